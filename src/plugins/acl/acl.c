@@ -21,6 +21,8 @@
 
 #include <vnet/l2/l2_classify.h>
 #include <vnet/classify/in_out_acl.h>
+#include <vnet/ip/ip4_flow_cache.h>
+#include <vnet/snapshot/snapshot.h>
 #include <vpp/app/version.h>
 
 #include <vlibapi/api.h>
@@ -436,6 +438,8 @@ acl_add_list (u32 count, vl_api_acl_rule_t rules[],
 
   /* notify the lookup contexts about the ACL changes */
   acl_plugin_lookup_context_notify_acl_change (*acl_list_index);
+  /* cached flows may no longer be permitted */
+  ip4_flow_cache_invalidate ();
   clib_mem_set_heap (oldheap);
   return 0;
 }
@@ -1359,6 +1363,7 @@ acl_interface_set_inout_acl_list (acl_main_t * am, u32 sw_if_index,
   /* ensure ACL processing is enabled/disabled as needed */
   acl_interface_inout_enable_disable (am, sw_if_index, is_input,
 				      vec_len (vec_acl_list_index) > 0);
+  ip4_flow_cache_invalidate ();
 
 done:
   clib_bitmap_free (change_acl_bitmap);
@@ -4077,6 +4082,132 @@ VLIB_CLI_COMMAND (aclplugin_clear_command, static) = {
 };
 /* *INDENT-ON* */
 
+/*
+ * Warm restart snapshot: the ACLs and their interface bindings. The
+ * rules are kept in their API encoding. ACL indices are reallocated on
+ * restore, the bindings are mapped to the new ones.
+ */
+static void
+acl_snapshot_save (serialize_main_t * m, va_list * va)
+{
+  acl_main_t *am = &acl_main;
+  vl_api_acl_rule_t api_rule;
+  acl_list_t *acl;
+  u32 sw_if_index, n, *acln;
+  int i;
+
+  serialize_likely_small_unsigned_integer (m, pool_elts (am->acls));
+  /* *INDENT-OFF* */
+  pool_foreach (acl, am->acls,
+  ({
+    serialize_integer (m, acl - am->acls, sizeof (u32));
+    serialize_vnet_snapshot_data (m, acl->tag, sizeof (acl->tag));
+    serialize_likely_small_unsigned_integer (m, acl->count);
+    for (i = 0; i < acl->count; i++)
+      {
+	memset (&api_rule, 0, sizeof (api_rule));
+	copy_acl_rule_to_api_rule (&api_rule, &acl->rules[i]);
+	serialize_vnet_snapshot_data (m, &api_rule, sizeof (api_rule));
+      }
+  }));
+  /* *INDENT-ON* */
+
+  n = 0;
+  vec_foreach_index (sw_if_index, am->input_acl_vec_by_sw_if_index)
+    n += (vec_len (am->input_acl_vec_by_sw_if_index[sw_if_index]) > 0);
+  vec_foreach_index (sw_if_index, am->output_acl_vec_by_sw_if_index)
+    n += (vec_len (am->output_acl_vec_by_sw_if_index[sw_if_index]) > 0);
+
+  serialize_likely_small_unsigned_integer (m, n);
+  for (i = 1; i >= 0; i--)
+    {
+      u32 **vec_by_sw_if_index = (i ? am->input_acl_vec_by_sw_if_index :
+				  am->output_acl_vec_by_sw_if_index);
+
+      vec_foreach_index (sw_if_index, vec_by_sw_if_index)
+      {
+	if (0 == vec_len (vec_by_sw_if_index[sw_if_index]))
+	  continue;
+	serialize_vnet_snapshot_sw_if_index (m, sw_if_index);
+	serialize_integer (m, i, sizeof (u8));
+	serialize_likely_small_unsigned_integer
+	  (m, vec_len (vec_by_sw_if_index[sw_if_index]));
+	vec_foreach (acln, vec_by_sw_if_index[sw_if_index])
+	  serialize_integer (m, *acln, sizeof (u32));
+      }
+    }
+}
+
+static void
+acl_snapshot_restore (serialize_main_t * m, va_list * va)
+{
+  acl_main_t *am = &acl_main;
+  vl_api_acl_rule_t *rules = 0;
+  u32 n, count, old_index, new_index, sw_if_index, *acls = 0;
+  uword *new_index_by_old = 0, *p;
+  u8 tag[64], is_input;
+  int skip, i;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      unserialize_integer (m, &old_index, sizeof (u32));
+      unserialize_vnet_snapshot_data (m, tag, sizeof (tag));
+      count = unserialize_likely_small_unsigned_integer (m);
+      vec_validate (rules, count);
+      for (i = 0; i < count; i++)
+	unserialize_vnet_snapshot_data (m, &rules[i], sizeof (rules[i]));
+
+      new_index = ~0;
+      if (acl_add_list (count, rules, &new_index, tag))
+	vnet_snapshot_skip ();
+      else
+	hash_set (new_index_by_old, old_index, new_index);
+    }
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+      unserialize_integer (m, &is_input, sizeof (u8));
+      count = unserialize_likely_small_unsigned_integer (m);
+      vec_reset_length (acls);
+      for (i = 0; i < count; i++)
+	{
+	  unserialize_integer (m, &old_index, sizeof (u32));
+	  p = hash_get (new_index_by_old, old_index);
+	  if (p)
+	    vec_add1 (acls, p[0]);
+	  else
+	    skip = 1;
+	}
+      if (skip)
+	continue;
+
+      int may_clear_sessions = 1;
+      void *oldheap = acl_set_heap (am);
+      u32 *acl_vec = vec_dup (acls);
+
+      if (acl_interface_set_inout_acl_list (am, sw_if_index, is_input,
+					    acl_vec, &may_clear_sessions))
+	vnet_snapshot_skip ();
+      vec_free (acl_vec);
+      clib_mem_set_heap (oldheap);
+    }
+
+  vec_free (rules);
+  vec_free (acls);
+  hash_free (new_index_by_old);
+}
+
+/* *INDENT-OFF* */
+VNET_SNAPSHOT_SECTION (acl, static) = {
+  .name = "acl",
+  .save = acl_snapshot_save,
+  .restore = acl_snapshot_restore,
+};
+/* *INDENT-ON* */
+
 static clib_error_t *
 acl_plugin_config (vlib_main_t * vm, unformat_input_t * input)
 {
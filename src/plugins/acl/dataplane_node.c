@@ -581,6 +581,7 @@ VNET_FEATURE_INIT (acl_in_ip4_fa_feature, static) =
   .arc_name = "ip4-unicast",
   .node_name = "acl-plugin-in-ip4-fa",
   .runs_before = VNET_FEATURES ("ip4-flow-classify"),
+  .runs_after = VNET_FEATURES ("ip4-flow-cache"),
 };
 
 
@@ -79,6 +79,7 @@
 #include <vlib/pci/pci.h>
 #include <vlib/linux/vfio.h>
 #include <vnet/vnet.h>
+#include <vnet/ethernet/ethernet.h>
 #include <dpdk/device/dpdk.h>
 #include <dpdk/device/dpdk_priv.h>
 
@@ -118,7 +119,11 @@ next:
     }
 
   if ((mb = rte_pktmbuf_prefree_seg (mb)))
-    rte_mempool_put (mb->pool, mb);
+    {
+      /* Whoever allocates the buffer next must not find it sampled */
+      b->flags &= ~VLIB_BUFFER_IS_SAMPLED;
+      rte_mempool_put (mb->pool, mb);
+    }
 
   if (maybe_next && (flags & VLIB_BUFFER_NEXT_PRESENT))
     {
@@ -538,28 +543,29 @@ dpdk_pool_create (vlib_main_t * vm, u8 * pool_name, u32 elt_size,
   return 0;
 }
 
-clib_error_t *
-dpdk_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
-			 unsigned socket_id)
+static clib_error_t *
+dpdk_buffer_pool_create_internal (vlib_main_t * vm,
+				  struct rte_mempool ***pools, char *name,
+				  unsigned num_mbufs, u32 data_size,
+				  unsigned socket_id)
 {
-  dpdk_main_t *dm = &dpdk_main;
   struct rte_mempool *rmp;
   vlib_physmem_region_index_t pri;
   clib_error_t *error = 0;
   u8 *pool_name;
   u32 elt_size, i;
 
-  vec_validate_aligned (dm->pktmbuf_pools, socket_id, CLIB_CACHE_LINE_BYTES);
+  vec_validate_aligned (pools[0], socket_id, CLIB_CACHE_LINE_BYTES);
 
   /* pool already exists, nothing to do */
-  if (dm->pktmbuf_pools[socket_id])
+  if (pools[0][socket_id])
     return 0;
 
-  pool_name = format (0, "dpdk_mbuf_pool_socket%u%c", socket_id, 0);
+  pool_name = format (0, "%s%u%c", name, socket_id, 0);
 
   elt_size = sizeof (struct rte_mbuf) +
     VLIB_BUFFER_HDR_SIZE /* priv size */  +
-    VLIB_BUFFER_PRE_DATA_SIZE + VLIB_BUFFER_DATA_SIZE;	/*data room size */
+    VLIB_BUFFER_PRE_DATA_SIZE + data_size;	/*data room size */
 
   error =
     dpdk_pool_create (vm, pool_name, elt_size, num_mbufs,
@@ -570,13 +576,18 @@ dpdk_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
 
   if (!error)
     {
+      dpdk_mempool_private_t *privp = rte_mempool_get_priv (rmp);
+
+      /* dpdk_pool_create sized the data room for the default buffers */
+      privp->mbp_priv.mbuf_data_room_size =
+	VLIB_BUFFER_PRE_DATA_SIZE + data_size;
+
       /* call the object initializers */
       rte_mempool_obj_iter (rmp, rte_pktmbuf_init, 0);
 
-      dpdk_mempool_private_t *privp = rte_mempool_get_priv (rmp);
       privp->buffer_pool_index = vlib_buffer_pool_create (vm, pri, 0);
 
-      dm->pktmbuf_pools[socket_id] = rmp;
+      pools[0][socket_id] = rmp;
 
       return 0;
     }
@@ -584,14 +595,14 @@ dpdk_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
   clib_error_report (error);
 
   /* no usable pool for this socket, try to use pool from another one */
-  for (i = 0; i < vec_len (dm->pktmbuf_pools); i++)
+  for (i = 0; i < vec_len (pools[0]); i++)
     {
-      if (dm->pktmbuf_pools[i])
+      if (pools[0][i])
 	{
 	  clib_warning ("WARNING: Failed to allocate mempool for CPU socket "
 			"%u. Threads running on socket %u will use socket %u "
 			"mempool.", socket_id, socket_id, i);
-	  dm->pktmbuf_pools[socket_id] = dm->pktmbuf_pools[i];
+	  pools[0][socket_id] = pools[0][i];
 	  return 0;
 	}
     }
@@ -600,6 +611,31 @@ dpdk_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
 			    socket_id);
 }
 
+clib_error_t *
+dpdk_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
+			 unsigned socket_id)
+{
+  dpdk_main_t *dm = &dpdk_main;
+
+  return dpdk_buffer_pool_create_internal (vm, &dm->pktmbuf_pools,
+					   "dpdk_mbuf_pool_socket", num_mbufs,
+					   VLIB_BUFFER_DATA_SIZE, socket_id);
+}
+
+/* Pool of mbufs with room for a whole jumbo frame, RX queues of
+   interfaces whose frames don't fit the default mbufs fill from it. */
+clib_error_t *
+dpdk_jumbo_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
+			       unsigned socket_id)
+{
+  dpdk_main_t *dm = &dpdk_main;
+
+  return dpdk_buffer_pool_create_internal (vm, &dm->jumbo_pktmbuf_pools,
+					   "dpdk_mbuf_jumbo_socket", num_mbufs,
+					   DPDK_JUMBO_MBUF_DATA_SIZE,
+					   socket_id);
+}
+
 #if CLIB_DEBUG > 0
 
 u32 *vlib_buffer_state_validation_lock;
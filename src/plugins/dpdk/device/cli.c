@@ -385,16 +385,15 @@ VLIB_CLI_COMMAND (pcap_rx_trace_command, static) = {
 /* *INDENT-ON* */
 
 
-static clib_error_t *
-show_dpdk_buffer (vlib_main_t * vm, unformat_input_t * input,
-		  vlib_cli_command_t * cmd)
+static void
+show_dpdk_buffer_pools (vlib_main_t * vm, struct rte_mempool **pools)
 {
   struct rte_mempool *rmp;
   int i;
 
-  for (i = 0; i < vec_len (dpdk_main.pktmbuf_pools); i++)
+  for (i = 0; i < vec_len (pools); i++)
     {
-      rmp = dpdk_main.pktmbuf_pools[i];
+      rmp = pools[i];
       if (rmp)
 	{
 	  unsigned count = rte_mempool_avail_count (rmp);
@@ -410,6 +409,14 @@ show_dpdk_buffer (vlib_main_t * vm, unformat_input_t * input,
 	  vlib_cli_output (vm, "rte_mempool is NULL (!)\n");
 	}
     }
+}
+
+static clib_error_t *
+show_dpdk_buffer (vlib_main_t * vm, unformat_input_t * input,
+		  vlib_cli_command_t * cmd)
+{
+  show_dpdk_buffer_pools (vm, dpdk_main.pktmbuf_pools);
+  show_dpdk_buffer_pools (vm, dpdk_main.jumbo_pktmbuf_pools);
   return 0;
 }
 
@@ -36,6 +36,21 @@ dpdk_device_error (dpdk_device_t * xd, char *str, int rv)
 				  str, xd->port_id, rv, rte_strerror (rv));
 }
 
+/* Mempool an RX queue fills from: the jumbo one of the queue's socket
+   when the interface's frames don't fit the default mbufs */
+static struct rte_mempool *
+dpdk_rx_queue_pool (vnet_hw_interface_t * hi, u16 socket_id)
+{
+  dpdk_main_t *dm = &dpdk_main;
+
+  if (hi->max_packet_bytes > VLIB_BUFFER_DATA_SIZE &&
+      socket_id < vec_len (dm->jumbo_pktmbuf_pools) &&
+      dm->jumbo_pktmbuf_pools[socket_id])
+    return dm->jumbo_pktmbuf_pools[socket_id];
+
+  return dm->pktmbuf_pools[socket_id];
+}
+
 void
 dpdk_device_setup (dpdk_device_t * xd)
 {
@@ -97,24 +112,25 @@ dpdk_device_setup (dpdk_device_t * xd)
   for (j = 0; j < xd->rx_q_used; j++)
     {
       dpdk_mempool_private_t *privp;
+      struct rte_mempool *mp;
       uword tidx = vnet_get_device_input_thread_index (dm->vnet_main,
 						       xd->hw_if_index, j);
       unsigned lcore = vlib_worker_threads[tidx].lcore_id;
       u16 socket_id = rte_lcore_to_socket_id (lcore);
 
+      mp = dpdk_rx_queue_pool (hi, socket_id);
+
       rv =
 	rte_eth_rx_queue_setup (xd->port_id, j, xd->nb_rx_desc,
-				xd->cpu_socket, 0,
-				dm->pktmbuf_pools[socket_id]);
+				xd->cpu_socket, 0, mp);
 
       /* retry with any other CPU socket */
       if (rv < 0)
 	rv =
 	  rte_eth_rx_queue_setup (xd->port_id, j,
-				  xd->nb_rx_desc, SOCKET_ID_ANY, 0,
-				  dm->pktmbuf_pools[socket_id]);
+				  xd->nb_rx_desc, SOCKET_ID_ANY, 0, mp);
 
-      privp = rte_mempool_get_priv (dm->pktmbuf_pools[socket_id]);
+      privp = rte_mempool_get_priv (mp);
       xd->buffer_pool_for_queue[j] = privp->buffer_pool_index;
 
       if (rv < 0)
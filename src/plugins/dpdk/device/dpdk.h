@@ -58,6 +58,9 @@
 
 #define NB_MBUF   (16<<10)
 
+/* Data room of jumbo mbufs, the largest frame plus vlan tags and fcs */
+#define DPDK_JUMBO_MBUF_DATA_SIZE (ETHERNET_MAX_PACKET_BYTES + 128)
+
 extern vnet_device_class_t dpdk_device_class;
 extern vlib_node_registration_t dpdk_input_node;
 
@@ -359,6 +362,7 @@ typedef struct
   u32 coremask;
   u32 nchannels;
   u32 num_mbufs;
+  u32 num_jumbo_mbufs;
 
   /*
    * format interface names ala xxxEthernet%d/%d/%d instead of
@@ -441,6 +445,7 @@ typedef struct
 
   /* mempool */
   struct rte_mempool **pktmbuf_pools;
+  struct rte_mempool **jumbo_pktmbuf_pools;
 
   /* API message ID base */
   u16 msg_id_base;
@@ -535,6 +540,9 @@ clib_error_t *dpdk_pool_create (vlib_main_t * vm, u8 * pool_name,
 
 clib_error_t *dpdk_buffer_pool_create (vlib_main_t * vm, unsigned num_mbufs,
 				       unsigned socket_id);
+clib_error_t *dpdk_jumbo_buffer_pool_create (vlib_main_t * vm,
+					     unsigned num_mbufs,
+					     unsigned socket_id);
 
 #if CLI_DEBUG
 int dpdk_buffer_validate_trajectory_all (u32 * uninitialized);
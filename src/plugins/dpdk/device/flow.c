@@ -41,6 +41,7 @@ dpdk_flow_add (dpdk_device_t * xd, vnet_flow_t * f, dpdk_flow_entry_t * fe)
   struct rte_flow_item_udp udp[2] = { };
   struct rte_flow_item_tcp tcp[2] = { };
   struct rte_flow_action_mark mark = { 0 };
+  struct rte_flow_action_queue queue = { 0 };
   struct rte_flow_item *item, *items = 0;
   struct rte_flow_action *action, *actions = 0;
 
@@ -63,6 +64,10 @@ dpdk_flow_add (dpdk_device_t * xd, vnet_flow_t * f, dpdk_flow_entry_t * fe)
   if (f->actions & (~xd->supported_flow_actions))
     return VNET_FLOW_ERROR_NOT_SUPPORTED;
 
+  if ((f->actions & VNET_FLOW_ACTION_REDIRECT_TO_QUEUE)
+      && f->redirect_queue >= xd->rx_q_used)
+    return VNET_FLOW_ERROR_NOT_SUPPORTED;
+
   /* Match items */
   /* Ethernet */
   vec_add2 (items, item, 1);
@@ -197,12 +202,25 @@ dpdk_flow_add (dpdk_device_t * xd, vnet_flow_t * f, dpdk_flow_entry_t * fe)
 
   /* Actions */
   vec_add2 (actions, action, 1);
-  action->type = RTE_FLOW_ACTION_TYPE_PASSTHRU;
+  if (f->actions & VNET_FLOW_ACTION_DROP)
+    action->type = RTE_FLOW_ACTION_TYPE_DROP;
+  else if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_QUEUE)
+    {
+      queue.index = f->redirect_queue;
+      action->type = RTE_FLOW_ACTION_TYPE_QUEUE;
+      action->conf = &queue;
+    }
+  else
+    action->type = RTE_FLOW_ACTION_TYPE_PASSTHRU;
 
-  vec_add2 (actions, action, 1);
-  mark.id = fe->mark;
-  action->type = RTE_FLOW_ACTION_TYPE_MARK;
-  action->conf = &mark;
+  /* dropped packets are never seen, so there is nothing to mark */
+  if (fe->mark && (f->actions & VNET_FLOW_ACTION_DROP) == 0)
+    {
+      vec_add2 (actions, action, 1);
+      mark.id = fe->mark;
+      action->type = RTE_FLOW_ACTION_TYPE_MARK;
+      action->conf = &mark;
+    }
 
   vec_add2 (actions, action, 1);
   action->type = RTE_FLOW_ACTION_TYPE_END;
@@ -421,7 +421,8 @@ dpdk_lib_init (dpdk_main_t * dm)
 	      xd->supported_flow_actions = VNET_FLOW_ACTION_MARK |
 		VNET_FLOW_ACTION_REDIRECT_TO_NODE |
 		VNET_FLOW_ACTION_BUFFER_ADVANCE |
-		VNET_FLOW_ACTION_COUNT | VNET_FLOW_ACTION_DROP;
+		VNET_FLOW_ACTION_COUNT | VNET_FLOW_ACTION_DROP |
+		VNET_FLOW_ACTION_REDIRECT_TO_QUEUE;
 
 	      if (dm->conf->no_tx_checksum_offload == 0)
 		{
@@ -1086,6 +1087,9 @@ dpdk_config (vlib_main_t * vm, unformat_input_t * input)
 	}
       else if (unformat (input, "num-mbufs %d", &conf->num_mbufs))
 	;
+      else if (unformat (input, "num-jumbo-mbufs %d",
+			 &conf->num_jumbo_mbufs))
+	;
       else if (unformat (input, "uio-driver %s", &conf->uio_driver_name))
 	;
       else if (unformat (input, "socket-mem %s", &socket_mem))
@@ -1411,6 +1415,23 @@ dpdk_config (vlib_main_t * vm, unformat_input_t * input)
 	return error;
     }
 
+  /* jumbo frames are received into single mbufs when asked for */
+  if (conf->num_jumbo_mbufs)
+    {
+      error = dpdk_jumbo_buffer_pool_create (vm, conf->num_jumbo_mbufs,
+					     rte_socket_id ());
+      if (error)
+	return error;
+
+      for (i = 0; i < RTE_MAX_LCORE; i++)
+	{
+	  error = dpdk_jumbo_buffer_pool_create (vm, conf->num_jumbo_mbufs,
+						 rte_lcore_to_socket_id (i));
+	  if (error)
+	    return error;
+	}
+    }
+
 done:
   return error;
 }
@@ -362,32 +362,23 @@ int vnet_gtpu_add_del_tunnel
   gtpu_main_t *gtm = &gtpu_main;
   gtpu_tunnel_t *t = 0;
   vnet_main_t *vnm = gtm->vnet_main;
-  uword *p;
   u32 hw_if_index = ~0;
   u32 sw_if_index = ~0;
-  gtpu4_tunnel_key_t key4;
-  gtpu6_tunnel_key_t key6;
+  u32 tunnel_index;
   u32 is_ip6 = a->is_ip6;
 
-  if (!is_ip6)
-    {
-      key4.src = a->dst.ip4.as_u32;	/* decap src in key is encap dst in config */
-      key4.teid = clib_host_to_net_u32 (a->teid);
-      p = hash_get (gtm->gtpu4_tunnel_by_key, key4.as_u64);
-    }
-  else
-    {
-      key6.src = a->dst.ip6;
-      key6.teid = clib_host_to_net_u32 (a->teid);
-      p = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6);
-    }
+  /* decap src in key is encap dst in config */
+  tunnel_index = udp_tunnel_demux_find (&gtm->tunnel_demux, &a->dst,
+					a->encap_fib_index,
+					clib_host_to_net_u32 (a->teid),
+					is_ip6);
 
   if (a->is_add)
     {
       l2input_main_t *l2im = &l2input_main;
 
       /* adding a tunnel: tunnel must not already exist */
-      if (p)
+      if (tunnel_index != ~0)
 	return VNET_API_ERROR_TUNNEL_EXIST;
 
       /*if not set explicitly, default to l2 */
@@ -406,12 +397,17 @@ int vnet_gtpu_add_del_tunnel
 
       ip_udp_gtpu_rewrite (t, is_ip6);
 
-      /* copy the key */
-      if (is_ip6)
-	hash_set_mem_alloc (&gtm->gtpu6_tunnel_by_key, &key6,
-			    t - gtm->tunnels);
-      else
-	hash_set (gtm->gtpu4_tunnel_by_key, key4.as_u64, t - gtm->tunnels);
+      /* copy the key; no interface exists yet, so on failure only the
+       * pool entry and its rewrite need to be undone */
+      if (udp_tunnel_demux_add_del (&gtm->tunnel_demux, &t->dst,
+				    t->encap_fib_index,
+				    clib_host_to_net_u32 (t->teid), is_ip6,
+				    t - gtm->tunnels, 1 /* is_add */ ))
+	{
+	  vec_free (t->rewrite);
+	  pool_put (gtm->tunnels, t);
+	  return VNET_API_ERROR_INVALID_REGISTRATION;
+	}
 
       vnet_hw_interface_t *hi;
       if (vec_len (gtm->free_gtpu_tunnel_hw_if_indices) > 0)
@@ -567,10 +563,10 @@ int vnet_gtpu_add_del_tunnel
   else
     {
       /* deleting a tunnel: tunnel must exist */
-      if (!p)
+      if (tunnel_index == ~0)
 	return VNET_API_ERROR_NO_SUCH_ENTRY;
 
-      t = pool_elt_at_index (gtm->tunnels, p[0]);
+      t = pool_elt_at_index (gtm->tunnels, tunnel_index);
       sw_if_index = t->sw_if_index;
 
       vnet_sw_interface_set_flags (vnm, t->sw_if_index, 0 /* down */ );
@@ -584,10 +580,10 @@ int vnet_gtpu_add_del_tunnel
 
       gtm->tunnel_index_by_sw_if_index[t->sw_if_index] = ~0;
 
-      if (!is_ip6)
-	hash_unset (gtm->gtpu4_tunnel_by_key, key4.as_u64);
-      else
-	hash_unset_mem_free (&gtm->gtpu6_tunnel_by_key, &key6);
+      udp_tunnel_demux_add_del (&gtm->tunnel_demux, &t->dst,
+				t->encap_fib_index,
+				clib_host_to_net_u32 (t->teid), is_ip6,
+				t - gtm->tunnels, 0 /* is_add */ );
 
       if (!ip46_address_is_multicast (&t->dst))
 	{
@@ -1081,10 +1077,9 @@ gtpu_init (vlib_main_t * vm)
   gtm->vnet_main = vnet_get_main ();
   gtm->vlib_main = vm;
 
+  udp_tunnel_demux_init (&gtm->tunnel_demux, "gtpu");
+
   /* initialize the ip6 hash */
-  gtm->gtpu6_tunnel_by_key = hash_create_mem (0,
-					      sizeof (gtpu6_tunnel_key_t),
-					      sizeof (uword));
   gtm->vtep6 = hash_create_mem (0, sizeof (ip6_address_t), sizeof (uword));
   gtm->mcast_shared = hash_create_mem (0,
 				       sizeof (ip46_address_t),
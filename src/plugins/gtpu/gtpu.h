@@ -30,6 +30,7 @@
 #include <vnet/ip/ip4_packet.h>
 #include <vnet/ip/ip6_packet.h>
 #include <vnet/udp/udp.h>
+#include <vnet/udp/udp_tunnel_demux.h>
 #include <vnet/dpo/dpo.h>
 #include <vnet/adj/adj_types.h>
 #include <vnet/fib/fib_table.h>
@@ -92,35 +93,6 @@ typedef CLIB_PACKED(struct
 }) ip6_gtpu_header_t;
 /* *INDENT-ON* */
 
-/* *INDENT-OFF* */
-typedef CLIB_PACKED
-(struct {
-  /*
-   * Key fields: ip src and gtpu teid on incoming gtpu packet
-   * all fields in NET byte order
-   */
-  union {
-    struct {
-      u32 src;
-      u32 teid;
-    };
-    u64 as_u64;
-  };
-}) gtpu4_tunnel_key_t;
-/* *INDENT-ON* */
-
-/* *INDENT-OFF* */
-typedef CLIB_PACKED
-(struct {
-  /*
-   * Key fields: ip src and gtpu teid on incoming gtpu packet
-   * all fields in NET byte order
-   */
-  ip6_address_t src;
-  u32 teid;
-}) gtpu6_tunnel_key_t;
-/* *INDENT-ON* */
-
 typedef struct
 {
   /* Required for pool_get_aligned  */
@@ -200,9 +172,8 @@ typedef struct
   /* vector of encap tunnel instances */
   gtpu_tunnel_t *tunnels;
 
-  /* lookup tunnel by key */
-  uword *gtpu4_tunnel_by_key;	/* keyed on ipv4.dst + teid */
-  uword *gtpu6_tunnel_by_key;	/* keyed on ipv6.dst + teid */
+  /* lookup tunnel by key: ip46.dst + encap fib + teid */
+  udp_tunnel_demux_t tunnel_demux;
 
   /* local VTEP IPs ref count used by gtpu-bypass node to check if
      received gtpu packet DIP matches any local VTEP address */
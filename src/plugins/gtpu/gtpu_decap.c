@@ -49,22 +49,109 @@ static u8 * format_gtpu_rx_trace (u8 * s, va_list * args)
 }
 
 always_inline u32
-validate_gtpu_fib (vlib_buffer_t *b, gtpu_tunnel_t *t, u32 is_ip4)
+gtpu_buffer_fib_index (vlib_buffer_t *b, u32 is_ip4)
 {
-  u32 fib_index, sw_if_index;
+  u32 sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
 
-  sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
+  if (vnet_buffer (b)->sw_if_index[VLIB_TX] != (u32) ~ 0)
+    return vnet_buffer (b)->sw_if_index[VLIB_TX];
+
+  return is_ip4 ?
+    vec_elt (ip4_main.fib_index_by_sw_if_index, sw_if_index) :
+    vec_elt (ip6_main.fib_index_by_sw_if_index, sw_if_index);
+}
+
+/* Build the tunnel demux key of each packet in the frame: packet SIP,
+ * encap-fib and teid. SIP identify a GTPU path, and teid identify a tunnel
+ * in a given GTPU path */
+always_inline void
+gtpu_demux_keys (vlib_main_t * vm, u32 * from, udp_tunnel_demux_key_t * k,
+		 u32 n_left, u32 is_ip4)
+{
+  while (n_left > 0)
+    {
+      vlib_buffer_t * b0;
+      gtpu_header_t * gtpu0;
+
+      if (n_left > 4)
+	{
+	  vlib_buffer_t * p4 = vlib_get_buffer (vm, from[4]);
+	  vlib_prefetch_buffer_header (p4, LOAD);
+	  CLIB_PREFETCH (p4->data, 2*CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      b0 = vlib_get_buffer (vm, from[0]);
+
+      /* udp leaves current_data pointing at the gtpu header */
+      gtpu0 = vlib_buffer_get_current (b0);
+      if (is_ip4)
+	{
+	  ip4_header_t * ip4_0 = (void *) ((u8 *) gtpu0 -
+		sizeof(udp_header_t) - sizeof(ip4_header_t));
+	  udp_tunnel_demux_key4 (k, &ip4_0->src_address,
+				 gtpu_buffer_fib_index (b0, is_ip4),
+				 gtpu0->teid);
+	}
+      else
+	{
+	  ip6_header_t * ip6_0 = (void *) ((u8 *) gtpu0 -
+		sizeof(udp_header_t) - sizeof(ip6_header_t));
+	  udp_tunnel_demux_key6 (k, &ip6_0->src_address,
+				 gtpu_buffer_fib_index (b0, is_ip4),
+				 gtpu0->teid);
+	}
+
+      from += 1;
+      k += 1;
+      n_left -= 1;
+    }
+}
+
+/* Return the tunnel found by the demux search, after checking the packet
+ * DIP against the tunnel SIP. A packet to a multicast group also needs the
+ * mcast tunnel for that group, returned in mt0 */
+always_inline u32
+gtpu_find_tunnel (gtpu_main_t * gtm, udp_tunnel_demux_key_t * k,
+		  void * ip0, u32 is_ip4, gtpu_tunnel_t ** mt0)
+{
+  u32 tunnel_index0 = udp_tunnel_demux_result (k, is_ip4);
+  gtpu_tunnel_t * t0;
+
+  if (PREDICT_FALSE (tunnel_index0 == ~0))
+    return ~0;
+  t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
   if (is_ip4)
-    fib_index = (vnet_buffer (b)->sw_if_index[VLIB_TX] == (u32) ~ 0) ?
-	vec_elt (ip4_main.fib_index_by_sw_if_index, sw_if_index) :
-	vnet_buffer (b)->sw_if_index[VLIB_TX];
+    {
+      ip4_header_t * ip4_0 = ip0;
+
+      if (PREDICT_TRUE (ip4_0->dst_address.as_u32 == t0->src.ip4.as_u32))
+	return tunnel_index0;
+      if (!ip4_address_is_multicast (&ip4_0->dst_address))
+	return ~0;
+      /* same encap-fib and teid, keyed on the group */
+      k->kv4.key[0] = ip4_0->dst_address.as_u32;
+    }
   else
-    fib_index = (vnet_buffer (b)->sw_if_index[VLIB_TX] == (u32) ~ 0) ?
-	vec_elt (ip6_main.fib_index_by_sw_if_index, sw_if_index) :
-	vnet_buffer (b)->sw_if_index[VLIB_TX];
+    {
+      ip6_header_t * ip6_0 = ip0;
+
+      if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
+					      &t0->src.ip6)))
+	return tunnel_index0;
+      if (!ip6_address_is_multicast (&ip6_0->dst_address))
+	return ~0;
+      k->kv6.key[0] = ip6_0->dst_address.as_u64[0];
+      k->kv6.key[1] = ip6_0->dst_address.as_u64[1];
+    }
 
-  return (fib_index == t->encap_fib_index);
+  /* Make sure mcast GTPU tunnel exist by packet DIP and teid */
+  u32 mcast_index0 = udp_tunnel_demux_lookup (&gtm->tunnel_demux, k, is_ip4);
+  if (PREDICT_FALSE (mcast_index0 == ~0))
+    return ~0;
+
+  *mt0 = pool_elt_at_index (gtm->tunnels, mcast_index0);
+  return tunnel_index0;
 }
 
 always_inline uword
@@ -77,21 +164,18 @@ gtpu_input (vlib_main_t * vm,
   gtpu_main_t * gtm = &gtpu_main;
   vnet_main_t * vnm = gtm->vnet_main;
   vnet_interface_main_t * im = &vnm->interface_main;
-  u32 last_tunnel_index = ~0;
-  gtpu4_tunnel_key_t last_key4;
-  gtpu6_tunnel_key_t last_key6;
+  udp_tunnel_demux_key_t keys[VLIB_FRAME_SIZE], * k = keys;
   u32 pkts_decapsulated = 0;
   u32 thread_index = vlib_get_thread_index();
   u32 stats_sw_if_index, stats_n_packets, stats_n_bytes;
 
-  if (is_ip4)
-    last_key4.as_u64 = ~0;
-  else
-    memset (&last_key6, 0xff, sizeof (last_key6));
-
   from = vlib_frame_vector_args (from_frame);
   n_left_from = from_frame->n_vectors;
 
+  /* Find the tunnels for the whole frame up front */
+  gtpu_demux_keys (vm, from, keys, n_left_from, is_ip4);
+  udp_tunnel_demux_search (&gtm->tunnel_demux, keys, n_left_from, is_ip4);
+
   next_index = node->cached_next_index;
   stats_sw_if_index = node->runtime_data[0];
   stats_n_packets = stats_n_bytes = 0;
@@ -111,11 +195,9 @@ gtpu_input (vlib_main_t * vm,
           ip6_header_t * ip6_0, * ip6_1;
           gtpu_header_t * gtpu0, * gtpu1;
           u32 gtpu_hdr_len0 = 0, gtpu_hdr_len1 =0 ;
-	  uword * p0, * p1;
+	  udp_tunnel_demux_key_t * k0, * k1;
           u32 tunnel_index0, tunnel_index1;
           gtpu_tunnel_t * t0, * t1, * mt0 = NULL, * mt1 = NULL;
-          gtpu4_tunnel_key_t key4_0, key4_1;
-          gtpu6_tunnel_key_t key6_0, key6_1;
           u32 error0, error1;
 	  u32 sw_if_index0, sw_if_index1, len0, len1;
 
@@ -135,9 +217,12 @@ gtpu_input (vlib_main_t * vm,
 
 	  bi0 = from[0];
 	  bi1 = from[1];
+	  k0 = &k[0];
+	  k1 = &k[1];
 	  to_next[0] = bi0;
 	  to_next[1] = bi1;
 	  from += 2;
+	  k += 2;
 	  to_next += 2;
 	  n_left_to_next -= 2;
 	  n_left_from -= 2;
@@ -191,108 +276,17 @@ gtpu_input (vlib_main_t * vm,
 	    }
 
 	  /* Manipulate packet 0 */
-          if (is_ip4) {
-            key4_0.src = ip4_0->src_address.as_u32;
-            key4_0.teid = gtpu0->teid;
-
- 	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-           if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
-              {
-                p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace0;
-                  }
-                last_key4.as_u64 = key4_0.as_u64;
-                tunnel_index0 = last_tunnel_index = p0[0];
-              }
-            else
-              tunnel_index0 = last_tunnel_index;
-	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
-
-	    /* Validate GTPU tunnel encap-fib index agaist packet */
-	    if (PREDICT_FALSE (validate_gtpu_fib (b0, t0, is_ip4) == 0))
-	      {
-		error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-		next0 = GTPU_INPUT_NEXT_DROP;
-		goto trace0;
-	      }
-
-	    /* Validate GTPU tunnel SIP against packet DIP */
-	    if (PREDICT_TRUE (ip4_0->dst_address.as_u32 == t0->src.ip4.as_u32))
-	      goto next0; /* valid packet */
-	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_0->dst_address)))
-	      {
-		key4_0.src = ip4_0->dst_address.as_u32;
-		key4_0.teid = gtpu0->teid;
-		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-		if (PREDICT_TRUE (p0 != NULL))
-		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
-		    goto next0; /* valid packet */
-		  }
-	      }
-	    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-	    next0 = GTPU_INPUT_NEXT_DROP;
-	    goto trace0;
-
-         } else /* !is_ip4 */ {
-            key6_0.src.as_u64[0] = ip6_0->src_address.as_u64[0];
-            key6_0.src.as_u64[1] = ip6_0->src_address.as_u64[1];
-            key6_0.teid = gtpu0->teid;
-
- 	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_0, &last_key6, sizeof(last_key6)) != 0))
-              {
-                p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace0;
-                  }
-                clib_memcpy (&last_key6, &key6_0, sizeof(key6_0));
-                tunnel_index0 = last_tunnel_index = p0[0];
-              }
-            else
-              tunnel_index0 = last_tunnel_index;
-	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
-
-	    /* Validate GTPU tunnel encap-fib index agaist packet */
-	    if (PREDICT_FALSE (validate_gtpu_fib (b0, t0, is_ip4) == 0))
-	      {
-		error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-		next0 = GTPU_INPUT_NEXT_DROP;
-		goto trace0;
-	      }
-
-	    /* Validate GTPU tunnel SIP against packet DIP */
-	    if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
-						    &t0->src.ip6)))
-		goto next0; /* valid packet */
-	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_0->dst_address)))
-	      {
-		key6_0.src.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		key6_0.src.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		key6_0.teid = gtpu0->teid;
-		p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-		if (PREDICT_TRUE (p0 != NULL))
-		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
-		    goto next0; /* valid packet */
-		  }
-	      }
-	    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-	    next0 = GTPU_INPUT_NEXT_DROP;
-	    goto trace0;
-          }
+	  tunnel_index0 = gtpu_find_tunnel (gtm, k0,
+					      is_ip4 ? (void *) ip4_0 :
+					      (void *) ip6_0, is_ip4, &mt0);
+	  if (PREDICT_FALSE (tunnel_index0 == ~0))
+	    {
+	      error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
+	      next0 = GTPU_INPUT_NEXT_DROP;
+	      goto trace0;
+	    }
+	  t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
-	next0:
 	  /* Manipulate gtpu header */
 	  if (PREDICT_FALSE((gtpu0->ver_flags & GTPU_E_S_PN_BIT) != 0))
 	    {
@@ -364,111 +358,18 @@ gtpu_input (vlib_main_t * vm,
 	      goto trace1;
 	    }
 
-          /* Manipulate packet 1 */
-          if (is_ip4) {
-            key4_1.src = ip4_1->src_address.as_u32;
-            key4_1.teid = gtpu1->teid;
-
- 	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-	    if (PREDICT_FALSE (key4_1.as_u64 != last_key4.as_u64))
-              {
-                p1 = hash_get (gtm->gtpu4_tunnel_by_key, key4_1.as_u64);
-                if (PREDICT_FALSE (p1 == NULL))
-                  {
-                    error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next1 = GTPU_INPUT_NEXT_DROP;
-                    goto trace1;
-                  }
-                last_key4.as_u64 = key4_1.as_u64;
-                tunnel_index1 = last_tunnel_index = p1[0];
-              }
-            else
-              tunnel_index1 = last_tunnel_index;
- 	    t1 = pool_elt_at_index (gtm->tunnels, tunnel_index1);
-
-	    /* Validate GTPU tunnel encap-fib index agaist packet */
-	    if (PREDICT_FALSE (validate_gtpu_fib (b1, t1, is_ip4) == 0))
-	      {
-		error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-		next1 = GTPU_INPUT_NEXT_DROP;
-		goto trace1;
-	      }
-
-	    /* Validate GTPU tunnel SIP against packet DIP */
-	    if (PREDICT_TRUE (ip4_1->dst_address.as_u32 == t1->src.ip4.as_u32))
-	      goto next1; /* valid packet */
-	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_1->dst_address)))
-	      {
-		key4_1.src = ip4_1->dst_address.as_u32;
-		key4_1.teid = gtpu1->teid;
-		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p1 = hash_get (gtm->gtpu4_tunnel_by_key, key4_1.as_u64);
-		if (PREDICT_TRUE (p1 != NULL))
-		  {
-		    mt1 = pool_elt_at_index (gtm->tunnels, p1[0]);
-		    goto next1; /* valid packet */
-		  }
-	      }
-	    error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-	    next1 = GTPU_INPUT_NEXT_DROP;
-	    goto trace1;
-
-         } else /* !is_ip4 */ {
-            key6_1.src.as_u64[0] = ip6_1->src_address.as_u64[0];
-            key6_1.src.as_u64[1] = ip6_1->src_address.as_u64[1];
-            key6_1.teid = gtpu1->teid;
-
- 	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_1, &last_key6, sizeof(last_key6)) != 0))
-              {
-                p1 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_1);
-
-                if (PREDICT_FALSE (p1 == NULL))
-                  {
-                    error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next1 = GTPU_INPUT_NEXT_DROP;
-                    goto trace1;
-                  }
-
-                clib_memcpy (&last_key6, &key6_1, sizeof(key6_1));
-                tunnel_index1 = last_tunnel_index = p1[0];
-              }
-            else
-              tunnel_index1 = last_tunnel_index;
- 	    t1 = pool_elt_at_index (gtm->tunnels, tunnel_index1);
-
-	    /* Validate GTPU tunnel encap-fib index agaist packet */
-	    if (PREDICT_FALSE (validate_gtpu_fib (b1, t1, is_ip4) == 0))
-	      {
-		error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-		next1 = GTPU_INPUT_NEXT_DROP;
-		goto trace1;
-	      }
-
-	    /* Validate GTPU tunnel SIP against packet DIP */
-	    if (PREDICT_TRUE (ip6_address_is_equal (&ip6_1->dst_address,
-						    &t1->src.ip6)))
-		goto next1; /* valid packet */
-	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_1->dst_address)))
-	      {
-		key6_1.src.as_u64[0] = ip6_1->dst_address.as_u64[0];
-		key6_1.src.as_u64[1] = ip6_1->dst_address.as_u64[1];
-		key6_1.teid = gtpu1->teid;
-		p1 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_1);
-		if (PREDICT_TRUE (p1 != NULL))
-		  {
-		    mt1 = pool_elt_at_index (gtm->tunnels, p1[0]);
-		    goto next1; /* valid packet */
-		  }
-	      }
-	    error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
-	    next1 = GTPU_INPUT_NEXT_DROP;
-	    goto trace1;
-	  }
+	  /* Manipulate packet 1 */
+	  tunnel_index1 = gtpu_find_tunnel (gtm, k1,
+					      is_ip4 ? (void *) ip4_1 :
+					      (void *) ip6_1, is_ip4, &mt1);
+	  if (PREDICT_FALSE (tunnel_index1 == ~0))
+	    {
+	      error1 = GTPU_ERROR_NO_SUCH_TUNNEL;
+	      next1 = GTPU_INPUT_NEXT_DROP;
+	      goto trace1;
+	    }
+	  t1 = pool_elt_at_index (gtm->tunnels, tunnel_index1);
 
-	next1:
 	  /* Manipulate gtpu header */
 	  if (PREDICT_FALSE((gtpu1->ver_flags & GTPU_E_S_PN_BIT) != 0))
 	    {
@@ -547,17 +448,17 @@ gtpu_input (vlib_main_t * vm,
           ip6_header_t * ip6_0;
           gtpu_header_t * gtpu0;
           u32 gtpu_hdr_len0 = 0;
-	  uword * p0;
+	  udp_tunnel_demux_key_t * k0;
           u32 tunnel_index0;
           gtpu_tunnel_t * t0, * mt0 = NULL;
-          gtpu4_tunnel_key_t key4_0;
-          gtpu6_tunnel_key_t key6_0;
           u32 error0;
 	  u32 sw_if_index0, len0;
 
 	  bi0 = from[0];
+	  k0 = &k[0];
 	  to_next[0] = bi0;
 	  from += 1;
+	  k += 1;
 	  to_next += 1;
 	  n_left_from -= 1;
 	  n_left_to_next -= 1;
@@ -594,108 +495,18 @@ gtpu_input (vlib_main_t * vm,
 	      goto trace00;
 	    }
 
-          if (is_ip4) {
-            key4_0.src = ip4_0->src_address.as_u32;
-            key4_0.teid = gtpu0->teid;
-
- 	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
-              {
-                p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace00;
-                  }
-                last_key4.as_u64 = key4_0.as_u64;
-                tunnel_index0 = last_tunnel_index = p0[0];
-              }
-            else
-              tunnel_index0 = last_tunnel_index;
-	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
-
-	    /* Validate GTPU tunnel encap-fib index agaist packet */
-	    if (PREDICT_FALSE (validate_gtpu_fib (b0, t0, is_ip4) == 0))
-	      {
-		error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-		next0 = GTPU_INPUT_NEXT_DROP;
-		goto trace00;
-	      }
-
-	    /* Validate GTPU tunnel SIP against packet DIP */
-	    if (PREDICT_TRUE (ip4_0->dst_address.as_u32 == t0->src.ip4.as_u32))
-	      goto next00; /* valid packet */
-	    if (PREDICT_FALSE (ip4_address_is_multicast (&ip4_0->dst_address)))
-	      {
-		key4_0.src = ip4_0->dst_address.as_u32;
-		key4_0.teid = gtpu0->teid;
-		/* Make sure mcast GTPU tunnel exist by packet DIP and teid */
-		p0 = hash_get (gtm->gtpu4_tunnel_by_key, key4_0.as_u64);
-		if (PREDICT_TRUE (p0 != NULL))
-		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
-		    goto next00; /* valid packet */
-		  }
-	      }
-	    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-	    next0 = GTPU_INPUT_NEXT_DROP;
-	    goto trace00;
-
-          } else /* !is_ip4 */ {
-            key6_0.src.as_u64[0] = ip6_0->src_address.as_u64[0];
-            key6_0.src.as_u64[1] = ip6_0->src_address.as_u64[1];
-            key6_0.teid = gtpu0->teid;
-
- 	    /* Make sure GTPU tunnel exist according to packet SIP and teid
- 	     * SIP identify a GTPU path, and teid identify a tunnel in a given GTPU path */
-            if (PREDICT_FALSE (memcmp(&key6_0, &last_key6, sizeof(last_key6)) != 0))
-              {
-                p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-                if (PREDICT_FALSE (p0 == NULL))
-                  {
-                    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-                    next0 = GTPU_INPUT_NEXT_DROP;
-                    goto trace00;
-                  }
-                clib_memcpy (&last_key6, &key6_0, sizeof(key6_0));
-                tunnel_index0 = last_tunnel_index = p0[0];
-              }
-            else
-              tunnel_index0 = last_tunnel_index;
-	    t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
-
-	    /* Validate GTPU tunnel encap-fib index agaist packet */
-	    if (PREDICT_FALSE (validate_gtpu_fib (b0, t0, is_ip4) == 0))
-	      {
-		error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-		next0 = GTPU_INPUT_NEXT_DROP;
-		goto trace00;
-	      }
-
-	    /* Validate GTPU tunnel SIP against packet DIP */
-	    if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
-						    &t0->src.ip6)))
-		goto next00; /* valid packet */
-	    if (PREDICT_FALSE (ip6_address_is_multicast (&ip6_0->dst_address)))
-	      {
-		key6_0.src.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		key6_0.src.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		key6_0.teid = gtpu0->teid;
-		p0 = hash_get_mem (gtm->gtpu6_tunnel_by_key, &key6_0);
-		if (PREDICT_TRUE (p0 != NULL))
-		  {
-		    mt0 = pool_elt_at_index (gtm->tunnels, p0[0]);
-		    goto next00; /* valid packet */
-		  }
-	      }
-	    error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
-	    next0 = GTPU_INPUT_NEXT_DROP;
-	    goto trace00;
-          }
+	  /* Manipulate packet 0 */
+	  tunnel_index0 = gtpu_find_tunnel (gtm, k0,
+					      is_ip4 ? (void *) ip4_0 :
+					      (void *) ip6_0, is_ip4, &mt0);
+	  if (PREDICT_FALSE (tunnel_index0 == ~0))
+	    {
+	      error0 = GTPU_ERROR_NO_SUCH_TUNNEL;
+	      next0 = GTPU_INPUT_NEXT_DROP;
+	      goto trace00;
+	    }
+	  t0 = pool_elt_at_index (gtm->tunnels, tunnel_index0);
 
-	next00:
 	  /* Manipulate gtpu header */
 	  if (PREDICT_FALSE((gtpu0->ver_flags & GTPU_E_S_PN_BIT) != 0))
 	    {
@@ -151,8 +151,8 @@ static void vl_api_vxlan_gpe_ioam_vni_enable_t_handler
   vl_api_vxlan_gpe_ioam_vni_enable_reply_t *rmp;
   clib_error_t *error;
   vxlan_gpe_ioam_main_t *sm = &vxlan_gpe_ioam_main;
-  vxlan4_gpe_tunnel_key_t key4;
-  uword *p = NULL;
+  ip46_address_t local, remote;
+  u32 tunnel_index;
   vxlan_gpe_main_t *gm = &vxlan_gpe_main;
   vxlan_gpe_tunnel_t *t = 0;
   vxlan_gpe_ioam_main_t *hm = &vxlan_gpe_ioam_main;
@@ -161,23 +161,23 @@ static void vl_api_vxlan_gpe_ioam_vni_enable_t_handler
 
   if (!mp->is_ipv6)
     {
-      clib_memcpy (&key4.local, &mp->local, sizeof (key4.local));
-      clib_memcpy (&key4.remote, &mp->remote, sizeof (key4.remote));
+      ip46_address_reset (&local);
+      ip46_address_reset (&remote);
+      clib_memcpy (&local.ip4, &mp->local, sizeof (local.ip4));
+      clib_memcpy (&remote.ip4, &mp->remote, sizeof (remote.ip4));
       vni = clib_net_to_host_u32 (mp->vni);
-      key4.vni = clib_host_to_net_u32 (vni << 8);
-      key4.pad = 0;
 
-      p = hash_get_mem (gm->vxlan4_gpe_tunnel_by_key, &key4);
+      tunnel_index = vxlan_gpe_tunnel_find (&local, &remote, vni, 0);
     }
   else
     {
       return;
     }
 
-  if (!p)
+  if (tunnel_index == ~0)
     return;
 
-  t = pool_elt_at_index (gm->tunnels, p[0]);
+  t = pool_elt_at_index (gm->tunnels, tunnel_index);
 
   error = vxlan_gpe_ioam_set (t, hm->has_trace_option,
 			      hm->has_pot_option,
@@ -201,8 +201,8 @@ static void vl_api_vxlan_gpe_ioam_vni_disable_t_handler
   vl_api_vxlan_gpe_ioam_vni_enable_reply_t *rmp;
   clib_error_t *error;
   vxlan_gpe_ioam_main_t *sm = &vxlan_gpe_ioam_main;
-  vxlan4_gpe_tunnel_key_t key4;
-  uword *p = NULL;
+  ip46_address_t local, remote;
+  u32 tunnel_index;
   vxlan_gpe_main_t *gm = &vxlan_gpe_main;
   vxlan_gpe_tunnel_t *t = 0;
   u32 vni;
@@ -210,23 +210,23 @@ static void vl_api_vxlan_gpe_ioam_vni_disable_t_handler
 
   if (!mp->is_ipv6)
     {
-      clib_memcpy (&key4.local, &mp->local, sizeof (key4.local));
-      clib_memcpy (&key4.remote, &mp->remote, sizeof (key4.remote));
+      ip46_address_reset (&local);
+      ip46_address_reset (&remote);
+      clib_memcpy (&local.ip4, &mp->local, sizeof (local.ip4));
+      clib_memcpy (&remote.ip4, &mp->remote, sizeof (remote.ip4));
       vni = clib_net_to_host_u32 (mp->vni);
-      key4.vni = clib_host_to_net_u32 (vni << 8);
-      key4.pad = 0;
 
-      p = hash_get_mem (gm->vxlan4_gpe_tunnel_by_key, &key4);
+      tunnel_index = vxlan_gpe_tunnel_find (&local, &remote, vni, 0);
     }
   else
     {
       return;
     }
 
-  if (!p)
+  if (tunnel_index == ~0)
     return;
 
-  t = pool_elt_at_index (gm->tunnels, p[0]);
+  t = pool_elt_at_index (gm->tunnels, tunnel_index);
 
   error = vxlan_gpe_ioam_clear (t, 0, 0, 0, 0);
 
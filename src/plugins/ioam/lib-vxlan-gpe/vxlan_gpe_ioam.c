@@ -425,11 +425,12 @@ vxlan_gpe_set_ioam_rewrite_command_fn (vlib_main_t *
   u8 vni_set = 0;
   u8 disable = 0;
   clib_error_t *rv = 0;
-  vxlan4_gpe_tunnel_key_t key4;
-  vxlan6_gpe_tunnel_key_t key6;
-  uword *p;
+  u32 tunnel_index;
   vxlan_gpe_main_t *gm = &vxlan_gpe_main;
   vxlan_gpe_tunnel_t *t = 0;
+
+  ip46_address_reset (&local);
+  ip46_address_reset (&remote);
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
       if (unformat (input, "local %U", unformat_ip4_address, &local.ip4))
@@ -479,27 +480,11 @@ vxlan_gpe_set_ioam_rewrite_command_fn (vlib_main_t *
     return clib_error_return (0, "src and dst addresses are identical");
   if (vni_set == 0)
     return clib_error_return (0, "vni not specified");
-  if (!ipv6_set)
-    {
-      key4.local = local.ip4.as_u32;
-      key4.remote = remote.ip4.as_u32;
-      key4.vni = clib_host_to_net_u32 (vni << 8);
-      key4.pad = 0;
-      p = hash_get_mem (gm->vxlan4_gpe_tunnel_by_key, &key4);
-    }
-  else
-    {
-      key6.local.as_u64[0] = local.ip6.as_u64[0];
-      key6.local.as_u64[1] = local.ip6.as_u64[1];
-      key6.remote.as_u64[0] = remote.ip6.as_u64[0];
-      key6.remote.as_u64[1] = remote.ip6.as_u64[1];
-      key6.vni = clib_host_to_net_u32 (vni << 8);
-      p = hash_get_mem (gm->vxlan6_gpe_tunnel_by_key, &key6);
-    }
+  tunnel_index = vxlan_gpe_tunnel_find (&local, &remote, vni, ipv6_set);
 
-  if (!p)
+  if (tunnel_index == ~0)
     return clib_error_return (0, "VxLAN Tunnel not found");
-  t = pool_elt_at_index (gm->tunnels, p[0]);
+  t = pool_elt_at_index (gm->tunnels, tunnel_index);
   if (!disable)
     {
       rv =
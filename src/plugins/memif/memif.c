@@ -45,7 +45,13 @@ memif_main_t memif_main;
 static u32
 memif_eth_flag_change (vnet_main_t * vnm, vnet_hw_interface_t * hi, u32 flags)
 {
-  /* nothing for now */
+  memif_main_t *mm = &memif_main;
+  memif_if_t *mif = pool_elt_at_index (mm->interfaces, hi->dev_instance);
+
+  if (flags & ETHERNET_INTERFACE_FLAG_MTU)
+    mif->rx_free_list_index =
+      vnet_hw_interface_rx_free_list (vnm, hi->hw_if_index);
+
   return 0;
 }
 
@@ -344,6 +350,15 @@ memif_init_regions_and_queues (memif_if_t * mif)
 	{
 	  vlib_physmem_region_t *pr;
 	  pr = vlib_physmem_get_region (vm, bp->physmem_region);
+	  /* an arena region shares its fd with the whole arena, handing it
+	     to the peer would expose memory beyond the buffer pool */
+	  if (pr->flags & VLIB_PHYSMEM_F_ARENA)
+	    {
+	      err = clib_error_return (0, "buffer pool '%s' is carved out of "
+				       "a physmem arena, zero-copy not "
+				       "supported", pr->name);
+	      goto error;
+	    }
 	  vec_add2_aligned (mif->regions, r, 1, CLIB_CACHE_LINE_BYTES);
 	  r->fd = pr->fd;
 	  r->region_size = pr->size;
@@ -888,6 +903,8 @@ memif_create_if (vlib_main_t * vm, memif_create_if_args_t * args)
 
   sw = vnet_get_hw_sw_interface (vnm, mif->hw_if_index);
   mif->sw_if_index = sw->sw_if_index;
+  mif->rx_free_list_index =
+    vnet_hw_interface_rx_free_list (vnm, mif->hw_if_index);
 
   mif->cfg.log2_ring_size = args->log2_ring_size;
   mif->cfg.buffer_size = args->buffer_size;
@@ -180,12 +180,14 @@ memif_device_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   memif_main_t *mm = &memif_main;
   memif_ring_t *ring;
   memif_queue_t *mq;
-  u16 buffer_size = VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES;
+  vlib_buffer_free_list_index_t fl_index = mif->rx_free_list_index;
+  u32 buffer_size = vlib_buffer_free_list_buffer_size (vm, fl_index);
   u32 next_index;
   uword n_trace = vlib_get_trace_count (vm, node);
   u32 n_rx_packets = 0, n_rx_bytes = 0;
   u32 n_left, *to_next = 0;
   u32 bi0, bi1, bi2, bi3;
+  u8 bpi0, bpi1, bpi2, bpi3;
   vlib_buffer_t *b0, *b1, *b2, *b3;
   u32 thread_index = vm->thread_index;
   memif_per_thread_data_t *ptd = vec_elt_at_index (mm->per_thread_data,
@@ -283,7 +285,8 @@ memif_device_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 
   /* allocate free buffers */
   vec_validate_aligned (ptd->buffers, n_buffers - 1, CLIB_CACHE_LINE_BYTES);
-  n_alloc = vlib_buffer_alloc (vm, ptd->buffers, n_buffers);
+  n_alloc = vlib_buffer_alloc_from_free_list (vm, ptd->buffers, n_buffers,
+					      fl_index);
   if (PREDICT_FALSE (n_alloc != n_buffers))
     {
       if (n_alloc)
@@ -344,6 +347,7 @@ memif_device_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   po = ptd->packet_ops;
 
   vnet_buffer (bt)->sw_if_index[VLIB_RX] = mif->sw_if_index;
+  vlib_buffer_set_free_list_index (bt, fl_index);
   bt->current_data = start_offset;
 
   while (n_from)
@@ -380,8 +384,19 @@ memif_device_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  b2 = vlib_get_buffer (vm, bi2);
 	  b3 = vlib_get_buffer (vm, bi3);
 
+	  /* the template doesn't know which pool each buffer came from */
+	  bpi0 = b0->buffer_pool_index;
+	  bpi1 = b1->buffer_pool_index;
+	  bpi2 = b2->buffer_pool_index;
+	  bpi3 = b3->buffer_pool_index;
+
 	  clib_memcpy64_x4 (b0, b1, b2, b3, bt);
 
+	  b0->buffer_pool_index = bpi0;
+	  b1->buffer_pool_index = bpi1;
+	  b2->buffer_pool_index = bpi2;
+	  b3->buffer_pool_index = bpi3;
+
 	  b0->current_length = po[0].packet_len;
 	  n_rx_bytes += b0->current_length;
 	  b1->current_length = po[1].packet_len;
@@ -457,7 +472,9 @@ memif_device_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  n_left_to_next--;
 
 	  b0 = vlib_get_buffer (vm, bi0);
+	  bpi0 = b0->buffer_pool_index;
 	  clib_memcpy (b0, bt, 64);
+	  b0->buffer_pool_index = bpi0;
 	  b0->current_length = po->packet_len;
 	  n_rx_bytes += b0->current_length;
 
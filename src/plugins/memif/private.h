@@ -130,6 +130,9 @@ typedef struct
 
   u32 per_interface_next_index;
 
+  /* free list copy mode receives into */
+  vlib_buffer_free_list_index_t rx_free_list_index;
+
   /* socket connection */
   clib_socket_t *sock;
   uword socket_file_index;
@@ -30,6 +30,8 @@
 #include <nat/nat_inlines.h>
 #include <vnet/fib/fib_table.h>
 #include <vnet/fib/ip4_fib.h>
+#include <vnet/ip/ip4_flow_cache.h>
+#include <vnet/snapshot/snapshot.h>
 
 #include <vpp/app/version.h>
 
@@ -40,87 +42,87 @@ snat_main_t snat_main;
 VNET_FEATURE_INIT (ip4_snat_in2out, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-in2out",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_out2in, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-out2in",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa",
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache",
                                "ip4-dhcp-client-detect"),
 };
 VNET_FEATURE_INIT (ip4_nat_classify, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-classify",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_det_in2out, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-det-in2out",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_det_out2in, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-det-out2in",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa",
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache",
                                "ip4-dhcp-client-detect"),
 };
 VNET_FEATURE_INIT (ip4_nat_det_classify, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-det-classify",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_nat44_ed_in2out, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-ed-in2out",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_nat44_ed_out2in, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-ed-out2in",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa",
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache",
                                "ip4-dhcp-client-detect"),
 };
 VNET_FEATURE_INIT (ip4_nat44_ed_classify, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-ed-classify",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_in2out_worker_handoff, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-in2out-worker-handoff",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_out2in_worker_handoff, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-out2in-worker-handoff",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa",
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache",
                                "ip4-dhcp-client-detect"),
 };
 VNET_FEATURE_INIT (ip4_nat_handoff_classify, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-handoff-classify",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_in2out_fast, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-in2out-fast",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_snat_out2in_fast, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-out2in-fast",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa",
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache",
                                "ip4-dhcp-client-detect"),
 };
 VNET_FEATURE_INIT (ip4_snat_hairpin_dst, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-hairpin-dst",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 VNET_FEATURE_INIT (ip4_nat44_ed_hairpin_dst, static) = {
   .arc_name = "ip4-unicast",
   .node_name = "nat44-ed-hairpin-dst",
-  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa"),
+  .runs_after = VNET_FEATURES ("acl-plugin-in-ip4-fa", "ip4-flow-cache"),
 };
 
 /* Hook up output features */
@@ -183,6 +185,31 @@ typedef enum {
   NAT44_CLASSIFY_N_NEXT,
 } nat44_classify_next_t;
 
+/**
+ * Remove the session's flows, in both directions, from the flow cache,
+ * where they may be cached with its translation.
+ */
+static void
+nat_free_session_flows (snat_session_t * s, u32 thread_index)
+{
+  u8 proto = snat_proto_to_ip_proto (s->in2out.protocol);
+  ip4_address_t r_addr;
+  u16 r_port;
+
+  if (proto != IP_PROTOCOL_TCP && proto != IP_PROTOCOL_UDP)
+    return;
+
+  /* inside hosts see the remote host's twice-nat address */
+  r_addr = is_twice_nat_session (s) ? s->ext_host_nat_addr : s->ext_host_addr;
+  r_port = is_twice_nat_session (s) ? s->ext_host_nat_port : s->ext_host_port;
+
+  ip4_flow_cache_delete_flow (thread_index, s->in2out.addr.as_u32,
+                              r_addr.as_u32, s->in2out.port, r_port, proto);
+  ip4_flow_cache_delete_flow (thread_index, s->ext_host_addr.as_u32,
+                              s->out2in.addr.as_u32, s->ext_host_port,
+                              s->out2in.port, proto);
+}
+
 void
 nat_free_session_data (snat_main_t * sm, snat_session_t * s, u32 thread_index)
 {
@@ -195,6 +222,8 @@ nat_free_session_data (snat_main_t * sm, snat_session_t * s, u32 thread_index)
   snat_main_per_thread_data_t *tsm =
     vec_elt_at_index (sm->per_thread_data, thread_index);
 
+  nat_free_session_flows (s, thread_index);
+
   if (is_fwd_bypass_session (s))
     {
       ed_key.l_addr = s->in2out.addr;
@@ -818,6 +847,8 @@ int snat_add_static_mapping(ip4_address_t l_addr, ip4_address_t e_addr,
   snat_session_t * s;
   snat_static_map_resolve_t *rp, *rp_match = 0;
 
+  ip4_flow_cache_invalidate ();
+
   if (!sm->endpoint_dependent)
     {
       if (twice_nat || out2in_only)
@@ -1241,6 +1272,8 @@ int nat44_add_del_lb_static_mapping (ip4_address_t e_addr, u16 e_port,
   if (!sm->endpoint_dependent)
     return VNET_API_ERROR_FEATURE_DISABLED;
 
+  ip4_flow_cache_invalidate ();
+
   m_key.addr = e_addr;
   m_key.port = e_port;
   m_key.protocol = proto;
@@ -1487,6 +1520,8 @@ snat_del_address (snat_main_t *sm, ip4_address_t addr, u8 delete_sm,
   int i;
   snat_address_t *addresses = twice_nat ? sm->twice_nat_addresses : sm->addresses;
 
+  ip4_flow_cache_invalidate ();
+
   /* Find SNAT address */
   for (i=0; i < vec_len (addresses); i++)
     {
@@ -3463,3 +3498,285 @@ nat_set_alloc_addr_and_port_default (void)
   sm->alloc_addr_and_port = nat_alloc_addr_and_port_default;
 }
 
+/*
+ * Warm restart snapshot: the NAT44 interfaces and address pools, and
+ * the dynamic endpoint-independent sessions with their outside ports,
+ * so established flows keep their translation across a restart.
+ * Sessions of static mappings come back with the same translation on
+ * their next packet and are not saved. Sessions stay on the thread
+ * which owned them, so they are restored only if the thread count and
+ * the port partitioning have not changed.
+ */
+static void
+nat44_snapshot_save_addresses (serialize_main_t * m, snat_address_t * as)
+{
+  snat_address_t *a;
+
+  serialize_likely_small_unsigned_integer (m, vec_len (as));
+  vec_foreach (a, as)
+    {
+      serialize_vnet_snapshot_data (m, &a->addr, sizeof (a->addr));
+      serialize_integer (m, (~0 == a->fib_index ? ~0 :
+                             fib_table_get_table_id (a->fib_index,
+                                                     FIB_PROTOCOL_IP4)),
+                         sizeof (u32));
+    }
+}
+
+static void
+nat44_snapshot_save_interfaces (serialize_main_t * m, snat_interface_t * is)
+{
+  snat_interface_t *i;
+
+  serialize_likely_small_unsigned_integer (m, pool_elts (is));
+  /* *INDENT-OFF* */
+  pool_foreach (i, is,
+  ({
+    serialize_vnet_snapshot_sw_if_index (m, i->sw_if_index);
+    serialize_integer (m, i->flags, sizeof (u8));
+  }));
+  /* *INDENT-ON* */
+}
+
+static void
+nat44_snapshot_save (serialize_main_t * m, va_list * va)
+{
+  snat_main_t *sm = &snat_main;
+  snat_main_per_thread_data_t *tsm;
+  snat_session_t *s, **ss = 0, **sp;
+  f64 now = vlib_time_now (sm->vlib_main);
+
+  nat44_snapshot_save_interfaces (m, sm->interfaces);
+  nat44_snapshot_save_interfaces (m, sm->output_feature_interfaces);
+  nat44_snapshot_save_addresses (m, sm->addresses);
+  nat44_snapshot_save_addresses (m, sm->twice_nat_addresses);
+
+  serialize_likely_small_unsigned_integer (m, vec_len (sm->per_thread_data));
+  serialize_integer (m, sm->port_per_thread, sizeof (u16));
+
+  vec_foreach (tsm, sm->per_thread_data)
+    {
+      vec_reset_length (ss);
+      if (!sm->endpoint_dependent && !sm->deterministic)
+        {
+          /* *INDENT-OFF* */
+          pool_foreach (s, tsm->sessions,
+          ({
+            if (!snat_is_session_static (s) && ~0 != s->outside_address_index)
+              vec_add1 (ss, s);
+          }));
+          /* *INDENT-ON* */
+        }
+
+      serialize_likely_small_unsigned_integer (m, vec_len (ss));
+      vec_foreach (sp, ss)
+        {
+          s = *sp;
+          serialize_integer (m, s->in2out.as_u64, sizeof (u64));
+          serialize_integer (m, fib_table_get_table_id (s->in2out.fib_index,
+                                                        FIB_PROTOCOL_IP4),
+                             sizeof (u32));
+          serialize_integer (m, s->out2in.as_u64, sizeof (u64));
+          serialize_integer (m, fib_table_get_table_id (s->out2in.fib_index,
+                                                        FIB_PROTOCOL_IP4),
+                             sizeof (u32));
+          serialize_integer (m, s->flags, sizeof (u32));
+          serialize_vnet_snapshot_data (m, &s->ext_host_addr,
+                                        sizeof (s->ext_host_addr));
+          serialize_integer (m, s->ext_host_port, sizeof (u16));
+          /* idle time in seconds, timeouts are whole seconds anyway */
+          serialize_integer (m, (u32) (now - s->last_heard), sizeof (u32));
+          serialize_integer (m, s->total_bytes, sizeof (u64));
+          serialize_integer (m, s->total_pkts, sizeof (u32));
+          serialize_integer (m, s->state, sizeof (u8));
+        }
+    }
+
+  vec_free (ss);
+}
+
+static void
+nat44_snapshot_restore_interfaces (serialize_main_t * m, u8 output_feature)
+{
+  u32 n, sw_if_index;
+  u8 flags;
+  int skip;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+      unserialize_integer (m, &flags, sizeof (u8));
+      if (skip)
+        continue;
+
+      /* an interface can be both inside and outside */
+      if (output_feature)
+        {
+          if (flags & NAT_INTERFACE_FLAG_IS_INSIDE)
+            snat_interface_add_del_output_feature (sw_if_index, 1, 0);
+          if (flags & NAT_INTERFACE_FLAG_IS_OUTSIDE)
+            snat_interface_add_del_output_feature (sw_if_index, 0, 0);
+        }
+      else
+        {
+          if (flags & NAT_INTERFACE_FLAG_IS_INSIDE)
+            snat_interface_add_del (sw_if_index, 1, 0);
+          if (flags & NAT_INTERFACE_FLAG_IS_OUTSIDE)
+            snat_interface_add_del (sw_if_index, 0, 0);
+        }
+    }
+}
+
+static void
+nat44_snapshot_restore_addresses (serialize_main_t * m, u8 twice_nat)
+{
+  snat_main_t *sm = &snat_main;
+  ip4_address_t addr;
+  u32 n, vrf_id;
+  int rv;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      unserialize_vnet_snapshot_data (m, &addr, sizeof (addr));
+      unserialize_integer (m, &vrf_id, sizeof (u32));
+      rv = snat_add_address (sm, &addr, vrf_id, twice_nat);
+      if (rv && VNET_API_ERROR_VALUE_EXIST != rv)
+        vnet_snapshot_skip ();
+    }
+}
+
+/**
+ * Take the outside port of a restored session out of the pool
+ */
+static int
+nat44_snapshot_reserve_port (snat_main_t * sm, snat_session_key_t * k,
+                             u32 thread_index, u32 * address_indexp)
+{
+  u16 port = clib_net_to_host_u16 (k->port);
+  snat_address_t *a;
+
+  vec_foreach (a, sm->addresses)
+    {
+      if (a->addr.as_u32 != k->addr.as_u32)
+        continue;
+
+      switch (k->protocol)
+        {
+#define _(N, i, n, s) \
+        case SNAT_PROTOCOL_##N: \
+          if (clib_bitmap_get_no_check (a->busy_##n##_port_bitmap, port)) \
+            return -1; \
+          clib_bitmap_set_no_check (a->busy_##n##_port_bitmap, port, 1); \
+          a->busy_##n##_ports_per_thread[thread_index]++; \
+          a->busy_##n##_ports++; \
+          break;
+          foreach_snat_protocol
+#undef _
+        default:
+          return -1;
+        }
+
+      *address_indexp = a - sm->addresses;
+      return 0;
+    }
+
+  return -1;
+}
+
+static void
+nat44_snapshot_restore (serialize_main_t * m, va_list * va)
+{
+  snat_main_t *sm = &snat_main;
+  snat_main_per_thread_data_t *tsm;
+  snat_session_key_t in2out, out2in;
+  clib_bihash_kv_8_8_t kv;
+  u32 n_threads, thread_index, n, table_id, fib_index, address_index;
+  u32 flags, total_pkts, age;
+  u16 port_per_thread, ext_host_port;
+  ip4_address_t ext_host_addr;
+  u64 total_bytes;
+  f64 now = vlib_time_now (sm->vlib_main);
+  snat_user_t *u;
+  snat_session_t *s;
+  u8 state;
+  int skip;
+
+  nat44_snapshot_restore_interfaces (m, 0);
+  nat44_snapshot_restore_interfaces (m, 1);
+  nat44_snapshot_restore_addresses (m, 0);
+  nat44_snapshot_restore_addresses (m, 1);
+
+  n_threads = unserialize_likely_small_unsigned_integer (m);
+  unserialize_integer (m, &port_per_thread, sizeof (u16));
+  skip = (n_threads != vec_len (sm->per_thread_data) ||
+          port_per_thread != sm->port_per_thread ||
+          sm->endpoint_dependent || sm->deterministic);
+
+  for (thread_index = 0; thread_index < n_threads; thread_index++)
+    {
+      n = unserialize_likely_small_unsigned_integer (m);
+      while (n--)
+        {
+          unserialize_integer (m, &in2out.as_u64, sizeof (u64));
+          unserialize_integer (m, &table_id, sizeof (u32));
+          fib_index = fib_table_find (FIB_PROTOCOL_IP4, table_id);
+          in2out.fib_index = fib_index;
+          unserialize_integer (m, &out2in.as_u64, sizeof (u64));
+          unserialize_integer (m, &table_id, sizeof (u32));
+          out2in.fib_index = fib_table_find (FIB_PROTOCOL_IP4, table_id);
+          fib_index |= out2in.fib_index;
+          unserialize_integer (m, &flags, sizeof (u32));
+          unserialize_vnet_snapshot_data (m, &ext_host_addr,
+                                          sizeof (ext_host_addr));
+          unserialize_integer (m, &ext_host_port, sizeof (u16));
+          unserialize_integer (m, &age, sizeof (u32));
+          unserialize_integer (m, &total_bytes, sizeof (u64));
+          unserialize_integer (m, &total_pkts, sizeof (u32));
+          unserialize_integer (m, &state, sizeof (u8));
+
+          if (skip || ~0 == fib_index ||
+              maximum_sessions_exceeded (sm, thread_index) ||
+              nat44_snapshot_reserve_port (sm, &out2in, thread_index,
+                                           &address_index))
+            {
+              vnet_snapshot_skip ();
+              continue;
+            }
+
+          tsm = vec_elt_at_index (sm->per_thread_data, thread_index);
+          u = nat_user_get_or_create (sm, &in2out.addr, in2out.fib_index,
+                                      thread_index);
+          s = nat_session_alloc_or_recycle (sm, u, thread_index);
+          user_session_increment (sm, u, 0);
+
+          s->in2out = in2out;
+          s->out2in = out2in;
+          s->flags = flags;
+          s->outside_address_index = address_index;
+          s->ext_host_addr = ext_host_addr;
+          s->ext_host_port = ext_host_port;
+          s->last_heard = now - age;
+          s->total_bytes = total_bytes;
+          s->total_pkts = total_pkts;
+          s->state = state;
+
+          kv.key = s->in2out.as_u64;
+          kv.value = s - tsm->sessions;
+          if (clib_bihash_add_del_8_8 (&tsm->in2out, &kv, 1 /* is_add */ ))
+            nat_log_notice ("in2out key add failed");
+          kv.key = s->out2in.as_u64;
+          if (clib_bihash_add_del_8_8 (&tsm->out2in, &kv, 1 /* is_add */ ))
+            nat_log_notice ("out2in key add failed");
+        }
+    }
+}
+
+/* *INDENT-OFF* */
+VNET_SNAPSHOT_SECTION (nat44, static) = {
+  .name = "nat44",
+  .save = nat44_snapshot_save,
+  .restore = nat44_snapshot_restore,
+};
+/* *INDENT-ON* */
@@ -648,27 +648,21 @@ snat_out2in_node_fn (vlib_main_t * vm,
 		  vlib_node_runtime_t * node,
 		  vlib_frame_t * frame)
 {
-  u32 n_left_from, * from, * to_next;
-  snat_out2in_next_t next_index;
+  u32 n_left_from, * from;
   u32 pkts_processed = 0;
   snat_main_t * sm = &snat_main;
   f64 now = vlib_time_now (vm);
   u32 thread_index = vm->thread_index;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
-  next_index = node->cached_next_index;
-
-  while (n_left_from > 0)
-    {
-      u32 n_left_to_next;
+  next = nexts;
+  vlib_get_buffers (vm, from, bufs, n_left_from);
 
-      vlib_get_next_frame (vm, node, next_index,
-			   to_next, n_left_to_next);
-
-      while (n_left_from >= 4 && n_left_to_next >= 2)
+      while (n_left_from >= 4)
 	{
-          u32 bi0, bi1;
 	  vlib_buffer_t * b0, * b1;
           u32 next0 = SNAT_OUT2IN_NEXT_LOOKUP;
           u32 next1 = SNAT_OUT2IN_NEXT_LOOKUP;
@@ -689,29 +683,14 @@ snat_out2in_node_fn (vlib_main_t * vm,
           clib_bihash_kv_8_8_t kv0, kv1, value0, value1;
 
 	  /* Prefetch next iteration. */
-	  {
-	    vlib_buffer_t * p2, * p3;
+	  vlib_prefetch_buffer_header (b[2], LOAD);
+	  vlib_prefetch_buffer_header (b[3], LOAD);
 
-	    p2 = vlib_get_buffer (vm, from[2]);
-	    p3 = vlib_get_buffer (vm, from[3]);
-
-	    vlib_prefetch_buffer_header (p2, LOAD);
-	    vlib_prefetch_buffer_header (p3, LOAD);
-
-	    CLIB_PREFETCH (p2->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p3->data, CLIB_CACHE_LINE_BYTES, STORE);
-	  }
-
-          /* speculatively enqueue b0 and b1 to the current next frame */
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  from += 2;
-	  to_next += 2;
-	  n_left_from -= 2;
-	  n_left_to_next -= 2;
+	  CLIB_PREFETCH (b[2]->data, CLIB_CACHE_LINE_BYTES, STORE);
+	  CLIB_PREFETCH (b[3]->data, CLIB_CACHE_LINE_BYTES, STORE);
 
-	  b0 = vlib_get_buffer (vm, bi0);
-	  b1 = vlib_get_buffer (vm, bi1);
+	  b0 = b[0];
+	  b1 = b[1];
 
           vnet_buffer (b0)->snat.flags = 0;
           vnet_buffer (b1)->snat.flags = 0;
@@ -1019,15 +998,16 @@ snat_out2in_node_fn (vlib_main_t * vm,
 
           pkts_processed += next1 != SNAT_OUT2IN_NEXT_DROP;
 
-          /* verify speculative enqueues, maybe switch current next frame */
-          vlib_validate_buffer_enqueue_x2 (vm, node, next_index,
-                                           to_next, n_left_to_next,
-                                           bi0, bi1, next0, next1);
+          next[0] = next0;
+          next[1] = next1;
+
+          b += 2;
+          next += 2;
+          n_left_from -= 2;
         }
 
-      while (n_left_from > 0 && n_left_to_next > 0)
+      while (n_left_from > 0)
 	{
-          u32 bi0;
 	  vlib_buffer_t * b0;
           u32 next0 = SNAT_OUT2IN_NEXT_LOOKUP;
           u32 sw_if_index0;
@@ -1044,15 +1024,7 @@ snat_out2in_node_fn (vlib_main_t * vm,
           snat_session_t * s0 = 0;
           clib_bihash_kv_8_8_t kv0, value0;
 
-          /* speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
+	  b0 = b[0];
 
           vnet_buffer (b0)->snat.flags = 0;
 
@@ -1207,14 +1179,14 @@ snat_out2in_node_fn (vlib_main_t * vm,
 
           pkts_processed += next0 != SNAT_OUT2IN_NEXT_DROP;
 
-          /* verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, next0);
+          next[0] = next0;
+
+          b += 1;
+          next += 1;
+          n_left_from -= 1;
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
-    }
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
 
   vlib_node_increment_counter (vm, snat_out2in_node.index,
                                SNAT_OUT2IN_ERROR_OUT2IN_PACKETS,
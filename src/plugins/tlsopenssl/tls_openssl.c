@@ -53,6 +53,13 @@ openssl_ctx_free (tls_ctx_t * ctx)
 {
   openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
 
+  /* openssl's record sequence numbers are stale once offloaded */
+  if (oc->record_offload)
+    {
+      SSL_set_quiet_shutdown (oc->ssl, 1);
+      openssl_record_offload_free (oc);
+    }
+
   if (SSL_is_init_finished (oc->ssl) && !ctx->is_passive_close)
     SSL_shutdown (oc->ssl);
 
@@ -224,6 +231,10 @@ openssl_ctx_handshake_rx (tls_ctx_t * ctx, stream_session_t * tls_session)
   if (SSL_in_init (oc->ssl))
     return 0;
 
+  if (openssl_main.record_offload && !openssl_main.async
+      && !openssl_record_offload_enable (oc))
+    openssl_main.record_offloaded[oc->ctx.c_thread_index]++;
+
   /*
    * Handshake complete
    */
@@ -253,11 +264,80 @@ openssl_ctx_handshake_rx (tls_ctx_t * ctx, stream_session_t * tls_session)
       tls_notify_app_accept (ctx);
     }
 
+  /* Records that arrived with the peer's Finished */
+  if (vec_len (oc->rec_carry))
+    tls_add_vpp_q_evt (tls_session->server_rx_fifo, FIFO_EVENT_BUILTIN_RX);
+
   TLS_DBG (1, "Handshake for %u complete. TLS cipher is %s",
 	   oc->openssl_ctx_index, SSL_get_cipher (oc->ssl));
   return rv;
 }
 
+static int
+openssl_ctx_write_offload (tls_ctx_t * ctx, stream_session_t * app_session)
+{
+  openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
+  stream_session_t *tls_session;
+  svm_fifo_t *f;
+  int wrote;
+
+  tls_session = session_get_from_handle (ctx->tls_session_handle);
+  f = tls_session->server_tx_fifo;
+
+  /* Anything openssl queued before the switch must go out first */
+  if (PREDICT_FALSE (BIO_ctrl_pending (oc->rbio) > 0))
+    {
+      openssl_try_handshake_write (oc, tls_session);
+      if (BIO_ctrl_pending (oc->rbio) > 0)
+	{
+	  tls_add_vpp_q_evt (app_session->server_tx_fifo, FIFO_EVENT_APP_TX);
+	  return 0;
+	}
+    }
+
+  wrote = openssl_record_write (oc, app_session->server_tx_fifo, f,
+				openssl_main.record_bufs[ctx->c_thread_index]);
+  if (PREDICT_FALSE (wrote < 0))
+    {
+      stream_session_disconnect (tls_session);
+      return 0;
+    }
+
+  if (wrote)
+    tls_add_vpp_q_evt (f, FIFO_EVENT_APP_TX);
+  if (svm_fifo_max_dequeue (app_session->server_tx_fifo))
+    tls_add_vpp_q_evt (app_session->server_tx_fifo, FIFO_EVENT_APP_TX);
+
+  return wrote;
+}
+
+static int
+openssl_ctx_read_offload (tls_ctx_t * ctx, stream_session_t * tls_session)
+{
+  openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
+  stream_session_t *app_session;
+  int read;
+  u8 is_full;
+
+  app_session = session_get_from_handle (ctx->app_session_handle);
+  read = openssl_record_read (oc, tls_session->server_rx_fifo,
+			      app_session->server_rx_fifo,
+			      openssl_main.record_bufs[ctx->c_thread_index],
+			      &is_full);
+  if (PREDICT_FALSE (read < 0))
+    {
+      stream_session_disconnect (tls_session);
+      return 0;
+    }
+
+  if (read)
+    tls_notify_app_enqueue (ctx, app_session);
+  if (is_full)
+    tls_add_vpp_q_evt (tls_session->server_rx_fifo, FIFO_EVENT_BUILTIN_RX);
+
+  return read;
+}
+
 static inline int
 openssl_ctx_write (tls_ctx_t * ctx, stream_session_t * app_session)
 {
@@ -267,6 +347,9 @@ openssl_ctx_write (tls_ctx_t * ctx, stream_session_t * app_session)
   stream_session_t *tls_session;
   svm_fifo_t *f;
 
+  if (oc->record_offload)
+    return openssl_ctx_write_offload (ctx, app_session);
+
   f = app_session->server_tx_fifo;
   deq_max = svm_fifo_max_dequeue (f);
   if (!deq_max)
@@ -351,6 +434,9 @@ openssl_ctx_read (tls_ctx_t * ctx, stream_session_t * tls_session)
       return 0;
     }
 
+  if (oc->record_offload)
+    return openssl_ctx_read_offload (ctx, tls_session);
+
   f = tls_session->server_rx_fifo;
   deq_max = svm_fifo_max_dequeue (f);
   max_space = max_buf - BIO_ctrl_pending (oc->wbio);
@@ -459,6 +545,11 @@ openssl_ctx_init_client (tls_ctx_t * ctx)
     }
 
   SSL_CTX_set_options (oc->ssl_ctx, flags);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  /* The native record layer only does TLS 1.2 */
+  if (om->record_offload)
+    SSL_CTX_set_max_proto_version (oc->ssl_ctx, TLS1_2_VERSION);
+#endif
   SSL_CTX_set_cert_store (oc->ssl_ctx, om->cert_store);
 
   oc->ssl = SSL_new (oc->ssl_ctx);
@@ -519,13 +610,13 @@ openssl_ctx_init_server (tls_ctx_t * ctx)
   char *ciphers = "ALL:!ADH:!LOW:!EXP:!MD5:!RC4-SHA:!DES-CBC3-SHA:@STRENGTH";
   long flags = SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3 | SSL_OP_NO_COMPRESSION;
   openssl_ctx_t *oc = (openssl_ctx_t *) ctx;
+  openssl_main_t *om = &openssl_main;
   stream_session_t *tls_session;
   const SSL_METHOD *method;
   application_t *app;
   int rv, err;
   BIO *cert_bio;
 #ifdef HAVE_OPENSSL_ASYNC
-  openssl_main_t *om = &openssl_main;
   openssl_resume_handler *handler;
 #endif
 
@@ -551,6 +642,10 @@ openssl_ctx_init_server (tls_ctx_t * ctx)
     SSL_CTX_set_mode (oc->ssl_ctx, SSL_MODE_ASYNC);
 #endif
   SSL_CTX_set_options (oc->ssl_ctx, flags);
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  if (om->record_offload)
+    SSL_CTX_set_max_proto_version (oc->ssl_ctx, TLS1_2_VERSION);
+#endif
   SSL_CTX_set_ecdh_auto (oc->ssl_ctx, 1);
 
   rv = SSL_CTX_set_cipher_list (oc->ssl_ctx, (const char *) ciphers);
@@ -702,7 +797,7 @@ tls_openssl_init (vlib_main_t * vm)
   vlib_thread_main_t *vtm = vlib_get_thread_main ();
   openssl_main_t *om = &openssl_main;
   clib_error_t *error;
-  u32 num_threads;
+  u32 num_threads, i;
 
   num_threads = 1 /* main thread */  + vtm->n_threads;
 
@@ -719,6 +814,10 @@ tls_openssl_init (vlib_main_t * vm)
     }
 
   vec_validate (om->ctx_pool, num_threads - 1);
+  vec_validate (om->record_bufs, num_threads - 1);
+  vec_validate (om->record_offloaded, num_threads - 1);
+  for (i = 0; i < num_threads; i++)
+    vec_validate (om->record_bufs[i], TLS_RECORD_BOUNCE_SIZE - 1);
 
   tls_register_engine (&openssl_engine, TLS_ENGINE_OPENSSL);
 
@@ -795,6 +894,77 @@ VLIB_CLI_COMMAND (tls_openssl_set_command, static) =
 /* *INDENT-ON* */
 #endif
 
+static clib_error_t *
+tls_openssl_record_offload_command_fn (vlib_main_t * vm,
+				       unformat_input_t * input,
+				       vlib_cli_command_t * cmd)
+{
+  openssl_main_t *om = &openssl_main;
+  u8 enable = 1;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "enable"))
+	enable = 1;
+      else if (unformat (input, "disable"))
+	enable = 0;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (enable && om->async)
+    return clib_error_return (0, "record offload can't be used with an "
+			      "async engine");
+
+  /* Only affects sessions that complete their handshake from now on */
+  om->record_offload = enable;
+  return 0;
+}
+
+/*?
+ * Process the records of TLS 1.2 AES-GCM sessions in the openssl engine
+ * itself, encrypting and decrypting directly between the app and tls
+ * fifos. Handshakes and other ciphers still go through openssl. While
+ * enabled, new sessions don't negotiate anything above TLS 1.2.
+ *
+ * @cliexpar
+ * @cliexcmd{tls openssl record-offload enable}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (tls_openssl_record_offload_command, static) =
+{
+  .path = "tls openssl record-offload",
+  .short_help = "tls openssl record-offload [enable|disable]",
+  .function = tls_openssl_record_offload_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+show_tls_openssl_record_offload_command_fn (vlib_main_t * vm,
+					    unformat_input_t * input,
+					    vlib_cli_command_t * cmd)
+{
+  openssl_main_t *om = &openssl_main;
+  u64 n_offloaded = 0;
+  int i;
+
+  for (i = 0; i < vec_len (om->record_offloaded); i++)
+    n_offloaded += om->record_offloaded[i];
+
+  vlib_cli_output (vm, "record offload %s, %llu sessions offloaded",
+		   om->record_offload ? "enabled" : "disabled", n_offloaded);
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_tls_openssl_record_offload_command, static) =
+{
+  .path = "show tls openssl record-offload",
+  .short_help = "show tls openssl record-offload",
+  .function = show_tls_openssl_record_offload_command_fn,
+};
+/* *INDENT-ON* */
 
 VLIB_INIT_FUNCTION (tls_openssl_init);
 
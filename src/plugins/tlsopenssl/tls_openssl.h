@@ -21,6 +21,23 @@
 #include <vpp/app/version.h>
 #include <vnet/tls/tls.h>
 
+#define TLS_RECORD_HDR_LEN	5
+#define TLS_RECORD_NONCE_LEN	8
+#define TLS_RECORD_TAG_LEN	16
+#define TLS_RECORD_OVERHEAD \
+  (TLS_RECORD_HDR_LEN + TLS_RECORD_NONCE_LEN + TLS_RECORD_TAG_LEN)
+#define TLS_RECORD_MAX_PLAIN	(1 << 14)
+/* Room for one plaintext and one full ciphertext record */
+#define TLS_RECORD_BOUNCE_SIZE \
+  (2 * TLS_RECORD_MAX_PLAIN + TLS_RECORD_OVERHEAD)
+
+typedef struct openssl_record_dir_
+{
+  EVP_CIPHER_CTX *evp;
+  u8 salt[4];			/**< implicit part of the gcm nonce */
+  u64 seq;
+} openssl_record_dir_t;
+
 typedef struct tls_ctx_openssl_
 {
   tls_ctx_t ctx;			/**< First */
@@ -31,6 +48,12 @@ typedef struct tls_ctx_openssl_
   BIO *wbio;
   X509 *srvcert;
   EVP_PKEY *pkey;
+
+  /* Native record layer, see tls_record.c */
+  u8 record_offload;
+  openssl_record_dir_t rec_tx;
+  openssl_record_dir_t rec_rx;
+  u8 *rec_carry;
 } openssl_ctx_t;
 
 typedef struct openssl_main_
@@ -40,6 +63,10 @@ typedef struct openssl_main_
   X509_STORE *cert_store;
   int engine_init;
   int async;
+
+  int record_offload;
+  u8 **record_bufs;
+  u64 *record_offloaded;	/**< per thread count of offloaded sessions */
 } openssl_main_t;
 
 typedef struct openssl_tls_callback_
@@ -59,6 +86,17 @@ void openssl_polling_start (ENGINE * engine);
 int openssl_engine_register (char *engine, char *alg);
 void openssl_async_node_enable_disable (u8 is_en);
 
+int openssl_record_prf (const EVP_MD * md, u8 * secret, u32 secret_len,
+			u8 * seed, u32 seed_len, u8 * out, u32 out_len);
+int openssl_record_dir_init (openssl_record_dir_t * rd, const EVP_CIPHER * c,
+			     u8 * key, u8 * salt, int is_enc);
+int openssl_record_offload_enable (openssl_ctx_t * oc);
+void openssl_record_offload_free (openssl_ctx_t * oc);
+int openssl_record_write (openssl_ctx_t * oc, svm_fifo_t * app_fifo,
+			  svm_fifo_t * tls_fifo, u8 * bounce);
+int openssl_record_read (openssl_ctx_t * oc, svm_fifo_t * tls_fifo,
+			 svm_fifo_t * app_fifo, u8 * bounce, u8 * is_full);
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
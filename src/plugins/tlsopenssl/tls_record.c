@@ -0,0 +1,443 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief TLS 1.2 AES-GCM record layer for the openssl engine
+ *
+ * Once openssl completes the handshake, sessions that negotiated an AES-GCM
+ * suite can have their application records processed here instead of going
+ * through SSL_write/SSL_read and the memory BIOs. Plaintext is encrypted
+ * straight out of the app tx fifo into the tls tx fifo and ciphertext is
+ * decrypted straight out of the tls rx fifo into the app rx fifo. A bounce
+ * buffer is only used when a record wraps around the end of a fifo.
+ */
+
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <tlsopenssl/tls_openssl.h>
+
+#define TLS_RECORD_TYPE_DATA	23
+
+/**
+ * TLS 1.2 PRF (RFC5246 section 5). The label is expected at the start of
+ * the seed. Returns 0 on success, -1 on error.
+ */
+int
+openssl_record_prf (const EVP_MD * md, u8 * secret, u32 secret_len,
+		    u8 * seed, u32 seed_len, u8 * out, u32 out_len)
+{
+  u8 a[EVP_MAX_MD_SIZE], buf[EVP_MAX_MD_SIZE];
+  u8 tmp[EVP_MAX_MD_SIZE + 128];
+  unsigned int a_len, buf_len;
+  u32 n;
+
+  if (seed_len > 128)
+    return -1;
+
+  /* P_hash from RFC5246 section 5: A(1) = HMAC (secret, seed) */
+  if (!HMAC (md, secret, secret_len, seed, seed_len, a, &a_len))
+    return -1;
+
+  while (out_len)
+    {
+      clib_memcpy (tmp, a, a_len);
+      clib_memcpy (tmp + a_len, seed, seed_len);
+      if (!HMAC (md, secret, secret_len, tmp, a_len + seed_len, buf,
+		 &buf_len))
+	return -1;
+      n = clib_min (buf_len, out_len);
+      clib_memcpy (out, buf, n);
+      out += n;
+      out_len -= n;
+
+      clib_memcpy (tmp, a, a_len);
+      if (!HMAC (md, secret, secret_len, tmp, a_len, a, &a_len))
+	return -1;
+    }
+
+  OPENSSL_cleanse (tmp, sizeof (tmp));
+  OPENSSL_cleanse (buf, sizeof (buf));
+  return 0;
+}
+
+int
+openssl_record_dir_init (openssl_record_dir_t * rd, const EVP_CIPHER * c,
+			 u8 * key, u8 * salt, int is_enc)
+{
+  rd->evp = EVP_CIPHER_CTX_new ();
+  if (!rd->evp)
+    return -1;
+  if (EVP_CipherInit_ex (rd->evp, c, NULL, key, NULL, is_enc) != 1)
+    return -1;
+  clib_memcpy (rd->salt, salt, sizeof (rd->salt));
+
+  /* The Finished message was record 0 in both directions */
+  rd->seq = 1;
+  return 0;
+}
+
+void
+openssl_record_offload_free (openssl_ctx_t * oc)
+{
+  EVP_CIPHER_CTX_free (oc->rec_tx.evp);
+  EVP_CIPHER_CTX_free (oc->rec_rx.evp);
+  oc->rec_tx.evp = oc->rec_rx.evp = 0;
+  vec_free (oc->rec_carry);
+  oc->record_offload = 0;
+}
+
+/**
+ * Take over the record layer of a session that just completed its
+ * handshake. Returns 0 if the session is now offloaded, -1 if it must
+ * stay on the openssl record path.
+ */
+int
+openssl_record_offload_enable (openssl_ctx_t * oc)
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+  u8 seed[13 + 2 * SSL3_RANDOM_SIZE], master[SSL_MAX_MASTER_KEY_LENGTH];
+  u8 key_block[2 * 32 + 2 * 4];
+  u8 *client_key, *server_key, *client_salt, *server_salt;
+  const EVP_CIPHER *cipher;
+  const EVP_MD *md;
+  u32 master_len, key_len;
+  int is_server, pending, rv = -1;
+
+  if (SSL_version (oc->ssl) != TLS1_2_VERSION)
+    return -1;
+
+  switch (SSL_CIPHER_get_cipher_nid (SSL_get_current_cipher (oc->ssl)))
+    {
+    case NID_aes_128_gcm:
+      cipher = EVP_aes_128_gcm ();
+      md = EVP_sha256 ();
+      key_len = 16;
+      break;
+    case NID_aes_256_gcm:
+      cipher = EVP_aes_256_gcm ();
+      md = EVP_sha384 ();
+      key_len = 32;
+      break;
+    default:
+      return -1;
+    }
+
+  /* Plaintext openssl already decrypted must be read through openssl */
+  if (SSL_pending (oc->ssl))
+    return -1;
+
+  master_len = SSL_SESSION_get_master_key (SSL_get_session (oc->ssl),
+					   master, sizeof (master));
+  if (!master_len)
+    return -1;
+
+  clib_memcpy (seed, "key expansion", 13);
+  SSL_get_server_random (oc->ssl, seed + 13, SSL3_RANDOM_SIZE);
+  SSL_get_client_random (oc->ssl, seed + 13 + SSL3_RANDOM_SIZE,
+			 SSL3_RANDOM_SIZE);
+  if (openssl_record_prf (md, master, master_len, seed, sizeof (seed),
+			  key_block, 2 * key_len + 2 * 4))
+    goto done;
+
+  client_key = key_block;
+  server_key = key_block + key_len;
+  client_salt = key_block + 2 * key_len;
+  server_salt = client_salt + 4;
+  is_server = SSL_is_server (oc->ssl);
+
+  if (openssl_record_dir_init (&oc->rec_tx, cipher,
+			       is_server ? server_key : client_key,
+			       is_server ? server_salt : client_salt, 1)
+      || openssl_record_dir_init (&oc->rec_rx, cipher,
+				  is_server ? client_key : server_key,
+				  is_server ? client_salt : server_salt, 0))
+    {
+      openssl_record_offload_free (oc);
+      goto done;
+    }
+
+  /* Ciphertext handed to openssl but not consumed by the handshake, e.g.
+   * a request sent right behind the client Finished */
+  pending = BIO_ctrl_pending (oc->wbio);
+  if (pending > 0)
+    {
+      vec_validate (oc->rec_carry, pending - 1);
+      BIO_read (oc->wbio, oc->rec_carry, pending);
+    }
+
+  oc->record_offload = 1;
+  rv = 0;
+
+done:
+  OPENSSL_cleanse (master, sizeof (master));
+  OPENSSL_cleanse (key_block, sizeof (key_block));
+  return rv;
+#else
+  return -1;
+#endif
+}
+
+static inline int
+openssl_record_crypt (openssl_record_dir_t * rd, u8 type, u8 * explicit,
+		      u8 * in, u8 * out, u32 len, u8 * tag, int is_enc)
+{
+  u8 nonce[12], aad[13];
+  u64 seq = clib_host_to_net_u64 (rd->seq);
+  int outl;
+
+  clib_memcpy (nonce, rd->salt, 4);
+  clib_memcpy (nonce + 4, explicit, TLS_RECORD_NONCE_LEN);
+  clib_memcpy (aad, &seq, sizeof (seq));
+  aad[8] = type;
+  aad[9] = 3;
+  aad[10] = 3;
+  aad[11] = len >> 8;
+  aad[12] = len & 0xff;
+
+  if (EVP_CipherInit_ex (rd->evp, NULL, NULL, NULL, nonce, -1) != 1)
+    return -1;
+  if (!is_enc && EVP_CIPHER_CTX_ctrl (rd->evp, EVP_CTRL_GCM_SET_TAG,
+				      TLS_RECORD_TAG_LEN, tag) != 1)
+    return -1;
+  if (EVP_CipherUpdate (rd->evp, NULL, &outl, aad, sizeof (aad)) != 1
+      || EVP_CipherUpdate (rd->evp, out, &outl, in, len) != 1
+      || EVP_CipherFinal_ex (rd->evp, out + outl, &outl) != 1)
+    return -1;
+  if (is_enc && EVP_CIPHER_CTX_ctrl (rd->evp, EVP_CTRL_GCM_GET_TAG,
+				     TLS_RECORD_TAG_LEN, tag) != 1)
+    return -1;
+
+  rd->seq++;
+  return 0;
+}
+
+/**
+ * Encrypt as many records as fit from the app tx fifo into the tls tx
+ * fifo. Returns the number of plaintext bytes consumed or -1 on error.
+ */
+int
+openssl_record_write (openssl_ctx_t * oc, svm_fifo_t * app_fifo,
+		      svm_fifo_t * tls_fifo, u8 * bounce)
+{
+  u32 deq_max, enq_max, plen, rec_len, wrote = 0;
+  u64 seq;
+  u8 *rec;
+
+  deq_max = svm_fifo_max_dequeue (app_fifo);
+  enq_max = svm_fifo_max_enqueue (tls_fifo);
+
+  while (deq_max && enq_max > TLS_RECORD_OVERHEAD)
+    {
+      /* End the record where the plaintext wraps instead of copying it */
+      plen = clib_min (deq_max, TLS_RECORD_MAX_PLAIN);
+      plen = clib_min (plen, enq_max - TLS_RECORD_OVERHEAD);
+      plen = clib_min (plen, svm_fifo_max_read_chunk (app_fifo));
+      rec_len = plen + TLS_RECORD_OVERHEAD;
+
+      if (svm_fifo_max_write_chunk (tls_fifo) >= rec_len)
+	rec = svm_fifo_tail (tls_fifo);
+      else
+	rec = bounce;
+
+      rec[0] = TLS_RECORD_TYPE_DATA;
+      rec[1] = 3;
+      rec[2] = 3;
+      rec[3] = (rec_len - TLS_RECORD_HDR_LEN) >> 8;
+      rec[4] = (rec_len - TLS_RECORD_HDR_LEN) & 0xff;
+      seq = clib_host_to_net_u64 (oc->rec_tx.seq);
+      clib_memcpy (rec + TLS_RECORD_HDR_LEN, &seq, sizeof (seq));
+
+      if (openssl_record_crypt (&oc->rec_tx, TLS_RECORD_TYPE_DATA,
+				rec + TLS_RECORD_HDR_LEN,
+				svm_fifo_head (app_fifo),
+				rec + TLS_RECORD_HDR_LEN + TLS_RECORD_NONCE_LEN,
+				plen, rec + rec_len - TLS_RECORD_TAG_LEN, 1))
+	return -1;
+
+      if (rec == bounce)
+	svm_fifo_enqueue_nowait (tls_fifo, rec_len, rec);
+      else
+	svm_fifo_enqueue_nocopy (tls_fifo, rec_len);
+      svm_fifo_dequeue_drop (app_fifo, plen);
+
+      wrote += plen;
+      deq_max -= plen;
+      enq_max -= rec_len;
+    }
+
+  return wrote;
+}
+
+/**
+ * Decrypt one complete record. Returns the number of plaintext bytes
+ * enqueued to the app fifo, 0 if the app fifo has no room for it or -1
+ * if the session must be torn down.
+ */
+static int
+openssl_record_decrypt_one (openssl_ctx_t * oc, u8 * rec, u32 rec_len,
+			    svm_fifo_t * app_fifo, u8 * bounce)
+{
+  u32 plen = rec_len - TLS_RECORD_OVERHEAD;
+  u8 *out;
+
+  /* close_notify or an error alert, either way we're done. Renegotiation
+   * or any other post-handshake message isn't supported */
+  if (PREDICT_FALSE (rec[0] != TLS_RECORD_TYPE_DATA))
+    return -1;
+
+  if (svm_fifo_max_enqueue (app_fifo) < plen)
+    return 0;
+
+  if (svm_fifo_max_write_chunk (app_fifo) >= plen)
+    out = svm_fifo_tail (app_fifo);
+  else
+    out = bounce;
+
+  /* Nothing is visible to the app until the tag checks out and the
+   * tail is moved */
+  if (openssl_record_crypt (&oc->rec_rx, TLS_RECORD_TYPE_DATA,
+			    rec + TLS_RECORD_HDR_LEN,
+			    rec + TLS_RECORD_HDR_LEN + TLS_RECORD_NONCE_LEN,
+			    out, plen, rec + rec_len - TLS_RECORD_TAG_LEN, 0))
+    return -1;
+
+  if (out == bounce)
+    svm_fifo_enqueue_nowait (app_fifo, plen, out);
+  else
+    svm_fifo_enqueue_nocopy (app_fifo, plen);
+
+  /* Zero length records are legal, don't report them as a stall */
+  return plen ? plen : 1;
+}
+
+static inline int
+openssl_record_len (u8 * hdr)
+{
+  int rec_len = TLS_RECORD_HDR_LEN + ((hdr[3] << 8) | hdr[4]);
+
+  if (rec_len < TLS_RECORD_OVERHEAD
+      || rec_len > TLS_RECORD_OVERHEAD + TLS_RECORD_MAX_PLAIN)
+    return -1;
+  return rec_len;
+}
+
+static int
+openssl_record_read_carry (openssl_ctx_t * oc, svm_fifo_t * tls_fifo,
+			   svm_fifo_t * app_fifo, u8 * bounce)
+{
+  u32 have, need, read = 0;
+  int rec_len, rv, n;
+
+  while ((have = vec_len (oc->rec_carry)))
+    {
+      rec_len = TLS_RECORD_HDR_LEN;
+      if (have >= TLS_RECORD_HDR_LEN
+	  && (rec_len = openssl_record_len (oc->rec_carry)) < 0)
+	return -1;
+
+      /* Complete the record at the head of the carry from the fifo */
+      if (have < rec_len)
+	{
+	  need = rec_len - have;
+	  vec_validate (oc->rec_carry, rec_len - 1);
+	  n = svm_fifo_dequeue_nowait (tls_fifo, need, oc->rec_carry + have);
+	  n = clib_max (n, 0);
+	  _vec_len (oc->rec_carry) = have + n;
+	  if (n < need)
+	    break;
+	  continue;
+	}
+
+      rv = openssl_record_decrypt_one (oc, oc->rec_carry, rec_len, app_fifo,
+				       bounce);
+      if (rv <= 0)
+	return rv < 0 ? rv : read;
+      read += rv;
+      vec_delete (oc->rec_carry, rec_len, 0);
+    }
+
+  return read;
+}
+
+/**
+ * Decrypt all complete records in the tls rx fifo the app rx fifo has
+ * room for. Returns the number of plaintext bytes enqueued or -1 if the
+ * session must be torn down. Sets is_full if records were left behind
+ * for lack of app fifo space.
+ */
+int
+openssl_record_read (openssl_ctx_t * oc, svm_fifo_t * tls_fifo,
+		     svm_fifo_t * app_fifo, u8 * bounce, u8 * is_full)
+{
+  u32 deq_max, read = 0;
+  u8 hdr[TLS_RECORD_HDR_LEN], *rec;
+  int rec_len, rv;
+
+  *is_full = 0;
+
+  if (PREDICT_FALSE (vec_len (oc->rec_carry) != 0))
+    {
+      rv = openssl_record_read_carry (oc, tls_fifo, app_fifo, bounce);
+      if (rv < 0 || vec_len (oc->rec_carry))
+	{
+	  *is_full = rv >= 0 && svm_fifo_max_enqueue (app_fifo) == 0;
+	  return rv;
+	}
+      read = rv;
+    }
+
+  deq_max = svm_fifo_max_dequeue (tls_fifo);
+  while (deq_max >= TLS_RECORD_HDR_LEN)
+    {
+      svm_fifo_peek (tls_fifo, 0, TLS_RECORD_HDR_LEN, hdr);
+      if ((rec_len = openssl_record_len (hdr)) < 0)
+	return -1;
+      if (deq_max < rec_len)
+	break;
+
+      if (svm_fifo_max_read_chunk (tls_fifo) >= rec_len)
+	rec = svm_fifo_head (tls_fifo);
+      else
+	{
+	  /* Ciphertext bounce goes after the plaintext bounce */
+	  rec = bounce + TLS_RECORD_MAX_PLAIN;
+	  svm_fifo_peek (tls_fifo, 0, rec_len, rec);
+	}
+
+      rv = openssl_record_decrypt_one (oc, rec, rec_len, app_fifo, bounce);
+      if (rv < 0)
+	return -1;
+      if (rv == 0)
+	{
+	  *is_full = 1;
+	  break;
+	}
+
+      svm_fifo_dequeue_drop (tls_fifo, rec_len);
+      deq_max -= rec_len;
+      read += rv;
+    }
+
+  return read;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Known answer tests for the native TLS 1.2 record layer
+ *
+ * The PRF vectors are the widely used TLS 1.2 P_SHA256/P_SHA384 vectors.
+ * The records were generated with an independent AES-GCM implementation,
+ * itself checked against test cases 4 and 16 of the GCM specification,
+ * using the RFC5246 section 6.2.3.3 nonce and additional data layout.
+ */
+
+#include <openssl/evp.h>
+#include <tlsopenssl/tls_openssl.h>
+
+#define TLS_TEST_I(_cond, _comment, _args...)			\
+({								\
+  int _evald = (_cond);						\
+  if (!(_evald)) {						\
+    fformat(stderr, "FAIL:%d: " _comment "\n",			\
+	    __LINE__, ##_args);					\
+  } else {							\
+    fformat(stderr, "PASS:%d: " _comment "\n",			\
+	    __LINE__, ##_args);					\
+  }								\
+  _evald;							\
+})
+
+#define TLS_TEST(_cond, _comment, _args...)			\
+{								\
+    if (!TLS_TEST_I(_cond, _comment, ##_args)) {		\
+	return 1;                                               \
+    }								\
+}
+
+/* *INDENT-OFF* */
+static u8 tls_test_prf_sha256_secret[] = {
+  0x9b, 0xbe, 0x43, 0x6b, 0xa9, 0x40, 0xf0, 0x17,
+  0xb1, 0x76, 0x52, 0x84, 0x9a, 0x71, 0xdb, 0x35,
+};
+
+static u8 tls_test_prf_sha256_seed[] = {
+  0xa0, 0xba, 0x9f, 0x93, 0x6c, 0xda, 0x31, 0x18,
+  0x27, 0xa6, 0xf7, 0x96, 0xff, 0xd5, 0x19, 0x8c,
+};
+
+static u8 tls_test_prf_sha256_out[] = {
+  0xe3, 0xf2, 0x29, 0xba, 0x72, 0x7b, 0xe1, 0x7b, 0x8d, 0x12, 0x26, 0x20,
+  0x55, 0x7c, 0xd4, 0x53, 0xc2, 0xaa, 0xb2, 0x1d, 0x07, 0xc3, 0xd4, 0x95,
+  0x32, 0x9b, 0x52, 0xd4, 0xe6, 0x1e, 0xdb, 0x5a, 0x6b, 0x30, 0x17, 0x91,
+  0xe9, 0x0d, 0x35, 0xc9, 0xc9, 0xa4, 0x6b, 0x4e, 0x14, 0xba, 0xf9, 0xaf,
+  0x0f, 0xa0, 0x22, 0xf7, 0x07, 0x7d, 0xef, 0x17, 0xab, 0xfd, 0x37, 0x97,
+  0xc0, 0x56, 0x4b, 0xab, 0x4f, 0xbc, 0x91, 0x66, 0x6e, 0x9d, 0xef, 0x9b,
+  0x97, 0xfc, 0xe3, 0x4f, 0x79, 0x67, 0x89, 0xba, 0xa4, 0x80, 0x82, 0xd1,
+  0x22, 0xee, 0x42, 0xc5, 0xa7, 0x2e, 0x5a, 0x51, 0x10, 0xff, 0xf7, 0x01,
+  0x87, 0x34, 0x7b, 0x66,
+};
+
+static u8 tls_test_prf_sha384_secret[] = {
+  0xb8, 0x0b, 0x73, 0x3d, 0x6c, 0xee, 0xfc, 0xdc,
+  0x71, 0x56, 0x6e, 0xa4, 0x8e, 0x55, 0x67, 0xdf,
+};
+
+static u8 tls_test_prf_sha384_seed[] = {
+  0xcd, 0x66, 0x5c, 0xf6, 0xa8, 0x44, 0x7d, 0xd6,
+  0xff, 0x8b, 0x27, 0x55, 0x5e, 0xdb, 0x74, 0x65,
+};
+
+static u8 tls_test_prf_sha384_out[] = {
+  0x7b, 0x0c, 0x18, 0xe9, 0xce, 0xd4, 0x10, 0xed, 0x18, 0x04, 0xf2, 0xcf,
+  0xa3, 0x4a, 0x33, 0x6a, 0x1c, 0x14, 0xdf, 0xfb, 0x49, 0x00, 0xbb, 0x5f,
+  0xd7, 0x94, 0x21, 0x07, 0xe8, 0x1c, 0x83, 0xcd, 0xe9, 0xca, 0x0f, 0xaa,
+  0x60, 0xbe, 0x9f, 0xe3, 0x4f, 0x82, 0xb1, 0x23, 0x3c, 0x91, 0x46, 0xa0,
+  0xe5, 0x34, 0xcb, 0x40, 0x0f, 0xed, 0x27, 0x00, 0x88, 0x4f, 0x9d, 0xc2,
+  0x36, 0xf8, 0x0e, 0xdd, 0x8b, 0xfa, 0x96, 0x11, 0x44, 0xc9, 0xe8, 0xd7,
+  0x92, 0xec, 0xa7, 0x22, 0xa7, 0xb3, 0x2f, 0xc3, 0xd4, 0x16, 0xd4, 0x73,
+  0xeb, 0xc2, 0xc5, 0xfd, 0x4a, 0xbf, 0xda, 0xd0, 0x5d, 0x91, 0x84, 0x25,
+  0x9b, 0x5b, 0xf8, 0xcd, 0x4d, 0x90, 0xfa, 0x0d, 0x31, 0xe2, 0xde, 0xc4,
+  0x79, 0xe4, 0xf1, 0xa2, 0x60, 0x66, 0xf2, 0xee, 0xa9, 0xa6, 0x92, 0x36,
+  0xa3, 0xe5, 0x26, 0x55, 0xc9, 0xe9, 0xae, 0xe6, 0x91, 0xc8, 0xf3, 0xa2,
+  0x68, 0x54, 0x30, 0x8d, 0x5e, 0xaa, 0x3b, 0xe8, 0x5e, 0x09, 0x90, 0x70,
+  0x3d, 0x73, 0xe5, 0x6f,
+};
+
+static u8 tls_test_plain[] = "Hello, world! Jenny is a friend of mine.";
+
+/* key 10 11 .. 1f, salt a0 a1 a2 a3, sequence number 1 */
+static u8 tls_test_rec128[] = {
+  0x17, 0x03, 0x03, 0x00, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x01, 0xdf, 0x55, 0x47, 0x95, 0xf5, 0x01, 0x94, 0x5a, 0x16, 0x20, 0x08,
+  0x5a, 0x67, 0xcb, 0x23, 0x1a, 0xe3, 0x66, 0x25, 0x29, 0x7f, 0x88, 0x6c,
+  0xce, 0x20, 0x31, 0xcd, 0xd1, 0xdd, 0x66, 0x9e, 0x47, 0x25, 0xfa, 0xf0,
+  0x53, 0x66, 0x76, 0xcc, 0x1b, 0x4b, 0xa9, 0xa3, 0xc3, 0x7d, 0x38, 0x5f,
+  0xbf, 0xc4, 0x42, 0xc8, 0x08, 0x34, 0xe8, 0x54, 0x81,
+};
+
+/* key 40 41 .. 5f, salt b0 b1 b2 b3, sequence number 0x0102030405 */
+static u8 tls_test_rec256[] = {
+  0x17, 0x03, 0x03, 0x00, 0x40, 0x00, 0x00, 0x00, 0x01, 0x02, 0x03, 0x04,
+  0x05, 0x58, 0xfb, 0x2c, 0xb8, 0xe4, 0x8e, 0x6c, 0x9a, 0x5c, 0x99, 0x26,
+  0xfa, 0x19, 0xdc, 0x49, 0xbd, 0xb1, 0x2e, 0x4a, 0xa2, 0x76, 0x7b, 0x68,
+  0xaa, 0x08, 0x8d, 0x35, 0x1b, 0x93, 0xe4, 0x9f, 0x1a, 0xc0, 0x45, 0x7c,
+  0x02, 0x41, 0xa5, 0x75, 0xdb, 0x2c, 0x2d, 0xa3, 0xbf, 0x7d, 0x77, 0x79,
+  0x76, 0x23, 0x14, 0x9b, 0x81, 0xbe, 0x35, 0x8f, 0xb5,
+};
+/* *INDENT-ON* */
+
+static int
+tls_test_prf_one (const EVP_MD * md, u8 * secret, u32 secret_len,
+		  u8 * seed, u32 seed_len, u8 * expected, u32 out_len)
+{
+  u8 *label_seed = 0, *out = 0;
+  int rv;
+
+  label_seed = format (0, "test label");
+  vec_add (label_seed, seed, seed_len);
+  vec_validate (out, out_len - 1);
+
+  rv = openssl_record_prf (md, secret, secret_len, label_seed,
+			   vec_len (label_seed), out, out_len);
+  if (!rv)
+    rv = memcmp (out, expected, out_len);
+
+  vec_free (label_seed);
+  vec_free (out);
+  return rv;
+}
+
+static int
+tls_test_prf (vlib_main_t * vm, unformat_input_t * input)
+{
+  int rv;
+
+  rv = tls_test_prf_one (EVP_sha256 (), tls_test_prf_sha256_secret,
+			 sizeof (tls_test_prf_sha256_secret),
+			 tls_test_prf_sha256_seed,
+			 sizeof (tls_test_prf_sha256_seed),
+			 tls_test_prf_sha256_out,
+			 sizeof (tls_test_prf_sha256_out));
+  TLS_TEST (rv == 0, "P_SHA256 output should match");
+
+  rv = tls_test_prf_one (EVP_sha384 (), tls_test_prf_sha384_secret,
+			 sizeof (tls_test_prf_sha384_secret),
+			 tls_test_prf_sha384_seed,
+			 sizeof (tls_test_prf_sha384_seed),
+			 tls_test_prf_sha384_out,
+			 sizeof (tls_test_prf_sha384_out));
+  TLS_TEST (rv == 0, "P_SHA384 output should match");
+
+  return 0;
+}
+
+/**
+ * Encrypt tls_test_plain into a record and decrypt it back. If offset is
+ * non zero, the tls fifo head and tail are moved there first so that a
+ * record starting at offset wraps and goes through the bounce buffer.
+ */
+static int
+tls_test_record_one (const EVP_CIPHER * c, u8 * key, u8 * salt, u64 seq,
+		     u8 * expected, u32 rec_len, u32 offset)
+{
+  u32 plen = sizeof (tls_test_plain) - 1, fifo_size = 1024;
+  svm_fifo_t *app_tx, *app_rx, *tls_f;
+  openssl_ctx_t _oc, *oc = &_oc;
+  u8 *bounce = 0, *junk = 0, *rec = 0;
+  u8 is_full;
+  int rv;
+
+  memset (oc, 0, sizeof (*oc));
+  vec_validate (bounce, TLS_RECORD_BOUNCE_SIZE - 1);
+  vec_validate (rec, rec_len - 1);
+  app_tx = svm_fifo_create (fifo_size);
+  app_rx = svm_fifo_create (fifo_size);
+  tls_f = svm_fifo_create (fifo_size);
+
+  if (offset)
+    {
+      vec_validate (junk, offset - 1);
+      svm_fifo_enqueue_nowait (tls_f, offset, junk);
+      svm_fifo_dequeue_drop (tls_f, offset);
+    }
+
+  TLS_TEST (!openssl_record_dir_init (&oc->rec_tx, c, key, salt, 1)
+	    && !openssl_record_dir_init (&oc->rec_rx, c, key, salt, 0),
+	    "record directions should init");
+  oc->rec_tx.seq = oc->rec_rx.seq = seq;
+
+  svm_fifo_enqueue_nowait (app_tx, plen, tls_test_plain);
+  rv = openssl_record_write (oc, app_tx, tls_f, bounce);
+  TLS_TEST (rv == plen, "wrote %d plaintext bytes, expected %u", rv, plen);
+  TLS_TEST (svm_fifo_max_dequeue (tls_f) == rec_len,
+	    "record is %u bytes, expected %u",
+	    svm_fifo_max_dequeue (tls_f), rec_len);
+  svm_fifo_peek (tls_f, 0, rec_len, rec);
+  TLS_TEST (!memcmp (rec, expected, rec_len),
+	    "record at offset %u should match", offset);
+  TLS_TEST (oc->rec_tx.seq == seq + 1, "tx sequence number should move");
+
+  rv = openssl_record_read (oc, tls_f, app_rx, bounce, &is_full);
+  TLS_TEST (rv == plen, "read %d plaintext bytes, expected %u", rv, plen);
+  TLS_TEST (!is_full && svm_fifo_max_dequeue (tls_f) == 0,
+	    "record should be consumed");
+  memset (bounce, 0, plen);
+  svm_fifo_dequeue_nowait (app_rx, plen, bounce);
+  TLS_TEST (!memcmp (bounce, tls_test_plain, plen),
+	    "decrypted record should match the plaintext");
+
+  /* A record that fails authentication must not reach the app */
+  rec[rec_len - 1] ^= 1;
+  oc->rec_rx.seq = seq;
+  svm_fifo_enqueue_nowait (tls_f, rec_len, rec);
+  rv = openssl_record_read (oc, tls_f, app_rx, bounce, &is_full);
+  TLS_TEST (rv == -1, "bad tag should fail the session, got %d", rv);
+  TLS_TEST (svm_fifo_max_dequeue (app_rx) == 0,
+	    "nothing should be enqueued to the app");
+
+  openssl_record_offload_free (oc);
+  svm_fifo_free (app_tx);
+  svm_fifo_free (app_rx);
+  svm_fifo_free (tls_f);
+  vec_free (bounce);
+  vec_free (junk);
+  vec_free (rec);
+  return 0;
+}
+
+static int
+tls_test_record (vlib_main_t * vm, unformat_input_t * input)
+{
+  /* Contiguous, payload split at the wrap, header split at the wrap */
+  u32 offsets[] = { 0, 1024 - 30, 1024 - 3 };
+  u8 key128[16], key256[32], salt128[4], salt256[4];
+  int i;
+
+  for (i = 0; i < sizeof (key128); i++)
+    key128[i] = 0x10 + i;
+  for (i = 0; i < sizeof (key256); i++)
+    key256[i] = 0x40 + i;
+  for (i = 0; i < 4; i++)
+    {
+      salt128[i] = 0xa0 + i;
+      salt256[i] = 0xb0 + i;
+    }
+
+  for (i = 0; i < ARRAY_LEN (offsets); i++)
+    {
+      if (tls_test_record_one (EVP_aes_128_gcm (), key128, salt128, 1,
+			       tls_test_rec128, sizeof (tls_test_rec128),
+			       offsets[i]))
+	return 1;
+      if (tls_test_record_one (EVP_aes_256_gcm (), key256, salt256,
+			       0x0102030405ULL, tls_test_rec256,
+			       sizeof (tls_test_rec256), offsets[i]))
+	return 1;
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+tls_test (vlib_main_t * vm,
+	  unformat_input_t * input, vlib_cli_command_t * cmd_arg)
+{
+  int res = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "prf"))
+	res = tls_test_prf (vm, input);
+      else if (unformat (input, "record"))
+	res = tls_test_record (vm, input);
+      else if (unformat (input, "all"))
+	{
+	  if ((res = tls_test_prf (vm, input)))
+	    goto done;
+	  if ((res = tls_test_record (vm, input)))
+	    goto done;
+	}
+      else
+	break;
+    }
+
+done:
+  if (res)
+    return clib_error_return (0, "TLS unit test failed");
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (tls_test_command, static) =
+{
+  .path = "test tls",
+  .short_help = "internal tls record layer unit tests",
+  .function = tls_test,
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
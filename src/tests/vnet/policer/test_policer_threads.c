@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Police from 1 to N threads with one policer, in shared (spin-lock)
+ * and per-thread mode, and check that no tokens are lost or created
+ * when threads race on the policer.
+ *
+ * The policer runs on a synthetic clock, so the results do not depend
+ * on the speed of the machine. First the threads drain the bucket with
+ * the clock stopped, then they police while stepping the clock through
+ * a refill that cannot overflow the bucket. In both phases the tokens
+ * that conformed, plus those still in the bucket (and in per-thread
+ * mode, in the threads' shares) must add up to the tokens the policer
+ * started with plus those it was refilled with, exactly.
+ *
+ * test_policer_threads [threads <n>] [cir <kbps>] [quantum <bytes>]
+ *                      [size <bytes>] [verbose]
+ */
+
+#include <pthread.h>
+#include <vppinfra/time.h>
+#include <vppinfra/format.h>
+#include <vppinfra/error.h>
+#include <vnet/policer/xlate.h>
+
+/* synthetic clock start, in policer periods */
+#define TEST_POLICER_T0 1000
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  void *tm;
+  int thread_index;
+  u64 n_conform_tokens;
+  policer_thread_share_t share;
+} test_thread_t;
+
+typedef struct
+{
+  u32 n_threads;
+  u32 cir_kbps;
+  u32 quantum;
+  u32 packet_size;
+  int verbose;
+
+  /* current phase */
+  int per_thread;
+  volatile int go;
+  u32 n_steps;
+  u32 n_packets_per_step;
+  policer_read_response_type_st policer;
+  test_thread_t *threads;
+} test_main_t;
+
+test_main_t test_main;
+
+static void *
+police_thread (void *arg)
+{
+  test_thread_t *tt = arg;
+  test_main_t *tm = tt->tm;
+  policer_read_response_type_st *pol = &tm->policer;
+  u32 packet_tokens = tm->packet_size << pol->scale;
+  policer_result_e col;
+  u32 step, i;
+  u64 time;
+
+  while (!tm->go)
+    ;
+
+  for (step = 0; step < tm->n_steps; step++)
+    {
+      /* step 0 is at the policer's start time, the clock is stopped
+         when there is a single step */
+      time = TEST_POLICER_T0 + step;
+
+      for (i = 0; i < tm->n_packets_per_step; i++)
+	{
+	  if (tm->per_thread)
+	    col = vnet_police_packet_per_thread (pol, &tt->share,
+						 tm->packet_size,
+						 POLICE_CONFORM, time);
+	  else
+	    {
+	      while (__sync_lock_test_and_set (&pol->lock, 1))
+		;
+	      /* another thread may already be further along */
+	      col = vnet_police_packet (pol, tm->packet_size,
+					POLICE_CONFORM,
+					clib_max (time,
+						  pol->last_update_time));
+	      __sync_lock_release (&pol->lock);
+	    }
+	  if (col == POLICE_CONFORM)
+	    tt->n_conform_tokens += packet_tokens;
+	}
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+test_policer_phase (test_main_t * tm, u32 n_threads, char *phase,
+		    u64 max_left)
+{
+  policer_read_response_type_st *pol = &tm->policer;
+  u64 before, after, n_conform = 0, n_refilled;
+  u64 last_update_time = pol->last_update_time;
+  pthread_t *handles = 0;
+  int i;
+
+  /* tokens in the bucket and in the threads' shares */
+  before = pol->current_bucket;
+  for (i = 0; i < n_threads; i++)
+    {
+      before += tm->threads[i].share.current_bucket;
+      tm->threads[i].n_conform_tokens = 0;
+    }
+
+  tm->go = 0;
+  vec_validate (handles, n_threads - 1);
+  for (i = 0; i < n_threads; i++)
+    if (pthread_create (&handles[i], NULL, police_thread, &tm->threads[i]))
+      return clib_error_return_unix (0, "pthread_create");
+
+  CLIB_MEMORY_BARRIER ();
+  tm->go = 1;
+
+  for (i = 0; i < n_threads; i++)
+    pthread_join (handles[i], NULL);
+  vec_free (handles);
+
+  after = pol->current_bucket;
+  for (i = 0; i < n_threads; i++)
+    {
+      after += tm->threads[i].share.current_bucket;
+      n_conform += tm->threads[i].n_conform_tokens;
+      if (tm->verbose)
+	fformat (stdout, "  thread %d: %llu conform tokens, %u in share\n", i,
+		 tm->threads[i].n_conform_tokens,
+		 tm->threads[i].share.current_bucket);
+    }
+
+  /* the bucket never reaches its limit, so nothing is capped off */
+  n_refilled = (pol->last_update_time - last_update_time) *
+    pol->cir_tokens_per_period;
+
+  if (tm->verbose)
+    fformat (stdout, "%-10s %-6s threads %2d: %llu conform, %llu refilled, "
+	     "%u left\n", tm->per_thread ? "per-thread" : "shared", phase,
+	     n_threads, n_conform, n_refilled, pol->current_bucket);
+
+  if (n_conform + after != before + n_refilled)
+    return clib_error_return (0, "%s %s, %d threads: %llu conform + %llu "
+			      "left != %llu + %llu refilled",
+			      tm->per_thread ? "per-thread" : "shared",
+			      phase, n_threads, n_conform, after, before,
+			      n_refilled);
+
+  /* the demand was higher than the supply, so little is left over */
+  if (after > max_left)
+    return clib_error_return (0, "%s %s, %d threads: %llu tokens left "
+			      "unused", tm->per_thread ? "per-thread" :
+			      "shared", phase, n_threads, after);
+  return 0;
+}
+
+static clib_error_t *
+test_policer_run (test_main_t * tm, u32 n_threads, int per_thread)
+{
+  policer_read_response_type_st *pol = &tm->policer;
+  sse2_qos_pol_cfg_params_st cfg;
+  clib_error_t *error;
+  u32 packet_tokens;
+  u64 max_left;
+  int i;
+
+  memset (&cfg, 0, sizeof (cfg));
+  cfg.rate_type = SSE2_QOS_RATE_KBPS;
+  cfg.rnd_type = SSE2_QOS_ROUND_TO_CLOSEST;
+  cfg.rfc = SSE2_QOS_POLICER_TYPE_1R2C;
+  cfg.rb.kbps.cir_kbps = tm->cir_kbps;
+  cfg.rb.kbps.cb_bytes = tm->cir_kbps * 125 / 100;	/* 10ms */
+  cfg.per_thread = per_thread;
+  cfg.thread_quantum_bytes = tm->quantum;
+
+  if (sse2_pol_logical_2_physical (&cfg, pol))
+    return clib_error_return (0, "policer config failed");
+  pol->last_update_time = TEST_POLICER_T0;
+  packet_tokens = tm->packet_size << pol->scale;
+  if (pol->cir_tokens_per_period == 0 ||
+      pol->current_limit < (n_threads + 1) * packet_tokens +
+      pol->cir_tokens_per_period)
+    return clib_error_return (0, "cir %u kbps too low for %u byte packets",
+			      tm->cir_kbps, tm->packet_size);
+
+  tm->per_thread = per_thread;
+  vec_validate_aligned (tm->threads, n_threads - 1, CLIB_CACHE_LINE_BYTES);
+  for (i = 0; i < n_threads; i++)
+    {
+      memset (&tm->threads[i], 0, sizeof (tm->threads[i]));
+      tm->threads[i].tm = tm;
+      tm->threads[i].thread_index = i;
+    }
+
+  /* less than a packet is left in the bucket, and in per-thread mode
+     a thread which never ran dry may still hold up to a quantum */
+  max_left = packet_tokens;
+  if (per_thread)
+    max_left = n_threads * ((u64) pol->thread_quantum + packet_tokens);
+
+  /* drain a full bucket with the clock stopped, asking for twice what
+     is there */
+  tm->n_steps = 1;
+  tm->n_packets_per_step = 2 * (pol->current_bucket / packet_tokens) /
+    n_threads + 1;
+  if ((error = test_policer_phase (tm, n_threads, "drain", max_left)))
+    return error;
+
+  /* step the clock, each thread asking for more than is refilled. The
+     shares hold less than a packet each, so the bucket stays under its
+     limit as long as the refills do */
+  tm->n_steps = (pol->current_limit - n_threads * packet_tokens) /
+    pol->cir_tokens_per_period;
+  tm->n_steps = clib_min (tm->n_steps, 10000);
+  tm->n_packets_per_step = pol->cir_tokens_per_period / packet_tokens + 1;
+  max_left += pol->cir_tokens_per_period;
+  if ((error = test_policer_phase (tm, n_threads, "refill", max_left)))
+    return error;
+
+  fformat (stdout, "%-10s threads %2d: ok\n",
+	   per_thread ? "per-thread" : "shared", n_threads);
+  return 0;
+}
+
+static clib_error_t *
+test_policer_main (unformat_input_t * i)
+{
+  test_main_t *tm = &test_main;
+  clib_error_t *error;
+  u32 n_threads;
+
+  tm->n_threads = 4;
+  tm->cir_kbps = 100000;
+  tm->packet_size = 64;
+
+  while (unformat_check_input (i) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (i, "threads %d", &tm->n_threads))
+	;
+      else if (unformat (i, "cir %d", &tm->cir_kbps))
+	;
+      else if (unformat (i, "quantum %d", &tm->quantum))
+	;
+      else if (unformat (i, "size %d", &tm->packet_size))
+	;
+      else if (unformat (i, "verbose"))
+	tm->verbose = 1;
+      else
+	return clib_error_create ("unknown input `%U'\n",
+				  format_unformat_error, i);
+    }
+
+  if (tm->n_threads == 0)
+    return clib_error_create ("need at least one thread");
+
+  for (n_threads = 1; n_threads <= tm->n_threads; n_threads++)
+    {
+      if ((error = test_policer_run (tm, n_threads, 0 /* per_thread */ )))
+	return error;
+      if ((error = test_policer_run (tm, n_threads, 1 /* per_thread */ )))
+	return error;
+    }
+
+  return 0;
+}
+
+#ifdef CLIB_UNIX
+int
+main (int argc, char *argv[])
+{
+  unformat_input_t i;
+  clib_error_t *error;
+  int ret = 0;
+
+  clib_mem_init (0, 64ULL << 20);
+
+  unformat_init_command_line (&i, argv);
+  error = test_policer_main (&i);
+  unformat_free (&i);
+
+  if (error)
+    {
+      clib_error_report (error);
+      ret = 1;
+    }
+  return ret;
+}
+#endif /* CLIB_UNIX */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
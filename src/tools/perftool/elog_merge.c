@@ -52,6 +52,7 @@ elog_merge_main (unformat_input_t * input)
   u32 verbose;
   char *dump_file, *merge_file, **merge_files;
   u8 *tag, **tags;
+  u8 *is_stream;
   f64 align_tweak;
   f64 *align_tweaks;
   uword i;
@@ -60,6 +61,7 @@ elog_merge_main (unformat_input_t * input)
   verbose = 0;
   dump_file = 0;
   merge_files = 0;
+  is_stream = 0;
   tags = 0;
   align_tweaks = 0;
 
@@ -70,7 +72,16 @@ elog_merge_main (unformat_input_t * input)
       else if (unformat (input, "tag %s", &tag))
 	vec_add1 (tags, tag);
       else if (unformat (input, "merge %s", &merge_file))
-	vec_add1 (merge_files, merge_file);
+	{
+	  vec_add1 (merge_files, merge_file);
+	  vec_add1 (is_stream, 0);
+	}
+      /* Files written by elog_stream_flush, e.g. "event-logger stream" */
+      else if (unformat (input, "stream %s", &merge_file))
+	{
+	  vec_add1 (merge_files, merge_file);
+	  vec_add1 (is_stream, 1);
+	}
 
       else if (unformat (input, "verbose %=", &verbose, 1))
 	;
@@ -95,7 +106,12 @@ elog_merge_main (unformat_input_t * input)
 
   for (i = 0; i < vec_len (ems); i++)
     {
-      if ((error = elog_read_file ((i == 0) ? em : &ems[i], merge_files[i])))
+      if (is_stream[i])
+	error = elog_read_stream_file ((i == 0) ? em : &ems[i],
+				       merge_files[i]);
+      else
+	error = elog_read_file ((i == 0) ? em : &ems[i], merge_files[i]);
+      if (error)
 	goto done;
       if (i > 0)
 	{
@@ -29,6 +29,7 @@
 #include <vcl/vppcom.h>
 #include <vppinfra/time.h>
 #include <vppinfra/bitmap.h>
+#include <vppinfra/lock.h>
 
 #define HAVE_CONSTRUCTOR_ATTRIBUTE
 #ifdef HAVE_CONSTRUCTOR_ATTRIBUTE
@@ -46,6 +47,12 @@
 #define DESTRUCTOR_ATTRIBUTE
 #endif
 
+typedef struct
+{
+  int libc_epfd;
+  u32 n_libc_fds;
+} ldp_vep_t;
+
 typedef struct
 {
   int init;
@@ -66,10 +73,20 @@ typedef struct
   clib_bitmap_t *libc_ex_bitmap;
   vcl_poll_t *vcl_poll;
   u8 select_vcl;
+  /* vcl filled all events in the last epoll_wait, poll kernel fds first */
   u8 epoll_wait_vcl;
+  /* Kernel side state of vcl epoll sessions, indexed by vep_idx. The
+   * vector may grow in epoll_ctl while other threads are in epoll_wait */
+  ldp_vep_t *veps;
+  clib_spinlock_t veps_lock;
 } ldp_main_t;
 #define LDP_DEBUG ldp->debug
 
+/* How long an idle epoll_wait blocks in the kernel, or sleeps if there is
+ * no kernel fd to block on, between two polls of the vcl sessions */
+#define LDP_EPOLL_IDLE_WAIT_MS  1
+#define LDP_EPOLL_IDLE_SLEEP_US 100
+
 static ldp_main_t ldp_main = {
   .sid_bit_val = (1 << LDP_SID_BIT_MIN),
   .sid_bit_mask = (1 << LDP_SID_BIT_MIN) - 1,
@@ -122,6 +139,47 @@ ldp_sid_from_fd (int fd)
 	  INVALID_SESSION_ID);
 }
 
+/* Track kernel fds registered with a vcl epoll session, so epoll_wait only
+ * polls the kernel when there is something to poll */
+static inline void
+ldp_vep_libc_fd_add_del (u32 vep_idx, int libc_epfd, int op)
+{
+  ldp_vep_t *vep;
+
+  clib_spinlock_lock_if_init (&ldp->veps_lock);
+  vec_validate (ldp->veps, vep_idx);
+  vep = &ldp->veps[vep_idx];
+  vep->libc_epfd = libc_epfd;
+  if (op == EPOLL_CTL_ADD)
+    vep->n_libc_fds++;
+  else if (op == EPOLL_CTL_DEL && vep->n_libc_fds)
+    vep->n_libc_fds--;
+  clib_spinlock_unlock_if_init (&ldp->veps_lock);
+}
+
+/* Kernel epfd of a vcl epoll session, 0 if no kernel fds are registered */
+static inline int
+ldp_vep_libc_epfd (u32 vep_idx)
+{
+  int libc_epfd = 0;
+
+  clib_spinlock_lock_if_init (&ldp->veps_lock);
+  if (vep_idx < vec_len (ldp->veps) && ldp->veps[vep_idx].n_libc_fds)
+    libc_epfd = ldp->veps[vep_idx].libc_epfd;
+  clib_spinlock_unlock_if_init (&ldp->veps_lock);
+
+  return libc_epfd;
+}
+
+static inline void
+ldp_vep_reset (u32 vep_idx)
+{
+  clib_spinlock_lock_if_init (&ldp->veps_lock);
+  if (vep_idx < vec_len (ldp->veps))
+    memset (&ldp->veps[vep_idx], 0, sizeof (ldp_vep_t));
+  clib_spinlock_unlock_if_init (&ldp->veps_lock);
+}
+
 static inline int
 ldp_init (void)
 {
@@ -214,6 +272,7 @@ ldp_init (void)
 	    }
 
 	  clib_time_init (&ldp->clib_time);
+	  clib_spinlock_init (&ldp->veps_lock);
 	  if (LDP_DEBUG > 0)
 	    clib_warning ("LDP<%d>: LDP initialization: done!", getpid ());
 	}
@@ -254,6 +313,7 @@ close (int fd)
 	       getpid (), fd, fd, func_str, epfd, epfd);
 
 	  rv = libc_close (epfd);
+	  ldp_vep_reset (sid);
 	  if (rv < 0)
 	    {
 	      u32 size = sizeof (epfd);
@@ -2979,7 +3039,10 @@ epoll_create1 (int flags)
       rv = -1;
     }
   else
-    rv = ldp_fd_from_sid ((u32) rv);
+    {
+      ldp_vep_reset ((u32) rv);
+      rv = ldp_fd_from_sid ((u32) rv);
+    }
 
   if (LDP_DEBUG > 1)
     {
@@ -3105,6 +3168,8 @@ epoll_ctl (int epfd, int op, int fd, struct epoll_event *event)
 			  libc_epfd, libc_epfd, op, fd, fd, event);
 
 	  rv = libc_epoll_ctl (libc_epfd, op, fd, event);
+	  if (rv == 0)
+	    ldp_vep_libc_fd_add_del (vep_idx, libc_epfd, op);
 	}
     }
   else
@@ -3147,8 +3212,8 @@ static inline int
 ldp_epoll_pwait (int epfd, struct epoll_event *events,
 		 int maxevents, int timeout, const sigset_t * sigmask)
 {
-  const char *func_str;
-  int rv = 0;
+  const char *func_str = "vppcom_epoll_wait";
+  int rv = 0, n_vcl, n_libc;
   double time_to_wait = (double) 0;
   double time_out, now = 0;
   u32 vep_idx = ldp_sid_from_fd (epfd);
@@ -3163,6 +3228,12 @@ ldp_epoll_pwait (int epfd, struct epoll_event *events,
       return -1;
     }
 
+  if (PREDICT_FALSE (maxevents <= 0))
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
   if (PREDICT_FALSE (vep_idx == INVALID_SESSION_ID))
     {
       clib_warning ("LDP<%d>: ERROR: epfd %d (0x%x): bad vep_idx %d (0x%x)!",
@@ -3174,14 +3245,8 @@ ldp_epoll_pwait (int epfd, struct epoll_event *events,
   time_to_wait = ((timeout >= 0) ? (double) timeout / (double) 1000 : 0);
   time_out = clib_time_now (&ldp->clib_time) + time_to_wait;
 
-  func_str = "vppcom_session_attr[GET_LIBC_EPFD]";
-  libc_epfd = vppcom_session_attr (vep_idx, VPPCOM_ATTR_GET_LIBC_EPFD, 0, 0);
-  if (PREDICT_FALSE (libc_epfd < 0))
-    {
-      errno = -libc_epfd;
-      rv = -1;
-      goto done;
-    }
+  /* Only look at the kernel epfd if kernel fds were registered with it */
+  libc_epfd = ldp_vep_libc_epfd (vep_idx);
 
   if (LDP_DEBUG > 2)
     clib_warning ("LDP<%d>: epfd %d (0x%x): vep_idx %d (0x%x), "
@@ -3192,7 +3257,23 @@ ldp_epoll_pwait (int epfd, struct epoll_event *events,
 		  sigmask, time_to_wait, time_out);
   do
     {
-      if (!ldp->epoll_wait_vcl)
+      n_vcl = n_libc = 0;
+
+      /* Both sides are polled without blocking and their events merged.
+       * Whichever side was starved last time goes first. */
+      if (libc_epfd > 0 && ldp->epoll_wait_vcl)
+	{
+	  func_str = "libc_epoll_pwait";
+	  n_libc = libc_epoll_pwait (libc_epfd, events, maxevents, 0,
+				     sigmask);
+	  if (n_libc < 0)
+	    {
+	      rv = -1;
+	      goto done;
+	    }
+	}
+
+      if (n_libc < maxevents)
 	{
 	  func_str = "vppcom_epoll_wait";
 
@@ -3202,23 +3283,17 @@ ldp_epoll_pwait (int epfd, struct epoll_event *events,
 			  getpid (), epfd, epfd, func_str,
 			  vep_idx, vep_idx, events, maxevents);
 
-	  rv = vppcom_epoll_wait (vep_idx, events, maxevents, 0);
-	  if (rv > 0)
+	  n_vcl = vppcom_epoll_wait (vep_idx, events + n_libc,
+				     maxevents - n_libc, 0);
+	  if (n_vcl < 0)
 	    {
-	      ldp->epoll_wait_vcl = 1;
-	      goto done;
-	    }
-	  else if (rv < 0)
-	    {
-	      errno = -rv;
+	      errno = -n_vcl;
 	      rv = -1;
 	      goto done;
 	    }
 	}
-      else
-	ldp->epoll_wait_vcl = 0;
 
-      if (libc_epfd > 0)
+      if (libc_epfd > 0 && !ldp->epoll_wait_vcl && n_vcl < maxevents)
 	{
 	  func_str = "libc_epoll_pwait";
 
@@ -3229,15 +3304,45 @@ ldp_epoll_pwait (int epfd, struct epoll_event *events,
 			  getpid (), epfd, epfd, func_str,
 			  libc_epfd, libc_epfd, events, maxevents, sigmask);
 
-	  rv = libc_epoll_pwait (libc_epfd, events, maxevents, 1, sigmask);
-	  if (rv != 0)
-	    goto done;
+	  n_libc = libc_epoll_pwait (libc_epfd, events + n_vcl,
+				     maxevents - n_vcl, 0, sigmask);
+	  if (n_libc < 0)
+	    {
+	      rv = -1;
+	      goto done;
+	    }
+	}
+
+      rv = n_vcl + n_libc;
+      if (rv)
+	{
+	  ldp->epoll_wait_vcl = (rv == maxevents) ? !ldp->epoll_wait_vcl : 0;
+	  goto done;
 	}
 
       if (timeout != -1)
-	now = clib_time_now (&ldp->clib_time);
+	{
+	  now = clib_time_now (&ldp->clib_time);
+	  if (now >= time_out)
+	    break;
+	}
+
+      /* Nothing ready: don't spin. Block in the kernel for a slice, which
+       * returns early on kernel fd events, or just sleep if only vcl
+       * sessions are registered. vcl events have no fd to wait on, so the
+       * slice bounds the latency they see. */
+      if (libc_epfd > 0)
+	{
+	  func_str = "libc_epoll_pwait";
+	  rv = libc_epoll_pwait (libc_epfd, events, maxevents,
+				 LDP_EPOLL_IDLE_WAIT_MS, sigmask);
+	  if (rv)
+	    goto done;
+	}
+      else
+	usleep (LDP_EPOLL_IDLE_SLEEP_US);
     }
-  while (now < time_out);
+  while (1);
 
 done:
   if (LDP_DEBUG > 3)
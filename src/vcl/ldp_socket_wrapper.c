@@ -455,13 +455,25 @@ _swrap_bind_symbol (enum swrap_lib lib, const char *fn_name)
   return func;
 }
 
+/* Symbols are bound once and never change afterwards, so only take the
+ * binding lock on the first call instead of on every libc fallback. The
+ * pointer is published with release and read with acquire semantics, so
+ * a thread that sees it bound also sees what it points to. */
 #define swrap_bind_symbol_libc(sym_name) \
-        SWRAP_LOCK(libc_symbol_binding); \
-        if (swrap.libc.symbols._libc_##sym_name.obj == NULL) { \
-                swrap.libc.symbols._libc_##sym_name.obj = \
-                        _swrap_bind_symbol(SWRAP_LIBC, #sym_name); \
-        } \
-        SWRAP_UNLOCK(libc_symbol_binding)
+        do { \
+                if (__builtin_expect (__atomic_load_n \
+                                      (&swrap.libc.symbols._libc_##sym_name.obj, \
+                                       __ATOMIC_ACQUIRE) == NULL, 0)) { \
+                        SWRAP_LOCK(libc_symbol_binding); \
+                        if (swrap.libc.symbols._libc_##sym_name.obj == NULL) { \
+                                __atomic_store_n \
+                                        (&swrap.libc.symbols._libc_##sym_name.obj, \
+                                         _swrap_bind_symbol(SWRAP_LIBC, #sym_name), \
+                                         __ATOMIC_RELEASE); \
+                        } \
+                        SWRAP_UNLOCK(libc_symbol_binding); \
+                } \
+        } while (0)
 
 /*
  * IMPORTANT
@@ -534,6 +534,136 @@ stream_test_client (sock_test_t test)
 	  test == SOCK_TEST_TYPE_BI ? "Bi" : "Uni");
 }
 
+static void
+rr_test_client (void)
+{
+  sock_client_main_t *scm = &sock_client_main;
+  sock_test_socket_t *ctrl = &scm->ctrl_socket;
+  sock_test_socket_t *tsock;
+  struct timespec diff;
+  double duration;
+  uint64_t n_xacts, xact;
+  uint32_t i, n, rx_left;
+  int rv;
+
+  ctrl->cfg.total_bytes = ctrl->cfg.num_writes * ctrl->cfg.txbuf_size;
+  ctrl->cfg.ctrl_handle = ~0;
+
+  printf ("\n" SOCK_TEST_BANNER_STRING
+	  "CLIENT (fd %d): Request/Response Test!\n\n"
+	  "CLIENT (fd %d): Sending config to server on ctrl socket...\n",
+	  ctrl->fd, ctrl->fd);
+
+  if (sock_test_cfg_sync (ctrl))
+    {
+      fprintf (stderr, "CLIENT: ERROR: test cfg sync failed -- aborting!");
+      return;
+    }
+
+  memset (&ctrl->stats, 0, sizeof (ctrl->stats));
+  for (n = 0; n != ctrl->cfg.num_test_sockets; n++)
+    {
+      tsock = &scm->test_socket[n];
+      tsock->cfg = ctrl->cfg;
+      sock_test_socket_buf_alloc (tsock);
+      printf ("CLIENT (fd %d): Sending config to server on "
+	      "test socket %d...\n", tsock->fd, n);
+      sock_test_cfg_sync (tsock);
+
+      for (i = 0; i < tsock->txbuf_size; i++)
+	tsock->txbuf[i] = i & 0xff;
+
+      memset (&tsock->stats, 0, sizeof (tsock->stats));
+    }
+
+  /* Each socket has exactly one request in flight: send it, then wait
+   * for the server to echo all of it back before sending the next one.
+   * With small txbuf sizes this is dominated by per-call overhead, much
+   * like an http server handling short requests. */
+  clock_gettime (CLOCK_REALTIME, &ctrl->stats.start);
+  for (xact = 0; xact < ctrl->cfg.num_writes; xact++)
+    {
+      for (n = 0; n < ctrl->cfg.num_test_sockets; n++)
+	{
+	  tsock = &scm->test_socket[n];
+	  rv = sock_test_write (tsock->fd, (uint8_t *) tsock->txbuf,
+				ctrl->cfg.txbuf_size, &tsock->stats,
+				ctrl->cfg.verbose);
+	  if (rv < 0)
+	    {
+	      fprintf (stderr, "\nCLIENT: ERROR: sock_test_write(%d) "
+		       "failed -- aborting test!\n", tsock->fd);
+	      return;
+	    }
+	}
+
+      for (n = 0; n < ctrl->cfg.num_test_sockets; n++)
+	{
+	  tsock = &scm->test_socket[n];
+	  rx_left = ctrl->cfg.txbuf_size;
+	  while (rx_left)
+	    {
+	      rv = sock_test_read (tsock->fd, (uint8_t *) tsock->rxbuf,
+				   rx_left < tsock->rxbuf_size ?
+				   rx_left : tsock->rxbuf_size,
+				   &tsock->stats);
+	      if (rv < 0)
+		{
+		  fprintf (stderr, "\nCLIENT: ERROR: sock_test_read(%d) "
+			   "failed -- aborting test!\n", tsock->fd);
+		  return;
+		}
+	      rx_left -= rv;
+	    }
+	}
+    }
+  clock_gettime (CLOCK_REALTIME, &ctrl->stats.stop);
+
+  printf ("CLIENT (fd %d): Sending config to server on ctrl socket...\n",
+	  ctrl->fd);
+
+  if (sock_test_cfg_sync (ctrl))
+    {
+      fprintf (stderr, "CLIENT: ERROR: test cfg sync failed -- aborting!");
+      return;
+    }
+
+  for (i = 0; i < ctrl->cfg.num_test_sockets; i++)
+    {
+      tsock = &scm->test_socket[i];
+      sock_test_stats_accumulate (&ctrl->stats, &tsock->stats);
+    }
+
+  sock_test_stats_dump ("CLIENT RESULTS", &ctrl->stats, 1 /* show_rx */ ,
+			1 /* show tx */ , ctrl->cfg.verbose);
+  sock_test_cfg_dump (&ctrl->cfg, 1 /* is_client */ );
+
+  if ((ctrl->stats.stop.tv_nsec - ctrl->stats.start.tv_nsec) < 0)
+    {
+      diff.tv_sec = ctrl->stats.stop.tv_sec - ctrl->stats.start.tv_sec - 1;
+      diff.tv_nsec = ctrl->stats.stop.tv_nsec - ctrl->stats.start.tv_nsec
+	+ 1000000000;
+    }
+  else
+    {
+      diff.tv_sec = ctrl->stats.stop.tv_sec - ctrl->stats.start.tv_sec;
+      diff.tv_nsec = ctrl->stats.stop.tv_nsec - ctrl->stats.start.tv_nsec;
+    }
+  duration = (double) diff.tv_sec + (1e-9 * diff.tv_nsec);
+  n_xacts = ctrl->cfg.num_writes * ctrl->cfg.num_test_sockets;
+  printf ("CLIENT RESULTS: %lu transactions in %lf seconds "
+	  "(%lf transactions/sec, %lf usec avg latency)\n",
+	  n_xacts, duration, duration > 0 ? n_xacts / duration : 0,
+	  ctrl->cfg.num_writes ? 1e6 * duration / ctrl->cfg.num_writes : 0);
+
+  ctrl->cfg.test = SOCK_TEST_TYPE_ECHO;
+  if (sock_test_cfg_sync (ctrl))
+    fprintf (stderr, "CLIENT: ERROR: post-test cfg sync failed!");
+
+  printf ("CLIENT (fd %d): Request/Response Test Complete!\n"
+	  SOCK_TEST_BANNER_STRING "\n", ctrl->fd);
+}
+
 static void
 exit_client (void)
 {
@@ -699,6 +829,8 @@ dump_help (void)
 	  "\t\t\tRun the Uni-directional test."
 	  INDENT SOCK_TEST_TOKEN_RUN_BI
 	  "\t\t\tRun the Bi-directional test."
+	  INDENT SOCK_TEST_TOKEN_RUN_RR
+	  "\t\t\tRun the Request/Response test."
 	  INDENT SOCK_TEST_TOKEN_VERBOSE
 	  "\t\t\tToggle verbose setting."
 	  INDENT SOCK_TEST_TOKEN_RXBUF_SIZE
@@ -854,6 +986,10 @@ parse_input ()
 		     strlen (SOCK_TEST_TOKEN_RUN_BI)))
     rv = ctrl->cfg.test = SOCK_TEST_TYPE_BI;
 
+  else if (!strncmp (SOCK_TEST_TOKEN_RUN_RR, ctrl->txbuf,
+		     strlen (SOCK_TEST_TOKEN_RUN_RR)))
+    rv = ctrl->cfg.test = SOCK_TEST_TYPE_RR;
+
   else
     rv = SOCK_TEST_TYPE_ECHO;
 
@@ -878,6 +1014,7 @@ print_usage_and_exit (void)
 	   "  -T <txbuf-size>  Test Cfg: tx buffer size.\n"
 	   "  -U               Run Uni-directional test.\n"
 	   "  -B               Run Bi-directional test.\n"
+	   "  -Q               Run Request/Response test.\n"
 	   "  -V               Verbose mode.\n");
   exit (1);
 }
@@ -894,7 +1031,7 @@ main (int argc, char **argv)
   sock_test_socket_buf_alloc (ctrl);
 
   opterr = 0;
-  while ((c = getopt (argc, argv, "chn:w:XE:I:N:R:T:UBV6D")) != -1)
+  while ((c = getopt (argc, argv, "chn:w:XE:I:N:R:T:UBQV6D")) != -1)
     switch (c)
       {
       case 'c':
@@ -1027,6 +1164,10 @@ main (int argc, char **argv)
 	ctrl->cfg.test = SOCK_TEST_TYPE_BI;
 	break;
 
+      case 'Q':
+	ctrl->cfg.test = SOCK_TEST_TYPE_RR;
+	break;
+
       case 'V':
 	ctrl->cfg.verbose = 1;
 	break;
@@ -1195,6 +1336,10 @@ main (int argc, char **argv)
 	  stream_test_client (ctrl->cfg.test);
 	  break;
 
+	case SOCK_TEST_TYPE_RR:
+	  rr_test_client ();
+	  break;
+
 	case SOCK_TEST_TYPE_EXIT:
 	  continue;
 
@@ -1210,6 +1355,7 @@ main (int argc, char **argv)
 	    case SOCK_TEST_TYPE_EXIT:
 	    case SOCK_TEST_TYPE_UNI:
 	    case SOCK_TEST_TYPE_BI:
+	    case SOCK_TEST_TYPE_RR:
 	    case SOCK_TEST_TYPE_ECHO:
 	      ctrl->cfg.test = SOCK_TEST_TYPE_EXIT;
 	      continue;
@@ -1224,6 +1370,7 @@ main (int argc, char **argv)
 	case SOCK_TEST_TYPE_ECHO:
 	case SOCK_TEST_TYPE_UNI:
 	case SOCK_TEST_TYPE_BI:
+	case SOCK_TEST_TYPE_RR:
 	default:
 	  break;
 	}
@@ -239,7 +239,7 @@ stream_test_server_start_stop (sock_server_conn_t * conn,
 
 		  sprintf (buf, "SERVER (fd %d) RESULTS", tc->fd);
 		  sock_test_stats_dump (buf, &tc->stats, 1 /* show_rx */ ,
-					test == SOCK_TEST_TYPE_BI
+					test != SOCK_TEST_TYPE_UNI
 					/* show tx */ ,
 					conn->cfg.verbose);
 		}
@@ -247,7 +247,7 @@ stream_test_server_start_stop (sock_server_conn_t * conn,
 	}
 
       sock_test_stats_dump ("SERVER RESULTS", &conn->stats, 1 /* show_rx */ ,
-			    (test == SOCK_TEST_TYPE_BI) /* show_tx */ ,
+			    (test != SOCK_TEST_TYPE_UNI) /* show_tx */ ,
 			    conn->cfg.verbose);
       sock_test_cfg_dump (&conn->cfg, 0 /* is_client */ );
       if (conn->cfg.verbose)
@@ -263,14 +263,14 @@ stream_test_server_start_stop (sock_server_conn_t * conn,
       sync_config_and_reply (conn, rx_cfg);
       printf ("\nSERVER (fd %d): %s-directional Stream Test Complete!\n"
 	      SOCK_TEST_BANNER_STRING "\n", conn->fd,
-	      test == SOCK_TEST_TYPE_BI ? "Bi" : "Uni");
+	      test == SOCK_TEST_TYPE_UNI ? "Uni" : "Bi");
     }
   else
     {
       printf ("\n" SOCK_TEST_BANNER_STRING
 	      "SERVER (fd %d): %s-directional Stream Test!\n"
 	      "  Sending client the test cfg to start streaming data...\n",
-	      client_fd, test == SOCK_TEST_TYPE_BI ? "Bi" : "Uni");
+	      client_fd, test == SOCK_TEST_TYPE_UNI ? "Uni" : "Bi");
 
       rx_cfg->ctrl_handle = (rx_cfg->ctrl_handle == ~0) ? conn->fd :
 	rx_cfg->ctrl_handle;
@@ -290,7 +290,8 @@ stream_test_server (sock_server_conn_t * conn, int rx_bytes)
   int client_fd = conn->fd;
   sock_test_t test = conn->cfg.test;
 
-  if (test == SOCK_TEST_TYPE_BI)
+  /* Request/response clients wait for each request to be echoed */
+  if (test == SOCK_TEST_TYPE_BI || test == SOCK_TEST_TYPE_RR)
     (void) sock_test_write (client_fd, conn->buf, rx_bytes, &conn->stats,
 			    conn->cfg.verbose);
 
@@ -870,6 +871,7 @@ main (int argc, char **argv)
 
 			case SOCK_TEST_TYPE_BI:
 			case SOCK_TEST_TYPE_UNI:
+			case SOCK_TEST_TYPE_RR:
 			  stream_test_server_start_stop (conn, rx_cfg);
 			  break;
 
@@ -907,7 +909,8 @@ main (int argc, char **argv)
 		    }
 
 		  else if ((conn->cfg.test == SOCK_TEST_TYPE_UNI) ||
-			   (conn->cfg.test == SOCK_TEST_TYPE_BI))
+			   (conn->cfg.test == SOCK_TEST_TYPE_BI) ||
+			   (conn->cfg.test == SOCK_TEST_TYPE_RR))
 		    {
 		      stream_test_server (conn, rx_bytes);
 		      continue;
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Datagram batch test: a connected udp session sends a batch of datagrams
+ * with vppcom_session_sendmmsg to a udp listener in the same app, which
+ * reads them with vppcom_session_recvmmsg and echoes each one back to its
+ * source in a single sendmmsg. Exits non-zero on any mismatch.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <vcl/vppcom.h>
+
+#define TEST_MMSG_N_MSGS	8
+#define TEST_MMSG_BUF_SIZE	128
+
+typedef struct
+{
+  vppcom_mmsg_t msgs[TEST_MMSG_N_MSGS];
+  vppcom_endpt_t eps[TEST_MMSG_N_MSGS];
+  uint8_t ips[TEST_MMSG_N_MSGS][16];
+  char bufs[TEST_MMSG_N_MSGS][TEST_MMSG_BUF_SIZE];
+} test_mmsg_batch_t;
+
+static void
+test_mmsg_batch_init (test_mmsg_batch_t * b, int with_ep)
+{
+  int i;
+
+  memset (b, 0, sizeof (*b));
+  for (i = 0; i < TEST_MMSG_N_MSGS; i++)
+    {
+      b->msgs[i].buf = b->bufs[i];
+      b->msgs[i].len = TEST_MMSG_BUF_SIZE;
+      if (with_ep)
+	{
+	  b->eps[i].ip = b->ips[i];
+	  b->msgs[i].ep = &b->eps[i];
+	}
+    }
+}
+
+static int
+test_mmsg_send_all (uint32_t sid, vppcom_mmsg_t * msgs, uint32_t n_msgs)
+{
+  uint32_t n_sent = 0;
+  int rv;
+
+  while (n_sent < n_msgs)
+    {
+      rv = vppcom_session_sendmmsg (sid, msgs + n_sent, n_msgs - n_sent, 0);
+      if (rv == VPPCOM_EAGAIN)
+	continue;
+      if (rv < 0)
+	{
+	  fprintf (stderr, "ERROR: sendmmsg on sid %u failed: %s\n", sid,
+		   vppcom_retval_str (rv));
+	  return rv;
+	}
+      n_sent += rv;
+    }
+  return 0;
+}
+
+static int
+test_mmsg_recv_all (uint32_t sid, vppcom_mmsg_t * msgs, uint32_t n_msgs)
+{
+  uint32_t n_recv = 0;
+  int rv;
+
+  while (n_recv < n_msgs)
+    {
+      rv = vppcom_session_recvmmsg (sid, msgs + n_recv, n_msgs - n_recv, 0);
+      if (rv == VPPCOM_EAGAIN)
+	continue;
+      if (rv < 0)
+	{
+	  fprintf (stderr, "ERROR: recvmmsg on sid %u failed: %s\n", sid,
+		   vppcom_retval_str (rv));
+	  return rv;
+	}
+      n_recv += rv;
+    }
+  return 0;
+}
+
+int
+main (int argc, char **argv)
+{
+  static test_mmsg_batch_t tx, srv_rx, cli_rx;
+  struct sockaddr_in server_address;
+  vppcom_endpt_t endpt;
+  int i, rv, srv, cli, failed = 0;
+
+  if (argc < 3)
+    {
+      fprintf (stderr, "usage: test_vcl_mmsg <ipv4 addr> <port>\n");
+      return 1;
+    }
+
+  rv = vppcom_app_create ("test_vcl_mmsg");
+  if (rv)
+    return rv;
+
+  memset (&server_address, 0, sizeof (server_address));
+  server_address.sin_family = AF_INET;
+  server_address.sin_port = htons (atoi (argv[2]));
+  server_address.sin_addr.s_addr = inet_addr (argv[1]);
+
+  memset (&endpt, 0, sizeof (endpt));
+  endpt.is_ip4 = 1;
+  endpt.ip = (uint8_t *) & server_address.sin_addr;
+  endpt.port = (uint16_t) server_address.sin_port;
+
+  srv = vppcom_session_create (VPPCOM_PROTO_UDP, 0 /* is_nonblocking */ );
+  if (srv < 0 || vppcom_session_bind (srv, &endpt)
+      || vppcom_session_listen (srv, 10))
+    {
+      fprintf (stderr, "ERROR: udp listener setup failed\n");
+      goto fail;
+    }
+
+  cli = vppcom_session_create (VPPCOM_PROTO_UDP, 0 /* is_nonblocking */ );
+  if (cli < 0 || vppcom_session_connect (cli, &endpt))
+    {
+      fprintf (stderr, "ERROR: udp connect failed\n");
+      goto fail;
+    }
+
+  /* No flags are supported */
+  test_mmsg_batch_init (&cli_rx, 0);
+  rv = vppcom_session_recvmmsg (cli, cli_rx.msgs, 1, MSG_PEEK);
+  if (rv != VPPCOM_EOPNOTSUPP)
+    {
+      fprintf (stderr, "ERROR: recvmmsg with flags returned %d\n", rv);
+      failed = 1;
+    }
+  rv = vppcom_session_sendmmsg (cli, cli_rx.msgs, 1, MSG_DONTWAIT);
+  if (rv != VPPCOM_EOPNOTSUPP)
+    {
+      fprintf (stderr, "ERROR: sendmmsg with flags returned %d\n", rv);
+      failed = 1;
+    }
+
+  /* Datagrams of different sizes, each must come back whole */
+  test_mmsg_batch_init (&tx, 0);
+  for (i = 0; i < TEST_MMSG_N_MSGS; i++)
+    {
+      tx.msgs[i].len = snprintf (tx.bufs[i], TEST_MMSG_BUF_SIZE,
+				 "datagram %d %.*s", i, 8 * i,
+				 "................................"
+				 "................................") + 1;
+    }
+  if (test_mmsg_send_all (cli, tx.msgs, TEST_MMSG_N_MSGS))
+    goto fail;
+
+  test_mmsg_batch_init (&srv_rx, 1);
+  if (test_mmsg_recv_all (srv, srv_rx.msgs, TEST_MMSG_N_MSGS))
+    goto fail;
+
+  for (i = 0; i < TEST_MMSG_N_MSGS; i++)
+    {
+      if (srv_rx.msgs[i].msg_len != tx.msgs[i].len
+	  || memcmp (srv_rx.bufs[i], tx.bufs[i], tx.msgs[i].len))
+	{
+	  fprintf (stderr, "ERROR: server datagram %d: got %u bytes '%s'\n",
+		   i, srv_rx.msgs[i].msg_len, srv_rx.bufs[i]);
+	  failed = 1;
+	}
+      /* Echo it back to where it came from */
+      srv_rx.msgs[i].len = srv_rx.msgs[i].msg_len;
+    }
+  if (test_mmsg_send_all (srv, srv_rx.msgs, TEST_MMSG_N_MSGS))
+    goto fail;
+
+  test_mmsg_batch_init (&cli_rx, 0);
+  if (test_mmsg_recv_all (cli, cli_rx.msgs, TEST_MMSG_N_MSGS))
+    goto fail;
+
+  for (i = 0; i < TEST_MMSG_N_MSGS; i++)
+    {
+      if (cli_rx.msgs[i].msg_len != tx.msgs[i].len
+	  || memcmp (cli_rx.bufs[i], tx.bufs[i], tx.msgs[i].len))
+	{
+	  fprintf (stderr, "ERROR: client datagram %d: got %u bytes '%s'\n",
+		   i, cli_rx.msgs[i].msg_len, cli_rx.bufs[i]);
+	  failed = 1;
+	}
+      else
+	printf ("datagram %d: %u bytes echoed\n", i, cli_rx.msgs[i].msg_len);
+    }
+
+  vppcom_session_close (cli);
+  vppcom_session_close (srv);
+  vppcom_app_destroy ();
+  return failed;
+
+fail:
+  vppcom_app_destroy ();
+  return 1;
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
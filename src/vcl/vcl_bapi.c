@@ -356,6 +356,16 @@ done:
   vppcom_session_table_add_listener (mp->handle, session_index);
   session->session_state = STATE_LISTEN;
 
+  /* Connectionless listeners exchange datagrams over their own fifos */
+  if (session->is_dgram && mp->rx_fifo)
+    {
+      session->rx_fifo = uword_to_pointer (mp->rx_fifo, svm_fifo_t *);
+      session->rx_fifo->client_session_index = session_index;
+      session->tx_fifo = uword_to_pointer (mp->tx_fifo, svm_fifo_t *);
+      session->tx_fifo->client_session_index = session_index;
+      session->vpp_evt_q = uword_to_pointer (mp->vpp_evt_q, svm_queue_t *);
+    }
+
   VDBG (1, "VCL<%d>: vpp handle 0x%llx, sid %u: bind succeeded!",
 	getpid (), mp->handle, mp->context);
 done_unlock:
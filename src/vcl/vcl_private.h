@@ -166,6 +166,12 @@ typedef struct vppcom_cfg_t_
 
 void vppcom_cfg (vppcom_cfg_t * vcl_cfg);
 
+typedef struct vcl_batch_tx_evt_
+{
+  svm_queue_t *q;
+  session_fifo_event_t evt;
+} vcl_batch_tx_evt_t;
+
 typedef struct vppcom_main_t_
 {
   u8 init;
@@ -196,6 +202,13 @@ typedef struct vppcom_main_t_
   /* Our event queue */
   svm_queue_t *app_event_queue;
 
+  /* Batched io: ops waiting to complete, completion ring and
+   * coalesced tx events not yet signaled to vpp */
+  clib_spinlock_t batch_lockp;
+  vppcom_batch_op_t *batch_pending;
+  vppcom_batch_cqe_t *batch_cq;
+  vcl_batch_tx_evt_t *batch_tx_evts;
+
   /* unique segment name counter */
   u32 unique_segment_index;
 
@@ -34,6 +34,8 @@ typedef struct
   sock_test_socket_t *test_socket;
   uint32_t num_test_sockets;
   uint8_t dump_cfg;
+  uint8_t use_batch;
+  uint8_t test_failed;
 } sock_client_main_t;
 
 sock_client_main_t sock_client_main;
@@ -253,6 +255,135 @@ echo_test_client ()
     }
 }
 
+/* Echo test driven through vppcom_batch_submit/reap: one write and one
+ * read op per test socket, partial transfers are resubmitted for the rest
+ * of the buffer and the echo is checked byte for byte. */
+static void
+batch_echo_test_client ()
+{
+  sock_client_main_t *scm = &sock_client_main;
+  sock_test_socket_t *ctrl = &scm->ctrl_socket;
+  sock_test_socket_t *tsock;
+  vppcom_batch_op_t op;
+  vppcom_batch_cqe_t cqes[16];
+  int i, rv, nbytes, n_idle = 0;
+  uint32_t n, n_left;
+
+  memset (&ctrl->stats, 0, sizeof (ctrl->stats));
+  ctrl->cfg.total_bytes = nbytes = strlen (ctrl->txbuf) + 1;
+  memset (&op, 0, sizeof (op));
+  for (n = 0; n != ctrl->cfg.num_test_sockets; n++)
+    {
+      tsock = &scm->test_socket[n];
+      tsock->cfg = ctrl->cfg;
+      sock_test_socket_buf_alloc (tsock);
+      if (sock_test_cfg_sync (tsock))
+	goto fail;
+
+      memcpy (tsock->txbuf, ctrl->txbuf, nbytes);
+      memset (tsock->rxbuf, 0, nbytes);
+      memset (&tsock->stats, 0, sizeof (tsock->stats));
+
+      op.session_index = tsock->fd;
+      op.user_data = n << 1;
+      op.op = VPPCOM_BATCH_OP_WRITE;
+      op.buf = tsock->txbuf;
+      op.len = nbytes;
+      if (vppcom_batch_submit (&op, 1) != 1)
+	goto fail;
+      op.user_data = (n << 1) | 1;
+      op.op = VPPCOM_BATCH_OP_READ;
+      op.buf = tsock->rxbuf;
+      if (vppcom_batch_submit (&op, 1) != 1)
+	goto fail;
+    }
+
+  clock_gettime (CLOCK_REALTIME, &ctrl->stats.start);
+  n_left = 2 * ctrl->cfg.num_test_sockets;
+  while (n_left)
+    {
+      rv = vppcom_batch_reap (cqes, 16, 1.0);
+      if (rv < 0 || (rv == 0 && ++n_idle > 5))
+	{
+	  fprintf (stderr, "\nCLIENT: ERROR: batch reap failed (%d), "
+		   "%u ops outstanding -- aborting test!\n", rv, n_left);
+	  goto fail;
+	}
+
+      for (i = 0; i < rv; i++)
+	{
+	  /* user_data is the test socket index, low bit set for reads */
+	  tsock = &scm->test_socket[cqes[i].user_data >> 1];
+	  if (cqes[i].result <= 0 || cqes[i].session_index != tsock->fd)
+	    {
+	      fprintf (stderr, "\nCLIENT: ERROR: batch op on fd %d "
+		       "failed (%d) -- aborting test!\n",
+		       cqes[i].session_index, cqes[i].result);
+	      goto fail;
+	    }
+
+	  op.session_index = tsock->fd;
+	  op.user_data = cqes[i].user_data;
+	  if (!(cqes[i].user_data & 1))
+	    {
+	      tsock->stats.tx_xacts++;
+	      tsock->stats.tx_bytes += cqes[i].result;
+	      if (tsock->stats.tx_bytes < nbytes)
+		{
+		  op.op = VPPCOM_BATCH_OP_WRITE;
+		  op.buf = tsock->txbuf + tsock->stats.tx_bytes;
+		  op.len = nbytes - tsock->stats.tx_bytes;
+		  vppcom_batch_submit (&op, 1);
+		  continue;
+		}
+	      printf ("CLIENT (fd %d): TX (%d bytes) - '%s'\n",
+		      tsock->fd, nbytes, tsock->txbuf);
+	    }
+	  else
+	    {
+	      tsock->stats.rx_xacts++;
+	      tsock->stats.rx_bytes += cqes[i].result;
+	      if (tsock->stats.rx_bytes < nbytes)
+		{
+		  op.op = VPPCOM_BATCH_OP_READ;
+		  op.buf = tsock->rxbuf + tsock->stats.rx_bytes;
+		  op.len = nbytes - tsock->stats.rx_bytes;
+		  vppcom_batch_submit (&op, 1);
+		  continue;
+		}
+	      printf ("CLIENT (fd %d): RX (%d bytes) - '%s'\n",
+		      tsock->fd, nbytes, tsock->rxbuf);
+	      if (memcmp (tsock->rxbuf, tsock->txbuf, nbytes))
+		{
+		  fprintf (stderr, "\nCLIENT: ERROR: fd %d echoed data "
+			   "does not match -- aborting test!\n", tsock->fd);
+		  goto fail;
+		}
+	      clock_gettime (CLOCK_REALTIME, &tsock->stats.stop);
+	    }
+	  n_left--;
+	  n_idle = 0;
+	}
+    }
+  clock_gettime (CLOCK_REALTIME, &ctrl->stats.stop);
+
+  for (n = 0; n < ctrl->cfg.num_test_sockets; n++)
+    {
+      tsock = &scm->test_socket[n];
+      tsock->stats.start = ctrl->stats.start;
+      sock_test_stats_accumulate (&ctrl->stats, &tsock->stats);
+    }
+
+  if (ctrl->cfg.verbose)
+    sock_test_stats_dump ("CLIENT BATCH RESULTS", &ctrl->stats,
+			  1 /* show_rx */ , 1 /* show tx */ ,
+			  ctrl->cfg.verbose);
+  return;
+
+fail:
+  scm->test_failed = 1;
+}
+
 static void
 stream_test_client (sock_test_t test)
 {
@@ -738,6 +869,7 @@ print_usage_and_exit (void)
 	   "  -w <dir>         Write test results to <dir>.\n"
 	   "  -X               Exit after running test.\n"
 	   "  -E               Run Echo test.\n"
+	   "  -b               Run the Echo test through the batch api.\n"
 	   "  -N <num-writes>  Test Cfg: number of writes.\n"
 	   "  -R <rxbuf-size>  Test Cfg: rx buffer size.\n"
 	   "  -T <txbuf-size>  Test Cfg: tx buffer size.\n"
@@ -759,13 +891,17 @@ main (int argc, char **argv)
   sock_test_socket_buf_alloc (ctrl);
 
   opterr = 0;
-  while ((c = getopt (argc, argv, "chn:w:XE:I:N:R:T:UBV6D")) != -1)
+  while ((c = getopt (argc, argv, "chbn:w:XE:I:N:R:T:UBV6D")) != -1)
     switch (c)
       {
       case 'c':
 	scm->dump_cfg = 1;
 	break;
 
+      case 'b':
+	scm->use_batch = 1;
+	break;
+
       case 's':
 	if (sscanf (optarg, "0x%x", &ctrl->cfg.num_test_sockets) != 1)
 	  if (sscanf (optarg, "%u", &ctrl->cfg.num_test_sockets) != 1)
@@ -1039,7 +1175,10 @@ main (int argc, char **argv)
       switch (ctrl->cfg.test)
 	{
 	case SOCK_TEST_TYPE_ECHO:
-	  echo_test_client ();
+	  if (scm->use_batch)
+	    batch_echo_test_client ();
+	  else
+	    echo_test_client ();
 	  break;
 
 	case SOCK_TEST_TYPE_UNI:
@@ -1103,7 +1242,7 @@ main (int argc, char **argv)
   exit_client ();
   vppcom_session_close (ctrl->fd);
   vppcom_app_destroy ();
-  return 0;
+  return scm->test_failed;
 }
 
 /*
@@ -378,6 +378,7 @@ vppcom_app_create (char *app_name)
       clib_fifo_validate (vcm->client_session_index_fifo,
 			  vcm->cfg.listen_queue_size);
       clib_spinlock_init (&vcm->sessions_lockp);
+      clib_spinlock_init (&vcm->batch_lockp);
 
       vppcom_cfg (&vcm->cfg);
 
@@ -482,6 +483,7 @@ vppcom_session_create (u8 proto, u8 is_nonblocking)
   session->session_type = proto;
   session->session_state = STATE_START;
   session->vpp_handle = ~0;
+  session->is_dgram = proto == VPPCOM_PROTO_UDP;
 
   if (is_nonblocking)
     VCL_SESS_ATTR_SET (session->attr, VCL_SESS_ATTR_NONBLOCK);
@@ -983,15 +985,117 @@ done:
   return rv;
 }
 
+/*
+ * Datagram sessions
+ *
+ * Every datagram in a dgram session's fifos is preceded by a
+ * session_dgram_hdr_t that carries its length and peer. Unlike
+ * app_recv_dgram_raw, reads consume whole datagrams, truncating whatever
+ * does not fit in the caller's buffer, and writes never split a datagram.
+ */
+
+static inline u8
+vcl_session_is_open (vcl_session_t * session)
+{
+  /* Dgram listeners get fifos on bind and can exchange datagrams with
+   * any peer from then on */
+  return ((session->session_state & (SERVER_STATE_OPEN | CLIENT_STATE_OPEN))
+	  || (session->is_dgram && session->rx_fifo
+	      && (session->session_state & STATE_LISTEN)));
+}
+
+static inline void
+vcl_dgram_at_to_ep (app_session_transport_t * at, vppcom_endpt_t * ep)
+{
+  ep->is_ip4 = at->is_ip4;
+  ep->port = at->rmt_port;
+  if (at->is_ip4)
+    clib_memcpy (ep->ip, &at->rmt_ip.ip4, sizeof (ip4_address_t));
+  else
+    clib_memcpy (ep->ip, &at->rmt_ip.ip6, sizeof (ip6_address_t));
+}
+
+static inline void
+vcl_dgram_ep_to_at (vppcom_endpt_t * ep, app_session_transport_t * at)
+{
+  at->is_ip4 = ep->is_ip4;
+  at->rmt_port = ep->port;
+  memset (&at->rmt_ip, 0, sizeof (at->rmt_ip));
+  if (ep->is_ip4)
+    clib_memcpy (&at->rmt_ip.ip4, ep->ip, sizeof (ip4_address_t));
+  else
+    clib_memcpy (&at->rmt_ip.ip6, ep->ip, sizeof (ip6_address_t));
+}
+
+static inline int
+vcl_dgram_recv (svm_fifo_t * f, void *buf, u32 len,
+		app_session_transport_t * at, u8 peek)
+{
+  session_dgram_hdr_t hdr;
+  int rv;
+
+  if (svm_fifo_max_dequeue (f) < sizeof (hdr))
+    return VPPCOM_EAGAIN;
+
+  svm_fifo_peek (f, 0, sizeof (hdr), (u8 *) & hdr);
+  ASSERT (hdr.data_length >= hdr.data_offset);
+  at->rmt_ip = hdr.rmt_ip;
+  at->lcl_ip = hdr.lcl_ip;
+  at->rmt_port = hdr.rmt_port;
+  at->lcl_port = hdr.lcl_port;
+  at->is_ip4 = hdr.is_ip4;
+
+  len = clib_min (len, hdr.data_length - hdr.data_offset);
+  rv = svm_fifo_peek (f, hdr.data_offset + SESSION_CONN_HDR_LEN, len, buf);
+  if (!peek)
+    svm_fifo_dequeue_drop (f, hdr.data_length + SESSION_CONN_HDR_LEN);
+  return rv;
+}
+
+static inline int
+vcl_dgram_send (svm_fifo_t * f, app_session_transport_t * at, void *buf,
+		u32 len)
+{
+  session_dgram_hdr_t hdr;
+
+  if (svm_fifo_max_enqueue (f) < sizeof (hdr) + len)
+    return VPPCOM_EAGAIN;
+
+  hdr.data_length = len;
+  hdr.data_offset = 0;
+  hdr.rmt_ip = at->rmt_ip;
+  hdr.lcl_ip = at->lcl_ip;
+  hdr.rmt_port = at->rmt_port;
+  hdr.lcl_port = at->lcl_port;
+  hdr.is_ip4 = at->is_ip4;
+  svm_fifo_enqueue_nowait (f, sizeof (hdr), (u8 *) & hdr);
+  return svm_fifo_enqueue_nowait (f, len, buf);
+}
+
+/* Resolves the peer a datagram is sent to. Connected sessions default to
+ * their peer, dgram listeners need one for every datagram. */
+static inline int
+vcl_dgram_tx_transport (vcl_session_t * session, vppcom_endpt_t * ep,
+			app_session_transport_t * at)
+{
+  *at = session->transport;
+  if (ep)
+    vcl_dgram_ep_to_at (ep, at);
+  else if (!at->rmt_port)
+    return VPPCOM_EDESTADDRREQ;
+  return VPPCOM_OK;
+}
+
 static inline int
 vppcom_session_read_internal (uint32_t session_index, void *buf, int n,
-			      u8 peek)
+			      u8 peek, vppcom_endpt_t * ep)
 {
+  app_session_transport_t at;
   vcl_session_t *session = 0;
   svm_fifo_t *rx_fifo;
   int n_read = 0;
   int rv;
-  int is_nonblocking;
+  int is_nonblocking, is_dgram;
 
   u64 vpp_handle;
   u32 poll_et;
@@ -1002,6 +1106,7 @@ vppcom_session_read_internal (uint32_t session_index, void *buf, int n,
   VCL_SESSION_LOCK_AND_GET (session_index, &session);
 
   is_nonblocking = VCL_SESS_ATTR_TEST (session->attr, VCL_SESS_ATTR_NONBLOCK);
+  is_dgram = session->is_dgram;
   rx_fifo = session->rx_fifo;
   state = session->session_state;
   vpp_handle = session->vpp_handle;
@@ -1015,7 +1120,7 @@ vppcom_session_read_internal (uint32_t session_index, void *buf, int n,
       goto done;
     }
 
-  if (PREDICT_FALSE (!(state & (SERVER_STATE_OPEN | CLIENT_STATE_OPEN))))
+  if (PREDICT_FALSE (!vcl_session_is_open (session)))
     {
       VCL_SESSION_UNLOCK ();
       rv = ((state & STATE_DISCONNECT) ? VPPCOM_ECONNRESET : VPPCOM_ENOTCONN);
@@ -1031,7 +1136,13 @@ vppcom_session_read_internal (uint32_t session_index, void *buf, int n,
 
   do
     {
-      if (peek)
+      if (is_dgram)
+	{
+	  n_read = vcl_dgram_recv (rx_fifo, buf, n, &at, peek);
+	  if (n_read > 0 && ep)
+	    vcl_dgram_at_to_ep (&at, ep);
+	}
+      else if (peek)
 	n_read = svm_fifo_peek (rx_fifo, 0, n, buf);
       else
 	n_read = svm_fifo_dequeue_nowait (rx_fifo, n, buf);
@@ -1088,13 +1199,7 @@ done:
 int
 vppcom_session_read (uint32_t session_index, void *buf, size_t n)
 {
-  return (vppcom_session_read_internal (session_index, buf, n, 0));
-}
-
-static int
-vppcom_session_peek (uint32_t session_index, void *buf, int n)
-{
-  return (vppcom_session_read_internal (session_index, buf, n, 1));
+  return (vppcom_session_read_internal (session_index, buf, n, 0, 0));
 }
 
 static inline int
@@ -1115,7 +1220,7 @@ vppcom_session_read_ready (vcl_session_t * session, u32 session_index)
       goto done;
     }
 
-  if (session->session_state & STATE_LISTEN)
+  if ((session->session_state & STATE_LISTEN) && !session->is_dgram)
     {
       VCL_ACCEPT_FIFO_LOCK ();
       ready = clib_fifo_elts (vcm->client_session_index_fifo);
@@ -1179,15 +1284,17 @@ done:
   return rv;
 }
 
-int
-vppcom_session_write (uint32_t session_index, void *buf, size_t n)
+static int
+vppcom_session_write_internal (uint32_t session_index, void *buf, size_t n,
+			       vppcom_endpt_t * ep)
 {
   vcl_session_t *session = 0;
   svm_fifo_t *tx_fifo = 0;
   svm_queue_t *q;
   session_fifo_event_t evt;
   session_state_t state;
-  int rv, n_write, is_nonblocking;
+  app_session_transport_t at;
+  int rv, n_write, is_nonblocking, is_dgram;
   u32 poll_et;
   u64 vpp_handle;
 
@@ -1197,6 +1304,7 @@ vppcom_session_write (uint32_t session_index, void *buf, size_t n)
 
   tx_fifo = session->tx_fifo;
   is_nonblocking = VCL_SESS_ATTR_TEST (session->attr, VCL_SESS_ATTR_NONBLOCK);
+  is_dgram = session->is_dgram;
   vpp_handle = session->vpp_handle;
   state = session->session_state;
 
@@ -1211,7 +1319,7 @@ vppcom_session_write (uint32_t session_index, void *buf, size_t n)
       goto done;
     }
 
-  if (!(session->session_state & (SERVER_STATE_OPEN | CLIENT_STATE_OPEN)))
+  if (!vcl_session_is_open (session))
     {
       rv =
 	((session->session_state & STATE_DISCONNECT) ? VPPCOM_ECONNRESET :
@@ -1225,11 +1333,34 @@ vppcom_session_write (uint32_t session_index, void *buf, size_t n)
       goto done;
     }
 
+  if (is_dgram)
+    {
+      /* Datagrams are never split and empty ones can't be carried by the
+       * session layer */
+      rv = vcl_dgram_tx_transport (session, ep, &at);
+      if (!rv && n + sizeof (session_dgram_hdr_t) > tx_fifo->nitems)
+	rv = VPPCOM_EMSGSIZE;
+      if (rv || !n)
+	{
+	  VCL_SESSION_UNLOCK ();
+	  goto done;
+	}
+    }
+  else if (ep)
+    {
+      VCL_SESSION_UNLOCK ();
+      rv = VPPCOM_EINVAL;
+      goto done;
+    }
+
   VCL_SESSION_UNLOCK ();
 
   do
     {
-      n_write = svm_fifo_enqueue_nowait (tx_fifo, n, (void *) buf);
+      if (is_dgram)
+	n_write = vcl_dgram_send (tx_fifo, &at, buf, n);
+      else
+	n_write = svm_fifo_enqueue_nowait (tx_fifo, n, (void *) buf);
     }
   while (!is_nonblocking && (n_write <= 0));
 
@@ -1303,6 +1434,12 @@ done:
   return rv;
 }
 
+int
+vppcom_session_write (uint32_t session_index, void *buf, size_t n)
+{
+  return vppcom_session_write_internal (session_index, buf, n, 0);
+}
+
 static inline int
 vppcom_session_write_ready (vcl_session_t * session, u32 session_index)
 {
@@ -1322,7 +1459,8 @@ vppcom_session_write_ready (vcl_session_t * session, u32 session_index)
       goto done;
     }
 
-  if (PREDICT_FALSE (session->session_state & STATE_LISTEN))
+  if (PREDICT_FALSE ((session->session_state & STATE_LISTEN)
+		     && !vcl_session_is_open (session)))
     {
       clib_warning ("VCL<%d>: ERROR: vpp handle 0x%llx, sid %u: "
 		    "cannot write to a listen session!",
@@ -1331,7 +1469,7 @@ vppcom_session_write_ready (vcl_session_t * session, u32 session_index)
       goto done;
     }
 
-  if (!(session->session_state & (SERVER_STATE_OPEN | CLIENT_STATE_OPEN)))
+  if (!vcl_session_is_open (session))
     {
       session_state_t state = session->session_state;
 
@@ -2605,21 +2743,16 @@ vppcom_session_recvfrom (uint32_t session_index, void *buffer,
 	  VCL_SESSION_UNLOCK ();
 	  goto done;
 	}
-      ep->is_ip4 = session->transport.is_ip4;
-      ep->port = session->transport.rmt_port;
-      if (session->transport.is_ip4)
-	clib_memcpy (ep->ip, &session->transport.rmt_ip.ip4,
-		     sizeof (ip4_address_t));
-      else
-	clib_memcpy (ep->ip, &session->transport.rmt_ip.ip6,
-		     sizeof (ip6_address_t));
+      /* Dgram sessions report the source of the datagram read */
+      if (!session->is_dgram)
+	vcl_dgram_at_to_ep (&session->transport, ep);
       VCL_SESSION_UNLOCK ();
     }
 
   if (flags == 0)
-    rv = vppcom_session_read (session_index, buffer, buflen);
+    rv = vppcom_session_read_internal (session_index, buffer, buflen, 0, ep);
   else if (flags & MSG_PEEK)
-    rv = vppcom_session_peek (session_index, buffer, buflen);
+    rv = vppcom_session_read_internal (session_index, buffer, buflen, 1, ep);
   else
     {
       clib_warning ("VCL<%d>: Unsupport flags for recvfrom %d",
@@ -2638,12 +2771,6 @@ vppcom_session_sendto (uint32_t session_index, void *buffer,
   if (!buffer)
     return VPPCOM_EINVAL;
 
-  if (ep)
-    {
-      // TBD
-      return VPPCOM_EINVAL;
-    }
-
   if (flags)
     {
       // TBD check the flags and do the right thing
@@ -2651,7 +2778,8 @@ vppcom_session_sendto (uint32_t session_index, void *buffer,
 	    getpid (), flags, flags);
     }
 
-  return (vppcom_session_write (session_index, buffer, buflen));
+  /* Only dgram sessions accept a destination */
+  return (vppcom_session_write_internal (session_index, buffer, buflen, ep));
 }
 
 int
@@ -2758,6 +2886,399 @@ vppcom_poll (vcl_poll_t * vp, uint32_t n_sids, double wait_for_time)
   return num_ev;
 }
 
+/*
+ * Batched io
+ *
+ * Ops never block: anything that can't make progress stays on the pending
+ * list and is retried on the next submit/reap. Tx notifications for all
+ * fifos written in one pass are coalesced and handed to each vpp event
+ * queue under a single mutex acquisition.
+ */
+
+static int
+vcl_batch_session_check (vcl_session_t * session)
+{
+  session_state_t state = session->session_state;
+
+  if (PREDICT_FALSE (session->is_vep))
+    return VPPCOM_EBADFD;
+  if (PREDICT_FALSE (!vcl_session_is_open (session)))
+    return ((state & STATE_DISCONNECT) ? VPPCOM_ECONNRESET :
+	    VPPCOM_ENOTCONN);
+  return VPPCOM_OK;
+}
+
+static int
+vcl_batch_empty_fifo (u32 session_index, u32 et_event)
+{
+  vcl_session_t *session = 0;
+  int rv;
+
+  VCL_SESSION_LOCK_AND_GET (session_index, &session);
+  if (((EPOLLET | et_event) & session->vep.ev.events) == (EPOLLET | et_event))
+    session->vep.et_mask |= et_event;
+  if (session->session_state & STATE_CLOSE_ON_EMPTY)
+    {
+      session->session_state = STATE_DISCONNECT;
+      rv = VPPCOM_ECONNRESET;
+    }
+  else
+    rv = VPPCOM_EAGAIN;
+  VCL_SESSION_UNLOCK ();
+done:
+  return rv;
+}
+
+static int
+vcl_batch_read (vppcom_batch_op_t * op)
+{
+  vcl_session_t *session = 0;
+  app_session_transport_t at;
+  svm_fifo_t *rx_fifo;
+  int rv, n_read, is_dgram;
+
+  VCL_SESSION_LOCK_AND_GET (op->session_index, &session);
+  rv = vcl_batch_session_check (session);
+  rx_fifo = session->rx_fifo;
+  is_dgram = session->is_dgram;
+  VCL_SESSION_UNLOCK ();
+  if (rv)
+    goto done;
+
+  if (is_dgram)
+    {
+      n_read = vcl_dgram_recv (rx_fifo, op->buf, op->len, &at, 0);
+      if (n_read > 0 && op->ep)
+	vcl_dgram_at_to_ep (&at, op->ep);
+    }
+  else
+    n_read = svm_fifo_dequeue_nowait (rx_fifo, op->len, op->buf);
+  if (n_read > 0)
+    return n_read;
+
+  rv = vcl_batch_empty_fifo (op->session_index, EPOLLIN);
+done:
+  return rv;
+}
+
+static int
+vcl_batch_write (vppcom_batch_op_t * op)
+{
+  vcl_session_t *session = 0;
+  app_session_transport_t at;
+  vcl_batch_tx_evt_t *te;
+  svm_fifo_t *tx_fifo;
+  svm_queue_t *q;
+  int rv, n_write, is_dgram;
+
+  VCL_SESSION_LOCK_AND_GET (op->session_index, &session);
+  rv = vcl_batch_session_check (session);
+  tx_fifo = session->tx_fifo;
+  q = session->vpp_evt_q;
+  is_dgram = session->is_dgram;
+  if (!rv && is_dgram)
+    {
+      rv = vcl_dgram_tx_transport (session, op->ep, &at);
+      if (!rv && op->len + sizeof (session_dgram_hdr_t) > tx_fifo->nitems)
+	rv = VPPCOM_EMSGSIZE;
+    }
+  VCL_SESSION_UNLOCK ();
+  if (rv || (is_dgram && !op->len))
+    goto done;
+
+  if (is_dgram)
+    n_write = vcl_dgram_send (tx_fifo, &at, op->buf, op->len);
+  else
+    n_write = svm_fifo_enqueue_nowait (tx_fifo, op->len, op->buf);
+  if (n_write > 0)
+    {
+      /* Only the first write to a fifo since vpp last drained it needs
+       * an event, and that one is deferred until the end of the pass */
+      if (svm_fifo_set_event (tx_fifo))
+	{
+	  ASSERT (q);
+	  vec_add2 (vcm->batch_tx_evts, te, 1);
+	  te->q = q;
+	  te->evt.fifo = tx_fifo;
+	  te->evt.event_type = FIFO_EVENT_APP_TX;
+	}
+      return n_write;
+    }
+
+  rv = vcl_batch_empty_fifo (op->session_index, EPOLLOUT);
+done:
+  return rv;
+}
+
+static int
+vcl_batch_accept (vppcom_batch_op_t * op)
+{
+  vcl_session_t *session = 0;
+  int rv, is_listen;
+
+  VCL_SESSION_LOCK_AND_GET (op->session_index, &session);
+  is_listen = (session->session_state & STATE_LISTEN) != 0;
+  VCL_SESSION_UNLOCK ();
+  if (!is_listen)
+    return VPPCOM_EBADFD;
+
+  VCL_ACCEPT_FIFO_LOCK ();
+  rv = clib_fifo_elts (vcm->client_session_index_fifo);
+  VCL_ACCEPT_FIFO_UNLOCK ();
+  if (!rv)
+    return VPPCOM_EAGAIN;
+
+  rv = vppcom_session_accept (op->session_index, op->ep, op->flags);
+done:
+  return rv;
+}
+
+static void
+vcl_batch_flush_tx_evts (void)
+{
+  vcl_batch_tx_evt_t *evts = vcm->batch_tx_evts;
+  svm_queue_t *q;
+  u32 i, j, n_evts = vec_len (evts);
+
+  for (i = 0; i < n_evts; i++)
+    {
+      if (!(q = evts[i].q))
+	continue;
+      /* Sessions of one app mostly share a handful of vpp queues, so
+       * grab each queue once and push all of its events */
+      svm_queue_lock (q);
+      for (j = i; j < n_evts; j++)
+	{
+	  if (evts[j].q != q)
+	    continue;
+	  svm_queue_add_nolock (q, (u8 *) & evts[j].evt);
+	  evts[j].q = 0;
+	}
+      svm_queue_unlock (q);
+    }
+  _vec_len (vcm->batch_tx_evts) = 0;
+}
+
+/* Assumes caller holds vcm->batch_lockp */
+static u32
+vcl_batch_run_pending (void)
+{
+  vppcom_batch_op_t *op;
+  vppcom_batch_cqe_t *cqe;
+  u32 i, n_left = 0, n_done = 0;
+  int rv;
+
+  for (i = 0; i < vec_len (vcm->batch_pending); i++)
+    {
+      op = &vcm->batch_pending[i];
+      switch (op->op)
+	{
+	case VPPCOM_BATCH_OP_READ:
+	  rv = vcl_batch_read (op);
+	  break;
+	case VPPCOM_BATCH_OP_WRITE:
+	  rv = vcl_batch_write (op);
+	  break;
+	case VPPCOM_BATCH_OP_ACCEPT:
+	  rv = vcl_batch_accept (op);
+	  break;
+	default:
+	  rv = VPPCOM_EINVAL;
+	  break;
+	}
+
+      if (rv == VPPCOM_EAGAIN)
+	{
+	  if (n_left != i)
+	    vcm->batch_pending[n_left] = *op;
+	  n_left++;
+	  continue;
+	}
+
+      clib_fifo_add2 (vcm->batch_cq, cqe);
+      cqe->user_data = op->user_data;
+      cqe->session_index = op->session_index;
+      cqe->result = rv;
+      n_done++;
+    }
+  _vec_len (vcm->batch_pending) = n_left;
+
+  if (vec_len (vcm->batch_tx_evts))
+    vcl_batch_flush_tx_evts ();
+
+  return n_done;
+}
+
+int
+vppcom_batch_submit (vppcom_batch_op_t * ops, uint32_t n_ops)
+{
+  if (PREDICT_FALSE (!ops && n_ops))
+    return VPPCOM_EINVAL;
+
+  clib_spinlock_lock (&vcm->batch_lockp);
+  vec_add (vcm->batch_pending, ops, n_ops);
+  vcl_batch_run_pending ();
+  clib_spinlock_unlock (&vcm->batch_lockp);
+
+  VDBG (2, "VCL<%d>: submitted %u ops", getpid (), n_ops);
+  return n_ops;
+}
+
+int
+vppcom_batch_reap (vppcom_batch_cqe_t * cqes, uint32_t max_cqes,
+		   double wait_for_time)
+{
+  f64 timeout = clib_time_now (&vcm->clib_time) + wait_for_time;
+  u32 n_reaped = 0;
+
+  if (PREDICT_FALSE (!cqes || !max_cqes))
+    return VPPCOM_EINVAL;
+
+  do
+    {
+      clib_spinlock_lock (&vcm->batch_lockp);
+      if (vec_len (vcm->batch_pending))
+	vcl_batch_run_pending ();
+      while (n_reaped < max_cqes && clib_fifo_elts (vcm->batch_cq))
+	clib_fifo_sub1 (vcm->batch_cq, cqes[n_reaped++]);
+      clib_spinlock_unlock (&vcm->batch_lockp);
+
+      if (n_reaped || wait_for_time == 0)
+	break;
+    }
+  while (wait_for_time == -1
+	 || clib_time_now (&vcm->clib_time) <= timeout);
+
+  return n_reaped;
+}
+
+/*
+ * Datagram batches
+ *
+ * The session is looked up once per call and vpp gets at most one tx
+ * notification per call, however many datagrams are moved.
+ */
+
+static int
+vcl_mmsg_session_get (uint32_t session_index, vcl_session_t * out)
+{
+  vcl_session_t *session = 0;
+  int rv = VPPCOM_OK;
+
+  VCL_SESSION_LOCK_AND_GET (session_index, &session);
+  if (PREDICT_FALSE (!session->is_dgram || session->is_vep))
+    rv = VPPCOM_EBADFD;
+  else if (PREDICT_FALSE (!vcl_session_is_open (session)))
+    rv = ((session->session_state & STATE_DISCONNECT) ? VPPCOM_ECONNRESET :
+	  VPPCOM_ENOTCONN);
+  else
+    *out = *session;
+  VCL_SESSION_UNLOCK ();
+done:
+  return rv;
+}
+
+int
+vppcom_session_recvmmsg (uint32_t session_index, vppcom_mmsg_t * msgs,
+			 uint32_t n_msgs, int flags)
+{
+  vcl_session_t _s, *s = &_s;
+  app_session_transport_t at;
+  vppcom_mmsg_t *msg;
+  int rv, n_read;
+  u32 i = 0;
+
+  if (!msgs)
+    return VPPCOM_EFAULT;
+  if (flags)
+    return VPPCOM_EOPNOTSUPP;
+  if ((rv = vcl_mmsg_session_get (session_index, s)))
+    return rv;
+
+  while (i < n_msgs)
+    {
+      msg = &msgs[i];
+      n_read = vcl_dgram_recv (s->rx_fifo, msg->buf, msg->len, &at, 0);
+      if (n_read < 0)
+	{
+	  if (i || VCL_SESS_ATTR_TEST (s->attr, VCL_SESS_ATTR_NONBLOCK))
+	    break;
+	  continue;
+	}
+      msg->msg_len = n_read;
+      if (msg->ep)
+	vcl_dgram_at_to_ep (&at, msg->ep);
+      i++;
+    }
+
+  if (!i)
+    return vcl_batch_empty_fifo (session_index, EPOLLIN);
+
+  VDBG (2, "VCL<%d>: vpp handle 0x%llx, sid %u: read %u datagrams",
+	getpid (), s->vpp_handle, session_index, i);
+  return i;
+}
+
+int
+vppcom_session_sendmmsg (uint32_t session_index, vppcom_mmsg_t * msgs,
+			 uint32_t n_msgs, int flags)
+{
+  vcl_session_t _s, *s = &_s;
+  app_session_transport_t at;
+  session_fifo_event_t evt;
+  vppcom_mmsg_t *msg;
+  int rv, n_write;
+  u32 i = 0;
+
+  if (!msgs)
+    return VPPCOM_EFAULT;
+  if (flags)
+    return VPPCOM_EOPNOTSUPP;
+  if ((rv = vcl_mmsg_session_get (session_index, s)))
+    return rv;
+
+  while (i < n_msgs)
+    {
+      msg = &msgs[i];
+      if ((rv = vcl_dgram_tx_transport (s, msg->ep, &at)))
+	break;
+      if (msg->len + sizeof (session_dgram_hdr_t) > s->tx_fifo->nitems)
+	{
+	  rv = VPPCOM_EMSGSIZE;
+	  break;
+	}
+      if (!msg->len)
+	{
+	  msg->msg_len = 0;
+	  i++;
+	  continue;
+	}
+      n_write = vcl_dgram_send (s->tx_fifo, &at, msg->buf, msg->len);
+      if (n_write < 0)
+	{
+	  if (i || VCL_SESS_ATTR_TEST (s->attr, VCL_SESS_ATTR_NONBLOCK))
+	    break;
+	  continue;
+	}
+      msg->msg_len = n_write;
+      i++;
+    }
+
+  if (i && svm_fifo_set_event (s->tx_fifo))
+    {
+      evt.fifo = s->tx_fifo;
+      evt.event_type = FIFO_EVENT_APP_TX;
+      svm_queue_add (s->vpp_evt_q, (u8 *) & evt, 0 /* do wait for mutex */ );
+    }
+
+  if (!i)
+    return rv ? rv : vcl_batch_empty_fifo (session_index, EPOLLOUT);
+
+  VDBG (2, "VCL<%d>: vpp handle 0x%llx, sid %u: wrote %u datagrams",
+	getpid (), s->vpp_handle, session_index, i);
+  return i;
+}
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
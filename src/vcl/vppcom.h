@@ -97,6 +97,9 @@ typedef enum
   VPPCOM_ENOTCONN = -ENOTCONN,
   VPPCOM_ECONNREFUSED = -ECONNREFUSED,
   VPPCOM_ETIMEDOUT = -ETIMEDOUT,
+  VPPCOM_EMSGSIZE = -EMSGSIZE,
+  VPPCOM_EDESTADDRREQ = -EDESTADDRREQ,
+  VPPCOM_EOPNOTSUPP = -EOPNOTSUPP,
 } vppcom_error_t;
 
 typedef enum
@@ -144,6 +147,50 @@ typedef struct _vcl_poll
   short *revents;
 } vcl_poll_t;
 
+typedef enum
+{
+  VPPCOM_BATCH_OP_READ,
+  VPPCOM_BATCH_OP_WRITE,
+  VPPCOM_BATCH_OP_ACCEPT,
+} vppcom_batch_op_type_t;
+
+/* Batch submission entry. Ops that cannot complete immediately stay
+ * queued in vcl and are retried on every submit/reap, so buf and ep must
+ * remain valid until the matching completion is reaped. */
+typedef struct vppcom_batch_op_t_
+{
+  uint8_t op;			/* vppcom_batch_op_type_t */
+  uint32_t session_index;
+  void *buf;			/* read/write buffer */
+  uint32_t len;			/* read/write length */
+  uint32_t flags;		/* accept flags */
+  vppcom_endpt_t *ep;		/* accept peer or dgram peer, optional */
+  uint64_t user_data;		/* returned as-is in the completion */
+} vppcom_batch_op_t;
+
+/* Batch completion entry: result is the number of bytes read/written,
+ * the accepted session index or a negative vppcom_error_t */
+typedef struct vppcom_batch_cqe_t_
+{
+  uint64_t user_data;
+  int32_t result;
+  uint32_t session_index;
+} vppcom_batch_cqe_t;
+
+/* One datagram in a recvmmsg/sendmmsg style call. On receive, len is the
+ * size of buf, msg_len is set to the number of bytes copied and ep, if
+ * set, to the datagram's source. Datagrams larger than buf are truncated.
+ * On send, len bytes are sent as one datagram to ep or, if ep is not set,
+ * to the session's connected peer. No flags are supported yet, calls with
+ * non-zero flags fail with VPPCOM_EOPNOTSUPP. */
+typedef struct vppcom_mmsg_t_
+{
+  void *buf;
+  uint32_t len;
+  uint32_t msg_len;
+  vppcom_endpt_t *ep;
+} vppcom_mmsg_t;
+
 /*
  * VPPCOM Public API Functions
  */
@@ -202,6 +249,18 @@ vppcom_retval_str (int retval)
       st = "VPPCOM_ETIMEDOUT";
       break;
 
+    case VPPCOM_EMSGSIZE:
+      st = "VPPCOM_EMSGSIZE";
+      break;
+
+    case VPPCOM_EDESTADDRREQ:
+      st = "VPPCOM_EDESTADDRREQ";
+      break;
+
+    case VPPCOM_EOPNOTSUPP:
+      st = "VPPCOM_EOPNOTSUPP";
+      break;
+
     default:
       st = "UNKNOWN_STATE";
       break;
@@ -249,6 +308,15 @@ extern int vppcom_session_sendto (uint32_t session_index, void *buffer,
 				  vppcom_endpt_t * ep);
 extern int vppcom_poll (vcl_poll_t * vp, uint32_t n_sids,
 			double wait_for_time);
+extern int vppcom_session_recvmmsg (uint32_t session_index,
+				    vppcom_mmsg_t * msgs, uint32_t n_msgs,
+				    int flags);
+extern int vppcom_session_sendmmsg (uint32_t session_index,
+				    vppcom_mmsg_t * msgs, uint32_t n_msgs,
+				    int flags);
+extern int vppcom_batch_submit (vppcom_batch_op_t * ops, uint32_t n_ops);
+extern int vppcom_batch_reap (vppcom_batch_cqe_t * cqes, uint32_t max_cqes,
+			      double wait_for_time);
 
 /*
  * VPPCOM Event Functions
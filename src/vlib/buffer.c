@@ -45,9 +45,21 @@
 
 #include <vlib/vlib.h>
 #include <vlib/unix/unix.h>
+#include <vppinfra/linux/sysfs.h>
 
 vlib_buffer_callbacks_t *vlib_buffer_callbacks = 0;
 static u32 vlib_buffer_physmem_sz = 32 << 20;
+static u8 vlib_buffer_numa_pools = 1;
+
+/* Buffer pools with other data sizes than the default one, from the
+   "buffers" startup config section. */
+typedef struct
+{
+  u32 n_data_bytes;
+  u32 physmem_size;
+} vlib_buffer_pool_config_t;
+
+static vlib_buffer_pool_config_t *vlib_buffer_pool_configs;
 
 vlib_buffer_main_t buffer_main;
 
@@ -381,7 +393,8 @@ vlib_buffer_create_free_list_helper (vlib_main_t * vm,
   f->index = f - vm->buffer_free_list_pool;
   f->n_data_bytes = vlib_buffer_round_size (n_data_bytes);
   f->min_n_buffers_each_alloc = VLIB_FRAME_SIZE;
-  f->buffer_pool_index = 0;
+  f->buffer_pool_index =
+    vlib_buffer_pool_get_for_size (vm, vm->numa_node, f->n_data_bytes);
   f->name = clib_mem_is_vec (name) ? name : format (0, "%s", name);
 
   /* Setup free buffer template. */
@@ -395,6 +408,21 @@ vlib_buffer_create_free_list_helper (vlib_main_t * vm,
 	hash_set (bm->free_list_by_size, f->n_data_bytes, f->index);
     }
 
+  /* No buffer pool has room for that much data, use what there is. */
+  if (!bm->callbacks_registered && vec_len (bm->buffer_pools))
+    {
+      vlib_buffer_pool_t *bp = vlib_buffer_pool_get (f->buffer_pool_index);
+      u32 n_pool_data_bytes = bp->buffer_size - sizeof (vlib_buffer_t);
+
+      if (f->n_data_bytes > n_pool_data_bytes)
+	{
+	  clib_warning ("free list %v: no buffer pool with %d data bytes, "
+			"using %d", f->name, f->n_data_bytes,
+			n_pool_data_bytes);
+	  f->n_data_bytes = n_pool_data_bytes;
+	}
+    }
+
   for (i = 1; i < vec_len (vlib_mains); i++)
     {
       vlib_main_t *wvm = vlib_mains[i];
@@ -405,7 +433,10 @@ vlib_buffer_create_free_list_helper (vlib_main_t * vm,
 	      wf - wvm->buffer_free_list_pool);
       wf[0] = f[0];
       wf->buffers = 0;
+      wf->remote_buffers = 0;
       wf->n_alloc = 0;
+      wf->buffer_pool_index =
+	vlib_buffer_pool_get_for_size (wvm, wvm->numa_node, f->n_data_bytes);
     }
 
   return f->index;
@@ -428,15 +459,113 @@ vlib_buffer_create_free_list (vlib_main_t * vm, u32 n_data_bytes,
 					      name);
 }
 
+/* Shared free list for buffers of the given data size, which also picks
+   the buffer pool they come from. The default free list if no buffer
+   pool has room for that much data. */
+vlib_buffer_free_list_index_t
+vlib_buffer_get_or_create_free_list (vlib_main_t * vm, u32 n_data_bytes,
+				     char *fmt, ...)
+{
+  vlib_buffer_main_t *bm = &buffer_main;
+  vlib_buffer_pool_t *bp;
+  va_list va;
+  uword *p;
+  u8 *name;
+
+  n_data_bytes = vlib_buffer_round_size (n_data_bytes);
+  p = hash_get (bm->free_list_by_size, n_data_bytes);
+  if (p)
+    return p[0];
+
+  /* Buffers of external buffer managers have their own sizes */
+  if (bm->callbacks_registered || vec_len (bm->buffer_pools) == 0)
+    return VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX;
+
+  bp = vlib_buffer_pool_get (vlib_buffer_pool_get_for_size
+			     (vm, vm->numa_node, n_data_bytes));
+  if (bp->buffer_size < sizeof (vlib_buffer_t) + n_data_bytes)
+    return VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX;
+
+  va_start (va, fmt);
+  name = va_format (0, fmt, &va);
+  va_end (va);
+
+  return vlib_buffer_create_free_list_helper (vm, n_data_bytes,
+					      /* is_public */ 1,
+					      /* is_default */ 0,
+					      name);
+}
+
+static void
+vlib_buffer_flush_remote_free_list (vlib_main_t * vm,
+				    vlib_buffer_free_list_t * f)
+{
+  vlib_buffer_pool_t *bp =
+    vlib_buffer_pool_get (f->remote_buffer_pool_index);
+
+  if (vec_len (f->remote_buffers) == 0)
+    return;
+
+  /* Keep them if their pool has no room, better than losing them. Only
+     buffers of the same size can go on the free list, others wait for
+     the next flush. */
+  if (vlib_buffer_pool_put (bp, f->remote_buffers,
+			    vec_len (f->remote_buffers)))
+    f->n_alloc -= vec_len (f->remote_buffers);
+  else
+    {
+      if (bp->buffer_size !=
+	  vlib_buffer_pool_get (f->buffer_pool_index)->buffer_size)
+	return;
+      vec_add_aligned (f->buffers, f->remote_buffers,
+		       vec_len (f->remote_buffers), CLIB_CACHE_LINE_BYTES);
+    }
+
+  vec_reset_length (f->remote_buffers);
+}
+
+/* Buffers freed by a thread on another numa node than the one they
+   belong to, or from another pool than the free list's, are batched and
+   returned to their own pool. */
+void
+vlib_buffer_add_to_remote_free_list (vlib_main_t * vm,
+				     vlib_buffer_free_list_t * f,
+				     u32 buffer_index, u8 buffer_pool_index)
+{
+  if (f->remote_buffer_pool_index != buffer_pool_index)
+    {
+      vlib_buffer_flush_remote_free_list (vm, f);
+      f->remote_buffer_pool_index = buffer_pool_index;
+    }
+
+  vec_add1_aligned (f->remote_buffers, buffer_index, CLIB_CACHE_LINE_BYTES);
+
+  if (vec_len (f->remote_buffers) >= VLIB_BUFFER_MAGAZINE_SIZE)
+    vlib_buffer_flush_remote_free_list (vm, f);
+}
+
 static void
 del_free_list (vlib_main_t * vm, vlib_buffer_free_list_t * f)
 {
   vlib_buffer_pool_t *bp = vlib_buffer_pool_get (f->buffer_pool_index);
+  u32 n;
+
+  vlib_buffer_flush_remote_free_list (vm, f);
+
+  while ((n = clib_min (vec_len (f->buffers), VLIB_BUFFER_MAGAZINE_SIZE)))
+    {
+      if (!vlib_buffer_pool_put (bp, vec_end (f->buffers) - n, n))
+	{
+	  clib_warning ("no room to return %d buffers to pool %d",
+			vec_len (f->buffers), f->buffer_pool_index);
+	  break;
+	}
+      _vec_len (f->buffers) -= n;
+    }
 
-  vec_add_aligned (bp->buffers, f->buffers, vec_len (f->buffers),
-		   CLIB_CACHE_LINE_BYTES);
   vec_free (f->name);
   vec_free (f->buffers);
+  vec_free (f->remote_buffers);
 
   /* Poison it. */
   memset (f, 0xab, sizeof (f[0]));
@@ -500,8 +629,9 @@ vlib_buffer_fill_free_list_internal (vlib_main_t * vm,
 {
   vlib_buffer_t *b;
   vlib_buffer_pool_t *bp = vlib_buffer_pool_get (fl->buffer_pool_index);
+  vlib_buffer_magazine_t *m;
   int n;
-  u32 *bi;
+  u32 *bi, index;
   u32 n_alloc = 0;
 
   /* Already have enough free buffers on free list? */
@@ -509,20 +639,20 @@ vlib_buffer_fill_free_list_internal (vlib_main_t * vm,
   if (n <= 0)
     return min_free_buffers;
 
-  if (vec_len (bp->buffers) > 0)
+  /* Take whole magazines of free buffers from the pool, lock-free */
+  while (n > 0 && bp->magazines &&
+	 (index = vlib_buffer_magazine_pop (bp, &bp->full_magazines)) != ~0)
     {
-      int n_copy, n_left;
-      clib_spinlock_lock (&bp->lock);
-      n_copy = clib_min (vec_len (bp->buffers), n);
-      n_left = vec_len (bp->buffers) - n_copy;
-      vec_add_aligned (fl->buffers, bp->buffers + n_left, n_copy,
+      m = bp->magazines + index;
+      vec_add_aligned (fl->buffers, m->buffers, m->n_buffers,
 		       CLIB_CACHE_LINE_BYTES);
-      _vec_len (bp->buffers) = n_left;
-      clib_spinlock_unlock (&bp->lock);
-      n = min_free_buffers - vec_len (fl->buffers);
-      if (n <= 0)
-	return min_free_buffers;
+      __sync_fetch_and_sub (&bp->n_free, m->n_buffers);
+      fl->n_alloc += m->n_buffers;
+      n -= m->n_buffers;
+      vlib_buffer_magazine_push (bp, &bp->empty_magazines, index);
     }
+  if (n <= 0)
+    return min_free_buffers;
 
   /* Always allocate round number of buffers. */
   n = round_pow2 (n, CLIB_CACHE_LINE_BYTES / sizeof (u32));
@@ -546,6 +676,7 @@ vlib_buffer_fill_free_list_internal (vlib_main_t * vm,
 
       memset (b, 0, sizeof (vlib_buffer_t));
       vlib_buffer_init_for_free_list (b, fl);
+      b->buffer_pool_index = bp - buffer_main.buffer_pools;
 
       if (fl->buffer_init_function)
 	fl->buffer_init_function (vm, fl, bi, 1);
@@ -554,6 +685,19 @@ vlib_buffer_fill_free_list_internal (vlib_main_t * vm,
 done:
   clib_spinlock_unlock (&bp->lock);
   fl->n_alloc += n_alloc;
+
+  /* Last resort, buffers of another numa node freed here */
+  if (vec_len (fl->buffers) < min_free_buffers &&
+      vec_len (fl->remote_buffers) &&
+      vlib_buffer_pool_get (fl->remote_buffer_pool_index)->buffer_size ==
+      bp->buffer_size)
+    {
+      vec_add_aligned (fl->buffers, fl->remote_buffers,
+		       vec_len (fl->remote_buffers), CLIB_CACHE_LINE_BYTES);
+      n_alloc += vec_len (fl->remote_buffers);
+      vec_reset_length (fl->remote_buffers);
+    }
+
   return n_alloc;
 }
 
@@ -609,6 +753,9 @@ recycle_or_free (vlib_main_t * vm, vlib_buffer_main_t * bm, u32 bi,
 		{
 		  vlib_buffer_validate_alloc_free (vm, &bi, 1,
 						   VLIB_BUFFER_KNOWN_ALLOCATED);
+		  /* Whoever allocates the buffer next must not find it
+		     sampled */
+		  nb->flags &= ~VLIB_BUFFER_IS_SAMPLED;
 		  vlib_buffer_add_to_free_list (vm, fl, bi, 1);
 		}
 	      bi = next;
@@ -944,22 +1091,119 @@ vlib_buffer_pool_create (vlib_main_t * vm, vlib_physmem_region_index_t pri,
     goto done;
 
   p->log2_page_size = pr->log2_page_size;
+  p->numa_node = pr->numa_node;
   p->buffer_size = buffer_size;
   p->buffers_per_page = (1 << pr->log2_page_size) / p->buffer_size;
   p->n_elts = p->buffers_per_page * pr->n_pages;
   p->n_used = 0;
   clib_spinlock_init (&p->lock);
+
+  /* Twice as many magazines as needed to hold all the buffers, some may
+     be returned partially filled. */
+  {
+    u32 i, n_magazines = 2 * (p->n_elts / VLIB_BUFFER_MAGAZINE_SIZE + 1);
+
+    vec_validate_aligned (p->magazines, n_magazines - 1,
+			  CLIB_CACHE_LINE_BYTES);
+    p->full_magazines = p->empty_magazines = (u32) ~ 0;
+    for (i = 0; i < n_magazines; i++)
+      vlib_buffer_magazine_push (p, &p->empty_magazines, i);
+  }
 done:
   ASSERT (p - bm->buffer_pools < 256);
   return p - bm->buffer_pools;
 }
 
+u8
+vlib_buffer_pool_get_default_for_numa (vlib_main_t * vm, u32 numa_node)
+{
+  vlib_buffer_main_t *bm = &buffer_main;
+
+  if (numa_node < vec_len (bm->default_buffer_pool_index_by_numa) &&
+      bm->default_buffer_pool_index_by_numa[numa_node] != (u8) ~ 0)
+    return bm->default_buffer_pool_index_by_numa[numa_node];
+
+  return 0;
+}
+
+/* Smallest pool with room for the given data size, on the given numa
+   node if there is one there. */
+u8
+vlib_buffer_pool_get_for_size (vlib_main_t * vm, u32 numa_node,
+			       u32 n_data_bytes)
+{
+  vlib_buffer_main_t *bm = &buffer_main;
+  vlib_buffer_pool_t *bp, *best = 0;
+  u32 buffer_size = sizeof (vlib_buffer_t) + n_data_bytes;
+
+  vec_foreach (bp, bm->buffer_pools)
+  {
+    int is_local = bp->numa_node == numa_node;
+    int best_is_local = best && best->numa_node == numa_node;
+
+    if (bp->buffer_size < buffer_size)
+      continue;
+
+    if (best == 0 || is_local > best_is_local ||
+	(is_local == best_is_local && bp->buffer_size < best->buffer_size))
+      best = bp;
+  }
+
+  if (best == 0)
+    return vlib_buffer_pool_get_default_for_numa (vm, numa_node);
+
+  return best - bm->buffer_pools;
+}
+
+static clib_error_t *
+vlib_buffer_region_alloc (vlib_main_t * vm, char *name, u32 size,
+			  u32 numa_node, vlib_physmem_region_index_t * pri)
+{
+  clib_error_t *error;
+
+  error = vlib_physmem_region_alloc (vm, name, size, numa_node,
+				     VLIB_PHYSMEM_F_SHARED |
+				     VLIB_PHYSMEM_F_HUGETLB, pri);
+  if (error == 0)
+    return 0;
+
+  clib_error_free (error);
+
+  return vlib_physmem_region_alloc (vm, name, size, numa_node,
+				    VLIB_PHYSMEM_F_SHARED, pri);
+}
+
+static u8 *
+format_vlib_buffer_pool (u8 * s, va_list * va)
+{
+  vlib_buffer_pool_t *bp = va_arg (*va, vlib_buffer_pool_t *);
+  u32 n_full = 0;
+  u64 top;
+
+  if (!bp)
+    return format (s, "%=7s%=7s%=12s%=12s%=12s%=12s%=12s", "Pool", "Numa",
+		   "Size", "Total", "Used", "Magazines", "Free");
+
+  /* Racy walk, for display only */
+  top = bp->full_magazines;
+  while ((u32) top != ~0 && n_full < vec_len (bp->magazines))
+    {
+      top = bp->magazines[(u32) top].next;
+      n_full++;
+    }
+
+  return format (s, "%7d%7d%12d%12d%12d%12d%12d",
+		 bp - buffer_main.buffer_pools, bp->numa_node,
+		 bp->buffer_size, bp->n_elts, bp->n_used, n_full, bp->n_free);
+}
+
 static u8 *
 format_vlib_buffer_free_list (u8 * s, va_list * va)
 {
   vlib_buffer_free_list_t *f = va_arg (*va, vlib_buffer_free_list_t *);
   u32 threadnum = va_arg (*va, u32);
-  uword bytes_alloc, bytes_free, n_free, size;
+  uword bytes_free, n_free, size;
+  u8 *alloc;
 
   if (!f)
     return format (s, "%=7s%=30s%=12s%=12s%=12s%=12s%=12s%=12s",
@@ -968,14 +1212,19 @@ format_vlib_buffer_free_list (u8 * s, va_list * va)
 
   size = sizeof (vlib_buffer_t) + f->n_data_bytes;
   n_free = vec_len (f->buffers);
-  bytes_alloc = size * f->n_alloc;
   bytes_free = size * n_free;
 
-  s = format (s, "%7d%30v%12d%12d%=12U%=12U%=12d%=12d", threadnum,
-	      f->name, f->index, f->n_data_bytes,
-	      format_memory_size, bytes_alloc,
+  /* Negative on a thread which frees more buffers than it allocates */
+  if (f->n_alloc >= 0)
+    alloc = format (0, "%U", format_memory_size, size * f->n_alloc);
+  else
+    alloc = format (0, "-%U", format_memory_size, size * -f->n_alloc);
+
+  s = format (s, "%7d%30v%12d%12d%=12v%=12U%=12d%=12d", threadnum,
+	      f->name, f->index, f->n_data_bytes, alloc,
 	      format_memory_size, bytes_free, f->n_alloc, n_free);
 
+  vec_free (alloc);
   return s;
 }
 
@@ -983,10 +1232,20 @@ static clib_error_t *
 show_buffers (vlib_main_t * vm,
 	      unformat_input_t * input, vlib_cli_command_t * cmd)
 {
+  vlib_buffer_main_t *bm = &buffer_main;
   vlib_buffer_free_list_t *f;
+  vlib_buffer_pool_t *bp;
   vlib_main_t *curr_vm;
   u32 vm_index = 0;
 
+  if (!bm->callbacks_registered)
+    {
+      vlib_cli_output (vm, "%U", format_vlib_buffer_pool, 0);
+      vec_foreach (bp, bm->buffer_pools)
+	vlib_cli_output (vm, "%U", format_vlib_buffer_pool, bp);
+      vlib_cli_output (vm, "");
+    }
+
   vlib_cli_output (vm, "%U", format_vlib_buffer_free_list, 0, 0);
 
   do
@@ -1014,6 +1273,197 @@ VLIB_CLI_COMMAND (show_buffers_command, static) = {
 };
 /* *INDENT-ON* */
 
+/* Alloc/free microbenchmark, on the calling thread */
+static clib_error_t *
+test_buffer_alloc_command_fn (vlib_main_t * vm,
+			      unformat_input_t * input,
+			      vlib_cli_command_t * cmd)
+{
+  u32 n_buffers = 10 << 20, batch = VLIB_FRAME_SIZE, n_alloc;
+  u32 *buffers = 0;
+  u64 t0, n_done = 0, n_failed = 0;
+  f64 dt;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "buffers %d", &n_buffers))
+	;
+      else if (unformat (input, "batch %d", &batch))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (batch == 0)
+    return clib_error_return (0, "batch must be > 0");
+
+  vec_validate_aligned (buffers, batch - 1, CLIB_CACHE_LINE_BYTES);
+
+  t0 = clib_cpu_time_now ();
+  while (n_done < n_buffers)
+    {
+      n_alloc = vlib_buffer_alloc (vm, buffers, batch);
+      if (n_alloc < batch)
+	n_failed++;
+      vlib_buffer_free_no_next (vm, buffers, n_alloc);
+      n_done += batch;
+    }
+  dt = (clib_cpu_time_now () - t0) * vm->clib_time.seconds_per_clock;
+
+  vlib_cli_output (vm, "%lld buffers in batches of %d: %.2f Mbuffers/s "
+		   "alloc+free, %.1f clocks/buffer, %lld short allocs",
+		   n_done, batch, n_done / dt * 1e-6,
+		   dt * vm->clib_time.clocks_per_second / n_done, n_failed);
+
+  vec_free (buffers);
+  return 0;
+}
+
+/*?
+ * Measure the buffer alloc/free rate of the thread running the command,
+ * allocating and freeing buffers in batches of a given size.
+ *
+ * @cliexpar
+ * @cliexstart{test buffer alloc buffers 10000000 batch 32}
+ * 10000000 buffers in batches of 32: 91.36 Mbuffers/s alloc+free,
+ *   27.4 clocks/buffer, 0 short allocs
+ * @cliexend
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (test_buffer_alloc_command, static) = {
+  .path = "test buffer alloc",
+  .short_help = "test buffer alloc [buffers <n>] [batch <n>]",
+  .function = test_buffer_alloc_command_fn,
+};
+/* *INDENT-ON* */
+
+/* Buffers the threads' free lists took from the pools, and those they
+   hold free */
+static void
+test_buffer_count (vlib_buffer_free_list_index_t fi, i64 * n_taken,
+		   i64 * n_held)
+{
+  vlib_buffer_free_list_t *fl;
+  int i;
+
+  *n_taken = *n_held = 0;
+  for (i = 0; i < vec_len (vlib_mains); i++)
+    {
+      fl = vlib_buffer_get_free_list (vlib_mains[i], fi);
+      *n_taken += fl->n_alloc;
+      *n_held += vec_len (fl->buffers) + vec_len (fl->remote_buffers);
+    }
+}
+
+static i64
+test_buffer_n_out_of_pools (void)
+{
+  vlib_buffer_pool_t *bp;
+  i64 n = 0;
+
+  vec_foreach (bp, buffer_main.buffer_pools) n += bp->n_used - bp->n_free;
+  return n;
+}
+
+/* Allocates buffers on one thread and frees them on another, both
+   ways, then checks that the threads' free lists and the pools still
+   agree on how many buffers are out. */
+static clib_error_t *
+test_buffer_remote_free_command_fn (vlib_main_t * vm,
+				    unformat_input_t * input,
+				    vlib_cli_command_t * cmd)
+{
+  vlib_buffer_free_list_index_t fi = VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX;
+  u32 n_buffers = 4 * VLIB_BUFFER_CACHE_SIZE, n_rounds = 16;
+  u32 *buffers = 0, n_alloc, i, j;
+  i64 n_taken0, n_held0, n_out0, n_taken, n_held, n_out;
+  vlib_main_t *a, *b;
+  int failed = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "buffers %d", &n_buffers))
+	;
+      else if (unformat (input, "rounds %d", &n_rounds))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (vec_len (vlib_mains) < 2)
+    return clib_error_return (0, "needs at least one worker thread");
+
+  if (buffer_main.callbacks_registered)
+    return clib_error_return (0, "buffers are not managed by vlib");
+
+  vec_validate_aligned (buffers, n_buffers - 1, CLIB_CACHE_LINE_BYTES);
+
+  /* The workers are parked, so their free lists can be used from here */
+  vlib_worker_thread_barrier_sync (vm);
+
+  test_buffer_count (fi, &n_taken0, &n_held0);
+  n_out0 = test_buffer_n_out_of_pools ();
+
+  for (i = 0; i < n_rounds; i++)
+    for (j = 1; j < vec_len (vlib_mains); j++)
+      {
+	a = (i & 1) ? vlib_mains[j] : vm;
+	b = (i & 1) ? vm : vlib_mains[j];
+	n_alloc = vlib_buffer_alloc (a, buffers, n_buffers);
+	vlib_buffer_free_no_next (b, buffers, n_alloc);
+      }
+
+  test_buffer_count (fi, &n_taken, &n_held);
+  n_out = test_buffer_n_out_of_pools ();
+
+  vlib_worker_thread_barrier_release (vm);
+
+  /* All freed again, so no more buffers in use than before */
+  if (n_taken - n_held != n_taken0 - n_held0)
+    {
+      vlib_cli_output (vm, "failed: %lld buffers in use, expected %lld",
+		       n_taken - n_held, n_taken0 - n_held0);
+      failed = 1;
+    }
+
+  /* What the threads took or returned, the pools gave or got back */
+  if (n_out - n_out0 != n_taken - n_taken0)
+    {
+      vlib_cli_output (vm, "failed: %lld buffers left the pools, free "
+		       "lists took %lld", n_out - n_out0,
+		       n_taken - n_taken0);
+      failed = 1;
+    }
+
+  if (!failed)
+    vlib_cli_output (vm, "%d rounds of %d buffers freed across threads",
+		     n_rounds, n_buffers);
+
+  vec_free (buffers);
+  return 0;
+}
+
+/*?
+ * Allocate buffers on the main thread and free them on the workers, and
+ * the other way around, with the workers stopped at the barrier. Checks
+ * that the buffers the threads' free lists took from the pool, less the
+ * ones they returned, still add up to the buffers out of the pool.
+ *
+ * @cliexpar
+ * @cliexstart{test buffer remote-free rounds 16}
+ * 16 rounds of 4096 buffers freed across threads
+ * @cliexend
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (test_buffer_remote_free_command, static) = {
+  .path = "test buffer remote-free",
+  .short_help = "test buffer remote-free [buffers <n>] [rounds <n>]",
+  .function = test_buffer_remote_free_command_fn,
+};
+/* *INDENT-ON* */
+
 clib_error_t *
 vlib_buffer_main_init (struct vlib_main_t * vm)
 {
@@ -1039,35 +1489,137 @@ vlib_buffer_main_init (struct vlib_main_t * vm)
   clib_spinlock_init (&bm->buffer_known_hash_lockp);
 
   /* allocate default region */
-  error = vlib_physmem_region_alloc (vm, "buffers",
-				     vlib_buffer_physmem_sz, 0,
-				     VLIB_PHYSMEM_F_SHARED |
-				     VLIB_PHYSMEM_F_HUGETLB, &pri);
+  error = vlib_buffer_region_alloc (vm, "buffers", vlib_buffer_physmem_sz,
+				    0, &pri);
+  if (error)
+    return error;
+
+  vec_validate_init_empty (bm->default_buffer_pool_index_by_numa, 0,
+			   (u8) ~ 0);
+  bm->default_buffer_pool_index_by_numa[0] =
+    vlib_buffer_pool_create (vm, pri, sizeof (vlib_buffer_t) +
+			     VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES);
 
-  if (error == 0)
-    goto done;
+  /* And one on each other numa node, for the threads running there.
+     All the pools are created now since a region mapped below the
+     existing ones would change the buffer indices. */
+  if (vlib_buffer_numa_pools)
+    {
+      uword *numa_nodes = 0, numa_node;
 
-  clib_error_free (error);
+      clib_sysfs_read ("/sys/devices/system/node/online", "%U",
+		       unformat_bitmap_list, &numa_nodes);
 
-  error = vlib_physmem_region_alloc (vm, "buffers",
-				     vlib_buffer_physmem_sz, 0,
-				     VLIB_PHYSMEM_F_SHARED, &pri);
-done:
-  if (error == 0)
-    vlib_buffer_pool_create (vm, pri, sizeof (vlib_buffer_t) +
-			     VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES);
-  return error;
+      /* *INDENT-OFF* */
+      clib_bitmap_foreach (numa_node, numa_nodes, ({
+	u8 *name;
+
+	if (numa_node == 0)
+	  continue;
+
+	name = format (0, "buffers-numa-%d%c", numa_node, 0);
+	error = vlib_buffer_region_alloc (vm, (char *) name,
+					  vlib_buffer_physmem_sz, numa_node,
+					  &pri);
+	vec_free (name);
+	if (error)
+	  {
+	    clib_warning ("numa %d buffer pool: %U, threads there will use "
+			  "numa 0 buffers", numa_node, format_clib_error,
+			  error);
+	    clib_error_free (error);
+	    continue;
+	  }
+
+	vec_validate_init_empty (bm->default_buffer_pool_index_by_numa,
+				 numa_node, (u8) ~ 0);
+	bm->default_buffer_pool_index_by_numa[numa_node] =
+	  vlib_buffer_pool_create (vm, pri, sizeof (vlib_buffer_t) +
+				   VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES);
+      }));
+      /* *INDENT-ON* */
+
+      clib_bitmap_free (numa_nodes);
+    }
+
+  /* Pools of other buffer sizes, next to each default pool */
+  {
+    vlib_buffer_pool_config_t *pc;
+    u8 *default_pools = vec_dup (bm->default_buffer_pool_index_by_numa);
+    u32 numa_node;
+
+    vec_foreach (pc, vlib_buffer_pool_configs)
+    {
+      vec_foreach_index (numa_node, default_pools)
+      {
+	u8 *name;
+
+	if (default_pools[numa_node] == (u8) ~ 0)
+	  continue;
+
+	name = format (0, "buffers-%d-numa-%d%c", pc->n_data_bytes,
+		       numa_node, 0);
+	error = vlib_buffer_region_alloc (vm, (char *) name,
+					  pc->physmem_size, numa_node, &pri);
+	vec_free (name);
+	if (error)
+	  {
+	    vec_free (default_pools);
+	    return error;
+	  }
+
+	vlib_buffer_pool_create (vm, pri, sizeof (vlib_buffer_t) +
+				 pc->n_data_bytes);
+      }
+    }
+    vec_free (default_pools);
+  }
+
+  return 0;
+}
+
+/* Move the free lists of a thread to the buffer pool of its numa node,
+   called once the thread knows where it runs. */
+void
+vlib_buffer_main_set_numa_node (vlib_main_t * vm, u32 numa_node)
+{
+  vlib_buffer_free_list_t *fl;
+
+  vm->numa_node = numa_node;
+
+  /* *INDENT-OFF* */
+  pool_foreach (fl, vm->buffer_free_list_pool, ({
+    ASSERT (vec_len (fl->buffers) == 0);
+    fl->buffer_pool_index =
+      vlib_buffer_pool_get_for_size (vm, numa_node, fl->n_data_bytes);
+  }));
+  /* *INDENT-ON* */
 }
 
 static clib_error_t *
 vlib_buffers_configure (vlib_main_t * vm, unformat_input_t * input)
 {
-  u32 size_in_mb;
+  vlib_buffer_pool_config_t *pc;
+  u32 size_in_mb, n_data_bytes;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
       if (unformat (input, "memory-size-in-mb %d", &size_in_mb))
 	vlib_buffer_physmem_sz = size_in_mb << 20;
+      else if (unformat (input, "no-numa-pools"))
+	vlib_buffer_numa_pools = 0;
+      else if (unformat (input, "pool data-size %d", &n_data_bytes))
+	{
+	  n_data_bytes = vlib_buffer_round_size (n_data_bytes);
+	  if (sizeof (vlib_buffer_t) + n_data_bytes > (u16) ~ 0)
+	    return clib_error_return (0, "pool data-size %d too large",
+				      n_data_bytes);
+	  vec_add2 (vlib_buffer_pool_configs, pc, 1);
+	  pc->n_data_bytes = n_data_bytes;
+	  pc->physmem_size = vlib_buffer_physmem_sz;
+	  if (unformat (input, "memory-size-in-mb %d", &size_in_mb))
+	    pc->physmem_size = size_in_mb << 20;
+	}
       else
 	return unformat_parse_error (input);
     }
@@ -1076,6 +1628,26 @@ vlib_buffers_configure (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+/*?
+ * Configure the vlib buffer pools. These are not used when the dpdk
+ * plugin manages the buffers.
+ *
+ * @cfgcmd{memory-size-in-mb, &lt;n&gt;}
+ * Size of the default buffer pool of each numa node.
+ *
+ * @cfgcmd{no-numa-pools}
+ * Only create the numa 0 pools, threads on other numa nodes use them.
+ *
+ * @cfgcmd{pool data-size, &lt;n&gt; [memory-size-in-mb &lt;m&gt;]}
+ * Add a pool of buffers of n data bytes on each numa node. Free lists
+ * created for a larger data size than the default take their buffers
+ * from it: packet generator streams with a matching buffer size, and
+ * any code calling vlib_buffer_get_or_create_free_list. The RX queues
+ * of af_packet and copy mode memif interfaces fill from the free list
+ * sized for the interface's largest frame, so a pool of that size
+ * receives jumbo frames into single buffers. The dpdk plugin has its
+ * own jumbo mbufs, see num-jumbo-mbufs in the dpdk section.
+?*/
 VLIB_EARLY_CONFIG_FUNCTION (vlib_buffers_configure, "buffers");
 
 
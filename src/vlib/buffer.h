@@ -71,7 +71,8 @@ typedef u8 vlib_buffer_free_list_index_t;
   _( 4, TOTAL_LENGTH_VALID, 0)				\
   _( 5, REPL_FAIL, "repl-fail")				\
   _( 6, RECYCLE, "recycle")				\
-  _( 7, EXT_HDR_VALID, "ext-hdr-valid")
+  _( 7, EXT_HDR_VALID, "ext-hdr-valid")		\
+  _( 8, IS_SAMPLED, "sampled")
 
 /* NOTE: only buffer generic flags should be defined here, please consider
    using user flags. i.e. src/vnet/buffer.h */
@@ -117,6 +118,7 @@ typedef struct
                 <br> VLIB_BUFFER_RECYCLE: as it says
                 <br> VLIB_BUFFER_EXT_HDR_VALID: buffer contains valid external buffer manager header,
                 set to avoid adding it to a flow report
+                <br> VLIB_BUFFER_IS_SAMPLED: sampling tracer records this buffer
                 <br> VLIB_BUFFER_FLAG_USER(n): user-defined bit N
              */
 
@@ -145,7 +147,8 @@ typedef struct
     CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
 
   u32 trace_index; /**< Specifies index into trace buffer
-                      if VLIB_PACKET_IS_TRACED flag is set.
+                      if VLIB_PACKET_IS_TRACED flag is set,
+                      or the sample id if VLIB_BUFFER_IS_SAMPLED is set.
                    */
   u32 recycle_count; /**< Used by L2 path recycle code */
 
@@ -352,12 +355,20 @@ typedef struct vlib_buffer_free_list_t
   /* Number of buffers to allocate when we need to allocate new buffers */
   u32 min_n_buffers_each_alloc;
 
-  /* Total number of buffers allocated from this free list. */
-  u32 n_alloc;
+  /* Buffers this free list took from its pool, less the ones it
+     returned. Buffers allocated on one thread are often freed on
+     another, which then returns more than it took: only the sum over
+     the threads' free lists counts the buffers out of the pool. */
+  i32 n_alloc;
 
   /* Vector of free buffers.  Each element is a byte offset into I/O heap. */
   u32 *buffers;
 
+  /* Free buffers from another pool than buffer_pool_index, on their
+     way back to it. */
+  u32 *remote_buffers;
+  u8 remote_buffer_pool_index;
+
   /* index of buffer pool used to get / put buffers */
   u8 buffer_pool_index;
 
@@ -404,6 +415,27 @@ typedef struct
 
 extern vlib_buffer_callbacks_t *vlib_buffer_callbacks;
 
+/* Free buffers move between the per-thread free lists and their buffer
+   pool a magazine (a frame's worth) at a time. */
+#define VLIB_BUFFER_MAGAZINE_SIZE 256
+
+/* Threads return buffers to the pool above this many free buffers. */
+#define VLIB_BUFFER_CACHE_SIZE (4 * VLIB_BUFFER_MAGAZINE_SIZE)
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* Next magazine on the same stack. */
+  u32 next;
+  u32 n_buffers;
+  u32 buffers[VLIB_BUFFER_MAGAZINE_SIZE];
+} vlib_buffer_magazine_t;
+
+/* Lock-free stack of magazines: index of the top magazine in the low 32
+   bits, ~0 if empty, and a tag bumped by every push and pop in the high
+   32 bits so that a stale compare-and-swap fails. */
+typedef volatile u64 vlib_buffer_magazine_stack_t;
+
 typedef struct
 {
   CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
@@ -411,8 +443,7 @@ typedef struct
   uword size;
   uword log2_page_size;
   vlib_physmem_region_index_t physmem_region;
-
-  u32 *buffers;
+  u8 numa_node;
 
   u16 buffer_size;
   uword buffers_per_page;
@@ -420,7 +451,23 @@ typedef struct
   uword n_used;
   uword next_clear;
   uword *bitmap;
+
+  /* Protects the bitmap above, only used until all the pool's buffers
+     have been handed out once. */
   clib_spinlock_t lock;
+
+  /* Never resized, so that a thread may read a magazine another one
+     just popped. */
+  vlib_buffer_magazine_t *magazines;
+
+  /* Free buffers in the full magazines. */
+  volatile u32 n_free;
+
+  /* Magazines of free buffers, and empty ones to return buffers with. */
+    CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  vlib_buffer_magazine_stack_t full_magazines;
+    CLIB_CACHE_LINE_ALIGN_MARK (cacheline2);
+  vlib_buffer_magazine_stack_t empty_magazines;
 } vlib_buffer_pool_t;
 
 typedef struct
@@ -432,6 +479,10 @@ typedef struct
   uword buffer_mem_size;
   vlib_buffer_pool_t *buffer_pools;
 
+  /* Pool the free lists of threads running on a numa node use,
+     (u8) ~0 if none. */
+  u8 *default_buffer_pool_index_by_numa;
+
   /* Buffer free callback, for subversive activities */
     u32 (*buffer_free_callback) (struct vlib_main_t * vm,
 				 u32 * buffers,
@@ -468,7 +519,13 @@ u8 vlib_buffer_pool_create (struct vlib_main_t * vm,
 			    vlib_physmem_region_index_t region,
 			    u16 buffer_size);
 
+u8 vlib_buffer_pool_get_default_for_numa (struct vlib_main_t * vm,
+					  u32 numa_node);
+u8 vlib_buffer_pool_get_for_size (struct vlib_main_t * vm, u32 numa_node,
+				  u32 n_data_bytes);
+
 clib_error_t *vlib_buffer_main_init (struct vlib_main_t *vm);
+void vlib_buffer_main_set_numa_node (struct vlib_main_t *vm, u32 numa_node);
 
 typedef struct
 {
@@ -130,6 +130,60 @@ vlib_get_buffers (vlib_main_t * vm, u32 * bi, vlib_buffer_t ** b, int count)
   vlib_get_buffers_with_offset (vm, bi, (void **) b, count, 0);
 }
 
+#ifdef CLIB_HAVE_VEC256
+/** \brief Load a u32 from the same offset of 8 buffer headers
+
+    @param b - (vlib_buffer_t **) array of 8 buffer pointers
+    @param offset - (uword) byte offset in vlib_buffer_t
+    @return - (u32x8) the 8 values
+*/
+static_always_inline u32x8
+vlib_buffer_gather_u32_x8 (vlib_buffer_t ** b, uword offset)
+{
+#ifdef CLIB_HAVE_VEC512
+  return u64x8_gather_u32 (u64x8_load_unaligned (b) + offset);
+#else
+  u8 **p = (u8 **) b;
+  return u32x8_gather (p[0] + offset, p[1] + offset, p[2] + offset,
+		       p[3] + offset, p[4] + offset, p[5] + offset,
+		       p[6] + offset, p[7] + offset);
+#endif
+}
+
+/** \brief Load a u32 from the same offset of the current data of 8 buffers
+
+    @param b - (vlib_buffer_t **) array of 8 buffer pointers
+    @param offset - (i32) byte offset from the current data
+    @return - (u32x8) the 8 values, in network byte order
+*/
+static_always_inline u32x8
+vlib_buffer_gather_current_u32_x8 (vlib_buffer_t ** b, i32 offset)
+{
+#ifdef CLIB_HAVE_VEC512
+  i32x8 cd;
+  u64x8 p;
+
+  /* current_data is the low half of the u32 it shares with
+     current_length */
+  cd = (i32x8) vlib_buffer_gather_u32_x8 (b, STRUCT_OFFSET_OF (vlib_buffer_t,
+							      current_data));
+  cd = (cd << 16) >> 16;
+  p = u64x8_load_unaligned (b) + (u64x8) i32x8_extend_to_i64x8 (cd);
+  return u64x8_gather_u32 (p + STRUCT_OFFSET_OF (vlib_buffer_t, data) +
+			   offset);
+#else
+  return u32x8_gather (vlib_buffer_get_current (b[0]) + offset,
+		       vlib_buffer_get_current (b[1]) + offset,
+		       vlib_buffer_get_current (b[2]) + offset,
+		       vlib_buffer_get_current (b[3]) + offset,
+		       vlib_buffer_get_current (b[4]) + offset,
+		       vlib_buffer_get_current (b[5]) + offset,
+		       vlib_buffer_get_current (b[6]) + offset,
+		       vlib_buffer_get_current (b[7]) + offset);
+#endif
+}
+#endif
+
 /** \brief Translate buffer pointer into buffer index
 
     @param vm - (vlib_main_t *) vlib main data structure pointer
@@ -631,6 +685,9 @@ vlib_buffer_free_from_ring_no_next (vlib_main_t * vm, u32 * ring, u32 start,
 vlib_buffer_free_list_index_t vlib_buffer_create_free_list (vlib_main_t * vm,
 							    u32 n_data_bytes,
 							    char *fmt, ...);
+vlib_buffer_free_list_index_t
+vlib_buffer_get_or_create_free_list (vlib_main_t * vm, u32 n_data_bytes,
+				     char *fmt, ...);
 always_inline void
 vlib_buffer_delete_free_list (vlib_main_t * vm,
 			      vlib_buffer_free_list_index_t free_list_index)
@@ -1075,10 +1132,20 @@ vlib_buffer_init_for_free_list (vlib_buffer_t * dst,
   /* Make sure buffer template is sane. */
   ASSERT (fl->index == vlib_buffer_get_free_list_index (src));
 
+#if defined(CLIB_HAVE_VEC128)
+  /* The template is exactly one 16 byte vector. */
+  STATIC_ASSERT (STRUCT_OFFSET_OF (vlib_buffer_t, template_end) -
+		 STRUCT_OFFSET_OF (vlib_buffer_t, template_start) ==
+		 sizeof (u8x16), "buffer template is not 16 bytes");
+  u8x16_store_unaligned (u8x16_load_unaligned
+			 (STRUCT_MARK_PTR (src, template_start)),
+			 STRUCT_MARK_PTR (dst, template_start));
+#else
   clib_memcpy (STRUCT_MARK_PTR (dst, template_start),
 	       STRUCT_MARK_PTR (src, template_start),
 	       STRUCT_OFFSET_OF (vlib_buffer_t, template_end) -
 	       STRUCT_OFFSET_OF (vlib_buffer_t, template_start));
+#endif
 
   /* Not in the first 16 octets. */
   dst->n_add_refs = src->n_add_refs;
@@ -1099,6 +1166,75 @@ vlib_buffer_init_for_free_list (vlib_buffer_t * dst,
   ASSERT (dst->n_add_refs == 0);
 }
 
+/* Pop a magazine off a pool's magazine stack, ~0 if it is empty. */
+always_inline u32
+vlib_buffer_magazine_pop (vlib_buffer_pool_t * bp,
+			  vlib_buffer_magazine_stack_t * stack)
+{
+  u64 old, new;
+  u32 index;
+
+  do
+    {
+      old = *stack;
+      index = (u32) old;
+      if (index == ~0)
+	return ~0;
+      /* May read a magazine another thread popped meanwhile, the tag
+         makes the swap fail then. */
+      new = (((old >> 32) + 1) << 32) | bp->magazines[index].next;
+    }
+  while (!__sync_bool_compare_and_swap (stack, old, new));
+
+  return index;
+}
+
+always_inline void
+vlib_buffer_magazine_push (vlib_buffer_pool_t * bp,
+			   vlib_buffer_magazine_stack_t * stack, u32 index)
+{
+  u64 old, new;
+
+  do
+    {
+      old = *stack;
+      bp->magazines[index].next = (u32) old;
+      new = (((old >> 32) + 1) << 32) | index;
+    }
+  while (!__sync_bool_compare_and_swap (stack, old, new));
+}
+
+/* Return up to a magazine of free buffers to their pool. Returns 0 if
+   the pool has no empty magazine left, the caller keeps the buffers
+   then. */
+always_inline int
+vlib_buffer_pool_put (vlib_buffer_pool_t * bp, u32 * buffers, u32 n_buffers)
+{
+  vlib_buffer_magazine_t *m;
+  u32 index;
+
+  ASSERT (n_buffers <= VLIB_BUFFER_MAGAZINE_SIZE);
+
+  if (PREDICT_FALSE (bp->magazines == 0))
+    return 0;
+
+  index = vlib_buffer_magazine_pop (bp, &bp->empty_magazines);
+  if (PREDICT_FALSE (index == ~0))
+    return 0;
+
+  m = bp->magazines + index;
+  clib_memcpy (m->buffers, buffers, n_buffers * sizeof (u32));
+  m->n_buffers = n_buffers;
+  __sync_fetch_and_add (&bp->n_free, n_buffers);
+  vlib_buffer_magazine_push (bp, &bp->full_magazines, index);
+  return 1;
+}
+
+void vlib_buffer_add_to_remote_free_list (vlib_main_t * vm,
+					  vlib_buffer_free_list_t * f,
+					  u32 buffer_index,
+					  u8 buffer_pool_index);
+
 always_inline void
 vlib_buffer_add_to_free_list (vlib_main_t * vm,
 			      vlib_buffer_free_list_t * f,
@@ -1109,17 +1245,23 @@ vlib_buffer_add_to_free_list (vlib_main_t * vm,
   b = vlib_get_buffer (vm, buffer_index);
   if (PREDICT_TRUE (do_init))
     vlib_buffer_init_for_free_list (b, f);
+
+  /* Allocated by a thread on another numa node */
+  if (PREDICT_FALSE (b->buffer_pool_index != f->buffer_pool_index))
+    {
+      vlib_buffer_add_to_remote_free_list (vm, f, buffer_index,
+					   b->buffer_pool_index);
+      return;
+    }
+
   vec_add1_aligned (f->buffers, buffer_index, CLIB_CACHE_LINE_BYTES);
 
-  if (vec_len (f->buffers) > 4 * VLIB_FRAME_SIZE)
+  /* keep last stored buffers, as they are more likely hot in the cache */
+  if (vec_len (f->buffers) > VLIB_BUFFER_CACHE_SIZE &&
+      vlib_buffer_pool_put (bp, f->buffers, VLIB_BUFFER_MAGAZINE_SIZE))
     {
-      clib_spinlock_lock (&bp->lock);
-      /* keep last stored buffers, as they are more likely hot in the cache */
-      vec_add_aligned (bp->buffers, f->buffers, VLIB_FRAME_SIZE,
-		       CLIB_CACHE_LINE_BYTES);
-      vec_delete (f->buffers, VLIB_FRAME_SIZE, 0);
-      f->n_alloc -= VLIB_FRAME_SIZE;
-      clib_spinlock_unlock (&bp->lock);
+      vec_delete (f->buffers, VLIB_BUFFER_MAGAZINE_SIZE, 0);
+      f->n_alloc -= VLIB_BUFFER_MAGAZINE_SIZE;
     }
 }
 
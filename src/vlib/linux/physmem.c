@@ -109,6 +109,103 @@ unix_physmem_free (vlib_main_t * vm, vlib_physmem_region_index_t idx, void *x)
   mheap_put (pr->heap, x - pr->heap);
 }
 
+static void
+unix_physmem_check_numa (u8 * name, void *mem, u8 log2_page_size,
+			 u32 n_pages, u8 numa_node)
+{
+  int i;
+
+  for (i = 0; i < n_pages; i++)
+    {
+      void *ptr = mem + ((u64) i << log2_page_size);
+      int node;
+      if ((move_pages (0, 1, &ptr, 0, &node, 0) == 0) && (numa_node != node))
+	{
+	  clib_warning ("physmem page for region \'%s\' allocated on the"
+			" wrong numa node (requested %u actual %u)",
+			name, numa_node, node, i);
+	  break;
+	}
+    }
+}
+
+/* Carve a region out of the arena of its numa node. Space is handed
+   out in whole arena pages and is not reused once the region is freed. */
+static int
+unix_physmem_region_from_arena (vlib_physmem_region_t * pr, u32 size,
+				u8 numa_node)
+{
+  vlib_physmem_main_t *vpm = &physmem_main;
+  vlib_physmem_arena_t *a;
+  uword n_bytes, first_page;
+
+  if (numa_node >= vec_len (vpm->arenas))
+    return 0;
+
+  a = vec_elt_at_index (vpm->arenas, numa_node);
+  if (a->mem == 0)
+    return 0;
+
+  n_bytes = round_pow2 ((uword) size, 1ULL << a->log2_page_size);
+  if (a->n_used + n_bytes > a->size)
+    return 0;
+
+  first_page = a->n_used >> a->log2_page_size;
+
+  pr->fd = a->fd;
+  pr->fd_offset = a->n_used;
+  pr->mem = a->mem + a->n_used;
+  pr->log2_page_size = a->log2_page_size;
+  pr->n_pages = n_bytes >> a->log2_page_size;
+  if (a->page_table)
+    vec_add (pr->page_table, a->page_table + first_page, pr->n_pages);
+
+  a->n_used += n_bytes;
+  return 1;
+}
+
+static clib_error_t *
+unix_physmem_arena_alloc (vlib_main_t * vm, u8 numa_node)
+{
+  vlib_physmem_main_t *vpm = &physmem_main;
+  vlib_physmem_arena_t *a;
+  clib_mem_vm_alloc_t alloc = { 0 };
+  clib_error_t *error;
+  u8 *name;
+
+  name = format (0, "physmem-numa-%u%c", numa_node, 0);
+
+  alloc.name = (char *) name;
+  alloc.size = vpm->arena_size;
+  alloc.numa_node = numa_node;
+  alloc.log2_page_size = vpm->arena_log2_page_size;
+  alloc.flags = CLIB_MEM_VM_F_SHARED | CLIB_MEM_VM_F_HUGETLB |
+    CLIB_MEM_VM_F_HUGETLB_PREALLOC | CLIB_MEM_VM_F_NUMA_FORCE;
+
+  error = clib_mem_vm_ext_alloc (&alloc);
+  if (error)
+    goto done;
+
+  vec_validate (vpm->arenas, numa_node);
+  a = vec_elt_at_index (vpm->arenas, numa_node);
+  a->mem = alloc.addr;
+  a->fd = alloc.fd;
+  a->log2_page_size = alloc.log2_page_size;
+  a->n_pages = alloc.n_pages;
+  a->size = (uword) a->n_pages << a->log2_page_size;
+  a->numa_node = numa_node;
+
+  unix_physmem_check_numa (name, a->mem, a->log2_page_size, a->n_pages,
+			   numa_node);
+
+  a->page_table = clib_mem_vm_get_paddr (a->mem, a->log2_page_size,
+					 a->n_pages);
+
+done:
+  vec_free (name);
+  return error;
+}
+
 static clib_error_t *
 unix_physmem_region_alloc (vlib_main_t * vm, char *name, u32 size,
 			   u8 numa_node, u32 flags,
@@ -118,9 +215,9 @@ unix_physmem_region_alloc (vlib_main_t * vm, char *name, u32 size,
   vlib_physmem_region_t *pr;
   clib_error_t *error = 0;
   clib_mem_vm_alloc_t alloc = { 0 };
-  int i;
 
   pool_get (vpm->regions, pr);
+  memset (pr, 0, sizeof (*pr));
 
   if ((pr - vpm->regions) >= 256)
     {
@@ -128,6 +225,12 @@ unix_physmem_region_alloc (vlib_main_t * vm, char *name, u32 size,
       goto error;
     }
 
+  if (unix_physmem_region_from_arena (pr, size, numa_node))
+    {
+      flags |= VLIB_PHYSMEM_F_ARENA;
+      goto region_ready;
+    }
+
   alloc.name = name;
   alloc.size = size;
   alloc.numa_node = numa_node;
@@ -150,33 +253,25 @@ unix_physmem_region_alloc (vlib_main_t * vm, char *name, u32 size,
   if (error)
     goto error;
 
-  pr->index = pr - vpm->regions;
-  pr->flags = flags;
   pr->fd = alloc.fd;
   pr->mem = alloc.addr;
   pr->log2_page_size = alloc.log2_page_size;
   pr->n_pages = alloc.n_pages;
-  pr->size = (u64) pr->n_pages << (u64) pr->log2_page_size;
-  pr->page_mask = (1 << pr->log2_page_size) - 1;
-  pr->numa_node = numa_node;
-  pr->name = format (0, "%s%c", name, 0);
 
-  for (i = 0; i < pr->n_pages; i++)
-    {
-      void *ptr = pr->mem + ((u64) i << pr->log2_page_size);
-      int node;
-      if ((move_pages (0, 1, &ptr, 0, &node, 0) == 0) && (numa_node != node))
-	{
-	  clib_warning ("physmem page for region \'%s\' allocated on the"
-			" wrong numa node (requested %u actual %u)",
-			pr->name, pr->numa_node, node, i);
-	  break;
-	}
-    }
+  unix_physmem_check_numa ((u8 *) name, pr->mem, pr->log2_page_size,
+			   pr->n_pages, numa_node);
 
   pr->page_table = clib_mem_vm_get_paddr (pr->mem, pr->log2_page_size,
 					  pr->n_pages);
 
+region_ready:
+  pr->index = pr - vpm->regions;
+  pr->flags = flags;
+  pr->size = (u64) pr->n_pages << (u64) pr->log2_page_size;
+  pr->page_mask = (1 << pr->log2_page_size) - 1;
+  pr->numa_node = numa_node;
+  pr->name = format (0, "%s%c", name, 0);
+
   linux_vfio_dma_map_regions (vm);
 
   if (flags & VLIB_PHYSMEM_F_INIT_MHEAP)
@@ -205,9 +300,16 @@ unix_physmem_region_free (vlib_main_t * vm, vlib_physmem_region_index_t idx)
   vlib_physmem_main_t *vpm = &physmem_main;
   vlib_physmem_region_t *pr = vlib_physmem_get_region (vm, idx);
 
-  if (pr->fd > 0)
-    close (pr->fd);
-  munmap (pr->mem, pr->size);
+  /* the IOMMU must not keep pointing at memory we hand back */
+  linux_vfio_dma_unmap_region (vm, pr);
+
+  if ((pr->flags & VLIB_PHYSMEM_F_ARENA) == 0)
+    {
+      if (pr->fd > 0)
+	close (pr->fd);
+      munmap (pr->mem, pr->size);
+    }
+  vec_free (pr->page_table);
   vec_free (pr->name);
   pool_put (vpm->regions, pr);
 }
@@ -232,6 +334,31 @@ unix_physmem_init (vlib_main_t * vm)
   if ((error = linux_vfio_init (vm)))
     return error;
 
+  /* Preallocate the hugepages of each numa node in one go, instead of
+     per region as the regions get allocated. */
+  if (vpm->arena_size)
+    {
+      uword *numa_nodes = 0, numa_node;
+
+      clib_sysfs_read ("/sys/devices/system/node/online", "%U",
+		       unformat_bitmap_list, &numa_nodes);
+      if (numa_nodes == 0)
+	numa_nodes = clib_bitmap_set (numa_nodes, 0, 1);
+
+      /* *INDENT-OFF* */
+      clib_bitmap_foreach (numa_node, numa_nodes, ({
+	if ((error = unix_physmem_arena_alloc (vm, numa_node)))
+	  {
+	    clib_warning ("numa %d physmem prealloc: %U", numa_node,
+			  format_clib_error, error);
+	    clib_error_free (error);
+	  }
+      }));
+      /* *INDENT-ON* */
+
+      clib_bitmap_free (numa_nodes);
+    }
+
   vm->os_physmem_alloc_aligned = unix_physmem_alloc_aligned;
   vm->os_physmem_free = unix_physmem_free;
   vm->os_physmem_region_alloc = unix_physmem_region_alloc;
@@ -246,14 +373,29 @@ show_physmem (vlib_main_t * vm,
 {
   vlib_physmem_main_t *vpm = &physmem_main;
   vlib_physmem_region_t *pr;
+  vlib_physmem_arena_t *a;
+
+  vec_foreach (a, vpm->arenas)
+  {
+    if (a->mem == 0)
+      continue;
+    vlib_cli_output (vm, "arena numa-node %u page-size %uKB num-pages %u "
+		     "used %U of %U%s\n", a->numa_node,
+		     1 << (a->log2_page_size - 10), a->n_pages,
+		     format_memory_size, a->n_used, format_memory_size,
+		     a->size, a->dma_mapped ? " dma-mapped" : "");
+  }
 
   /* *INDENT-OFF* */
   pool_foreach (pr, vpm->regions, (
     {
       vlib_cli_output (vm, "index %u name '%s' page-size %uKB num-pages %d "
-		       "numa-node %u fd %d\n",
+		       "numa-node %u fd %d%s%s\n",
 		       pr->index, pr->name, (1 << (pr->log2_page_size -10)),
-		       pr->n_pages, pr->numa_node, pr->fd);
+		       pr->n_pages, pr->numa_node, pr->fd,
+		       (pr->flags & VLIB_PHYSMEM_F_ARENA) ? " arena" : "",
+		       (pr->flags & VLIB_PHYSMEM_F_DMA_MAPPED) ?
+		       " dma-mapped" : "");
       if (pr->heap)
 	vlib_cli_output (vm, "  %U", format_mheap, pr->heap, /* verbose */ 1);
       else
@@ -271,6 +413,35 @@ VLIB_CLI_COMMAND (show_physmem_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+vlib_physmem_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  vlib_physmem_main_t *vpm = &physmem_main;
+  uword page_size;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "prealloc-size %U", unformat_memory_size,
+		    &vpm->arena_size))
+	;
+      else if (unformat (input, "page-size %U", unformat_memory_size,
+			 &page_size))
+	{
+	  if (!is_pow2 (page_size) || page_size < (2 << 20))
+	    return clib_error_return (0, "invalid hugepage size %U",
+				      format_memory_size, page_size);
+	  vpm->arena_log2_page_size = min_log2 (page_size);
+	}
+      else
+	return unformat_parse_error (input);
+    }
+
+  unformat_free (input);
+  return 0;
+}
+
+VLIB_EARLY_CONFIG_FUNCTION (vlib_physmem_config, "physmem");
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -35,31 +35,71 @@
 linux_vfio_main_t vfio_main;
 
 static int
-map_regions (vlib_main_t * vm, int fd)
+map_dma (int fd, void *mem, uword size)
 {
-  vlib_physmem_main_t *vpm = &physmem_main;
-  vlib_physmem_region_t *pr;
   struct vfio_iommu_type1_dma_map dm = { 0 };
-  int i;
 
   dm.argsz = sizeof (struct vfio_iommu_type1_dma_map);
   dm.flags = VFIO_DMA_MAP_FLAG_READ | VFIO_DMA_MAP_FLAG_WRITE;
+  dm.vaddr = pointer_to_uword (mem);
+  dm.size = size;
+  dm.iova = dm.vaddr;
+
+  return ioctl (fd, VFIO_IOMMU_MAP_DMA, &dm);
+}
+
+static int
+unmap_dma (int fd, void *mem, uword size)
+{
+  struct vfio_iommu_type1_dma_unmap dm = { 0 };
+
+  dm.argsz = sizeof (struct vfio_iommu_type1_dma_unmap);
+  dm.iova = pointer_to_uword (mem);
+  dm.size = size;
+
+  return ioctl (fd, VFIO_IOMMU_UNMAP_DMA, &dm);
+}
+
+/* Map whatever is not mapped yet, each arena and each region outside
+   of the arenas with a single mapping. */
+static void
+map_regions (vlib_main_t * vm, int fd)
+{
+  vlib_physmem_main_t *vpm = &physmem_main;
+  vlib_physmem_region_t *pr;
+  vlib_physmem_arena_t *a;
+
+  vec_foreach (a, vpm->arenas)
+  {
+    if (a->mem == 0 || a->dma_mapped)
+      continue;
+    if (map_dma (fd, a->mem, a->size))
+      clib_unix_warning ("ioctl(VFIO_IOMMU_MAP_DMA) numa %u arena",
+			 a->numa_node);
+    else
+      a->dma_mapped = 1;
+  }
 
   /* *INDENT-OFF* */
   pool_foreach (pr, vpm->regions,
     {
-      vec_foreach_index (i, pr->page_table)
-        {
-	  int rv;
-	  dm.vaddr = pointer_to_uword (pr->mem) + (i << pr->log2_page_size);
-	  dm.size = 1 << pr->log2_page_size;
-	  dm.iova = dm.vaddr;
-	  if ((rv = ioctl (fd, VFIO_IOMMU_MAP_DMA, &dm)))
-	    return rv;
-        }
+      if (pr->flags & VLIB_PHYSMEM_F_DMA_MAPPED)
+	continue;
+
+      if (pr->flags & VLIB_PHYSMEM_F_ARENA)
+	{
+	  if (vpm->arenas[pr->numa_node].dma_mapped)
+	    pr->flags |= VLIB_PHYSMEM_F_DMA_MAPPED;
+	  continue;
+	}
+
+      if (map_dma (fd, pr->mem, pr->size))
+	clib_unix_warning ("ioctl(VFIO_IOMMU_MAP_DMA) region '%s'",
+			   pr->name);
+      else
+	pr->flags |= VLIB_PHYSMEM_F_DMA_MAPPED;
     });
   /* *INDENT-ON* */
-  return 0;
 }
 
 void
@@ -67,10 +107,27 @@ linux_vfio_dma_map_regions (vlib_main_t * vm)
 {
   linux_vfio_main_t *lvm = &vfio_main;
 
-  if (lvm->container_fd != -1)
+  /* Nothing can be mapped before a group sets the container's iommu */
+  if (lvm->container_fd != -1 && lvm->iommu_mode == VFIO_TYPE1_IOMMU)
     map_regions (vm, lvm->container_fd);
 }
 
+/* Arena regions stay mapped with their arena, which is never freed */
+void
+linux_vfio_dma_unmap_region (vlib_main_t * vm, vlib_physmem_region_t * pr)
+{
+  linux_vfio_main_t *lvm = &vfio_main;
+
+  if ((pr->flags & VLIB_PHYSMEM_F_DMA_MAPPED) == 0
+      || (pr->flags & VLIB_PHYSMEM_F_ARENA))
+    return;
+
+  if (unmap_dma (lvm->container_fd, pr->mem, pr->size))
+    clib_unix_warning ("ioctl(VFIO_IOMMU_UNMAP_DMA) region '%s'", pr->name);
+
+  pr->flags &= ~VLIB_PHYSMEM_F_DMA_MAPPED;
+}
+
 static linux_pci_vfio_iommu_group_t *
 get_vfio_iommu_group (int group)
 {
@@ -139,6 +196,9 @@ open_vfio_iommu_group (int group, int is_noiommu)
 					"'/dev/vfio/vfio'");
 	  goto error;
 	}
+
+      /* memory allocated so far could not be mapped without an iommu */
+      linux_vfio_dma_map_regions (vlib_get_main ());
     }
 
 
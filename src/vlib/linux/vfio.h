@@ -45,6 +45,8 @@ extern linux_vfio_main_t vfio_main;
 
 clib_error_t *linux_vfio_init (vlib_main_t * vm);
 void linux_vfio_dma_map_regions (vlib_main_t * vm);
+void linux_vfio_dma_unmap_region (vlib_main_t * vm,
+				  vlib_physmem_region_t * pr);
 clib_error_t *linux_vfio_group_get_device_fd (vlib_pci_addr_t * addr,
 					      int *fd);
 
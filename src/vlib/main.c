@@ -458,7 +458,7 @@ vlib_put_next_frame (vlib_main_t * vm,
   vlib_node_main_t *nm = &vm->node_main;
   vlib_next_frame_t *nf;
   vlib_frame_t *f;
-  u32 n_vectors_in_frame;
+  u32 n_vectors_in_frame, n_vectors_before;
 
   if (buffer_main.callbacks_registered == 0 && CLIB_DEBUG > 0)
     vlib_put_next_frame_validate (vm, r, next_index, n_vectors_left);
@@ -478,6 +478,7 @@ vlib_put_next_frame (vlib_main_t * vm,
   ASSERT (n_vectors_left <= VLIB_FRAME_SIZE);
   n_vectors_in_frame = VLIB_FRAME_SIZE - n_vectors_left;
 
+  n_vectors_before = f->n_vectors;
   f->n_vectors = n_vectors_in_frame;
 
   /* If vectors were added to frame, add to pending vector. */
@@ -524,6 +525,18 @@ vlib_put_next_frame (vlib_main_t * vm,
 	(nf->flags & VLIB_NODE_FLAG_TRACE) | (r->
 					      flags & VLIB_NODE_FLAG_TRACE);
 
+      /* Same for the sample flag; sampling input nodes pick the packets
+         to sample among the ones just added. */
+      nf->flags |= r->flags & VLIB_NODE_FLAG_SAMPLE;
+      if (PREDICT_FALSE (r->flags & VLIB_NODE_FLAG_SAMPLE_INPUT)
+	  && n_vectors_in_frame > n_vectors_before)
+	{
+	  u32 *from = vlib_frame_vector_args (f);
+	  if (vlib_trace_sample_input (vm, r, from + n_vectors_before,
+				       n_vectors_in_frame - n_vectors_before))
+	    nf->flags |= VLIB_FRAME_SAMPLE;
+	}
+
       v0 = nf->vectors_since_last_overflow;
       v1 = v0 + n_vectors_in_frame;
       nf->vectors_since_last_overflow = v1;
@@ -702,6 +715,8 @@ elog_save_buffer (vlib_main_t * vm,
   return error;
 }
 
+static elog_stream_t vlib_elog_stream = {.fd = -1 };
+
 void
 elog_post_mortem_dump (void)
 {
@@ -710,6 +725,14 @@ elog_post_mortem_dump (void)
   u8 *filename;
   clib_error_t *error;
 
+  /* Write out what the stream has not caught up with yet. */
+  if (vlib_elog_stream.fd >= 0)
+    {
+      error = elog_stream_close (em, &vlib_elog_stream);
+      if (error)
+	clib_error_report (error);
+    }
+
   if (!vm->elog_post_mortem_dump)
     return;
 
@@ -798,6 +821,141 @@ VLIB_CLI_COMMAND (elog_resize_cli, static) = {
 };
 /* *INDENT-ON* */
 
+/* Streams the event log to a file, without stopping the threads. */
+static uword
+elog_stream_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
+		     vlib_frame_t * f)
+{
+  elog_main_t *em = &vm->elog_main;
+  clib_error_t *error;
+  uword *event_data = 0;
+
+  while (1)
+    {
+      if (vlib_elog_stream.fd >= 0)
+	vlib_process_wait_for_event_or_clock (vm,
+					      vm->elog_stream_interval);
+      else
+	vlib_process_wait_for_event (vm);
+
+      vlib_process_get_events (vm, &event_data);
+      vec_reset_length (event_data);
+
+      if (vlib_elog_stream.fd < 0)
+	continue;
+
+      error = elog_stream_flush (em, &vlib_elog_stream);
+      if (error)
+	{
+	  clib_error_report (error);
+	  error = elog_stream_close (em, &vlib_elog_stream);
+	  clib_error_free (error);
+	}
+    }
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (elog_stream_node, static) = {
+  .function = elog_stream_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "elog-stream-process",
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+elog_stream_start (vlib_main_t * vm, char *file)
+{
+  elog_main_t *em = &vm->elog_main;
+  char *chroot_file;
+  clib_error_t *error;
+
+  /* It's fairly hard to get "../oopsie" through unformat; just in case */
+  if (strstr (file, "..") || index (file, '/'))
+    return clib_error_return (0, "illegal characters in filename '%s'",
+			      file);
+
+  if (vlib_elog_stream.fd >= 0)
+    {
+      error = elog_stream_close (em, &vlib_elog_stream);
+      clib_error_free (error);
+    }
+
+  chroot_file = (char *) format (0, "/tmp/%s%c", file, 0);
+  error = elog_stream_open (em, &vlib_elog_stream, chroot_file);
+  vec_free (chroot_file);
+
+  if (!error)
+    vlib_process_signal_event (vm, elog_stream_node.index, 0, 0);
+
+  return error;
+}
+
+static clib_error_t *
+elog_stream (vlib_main_t * vm,
+	     unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  elog_main_t *em = &vm->elog_main;
+  char *file = 0;
+  clib_error_t *error = 0;
+  f64 interval;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "stop"))
+	{
+	  if (vlib_elog_stream.fd < 0)
+	    return clib_error_return (0, "not streaming");
+	  vlib_cli_output (vm, "Streamed %Ld events, %Ld lost",
+			   vlib_elog_stream.n_events_written,
+			   vlib_elog_stream.n_events_lost);
+	  return elog_stream_close (em, &vlib_elog_stream);
+	}
+      else if (unformat (input, "interval %f", &interval) && interval > 0)
+	vm->elog_stream_interval = interval;
+      else if (unformat (input, "%s", &file))
+	;
+      else
+	return unformat_parse_error (input);
+    }
+
+  if (!file)
+    return clib_error_return (0, "expected file name");
+
+  error = elog_stream_start (vm, file);
+  if (!error)
+    vlib_cli_output (vm, "Streaming the event log to /tmp/%s every %.2fs",
+		     file, vm->elog_stream_interval);
+  vec_free (file);
+  return error;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (elog_stream_cli, static) = {
+  .path = "event-logger stream",
+  .short_help = "event-logger stream <filename> [interval <sec>] | stop "
+    "(streams log to /tmp/<filename>)",
+  .function = elog_stream,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+elog_stream_config_init (vlib_main_t * vm)
+{
+  clib_error_t *error = 0;
+
+  if (vm->elog_stream_file)
+    {
+      error = elog_stream_start (vm, vm->elog_stream_file);
+      vec_free (vm->elog_stream_file);
+    }
+
+  return error;
+}
+
+VLIB_MAIN_LOOP_ENTER_FUNCTION (elog_stream_config_init);
+
 #endif /* CLIB_UNIX */
 
 static void
@@ -813,9 +971,15 @@ elog_show_buffer_internal (vlib_main_t * vm, u32 n_events_to_show)
 
   es = elog_peek_events (em);
   vlib_cli_output (vm, "%d of %d events in buffer, logger %s", vec_len (es),
-		   em->event_ring_size,
+		   elog_buffer_capacity (em),
 		   em->n_total_events < em->n_total_events_disable_limit ?
 		   "running" : "stopped");
+#ifdef CLIB_UNIX
+  if (vlib_elog_stream.fd >= 0)
+    vlib_cli_output (vm, "streaming: %Ld events written, %Ld lost",
+		     vlib_elog_stream.n_events_written,
+		     vlib_elog_stream.n_events_lost);
+#endif
   vec_foreach (e, es)
   {
     vlib_cli_output (vm, "%18.9f: %U",
@@ -972,6 +1136,9 @@ dispatch_node (vlib_main_t * vm,
        * "bad monkey" contexts, and you want to know exactly
        * which nodes they've visited... See ixge.c...
        */
+      if (PREDICT_FALSE (node->flags & VLIB_NODE_FLAG_SAMPLE) && frame)
+	vlib_trace_sample_frame (vm, node, frame, last_time_stamp);
+
       if (VLIB_BUFFER_TRACE_TRAJECTORY && frame)
 	{
 	  int i;
@@ -1105,7 +1272,7 @@ dispatch_pending_node (vlib_main_t * vm, uword pending_frame_index,
     {
       /* No next frame: so use dummy on stack. */
       nf = &nf_dummy;
-      nf->flags = f->flags & VLIB_NODE_FLAG_TRACE;
+      nf->flags = f->flags & (VLIB_NODE_FLAG_TRACE | VLIB_NODE_FLAG_SAMPLE);
       nf->frame_index = ~p->frame_index;
     }
   else
@@ -1131,9 +1298,10 @@ dispatch_pending_node (vlib_main_t * vm, uword pending_frame_index,
   /* Copy trace flag from next frame to node.
      Trace flag indicates that at least one vector in the dispatched
      frame is traced. */
-  n->flags &= ~VLIB_NODE_FLAG_TRACE;
+  n->flags &= ~(VLIB_NODE_FLAG_TRACE | VLIB_NODE_FLAG_SAMPLE);
   n->flags |= (nf->flags & VLIB_FRAME_TRACE) ? VLIB_NODE_FLAG_TRACE : 0;
-  nf->flags &= ~VLIB_FRAME_TRACE;
+  n->flags |= (nf->flags & VLIB_FRAME_SAMPLE) ? VLIB_NODE_FLAG_SAMPLE : 0;
+  nf->flags &= ~(VLIB_FRAME_TRACE | VLIB_FRAME_SAMPLE);
 
   last_time_stamp = dispatch_node (vm, n,
 				   VLIB_NODE_TYPE_INTERNAL,
@@ -1658,6 +1826,11 @@ vlib_main_configure (vlib_main_t * vm, unformat_input_t * input)
 	;
       else if (unformat (input, "elog-post-mortem-dump"))
 	vm->elog_post_mortem_dump = 1;
+      else if (unformat (input, "elog-stream %s", &vm->elog_stream_file))
+	;
+      else if (unformat (input, "elog-stream-interval %f",
+			 &vm->elog_stream_interval))
+	;
       else
 	return unformat_parse_error (input);
     }
@@ -1704,6 +1877,8 @@ vlib_main (vlib_main_t * volatile vm, unformat_input_t * input)
   /* Turn on event log. */
   if (!vm->elog_main.event_ring_size)
     vm->elog_main.event_ring_size = 128 << 10;
+  if (vm->elog_stream_interval <= 0)
+    vm->elog_stream_interval = 1.0;
   elog_init (&vm->elog_main, vm->elog_main.event_ring_size);
   elog_enable_disable (&vm->elog_main, 1);
 
@@ -175,6 +175,9 @@ typedef struct vlib_main_t
   /* to compare with node runtime */
   u32 thread_index;
 
+  /* NUMA node the thread runs on */
+  u32 numa_node;
+
   /* List of init functions to call, setup by constructors */
   _vlib_init_function_list_elt_t *init_function_registrations;
   _vlib_init_function_list_elt_t *worker_init_function_registrations;
@@ -196,6 +199,10 @@ typedef struct vlib_main_t
   /* Attempt to do a post-mortem elog dump */
   int elog_post_mortem_dump;
 
+  /* Event log stream started at boot, seconds between stream flushes */
+  char *elog_stream_file;
+  f64 elog_stream_interval;
+
   /*
    * Need to call vlib_worker_thread_node_runtime_update before
    * releasing worker thread barrier. Only valid in vlib_global_main.
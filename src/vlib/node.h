@@ -78,8 +78,11 @@ typedef enum
 typedef struct _vlib_node_fn_registration
 {
   vlib_node_function_t *function;
+  /* Highest wins, negative if the cpu can't run it */
   int priority;
   struct _vlib_node_fn_registration *next_registration;
+  /* Name of the cpu variant, "default" for the baseline one */
+  char *name;
 } vlib_node_fn_registration_t;
 
 typedef struct _vlib_node_registration
@@ -174,7 +177,8 @@ __VA_ARGS__ vlib_node_registration_t x
 uword CLIB_MARCH_SFX (node##_fn)();					\
 static vlib_node_fn_registration_t					\
   CLIB_MARCH_SFX(node##_fn_registration) =				\
-  { .function = &CLIB_MARCH_SFX (node##_fn), };				\
+  { .function = &CLIB_MARCH_SFX (node##_fn),				\
+    .name = CLIB_MARCH_VARIANT_STR, };					\
 									\
 static void __clib_constructor						\
 CLIB_MARCH_SFX (node##_multiarch_register) (void)			\
@@ -256,6 +260,9 @@ typedef struct vlib_node_t
   /* Node name. */
   u8 *name;
 
+  /* Candidates for the node function, one per cpu variant. */
+  vlib_node_fn_registration_t *node_fn_registrations;
+
   /* Node name index in elog string table. */
   u32 name_elog_string;
 
@@ -297,6 +304,12 @@ typedef struct vlib_node_t
 #define VLIB_NODE_FLAG_SWITCH_FROM_INTERRUPT_TO_POLLING_MODE (1 << 6)
 #define VLIB_NODE_FLAG_SWITCH_FROM_POLLING_TO_INTERRUPT_MODE (1 << 7)
 
+  /* Set if current node runtime has sampled vectors. */
+#define VLIB_NODE_FLAG_SAMPLE (1 << 8)
+
+  /* Set on input nodes which sample the packets they receive. */
+#define VLIB_NODE_FLAG_SAMPLE_INPUT (1 << 9)
+
   /* State for input nodes. */
   u8 state;
 
@@ -414,6 +427,9 @@ typedef struct
   /* Set when frame has traced packets. */
 #define VLIB_FRAME_TRACE VLIB_NODE_FLAG_TRACE
 
+  /* Set when frame has sampled packets. */
+#define VLIB_FRAME_SAMPLE VLIB_NODE_FLAG_SAMPLE
+
   /* Number of vectors enqueue to this next since last overflow. */
   u32 vectors_since_last_overflow;
 } vlib_next_frame_t;
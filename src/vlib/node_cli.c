@@ -441,6 +441,129 @@ VLIB_CLI_COMMAND (clear_node_runtime_command, static) = {
 };
 /* *INDENT-ON* */
 
+static clib_error_t *
+show_node (vlib_main_t * vm, unformat_input_t * input,
+	   vlib_cli_command_t * cmd)
+{
+  static char *type_str[] = {
+    [VLIB_NODE_TYPE_INTERNAL] = "internal",
+    [VLIB_NODE_TYPE_INPUT] = "input",
+    [VLIB_NODE_TYPE_PRE_INPUT] = "pre-input",
+    [VLIB_NODE_TYPE_PROCESS] = "process",
+  };
+  static char *state_str[] = {
+#define _(f) [VLIB_NODE_STATE_##f] = #f,
+    foreach_vlib_node_state
+#undef _
+  };
+  vlib_node_fn_registration_t *fnr;
+  vlib_node_t *n;
+  u32 node_index;
+
+  if (!unformat (input, "%U", unformat_vlib_node, vm, &node_index))
+    return clib_error_return (0, "please specify a node");
+
+  n = vlib_get_node (vm, node_index);
+
+  vlib_cli_output (vm, "node %v, type %s, state %s, index %d", n->name,
+		   type_str[n->type], state_str[n->state], n->index);
+
+  if (n->node_fn_registrations == 0)
+    return 0;
+
+  vlib_cli_output (vm, "  node function variants:");
+  vlib_cli_output (vm, "    %-20s%-10s%s", "Name", "Priority", "Active");
+  for (fnr = n->node_fn_registrations; fnr; fnr = fnr->next_registration)
+    vlib_cli_output (vm, "    %-20s%-10d%s", fnr->name, fnr->priority,
+		     fnr->function == n->function ? "yes" : "");
+
+  return 0;
+}
+
+/*?
+ * Show the type and state of a graph node and, for the nodes which are
+ * built for several cpu variants, the variants of the node function and
+ * which one is in use. Variants with a negative priority can't run on
+ * this cpu.
+ *
+ * @cliexpar
+ * @cliexstart{show node ip4-rewrite}
+ * node ip4-rewrite, type internal, state POLLING, index 356
+ *   node function variants:
+ *     Name                Priority  Active
+ *     avx512              20        yes
+ *     avx2                10
+ *     default             0
+ * @cliexend
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_node_command, static) = {
+  .path = "show node",
+  .short_help = "show node <node-name>",
+  .function = show_node,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+set_node_function (vlib_main_t * vm, unformat_input_t * input,
+		   vlib_cli_command_t * cmd)
+{
+  vlib_node_fn_registration_t *fnr;
+  vlib_node_t *n;
+  u32 node_index;
+  u8 *variant = 0;
+
+  if (!unformat (input, "%U %s", unformat_vlib_node, vm, &node_index,
+		 &variant))
+    return clib_error_return (0, "please specify a node and a variant");
+
+  n = vlib_get_node (vm, node_index);
+
+  for (fnr = n->node_fn_registrations; fnr; fnr = fnr->next_registration)
+    if (!strcmp (fnr->name, (char *) variant))
+      break;
+
+  vec_free (variant);
+
+  if (fnr == 0)
+    return clib_error_return (0, "node %v has no such variant", n->name);
+
+  if (fnr->priority < 0)
+    return clib_error_return (0, "variant %s is not supported by this cpu",
+			      fnr->name);
+
+  /* Every thread has its own copy of the node and its runtime */
+  vlib_worker_thread_barrier_sync (vm);
+
+  /* *INDENT-OFF* */
+  foreach_vlib_main (({
+    vlib_get_node (this_vlib_main, node_index)->function = fnr->function;
+    if (n->type != VLIB_NODE_TYPE_PROCESS)
+      vlib_node_get_runtime (this_vlib_main, node_index)->function =
+	fnr->function;
+  }));
+  /* *INDENT-ON* */
+
+  vlib_worker_thread_barrier_release (vm);
+
+  return 0;
+}
+
+/*?
+ * Use another cpu variant of a node function than the one picked at
+ * startup, for instance to compare their cost with "show runtime".
+ *
+ * @cliexpar
+ * @cliexcmd{set node function ip4-rewrite avx2}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (set_node_function_command, static) = {
+  .path = "set node function",
+  .short_help = "set node function <node-name> <variant>",
+  .function = set_node_function,
+};
+/* *INDENT-ON* */
+
 /* Dummy function to get us linked in. */
 void
 vlib_node_cli_reference (void)
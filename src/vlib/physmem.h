@@ -57,13 +57,32 @@ typedef struct
 #define VLIB_PHYSMEM_F_INIT_MHEAP		(1 << 0)
 #define VLIB_PHYSMEM_F_HUGETLB			(1 << 1)
 #define VLIB_PHYSMEM_F_SHARED			(1 << 2)
+#define VLIB_PHYSMEM_F_ARENA			(1 << 3)
+#define VLIB_PHYSMEM_F_DMA_MAPPED		(1 << 4)
 
   u8 numa_node;
   u64 *page_table;
   u8 *name;
-} vlib_physmem_region_t;
 
+  /* offset of mem in the file behind fd, non-zero for regions carved
+     out of a preallocated arena */
+  uword fd_offset;
+} vlib_physmem_region_t;
 
+/* Hugepage memory preallocated on one numa node at startup, regions on
+   that node are carved out of it */
+typedef struct
+{
+  void *mem;
+  uword size;
+  uword n_used;
+  int fd;
+  u8 log2_page_size;
+  u8 numa_node;
+  u8 dma_mapped;
+  u32 n_pages;
+  u64 *page_table;
+} vlib_physmem_arena_t;
 
 typedef struct
 {
@@ -71,6 +90,13 @@ typedef struct
 #define VLIB_PHYSMEM_MAIN_F_HAVE_PAGEMAP	(1 << 0)
 #define VLIB_PHYSMEM_MAIN_F_HAVE_IOMMU		(1 << 1)
   vlib_physmem_region_t *regions;
+
+  /* arenas, indexed by numa node */
+  vlib_physmem_arena_t *arenas;
+
+  /* config */
+  uword arena_size;
+  u8 arena_log2_page_size;
 } vlib_physmem_main_t;
 
 extern vlib_physmem_main_t physmem_main;
@@ -316,6 +316,28 @@ clib_sysfs_list_to_bitmap (char *filename)
 }
 
 
+/* NUMA node of a cpu, 0 if unknown */
+static u32
+vlib_get_cpu_numa_node (vlib_thread_main_t * tm, u32 cpu)
+{
+  uword numa_node;
+  u32 rv = 0;
+  u8 *path = 0;
+
+  /* *INDENT-OFF* */
+  clib_bitmap_foreach (numa_node, tm->cpu_socket_bitmap, ({
+    vec_reset_length (path);
+    path = format (path, "/sys/devices/system/node/node%u/cpu%u%c",
+		   numa_node, cpu, 0);
+    if (access ((char *) path, F_OK) == 0)
+      rv = numa_node;
+  }));
+  /* *INDENT-ON* */
+
+  vec_free (path);
+  return rv;
+}
+
 /* Called early in the init sequence */
 
 clib_error_t *
@@ -371,6 +393,10 @@ vlib_thread_init (vlib_main_t * vm)
   if (!tm->cpu_socket_bitmap)
     tm->cpu_socket_bitmap = clib_bitmap_set (0, 0, 1);
 
+  vlib_buffer_main_set_numa_node (vm,
+				  vlib_get_cpu_numa_node (tm,
+							  tm->main_lcore));
+
   /* pin main thread to main_lcore  */
   if (tm->cb.vlib_thread_set_lcore_cb)
     {
@@ -679,7 +705,7 @@ vlib_worker_thread_bootstrap_fn (void *arg)
   w->lwp = syscall (SYS_gettid);
   w->thread_id = pthread_self ();
 
-  __os_thread_index = w - vlib_worker_threads;
+  os_set_thread_index (w - vlib_worker_threads);
 
   rv = (void *) clib_calljmp
     ((uword (*)(uword)) w->thread_function,
@@ -748,10 +774,16 @@ start_workers (vlib_main_t * vm)
    * and make the event log thread-safe.
    */
   main_heap_header->flags |= MHEAP_FLAG_THREAD_SAFE;
+  if (tm->heap_thread_cache && n_vlib_mains > 1)
+    mheap_thread_cache (main_heap, 1);
   vm->elog_main.lock =
     clib_mem_alloc_aligned (CLIB_CACHE_LINE_BYTES, CLIB_CACHE_LINE_BYTES);
   vm->elog_main.lock[0] = 0;
 
+  /* Each thread logs into its own ring, without locking. */
+  if (n_vlib_mains > 1)
+    elog_alloc_thread_rings (&vm->elog_main, n_vlib_mains);
+
   if (n_vlib_mains > 1)
     {
       /* Replace hand-crafted length-1 vector with a real vector */
@@ -940,6 +972,7 @@ start_workers (vlib_main_t * vm)
 
                             fl_clone[0] = fl_orig[0];
                             fl_clone->buffers = 0;
+                            fl_clone->remote_buffers = 0;
                             fl_clone->n_alloc = 0;
                           }));
 /* *INDENT-ON* */
@@ -1327,6 +1360,8 @@ cpu_config (vlib_main_t * vm, unformat_input_t * input)
 	;
       else if (unformat (input, "scheduler-priority %u", &tm->sched_priority))
 	;
+      else if (unformat (input, "heap-thread-cache"))
+	tm->heap_thread_cache = 1;
       else if (unformat (input, "%s %u", &name, &count))
 	{
 	  p = hash_get_mem (tm->thread_registrations_by_name, name);
@@ -1718,6 +1753,8 @@ vlib_frame_queue_dequeue (vlib_main_t * vm, vlib_frame_queue_main_t * fqm)
 
       vectors += elt->n_vectors;
       f->n_vectors = elt->n_vectors;
+      if (PREDICT_FALSE (vm->trace_main.sample_active_hint))
+	vlib_trace_sample_flag_frame (vm, f);
       vlib_put_frame_to_node (vm, fqm->node_index, f);
 
       elt->valid = 0;
@@ -1754,6 +1791,10 @@ vlib_worker_thread_fn (void *arg)
   clib_time_init (&vm->clib_time);
   clib_mem_set_heap (w->thread_mheap);
 
+  /* Allocate buffers from the pool of our numa node */
+  vlib_buffer_main_set_numa_node (vm,
+				  vlib_get_cpu_numa_node (tm, w->lcore_id));
+
   /* Wait until the dpdk init sequence is complete */
   while (tm->extern_thread_mgmt && tm->worker_thread_release == 0)
     vlib_worker_thread_barrier_check ();
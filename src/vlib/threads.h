@@ -343,6 +343,9 @@ typedef struct
   /* scheduling policy priority */
   u32 sched_priority;
 
+  /* Per-thread caches in front of the main heap */
+  int heap_thread_cache;
+
   /* callbacks */
   vlib_thread_callbacks_t cb;
   int extern_thread_mgmt;
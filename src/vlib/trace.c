@@ -128,6 +128,10 @@ clear_trace_buffer (void)
       if (! pool_is_free_index (tm->trace_buffer_pool, i))
         vec_free (tm->trace_buffer_pool[i]);
     pool_free (tm->trace_buffer_pool);
+
+    /* Sampled records stay in the ring for external readers. */
+    if (tm->sample_ring)
+      tm->sample_show_first = tm->sample_ring->head;
     clib_mem_set_heap (mainheap);
   }));
   /* *INDENT-ON* */
@@ -537,6 +541,442 @@ VLIB_CLI_COMMAND (clear_trace_cli,static) = {
 };
 /* *INDENT-ON* */
 
+/*
+ * Sampling tracer.
+ */
+
+void vlib_stats_register_trace_sample_ring (void *, u32, void *)
+  __attribute__ ((weak));
+void
+vlib_stats_register_trace_sample_ring (void *notused, u32 notused2,
+				       void *notused3)
+{
+}
+
+always_inline int
+trace_sample_match (vlib_trace_sampler_t * s, vlib_buffer_t * b)
+{
+  u8 *data;
+  int i;
+
+  if (s->match_offset + vec_len (s->match) > b->current_length)
+    return 0;
+
+  data = vlib_buffer_get_current (b) + s->match_offset;
+  for (i = 0; i < vec_len (s->match); i++)
+    if ((data[i] & s->mask[i]) != s->match[i])
+      return 0;
+
+  return 1;
+}
+
+/* Picks the packets to sample among the ones an input node just
+   enqueued, returns how many it picked. */
+uword
+vlib_trace_sample_input (vlib_main_t * vm, vlib_node_runtime_t * r,
+			 u32 * buffers, u32 n_buffers)
+{
+  vlib_trace_main_t *tm = &vm->trace_main;
+  vlib_trace_sampler_t *s;
+  vlib_buffer_t *b;
+  uword n_sampled = 0;
+  u64 now;
+  u32 i;
+
+  if (tm->sample_ring == 0 || r->node_index >= vec_len (tm->samplers))
+    return 0;
+
+  s = tm->samplers + r->node_index;
+  if (s->interval == 0)
+    return 0;
+
+  now = clib_cpu_time_now ();
+
+  for (i = 0; i < n_buffers; i++)
+    {
+      b = vlib_get_buffer (vm, buffers[i]);
+
+      /* trace_index belongs to the full tracer */
+      if (b->flags & VLIB_BUFFER_IS_TRACED)
+	continue;
+
+      if (s->match && !trace_sample_match (s, b))
+	continue;
+
+      if (--s->countdown > 0)
+	continue;
+
+      s->countdown = s->interval;
+      b->flags |= VLIB_BUFFER_IS_SAMPLED;
+      b->trace_index =
+	(vm->thread_index << VLIB_TRACE_SAMPLE_ID_THREAD_SHIFT) |
+	(tm->sample_sequence++ &
+	 pow2_mask (VLIB_TRACE_SAMPLE_ID_THREAD_SHIFT));
+      vlib_trace_sample_add (vm, r->node_index, buffers[i], b, now);
+      n_sampled++;
+    }
+
+  return n_sampled;
+}
+
+/* Records the sampled packets of a frame about to be dispatched. */
+void
+vlib_trace_sample_frame (vlib_main_t * vm, vlib_node_runtime_t * r,
+			 vlib_frame_t * f, u64 time)
+{
+  vlib_node_t *n = vlib_get_node (vm, r->node_index);
+  u32 i, *from;
+  vlib_buffer_t *b;
+
+  if (vm->trace_main.sample_ring == 0 || n->vector_size != sizeof (u32))
+    return;
+
+  from = vlib_frame_vector_args (f);
+  for (i = 0; i < f->n_vectors; i++)
+    {
+      b = vlib_get_buffer (vm, from[i]);
+      if (PREDICT_FALSE (b->flags & VLIB_BUFFER_IS_SAMPLED))
+	vlib_trace_sample_add (vm, r->node_index, from[i], b, time);
+    }
+}
+
+/* Sets the sample flag on a frame of buffers handed off by another
+   thread. */
+void
+vlib_trace_sample_flag_frame (vlib_main_t * vm, vlib_frame_t * f)
+{
+  u32 i, *from = vlib_frame_vector_args (f);
+
+  for (i = 0; i < f->n_vectors; i++)
+    if (vlib_get_buffer (vm, from[i])->flags & VLIB_BUFFER_IS_SAMPLED)
+      {
+	f->flags |= VLIB_FRAME_SAMPLE;
+	return;
+      }
+}
+
+static void
+trace_sample_ring_alloc (vlib_main_t * vm, vlib_main_t * this_vm,
+			 u32 n_records)
+{
+  vlib_trace_main_t *tm = &this_vm->trace_main;
+  vlib_trace_sample_ring_t *r;
+  void *oldheap;
+  void *vlib_stats_push_heap (void) __attribute__ ((weak));
+
+  if (tm->sample_ring && tm->sample_ring->n_records == n_records)
+    return;
+
+  /* Switch to the stats segment ... */
+  oldheap = vlib_stats_push_heap ();
+
+  if (tm->sample_ring)
+    clib_mem_free (tm->sample_ring);
+
+  r = clib_mem_alloc_aligned (sizeof (r[0]) + n_records *
+			      sizeof (r->records[0]), CLIB_CACHE_LINE_BYTES);
+  memset (r, 0, sizeof (r[0]) + n_records * sizeof (r->records[0]));
+  r->n_records = n_records;
+  r->thread_index = this_vm->thread_index;
+  r->init_cpu_time = vm->clib_time.init_cpu_time;
+  r->seconds_per_clock = vm->clib_time.seconds_per_clock;
+  tm->sample_ring = r;
+  tm->sample_show_first = 0;
+
+  /* ... register the ring there and switch back to the main heap */
+  vlib_stats_register_trace_sample_ring (r, this_vm->thread_index, oldheap);
+}
+
+static void
+trace_sampler_free (vlib_trace_sampler_t * s)
+{
+  vec_free (s->match);
+  vec_free (s->mask);
+  memset (s, 0, sizeof (s[0]));
+}
+
+static clib_error_t *
+cli_trace_sample (vlib_main_t * vm,
+		  unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  unformat_input_t _line_input, *line_input = &_line_input;
+  vlib_trace_main_t *tm;
+  vlib_trace_sampler_t *s;
+  vlib_node_runtime_t *rt;
+  vlib_node_t *n;
+  u32 node_index = ~0, interval = 0, match_offset = 0;
+  u32 n_records = VLIB_TRACE_SAMPLE_DEFAULT_RING_SIZE;
+  u8 *match = 0, *mask = 0;
+  int is_disable = 0, is_stop = 0, i;
+  clib_error_t *error = 0;
+
+  if (!unformat_user (input, unformat_line_input, line_input))
+    return 0;
+
+  while (unformat_check_input (line_input) != (uword) UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (line_input, "stop"))
+	is_stop = 1;
+      else if (unformat (line_input, "disable"))
+	is_disable = 1;
+      else if (unformat (line_input, "every %d", &interval))
+	;
+      else if (unformat (line_input, "match %d %U", &match_offset,
+			 unformat_hex_string, &match))
+	;
+      else if (unformat (line_input, "mask %U", unformat_hex_string, &mask))
+	;
+      else if (unformat (line_input, "records %d", &n_records))
+	;
+      else if (unformat (line_input, "%U", unformat_vlib_node, vm,
+			 &node_index))
+	;
+      else
+	{
+	  error = clib_error_create ("unknown input `%U'",
+				     format_unformat_error, line_input);
+	  goto done;
+	}
+    }
+
+  if (is_stop)
+    {
+      /* *INDENT-OFF* */
+      foreach_vlib_main ((
+	{
+	  void *oldheap;
+	  tm = &this_vlib_main->trace_main;
+	  tm->sample_active_hint = 0;
+	  oldheap = clib_mem_set_heap (this_vlib_main->heap_base);
+	  for (i = 0; i < vec_len (tm->samplers); i++)
+	    {
+	      if (tm->samplers[i].interval)
+		{
+		  rt = vlib_node_get_runtime (this_vlib_main, i);
+		  rt->flags &= ~VLIB_NODE_FLAG_SAMPLE_INPUT;
+		}
+	      trace_sampler_free (tm->samplers + i);
+	    }
+	  vec_free (tm->samplers);
+	  clib_mem_set_heap (oldheap);
+	}));
+      /* *INDENT-ON* */
+      goto done;
+    }
+
+  if (node_index == ~0)
+    {
+      error = clib_error_return (0, "input node required");
+      goto done;
+    }
+
+  n = vlib_get_node (vm, node_index);
+  if (n->type != VLIB_NODE_TYPE_INPUT)
+    {
+      error = clib_error_return (0, "%v is not an input node", n->name);
+      goto done;
+    }
+
+  if (!is_disable)
+    {
+      if (interval == 0)
+	{
+	  if (match == 0)
+	    {
+	      error = clib_error_return (0, "`every N' or `match' required");
+	      goto done;
+	    }
+	  interval = 1;
+	}
+      if (vec_len (match) > VLIB_TRACE_SAMPLE_MAX_MATCH_BYTES)
+	{
+	  error = clib_error_return (0, "match longer than %d bytes",
+				     VLIB_TRACE_SAMPLE_MAX_MATCH_BYTES);
+	  goto done;
+	}
+      if (mask && vec_len (mask) != vec_len (match))
+	{
+	  error = clib_error_return (0, "mask and match lengths differ");
+	  goto done;
+	}
+      if (n_records < 2)
+	{
+	  error = clib_error_return (0, "at least 2 records required");
+	  goto done;
+	}
+      n_records = max_pow2 (n_records);
+    }
+
+  /* *INDENT-OFF* */
+  foreach_vlib_main ((
+    {
+      void *oldheap;
+      tm = &this_vlib_main->trace_main;
+      rt = vlib_node_get_runtime (this_vlib_main, node_index);
+
+      if (!is_disable)
+	trace_sample_ring_alloc (vm, this_vlib_main, n_records);
+
+      oldheap = clib_mem_set_heap (this_vlib_main->heap_base);
+      vec_validate (tm->samplers, node_index);
+      s = tm->samplers + node_index;
+      trace_sampler_free (s);
+      if (is_disable)
+	rt->flags &= ~VLIB_NODE_FLAG_SAMPLE_INPUT;
+      else
+	{
+	  s->interval = s->countdown = interval;
+	  s->match_offset = match_offset;
+	  if (match)
+	    {
+	      s->match = vec_dup (match);
+	      if (mask)
+		s->mask = vec_dup (mask);
+	      else
+		{
+		  vec_validate (s->mask, vec_len (match) - 1);
+		  memset (s->mask, 0xff, vec_len (s->mask));
+		}
+	      /* Keep match == (data & mask) satisfiable. */
+	      for (i = 0; i < vec_len (s->match); i++)
+		s->match[i] &= s->mask[i];
+	    }
+	  rt->flags |= VLIB_NODE_FLAG_SAMPLE_INPUT;
+	}
+
+      tm->sample_active_hint = 0;
+      for (i = 0; i < vec_len (tm->samplers); i++)
+	tm->sample_active_hint |= tm->samplers[i].interval != 0;
+      clib_mem_set_heap (oldheap);
+    }));
+  /* *INDENT-ON* */
+
+done:
+  vec_free (match);
+  vec_free (mask);
+  unformat_free (line_input);
+  return error;
+}
+
+/*?
+ * Sample 1 in N of the packets received by an input node, or those
+ * matching a byte pattern, and record which nodes they visit into a
+ * per-thread ring in the stats segment. Recording costs a few stores per
+ * node visited by a sampled packet, so it can be left running in
+ * production. The rings are named /trace/sample/<thread-index> in the
+ * stats segment; use 'show trace sample' to decode them from the CLI.
+ *
+ * The match is a hex byte string compared with the packet data at the
+ * given offset from the start of the packet as the input node sees it,
+ * after applying the optional mask of the same length.
+ *
+ * @cliexpar
+ * @cliexcmd{trace sample dpdk-input every 1000}
+ * Sample the IPv4 packets sent to 10.0.0.1 by their ethernet header offset:
+ * @cliexcmd{trace sample pg-input match 30 0a000001}
+ * @cliexcmd{trace sample stop}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (trace_sample_cli,static) = {
+  .path = "trace sample",
+  .short_help = "trace sample <input-node> [every <n>] "
+    "[match <offset> <hex> [mask <hex>]] [records <n>] [disable] | stop",
+  .function = cli_trace_sample,
+};
+/* *INDENT-ON* */
+
+static int
+trace_sample_record_cmp (void *a1, void *a2)
+{
+  vlib_trace_sample_record_t *r1 = a1;
+  vlib_trace_sample_record_t *r2 = a2;
+
+  if (r1->sample_id != r2->sample_id)
+    return r1->sample_id < r2->sample_id ? -1 : 1;
+  return r1->time < r2->time ? -1 : (r1->time > r2->time);
+}
+
+static clib_error_t *
+cli_show_trace_sample (vlib_main_t * vm,
+		       unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  vlib_trace_sample_record_t *records = 0, *rec;
+  vlib_trace_sample_ring_t *r;
+  vlib_trace_main_t *tm;
+  u32 max = 50, n_samples = 0, last_id = ~0;
+  u64 next, n_total = 0;
+  vlib_node_t *n;
+
+  while (unformat_check_input (input) != (uword) UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "max %d", &max))
+	;
+      else
+	return clib_error_create ("expected 'max COUNT', got `%U'",
+				  format_unformat_error, input);
+    }
+
+  /* *INDENT-OFF* */
+  foreach_vlib_main ((
+    {
+      tm = &this_vlib_main->trace_main;
+      r = tm->sample_ring;
+      if (r)
+	{
+	  next = tm->sample_show_first;
+	  vlib_trace_sample_ring_read (r, &next, &records);
+	  n_total += next - tm->sample_show_first;
+	}
+    }));
+  /* *INDENT-ON* */
+
+  if (vec_len (records) == 0)
+    {
+      vlib_cli_output (vm, "No sampled packets");
+      goto done;
+    }
+
+  vec_sort_with_function (records, trace_sample_record_cmp);
+
+  vlib_cli_output (vm, "%lld records, %lld overwritten", n_total,
+		   n_total - vec_len (records));
+
+  vec_foreach (rec, records)
+  {
+    if (rec->sample_id != last_id)
+      {
+	if (n_samples++ == max)
+	  {
+	    vlib_cli_output (vm, "Limiting display to %d samples."
+			     " To display more specify max.", max);
+	    break;
+	  }
+	last_id = rec->sample_id;
+	vlib_cli_output (vm, "Sample 0x%08x thread %d", rec->sample_id,
+			 rec->sample_id >> VLIB_TRACE_SAMPLE_ID_THREAD_SHIFT);
+      }
+    n = vlib_get_node (vm, rec->node_index);
+    vlib_cli_output (vm, "  %-12.6f %-32v buffer 0x%x data %d length %d "
+		     "flags 0x%x opaque 0x%x",
+		     (f64) (i64) (rec->time - vm->clib_time.init_cpu_time) *
+		     vm->clib_time.seconds_per_clock, n->name,
+		     rec->buffer_index, rec->current_data,
+		     rec->current_length, rec->buffer_flags, rec->opaque0);
+  }
+
+done:
+  vec_free (records);
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_trace_sample_cli,static) = {
+  .path = "show trace sample",
+  .short_help = "show trace sample [max COUNT]",
+  .function = cli_show_trace_sample,
+};
+/* *INDENT-ON* */
+
 /* Dummy function to get us linked in. */
 void
 vlib_trace_cli_reference (void)
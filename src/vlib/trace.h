@@ -41,6 +41,7 @@
 #define included_vlib_trace_h
 
 #include <vppinfra/pool.h>
+#include <vppinfra/cache.h>
 
 typedef struct
 {
@@ -66,6 +67,128 @@ typedef struct
   u32 limit;
 } vlib_trace_node_t;
 
+/*
+ * Sampling tracer.
+ *
+ * Input nodes configured with "trace sample" mark 1 in N of their
+ * packets, optionally only those matching a byte mask, as sampled. Each
+ * node a sampled packet visits then appends a fixed size binary record
+ * to a per-thread ring. Nothing is formatted on the data-path: the rings
+ * live in the stats segment as /trace/sample/<thread-index> and are
+ * decoded by "show trace sample" or by an external reader mapping the
+ * segment.
+ */
+typedef struct
+{
+  /* CPU time stamp when the packet entered the node. */
+  u64 time;
+
+  /* Thread index << 24 | sequence number, same for all the records of
+     a packet. */
+  u32 sample_id;
+
+  /* Node the packet entered. */
+  u32 node_index;
+
+  u32 buffer_index;
+  i16 current_data;
+  u16 current_length;
+  u32 buffer_flags;
+
+  /* First opaque word, the RX sw_if_index for vnet buffers. */
+  u32 opaque0;
+} vlib_trace_sample_record_t;
+
+#define VLIB_TRACE_SAMPLE_ID_THREAD_SHIFT 24
+
+/*
+ * Single writer, lock-free reader ring. The writer fills in
+ * records[head % n_records] and then bumps head; a reader copies the
+ * records it wants and re-reads head to find out which of them may have
+ * been overwritten meanwhile.
+ */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /* Number of records ever written. */
+  volatile u64 head;
+
+  /* Power of 2. */
+  u32 n_records;
+  u32 thread_index;
+
+  /* To convert record times to seconds. */
+  u64 init_cpu_time;
+  f64 seconds_per_clock;
+
+    CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  vlib_trace_sample_record_t records[0];
+} vlib_trace_sample_ring_t;
+
+#define VLIB_TRACE_SAMPLE_DEFAULT_RING_SIZE (16 << 10)
+#define VLIB_TRACE_SAMPLE_MAX_MATCH_BYTES 64
+
+typedef struct
+{
+  /* Sample 1 in interval (matching) packets, 0 when disabled. */
+  u32 interval;
+  u32 countdown;
+
+  /* Optional filter: packet data at match_offset from current_data
+     and masked with mask must equal match. */
+  u32 match_offset;
+  u8 *match;
+  u8 *mask;
+} vlib_trace_sampler_t;
+
+/*
+ * Copy the records written since *next (at most the last n_records
+ * ones) to the end of *records, oldest first. Returns the number of
+ * records lost to the writer wrapping around. Only reads the ring, so
+ * usable from outside the process.
+ */
+static inline u64
+vlib_trace_sample_ring_read (vlib_trace_sample_ring_t * r, u64 * next,
+			     vlib_trace_sample_record_t ** records)
+{
+  vlib_trace_sample_record_t *dst;
+  u64 head, first, n_lost = 0;
+  i64 oldest;
+  u32 mask = r->n_records - 1;
+  uword n;
+
+  head = r->head;
+  CLIB_MEMORY_BARRIER ();
+
+  first = *next;
+  if (head - first > r->n_records)
+    {
+      n_lost = head - r->n_records - first;
+      first = head - r->n_records;
+    }
+  if (head == first)
+    return n_lost;
+
+  n = head - first;
+  vec_add2 (*records, dst, n);
+  for (; first < head; first++)
+    *dst++ = r->records[first & mask];
+
+  /* Records older than this may have been rewritten during the copy,
+     including the one the writer may be filling in right now. */
+  CLIB_MEMORY_BARRIER ();
+  oldest = (i64) r->head - r->n_records + 1;
+  if (oldest > (i64) (head - n))
+    {
+      u64 n_bad = clib_min (oldest - (i64) (head - n), n);
+      vec_delete (*records, n_bad, vec_len (*records) - n);
+      n_lost += n_bad;
+    }
+
+  *next = head;
+  return n_lost;
+}
+
 typedef struct
 {
   /* Pool of trace buffers. */
@@ -87,6 +210,18 @@ typedef struct
 
   /* verbosity */
   int verbose;
+
+  /* Sampling tracer: samplers indexed by input node index. */
+  vlib_trace_sampler_t *samplers;
+  vlib_trace_sample_ring_t *sample_ring;
+  u32 sample_sequence;
+
+  /* First ring record "show trace sample" displays, "clear trace"
+     moves it to the ring head. */
+  u64 sample_show_first;
+
+  /* Set while any input node of this thread samples. */
+  u8 sample_active_hint;
 } vlib_trace_main_t;
 
 #endif /* included_vlib_trace_h */
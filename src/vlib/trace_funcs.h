@@ -165,6 +165,37 @@ vlib_set_trace_count (vlib_main_t * vm, vlib_node_runtime_t * rt, u32 count)
   tn->count = tn->limit - count;
 }
 
+/* Append a sampling tracer record for buffer b entering node_index. */
+always_inline void
+vlib_trace_sample_add (vlib_main_t * vm, u32 node_index, u32 bi,
+		       vlib_buffer_t * b, u64 time)
+{
+  vlib_trace_sample_ring_t *r = vm->trace_main.sample_ring;
+  vlib_trace_sample_record_t *rec;
+  u64 head = r->head;
+
+  rec = r->records + (head & (r->n_records - 1));
+  rec->time = time;
+  rec->sample_id = b->trace_index;
+  rec->node_index = node_index;
+  rec->buffer_index = bi;
+  rec->current_data = b->current_data;
+  rec->current_length = b->current_length;
+  rec->buffer_flags = b->flags;
+  rec->opaque0 = b->opaque[0];
+
+  /* Readers must not see the new head before the record. */
+  CLIB_MEMORY_STORE_BARRIER ();
+  r->head = head + 1;
+}
+
+/* Sampling tracer hooks, called by the dispatcher. */
+uword vlib_trace_sample_input (vlib_main_t * vm, vlib_node_runtime_t * r,
+			       u32 * buffers, u32 n_buffers);
+void vlib_trace_sample_frame (vlib_main_t * vm, vlib_node_runtime_t * r,
+			      vlib_frame_t * f, u64 time);
+void vlib_trace_sample_flag_frame (vlib_main_t * vm, vlib_frame_t * f);
+
 /* Helper function for nodes which only trace buffer data. */
 void
 vlib_trace_frame_buffers_only (vlib_main_t * vm,
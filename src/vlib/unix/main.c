@@ -668,7 +668,7 @@ vlib_unix_main (int argc, char *argv[])
 
   vlib_thread_stack_init (0);
 
-  __os_thread_index = 0;
+  os_set_thread_index (0);
   vm->thread_index = 0;
 
   i = clib_calljmp (thread0, (uword) vm,
@@ -76,7 +76,7 @@ rx_thread_fn (void *arg)
        * and grab it for this thread. We need to be able to
        * push/pop the thread heap without affecting other thread(s).
        */
-      if (__os_thread_index == 0)
+      if (!os_thread_index_is_set ())
 	{
 	  for (i = 0; i < ARRAY_LEN (clib_per_cpu_mheaps); i++)
 	    {
@@ -84,11 +84,11 @@ rx_thread_fn (void *arg)
 		{
 		  /* Copy the main thread mheap pointer */
 		  clib_per_cpu_mheaps[i] = clib_per_cpu_mheaps[0];
-		  __os_thread_index = i;
+		  os_set_thread_index (i);
 		  break;
 		}
 	    }
-	  ASSERT (__os_thread_index > 0);
+	  ASSERT (os_get_thread_index () > 0);
 	}
       while (1)
 	vl_msg_api_queue_handler (q);
@@ -20,6 +20,7 @@
 #include <vnet/adj/adj_mcast.h>
 #include <vnet/adj/adj_delegate.h>
 #include <vnet/fib/fib_node_list.h>
+#include <vnet/ip/ip4_flow_cache.h>
 
 /* Adjacency packet/byte counters indexed by adjacency index. */
 vlib_combined_counter_main_t adjacency_counters;
@@ -165,6 +166,12 @@ adj_last_lock_gone (ip_adjacency_t *adj)
 
     vlib_worker_thread_barrier_sync (vm);
 
+    /*
+     * flows cached with this adj must not use it, or its index's
+     * next owner
+     */
+    ip4_flow_cache_invalidate();
+
     switch (adj->lookup_next_index)
     {
     case IP_LOOKUP_NEXT_MIDCHAIN:
@@ -64,7 +64,8 @@
   _(16, L4_HDR_OFFSET_VALID, 0)				\
   _(17, FLOW_REPORT, "flow-report")			\
   _(18, IS_DVR, "dvr")                                  \
-  _(19, QOS_DATA_VALID, 0)
+  _(19, QOS_DATA_VALID, 0)				\
+  _(20, FLOW_CACHE_LEARN, "flow-cache-learn")
 
 #define VNET_BUFFER_FLAGS_VLAN_BITS \
   (VNET_BUFFER_F_VLAN_1_DEEP | VNET_BUFFER_F_VLAN_2_DEEP)
@@ -394,6 +395,22 @@ typedef struct
       u64 pad[1];
       u64 pg_replay_timestamp;
     };
+    /**
+     * The flow a packet was looked up with in the ip4 flow cache, kept
+     * until the output feature arc learns the flow's outcome.
+     */
+    struct
+    {
+      u64 pad[2];
+      u32 src_address;
+      u32 dst_address;
+      u16 src_port;
+      u16 dst_port;
+      u32 rx_sw_if_index;
+      u32 epoch;
+      u16 fragment_id;
+      u16 length;
+    } flow_cache;
     u32 unused[10];
   };
 } vnet_buffer_opaque2_t;
@@ -18,6 +18,7 @@
 #include <vnet/api_errno.h>	/* for API error numbers */
 #include <vnet/l2/l2_classify.h>	/* for L2_INPUT_CLASSIFY_NEXT_xxx */
 #include <vnet/fib/fib_table.h>
+#include <vnet/ip/ip4_flow_cache.h>
 
 vnet_classify_main_t vnet_classify_main;
 
@@ -134,6 +135,7 @@ vnet_classify_new_table (vnet_classify_main_t * cm,
   clib_memcpy (t->mask, mask, match_n_vectors * sizeof (u32x4));
 
   t->next_table_index = ~0;
+  vec_add1 (t->chain, t - cm->tables);
   t->nbuckets = nbuckets;
   t->log2_nbuckets = max_log2 (nbuckets);
   t->match_n_vectors = match_n_vectors;
@@ -170,9 +172,38 @@ vnet_classify_delete_table_index (vnet_classify_main_t * cm,
 
   vec_free (t->mask);
   vec_free (t->buckets);
+  vec_free (t->chain);
   mheap_free (t->mheap);
 
   pool_put (cm->tables, t);
+  vnet_classify_update_chains (cm);
+}
+
+/*
+ * Rebuild each table's chain after a next_table_index changed or a table
+ * went away. Chains stop at a deleted table and are cut at the number of
+ * tables, should next_table_index make a loop.
+ */
+void
+vnet_classify_update_chains (vnet_classify_main_t * cm)
+{
+  vnet_classify_table_t *t;
+  u32 next, max_len = pool_elts (cm->tables);
+
+  /* *INDENT-OFF* */
+  pool_foreach (t, cm->tables,
+  ({
+    vec_reset_length (t->chain);
+    vec_add1 (t->chain, t - cm->tables);
+    next = t->next_table_index;
+    while (next != ~0 && !pool_is_free_index (cm->tables, next) &&
+	   vec_len (t->chain) < max_len)
+      {
+	vec_add1 (t->chain, next);
+	next = pool_elt_at_index (cm->tables, next)->next_table_index;
+      }
+  }));
+  /* *INDENT-ON* */
 }
 
 static vnet_classify_entry_t *
@@ -779,6 +810,7 @@ vnet_classify_add_del_table (vnet_classify_main_t * cm,
 
 	  t->next_table_index = next_table_index;
 	}
+      vnet_classify_update_chains (cm);
       return 0;
     }
 
@@ -2190,6 +2222,7 @@ vnet_classify_add_del_session (vnet_classify_main_t * cm,
   rv = vnet_classify_add_del (t, e, is_add);
 
   vnet_classify_entry_release_resource (e);
+  ip4_flow_cache_invalidate ();
 
   if (rv)
     return VNET_API_ERROR_NO_SUCH_ENTRY;
@@ -2456,6 +2489,7 @@ typedef struct
   u32 sessions;
   u32 iterations;
   u32 memory_size;
+  u32 n_tables;
   ip4_address_t src;
   vnet_classify_table_t *table;
   u32 table_index;
@@ -2642,6 +2676,185 @@ test_classify_churn (test_classify_main_t * tm)
   return 0;
 }
 
+#define TEST_CLASSIFY_CHAIN_N_PACKETS 1024
+#define TEST_CLASSIFY_CHAIN_PACKET_SIZE 64
+
+/*
+ * Look the test packets up in a chain, a table at a time as the nodes
+ * used to or with vnet_classify_find_entry_chain. As in the nodes, a
+ * frame's packets are first hashed in the chain's first table.
+ */
+static u64
+test_classify_chain_lookup (test_classify_main_t * tm, u32 table_index,
+			    u8 * packets, vnet_classify_entry_t ** results,
+			    int parallel)
+{
+  vnet_classify_main_t *cm = tm->classify_main;
+  vnet_classify_table_t *t0 = pool_elt_at_index (cm->tables, table_index);
+  u64 hashes[VLIB_FRAME_SIZE], start;
+  vnet_classify_entry_t *e;
+  vnet_classify_table_t *t;
+  u32 i, j, n, hit_table_index;
+  u8 *h;
+
+  start = clib_cpu_time_now ();
+
+  for (i = 0; i < TEST_CLASSIFY_CHAIN_N_PACKETS; i += n)
+    {
+      n = clib_min (TEST_CLASSIFY_CHAIN_N_PACKETS - i, VLIB_FRAME_SIZE);
+
+      for (j = 0; j < n; j++)
+	{
+	  h = packets + (i + j) * TEST_CLASSIFY_CHAIN_PACKET_SIZE;
+	  hashes[j] = vnet_classify_hash_packet_inline (t0, h);
+	  vnet_classify_prefetch_bucket (t0, hashes[j]);
+	}
+
+      for (j = 0; j < n; j++)
+	{
+	  h = packets + (i + j) * TEST_CLASSIFY_CHAIN_PACKET_SIZE;
+	  if (parallel)
+	    e = vnet_classify_find_entry_chain (cm, table_index, h,
+						hashes[j], 0, &hit_table_index);
+	  else
+	    {
+	      t = t0;
+	      e = vnet_classify_find_entry_inline (t, h, hashes[j], 0);
+	      while (!e && t->next_table_index != ~0)
+		{
+		  t = pool_elt_at_index (cm->tables, t->next_table_index);
+		  e = vnet_classify_find_entry_inline
+		    (t, h, vnet_classify_hash_packet_inline (t, h), 0);
+		}
+	    }
+	  results[i + j] = e;
+	}
+    }
+
+  return clib_cpu_time_now () - start;
+}
+
+static clib_error_t *
+test_classify_chain (test_classify_main_t * tm)
+{
+  vnet_classify_main_t *cm = tm->classify_main;
+  vlib_main_t *vm = tm->vlib_main;
+  vnet_classify_entry_t **results[2] = { 0 };
+  classify_data_or_mask_t *mask, *data;
+  u32 *table_indices = 0, n_per_table, n_addresses;
+  u32 next_table_index = ~0, src, dst;
+  u64 clocks[2] = { 0 }, n_lookups;
+  u32 i, k, n_hits = 0, n_mismatches = 0;
+  vnet_classify_table_t *t;
+  u8 *mp = 0, *packets = 0;
+  int rv;
+
+  if (tm->n_tables == 0 || tm->n_tables > 32)
+    return clib_error_return (0, "tables must be between 1 and 32");
+
+  n_per_table = clib_max (tm->sessions / tm->n_tables, 1);
+  src = clib_net_to_host_u32 (tm->src.as_u32);
+  dst = 0xc0a80001;
+
+  vec_validate_aligned (mp, 3 * sizeof (u32x4), sizeof (u32x4));
+  mask = (classify_data_or_mask_t *) mp;
+
+  /*
+   * Table k matches the source address and the destination address with
+   * its k low bits masked, so that every table has its own mask.
+   * Created last first, to chain them.
+   */
+  for (k = tm->n_tables; k-- > 0;)
+    {
+      memset (mp, 0, vec_len (mp));
+      memset (&mask->ip.src_address, 0xff, 4);
+      mask->ip.dst_address.as_u32 = clib_host_to_net_u32 (~0ULL << k);
+
+      t = vnet_classify_new_table (cm, (u8 *) mask, tm->buckets,
+				   tm->memory_size, 0 /* skip */ ,
+				   3 /* vectors to match */ );
+      t->next_table_index = next_table_index;
+      t->miss_next_index = IP_LOOKUP_NEXT_DROP;
+      next_table_index = t - cm->tables;
+      vec_add1 (table_indices, next_table_index);
+
+      data = (classify_data_or_mask_t *) mp;
+      for (i = 0; i < n_per_table; i++)
+	{
+	  memset (mp, 0, vec_len (mp));
+	  data->ip.src_address.as_u32 =
+	    clib_host_to_net_u32 (src + k * n_per_table + i);
+	  data->ip.dst_address.as_u32 = clib_host_to_net_u32 (dst);
+	  rv = vnet_classify_add_del_session (cm, next_table_index,
+					      (u8 *) data,
+					      IP_LOOKUP_NEXT_DROP,
+					      i /* opaque_index */ ,
+					      0 /* advance */ ,
+					      0 /* action */ ,
+					      0 /* metadata */ ,
+					      1 /* is_add */ );
+	  if (rv != 0)
+	    clib_warning ("add: returned %d", rv);
+	}
+    }
+  vnet_classify_update_chains (cm);
+
+  vlib_cli_output (vm, "Created a chain of %d tables, %d sessions each",
+		   tm->n_tables, n_per_table);
+
+  /* about one packet in nine misses the whole chain */
+  n_addresses = tm->n_tables * n_per_table;
+  n_addresses += n_addresses / 8;
+  vec_validate_aligned (packets, TEST_CLASSIFY_CHAIN_N_PACKETS *
+			TEST_CLASSIFY_CHAIN_PACKET_SIZE - 1, sizeof (u32x4));
+  for (i = 0; i < TEST_CLASSIFY_CHAIN_N_PACKETS; i++)
+    {
+      data = (classify_data_or_mask_t *)
+	(packets + i * TEST_CLASSIFY_CHAIN_PACKET_SIZE);
+      data->ip.src_address.as_u32 =
+	clib_host_to_net_u32 (src + random_u32 (&tm->seed) % n_addresses);
+      data->ip.dst_address.as_u32 = clib_host_to_net_u32 (dst);
+    }
+
+  vec_validate (results[0], TEST_CLASSIFY_CHAIN_N_PACKETS - 1);
+  vec_validate (results[1], TEST_CLASSIFY_CHAIN_N_PACKETS - 1);
+
+  for (i = 0; i < clib_max (tm->iterations / TEST_CLASSIFY_CHAIN_N_PACKETS,
+			    1); i++)
+    {
+      clocks[0] += test_classify_chain_lookup (tm, next_table_index,
+					       packets, results[0], 0);
+      clocks[1] += test_classify_chain_lookup (tm, next_table_index,
+					       packets, results[1], 1);
+    }
+  n_lookups = (u64) i * TEST_CLASSIFY_CHAIN_N_PACKETS;
+
+  for (i = 0; i < TEST_CLASSIFY_CHAIN_N_PACKETS; i++)
+    {
+      n_hits += results[0][i] != 0;
+      n_mismatches += results[0][i] != results[1][i];
+    }
+
+  vlib_cli_output (vm, "%llu lookups, %d of %d packets hit",
+		   n_lookups, n_hits, TEST_CLASSIFY_CHAIN_N_PACKETS);
+  vlib_cli_output (vm, "table at a time: %.2f clocks/lookup",
+		   (f64) clocks[0] / n_lookups);
+  vlib_cli_output (vm, "whole chain:     %.2f clocks/lookup",
+		   (f64) clocks[1] / n_lookups);
+  vlib_cli_output (vm, "%d mismatches, MUST be zero", n_mismatches);
+
+  vnet_classify_delete_table_index (cm, next_table_index, 1 /* del_chain */ );
+  vec_free (table_indices);
+  vec_free (results[0]);
+  vec_free (results[1]);
+  vec_free (packets);
+  vec_free (mp);
+
+  if (n_mismatches)
+    return clib_error_return (0, "chain lookup mismatches");
+  return 0;
+}
+
 static clib_error_t *
 test_classify_command_fn (vlib_main_t * vm,
 			  unformat_input_t * input, vlib_cli_command_t * cmd)
@@ -2662,6 +2875,7 @@ test_classify_command_fn (vlib_main_t * vm,
   tm->classify_main = cm;
   tm->vlib_main = vm;
   tm->verbose = 0;
+  tm->n_tables = 8;
 
   /* Default starting address 1.0.0.10 */
 
@@ -2687,6 +2901,10 @@ test_classify_command_fn (vlib_main_t * vm,
 	;
       else if (unformat (input, "churn-test"))
 	which = 0;
+      else if (unformat (input, "chain-test"))
+	which = 1;
+      else if (unformat (input, "tables %d", &tm->n_tables))
+	;
       else
 	break;
     }
@@ -2696,6 +2914,9 @@ test_classify_command_fn (vlib_main_t * vm,
     case 0:
       error = test_classify_churn (tm);
       break;
+    case 1:
+      error = test_classify_chain (tm);
+      break;
     default:
       error = clib_error_return (0, "No such test");
       break;
@@ -2709,8 +2930,8 @@ VLIB_CLI_COMMAND (test_classify_command, static) = {
     .path = "test classify",
     .short_help =
     "test classify [src <ip>] [sessions <nn>] [buckets <nn>] [seed <nnn>]\n"
-    "              [memory-size <nn>[M|G]]\n"
-    "              [churn-test]",
+    "              [memory-size <nn>[M|G]] [iterations <nn>]\n"
+    "              [churn-test | chain-test [tables <nn>]]",
     .function = test_classify_command_fn,
 };
 /* *INDENT-ON* */
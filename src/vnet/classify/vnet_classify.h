@@ -152,6 +152,8 @@ typedef struct
 
 typedef struct
 {
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
   /* Mask to apply after skipping N vectors */
   u32x4 *mask;
   /* Buckets and entries */
@@ -175,6 +177,9 @@ typedef struct
   /* Miss next index, return if next_table_index = 0 */
   u32 miss_next_index;
 
+  /* This table and the ones after it, in lookup order */
+  u32 *chain;
+
   /* Per-bucket working copies, one per thread */
   vnet_classify_entry_t **working_copies;
   int *working_copy_lengths;
@@ -508,6 +513,67 @@ vnet_classify_find_entry_inline (vnet_classify_table_t * t,
   return 0;
 }
 
+/* Tables a chain lookup hashes and prefetches ahead of searching them */
+#define VNET_CLASSIFY_CHAIN_BATCH 8
+
+/*
+ * Find the first match in the chain of tables starting at table_index,
+ * as walking next_table_index with vnet_classify_find_entry would.
+ * Instead of one table at a time, each batch of tables is hashed and has
+ * its buckets, then its entries, prefetched before any is searched, so
+ * the lookups in a long chain overlap rather than each waiting on the
+ * one before. hash is the packet's hash in the first table.
+ * Returns the entry and sets *hit_table_index to the table it was found
+ * in; on a miss returns 0 and sets it to the last table of the chain,
+ * whose miss_next_index applies.
+ */
+static inline vnet_classify_entry_t *
+vnet_classify_find_entry_chain (vnet_classify_main_t * cm, u32 table_index,
+				u8 * h, u64 hash, f64 now,
+				u32 * hit_table_index)
+{
+  vnet_classify_table_t *tables[VNET_CLASSIFY_CHAIN_BATCH];
+  u64 hashes[VNET_CLASSIFY_CHAIN_BATCH];
+  vnet_classify_table_t *t;
+  vnet_classify_entry_t *e;
+  u32 *chain, n_tables, n, i, j;
+
+  t = pool_elt_at_index (cm->tables, table_index);
+  chain = t->chain;
+  n_tables = vec_len (chain);
+
+  for (i = 0; i < n_tables; i += n)
+    {
+      n = clib_min (n_tables - i, VNET_CLASSIFY_CHAIN_BATCH);
+
+      for (j = 0; j < n; j++)
+	{
+	  tables[j] = pool_elt_at_index (cm->tables, chain[i + j]);
+	  hashes[j] = (i + j) ? vnet_classify_hash_packet_inline (tables[j],
+								 h) : hash;
+	  vnet_classify_prefetch_bucket (tables[j], hashes[j]);
+	}
+
+      for (j = 0; j < n; j++)
+	vnet_classify_prefetch_entry (tables[j], hashes[j]);
+
+      for (j = 0; j < n; j++)
+	{
+	  e = vnet_classify_find_entry_inline (tables[j], h, hashes[j], now);
+	  if (e)
+	    {
+	      *hit_table_index = chain[i + j];
+	      return e;
+	    }
+	}
+    }
+
+  *hit_table_index = chain[n_tables - 1];
+  return 0;
+}
+
+void vnet_classify_update_chains (vnet_classify_main_t * cm);
+
 vnet_classify_table_t *vnet_classify_new_table (vnet_classify_main_t * cm,
 						u8 * mask, u32 nbuckets,
 						u32 memory_size,
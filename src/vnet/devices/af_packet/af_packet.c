@@ -69,6 +69,9 @@ af_packet_eth_flag_change (vnet_main_t * vnm, vnet_hw_interface_t * hi,
 
   if (ETHERNET_INTERFACE_FLAG_MTU == (flags & ETHERNET_INTERFACE_FLAG_MTU))
     {
+      apif->rx_free_list_index =
+	vnet_hw_interface_rx_free_list (vnm, hi->hw_if_index);
+
       s = format (0, "/sys/class/net/%s/mtu%c", apif->host_if_name, 0);
 
       error = clib_sysfs_write ((char *) s, "%d", hi->max_packet_bytes);
@@ -362,6 +365,8 @@ af_packet_create_if (vlib_main_t * vm, u8 * host_if_name, u8 * hw_addr_set,
   sw = vnet_get_hw_sw_interface (vnm, apif->hw_if_index);
   hw = vnet_get_hw_interface (vnm, apif->hw_if_index);
   apif->sw_if_index = sw->sw_if_index;
+  apif->rx_free_list_index =
+    vnet_hw_interface_rx_free_list (vnm, apif->hw_if_index);
   vnet_hw_interface_set_input_node (vnm, apif->hw_if_index,
 				    af_packet_input_node.index);
 
@@ -47,6 +47,9 @@ typedef struct
 
   u32 per_interface_next_index;
   u8 is_admin_up;
+
+  /* free list received frames are copied into */
+  vlib_buffer_free_list_index_t rx_free_list_index;
 } af_packet_if_t;
 
 typedef struct
@@ -57,8 +60,8 @@ typedef struct
   /* bitmap of pending rx interfaces */
   uword *pending_input_bitmap;
 
-  /* rx buffer cache */
-  u32 **rx_buffers;
+  /* rx buffer cache, per thread and free list */
+  u32 ***rx_buffers;
 
   /* hash of host interface names */
   mhash_t if_index_by_host_if_name;
@@ -50,6 +50,7 @@ typedef struct
 {
   u32 next_index;
   u32 hw_if_index;
+  u32 n_buffers;
   int block;
   struct tpacket2_hdr tph;
 } af_packet_input_trace_t;
@@ -62,8 +63,8 @@ format_af_packet_input_trace (u8 * s, va_list * args)
   af_packet_input_trace_t *t = va_arg (*args, af_packet_input_trace_t *);
   u32 indent = format_get_indent (s);
 
-  s = format (s, "af_packet: hw_if_index %d next-index %d",
-	      t->hw_if_index, t->next_index);
+  s = format (s, "af_packet: hw_if_index %d next-index %d n-buffers %u",
+	      t->hw_if_index, t->next_index, t->n_buffers);
 
   s =
     format (s,
@@ -192,22 +193,25 @@ af_packet_device_input_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
   u8 *block_start = apif->rx_ring + block * block_size;
   uword n_trace = vlib_get_trace_count (vm, node);
   u32 thread_index = vm->thread_index;
-  u32 n_buffer_bytes = vlib_buffer_free_list_buffer_size (vm,
-							  VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX);
+  vlib_buffer_free_list_index_t fl_index = apif->rx_free_list_index;
+  u32 n_buffer_bytes = vlib_buffer_free_list_buffer_size (vm, fl_index);
   u32 min_bufs = apif->rx_req->tp_frame_size / n_buffer_bytes;
+  u32 **rx_buffers;
 
   if (apif->per_interface_next_index != ~0)
     next_index = apif->per_interface_next_index;
 
-  n_free_bufs = vec_len (apm->rx_buffers[thread_index]);
+  vec_validate (apm->rx_buffers[thread_index], fl_index);
+  rx_buffers = &apm->rx_buffers[thread_index][fl_index];
+
+  n_free_bufs = vec_len (rx_buffers[0]);
   if (PREDICT_FALSE (n_free_bufs < VLIB_FRAME_SIZE))
     {
-      vec_validate (apm->rx_buffers[thread_index],
-		    VLIB_FRAME_SIZE + n_free_bufs - 1);
+      vec_validate (rx_buffers[0], VLIB_FRAME_SIZE + n_free_bufs - 1);
       n_free_bufs +=
-	vlib_buffer_alloc (vm, &apm->rx_buffers[thread_index][n_free_bufs],
-			   VLIB_FRAME_SIZE);
-      _vec_len (apm->rx_buffers[thread_index]) = n_free_bufs;
+	vlib_buffer_alloc_from_free_list (vm, &rx_buffers[0][n_free_bufs],
+					  VLIB_FRAME_SIZE, fl_index);
+      _vec_len (rx_buffers[0]) = n_free_bufs;
     }
 
   rx_frame = apif->next_rx_frame;
@@ -229,12 +233,11 @@ af_packet_device_input_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  while (data_len)
 	    {
 	      /* grab free buffer */
-	      u32 last_empty_buffer =
-		vec_len (apm->rx_buffers[thread_index]) - 1;
+	      u32 last_empty_buffer = vec_len (rx_buffers[0]) - 1;
 	      prev_bi0 = bi0;
-	      bi0 = apm->rx_buffers[thread_index][last_empty_buffer];
+	      bi0 = rx_buffers[0][last_empty_buffer];
 	      b0 = vlib_get_buffer (vm, bi0);
-	      _vec_len (apm->rx_buffers[thread_index]) = last_empty_buffer;
+	      _vec_len (rx_buffers[0]) = last_empty_buffer;
 	      n_free_bufs--;
 
 	      /* copy data */
@@ -274,6 +277,7 @@ af_packet_device_input_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 		{
 		  b0->total_length_not_including_first_buffer = 0;
 		  b0->flags = VLIB_BUFFER_TOTAL_LENGTH_VALID;
+		  vlib_buffer_set_free_list_index (b0, fl_index);
 		  vnet_buffer (b0)->sw_if_index[VLIB_RX] = apif->sw_if_index;
 		  vnet_buffer (b0)->sw_if_index[VLIB_TX] = (u32) ~ 0;
 		  first_bi0 = bi0;
@@ -313,12 +317,19 @@ af_packet_device_input_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  if (PREDICT_FALSE (n_trace > 0))
 	    {
 	      af_packet_input_trace_t *tr;
+	      vlib_buffer_t *seg0 = first_b0;
 	      vlib_trace_buffer (vm, node, next0, first_b0,	/* follow_chain */
 				 0);
 	      vlib_set_trace_count (vm, node, --n_trace);
 	      tr = vlib_add_trace (vm, node, first_b0, sizeof (*tr));
 	      tr->next_index = next0;
 	      tr->hw_if_index = apif->hw_if_index;
+	      tr->n_buffers = 1;
+	      while (seg0->flags & VLIB_BUFFER_NEXT_PRESENT)
+		{
+		  seg0 = vlib_get_buffer (vm, seg0->next_buffer);
+		  tr->n_buffers++;
+		}
 	      clib_memcpy (&tr->tph, tph, sizeof (struct tpacket2_hdr));
 	    }
 
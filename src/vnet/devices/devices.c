@@ -340,6 +340,26 @@ vnet_hw_interface_get_rx_mode (vnet_main_t * vnm, u32 hw_if_index,
   return VNET_API_ERROR_INVALID_INTERFACE;
 }
 
+/* Free list the RX queues of an interface fill from, so a frame of the
+   interface's max_packet_bytes lands in a single buffer: the default
+   one when such frames fit it, else one of that size if a buffer pool
+   has room for it. Devices pick it when the interface is created and
+   again when its MTU changes. */
+vlib_buffer_free_list_index_t
+vnet_hw_interface_rx_free_list (vnet_main_t * vnm, u32 hw_if_index)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  vnet_hw_interface_t *hw = vnet_get_hw_interface (vnm, hw_if_index);
+  u32 n_bytes = hw->max_packet_bytes;
+
+  ASSERT (vlib_get_thread_index () == 0);
+
+  if (n_bytes <= VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES)
+    return VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX;
+
+  return vlib_buffer_get_or_create_free_list (vm, n_bytes, "rx %u bytes",
+					      n_bytes);
+}
 
 
 static clib_error_t *
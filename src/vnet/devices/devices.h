@@ -93,6 +93,8 @@ int vnet_hw_interface_set_rx_mode (vnet_main_t * vnm, u32 hw_if_index,
 int vnet_hw_interface_get_rx_mode (vnet_main_t * vnm, u32 hw_if_index,
 				   u16 queue_id,
 				   vnet_hw_interface_rx_mode * mode);
+vlib_buffer_free_list_index_t
+vnet_hw_interface_rx_free_list (vnet_main_t * vnm, u32 hw_if_index);
 
 static inline u64
 vnet_get_aggregate_rx_packets (void)
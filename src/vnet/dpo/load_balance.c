@@ -22,6 +22,7 @@
 #include <vnet/adj/adj_internal.h>
 #include <vnet/fib/fib_urpf_list.h>
 #include <vnet/bier/bier_hdr_inlines.h>
+#include <vnet/ip/ip4_flow_cache.h>
 
 /*
  * distribution error tolerance for load-balancing
@@ -505,6 +506,7 @@ load_balance_multipath_update (const dpo_id_t *dpo,
 
     ASSERT(DPO_LOAD_BALANCE == dpo->dpoi_type);
     lb = load_balance_get(dpo->dpoi_index);
+    ip4_flow_cache_invalidate();
     fixed_nhs = load_balance_multipath_next_hop_fixup(raw_nhs, lb->lb_proto);
     n_buckets =
         ip_multipath_normalize_next_hops((NULL == fixed_nhs ?
@@ -1007,7 +1007,7 @@ lookup_dpo_mpls_inline (vlib_main_t * vm,
 
         while (n_left_from > 0 && n_left_to_next > 0)
         {
-            u32 bi0, lkdi0, lbi0, fib_index0, next0, hash0;
+            u32 bi0, lkdi0, lbi0, fib_index0, next0, hash0, n_labels0;
             const mpls_unicast_header_t * hdr0;
             const load_balance_t *lb0;
             const lookup_dpo_t * lkd0;
@@ -1090,6 +1090,11 @@ lookup_dpo_mpls_inline (vlib_main_t * vm,
             vnet_buffer (b0)->mpls.first = 1;
             vlib_buffer_advance(b0, sizeof(*hdr0));
 
+            /* the labels below, for as long as they are popped too */
+            n_labels0 = 1;
+            next0 = mpls_lookup_next_labels (vm, b0, next0, thread_index,
+                                             &n_labels0);
+
 	    if (PREDICT_FALSE(b0->flags & VLIB_BUFFER_IS_TRACED)) 
             {
                 lookup_trace_t *tr = vlib_add_trace (vm, node, 
@@ -64,6 +64,7 @@ typedef struct
   u8 packet_data[32];
 } ethernet_input_trace_t;
 
+#ifndef CLIB_MARCH_VARIANT
 static u8 *
 format_ethernet_input_trace (u8 * s, va_list * va)
 {
@@ -75,8 +76,7 @@ format_ethernet_input_trace (u8 * s, va_list * va)
 
   return s;
 }
-
-vlib_node_registration_t ethernet_input_node;
+#endif
 
 typedef enum
 {
@@ -286,6 +286,129 @@ determine_next_node (ethernet_main_t * em,
     }
 }
 
+#ifdef CLIB_HAVE_VEC256
+/* Frame speed-path: every packet arrived on the same main interface and
+   is untagged, plus for an L3 interface carries ip4, ip6 or mpls to our
+   mac. Classifies 8 packets at a time and enqueues the whole frame at
+   once. Returns 0 without touching any buffer when a packet needs the
+   per-packet path. */
+static_always_inline int
+ethernet_input_frame_x8 (vlib_main_t * vm, vlib_node_runtime_t * node,
+			 u32 * from, u32 n_packets)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  ethernet_main_t *em = &ethernet_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE + 7], **b;
+  u16 nexts[VLIB_FRAME_SIZE + 7], *next;
+  vnet_hw_interface_t *hi;
+  main_intf_t *intf;
+  u32x8 mask16 = u32x8_splat (0xffff);
+  u32 sw_if_index, is_l2, hw0 = 0, hw1 = 0;
+  int i, n_left;
+
+  vlib_get_buffers (vm, from, bufs, n_packets);
+
+  /* pad with the last buffer so the tail is checked 8 at a time too */
+  for (i = n_packets; i < round_pow2 (n_packets, 8); i++)
+    bufs[i] = bufs[n_packets - 1];
+
+  sw_if_index = vnet_buffer (bufs[0])->sw_if_index[VLIB_RX];
+  hi = vnet_get_sup_hw_interface (vnm, sw_if_index);
+  intf = vec_elt_at_index (em->main_intfs, hi->hw_if_index);
+  is_l2 = intf->untagged_subint.flags & SUBINT_CONFIG_L2;
+
+  if (hi->hw_address)
+    {
+      hw0 = *(u32 *) hi->hw_address;
+      hw1 = *(u16 *) (hi->hw_address + 4);
+    }
+
+  b = bufs;
+  next = nexts;
+  n_left = n_packets;
+
+  while (n_left > 0)
+    {
+      u32x8 type, bad;
+
+      bad = vlib_buffer_gather_u32_x8 (b, STRUCT_OFFSET_OF (vlib_buffer_t,
+							    opaque) +
+				       STRUCT_OFFSET_OF (vnet_buffer_opaque_t,
+							 sw_if_index
+							 [VLIB_RX])) ^
+	u32x8_splat (sw_if_index);
+
+      /* ethertype in network byte order */
+      type = vlib_buffer_gather_current_u32_x8 (b, 12) & mask16;
+
+#define _(t) ((u32x8) (type == u32x8_splat (clib_host_to_net_u16 (t))))
+      if (is_l2)
+	{
+	  bad |= _(ETHERNET_TYPE_VLAN) | _(ETHERNET_TYPE_DOT1AD) |
+	    _(ETHERNET_TYPE_VLAN_9100) | _(ETHERNET_TYPE_VLAN_9200);
+	  u16x8_store_unaligned (u16x8_splat (em->l2_next), next);
+	}
+      else
+	{
+	  u32x8 ip4 = _(ETHERNET_TYPE_IP4);
+	  u32x8 ip6 = _(ETHERNET_TYPE_IP6);
+	  u32x8 mpls = _(ETHERNET_TYPE_MPLS);
+	  u32x8 nx;
+
+	  bad |= ~(ip4 | ip6 | mpls);
+
+	  /* L3 my-mac filter, for unicast destinations */
+	  if (hi->hw_address)
+	    {
+	      u32x8 d0 = vlib_buffer_gather_current_u32_x8 (b, 0);
+	      u32x8 d1 = vlib_buffer_gather_current_u32_x8 (b, 4) & mask16;
+	      u32x8 ucast = (u32x8) ((d0 & u32x8_splat (1)) == u32x8_splat (0));
+	      bad |= ucast & ((u32x8) (d0 != u32x8_splat (hw0)) |
+			      (u32x8) (d1 != u32x8_splat (hw1)));
+	    }
+
+	  nx = (ip4 & u32x8_splat (em->l3_next.input_next_ip4)) |
+	    (ip6 & u32x8_splat (em->l3_next.input_next_ip6)) |
+	    (mpls & u32x8_splat (em->l3_next.input_next_mpls));
+	  for (i = 0; i < 8; i++)
+	    next[i] = nx[i];
+	}
+#undef _
+
+      if (!u32x8_is_all_zero (bad))
+	return 0;
+
+      b += 8;
+      next += 8;
+      n_left -= 8;
+    }
+
+  b = bufs;
+  n_left = n_packets;
+
+  while (n_left > 0)
+    {
+      vnet_buffer (b[0])->l2_hdr_offset = b[0]->current_data;
+      vnet_buffer (b[0])->l3_hdr_offset =
+	b[0]->current_data + sizeof (ethernet_header_t);
+      b[0]->flags |= VNET_BUFFER_F_L2_HDR_OFFSET_VALID |
+	VNET_BUFFER_F_L3_HDR_OFFSET_VALID;
+      b[0]->error = node->errors[ETHERNET_ERROR_NONE];
+
+      if (is_l2)
+	vnet_buffer (b[0])->l2.l2_len = sizeof (ethernet_header_t);
+      else
+	vlib_buffer_advance (b[0], sizeof (ethernet_header_t));
+
+      b += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, n_packets);
+  return 1;
+}
+#endif
+
 static_always_inline uword
 ethernet_input_inline (vlib_main_t * vm,
 		       vlib_node_runtime_t * node,
@@ -317,6 +440,12 @@ ethernet_input_inline (vlib_main_t * vm,
 				   sizeof (from[0]),
 				   sizeof (ethernet_input_trace_t));
 
+#ifdef CLIB_HAVE_VEC256
+  if (variant == ETHERNET_INPUT_VARIANT_ETHERNET &&
+      ethernet_input_frame_x8 (vm, node, from, n_left_from))
+    return from_frame->n_vectors;
+#endif
+
   next_index = node->cached_next_index;
   stats_sw_if_index = node->runtime_data[0];
   stats_n_packets = stats_n_bytes = 0;
@@ -768,30 +897,31 @@ ethernet_input_inline (vlib_main_t * vm,
   return from_frame->n_vectors;
 }
 
-static uword
-ethernet_input (vlib_main_t * vm,
-		vlib_node_runtime_t * node, vlib_frame_t * from_frame)
+VLIB_NODE_FN (ethernet_input_node) (vlib_main_t * vm,
+				    vlib_node_runtime_t * node,
+				    vlib_frame_t * from_frame)
 {
   return ethernet_input_inline (vm, node, from_frame,
 				ETHERNET_INPUT_VARIANT_ETHERNET);
 }
 
-static uword
-ethernet_input_type (vlib_main_t * vm,
-		     vlib_node_runtime_t * node, vlib_frame_t * from_frame)
+VLIB_NODE_FN (ethernet_input_type_node) (vlib_main_t * vm,
+					 vlib_node_runtime_t * node,
+					 vlib_frame_t * from_frame)
 {
   return ethernet_input_inline (vm, node, from_frame,
 				ETHERNET_INPUT_VARIANT_ETHERNET_TYPE);
 }
 
-static uword
-ethernet_input_not_l2 (vlib_main_t * vm,
-		       vlib_node_runtime_t * node, vlib_frame_t * from_frame)
+VLIB_NODE_FN (ethernet_input_not_l2_node) (vlib_main_t * vm,
+					   vlib_node_runtime_t * node,
+					   vlib_frame_t * from_frame)
 {
   return ethernet_input_inline (vm, node, from_frame,
 				ETHERNET_INPUT_VARIANT_NOT_L2);
 }
 
+#ifndef CLIB_MARCH_VARIANT
 
 // Return the subinterface config struct for the given sw_if_index
 // Also return via parameter the appropriate match flags for the
@@ -1155,7 +1285,6 @@ static char *ethernet_error_strings[] = {
 
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (ethernet_input_node) = {
-  .function = ethernet_input,
   .name = "ethernet-input",
   /* Takes a vector of packets. */
   .vector_size = sizeof (u32),
@@ -1174,12 +1303,7 @@ VLIB_REGISTER_NODE (ethernet_input_node) = {
 /* *INDENT-ON* */
 
 /* *INDENT-OFF* */
-VLIB_NODE_FUNCTION_MULTIARCH (ethernet_input_node, ethernet_input)
-/* *INDENT-ON* */
-
-/* *INDENT-OFF* */
-VLIB_REGISTER_NODE (ethernet_input_type_node, static) = {
-  .function = ethernet_input_type,
+VLIB_REGISTER_NODE (ethernet_input_type_node) = {
   .name = "ethernet-input-type",
   /* Takes a vector of packets. */
   .vector_size = sizeof (u32),
@@ -1193,12 +1317,7 @@ VLIB_REGISTER_NODE (ethernet_input_type_node, static) = {
 /* *INDENT-ON* */
 
 /* *INDENT-OFF* */
-VLIB_NODE_FUNCTION_MULTIARCH (ethernet_input_type_node, ethernet_input_type)
-/* *INDENT-ON* */
-
-/* *INDENT-OFF* */
-VLIB_REGISTER_NODE (ethernet_input_not_l2_node, static) = {
-  .function = ethernet_input_not_l2,
+VLIB_REGISTER_NODE (ethernet_input_not_l2_node) = {
   .name = "ethernet-input-not-l2",
   /* Takes a vector of packets. */
   .vector_size = sizeof (u32),
@@ -1212,12 +1331,6 @@ VLIB_REGISTER_NODE (ethernet_input_not_l2_node, static) = {
 /* *INDENT-ON* */
 
 
-/* *INDENT-OFF* */
-VLIB_NODE_FUNCTION_MULTIARCH (ethernet_input_not_l2_node,
-			      ethernet_input_not_l2)
-/* *INDENT-ON* */
-
-
 void
 ethernet_set_rx_redirect (vnet_main_t * vnm,
 			  vnet_hw_interface_t * hi, u32 enable)
@@ -1418,6 +1531,7 @@ ethernet_register_l3_redirect (vlib_main_t * vm, u32 node_index)
 
   ASSERT (i == em->redirect_l3_next);
 }
+#endif /* CLIB_MARCH_VARIANT */
 
 /*
  * fd.io coding-style-patch-verification: ON
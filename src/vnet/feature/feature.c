@@ -15,6 +15,7 @@
 
 #include <vnet/feature/feature.h>
 #include <vnet/adj/adj.h>
+#include <vnet/ip/ip4_flow_cache.h>
 
 vnet_feature_main_t feature_main;
 
@@ -224,6 +225,7 @@ vnet_feature_enable_disable_with_index (u8 arc_index, u32 feature_index,
     clib_bitmap_set (fm->sw_if_index_has_features[arc_index], sw_if_index,
 		     (feature_count > 0));
   adj_feature_update (sw_if_index, arc_index, (feature_count > 0));
+  ip4_flow_cache_invalidate ();
 
   fm->feature_count_by_sw_if_index[arc_index][sw_if_index] = feature_count;
   return 0;
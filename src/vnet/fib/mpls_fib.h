@@ -133,6 +133,26 @@ mpls_fib_table_forwarding_lookup (u32 mpls_fib_index,
     return (mf->mf_lbs[key]);
 }
 
+/**
+ * @brief Prefetch the LFIB entry for the label at the head of the header,
+ * ahead of the mpls_fib_table_forwarding_lookup for it.
+ */
+static inline void
+mpls_fib_table_forwarding_lookup_prefetch (u32 mpls_fib_index,
+                                           const mpls_unicast_header_t *hdr)
+{
+    mpls_label_t label;
+    mpls_fib_t *mf;
+    u32 key;
+
+    label = clib_net_to_host_u32(hdr->label_exp_s_ttl);
+    key = (vnet_mpls_uc_get_label(label) << 1) | vnet_mpls_uc_get_s(label);
+
+    mf = mpls_fib_get(mpls_fib_index);
+
+    CLIB_PREFETCH(&mf->mf_lbs[key], sizeof(mf->mf_lbs[key]), LOAD);
+}
+
 static inline u32
 mpls_fib_table_get_index_for_sw_if_index (u32 sw_if_index)
 {
@@ -106,8 +106,13 @@ vnet_flow_enable (vnet_main_t * vnm, u32 flow_index, u32 hw_if_index)
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   dev_class = vnet_get_device_class (vnm, hi->dev_class_index);
 
+  /* devices without flow offload get it emulated */
   if (dev_class->flow_ops_function == 0)
-    return VNET_FLOW_ERROR_NOT_SUPPORTED;
+    {
+      rv = vnet_flow_sw_ops (vnm, VNET_FLOW_DEV_OP_ADD_FLOW, hw_if_index,
+			     flow_index, &private_data);
+      goto done;
+    }
 
   if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)
     {
@@ -121,6 +126,7 @@ vnet_flow_enable (vnet_main_t * vnm, u32 flow_index, u32 hw_if_index)
 				     hi->dev_instance, flow_index,
 				     &private_data);
 
+done:
   if (rv)
     return rv;
 
@@ -147,8 +153,12 @@ vnet_flow_disable (vnet_main_t * vnm, u32 flow_index, u32 hw_if_index)
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   dev_class = vnet_get_device_class (vnm, hi->dev_class_index);
 
-  rv = dev_class->flow_ops_function (vnm, VNET_FLOW_DEV_OP_DEL_FLOW,
-				     hi->dev_instance, flow_index, p);
+  if (dev_class->flow_ops_function == 0)
+    rv = vnet_flow_sw_ops (vnm, VNET_FLOW_DEV_OP_DEL_FLOW, hw_if_index,
+			   flow_index, p);
+  else
+    rv = dev_class->flow_ops_function (vnm, VNET_FLOW_DEV_OP_DEL_FLOW,
+				       hi->dev_instance, flow_index, p);
 
   if (rv)
     return rv;
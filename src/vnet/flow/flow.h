@@ -165,6 +165,23 @@ typedef struct
   u8 *owner;
 } vnet_flow_range_t;
 
+/*
+ * Software emulation of the flow offload, used on interfaces whose
+ * device has none. Flows are matched by the flow-sw-input device-input
+ * feature, which applies their actions as a NIC and its input node would.
+ */
+typedef struct
+{
+  u32 flow_index;
+  u32 sw_if_index;
+
+  /* flow-sw-input next index for VNET_FLOW_ACTION_REDIRECT_TO_NODE */
+  u32 next_index;
+} vnet_flow_sw_entry_t;
+
+int vnet_flow_sw_ops (vnet_main_t * vnm, vnet_flow_dev_op_t op,
+		      u32 hw_if_index, u32 flow_index, uword * private_data);
+
 typedef struct
 {
   /* pool of device flow entries */
@@ -176,12 +193,23 @@ typedef struct
   /* vector of flow ranges */
   vnet_flow_range_t *ranges;
 
+  /* pool of software emulated flow entries */
+  vnet_flow_sw_entry_t *sw_entries;
+
+  /* software emulated flow entry indices, in the order they were
+     enabled, by rx sw_if_index */
+  u32 **sw_entries_by_sw_if_index;
+
+  /* software emulated flow packet and byte counts, by entry index */
+  vlib_combined_counter_main_t sw_counters;
+
 } vnet_flow_main_t;
 
 extern vnet_flow_main_t flow_main;
 
 format_function_t format_flow_actions;
 format_function_t format_flow_enabled_hw;
+format_function_t format_flow_sw;
 
 #endif /* included_vnet_flow_flow_h */
 
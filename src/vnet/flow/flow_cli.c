@@ -165,6 +165,8 @@ show_flow_entry (vlib_main_t * vm, unformat_input_t * input,
 	  if (dev_class->format_flow)
 	    vlib_cli_output (vm,  "  %U\n", dev_class->format_flow,
 			     hi->dev_instance, f->index, private_data);
+	  else if (dev_class->flow_ops_function == 0)
+	    vlib_cli_output (vm,  "  %U\n", format_flow_sw, private_data);
          }));
       /* *INDENT-ON* */
       return 0;
@@ -244,6 +246,17 @@ show_flow_interface (vlib_main_t * vm, unformat_input_t * input,
 
   hi = vnet_get_hw_interface (vnm, hw_if_index);
   dev_class = vnet_get_device_class (vnm, hi->dev_class_index);
+  if (dev_class->flow_ops_function == 0)
+    {
+      vnet_flow_main_t *fm = &flow_main;
+      u32 n_flows = 0;
+
+      if (hi->sw_if_index < vec_len (fm->sw_entries_by_sw_if_index))
+	n_flows = vec_len (fm->sw_entries_by_sw_if_index[hi->sw_if_index]);
+      vlib_cli_output (vm, "software emulation, %u flows", n_flows);
+      return 0;
+    }
+
   if (dev_class->format_flow == 0)
     return clib_error_return (0, "not supported");
 
@@ -323,6 +336,11 @@ test_flow (vlib_main_t * vm, unformat_input_t * input,
       else if (unformat (line_input, "buffer-advance %d",
 			 &flow.buffer_advance))
 	flow.actions |= VNET_FLOW_ACTION_BUFFER_ADVANCE;
+      else if (unformat (line_input, "redirect-to-queue %d",
+			 &flow.redirect_queue))
+	flow.actions |= VNET_FLOW_ACTION_REDIRECT_TO_QUEUE;
+      else if (unformat (line_input, "drop"))
+	flow.actions |= VNET_FLOW_ACTION_DROP;
       else if (unformat (line_input, "%U", unformat_vnet_hw_interface, vnm,
 			 &hw_if_index))
 	;
@@ -367,6 +385,9 @@ test_flow (vlib_main_t * vm, unformat_input_t * input,
 
   if (rv < 0)
     return clib_error_return (0, "flow error: %U", format_flow_error, rv);
+
+  if (action == FLOW_ADD)
+    vlib_cli_output (vm, "flow-index %u", flow_index);
   return 0;
 }
 
@@ -375,7 +396,8 @@ VLIB_CLI_COMMAND (test_flow_command, static) = {
     .path = "test flow",
     .short_help = "test flow add [src-ip <ip-addr/mask>] [dst-ip "
       "<ip-addr/mask>] [src-port <port/mask>] [dst-port <port/mask>] "
-      "[proto <ip-proto>",
+      "[proto <ip-proto>] [mark <id>] [next-node <node>] "
+      "[buffer-advance <n>] [redirect-to-queue <queue>] [drop]",
     .function = test_flow,
 };
 /* *INDENT-ON* */
@@ -473,6 +495,10 @@ format_flow (u8 * s, va_list * args)
   if (f->actions & VNET_FLOW_ACTION_BUFFER_ADVANCE)
     t = format (t, "%sbuffer-advance %d", t ? ", " : "", f->buffer_advance);
 
+  if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_QUEUE)
+    t = format (t, "%sredirect-to-queue %u", t ? ", " : "",
+		f->redirect_queue);
+
   if (t)
     {
       s = format (s, "\n%U%v", format_white_space, indent + 4, t);
@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/vnet.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/feature/feature.h>
+#include <vnet/flow/flow.h>
+
+/**
+ * @file
+ * @brief Software emulation of flow offload.
+ *
+ * Flows enabled on an interface whose device cannot offload them are
+ * matched by the flow-sw-input feature on the device-input arc, which
+ * applies their actions as the NIC and a device input node would: mark
+ * the buffer with the flow id, drop it, or send it from its L3 header on
+ * to the redirect node. This lets the users of the flow API, such as the
+ * VXLAN decap offload, run and be tested on any interface.
+ */
+
+#define VNET_FLOW_SW_ACTIONS (VNET_FLOW_ACTION_COUNT |		\
+			      VNET_FLOW_ACTION_MARK |		\
+			      VNET_FLOW_ACTION_BUFFER_ADVANCE |	\
+			      VNET_FLOW_ACTION_REDIRECT_TO_NODE |	\
+			      VNET_FLOW_ACTION_DROP)
+
+#define foreach_flow_sw_error			\
+  _(DROP, "flow drop")
+
+typedef enum
+{
+#define _(sym,str) FLOW_SW_ERROR_##sym,
+  foreach_flow_sw_error
+#undef _
+    FLOW_SW_N_ERROR,
+} flow_sw_error_t;
+
+static char *flow_sw_error_strings[] = {
+#define _(sym,string) string,
+  foreach_flow_sw_error
+#undef _
+};
+
+typedef enum
+{
+  FLOW_SW_NEXT_DROP,
+  FLOW_SW_N_NEXT,
+} flow_sw_next_t;
+
+typedef struct
+{
+  u32 flow_index;
+  u32 next_index;
+} flow_sw_trace_t;
+
+static u8 *
+format_flow_sw_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  flow_sw_trace_t *t = va_arg (*args, flow_sw_trace_t *);
+
+  if (t->flow_index == ~0)
+    return format (s, "flow-sw: no match");
+  return format (s, "flow-sw: flow %d, next %d", t->flow_index,
+		 t->next_index);
+}
+
+vlib_node_registration_t flow_sw_input_node;
+
+static_always_inline int
+flow_sw_match_ports (ip_port_and_mask_t * src, ip_port_and_mask_t * dst,
+		     u8 protocol, int is_first_fragment, u16 * l4)
+{
+  u16 src_port, dst_port;
+
+  if ((protocol != IP_PROTOCOL_TCP && protocol != IP_PROTOCOL_UDP)
+      || !is_first_fragment)
+    return src->mask == 0 && dst->mask == 0;
+
+  src_port = clib_net_to_host_u16 (l4[0]);
+  dst_port = clib_net_to_host_u16 (l4[1]);
+  return ((src_port ^ src->port) & src->mask) == 0
+    && ((dst_port ^ dst->port) & dst->mask) == 0;
+}
+
+static_always_inline int
+flow_sw_match_ip6_address (ip6_address_t * a, ip6_address_and_mask_t * am)
+{
+  return ((a->as_u64[0] ^ am->addr.as_u64[0]) & am->mask.as_u64[0]) == 0
+    && ((a->as_u64[1] ^ am->addr.as_u64[1]) & am->mask.as_u64[1]) == 0;
+}
+
+/**
+ * The VNI of the VXLAN header following a UDP header
+ */
+static_always_inline u32
+flow_sw_vxlan_vni (udp_header_t * udp)
+{
+  u32 *vxlan = (u32 *) (udp + 1);
+  return clib_net_to_host_u32 (vxlan[1]) >> 8;
+}
+
+static_always_inline int
+flow_sw_match (vnet_flow_t * f, u16 ethertype, void *l3, u32 l3_len)
+{
+  ip4_header_t *ip4 = l3;
+  ip6_header_t *ip6 = l3;
+  udp_header_t *udp;
+
+  switch (f->type)
+    {
+    case VNET_FLOW_TYPE_IP4_N_TUPLE:
+      {
+	vnet_flow_ip4_n_tuple_t *t = &f->ip4_n_tuple;
+	if (ethertype != ETHERNET_TYPE_IP4
+	    || l3_len < sizeof (ip4_header_t) + sizeof (udp_header_t))
+	  return 0;
+	return ((ip4->src_address.as_u32 ^ t->src_addr.addr.as_u32) &
+		t->src_addr.mask.as_u32) == 0
+	  && ((ip4->dst_address.as_u32 ^ t->dst_addr.addr.as_u32) &
+	      t->dst_addr.mask.as_u32) == 0
+	  && ip4->protocol == t->protocol
+	  && flow_sw_match_ports (&t->src_port, &t->dst_port, ip4->protocol,
+				  ip4_get_fragment_offset (ip4) == 0,
+				  ip4_next_header (ip4));
+      }
+    case VNET_FLOW_TYPE_IP6_N_TUPLE:
+      {
+	vnet_flow_ip6_n_tuple_t *t = &f->ip6_n_tuple;
+	if (ethertype != ETHERNET_TYPE_IP6
+	    || l3_len < sizeof (ip6_header_t) + sizeof (udp_header_t))
+	  return 0;
+	return flow_sw_match_ip6_address (&ip6->src_address, &t->src_addr)
+	  && flow_sw_match_ip6_address (&ip6->dst_address, &t->dst_addr)
+	  && ip6->protocol == t->protocol
+	  && flow_sw_match_ports (&t->src_port, &t->dst_port, ip6->protocol,
+				  1, ip6_next_header (ip6));
+      }
+    case VNET_FLOW_TYPE_IP4_VXLAN:
+      {
+	vnet_flow_ip4_vxlan_t *v = &f->ip4_vxlan;
+	if (ethertype != ETHERNET_TYPE_IP4
+	    || l3_len < sizeof (ip4_header_t) + sizeof (udp_header_t) + 8
+	    || ip4->protocol != IP_PROTOCOL_UDP
+	    || ip4_get_fragment_offset (ip4) != 0)
+	  return 0;
+	udp = ip4_next_header (ip4);
+	return ip4->src_address.as_u32 == v->src_addr.as_u32
+	  && ip4->dst_address.as_u32 == v->dst_addr.as_u32
+	  && udp->dst_port == clib_host_to_net_u16 (v->dst_port)
+	  && flow_sw_vxlan_vni (udp) == v->vni;
+      }
+    case VNET_FLOW_TYPE_IP6_VXLAN:
+      {
+	vnet_flow_ip6_vxlan_t *v = &f->ip6_vxlan;
+	if (ethertype != ETHERNET_TYPE_IP6
+	    || l3_len < sizeof (ip6_header_t) + sizeof (udp_header_t) + 8
+	    || ip6->protocol != IP_PROTOCOL_UDP)
+	  return 0;
+	udp = ip6_next_header (ip6);
+	return ip6_address_is_equal (&ip6->src_address, &v->src_addr)
+	  && ip6_address_is_equal (&ip6->dst_address, &v->dst_addr)
+	  && udp->dst_port == clib_host_to_net_u16 (v->dst_port)
+	  && flow_sw_vxlan_vni (udp) == v->vni;
+      }
+    default:
+      return 0;
+    }
+}
+
+static uword
+flow_sw_input_node_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
+		       vlib_frame_t * frame)
+{
+  vnet_flow_main_t *fm = &flow_main;
+  u32 thread_index = vm->thread_index;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left, *from;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+  b = bufs;
+  next = nexts;
+
+  while (n_left > 0)
+    {
+      vnet_flow_sw_entry_t *e = 0;
+      ethernet_header_t *eh;
+      vnet_flow_t *f = 0;
+      u32 sw_if_index, next0, l3_offset, *ei;
+      u16 ethertype;
+
+      if (n_left > 1)
+	vlib_prefetch_buffer_header (b[1], LOAD);
+
+      sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      vnet_feature_next (sw_if_index, &next0, b[0]);
+
+      eh = vlib_buffer_get_current (b[0]);
+      ethertype = clib_net_to_host_u16 (eh->type);
+      l3_offset = sizeof (ethernet_header_t);
+      if (ethertype == ETHERNET_TYPE_VLAN || ethertype == ETHERNET_TYPE_DOT1AD)
+	{
+	  ethernet_vlan_header_t *vh = (ethernet_vlan_header_t *) (eh + 1);
+	  ethertype = clib_net_to_host_u16 (vh->type);
+	  l3_offset += sizeof (ethernet_vlan_header_t);
+	}
+
+      if (PREDICT_TRUE (b[0]->current_length > l3_offset))
+	{
+	  /* *INDENT-OFF* */
+	  vec_foreach (ei, fm->sw_entries_by_sw_if_index[sw_if_index])
+	    {
+	      e = pool_elt_at_index (fm->sw_entries, ei[0]);
+	      f = vnet_get_flow (e->flow_index);
+	      if (flow_sw_match (f, ethertype, (u8 *) eh + l3_offset,
+				 b[0]->current_length - l3_offset))
+		break;
+	      e = 0;
+	    }
+	  /* *INDENT-ON* */
+	}
+
+      if (e)
+	{
+	  vlib_increment_combined_counter (&fm->sw_counters, thread_index,
+					   e - fm->sw_entries, 1,
+					   vlib_buffer_length_in_chain (vm,
+									b[0]));
+	  if (f->actions & VNET_FLOW_ACTION_DROP)
+	    {
+	      next0 = FLOW_SW_NEXT_DROP;
+	      b[0]->error = node->errors[FLOW_SW_ERROR_DROP];
+	    }
+	  else
+	    {
+	      if (f->actions & VNET_FLOW_ACTION_MARK)
+		b[0]->flow_id = f->mark_flow_id;
+	      /* device input nodes hand IP packets over at the L3 header */
+	      if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)
+		{
+		  vlib_buffer_advance (b[0], l3_offset);
+		  if (f->actions & VNET_FLOW_ACTION_BUFFER_ADVANCE)
+		    vlib_buffer_advance (b[0], f->buffer_advance);
+		  next0 = e->next_index;
+		}
+	    }
+	}
+
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  flow_sw_trace_t *t = vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->flow_index = e ? e->flow_index : ~0;
+	  t->next_index = next0;
+	}
+
+      next[0] = next0;
+
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
+  return frame->n_vectors;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (flow_sw_input_node) =
+{
+  .function = flow_sw_input_node_fn,
+  .name = "flow-sw-input",
+  .vector_size = sizeof (u32),
+  .format_trace = format_flow_sw_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = FLOW_SW_N_ERROR,
+  .error_strings = flow_sw_error_strings,
+  .n_next_nodes = FLOW_SW_N_NEXT,
+  .next_nodes =
+  {
+    [FLOW_SW_NEXT_DROP] = "error-drop",
+  },
+};
+
+VLIB_NODE_FUNCTION_MULTIARCH (flow_sw_input_node, flow_sw_input_node_fn);
+
+VNET_FEATURE_INIT (flow_sw_input, static) =
+{
+  .arc_name = "device-input",
+  .node_name = "flow-sw-input",
+  .runs_before = VNET_FEATURES ("ethernet-input"),
+};
+/* *INDENT-ON* */
+
+int
+vnet_flow_sw_ops (vnet_main_t * vnm, vnet_flow_dev_op_t op, u32 hw_if_index,
+		  u32 flow_index, uword * private_data)
+{
+  vnet_flow_main_t *fm = &flow_main;
+  vnet_flow_t *f = vnet_get_flow (flow_index);
+  vnet_hw_interface_t *hi = vnet_get_hw_interface (vnm, hw_if_index);
+  vnet_flow_sw_entry_t *e;
+  u32 **entries, i;
+
+  if (op == VNET_FLOW_DEV_OP_DEL_FLOW)
+    {
+      e = pool_elt_at_index (fm->sw_entries, *private_data);
+      entries = vec_elt_at_index (fm->sw_entries_by_sw_if_index,
+				  e->sw_if_index);
+      i = vec_search (entries[0], *private_data);
+      ASSERT (i != ~0);
+      vec_delete (entries[0], 1, i);
+
+      if (vec_len (entries[0]) == 0)
+	vnet_feature_enable_disable ("device-input", "flow-sw-input",
+				     e->sw_if_index, 0, 0, 0);
+
+      memset (e, 0, sizeof (*e));
+      pool_put (fm->sw_entries, e);
+      return 0;
+    }
+
+  if (op != VNET_FLOW_DEV_OP_ADD_FLOW)
+    return VNET_FLOW_ERROR_NOT_SUPPORTED;
+
+  /* an advance is relative to the L3 header the redirect hands over */
+  if ((f->actions & ~VNET_FLOW_SW_ACTIONS)
+      || ((f->actions & VNET_FLOW_ACTION_BUFFER_ADVANCE)
+	  && !(f->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)))
+    return VNET_FLOW_ERROR_NOT_SUPPORTED;
+
+  switch (f->type)
+    {
+    case VNET_FLOW_TYPE_IP4_N_TUPLE:
+    case VNET_FLOW_TYPE_IP6_N_TUPLE:
+    case VNET_FLOW_TYPE_IP4_VXLAN:
+    case VNET_FLOW_TYPE_IP6_VXLAN:
+      break;
+    default:
+      return VNET_FLOW_ERROR_NOT_SUPPORTED;
+    }
+
+  pool_get (fm->sw_entries, e);
+  e->flow_index = flow_index;
+  e->sw_if_index = hi->sw_if_index;
+  e->next_index = ~0;
+  if (f->actions & VNET_FLOW_ACTION_REDIRECT_TO_NODE)
+    e->next_index = vlib_node_add_next (vnm->vlib_main,
+					flow_sw_input_node.index,
+					f->redirect_node_index);
+
+  vlib_validate_combined_counter (&fm->sw_counters, e - fm->sw_entries);
+  vlib_zero_combined_counter (&fm->sw_counters, e - fm->sw_entries);
+
+  vec_validate (fm->sw_entries_by_sw_if_index, e->sw_if_index);
+  entries = vec_elt_at_index (fm->sw_entries_by_sw_if_index, e->sw_if_index);
+  if (vec_len (entries[0]) == 0)
+    vnet_feature_enable_disable ("device-input", "flow-sw-input",
+				 e->sw_if_index, 1, 0, 0);
+  vec_add1 (entries[0], e - fm->sw_entries);
+
+  *private_data = e - fm->sw_entries;
+  return 0;
+}
+
+u8 *
+format_flow_sw (u8 * s, va_list * args)
+{
+  uword private_data = va_arg (*args, uword);
+  vnet_flow_main_t *fm = &flow_main;
+  vlib_counter_t c;
+
+  vlib_get_combined_counter (&fm->sw_counters, private_data, &c);
+  return format (s, "software, %llu packets %llu bytes", c.packets,
+		 c.bytes);
+}
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
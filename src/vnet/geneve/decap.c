@@ -51,22 +51,111 @@ format_geneve_rx_trace (u8 * s, va_list * args)
 }
 
 always_inline u32
-validate_geneve_fib (vlib_buffer_t * b, geneve_tunnel_t * t, u32 is_ip4)
+geneve_buffer_fib_index (vlib_buffer_t * b, u32 is_ip4)
 {
-  u32 fib_index, sw_if_index;
+  u32 sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
 
-  sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
+  if (vnet_buffer (b)->sw_if_index[VLIB_TX] != (u32) ~ 0)
+    return vnet_buffer (b)->sw_if_index[VLIB_TX];
+
+  return is_ip4 ?
+    vec_elt (ip4_main.fib_index_by_sw_if_index, sw_if_index) :
+    vec_elt (ip6_main.fib_index_by_sw_if_index, sw_if_index);
+}
+
+/* Build the tunnel demux key of each packet in the frame: packet SIP,
+ * encap-fib and VNI */
+always_inline void
+geneve_demux_keys (vlib_main_t * vm, u32 * from, udp_tunnel_demux_key_t * k,
+		   u32 n_left, u32 is_ip4)
+{
+  while (n_left > 0)
+    {
+      vlib_buffer_t *b0;
+      geneve_header_t *geneve0;
+      u32 fib_index0;
+
+      if (n_left > 4)
+	{
+	  vlib_buffer_t *p4 = vlib_get_buffer (vm, from[4]);
+	  vlib_prefetch_buffer_header (p4, LOAD);
+	  CLIB_PREFETCH (p4->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      b0 = vlib_get_buffer (vm, from[0]);
+      fib_index0 = geneve_buffer_fib_index (b0, is_ip4);
+
+      /* udp leaves current_data pointing at the geneve header */
+      geneve0 = vlib_buffer_get_current (b0);
+      if (is_ip4)
+	{
+	  ip4_header_t *ip4_0 = (void *) ((u8 *) geneve0 -
+					  sizeof (udp_header_t) -
+					  sizeof (ip4_header_t));
+	  udp_tunnel_demux_key4 (k, &ip4_0->src_address, fib_index0,
+				 vnet_get_geneve_vni_bigendian (geneve0));
+	}
+      else
+	{
+	  ip6_header_t *ip6_0 = (void *) ((u8 *) geneve0 -
+					  sizeof (udp_header_t) -
+					  sizeof (ip6_header_t));
+	  udp_tunnel_demux_key6 (k, &ip6_0->src_address, fib_index0,
+				 vnet_get_geneve_vni_bigendian (geneve0));
+	}
+
+      from += 1;
+      k += 1;
+      n_left -= 1;
+    }
+}
+
+/* Return the tunnel found by the demux search, after checking the packet
+ * DIP against the tunnel local address. A packet to a multicast group also
+ * needs the mcast tunnel for that group, returned in mt0 */
+always_inline u32
+geneve_find_tunnel (geneve_main_t * vxm, udp_tunnel_demux_key_t * k,
+		    void *ip0, u32 is_ip4, geneve_tunnel_t ** mt0)
+{
+  u32 tunnel_index0 = udp_tunnel_demux_result (k, is_ip4);
+  geneve_tunnel_t *t0;
+  u32 mcast_index0;
+
+  if (PREDICT_FALSE (tunnel_index0 == ~0))
+    return ~0;
+  t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
 
   if (is_ip4)
-    fib_index = (vnet_buffer (b)->sw_if_index[VLIB_TX] == (u32) ~ 0) ?
-      vec_elt (ip4_main.fib_index_by_sw_if_index, sw_if_index) :
-      vnet_buffer (b)->sw_if_index[VLIB_TX];
+    {
+      ip4_header_t *ip4_0 = ip0;
+
+      if (PREDICT_TRUE (ip4_0->dst_address.as_u32 == t0->local.ip4.as_u32))
+	return tunnel_index0;
+      if (!ip4_address_is_multicast (&ip4_0->dst_address))
+	return ~0;
+      /* same encap-fib and VNI, keyed on the group */
+      k->kv4.key[0] = ip4_0->dst_address.as_u32;
+    }
   else
-    fib_index = (vnet_buffer (b)->sw_if_index[VLIB_TX] == (u32) ~ 0) ?
-      vec_elt (ip6_main.fib_index_by_sw_if_index, sw_if_index) :
-      vnet_buffer (b)->sw_if_index[VLIB_TX];
+    {
+      ip6_header_t *ip6_0 = ip0;
+
+      if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
+					      &t0->local.ip6)))
+	return tunnel_index0;
+      if (!ip6_address_is_multicast (&ip6_0->dst_address))
+	return ~0;
+      k->kv6.key[0] = ip6_0->dst_address.as_u64[0];
+      k->kv6.key[1] = ip6_0->dst_address.as_u64[1];
+    }
+
+  /* Make sure mcast GENEVE tunnel exist by packet DIP and VNI */
+  mcast_index0 = udp_tunnel_demux_lookup (&vxm->tunnel_demux, k, is_ip4);
+  if (PREDICT_FALSE (mcast_index0 == ~0))
+    return ~0;
 
-  return (fib_index == t->encap_fib_index);
+  *mt0 = pool_elt_at_index (vxm->tunnels, mcast_index0);
+  return tunnel_index0;
 }
 
 always_inline uword
@@ -78,21 +167,18 @@ geneve_input (vlib_main_t * vm,
   geneve_main_t *vxm = &geneve_main;
   vnet_main_t *vnm = vxm->vnet_main;
   vnet_interface_main_t *im = &vnm->interface_main;
-  u32 last_tunnel_index = ~0;
-  geneve4_tunnel_key_t last_key4;
-  geneve6_tunnel_key_t last_key6;
+  udp_tunnel_demux_key_t keys[VLIB_FRAME_SIZE], *k = keys;
   u32 pkts_decapsulated = 0;
   u32 thread_index = vm->thread_index;
   u32 stats_sw_if_index, stats_n_packets, stats_n_bytes;
 
-  if (is_ip4)
-    last_key4.as_u64 = ~0;
-  else
-    memset (&last_key6, 0xff, sizeof (last_key6));
-
   from = vlib_frame_vector_args (from_frame);
   n_left_from = from_frame->n_vectors;
 
+  /* Find the tunnels for the whole frame up front */
+  geneve_demux_keys (vm, from, keys, n_left_from, is_ip4);
+  udp_tunnel_demux_search (&vxm->tunnel_demux, keys, n_left_from, is_ip4);
+
   next_index = node->cached_next_index;
   stats_sw_if_index = node->runtime_data[0];
   stats_n_packets = stats_n_bytes = 0;
@@ -110,11 +196,9 @@ geneve_input (vlib_main_t * vm,
 	  ip4_header_t *ip4_0, *ip4_1;
 	  ip6_header_t *ip6_0, *ip6_1;
 	  geneve_header_t *geneve0, *geneve1;
-	  uword *p0, *p1;
+	  udp_tunnel_demux_key_t *k0, *k1;
 	  u32 tunnel_index0, tunnel_index1;
 	  geneve_tunnel_t *t0, *t1, *mt0 = NULL, *mt1 = NULL;
-	  geneve4_tunnel_key_t key4_0, key4_1;
-	  geneve6_tunnel_key_t key6_0, key6_1;
 	  u32 error0, error1;
 	  u32 sw_if_index0, sw_if_index1, len0, len1;
 
@@ -134,9 +218,12 @@ geneve_input (vlib_main_t * vm,
 
 	  bi0 = from[0];
 	  bi1 = from[1];
+	  k0 = &k[0];
+	  k1 = &k[1];
 	  to_next[0] = bi0;
 	  to_next[1] = bi1;
 	  from += 2;
+	  k += 2;
 	  to_next += 2;
 	  n_left_to_next -= 2;
 	  n_left_from -= 2;
@@ -217,113 +304,17 @@ geneve_input (vlib_main_t * vm,
 	      goto trace0;
 	    }
 #endif
-	  if (is_ip4)
+	  tunnel_index0 = geneve_find_tunnel (vxm, k0,
+					       is_ip4 ? (void *) ip4_0 :
+					       (void *) ip6_0, is_ip4, &mt0);
+	  if (PREDICT_FALSE (tunnel_index0 == ~0))
 	    {
-	      key4_0.remote = ip4_0->src_address.as_u32;
-	      key4_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-
-	      /* Make sure GENEVE tunnel exist according to packet SIP and VNI */
-	      if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
-		{
-		  p0 = hash_get (vxm->geneve4_tunnel_by_key, key4_0.as_u64);
-		  if (PREDICT_FALSE (p0 == NULL))
-		    {
-		      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		      next0 = GENEVE_INPUT_NEXT_DROP;
-		      goto trace0;
-		    }
-		  last_key4.as_u64 = key4_0.as_u64;
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
-	      t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
-
-	      /* Validate GENEVE tunnel encap-fib index agaist packet */
-	      if (PREDICT_FALSE (validate_geneve_fib (b0, t0, is_ip4) == 0))
-		{
-		  error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		  next0 = GENEVE_INPUT_NEXT_DROP;
-		  goto trace0;
-		}
-
-	      /* Validate GENEVE tunnel SIP against packet DIP */
-	      if (PREDICT_TRUE
-		  (ip4_0->dst_address.as_u32 == t0->local.ip4.as_u32))
-		goto next0;	/* valid packet */
-	      if (PREDICT_FALSE
-		  (ip4_address_is_multicast (&ip4_0->dst_address)))
-		{
-		  key4_0.remote = ip4_0->dst_address.as_u32;
-		  key4_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-		  /* Make sure mcast GENEVE tunnel exist by packet DIP and VNI */
-		  p0 = hash_get (vxm->geneve4_tunnel_by_key, key4_0.as_u64);
-		  if (PREDICT_TRUE (p0 != NULL))
-		    {
-		      mt0 = pool_elt_at_index (vxm->tunnels, p0[0]);
-		      goto next0;	/* valid packet */
-		    }
-		}
 	      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
 	      next0 = GENEVE_INPUT_NEXT_DROP;
 	      goto trace0;
-
 	    }
-	  else			/* !is_ip4 */
-	    {
-	      key6_0.remote.as_u64[0] = ip6_0->src_address.as_u64[0];
-	      key6_0.remote.as_u64[1] = ip6_0->src_address.as_u64[1];
-	      key6_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-
-	      /* Make sure GENEVE tunnel exist according to packet SIP and VNI */
-	      if (PREDICT_FALSE
-		  (memcmp (&key6_0, &last_key6, sizeof (last_key6)) != 0))
-		{
-		  p0 = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6_0);
-		  if (PREDICT_FALSE (p0 == NULL))
-		    {
-		      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		      next0 = GENEVE_INPUT_NEXT_DROP;
-		      goto trace0;
-		    }
-		  clib_memcpy (&last_key6, &key6_0, sizeof (key6_0));
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
-	      t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
-
-	      /* Validate GENEVE tunnel encap-fib index agaist packet */
-	      if (PREDICT_FALSE (validate_geneve_fib (b0, t0, is_ip4) == 0))
-		{
-		  error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		  next0 = GENEVE_INPUT_NEXT_DROP;
-		  goto trace0;
-		}
+	  t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
 
-	      /* Validate GENEVE tunnel SIP against packet DIP */
-	      if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
-						      &t0->local.ip6)))
-		goto next0;	/* valid packet */
-	      if (PREDICT_FALSE
-		  (ip6_address_is_multicast (&ip6_0->dst_address)))
-		{
-		  key6_0.remote.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		  key6_0.remote.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		  key6_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-		  p0 = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6_0);
-		  if (PREDICT_TRUE (p0 != NULL))
-		    {
-		      mt0 = pool_elt_at_index (vxm->tunnels, p0[0]);
-		      goto next0;	/* valid packet */
-		    }
-		}
-	      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-	      next0 = GENEVE_INPUT_NEXT_DROP;
-	      goto trace0;
-	    }
-
-	next0:
 	  next0 = t0->decap_next_index;
 	  sw_if_index0 = t0->sw_if_index;
 	  len0 = vlib_buffer_length_in_chain (vm, b0);
@@ -384,115 +375,17 @@ geneve_input (vlib_main_t * vm,
 	      goto trace1;
 	    }
 #endif
-	  if (is_ip4)
+	  tunnel_index1 = geneve_find_tunnel (vxm, k1,
+					       is_ip4 ? (void *) ip4_1 :
+					       (void *) ip6_1, is_ip4, &mt1);
+	  if (PREDICT_FALSE (tunnel_index1 == ~0))
 	    {
-	      key4_1.remote = ip4_1->src_address.as_u32;
-	      key4_1.vni = vnet_get_geneve_vni_bigendian (geneve1);
-
-	      /* Make sure unicast GENEVE tunnel exist by packet SIP and VNI */
-	      if (PREDICT_FALSE (key4_1.as_u64 != last_key4.as_u64))
-		{
-		  p1 = hash_get (vxm->geneve4_tunnel_by_key, key4_1.as_u64);
-		  if (PREDICT_FALSE (p1 == NULL))
-		    {
-		      error1 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		      next1 = GENEVE_INPUT_NEXT_DROP;
-		      goto trace1;
-		    }
-		  last_key4.as_u64 = key4_1.as_u64;
-		  tunnel_index1 = last_tunnel_index = p1[0];
-		}
-	      else
-		tunnel_index1 = last_tunnel_index;
-	      t1 = pool_elt_at_index (vxm->tunnels, tunnel_index1);
-
-	      /* Validate GENEVE tunnel encap-fib index agaist packet */
-	      if (PREDICT_FALSE (validate_geneve_fib (b1, t1, is_ip4) == 0))
-		{
-		  error1 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		  next1 = GENEVE_INPUT_NEXT_DROP;
-		  goto trace1;
-		}
-
-	      /* Validate GENEVE tunnel SIP against packet DIP */
-	      if (PREDICT_TRUE
-		  (ip4_1->dst_address.as_u32 == t1->local.ip4.as_u32))
-		goto next1;	/* valid packet */
-	      if (PREDICT_FALSE
-		  (ip4_address_is_multicast (&ip4_1->dst_address)))
-		{
-		  key4_1.remote = ip4_1->dst_address.as_u32;
-		  key4_1.vni = vnet_get_geneve_vni_bigendian (geneve1);
-		  /* Make sure mcast GENEVE tunnel exist by packet DIP and VNI */
-		  p1 = hash_get (vxm->geneve4_tunnel_by_key, key4_1.as_u64);
-		  if (PREDICT_TRUE (p1 != NULL))
-		    {
-		      mt1 = pool_elt_at_index (vxm->tunnels, p1[0]);
-		      goto next1;	/* valid packet */
-		    }
-		}
 	      error1 = GENEVE_ERROR_NO_SUCH_TUNNEL;
 	      next1 = GENEVE_INPUT_NEXT_DROP;
 	      goto trace1;
-
 	    }
-	  else			/* !is_ip4 */
-	    {
-	      key6_1.remote.as_u64[0] = ip6_1->src_address.as_u64[0];
-	      key6_1.remote.as_u64[1] = ip6_1->src_address.as_u64[1];
-	      key6_1.vni = vnet_get_geneve_vni_bigendian (geneve1);
+	  t1 = pool_elt_at_index (vxm->tunnels, tunnel_index1);
 
-	      /* Make sure GENEVE tunnel exist according to packet SIP and VNI */
-	      if (PREDICT_FALSE
-		  (memcmp (&key6_1, &last_key6, sizeof (last_key6)) != 0))
-		{
-		  p1 = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6_1);
-
-		  if (PREDICT_FALSE (p1 == NULL))
-		    {
-		      error1 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		      next1 = GENEVE_INPUT_NEXT_DROP;
-		      goto trace1;
-		    }
-
-		  clib_memcpy (&last_key6, &key6_1, sizeof (key6_1));
-		  tunnel_index1 = last_tunnel_index = p1[0];
-		}
-	      else
-		tunnel_index1 = last_tunnel_index;
-	      t1 = pool_elt_at_index (vxm->tunnels, tunnel_index1);
-
-	      /* Validate GENEVE tunnel encap-fib index agaist packet */
-	      if (PREDICT_FALSE (validate_geneve_fib (b1, t1, is_ip4) == 0))
-		{
-		  error1 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		  next1 = GENEVE_INPUT_NEXT_DROP;
-		  goto trace1;
-		}
-
-	      /* Validate GENEVE tunnel SIP against packet DIP */
-	      if (PREDICT_TRUE (ip6_address_is_equal (&ip6_1->dst_address,
-						      &t1->local.ip6)))
-		goto next1;	/* valid packet */
-	      if (PREDICT_FALSE
-		  (ip6_address_is_multicast (&ip6_1->dst_address)))
-		{
-		  key6_1.remote.as_u64[0] = ip6_1->dst_address.as_u64[0];
-		  key6_1.remote.as_u64[1] = ip6_1->dst_address.as_u64[1];
-		  key6_1.vni = vnet_get_geneve_vni_bigendian (geneve1);
-		  p1 = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6_1);
-		  if (PREDICT_TRUE (p1 != NULL))
-		    {
-		      mt1 = pool_elt_at_index (vxm->tunnels, p1[0]);
-		      goto next1;	/* valid packet */
-		    }
-		}
-	      error1 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-	      next1 = GENEVE_INPUT_NEXT_DROP;
-	      goto trace1;
-	    }
-
-	next1:
 	  next1 = t1->decap_next_index;
 	  sw_if_index1 = t1->sw_if_index;
 	  len1 = vlib_buffer_length_in_chain (vm, b1);
@@ -551,17 +444,17 @@ geneve_input (vlib_main_t * vm,
 	  ip4_header_t *ip4_0;
 	  ip6_header_t *ip6_0;
 	  geneve_header_t *geneve0;
-	  uword *p0;
+	  udp_tunnel_demux_key_t *k0;
 	  u32 tunnel_index0;
 	  geneve_tunnel_t *t0, *mt0 = NULL;
-	  geneve4_tunnel_key_t key4_0;
-	  geneve6_tunnel_key_t key6_0;
 	  u32 error0;
 	  u32 sw_if_index0, len0;
 
 	  bi0 = from[0];
+	  k0 = &k[0];
 	  to_next[0] = bi0;
 	  from += 1;
+	  k += 1;
 	  to_next += 1;
 	  n_left_from -= 1;
 	  n_left_to_next -= 1;
@@ -621,113 +514,17 @@ geneve_input (vlib_main_t * vm,
 	      goto trace00;
 	    }
 #endif
-	  if (is_ip4)
-	    {
-	      key4_0.remote = ip4_0->src_address.as_u32;
-	      key4_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-
-	      /* Make sure unicast GENEVE tunnel exist by packet SIP and VNI */
-	      if (PREDICT_FALSE (key4_0.as_u64 != last_key4.as_u64))
-		{
-		  p0 = hash_get (vxm->geneve4_tunnel_by_key, key4_0.as_u64);
-		  if (PREDICT_FALSE (p0 == NULL))
-		    {
-		      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		      next0 = GENEVE_INPUT_NEXT_DROP;
-		      goto trace00;
-		    }
-		  last_key4.as_u64 = key4_0.as_u64;
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
-	      t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
-
-	      /* Validate GENEVE tunnel encap-fib index agaist packet */
-	      if (PREDICT_FALSE (validate_geneve_fib (b0, t0, is_ip4) == 0))
-		{
-		  error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		  next0 = GENEVE_INPUT_NEXT_DROP;
-		  goto trace00;
-		}
-
-	      /* Validate GENEVE tunnel SIP against packet DIP */
-	      if (PREDICT_TRUE
-		  (ip4_0->dst_address.as_u32 == t0->local.ip4.as_u32))
-		goto next00;	/* valid packet */
-	      if (PREDICT_FALSE
-		  (ip4_address_is_multicast (&ip4_0->dst_address)))
-		{
-		  key4_0.remote = ip4_0->dst_address.as_u32;
-		  key4_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-		  /* Make sure mcast GENEVE tunnel exist by packet DIP and VNI */
-		  p0 = hash_get (vxm->geneve4_tunnel_by_key, key4_0.as_u64);
-		  if (PREDICT_TRUE (p0 != NULL))
-		    {
-		      mt0 = pool_elt_at_index (vxm->tunnels, p0[0]);
-		      goto next00;	/* valid packet */
-		    }
-		}
-	      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-	      next0 = GENEVE_INPUT_NEXT_DROP;
-	      goto trace00;
-
-	    }
-	  else			/* !is_ip4 */
+	  tunnel_index0 = geneve_find_tunnel (vxm, k0,
+					       is_ip4 ? (void *) ip4_0 :
+					       (void *) ip6_0, is_ip4, &mt0);
+	  if (PREDICT_FALSE (tunnel_index0 == ~0))
 	    {
-	      key6_0.remote.as_u64[0] = ip6_0->src_address.as_u64[0];
-	      key6_0.remote.as_u64[1] = ip6_0->src_address.as_u64[1];
-	      key6_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-
-	      /* Make sure GENEVE tunnel exist according to packet SIP and VNI */
-	      if (PREDICT_FALSE
-		  (memcmp (&key6_0, &last_key6, sizeof (last_key6)) != 0))
-		{
-		  p0 = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6_0);
-		  if (PREDICT_FALSE (p0 == NULL))
-		    {
-		      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		      next0 = GENEVE_INPUT_NEXT_DROP;
-		      goto trace00;
-		    }
-		  clib_memcpy (&last_key6, &key6_0, sizeof (key6_0));
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
-	      t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
-
-	      /* Validate GENEVE tunnel encap-fib index agaist packet */
-	      if (PREDICT_FALSE (validate_geneve_fib (b0, t0, is_ip4) == 0))
-		{
-		  error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
-		  next0 = GENEVE_INPUT_NEXT_DROP;
-		  goto trace00;
-		}
-
-	      /* Validate GENEVE tunnel SIP against packet DIP */
-	      if (PREDICT_TRUE (ip6_address_is_equal (&ip6_0->dst_address,
-						      &t0->local.ip6)))
-		goto next00;	/* valid packet */
-	      if (PREDICT_FALSE
-		  (ip6_address_is_multicast (&ip6_0->dst_address)))
-		{
-		  key6_0.remote.as_u64[0] = ip6_0->dst_address.as_u64[0];
-		  key6_0.remote.as_u64[1] = ip6_0->dst_address.as_u64[1];
-		  key6_0.vni = vnet_get_geneve_vni_bigendian (geneve0);
-		  p0 = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6_0);
-		  if (PREDICT_TRUE (p0 != NULL))
-		    {
-		      mt0 = pool_elt_at_index (vxm->tunnels, p0[0]);
-		      goto next00;	/* valid packet */
-		    }
-		}
 	      error0 = GENEVE_ERROR_NO_SUCH_TUNNEL;
 	      next0 = GENEVE_INPUT_NEXT_DROP;
 	      goto trace00;
 	    }
+	  t0 = pool_elt_at_index (vxm->tunnels, tunnel_index0);
 
-	next00:
 	  next0 = t0->decap_next_index;
 	  sw_if_index0 = t0->sw_if_index;
 	  len0 = vlib_buffer_length_in_chain (vm, b0);
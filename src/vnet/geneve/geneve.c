@@ -357,35 +357,23 @@ int vnet_geneve_add_del_tunnel
   geneve_main_t *vxm = &geneve_main;
   geneve_tunnel_t *t = 0;
   vnet_main_t *vnm = vxm->vnet_main;
-  uword *p;
   u32 hw_if_index = ~0;
   u32 sw_if_index = ~0;
   int rv;
-  geneve4_tunnel_key_t key4;
-  geneve6_tunnel_key_t key6;
+  u32 tunnel_index;
   u32 is_ip6 = a->is_ip6;
+  u32 vni =
+    clib_host_to_net_u32 ((a->vni << GENEVE_VNI_SHIFT) & GENEVE_VNI_MASK);
 
-  if (!is_ip6)
-    {
-      key4.remote = a->remote.ip4.as_u32;
-      key4.vni =
-	clib_host_to_net_u32 ((a->vni << GENEVE_VNI_SHIFT) & GENEVE_VNI_MASK);
-      p = hash_get (vxm->geneve4_tunnel_by_key, key4.as_u64);
-    }
-  else
-    {
-      key6.remote = a->remote.ip6;
-      key6.vni =
-	clib_host_to_net_u32 ((a->vni << GENEVE_VNI_SHIFT) & GENEVE_VNI_MASK);
-      p = hash_get_mem (vxm->geneve6_tunnel_by_key, &key6);
-    }
+  tunnel_index = udp_tunnel_demux_find (&vxm->tunnel_demux, &a->remote,
+					a->encap_fib_index, vni, is_ip6);
 
   if (a->is_add)
     {
       l2input_main_t *l2im = &l2input_main;
 
       /* adding a tunnel: tunnel must not already exist */
-      if (p)
+      if (tunnel_index != ~0)
 	return VNET_API_ERROR_TUNNEL_EXIST;
 
       /*if not set explicitly, default to l2 */
@@ -409,12 +397,16 @@ int vnet_geneve_add_del_tunnel
 	  return rv;
 	}
 
-      /* copy the key */
-      if (is_ip6)
-	hash_set_mem_alloc (&vxm->geneve6_tunnel_by_key, &key6,
-			    t - vxm->tunnels);
-      else
-	hash_set (vxm->geneve4_tunnel_by_key, key4.as_u64, t - vxm->tunnels);
+      /* copy the key; no interface exists yet, so on failure only the
+       * pool entry and its rewrite need to be undone */
+      if (udp_tunnel_demux_add_del (&vxm->tunnel_demux, &t->remote,
+				    t->encap_fib_index, vni, is_ip6,
+				    t - vxm->tunnels, 1 /* is_add */ ))
+	{
+	  vec_free (t->rewrite);
+	  pool_put (vxm->tunnels, t);
+	  return VNET_API_ERROR_INVALID_REGISTRATION;
+	}
 
       vnet_hw_interface_t *hi;
       if (vec_len (vxm->free_geneve_tunnel_hw_if_indices) > 0)
@@ -570,10 +562,10 @@ int vnet_geneve_add_del_tunnel
   else
     {
       /* deleting a tunnel: tunnel must exist */
-      if (!p)
+      if (tunnel_index == ~0)
 	return VNET_API_ERROR_NO_SUCH_ENTRY;
 
-      t = pool_elt_at_index (vxm->tunnels, p[0]);
+      t = pool_elt_at_index (vxm->tunnels, tunnel_index);
 
       sw_if_index = t->sw_if_index;
       vnet_sw_interface_set_flags (vnm, t->sw_if_index, 0 /* down */ );
@@ -587,10 +579,9 @@ int vnet_geneve_add_del_tunnel
 
       vxm->tunnel_index_by_sw_if_index[t->sw_if_index] = ~0;
 
-      if (!is_ip6)
-	hash_unset (vxm->geneve4_tunnel_by_key, key4.as_u64);
-      else
-	hash_unset_mem_free (&vxm->geneve6_tunnel_by_key, &key6);
+      udp_tunnel_demux_add_del (&vxm->tunnel_demux, &t->remote,
+				t->encap_fib_index, vni, is_ip6,
+				t - vxm->tunnels, 0 /* is_add */ );
 
       if (!ip46_address_is_multicast (&t->remote))
 	{
@@ -1094,10 +1085,9 @@ geneve_init (vlib_main_t * vm)
   vxm->vnet_main = vnet_get_main ();
   vxm->vlib_main = vm;
 
+  udp_tunnel_demux_init (&vxm->tunnel_demux, "geneve");
+
   /* initialize the ip6 hash */
-  vxm->geneve6_tunnel_by_key = hash_create_mem (0,
-						sizeof (geneve6_tunnel_key_t),
-						sizeof (uword));
   vxm->vtep6 = hash_create_mem (0, sizeof (ip6_address_t), sizeof (uword));
   vxm->mcast_shared = hash_create_mem (0,
 				       sizeof (ip46_address_t),
@@ -27,6 +27,7 @@
 #include <vnet/ip/ip4_packet.h>
 #include <vnet/ip/ip6_packet.h>
 #include <vnet/udp/udp.h>
+#include <vnet/udp/udp_tunnel_demux.h>
 #include <vnet/dpo/dpo.h>
 #include <vnet/adj/adj_types.h>
 
@@ -46,33 +47,6 @@ typedef CLIB_PACKED (struct
 		     geneve_header_t geneve;	/* Min 8 bytes, Max 260 bytes */
 		     }) ip6_geneve_header_t;
 
-typedef CLIB_PACKED (struct
-		     {
-		     /*
-		      * Key fields: ip source and geneve vni on incoming GENEVE packet
-		      * all fields in NET byte order
-		      */
-		     union
-		     {
-		     struct
-		     {
-		     u32 remote;
-		     u32 vni;	/* shifted left 8 bits */
-		     };
-		     u64 as_u64;
-		     };
-		     }) geneve4_tunnel_key_t;
-
-typedef CLIB_PACKED (struct
-		     {
-		     /*
-		      * Key fields: ip source and geneve vni on incoming GENEVE packet
-		      * all fields in NET byte order
-		      */
-		     ip6_address_t remote;
-		     u32 vni;	/* shifted left 8 bits */
-		     }) geneve6_tunnel_key_t;
-
 typedef struct
 {
   /* Required for pool_get_aligned */
@@ -155,9 +129,8 @@ typedef struct
   /* vector of encap tunnel instances */
   geneve_tunnel_t *tunnels;
 
-  /* lookup tunnel by key */
-  uword *geneve4_tunnel_by_key;	/* keyed on ipv4.remote + vni */
-  uword *geneve6_tunnel_by_key;	/* keyed on ipv6.remote + vni */
+  /* lookup tunnel by key: ip46.remote + encap fib + vni */
+  udp_tunnel_demux_t tunnel_demux;
 
   /* local VTEP IPs ref count used by geneve-bypass node to check if
      received GENEVE packet DIP matches any local VTEP address */
@@ -0,0 +1,733 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/hqos/hqos.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/feature/feature.h>
+#include <vlib/threads.h>
+
+hqos_main_t hqos_main;
+
+static hqos_config_t *
+hqos_config_get (u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+
+  if (sw_if_index >= vec_len (hm->config_index_by_sw_if_index) ||
+      hm->config_index_by_sw_if_index[sw_if_index] == ~0)
+    return 0;
+
+  return pool_elt_at_index (hm->configs,
+			    hm->config_index_by_sw_if_index[sw_if_index]);
+}
+
+static hqos_sched_t *
+hqos_config_sched (hqos_config_t * c, u32 thread_index)
+{
+  hqos_per_thread_t *ptd = vec_elt_at_index (hqos_main.per_thread,
+					     thread_index);
+
+  return pool_elt_at_index (ptd->scheds, c->sched_index_by_thread
+			    [thread_index]);
+}
+
+/**
+ * Load a configuration into a thread's scheduler. Shapers start full.
+ */
+static void
+hqos_sched_update (hqos_config_t * c, hqos_sched_t * s, f64 now)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_pipe_params_t *pp;
+  hqos_pipe_t *p;
+  u32 i;
+
+  s->queue_size = c->queue_size;
+  hqos_tb_init (&s->tb, &c->port, hm->n_shaping_threads, now);
+
+  for (i = 0; i < c->n_subports; i++)
+    hqos_tb_init (&s->subports[i].tb, &c->subports[i],
+		  hm->n_shaping_threads, now);
+
+  for (i = 0; i < vec_len (s->pipes); i++)
+    {
+      p = &s->pipes[i];
+      pp = &c->pipes[i];
+      hqos_tb_init (&p->tb, &pp->shaper, 1, now);
+      clib_memcpy (p->weights, pp->weights, sizeof (p->weights));
+    }
+}
+
+static void
+hqos_config_update (hqos_config_t * c)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u32 thread_index;
+
+  for (thread_index = hqos_main.first_sched_thread;
+       thread_index < vec_len (c->sched_index_by_thread); thread_index++)
+    hqos_sched_update (c, hqos_config_sched (c, thread_index),
+		       vlib_time_now (vm));
+}
+
+static void
+hqos_sched_create (hqos_config_t * c, u32 thread_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = hm->vnet_main;
+  vlib_main_t *vm = vlib_mains[thread_index];
+  hqos_per_thread_t *ptd = vec_elt_at_index (hm->per_thread, thread_index);
+  vnet_hw_interface_t *hi;
+  hqos_sched_t *s;
+
+  pool_get_aligned (ptd->scheds, s, CLIB_CACHE_LINE_BYTES);
+  memset (s, 0, sizeof (*s));
+
+  hi = vnet_get_sup_hw_interface (vnm, c->sw_if_index);
+  s->sw_if_index = c->sw_if_index;
+  s->tx_node_index = hi->tx_node_index;
+  s->n_pipes_per_subport = c->n_pipes_per_subport;
+  vec_validate (s->subports, c->n_subports - 1);
+  vec_validate (s->pipes, c->n_subports * c->n_pipes_per_subport - 1);
+
+  tw_timer_wheel_init_2t_1w_2048sl (&s->timer_wheel, 0 /* no callback */ ,
+				    HQOS_TIMER_TICK, ~0);
+  s->timer_wheel.last_run_time = vlib_time_now (vm);
+
+  hqos_sched_update (c, s, vlib_time_now (vm));
+
+  vec_validate_init_empty (ptd->sched_index_by_sw_if_index, c->sw_if_index,
+			   ~0);
+  ptd->sched_index_by_sw_if_index[c->sw_if_index] = s - ptd->scheds;
+  vec_validate_init_empty (c->sched_index_by_thread, thread_index, ~0);
+  c->sched_index_by_thread[thread_index] = s - ptd->scheds;
+
+  if (ptd->n_active_scheds++ == 0)
+    vlib_node_set_state (vm, hqos_dequeue_node.index,
+			 VLIB_NODE_STATE_POLLING);
+}
+
+void
+hqos_sched_free_buffers (vlib_main_t * vm, hqos_sched_t * s)
+{
+  u32 *buffers = 0, *bi;
+  hqos_pipe_t *p;
+  u32 i;
+
+  vec_foreach (p, s->pipes)
+  {
+    for (i = 0; i < HQOS_N_QUEUES; i++)
+      {
+	/* *INDENT-OFF* */
+	clib_fifo_foreach (bi, p->queues[i],
+	({
+	  vec_add1 (buffers, bi[0]);
+	}));
+	/* *INDENT-ON* */
+	clib_fifo_reset (p->queues[i]);
+      }
+    memset (p->tc_n_buffers, 0, sizeof (p->tc_n_buffers));
+    p->n_buffers = 0;
+  }
+
+  if (vec_len (buffers))
+    vlib_buffer_free (vm, buffers, vec_len (buffers));
+  vec_free (buffers);
+  s->n_buffers = 0;
+}
+
+static void
+hqos_sched_delete (hqos_config_t * c, u32 thread_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  vlib_main_t *vm = vlib_mains[thread_index];
+  hqos_per_thread_t *ptd = vec_elt_at_index (hm->per_thread, thread_index);
+  hqos_sched_t *s = hqos_config_sched (c, thread_index);
+  hqos_subport_t *sp;
+  hqos_pipe_t *p;
+  u32 i;
+
+  hqos_sched_free_buffers (vm, s);
+
+  vec_foreach (p, s->pipes)
+  {
+    for (i = 0; i < HQOS_N_QUEUES; i++)
+      clib_fifo_free (p->queues[i]);
+  }
+  vec_foreach (sp, s->subports) clib_fifo_free (sp->active_pipes);
+  vec_free (s->pipes);
+  vec_free (s->subports);
+  clib_fifo_free (s->active_subports);
+  tw_timer_wheel_free_2t_1w_2048sl (&s->timer_wheel);
+  vec_free (s->expired_timers);
+
+  ptd->sched_index_by_sw_if_index[c->sw_if_index] = ~0;
+  pool_put (ptd->scheds, s);
+
+  if (--ptd->n_active_scheds == 0)
+    vlib_node_set_state (vm, hqos_dequeue_node.index,
+			 VLIB_NODE_STATE_DISABLED);
+}
+
+/**
+ * Default traffic class and queue of a DSCP: the higher the class
+ * selector the higher the priority, and the drop precedence bits pick
+ * the queue.
+ */
+static void
+hqos_config_default_dscp_map (hqos_config_t * c)
+{
+  u32 dscp;
+
+  for (dscp = 0; dscp < ARRAY_LEN (c->queue_by_dscp); dscp++)
+    c->queue_by_dscp[dscp] = (HQOS_N_TC - 1 - (dscp >> 4)) *
+      HQOS_N_QUEUES_PER_TC + ((dscp >> 2) & (HQOS_N_QUEUES_PER_TC - 1));
+}
+
+clib_error_t *
+hqos_port_delete (u32 sw_if_index)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_config_t *c;
+  u32 thread_index;
+
+  if (!(c = hqos_config_get (sw_if_index)))
+    return clib_error_return (0, "hqos not enabled on interface");
+
+  vnet_feature_enable_disable ("interface-output", "hqos-enqueue",
+			       sw_if_index, 0, 0, 0);
+
+  for (thread_index = hm->first_sched_thread;
+       thread_index < vec_len (c->sched_index_by_thread); thread_index++)
+    hqos_sched_delete (c, thread_index);
+
+  vec_free (c->sched_index_by_thread);
+  vec_free (c->subports);
+  vec_free (c->pipes);
+  hm->config_index_by_sw_if_index[sw_if_index] = ~0;
+  pool_put (hm->configs, c);
+
+  return 0;
+}
+
+clib_error_t *
+hqos_port_config (u32 sw_if_index, u64 rate, u32 burst, u32 n_subports,
+		  u32 n_pipes, u32 queue_size)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_hw_interface_t *hi;
+  hqos_config_t *c;
+  u32 thread_index, i, j;
+  clib_error_t *error;
+
+  if (n_subports == 0 || n_pipes == 0 || queue_size == 0)
+    return clib_error_return (0, "subports, pipes and queue size must be "
+			      "non-zero");
+  if ((u64) n_subports * n_pipes > HQOS_MAX_N_PIPES)
+    return clib_error_return (0, "at most %d pipes per port",
+			      HQOS_MAX_N_PIPES);
+
+  if ((c = hqos_config_get (sw_if_index)))
+    {
+      /* a change of shape starts over, dropping the queued packets */
+      if (c->n_subports != n_subports || c->n_pipes_per_subport != n_pipes)
+	{
+	  if ((error = hqos_port_delete (sw_if_index)))
+	    return error;
+	  c = 0;
+	}
+    }
+
+  if (!c)
+    {
+      pool_get (hm->configs, c);
+      memset (c, 0, sizeof (*c));
+      hi = vnet_get_sup_hw_interface (hm->vnet_main, sw_if_index);
+      c->sw_if_index = sw_if_index;
+      c->is_ethernet = hi->hw_class_index == ethernet_hw_interface_class.index;
+      c->n_subports = n_subports;
+      c->n_pipes_per_subport = n_pipes;
+      vec_validate (c->subports, n_subports - 1);
+      vec_validate (c->pipes, n_subports * n_pipes - 1);
+      for (i = 0; i < vec_len (c->pipes); i++)
+	for (j = 0; j < HQOS_N_QUEUES_PER_TC; j++)
+	  c->pipes[i].weights[j] = 1;
+      hqos_config_default_dscp_map (c);
+
+      vec_validate_init_empty (hm->config_index_by_sw_if_index, sw_if_index,
+			       ~0);
+      hm->config_index_by_sw_if_index[sw_if_index] = c - hm->configs;
+
+      c->port.rate = rate;
+      c->port.burst = burst;
+      c->queue_size = queue_size;
+
+      for (thread_index = hm->first_sched_thread;
+	   thread_index < vec_len (vlib_mains); thread_index++)
+	hqos_sched_create (c, thread_index);
+
+      vnet_feature_enable_disable ("interface-output", "hqos-enqueue",
+				   sw_if_index, 1, 0, 0);
+      return 0;
+    }
+
+  c->port.rate = rate;
+  c->port.burst = burst;
+  c->queue_size = queue_size;
+  hqos_config_update (c);
+
+  return 0;
+}
+
+clib_error_t *
+hqos_subport_config (u32 sw_if_index, u32 subport, u64 rate, u32 burst)
+{
+  hqos_config_t *c;
+
+  if (!(c = hqos_config_get (sw_if_index)))
+    return clib_error_return (0, "hqos not enabled on interface");
+  if (subport >= c->n_subports)
+    return clib_error_return (0, "subport %d out of range", subport);
+
+  c->subports[subport].rate = rate;
+  c->subports[subport].burst = burst;
+  hqos_config_update (c);
+
+  return 0;
+}
+
+clib_error_t *
+hqos_pipe_config (u32 sw_if_index, u32 subport, u32 pipe, u64 rate,
+		  u32 burst, u8 * weights)
+{
+  hqos_pipe_params_t *pp;
+  hqos_config_t *c;
+  u32 i;
+
+  if (!(c = hqos_config_get (sw_if_index)))
+    return clib_error_return (0, "hqos not enabled on interface");
+  if (subport >= c->n_subports)
+    return clib_error_return (0, "subport %d out of range", subport);
+  if (pipe >= c->n_pipes_per_subport)
+    return clib_error_return (0, "pipe %d out of range", pipe);
+
+  pp = &c->pipes[subport * c->n_pipes_per_subport + pipe];
+  pp->shaper.rate = rate;
+  pp->shaper.burst = burst;
+  if (weights)
+    for (i = 0; i < HQOS_N_QUEUES_PER_TC; i++)
+      pp->weights[i] = clib_max (weights[i], 1);
+  hqos_config_update (c);
+
+  return 0;
+}
+
+static u8 *
+format_hqos_shaper (u8 * s, va_list * args)
+{
+  hqos_shaper_params_t *p = va_arg (*args, hqos_shaper_params_t *);
+
+  if (p->rate == 0)
+    return format (s, "unshaped");
+  return format (s, "rate %llu bytes/s burst %u", p->rate, p->burst);
+}
+
+static u8 *
+format_hqos_sched (u8 * s, va_list * args)
+{
+  hqos_sched_t *sc = va_arg (*args, hqos_sched_t *);
+  int verbose = va_arg (*args, int);
+  hqos_subport_t *sp;
+  hqos_pipe_t *p;
+  u32 i;
+
+  s = format (s, "queued %u drops %llu active subports %u",
+	      sc->n_buffers, sc->n_drops, clib_fifo_elts (sc->active_subports));
+  if (!verbose)
+    return s;
+
+  vec_foreach (sp, sc->subports)
+  {
+    s = format (s, "\n    subport %d: tx packets %llu bytes %llu, "
+		"active pipes %u", sp - sc->subports, sp->n_tx_packets,
+		sp->n_tx_bytes, clib_fifo_elts (sp->active_pipes));
+  }
+  vec_foreach (p, sc->pipes)
+  {
+    if (p->n_buffers == 0 && p->n_tx_packets == 0 && p->n_drops == 0)
+      continue;
+    i = p - sc->pipes;
+    s = format (s, "\n    pipe %d/%d: queued %u tx packets %llu bytes %llu "
+		"drops %llu%s", i / sc->n_pipes_per_subport,
+		i % sc->n_pipes_per_subport, p->n_buffers, p->n_tx_packets,
+		p->n_tx_bytes, p->n_drops,
+		p->state == HQOS_STATE_WAIT ? " waiting" : "");
+  }
+
+  return s;
+}
+
+static uword
+unformat_hqos_shaper (unformat_input_t * input, va_list * args)
+{
+  hqos_shaper_params_t *p = va_arg (*args, hqos_shaper_params_t *);
+
+  if (unformat (input, "rate %llu", &p->rate))
+    return 1;
+  if (unformat (input, "burst %u", &p->burst))
+    return 1;
+  return 0;
+}
+
+static clib_error_t *
+hqos_port_command_fn (vlib_main_t * vm, unformat_input_t * input,
+		      vlib_cli_command_t * cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, n_subports, n_pipes, queue_size;
+  hqos_shaper_params_t port = { 0 };
+  hqos_config_t *c;
+  int is_del = 0;
+
+  n_subports = HQOS_DEFAULT_N_SUBPORTS;
+  n_pipes = HQOS_DEFAULT_N_PIPES;
+  queue_size = HQOS_DEFAULT_QUEUE_SIZE;
+
+  if (unformat (input, "%U", unformat_vnet_sw_interface, vnm, &sw_if_index))
+    {
+      /* a reconfiguration starts from the current values */
+      if ((c = hqos_config_get (sw_if_index)))
+	{
+	  port = c->port;
+	  n_subports = c->n_subports;
+	  n_pipes = c->n_pipes_per_subport;
+	  queue_size = c->queue_size;
+	}
+    }
+  else
+    return clib_error_return (0, "interface required");
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%U", unformat_hqos_shaper, &port))
+	;
+      else if (unformat (input, "subports %u", &n_subports))
+	;
+      else if (unformat (input, "pipes %u", &n_pipes))
+	;
+      else if (unformat (input, "queue-size %u", &queue_size))
+	;
+      else if (unformat (input, "del"))
+	is_del = 1;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (is_del)
+    return hqos_port_delete (sw_if_index);
+
+  return hqos_port_config (sw_if_index, port.rate, port.burst, n_subports,
+			   n_pipes, queue_size);
+}
+
+/*?
+ * Enable the hierarchical QoS scheduler on an interface, or change its
+ * port rate or shape. Rates are in bytes per second, 0 is unshaped.
+ * Changing the number of subports or pipes drops the queued packets.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos port GigabitEthernet0/8/0 rate 125000000 subports 4 pipes 256}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_port_command, static) = {
+  .path = "hqos port",
+  .short_help = "hqos port <interface> [rate <bytes/s>] [burst <bytes>] "
+    "[subports <n>] [pipes <n>] [queue-size <n>] [del]",
+  .function = hqos_port_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_subport_command_fn (vlib_main_t * vm, unformat_input_t * input,
+			 vlib_cli_command_t * cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  hqos_shaper_params_t sp = { 0 };
+  u32 sw_if_index = ~0, subport = 0;
+
+  if (!unformat (input, "%U", unformat_vnet_sw_interface, vnm, &sw_if_index))
+    return clib_error_return (0, "interface required");
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "subport %u", &subport))
+	;
+      else if (unformat (input, "%U", unformat_hqos_shaper, &sp))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  return hqos_subport_config (sw_if_index, subport, sp.rate, sp.burst);
+}
+
+/*?
+ * Shape a subport, the rate is in bytes per second.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos subport GigabitEthernet0/8/0 subport 1 rate 12500000}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_subport_command, static) = {
+  .path = "hqos subport",
+  .short_help = "hqos subport <interface> subport <n> [rate <bytes/s>] "
+    "[burst <bytes>]",
+  .function = hqos_subport_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_pipe_command_fn (vlib_main_t * vm, unformat_input_t * input,
+		      vlib_cli_command_t * cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  hqos_shaper_params_t sp = { 0 };
+  u32 sw_if_index = ~0, subport = 0, pipe = 0;
+  u32 w[HQOS_N_QUEUES_PER_TC];
+  u8 weights[HQOS_N_QUEUES_PER_TC], *wp = 0;
+  u32 i;
+
+  if (!unformat (input, "%U", unformat_vnet_sw_interface, vnm, &sw_if_index))
+    return clib_error_return (0, "interface required");
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "subport %u", &subport))
+	;
+      else if (unformat (input, "pipe %u", &pipe))
+	;
+      else if (unformat (input, "%U", unformat_hqos_shaper, &sp))
+	;
+      else if (unformat (input, "weights %u %u %u %u",
+			 &w[0], &w[1], &w[2], &w[3]))
+	{
+	  for (i = 0; i < HQOS_N_QUEUES_PER_TC; i++)
+	    {
+	      if (w[i] > 255)
+		return clib_error_return (0, "weights are at most 255");
+	      weights[i] = w[i];
+	    }
+	  wp = weights;
+	}
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  return hqos_pipe_config (sw_if_index, subport, pipe, sp.rate, sp.burst,
+			   wp);
+}
+
+/*?
+ * Shape a pipe and set the weights of the queues within each of its
+ * traffic classes.
+ *
+ * @cliexpar
+ * @cliexcmd{hqos pipe GigabitEthernet0/8/0 subport 1 pipe 7 rate 1250000 weights 4 2 1 1}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_pipe_command, static) = {
+  .path = "hqos pipe",
+  .short_help = "hqos pipe <interface> subport <n> pipe <n> "
+    "[rate <bytes/s>] [burst <bytes>] [weights <w0> <w1> <w2> <w3>]",
+  .function = hqos_pipe_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+hqos_classify_command_fn (vlib_main_t * vm, unformat_input_t * input,
+			  vlib_cli_command_t * cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0, offset, dscp, tc, queue;
+  hqos_field_t *f = 0;
+  hqos_config_t *c;
+  u64 mask;
+
+  if (!unformat (input, "%U", unformat_vnet_sw_interface, vnm, &sw_if_index))
+    return clib_error_return (0, "interface required");
+  if (!(c = hqos_config_get (sw_if_index)))
+    return clib_error_return (0, "hqos not enabled on interface");
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "subport offset %u mask %llx", &offset, &mask))
+	f = &c->subport_field;
+      else if (unformat (input, "pipe offset %u mask %llx", &offset, &mask))
+	f = &c->pipe_field;
+      else if (unformat (input, "dscp %u tc %u queue %u", &dscp, &tc, &queue))
+	{
+	  if (dscp >= ARRAY_LEN (c->queue_by_dscp) || tc >= HQOS_N_TC ||
+	      queue >= HQOS_N_QUEUES_PER_TC)
+	    return clib_error_return (0, "dscp, tc or queue out of range");
+	  c->queue_by_dscp[dscp] = tc * HQOS_N_QUEUES_PER_TC + queue;
+	  continue;
+	}
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+
+      f->offset = offset;
+      f->mask = mask;
+      f->shift = mask ? count_trailing_zeros (mask) : 0;
+    }
+
+  return 0;
+}
+
+/*?
+ * Choose how packets are classified. The subport and the pipe are taken
+ * from the masked big-endian 64 bit word at an offset into the packet,
+ * modulo their number; the traffic class and queue are mapped from the
+ * DSCP.
+ *
+ * @cliexpar
+ * Subport from the outer VLAN id, pipe from the low byte of the IPv4
+ * destination address:
+ * @cliexcmd{hqos classify GigabitEthernet0/8/0 subport offset 12 mask 00000fff00000000}
+ * @cliexcmd{hqos classify GigabitEthernet0/8/0 pipe offset 30 mask 00000000000000ff}
+ * @cliexcmd{hqos classify GigabitEthernet0/8/0 dscp 46 tc 0 queue 0}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (hqos_classify_command, static) = {
+  .path = "hqos classify",
+  .short_help = "hqos classify <interface> "
+    "[subport offset <n> mask <hex>] [pipe offset <n> mask <hex>] "
+    "[dscp <n> tc <n> queue <n>]",
+  .function = hqos_classify_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+show_hqos_command_fn (vlib_main_t * vm, unformat_input_t * input,
+		      vlib_cli_command_t * cmd)
+{
+  hqos_main_t *hm = &hqos_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  hqos_shaper_params_t *sp;
+  hqos_pipe_params_t *pp;
+  hqos_config_t *c;
+  int verbose = 0;
+  u32 thread_index, i;
+
+  if (unformat (input, "verbose"))
+    verbose = 1;
+
+  /* *INDENT-OFF* */
+  pool_foreach (c, hm->configs,
+  ({
+    vlib_cli_output (vm, "%U: port %U, %u subports of %u pipes, "
+		     "queue size %u",
+		     format_vnet_sw_if_index_name, vnm, c->sw_if_index,
+		     format_hqos_shaper, &c->port, c->n_subports,
+		     c->n_pipes_per_subport, c->queue_size);
+    vlib_cli_output (vm, "  subport field offset %u mask 0x%llx, "
+		     "pipe field offset %u mask 0x%llx",
+		     c->subport_field.offset, c->subport_field.mask,
+		     c->pipe_field.offset, c->pipe_field.mask);
+    if (verbose)
+      {
+	vec_foreach (sp, c->subports)
+	  if (sp->rate)
+	    vlib_cli_output (vm, "  subport %d: %U", sp - c->subports,
+			     format_hqos_shaper, sp);
+	vec_foreach (pp, c->pipes)
+	  if (pp->shaper.rate)
+	    {
+	      i = pp - c->pipes;
+	      vlib_cli_output (vm, "  pipe %d/%d: %U weights %d %d %d %d",
+			       i / c->n_pipes_per_subport,
+			       i % c->n_pipes_per_subport,
+			       format_hqos_shaper, &pp->shaper,
+			       pp->weights[0], pp->weights[1],
+			       pp->weights[2], pp->weights[3]);
+	    }
+      }
+    for (thread_index = hm->first_sched_thread;
+	 thread_index < vec_len (c->sched_index_by_thread); thread_index++)
+      vlib_cli_output (vm, "  thread %d: %U", thread_index,
+		       format_hqos_sched,
+		       hqos_config_sched (c, thread_index), verbose);
+  }));
+  /* *INDENT-ON* */
+
+  return 0;
+}
+
+/*?
+ * Show the hierarchical QoS schedulers and their per-thread state
+ *
+ * @cliexpar
+ * @cliexcmd{show hqos verbose}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_hqos_command, static) = {
+  .path = "show hqos",
+  .short_help = "show hqos [verbose]",
+  .function = show_hqos_command_fn,
+};
+/* *INDENT-ON* */
+
+/**
+ * An interface being deleted takes its port along, the schedulers free
+ * the packets still queued on it.
+ */
+static clib_error_t *
+hqos_interface_add_del (vnet_main_t * vnm, u32 sw_if_index, u32 is_add)
+{
+  if (!is_add && hqos_config_get (sw_if_index))
+    return hqos_port_delete (sw_if_index);
+  return 0;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (hqos_interface_add_del);
+
+static clib_error_t *
+hqos_init (vlib_main_t * vm)
+{
+  hqos_main_t *hm = &hqos_main;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+
+  hm->vlib_main = vm;
+  hm->vnet_main = vnet_get_main ();
+  hm->n_shaping_threads = clib_max (tm->n_vlib_mains - 1, 1);
+  hm->first_sched_thread = tm->n_vlib_mains > 1 ? 1 : 0;
+  vec_validate_aligned (hm->per_thread, tm->n_vlib_mains - 1,
+			CLIB_CACHE_LINE_BYTES);
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (hqos_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __HQOS_H__
+#define __HQOS_H__
+
+#include <vnet/vnet.h>
+#include <vppinfra/fifo.h>
+#include <vppinfra/tw_timer_2t_1w_2048sl.h>
+
+/**
+ * Hierarchical QoS scheduler.
+ *
+ * An interface-output feature that holds the packets sent on an interface
+ * in a port / subport / pipe / traffic class / queue hierarchy and releases
+ * them to the interface's tx node at the configured rates:
+ *  - port, subport and pipe are token bucket shapers,
+ *  - traffic classes within a pipe are served in strict priority, 0 first,
+ *  - queues within a traffic class are served by weighted (deficit) round
+ *    robin.
+ * Shapers that run out of tokens park their pipe or subport on a timer
+ * wheel until enough tokens have accumulated, so only entities that can
+ * send are visited.
+ *
+ * Each worker thread has its own scheduler instance for the interface and
+ * no state is shared on the data-path. The main thread has none unless
+ * there are no workers, so it does not busy-poll the dequeue node; what
+ * it sends on the interface goes out unshaped. The port and subport rates are
+ * split evenly between the worker threads; pipe rates are not, a pipe is
+ * expected to be served by a single thread, which is the case when
+ * subscribers are pinned to workers.
+ */
+
+#define HQOS_N_TC 4
+#define HQOS_N_QUEUES_PER_TC 4
+#define HQOS_N_QUEUES (HQOS_N_TC * HQOS_N_QUEUES_PER_TC)
+
+#define HQOS_DEFAULT_N_SUBPORTS 1
+#define HQOS_DEFAULT_N_PIPES 64
+#define HQOS_DEFAULT_QUEUE_SIZE 64
+#define HQOS_MAX_N_PIPES (1 << 20)
+
+/** Bytes a queue may send per round of weight 1 */
+#define HQOS_WRR_QUANTUM 256
+
+/** Shaper timer wheel tick */
+#define HQOS_TIMER_TICK 10e-6
+
+/** Timer ids: pipe and subport waits share the wheel */
+#define HQOS_TIMER_PIPE 0
+#define HQOS_TIMER_SUBPORT 1
+
+/**
+ * Token bucket, in bytes. A zero rate is not shaped.
+ */
+typedef struct hqos_tb_t_
+{
+  f64 tokens;
+  f64 size;
+  f64 rate;
+  f64 last_update;
+} hqos_tb_t;
+
+typedef enum hqos_state_t_
+{
+  HQOS_STATE_IDLE,
+  HQOS_STATE_ACTIVE,
+  HQOS_STATE_WAIT,
+} hqos_state_t;
+
+typedef struct hqos_pipe_t_
+{
+  /** Fifos of buffer indices, traffic class major */
+  u32 *queues[HQOS_N_QUEUES];
+  i32 deficit[HQOS_N_QUEUES];
+  u32 tc_n_buffers[HQOS_N_TC];
+  u8 wrr_pos[HQOS_N_TC];
+  u8 weights[HQOS_N_QUEUES_PER_TC];
+  u32 n_buffers;
+  hqos_state_t state;
+  hqos_tb_t tb;
+
+  u64 n_tx_packets;
+  u64 n_tx_bytes;
+  u64 n_drops;
+} hqos_pipe_t;
+
+typedef struct hqos_subport_t_
+{
+  /** Fifo of the pipe indices that have packets to send */
+  u32 *active_pipes;
+  hqos_state_t state;
+  hqos_tb_t tb;
+
+  u64 n_tx_packets;
+  u64 n_tx_bytes;
+} hqos_subport_t;
+
+/**
+ * A thread's scheduler for an interface
+ */
+typedef struct hqos_sched_t_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 sw_if_index;
+  u32 tx_node_index;
+  u32 n_pipes_per_subport;
+  u32 queue_size;
+  u32 n_buffers;
+  hqos_tb_t tb;
+
+  /** Fifo of the subport indices that have packets to send */
+  u32 *active_subports;
+  hqos_subport_t *subports;
+  /** Indexed by subport * n_pipes_per_subport + pipe */
+  hqos_pipe_t *pipes;
+
+  tw_timer_wheel_2t_1w_2048sl_t timer_wheel;
+  u32 *expired_timers;
+
+  u64 n_drops;
+} hqos_sched_t;
+
+/**
+ * A packet field the subport or pipe is taken from: the masked big-endian
+ * 64 bit word at offset bytes into the packet, modulo the number of
+ * subports or pipes.
+ */
+typedef struct hqos_field_t_
+{
+  u32 offset;
+  u64 mask;
+  u8 shift;
+} hqos_field_t;
+
+typedef struct hqos_shaper_params_t_
+{
+  /** bytes per second, 0 is unshaped */
+  u64 rate;
+  /** bytes */
+  u32 burst;
+} hqos_shaper_params_t;
+
+typedef struct hqos_pipe_params_t_
+{
+  hqos_shaper_params_t shaper;
+  u8 weights[HQOS_N_QUEUES_PER_TC];
+} hqos_pipe_params_t;
+
+/**
+ * An interface's configuration, from which the threads' schedulers are
+ * built.
+ */
+typedef struct hqos_config_t_
+{
+  u32 sw_if_index;
+  u32 n_subports;
+  u32 n_pipes_per_subport;
+  u32 queue_size;
+  /** packets start with an ethernet header */
+  u8 is_ethernet;
+
+  hqos_shaper_params_t port;
+  hqos_shaper_params_t *subports;
+  hqos_pipe_params_t *pipes;
+
+  hqos_field_t subport_field;
+  hqos_field_t pipe_field;
+  /** traffic class * HQOS_N_QUEUES_PER_TC + queue, by DSCP */
+  u8 queue_by_dscp[64];
+
+  /** scheduler index, by thread */
+  u32 *sched_index_by_thread;
+} hqos_config_t;
+
+typedef struct hqos_per_thread_t_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  hqos_sched_t *scheds;
+  u32 *sched_index_by_sw_if_index;
+  u32 n_active_scheds;
+} hqos_per_thread_t;
+
+typedef struct hqos_main_t_
+{
+  hqos_config_t *configs;
+  u32 *config_index_by_sw_if_index;
+  hqos_per_thread_t *per_thread;
+
+  /** Threads port and subport rates are split between */
+  u32 n_shaping_threads;
+
+  /** First thread with schedulers: the first worker, or the main thread
+      if there are no workers */
+  u32 first_sched_thread;
+
+  vlib_main_t *vlib_main;
+  vnet_main_t *vnet_main;
+} hqos_main_t;
+
+extern hqos_main_t hqos_main;
+extern vlib_node_registration_t hqos_enqueue_node;
+extern vlib_node_registration_t hqos_dequeue_node;
+
+extern clib_error_t *hqos_port_config (u32 sw_if_index, u64 rate, u32 burst,
+				       u32 n_subports, u32 n_pipes,
+				       u32 queue_size);
+extern clib_error_t *hqos_port_delete (u32 sw_if_index);
+extern clib_error_t *hqos_subport_config (u32 sw_if_index, u32 subport,
+					  u64 rate, u32 burst);
+extern clib_error_t *hqos_pipe_config (u32 sw_if_index, u32 subport,
+				       u32 pipe, u64 rate, u32 burst,
+				       u8 * weights);
+extern void hqos_sched_free_buffers (vlib_main_t * vm, hqos_sched_t * s);
+
+always_inline void
+hqos_tb_init (hqos_tb_t * tb, hqos_shaper_params_t * p, u32 n_threads,
+	      f64 now)
+{
+  tb->rate = (f64) p->rate / n_threads;
+  tb->size = clib_max ((f64) p->burst / n_threads, 2048.0);
+  tb->tokens = tb->size;
+  tb->last_update = now;
+}
+
+always_inline void
+hqos_tb_update (hqos_tb_t * tb, f64 now)
+{
+  tb->tokens += (now - tb->last_update) * tb->rate;
+  tb->tokens = clib_min (tb->tokens, tb->size);
+  tb->last_update = now;
+}
+
+/**
+ * Whether the shaper lets a packet through. It may go into debt for the
+ * last one, so packets larger than the bucket still pass.
+ */
+always_inline int
+hqos_tb_ready (hqos_tb_t * tb)
+{
+  return tb->rate == 0 || tb->tokens > 0;
+}
+
+always_inline void
+hqos_tb_consume (hqos_tb_t * tb, u32 n_bytes)
+{
+  if (tb->rate)
+    tb->tokens -= n_bytes;
+}
+
+/**
+ * Seconds until the bucket has tokens again
+ */
+always_inline f64
+hqos_tb_wait (hqos_tb_t * tb)
+{
+  return (1.0 - tb->tokens) / tb->rate;
+}
+
+#endif /* __HQOS_H__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
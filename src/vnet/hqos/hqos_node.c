@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/hqos/hqos.h>
+#include <vnet/ethernet/ethernet.h>
+#include <vnet/ip/ip.h>
+#include <vnet/feature/feature.h>
+
+/** Packets a pipe may send each time it is visited */
+#define HQOS_PIPE_BURST 8
+
+#define foreach_hqos_error			\
+_(ENQUEUED, "packets enqueued")			\
+_(QUEUE_FULL, "queue full drops")
+
+typedef enum
+{
+#define _(sym,str) HQOS_ERROR_##sym,
+  foreach_hqos_error
+#undef _
+    HQOS_N_ERROR,
+} hqos_error_t;
+
+static char *hqos_error_strings[] = {
+#define _(sym,string) string,
+  foreach_hqos_error
+#undef _
+};
+
+typedef enum
+{
+  HQOS_ENQUEUE_NEXT_DROP,
+  HQOS_ENQUEUE_N_NEXT,
+} hqos_enqueue_next_t;
+
+typedef struct
+{
+  u32 sw_if_index;
+  u32 subport;
+  u32 pipe;
+  u8 queue;
+  u8 dropped;
+} hqos_enqueue_trace_t;
+
+static u8 *
+format_hqos_enqueue_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  hqos_enqueue_trace_t *t = va_arg (*args, hqos_enqueue_trace_t *);
+
+  s = format (s, "HQOS: sw_if_index %d subport %d pipe %d tc %d queue %d%s",
+	      t->sw_if_index, t->subport, t->pipe,
+	      t->queue / HQOS_N_QUEUES_PER_TC, t->queue % HQOS_N_QUEUES_PER_TC,
+	      t->dropped ? " dropped" : "");
+  return s;
+}
+
+always_inline u32
+hqos_field_value (hqos_field_t * f, u8 * data, u32 len, u32 n)
+{
+  u64 v;
+
+  if (n == 1 || f->mask == 0 || f->offset + sizeof (u64) > len)
+    return 0;
+
+  v = clib_net_to_host_u64 (clib_mem_unaligned (data + f->offset, u64));
+  return ((v & f->mask) >> f->shift) % n;
+}
+
+always_inline u8
+hqos_packet_dscp (hqos_config_t * c, u8 * data, u32 len)
+{
+  u16 type;
+  u8 *ip = data;
+
+  if (c->is_ethernet)
+    {
+      ethernet_header_t *e = (ethernet_header_t *) data;
+      ethernet_vlan_header_t *v;
+
+      if (len < sizeof (*e) + sizeof (*v) + sizeof (u32))
+	return 0;
+      type = e->type;
+      ip = (u8 *) (e + 1);
+      if (type == clib_host_to_net_u16 (ETHERNET_TYPE_VLAN) ||
+	  type == clib_host_to_net_u16 (ETHERNET_TYPE_DOT1AD))
+	{
+	  v = (ethernet_vlan_header_t *) ip;
+	  type = v->type;
+	  ip = (u8 *) (v + 1);
+	}
+      if (type == clib_host_to_net_u16 (ETHERNET_TYPE_IP4))
+	return ((ip4_header_t *) ip)->tos >> 2;
+      if (type == clib_host_to_net_u16 (ETHERNET_TYPE_IP6))
+	return ip6_traffic_class_network_order ((ip6_header_t *) ip) >> 2;
+      return 0;
+    }
+
+  if (len < sizeof (u32))
+    return 0;
+  if ((ip[0] & 0xf0) == 0x40)
+    return ((ip4_header_t *) ip)->tos >> 2;
+  if ((ip[0] & 0xf0) == 0x60)
+    return ip6_traffic_class_network_order ((ip6_header_t *) ip) >> 2;
+  return 0;
+}
+
+always_inline void
+hqos_subport_activate (hqos_sched_t * s, u32 subport_index)
+{
+  hqos_subport_t *sp = vec_elt_at_index (s->subports, subport_index);
+
+  if (sp->state == HQOS_STATE_IDLE)
+    {
+      sp->state = HQOS_STATE_ACTIVE;
+      clib_fifo_add1 (s->active_subports, subport_index);
+    }
+}
+
+always_inline void
+hqos_pipe_activate (hqos_sched_t * s, u32 pipe_index)
+{
+  u32 subport_index = pipe_index / s->n_pipes_per_subport;
+  hqos_subport_t *sp = vec_elt_at_index (s->subports, subport_index);
+  hqos_pipe_t *p = vec_elt_at_index (s->pipes, pipe_index);
+
+  p->state = HQOS_STATE_ACTIVE;
+  clib_fifo_add1 (sp->active_pipes, pipe_index);
+  hqos_subport_activate (s, subport_index);
+}
+
+/**
+ * Queue a packet, returns 0 if the queue is full
+ */
+always_inline int
+hqos_sched_enqueue (hqos_sched_t * s, u32 pipe_index, u32 queue, u32 bi)
+{
+  hqos_pipe_t *p = vec_elt_at_index (s->pipes, pipe_index);
+
+  if (PREDICT_FALSE (clib_fifo_elts (p->queues[queue]) >= s->queue_size))
+    {
+      p->n_drops++;
+      s->n_drops++;
+      return 0;
+    }
+
+  clib_fifo_add1 (p->queues[queue], bi);
+  p->tc_n_buffers[queue / HQOS_N_QUEUES_PER_TC]++;
+  p->n_buffers++;
+  s->n_buffers++;
+
+  /* a waiting pipe is activated by its timer */
+  if (p->state == HQOS_STATE_IDLE)
+    hqos_pipe_activate (s, pipe_index);
+
+  return 1;
+}
+
+/**
+ * A thread without schedulers, i.e. the main thread when there are
+ * workers, sends the packets it originates on unshaped.
+ */
+static uword
+hqos_enqueue_bypass (vlib_main_t * vm, vlib_node_runtime_t * node,
+		     vlib_frame_t * frame)
+{
+  u32 *from = vlib_frame_vector_args (frame), i, next0;
+  u16 nexts[VLIB_FRAME_SIZE];
+  vlib_buffer_t *b0;
+
+  for (i = 0; i < frame->n_vectors; i++)
+    {
+      b0 = vlib_get_buffer (vm, from[i]);
+      vnet_feature_next (vnet_buffer (b0)->sw_if_index[VLIB_TX], &next0, b0);
+      nexts[i] = next0;
+    }
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
+  return frame->n_vectors;
+}
+
+static uword
+hqos_enqueue_node_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
+		      vlib_frame_t * frame)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_per_thread_t *ptd = vec_elt_at_index (hm->per_thread,
+					     vm->thread_index);
+  u32 n_left, *from, drops[VLIB_FRAME_SIZE], n_drops = 0;
+  u32 last_sw_if_index = ~0;
+  hqos_config_t *c = 0;
+  hqos_sched_t *s = 0;
+
+  if (PREDICT_FALSE (vm->thread_index < hm->first_sched_thread))
+    return hqos_enqueue_bypass (vm, node, frame);
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+
+  while (n_left > 0)
+    {
+      u32 bi0, sw_if_index0, subport0, pipe0, queue0, len0;
+      vlib_buffer_t *b0;
+      u8 *data0;
+      int ok0;
+
+      if (n_left > 1)
+	{
+	  vlib_buffer_t *p1 = vlib_get_buffer (vm, from[1]);
+	  vlib_prefetch_buffer_header (p1, LOAD);
+	  CLIB_PREFETCH (p1->data, CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      bi0 = from[0];
+      b0 = vlib_get_buffer (vm, bi0);
+      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_TX];
+
+      if (PREDICT_FALSE (sw_if_index0 != last_sw_if_index))
+	{
+	  c = pool_elt_at_index (hm->configs,
+				 hm->config_index_by_sw_if_index
+				 [sw_if_index0]);
+	  s = pool_elt_at_index (ptd->scheds,
+				 ptd->sched_index_by_sw_if_index
+				 [sw_if_index0]);
+	  last_sw_if_index = sw_if_index0;
+	}
+
+      data0 = vlib_buffer_get_current (b0);
+      len0 = b0->current_length;
+      subport0 = hqos_field_value (&c->subport_field, data0, len0,
+				   c->n_subports);
+      pipe0 = hqos_field_value (&c->pipe_field, data0, len0,
+				c->n_pipes_per_subport);
+      queue0 = c->queue_by_dscp[hqos_packet_dscp (c, data0, len0)];
+
+      ok0 = hqos_sched_enqueue (s, subport0 * c->n_pipes_per_subport + pipe0,
+				queue0, bi0);
+      if (PREDICT_FALSE (!ok0))
+	{
+	  b0->error = node->errors[HQOS_ERROR_QUEUE_FULL];
+	  drops[n_drops++] = bi0;
+	}
+
+      if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  hqos_enqueue_trace_t *t = vlib_add_trace (vm, node, b0,
+						    sizeof (*t));
+	  t->sw_if_index = sw_if_index0;
+	  t->subport = subport0;
+	  t->pipe = pipe0;
+	  t->queue = queue0;
+	  t->dropped = !ok0;
+	}
+
+      from += 1;
+      n_left -= 1;
+    }
+
+  if (n_drops)
+    {
+      u16 nexts[VLIB_FRAME_SIZE];
+      u32 i;
+
+      for (i = 0; i < n_drops; i++)
+	nexts[i] = HQOS_ENQUEUE_NEXT_DROP;
+      vlib_buffer_enqueue_to_next (vm, node, drops, nexts, n_drops);
+    }
+
+  vlib_node_increment_counter (vm, node->node_index, HQOS_ERROR_ENQUEUED,
+			       frame->n_vectors - n_drops);
+
+  return frame->n_vectors;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (hqos_enqueue_node) = {
+  .function = hqos_enqueue_node_fn,
+  .name = "hqos-enqueue",
+  .vector_size = sizeof (u32),
+  .format_trace = format_hqos_enqueue_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = HQOS_N_ERROR,
+  .error_strings = hqos_error_strings,
+  .n_next_nodes = HQOS_ENQUEUE_N_NEXT,
+  .next_nodes = {
+    [HQOS_ENQUEUE_NEXT_DROP] = "error-drop",
+  },
+};
+
+VLIB_NODE_FUNCTION_MULTIARCH (hqos_enqueue_node, hqos_enqueue_node_fn);
+
+VNET_FEATURE_INIT (hqos_enqueue, static) = {
+  .arc_name = "interface-output",
+  .node_name = "hqos-enqueue",
+  .runs_before = VNET_FEATURES ("interface-tx"),
+};
+/* *INDENT-ON* */
+
+/**
+ * Park a pipe or subport on the timer wheel until its shaper has tokens
+ */
+always_inline void
+hqos_sched_wait (hqos_sched_t * s, hqos_tb_t * tb, u32 index, u32 timer_id)
+{
+  u64 ticks = hqos_tb_wait (tb) / HQOS_TIMER_TICK + 1;
+
+  ticks = clib_min (ticks, TW_SLOTS_PER_RING - 1);
+  tw_timer_start_2t_1w_2048sl (&s->timer_wheel, index, timer_id, ticks);
+}
+
+static void
+hqos_sched_expire_timers (hqos_sched_t * s, f64 now)
+{
+  u32 *h;
+
+  vec_reset_length (s->expired_timers);
+  s->expired_timers =
+    tw_timer_expire_timers_vec_2t_1w_2048sl (&s->timer_wheel, now,
+					     s->expired_timers);
+
+  vec_foreach (h, s->expired_timers)
+  {
+    u32 index = h[0] & 0x7FFFFFFF;
+
+    if ((h[0] >> 31) == HQOS_TIMER_PIPE)
+      hqos_pipe_activate (s, index);
+    else
+      {
+	hqos_subport_t *sp = vec_elt_at_index (s->subports, index);
+
+	sp->state = HQOS_STATE_IDLE;
+	if (clib_fifo_elts (sp->active_pipes))
+	  hqos_subport_activate (s, index);
+      }
+  }
+}
+
+/**
+ * Pick the next packet of a pipe: the highest priority traffic class with
+ * packets, and a queue within it by deficit round robin.
+ */
+always_inline u32
+hqos_pipe_next_queue (vlib_main_t * vm, hqos_pipe_t * p, u32 * n_bytes)
+{
+  u32 tc, queue, bi;
+
+  for (tc = 0; tc < HQOS_N_TC - 1; tc++)
+    if (p->tc_n_buffers[tc])
+      break;
+
+  while (1)
+    {
+      queue = tc * HQOS_N_QUEUES_PER_TC + p->wrr_pos[tc];
+
+      if (clib_fifo_elts (p->queues[queue]))
+	{
+	  bi = clib_fifo_head (p->queues[queue])[0];
+	  *n_bytes = vlib_buffer_length_in_chain (vm,
+						  vlib_get_buffer (vm, bi));
+	  if (p->deficit[queue] >= (i32) n_bytes[0])
+	    {
+	      p->deficit[queue] -= n_bytes[0];
+	      return queue;
+	    }
+	}
+      else
+	p->deficit[queue] = 0;
+
+      /* the queue's turn is over, the next one gets its quantum */
+      p->wrr_pos[tc] = (p->wrr_pos[tc] + 1) % HQOS_N_QUEUES_PER_TC;
+      queue = tc * HQOS_N_QUEUES_PER_TC + p->wrr_pos[tc];
+      p->deficit[queue] += p->weights[p->wrr_pos[tc]] * HQOS_WRR_QUANTUM;
+    }
+}
+
+always_inline u32
+hqos_pipe_dequeue (vlib_main_t * vm, hqos_sched_t * s, hqos_subport_t * sp,
+		   hqos_pipe_t * p, u32 * to, u32 n_max)
+{
+  u32 n = 0, n_bytes, queue;
+
+  while (n < n_max && p->n_buffers && hqos_tb_ready (&p->tb) &&
+	 hqos_tb_ready (&sp->tb) && hqos_tb_ready (&s->tb))
+    {
+      queue = hqos_pipe_next_queue (vm, p, &n_bytes);
+
+      clib_fifo_sub1 (p->queues[queue], to[n]);
+      n++;
+      p->tc_n_buffers[queue / HQOS_N_QUEUES_PER_TC]--;
+      p->n_buffers--;
+      s->n_buffers--;
+
+      hqos_tb_consume (&p->tb, n_bytes);
+      hqos_tb_consume (&sp->tb, n_bytes);
+      hqos_tb_consume (&s->tb, n_bytes);
+      p->n_tx_bytes += n_bytes;
+      sp->n_tx_bytes += n_bytes;
+    }
+
+  p->n_tx_packets += n;
+  sp->n_tx_packets += n;
+
+  return n;
+}
+
+/**
+ * Dequeue up to n_max packets, round robin over the subports that can
+ * send, and within each over its pipes that can send.
+ */
+static u32
+hqos_sched_dequeue (vlib_main_t * vm, hqos_sched_t * s, u32 * to, u32 n_max,
+		    f64 now)
+{
+  u32 n = 0, subport_index, pipe_index;
+  hqos_subport_t *sp;
+  hqos_pipe_t *p;
+
+  hqos_sched_expire_timers (s, now);
+  hqos_tb_update (&s->tb, now);
+
+  while (n < n_max && clib_fifo_elts (s->active_subports))
+    {
+      /* the port is short, try again on the next poll */
+      if (!hqos_tb_ready (&s->tb))
+	break;
+
+      clib_fifo_sub1 (s->active_subports, subport_index);
+      sp = vec_elt_at_index (s->subports, subport_index);
+      hqos_tb_update (&sp->tb, now);
+
+      if (hqos_tb_ready (&sp->tb) && clib_fifo_elts (sp->active_pipes))
+	{
+	  clib_fifo_sub1 (sp->active_pipes, pipe_index);
+	  p = vec_elt_at_index (s->pipes, pipe_index);
+	  hqos_tb_update (&p->tb, now);
+
+	  n += hqos_pipe_dequeue (vm, s, sp, p, to + n,
+				  clib_min (n_max - n, HQOS_PIPE_BURST));
+
+	  if (p->n_buffers == 0)
+	    p->state = HQOS_STATE_IDLE;
+	  else if (!hqos_tb_ready (&p->tb))
+	    {
+	      p->state = HQOS_STATE_WAIT;
+	      hqos_sched_wait (s, &p->tb, pipe_index, HQOS_TIMER_PIPE);
+	    }
+	  else
+	    clib_fifo_add1 (sp->active_pipes, pipe_index);
+	}
+
+      if (clib_fifo_elts (sp->active_pipes) == 0)
+	sp->state = HQOS_STATE_IDLE;
+      else if (!hqos_tb_ready (&sp->tb))
+	{
+	  sp->state = HQOS_STATE_WAIT;
+	  hqos_sched_wait (s, &sp->tb, subport_index, HQOS_TIMER_SUBPORT);
+	}
+      else
+	clib_fifo_add1 (s->active_subports, subport_index);
+    }
+
+  return n;
+}
+
+static uword
+hqos_dequeue_node_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
+		      vlib_frame_t * frame)
+{
+  hqos_main_t *hm = &hqos_main;
+  hqos_per_thread_t *ptd = vec_elt_at_index (hm->per_thread,
+					     vm->thread_index);
+  u32 buffers[VLIB_FRAME_SIZE], n_total = 0, n, *to;
+  f64 now = vlib_time_now (vm);
+  hqos_sched_t *s;
+  vlib_frame_t *f;
+
+  /* *INDENT-OFF* */
+  pool_foreach (s, ptd->scheds,
+  ({
+    n = hqos_sched_dequeue (vm, s, buffers, VLIB_FRAME_SIZE, now);
+    if (n)
+      {
+	f = vlib_get_frame_to_node (vm, s->tx_node_index);
+	to = vlib_frame_vector_args (f);
+	clib_memcpy (to, buffers, n * sizeof (u32));
+	f->n_vectors = n;
+	vlib_put_frame_to_node (vm, s->tx_node_index, f);
+	n_total += n;
+      }
+  }));
+  /* *INDENT-ON* */
+
+  return n_total;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (hqos_dequeue_node) = {
+  .function = hqos_dequeue_node_fn,
+  .name = "hqos-dequeue",
+  .type = VLIB_NODE_TYPE_INPUT,
+  .state = VLIB_NODE_STATE_DISABLED,
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
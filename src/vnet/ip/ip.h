@@ -160,23 +160,24 @@ ip_incremental_checksum_buffer (vlib_main_t * vm,
   u32 n_bytes_left = n_bytes_to_checksum;
   ASSERT (b->current_length >= first_buffer_offset);
   void *h;
-  u32 n;
+  u32 n, is_odd = 0;
 
-  n = clib_min (n_bytes_left, b->current_length);
+  n = clib_min (n_bytes_left, b->current_length - first_buffer_offset);
   h = vlib_buffer_get_current (b) + first_buffer_offset;
   sum = ip_incremental_checksum (sum, h, n);
-  if (PREDICT_FALSE (b->flags & VLIB_BUFFER_NEXT_PRESENT))
+  while (PREDICT_FALSE (b->flags & VLIB_BUFFER_NEXT_PRESENT))
     {
-      while (1)
-	{
-	  n_bytes_left -= n;
-	  if (n_bytes_left == 0)
-	    break;
-	  b = vlib_get_buffer (vm, b->next_buffer);
-	  n = clib_min (n_bytes_left, b->current_length);
-	  h = vlib_buffer_get_current (b);
-	  sum = ip_incremental_checksum (sum, h, n);
-	}
+      n_bytes_left -= n;
+      if (n_bytes_left == 0)
+	break;
+      is_odd ^= n & 1;
+      b = vlib_get_buffer (vm, b->next_buffer);
+      n = clib_min (n_bytes_left, b->current_length);
+      h = vlib_buffer_get_current (b);
+      if (PREDICT_TRUE (!is_odd))
+	sum = ip_incremental_checksum (sum, h, n);
+      else
+	sum = ip_incremental_checksum_odd (sum, h, n);
     }
 
   return sum;
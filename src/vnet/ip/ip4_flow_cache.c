@@ -0,0 +1,893 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/ip/ip4_flow_cache.h>
+#include <vnet/adj/adj.h>
+#include <vnet/feature/feature.h>
+
+/**
+ * @file
+ * @brief IPv4 flow cache.
+ *
+ * ip4-flow-cache looks flows up on the ip4-unicast arc,
+ * ip4-flow-cache-learn records them on the ip4-output arc.
+ */
+
+ip4_flow_cache_main_t ip4_flow_cache_main;
+
+#define foreach_ip4_flow_cache_error		\
+  _(HIT, "flow cache hits")			\
+  _(MISS, "flow cache misses")			\
+  _(EXPIRED, "flow cache entries expired")
+
+typedef enum
+{
+#define _(sym,str) IP4_FLOW_CACHE_ERROR_##sym,
+  foreach_ip4_flow_cache_error
+#undef _
+    IP4_FLOW_CACHE_N_ERROR,
+} ip4_flow_cache_error_t;
+
+static char *ip4_flow_cache_error_strings[] = {
+#define _(sym,string) string,
+  foreach_ip4_flow_cache_error
+#undef _
+};
+
+#define foreach_ip4_flow_cache_learn_error		\
+  _(LEARNED, "flow cache flows learnt")			\
+  _(NOT_CACHEABLE, "flow cache flows not cacheable")	\
+  _(FULL, "flow cache full")
+
+typedef enum
+{
+#define _(sym,str) IP4_FLOW_CACHE_LEARN_ERROR_##sym,
+  foreach_ip4_flow_cache_learn_error
+#undef _
+    IP4_FLOW_CACHE_LEARN_N_ERROR,
+} ip4_flow_cache_learn_error_t;
+
+static char *ip4_flow_cache_learn_error_strings[] = {
+#define _(sym,string) string,
+  foreach_ip4_flow_cache_learn_error
+#undef _
+};
+
+typedef enum
+{
+  IP4_FLOW_CACHE_NEXT_INTERFACE_OUTPUT,
+  IP4_FLOW_CACHE_N_NEXT,
+} ip4_flow_cache_next_t;
+
+typedef struct
+{
+  u32 entry_index;
+  u8 hit;
+} ip4_flow_cache_trace_t;
+
+static u8 *
+format_ip4_flow_cache_trace (u8 * s, va_list * args)
+{
+  CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
+  CLIB_UNUSED (vlib_node_t * node) = va_arg (*args, vlib_node_t *);
+  ip4_flow_cache_trace_t *t = va_arg (*args, ip4_flow_cache_trace_t *);
+
+  if (t->hit)
+    s = format (s, "flow-cache: hit entry %d", t->entry_index);
+  else
+    s = format (s, "flow-cache: miss");
+  return s;
+}
+
+static u8 *
+format_ip4_flow_cache_entry (u8 * s, va_list * args)
+{
+  ip4_flow_cache_entry_t *e = va_arg (*args, ip4_flow_cache_entry_t *);
+  f64 now = va_arg (*args, f64);
+  ip4_address_t src, dst;
+
+  src.as_u32 = e->key[0] >> 32;
+  dst.as_u32 = e->key[0];
+
+  s = format (s, "%U %U:%d -> %U:%d rx %U",
+	      format_ip_protocol, (u32) e->key[2],
+	      format_ip4_address, &src, clib_net_to_host_u16 (e->key[1] >> 48),
+	      format_ip4_address, &dst,
+	      clib_net_to_host_u16 (e->key[1] >> 32),
+	      format_vnet_sw_if_index_name, vnet_get_main (),
+	      (u32) e->key[1]);
+  s = format (s, "\n    out %U:%d -> %U:%d adj %d, epoch %d, age %.1fs",
+	      format_ip4_address, &e->src_address,
+	      clib_net_to_host_u16 (e->src_port),
+	      format_ip4_address, &e->dst_address,
+	      clib_net_to_host_u16 (e->dst_port), e->adj_index, e->epoch,
+	      now - e->learn_time);
+  s = format (s, "\n    %llu packets, %llu bytes", e->n_packets, e->n_bytes);
+  return s;
+}
+
+static void
+ip4_flow_cache_entry_free (ip4_flow_cache_per_thread_t * ptd,
+			   ip4_flow_cache_entry_t * e)
+{
+  clib_bihash_kv_24_8_t kv;
+
+  clib_memcpy (kv.key, e->key, sizeof (kv.key));
+  clib_bihash_add_del_24_8 (&ptd->table, &kv, 0 /* is_add */ );
+  pool_put (ptd->entries, e);
+}
+
+/**
+ * Drop a few entries learnt in an older epoch or idle for too long, so
+ * the table is aged without a process walking the threads' tables.
+ */
+static u32
+ip4_flow_cache_age (ip4_flow_cache_main_t * fcm,
+		    ip4_flow_cache_per_thread_t * ptd, u32 epoch, f64 now)
+{
+  ip4_flow_cache_entry_t *e;
+  u32 i, n_expired = 0;
+
+  for (i = 0; i < IP4_FLOW_CACHE_AGE_BATCH; i++)
+    {
+      if (ptd->age_cursor >= vec_len (ptd->entries))
+	{
+	  ptd->age_cursor = 0;
+	  break;
+	}
+      if (!pool_is_free_index (ptd->entries, ptd->age_cursor))
+	{
+	  e = pool_elt_at_index (ptd->entries, ptd->age_cursor);
+	  if (e->epoch != epoch
+	      || now - e->last_hit_time > fcm->idle_timeout)
+	    {
+	      ip4_flow_cache_entry_free (ptd, e);
+	      n_expired++;
+	    }
+	}
+      ptd->age_cursor++;
+    }
+
+  return n_expired;
+}
+
+/**
+ * Replay a flow's outcome on a packet: the address and port translations,
+ * the TTL decrement and the adjacency's rewrite.
+ */
+always_inline void
+ip4_flow_cache_apply (vlib_buffer_t * b, ip4_header_t * ip,
+		      ip4_flow_cache_entry_t * e, ip_adjacency_t * adj)
+{
+  udp_header_t *udp = ip4_next_header (ip);
+  tcp_header_t *tcp = (tcp_header_t *) udp;
+  u16 *l4_checksum;
+  ip_csum_t sum, l4_sum;
+  u32 checksum, rw_len;
+
+  l4_checksum = (ip->protocol == IP_PROTOCOL_TCP ?
+		 &tcp->checksum : &udp->checksum);
+
+  if (e->flags)
+    {
+      sum = ip->checksum;
+      l4_sum = *l4_checksum;
+
+      if (e->flags & IP4_FLOW_CACHE_ENTRY_SRC_ADDRESS)
+	{
+	  sum = ip_csum_update (sum, ip->src_address.as_u32,
+				e->src_address.as_u32, ip4_header_t,
+				src_address);
+	  l4_sum = ip_csum_update (l4_sum, ip->src_address.as_u32,
+				   e->src_address.as_u32, ip4_header_t,
+				   src_address);
+	  ip->src_address.as_u32 = e->src_address.as_u32;
+	}
+      if (e->flags & IP4_FLOW_CACHE_ENTRY_DST_ADDRESS)
+	{
+	  sum = ip_csum_update (sum, ip->dst_address.as_u32,
+				e->dst_address.as_u32, ip4_header_t,
+				dst_address);
+	  l4_sum = ip_csum_update (l4_sum, ip->dst_address.as_u32,
+				   e->dst_address.as_u32, ip4_header_t,
+				   dst_address);
+	  ip->dst_address.as_u32 = e->dst_address.as_u32;
+	}
+      if (e->flags & IP4_FLOW_CACHE_ENTRY_SRC_PORT)
+	{
+	  l4_sum = ip_csum_update (l4_sum, udp->src_port, e->src_port,
+				   udp_header_t, src_port);
+	  udp->src_port = e->src_port;
+	}
+      if (e->flags & IP4_FLOW_CACHE_ENTRY_DST_PORT)
+	{
+	  l4_sum = ip_csum_update (l4_sum, udp->dst_port, e->dst_port,
+				   udp_header_t, dst_port);
+	  udp->dst_port = e->dst_port;
+	}
+
+      ip->checksum = ip_csum_fold (sum);
+      /* a zero UDP checksum means there is none */
+      if (*l4_checksum || ip->protocol == IP_PROTOCOL_TCP)
+	*l4_checksum = ip_csum_fold (l4_sum);
+    }
+
+  /* Decrement TTL & update checksum, as ip4-rewrite does */
+  checksum = ip->checksum + clib_host_to_net_u16 (0x0100);
+  checksum += checksum >= 0xffff;
+  ip->checksum = checksum;
+  ip->ttl -= 1;
+
+  vnet_rewrite_one_header (adj[0], ip, sizeof (ethernet_header_t));
+  rw_len = adj->rewrite_header.data_bytes;
+  vnet_buffer (b)->ip.save_rewrite_length = rw_len;
+  vlib_buffer_advance (b, -(word) rw_len);
+  vnet_buffer (b)->sw_if_index[VLIB_TX] = adj->rewrite_header.sw_if_index;
+}
+
+static uword
+ip4_flow_cache_node_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
+			vlib_frame_t * frame)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+  u32 thread_index = vm->thread_index;
+  ip4_flow_cache_per_thread_t *ptd =
+    vec_elt_at_index (fcm->per_thread, thread_index);
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left, *from, epoch, n_hits = 0, n_expired;
+  int do_counters = adj_are_counters_enabled ();
+  f64 now = vlib_time_now (vm);
+
+  epoch = fcm->epoch;
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+  b = bufs;
+  next = nexts;
+
+  while (n_left > 0)
+    {
+      clib_bihash_kv_24_8_t kv;
+      ip4_flow_cache_entry_t *e;
+      ip_adjacency_t *adj;
+      udp_header_t *udp;
+      ip4_header_t *ip;
+      u32 sw_if_index, next0, n_bytes;
+
+      if (n_left > 2)
+	{
+	  vlib_prefetch_buffer_header (b[2], LOAD);
+	  CLIB_PREFETCH (vlib_buffer_get_current (b[1]),
+			 CLIB_CACHE_LINE_BYTES, STORE);
+	}
+
+      sw_if_index = vnet_buffer (b[0])->sw_if_index[VLIB_RX];
+      ip = vlib_buffer_get_current (b[0]);
+      udp = ip4_next_header (ip);
+      b[0]->flags &= ~VNET_BUFFER_F_FLOW_CACHE_LEARN;
+
+      if (PREDICT_FALSE (ip->ip_version_and_header_length != 0x45
+			 || ip4_is_fragment (ip)
+			 || (ip->protocol != IP_PROTOCOL_TCP
+			     && ip->protocol != IP_PROTOCOL_UDP)))
+	goto slow_path;
+
+      ip4_flow_cache_make_key (&kv, ip->src_address.as_u32,
+			       ip->dst_address.as_u32, udp->src_port,
+			       udp->dst_port, ip->protocol, sw_if_index);
+
+      if (!clib_bihash_search_inline_24_8 (&ptd->table, &kv))
+	{
+	  e = pool_elt_at_index (ptd->entries, kv.value);
+
+	  /*
+	   * TCP connection setup and teardown and the periodic refresh
+	   * go through the graph, so the stateful features see them.
+	   */
+	  if (PREDICT_FALSE (e->epoch != epoch
+			     || now - e->learn_time >= fcm->refresh_interval
+			     || ip->ttl <= 1
+			     || (ip->protocol == IP_PROTOCOL_TCP
+				 && (((tcp_header_t *) udp)->flags &
+				     (TCP_FLAG_SYN | TCP_FLAG_FIN |
+				      TCP_FLAG_RST)))))
+	    goto miss;
+
+	  adj = adj_get (e->adj_index);
+	  if (PREDICT_FALSE (adj->lookup_next_index != IP_LOOKUP_NEXT_REWRITE
+			     || clib_net_to_host_u16 (ip->length) >
+			     adj->rewrite_header.max_l3_packet_bytes))
+	    goto miss;
+
+	  ip4_flow_cache_apply (b[0], ip, e, adj);
+
+	  n_bytes = vlib_buffer_length_in_chain (vm, b[0]);
+	  e->n_packets += 1;
+	  e->n_bytes += n_bytes;
+	  e->last_hit_time = now;
+	  if (do_counters)
+	    vlib_increment_combined_counter (&adjacency_counters,
+					     thread_index, e->adj_index,
+					     1, n_bytes);
+
+	  if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	    {
+	      ip4_flow_cache_trace_t *t =
+		vlib_add_trace (vm, node, b[0], sizeof (*t));
+	      t->hit = 1;
+	      t->entry_index = e - ptd->entries;
+	    }
+
+	  next[0] = IP4_FLOW_CACHE_NEXT_INTERFACE_OUTPUT;
+	  n_hits++;
+	  goto next_packet;
+	}
+
+    miss:
+      /* tag the packet with its flow for ip4-flow-cache-learn */
+      b[0]->flags |= VNET_BUFFER_F_FLOW_CACHE_LEARN;
+      vnet_buffer2 (b[0])->flow_cache.src_address = ip->src_address.as_u32;
+      vnet_buffer2 (b[0])->flow_cache.dst_address = ip->dst_address.as_u32;
+      vnet_buffer2 (b[0])->flow_cache.src_port = udp->src_port;
+      vnet_buffer2 (b[0])->flow_cache.dst_port = udp->dst_port;
+      vnet_buffer2 (b[0])->flow_cache.rx_sw_if_index = sw_if_index;
+      vnet_buffer2 (b[0])->flow_cache.epoch = epoch;
+      vnet_buffer2 (b[0])->flow_cache.fragment_id = ip->fragment_id;
+      vnet_buffer2 (b[0])->flow_cache.length = ip->length;
+
+    slow_path:
+      if (PREDICT_FALSE (b[0]->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  ip4_flow_cache_trace_t *t =
+	    vlib_add_trace (vm, node, b[0], sizeof (*t));
+	  t->hit = 0;
+	  t->entry_index = ~0;
+	}
+
+      vnet_feature_next (sw_if_index, &next0, b[0]);
+      next[0] = next0;
+
+    next_packet:
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
+  n_expired = ip4_flow_cache_age (fcm, ptd, epoch, now);
+
+  vlib_node_increment_counter (vm, node->node_index,
+			       IP4_FLOW_CACHE_ERROR_HIT, n_hits);
+  vlib_node_increment_counter (vm, node->node_index,
+			       IP4_FLOW_CACHE_ERROR_MISS,
+			       frame->n_vectors - n_hits);
+  if (n_expired)
+    vlib_node_increment_counter (vm, node->node_index,
+				 IP4_FLOW_CACHE_ERROR_EXPIRED, n_expired);
+
+  return frame->n_vectors;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (ip4_flow_cache_node) =
+{
+  .function = ip4_flow_cache_node_fn,
+  .name = "ip4-flow-cache",
+  .vector_size = sizeof (u32),
+  .format_trace = format_ip4_flow_cache_trace,
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = ARRAY_LEN (ip4_flow_cache_error_strings),
+  .error_strings = ip4_flow_cache_error_strings,
+  .n_next_nodes = IP4_FLOW_CACHE_N_NEXT,
+  .next_nodes =
+  {
+    [IP4_FLOW_CACHE_NEXT_INTERFACE_OUTPUT] = "interface-output",
+  },
+};
+
+VLIB_NODE_FUNCTION_MULTIARCH (ip4_flow_cache_node, ip4_flow_cache_node_fn);
+
+VNET_FEATURE_INIT (ip4_flow_cache_feature, static) =
+{
+  .arc_name = "ip4-unicast",
+  .node_name = "ip4-flow-cache",
+  .runs_before = VNET_FEATURES ("ip4-flow-classify"),
+};
+/* *INDENT-ON* */
+
+/**
+ * Learn the outcome of a tagged packet, if the flow can be replayed: it
+ * is sent on a rewrite adjacency, its output interface has no output
+ * features to run and nothing changed since it was looked up.
+ */
+static u32
+ip4_flow_cache_learn_one (vlib_main_t * vm, ip4_flow_cache_main_t * fcm,
+			  ip4_flow_cache_per_thread_t * ptd,
+			  vlib_buffer_t * b, u8 output_arc, f64 now)
+{
+  vnet_feature_main_t *fm = &feature_main;
+  clib_bihash_kv_24_8_t kv;
+  ip4_flow_cache_entry_t *e;
+  ip_adjacency_t *adj;
+  udp_header_t *udp;
+  ip4_header_t *ip;
+  u32 adj_index, tx_sw_if_index, rx_sw_if_index;
+
+  adj_index = vnet_buffer (b)->ip.adj_index[VLIB_TX];
+  tx_sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_TX];
+  rx_sw_if_index = vnet_buffer2 (b)->flow_cache.rx_sw_if_index;
+  adj = adj_get (adj_index);
+  ip = (ip4_header_t *) ((u8 *) vlib_buffer_get_current (b) +
+			 vnet_buffer (b)->ip.save_rewrite_length);
+  udp = ip4_next_header (ip);
+
+  /*
+   * The fragment id and length tell a packet from the tunnelled
+   * packet it may have carried.
+   */
+  if (vnet_buffer2 (b)->flow_cache.epoch != fcm->epoch
+      || vnet_buffer (b)->sw_if_index[VLIB_RX] != rx_sw_if_index
+      || adj->lookup_next_index != IP_LOOKUP_NEXT_REWRITE
+      || adj->rewrite_header.sw_if_index != tx_sw_if_index
+      || fm->feature_count_by_sw_if_index[output_arc][tx_sw_if_index] != 1
+      || ip->ip_version_and_header_length != 0x45
+      || ip->fragment_id != vnet_buffer2 (b)->flow_cache.fragment_id
+      || ip->length != vnet_buffer2 (b)->flow_cache.length
+      || (ip->protocol != IP_PROTOCOL_TCP
+	  && ip->protocol != IP_PROTOCOL_UDP))
+    return IP4_FLOW_CACHE_LEARN_ERROR_NOT_CACHEABLE;
+
+  ip4_flow_cache_make_key (&kv, vnet_buffer2 (b)->flow_cache.src_address,
+			   vnet_buffer2 (b)->flow_cache.dst_address,
+			   vnet_buffer2 (b)->flow_cache.src_port,
+			   vnet_buffer2 (b)->flow_cache.dst_port,
+			   ip->protocol, rx_sw_if_index);
+
+  if (!clib_bihash_search_24_8 (&ptd->table, &kv, &kv))
+    e = pool_elt_at_index (ptd->entries, kv.value);
+  else
+    {
+      if (pool_elts (ptd->entries) >= fcm->max_flows)
+	return IP4_FLOW_CACHE_LEARN_ERROR_FULL;
+
+      pool_get (ptd->entries, e);
+      memset (e, 0, sizeof (*e));
+      clib_memcpy (e->key, kv.key, sizeof (e->key));
+      kv.value = e - ptd->entries;
+      clib_bihash_add_del_24_8 (&ptd->table, &kv, 1 /* is_add */ );
+    }
+
+  e->src_address = ip->src_address;
+  e->dst_address = ip->dst_address;
+  e->src_port = udp->src_port;
+  e->dst_port = udp->dst_port;
+  e->adj_index = adj_index;
+  e->epoch = vnet_buffer2 (b)->flow_cache.epoch;
+  e->learn_time = e->last_hit_time = now;
+
+  e->flags = 0;
+  if (e->src_address.as_u32 != vnet_buffer2 (b)->flow_cache.src_address)
+    e->flags |= IP4_FLOW_CACHE_ENTRY_SRC_ADDRESS;
+  if (e->dst_address.as_u32 != vnet_buffer2 (b)->flow_cache.dst_address)
+    e->flags |= IP4_FLOW_CACHE_ENTRY_DST_ADDRESS;
+  if (e->src_port != vnet_buffer2 (b)->flow_cache.src_port)
+    e->flags |= IP4_FLOW_CACHE_ENTRY_SRC_PORT;
+  if (e->dst_port != vnet_buffer2 (b)->flow_cache.dst_port)
+    e->flags |= IP4_FLOW_CACHE_ENTRY_DST_PORT;
+
+  return IP4_FLOW_CACHE_LEARN_ERROR_LEARNED;
+}
+
+static uword
+ip4_flow_cache_learn_node_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
+			      vlib_frame_t * frame)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+  ip4_flow_cache_per_thread_t *ptd =
+    vec_elt_at_index (fcm->per_thread, vm->thread_index);
+  u8 output_arc = ip4_main.lookup_main.output_feature_arc_index;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
+  u32 n_left, *from, counts[IP4_FLOW_CACHE_LEARN_N_ERROR] = { 0 };
+  f64 now = vlib_time_now (vm);
+  int i;
+
+  from = vlib_frame_vector_args (frame);
+  n_left = frame->n_vectors;
+  vlib_get_buffers (vm, from, bufs, n_left);
+  b = bufs;
+  next = nexts;
+
+  while (n_left > 0)
+    {
+      u32 next0;
+
+      if (n_left > 1)
+	vlib_prefetch_buffer_header (b[1], LOAD);
+
+      if (PREDICT_FALSE (b[0]->flags & VNET_BUFFER_F_FLOW_CACHE_LEARN))
+	{
+	  b[0]->flags &= ~VNET_BUFFER_F_FLOW_CACHE_LEARN;
+	  counts[ip4_flow_cache_learn_one (vm, fcm, ptd, b[0],
+					   output_arc, now)]++;
+	}
+
+      vnet_feature_next (vnet_buffer (b[0])->sw_if_index[VLIB_TX], &next0,
+			 b[0]);
+      next[0] = next0;
+
+      b += 1;
+      next += 1;
+      n_left -= 1;
+    }
+
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
+  for (i = 0; i < IP4_FLOW_CACHE_LEARN_N_ERROR; i++)
+    if (counts[i])
+      vlib_node_increment_counter (vm, node->node_index, i, counts[i]);
+
+  return frame->n_vectors;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (ip4_flow_cache_learn_node) =
+{
+  .function = ip4_flow_cache_learn_node_fn,
+  .name = "ip4-flow-cache-learn",
+  .vector_size = sizeof (u32),
+  .type = VLIB_NODE_TYPE_INTERNAL,
+  .n_errors = ARRAY_LEN (ip4_flow_cache_learn_error_strings),
+  .error_strings = ip4_flow_cache_learn_error_strings,
+  .n_next_nodes = 0,
+};
+
+VLIB_NODE_FUNCTION_MULTIARCH (ip4_flow_cache_learn_node,
+			      ip4_flow_cache_learn_node_fn);
+
+VNET_FEATURE_INIT (ip4_flow_cache_learn_feature, static) =
+{
+  .arc_name = "ip4-output",
+  .node_name = "ip4-flow-cache-learn",
+  .runs_before = VNET_FEATURES ("interface-output"),
+};
+/* *INDENT-ON* */
+
+static void
+ip4_flow_cache_tables_init (ip4_flow_cache_main_t * fcm)
+{
+  ip4_flow_cache_per_thread_t *ptd;
+
+  vec_validate_aligned (fcm->per_thread, vec_len (vlib_mains) - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_foreach (ptd, fcm->per_thread)
+  {
+    clib_bihash_init_24_8 (&ptd->table, "ip4 flow cache",
+			   fcm->table_buckets, fcm->table_memory);
+    ptd->age_cursor = 0;
+  }
+}
+
+static void
+ip4_flow_cache_tables_free (ip4_flow_cache_main_t * fcm)
+{
+  ip4_flow_cache_per_thread_t *ptd;
+
+  vec_foreach (ptd, fcm->per_thread)
+  {
+    clib_bihash_free_24_8 (&ptd->table);
+    pool_free (ptd->entries);
+  }
+  vec_free (fcm->per_thread);
+}
+
+/**
+ * Forget a flow, as received on any of the interfaces the cache is
+ * enabled on. For the owners of the state a flow's outcome depends on,
+ * e.g. a NAT session that goes away, which would otherwise have to
+ * invalidate all the flows. The caller runs on the thread or holds the
+ * worker barrier.
+ */
+void
+ip4_flow_cache_delete_flow (u32 thread_index, u32 src_address,
+			    u32 dst_address, u16 src_port, u16 dst_port,
+			    u8 protocol)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+  ip4_flow_cache_per_thread_t *ptd;
+  clib_bihash_kv_24_8_t kv;
+  uword sw_if_index;
+
+  if (!fcm->is_enabled)
+    return;
+
+  ptd = vec_elt_at_index (fcm->per_thread, thread_index);
+
+  /* *INDENT-OFF* */
+  clib_bitmap_foreach (sw_if_index, fcm->enabled_by_sw_if_index,
+  ({
+    ip4_flow_cache_make_key (&kv, src_address, dst_address, src_port,
+			     dst_port, protocol, sw_if_index);
+    if (!clib_bihash_search_24_8 (&ptd->table, &kv, &kv))
+      ip4_flow_cache_entry_free (ptd, pool_elt_at_index (ptd->entries,
+							 kv.value));
+  }));
+  /* *INDENT-ON* */
+}
+
+/**
+ * Enable or disable the flow cache on an interface: the lookup on its
+ * input and the learning on its output. Flows are cached between
+ * interfaces the cache is enabled on.
+ */
+int
+ip4_flow_cache_enable_disable (u32 sw_if_index, int is_enable)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+  int rv;
+
+  is_enable = (is_enable != 0);
+  if (clib_bitmap_get (fcm->enabled_by_sw_if_index, sw_if_index) ==
+      is_enable)
+    return 0;
+
+  if (is_enable && !fcm->is_enabled)
+    {
+      ip4_flow_cache_tables_init (fcm);
+      fcm->is_enabled = 1;
+    }
+
+  rv = vnet_feature_enable_disable ("ip4-unicast", "ip4-flow-cache",
+				    sw_if_index, is_enable, 0, 0);
+  if (rv)
+    return rv;
+  vnet_feature_enable_disable ("ip4-output", "ip4-flow-cache-learn",
+			       sw_if_index, is_enable, 0, 0);
+
+  fcm->enabled_by_sw_if_index =
+    clib_bitmap_set (fcm->enabled_by_sw_if_index, sw_if_index, is_enable);
+
+  if (!is_enable && clib_bitmap_is_zero (fcm->enabled_by_sw_if_index))
+    {
+      ip4_flow_cache_invalidate ();
+      fcm->is_enabled = 0;
+      ip4_flow_cache_tables_free (fcm);
+    }
+
+  return 0;
+}
+
+static clib_error_t *
+ip4_flow_cache_interface_add_del (vnet_main_t * vnm, u32 sw_if_index,
+				  u32 is_add)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+
+  if (!is_add && clib_bitmap_get (fcm->enabled_by_sw_if_index, sw_if_index))
+    ip4_flow_cache_enable_disable (sw_if_index, 0);
+
+  return 0;
+}
+
+VNET_SW_INTERFACE_ADD_DEL_FUNCTION (ip4_flow_cache_interface_add_del);
+
+static clib_error_t *
+set_interface_ip4_flow_cache_command_fn (vlib_main_t * vm,
+					 unformat_input_t * input,
+					 vlib_cli_command_t * cmd)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  u32 sw_if_index = ~0;
+  int is_enable = 1, rv;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "%U", unformat_vnet_sw_interface, vnm,
+		    &sw_if_index))
+	;
+      else if (unformat (input, "disable"))
+	is_enable = 0;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (~0 == sw_if_index)
+    return clib_error_return (0, "interface required");
+
+  rv = ip4_flow_cache_enable_disable (sw_if_index, is_enable);
+  if (rv)
+    return clib_error_return (0, "failed: %d", rv);
+
+  return 0;
+}
+
+/*?
+ * Enable or disable the IPv4 flow cache on an interface. The TCP and UDP
+ * flows received on the interface and sent on an interface the cache is
+ * also enabled on are replayed from the cache once their first packet has
+ * been forwarded.
+ *
+ * @cliexpar
+ * @cliexcmd{set interface ip4-flow-cache GigabitEthernet2/0/0}
+ * @cliexcmd{set interface ip4-flow-cache GigabitEthernet2/0/0 disable}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (set_interface_ip4_flow_cache_command, static) = {
+  .path = "set interface ip4-flow-cache",
+  .short_help = "set interface ip4-flow-cache <interface> [disable]",
+  .function = set_interface_ip4_flow_cache_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+ip4_flow_cache_command_fn (vlib_main_t * vm,
+			   unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "refresh %f", &fcm->refresh_interval))
+	;
+      else if (unformat (input, "idle %f", &fcm->idle_timeout))
+	;
+      else if (unformat (input, "max-flows %d", &fcm->max_flows))
+	;
+      else if (unformat (input, "flush"))
+	ip4_flow_cache_invalidate ();
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  return 0;
+}
+
+/*?
+ * Configure the IPv4 flow cache: how often a flow's packets go through
+ * the graph, how long an idle flow stays cached and how many flows a
+ * thread caches. @c flush forgets all the cached flows.
+ *
+ * @cliexpar
+ * @cliexcmd{ip4 flow-cache refresh 5 idle 30}
+ * @cliexcmd{ip4 flow-cache flush}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (ip4_flow_cache_command, static) = {
+  .path = "ip4 flow-cache",
+  .short_help = "ip4 flow-cache [refresh <sec>] [idle <sec>] "
+    "[max-flows <n>] [flush]",
+  .function = ip4_flow_cache_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+show_ip4_flow_cache_command_fn (vlib_main_t * vm,
+				unformat_input_t * input,
+				vlib_cli_command_t * cmd)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+  ip4_flow_cache_per_thread_t *ptd;
+  ip4_flow_cache_entry_t *e;
+  f64 now = vlib_time_now (vm);
+  int verbose = 0;
+  u32 sw_if_index;
+
+  if (unformat (input, "verbose"))
+    verbose = 1;
+
+  vlib_cli_output (vm, "epoch %d, refresh %.1fs, idle %.1fs, max-flows %d",
+		   fcm->epoch, fcm->refresh_interval, fcm->idle_timeout,
+		   fcm->max_flows);
+
+  if (!fcm->is_enabled)
+    {
+      vlib_cli_output (vm, "not enabled");
+      return 0;
+    }
+
+  /* *INDENT-OFF* */
+  clib_bitmap_foreach (sw_if_index, fcm->enabled_by_sw_if_index,
+  ({
+    vlib_cli_output (vm, "enabled on %U", format_vnet_sw_if_index_name,
+		     vnet_get_main (), sw_if_index);
+  }));
+  /* *INDENT-ON* */
+
+  vec_foreach (ptd, fcm->per_thread)
+  {
+    vlib_cli_output (vm, "thread %d: %d flows",
+		     ptd - fcm->per_thread, pool_elts (ptd->entries));
+    if (!verbose)
+      continue;
+    /* *INDENT-OFF* */
+    pool_foreach (e, ptd->entries,
+    ({
+      vlib_cli_output (vm, "  [%d] %U%s", e - ptd->entries,
+		       format_ip4_flow_cache_entry, e, now,
+		       e->epoch != fcm->epoch ? " (stale)" : "");
+    }));
+    /* *INDENT-ON* */
+  }
+
+  return 0;
+}
+
+/*?
+ * Show the IPv4 flow cache and, with @c verbose, the cached flows
+ *
+ * @cliexpar
+ * @cliexcmd{show ip4 flow-cache verbose}
+ ?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (show_ip4_flow_cache_command, static) = {
+  .path = "show ip4 flow-cache",
+  .short_help = "show ip4 flow-cache [verbose]",
+  .function = show_ip4_flow_cache_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+ip4_flow_cache_init (vlib_main_t * vm)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+
+  fcm->vlib_main = vm;
+  fcm->vnet_main = vnet_get_main ();
+  fcm->refresh_interval = IP4_FLOW_CACHE_DEFAULT_REFRESH;
+  fcm->idle_timeout = IP4_FLOW_CACHE_DEFAULT_IDLE;
+  fcm->max_flows = IP4_FLOW_CACHE_DEFAULT_MAX_FLOWS;
+  fcm->table_buckets = IP4_FLOW_CACHE_DEFAULT_BUCKETS;
+  fcm->table_memory = IP4_FLOW_CACHE_DEFAULT_MEMORY;
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (ip4_flow_cache_init);
+
+static clib_error_t *
+ip4_flow_cache_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "buckets %d", &fcm->table_buckets))
+	;
+      else if (unformat (input, "memory-size %U", unformat_memory_size,
+			 &fcm->table_memory))
+	;
+      else if (unformat (input, "max-flows %d", &fcm->max_flows))
+	;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (ip4_flow_cache_config, "ip4-flow-cache");
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IP4_FLOW_CACHE_H__
+#define __IP4_FLOW_CACHE_H__
+
+#include <vnet/ip/ip.h>
+#include <vppinfra/bihash_24_8.h>
+#include <vppinfra/bihash_template.h>
+
+/**
+ * IPv4 flow cache.
+ *
+ * An ip4-unicast input feature that remembers what the rest of the graph
+ * did to the packets of a TCP or UDP flow and replays it for the flow's
+ * later packets in a single node.
+ *
+ * A packet that misses the cache is tagged with its flow and continues
+ * down the feature arc. If it makes it through the input features (ACL,
+ * NAT, ...), the FIB lookup and the rewrite to an output interface that
+ * the cache is enabled on and that has no other output features, the
+ * ip4-flow-cache-learn node on the output arc records the address and port translations applied to it and
+ * its adjacency. The flow's next packets are translated, rewritten and
+ * sent to interface-output by ip4-flow-cache directly.
+ *
+ * Anything that may change a flow's outcome - a FIB or adjacency change,
+ * a feature enabled or disabled, an ACL, classifier or NAT configuration
+ * change - bumps a global epoch that invalidates all the flows learnt
+ * before it. State that comes and goes with the traffic, such as NAT
+ * sessions, removes only its own flows instead. Flows
+ * are also sent through the graph again every refresh interval, which
+ * keeps the stateful features' sessions alive.
+ *
+ * Per-packet work done by the bypassed features, such as policing and
+ * their packet counters, is not replayed.
+ *
+ * Each thread has its own table, which only it reads and writes.
+ */
+
+typedef struct ip4_flow_cache_entry_t_
+{
+  /** the bihash key the entry is stored with */
+  u64 key[3];
+
+  /** the packet's header fields after the graph, network order */
+  ip4_address_t src_address;
+  ip4_address_t dst_address;
+  u16 src_port;
+  u16 dst_port;
+
+  u32 adj_index;
+  u32 epoch;
+  u8 flags;
+
+  f64 learn_time;
+  f64 last_hit_time;
+  u64 n_packets;
+  u64 n_bytes;
+} ip4_flow_cache_entry_t;
+
+#define IP4_FLOW_CACHE_ENTRY_SRC_ADDRESS (1 << 0)
+#define IP4_FLOW_CACHE_ENTRY_DST_ADDRESS (1 << 1)
+#define IP4_FLOW_CACHE_ENTRY_SRC_PORT (1 << 2)
+#define IP4_FLOW_CACHE_ENTRY_DST_PORT (1 << 3)
+
+typedef struct ip4_flow_cache_per_thread_t_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  clib_bihash_24_8_t table;
+  ip4_flow_cache_entry_t *entries;
+  /** next pool index the incremental ager looks at */
+  u32 age_cursor;
+} ip4_flow_cache_per_thread_t;
+
+#define IP4_FLOW_CACHE_DEFAULT_BUCKETS (64 << 10)
+#define IP4_FLOW_CACHE_DEFAULT_MEMORY (64 << 20)
+#define IP4_FLOW_CACHE_DEFAULT_MAX_FLOWS (256 << 10)
+#define IP4_FLOW_CACHE_DEFAULT_REFRESH 10.0
+#define IP4_FLOW_CACHE_DEFAULT_IDLE 60.0
+
+/** Entries the ager looks at per frame */
+#define IP4_FLOW_CACHE_AGE_BATCH 16
+
+typedef struct ip4_flow_cache_main_t_
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  /** Flows learnt in an older epoch are not used */
+  volatile u32 epoch;
+  u8 is_enabled;
+
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline1);
+  ip4_flow_cache_per_thread_t *per_thread;
+
+  /** Seconds between the trips of a flow's packets through the graph */
+  f64 refresh_interval;
+  /** Seconds a flow stays cached without packets */
+  f64 idle_timeout;
+  /** Per thread */
+  u32 max_flows;
+  u32 table_buckets;
+  uword table_memory;
+
+  /** Interfaces the cache is enabled on */
+  uword *enabled_by_sw_if_index;
+
+  vlib_main_t *vlib_main;
+  vnet_main_t *vnet_main;
+} ip4_flow_cache_main_t;
+
+extern ip4_flow_cache_main_t ip4_flow_cache_main;
+extern vlib_node_registration_t ip4_flow_cache_node;
+extern vlib_node_registration_t ip4_flow_cache_learn_node;
+
+extern int ip4_flow_cache_enable_disable (u32 sw_if_index, int is_enable);
+extern void ip4_flow_cache_delete_flow (u32 thread_index, u32 src_address,
+					u32 dst_address, u16 src_port,
+					u16 dst_port, u8 protocol);
+
+/**
+ * Forget all the flows learnt so far. Called by whatever changes the
+ * forwarding state a flow's outcome depends on; cheap enough to call
+ * from the data-path.
+ */
+always_inline void
+ip4_flow_cache_invalidate (void)
+{
+  ip4_flow_cache_main_t *fcm = &ip4_flow_cache_main;
+
+  if (PREDICT_FALSE (fcm->is_enabled))
+    __sync_fetch_and_add (&fcm->epoch, 1);
+}
+
+always_inline void
+ip4_flow_cache_make_key (clib_bihash_kv_24_8_t * kv, u32 src_address,
+			 u32 dst_address, u16 src_port, u16 dst_port,
+			 u8 protocol, u32 rx_sw_if_index)
+{
+  kv->key[0] = (u64) src_address << 32 | dst_address;
+  kv->key[1] = (u64) src_port << 48 | (u64) dst_port << 32 | rx_sw_if_index;
+  kv->key[2] = protocol;
+}
+
+#endif /* __IP4_FLOW_CACHE_H__ */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -88,9 +88,8 @@
       ip_adjacency_t @c adj->lookup_next_index
       (where @c adj is the lookup result adjacency).
 */
-static uword
-ip4_lookup (vlib_main_t * vm,
-	    vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_lookup_node) (vlib_main_t * vm, vlib_node_runtime_t * node,
+				vlib_frame_t * frame)
 {
   return ip4_lookup_inline (vm, node, frame,
 			    /* lookup_for_responses_to_locally_received_packets */
@@ -98,12 +97,12 @@ ip4_lookup (vlib_main_t * vm,
 
 }
 
+#ifndef CLIB_MARCH_VARIANT
 static u8 *format_ip4_lookup_trace (u8 * s, va_list * args);
 
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (ip4_lookup_node) =
 {
-  .function = ip4_lookup,
   .name = "ip4-lookup",
   .vector_size = sizeof (u32),
   .format_trace = format_ip4_lookup_trace,
@@ -111,12 +110,11 @@ VLIB_REGISTER_NODE (ip4_lookup_node) =
   .next_nodes = IP4_LOOKUP_NEXT_NODES,
 };
 /* *INDENT-ON* */
+#endif /* CLIB_MARCH_VARIANT */
 
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_lookup_node, ip4_lookup);
-
-static uword
-ip4_load_balance (vlib_main_t * vm,
-		  vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_load_balance_node) (vlib_main_t * vm,
+				      vlib_node_runtime_t * node,
+				      vlib_frame_t * frame)
 {
   vlib_combined_counter_main_t *cm = &load_balance_main.lbm_via_counters;
   u32 n_left_from, n_left_to_next, *from, *to_next;
@@ -301,10 +299,10 @@ ip4_load_balance (vlib_main_t * vm,
   return frame->n_vectors;
 }
 
+#ifndef CLIB_MARCH_VARIANT
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (ip4_load_balance_node) =
 {
-  .function = ip4_load_balance,
   .name = "ip4-load-balance",
   .vector_size = sizeof (u32),
   .sibling_of = "ip4-lookup",
@@ -313,8 +311,6 @@ VLIB_REGISTER_NODE (ip4_load_balance_node) =
 };
 /* *INDENT-ON* */
 
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_load_balance_node, ip4_load_balance);
-
 /* get first interface address */
 ip4_address_t *
 ip4_interface_first_address (ip4_main_t * im, u32 sw_if_index,
@@ -1058,6 +1054,7 @@ ip4_tcp_udp_compute_checksum (vlib_main_t * vm, vlib_buffer_t * p0,
   ip_csum_t sum0;
   u32 ip_header_length, payload_length_host_byte_order;
   u32 n_this_buffer, n_bytes_left, n_ip_bytes_this_buffer;
+  u32 is_odd = 0;
   u16 sum16;
   void *data_this_buffer;
 
@@ -1091,17 +1088,25 @@ ip4_tcp_udp_compute_checksum (vlib_main_t * vm, vlib_buffer_t * p0,
       n_this_buffer = n_ip_bytes_this_buffer > ip_header_length ?
 	n_ip_bytes_this_buffer - ip_header_length : 0;
     }
-  while (1)
-    {
-      sum0 = ip_incremental_checksum (sum0, data_this_buffer, n_this_buffer);
-      n_bytes_left -= n_this_buffer;
-      if (n_bytes_left == 0)
-	break;
+  sum0 = ip_incremental_checksum (sum0, data_this_buffer, n_this_buffer);
+  n_bytes_left -= n_this_buffer;
 
+  /* Rest of a chained packet; a buffer that follows an odd number of
+     bytes has its bytes swapped in the 16 bit sum. */
+  while (PREDICT_FALSE (n_bytes_left))
+    {
       ASSERT (p0->flags & VLIB_BUFFER_NEXT_PRESENT);
+      is_odd ^= n_this_buffer & 1;
       p0 = vlib_get_buffer (vm, p0->next_buffer);
       data_this_buffer = vlib_buffer_get_current (p0);
-      n_this_buffer = p0->current_length;
+      n_this_buffer = clib_min (p0->current_length, n_bytes_left);
+      if (!is_odd)
+	sum0 = ip_incremental_checksum (sum0, data_this_buffer,
+					n_this_buffer);
+      else
+	sum0 = ip_incremental_checksum_odd (sum0, data_this_buffer,
+					    n_this_buffer);
+      n_bytes_left -= n_this_buffer;
     }
 
   sum16 = ~ip_csum_fold (sum0);
@@ -1142,6 +1147,9 @@ VNET_FEATURE_ARC_INIT (ip4_local) =
   .start_nodes = VNET_FEATURES ("ip4-local"),
 };
 /* *INDENT-ON* */
+#else
+extern vnet_feature_arc_registration_t vnet_feat_arc_ip4_local;
+#endif /* CLIB_MARCH_VARIANT */
 
 static inline void
 ip4_local_l4_csum_validate (vlib_main_t * vm, vlib_buffer_t * p,
@@ -1528,16 +1536,16 @@ ip4_local_inline (vlib_main_t * vm,
   return frame->n_vectors;
 }
 
-static uword
-ip4_local (vlib_main_t * vm, vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_local_node) (vlib_main_t * vm, vlib_node_runtime_t * node,
+			       vlib_frame_t * frame)
 {
   return ip4_local_inline (vm, node, frame, 1 /* head of feature arc */ );
 }
 
+#ifndef CLIB_MARCH_VARIANT
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (ip4_local_node) =
 {
-  .function = ip4_local,
   .name = "ip4-local",
   .vector_size = sizeof (u32),
   .format_trace = format_ip4_forward_next_trace,
@@ -1551,19 +1559,18 @@ VLIB_REGISTER_NODE (ip4_local_node) =
   },
 };
 /* *INDENT-ON* */
+#endif /* CLIB_MARCH_VARIANT */
 
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_local_node, ip4_local);
-
-static uword
-ip4_local_end_of_arc (vlib_main_t * vm,
-		      vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_local_end_of_arc_node) (vlib_main_t * vm,
+					  vlib_node_runtime_t * node,
+					  vlib_frame_t * frame)
 {
   return ip4_local_inline (vm, node, frame, 0 /* head of feature arc */ );
 }
 
+#ifndef CLIB_MARCH_VARIANT
 /* *INDENT-OFF* */
-VLIB_REGISTER_NODE (ip4_local_end_of_arc_node,static) = {
-  .function = ip4_local_end_of_arc,
+VLIB_REGISTER_NODE (ip4_local_end_of_arc_node) = {
   .name = "ip4-local-end-of-arc",
   .vector_size = sizeof (u32),
 
@@ -1571,8 +1578,6 @@ VLIB_REGISTER_NODE (ip4_local_end_of_arc_node,static) = {
   .sibling_of = "ip4-local",
 };
 
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_local_end_of_arc_node, ip4_local_end_of_arc)
-
 VNET_FEATURE_INIT (ip4_local_end_of_arc, static) = {
   .arc_name = "ip4-local",
   .node_name = "ip4-local-end-of-arc",
@@ -1637,6 +1642,7 @@ VLIB_CLI_COMMAND (show_ip_local, static) =
   .short_help = "show ip local",
 };
 /* *INDENT-ON* */
+#endif /* CLIB_MARCH_VARIANT */
 
 always_inline uword
 ip4_arp_inline (vlib_main_t * vm,
@@ -1840,18 +1846,19 @@ ip4_arp_inline (vlib_main_t * vm,
   return frame->n_vectors;
 }
 
-static uword
-ip4_arp (vlib_main_t * vm, vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_arp_node) (vlib_main_t * vm, vlib_node_runtime_t * node,
+			     vlib_frame_t * frame)
 {
   return (ip4_arp_inline (vm, node, frame, 0));
 }
 
-static uword
-ip4_glean (vlib_main_t * vm, vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_glean_node) (vlib_main_t * vm, vlib_node_runtime_t * node,
+			       vlib_frame_t * frame)
 {
   return (ip4_arp_inline (vm, node, frame, 1));
 }
 
+#ifndef CLIB_MARCH_VARIANT
 static char *ip4_arp_error_strings[] = {
   [IP4_ARP_ERROR_DROP] = "address overflow drops",
   [IP4_ARP_ERROR_REQUEST_SENT] = "ARP requests sent",
@@ -1864,7 +1871,6 @@ static char *ip4_arp_error_strings[] = {
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (ip4_arp_node) =
 {
-  .function = ip4_arp,
   .name = "ip4-arp",
   .vector_size = sizeof (u32),
   .format_trace = format_ip4_forward_next_trace,
@@ -1879,7 +1885,6 @@ VLIB_REGISTER_NODE (ip4_arp_node) =
 
 VLIB_REGISTER_NODE (ip4_glean_node) =
 {
-  .function = ip4_glean,
   .name = "ip4-glean",
   .vector_size = sizeof (u32),
   .format_trace = format_ip4_forward_next_trace,
@@ -2024,6 +2029,7 @@ ip4_probe_neighbor (vlib_main_t * vm, ip4_address_t * dst, u32 sw_if_index,
   adj_unlock (ai);
   return /* no error */ 0;
 }
+#endif /* CLIB_MARCH_VARIANT */
 
 typedef enum
 {
@@ -2068,6 +2074,23 @@ ip4_mtu_check (vlib_buffer_t * b, u16 packet_len,
     }
 }
 
+/* Bytes from the current data to the end of a packet being rewritten,
+   for the adjacency counters. Single buffers and chains which carry
+   their length don't walk; other chains are measured by their IP
+   header rather than walked buffer by buffer. */
+always_inline u32
+ip4_rewrite_length_in_chain (vlib_buffer_t * b, ip4_header_t * ip)
+{
+  if (PREDICT_TRUE (!(b->flags & VLIB_BUFFER_NEXT_PRESENT)))
+    return b->current_length;
+
+  if (PREDICT_TRUE (b->flags & VLIB_BUFFER_TOTAL_LENGTH_VALID))
+    return b->current_length + b->total_length_not_including_first_buffer;
+
+  return ((u8 *) ip - (u8 *) vlib_buffer_get_current (b)) +
+    clib_net_to_host_u16 (ip->length);
+}
+
 always_inline uword
 ip4_rewrite_inline (vlib_main_t * vm,
 		    vlib_node_runtime_t * node,
@@ -2294,13 +2317,13 @@ ip4_rewrite_inline (vlib_main_t * vm,
 		(&adjacency_counters,
 		 thread_index,
 		 adj_index0, 1,
-		 vlib_buffer_length_in_chain (vm, p0) + rw_len0);
+		 ip4_rewrite_length_in_chain (p0, ip0) + rw_len0);
 
 	      vlib_increment_combined_counter
 		(&adjacency_counters,
 		 thread_index,
 		 adj_index1, 1,
-		 vlib_buffer_length_in_chain (vm, p1) + rw_len1);
+		 ip4_rewrite_length_in_chain (p1, ip1) + rw_len1);
 	    }
 
 	  if (is_midchain)
@@ -2418,7 +2441,7 @@ ip4_rewrite_inline (vlib_main_t * vm,
 	    vlib_increment_combined_counter
 	      (&adjacency_counters,
 	       thread_index, adj_index0, 1,
-	       vlib_buffer_length_in_chain (vm, p0) + rw_len0);
+	       ip4_rewrite_length_in_chain (p0, ip0) + rw_len0);
 
 	  /* Check MTU of outgoing interface. */
 	  ip4_mtu_check (p0, clib_net_to_host_u16 (ip0->length),
@@ -2511,9 +2534,9 @@ ip4_rewrite_inline (vlib_main_t * vm,
     - <code> adj->rewrite_header.next_index </code>
       or @c ip4-drop
 */
-static uword
-ip4_rewrite (vlib_main_t * vm,
-	     vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_rewrite_node) (vlib_main_t * vm,
+				 vlib_node_runtime_t * node,
+				 vlib_frame_t * frame)
 {
   if (adj_are_counters_enabled ())
     return ip4_rewrite_inline (vm, node, frame, 1, 0, 0);
@@ -2521,9 +2544,9 @@ ip4_rewrite (vlib_main_t * vm,
     return ip4_rewrite_inline (vm, node, frame, 0, 0, 0);
 }
 
-static uword
-ip4_midchain (vlib_main_t * vm,
-	      vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_midchain_node) (vlib_main_t * vm,
+				  vlib_node_runtime_t * node,
+				  vlib_frame_t * frame)
 {
   if (adj_are_counters_enabled ())
     return ip4_rewrite_inline (vm, node, frame, 1, 1, 0);
@@ -2531,9 +2554,9 @@ ip4_midchain (vlib_main_t * vm,
     return ip4_rewrite_inline (vm, node, frame, 0, 1, 0);
 }
 
-static uword
-ip4_rewrite_mcast (vlib_main_t * vm,
-		   vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_rewrite_mcast_node) (vlib_main_t * vm,
+				       vlib_node_runtime_t * node,
+				       vlib_frame_t * frame)
 {
   if (adj_are_counters_enabled ())
     return ip4_rewrite_inline (vm, node, frame, 1, 0, 1);
@@ -2541,9 +2564,9 @@ ip4_rewrite_mcast (vlib_main_t * vm,
     return ip4_rewrite_inline (vm, node, frame, 0, 0, 1);
 }
 
-static uword
-ip4_mcast_midchain (vlib_main_t * vm,
-		    vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (ip4_mcast_midchain_node) (vlib_main_t * vm,
+					vlib_node_runtime_t * node,
+					vlib_frame_t * frame)
 {
   if (adj_are_counters_enabled ())
     return ip4_rewrite_inline (vm, node, frame, 1, 1, 1);
@@ -2551,9 +2574,9 @@ ip4_mcast_midchain (vlib_main_t * vm,
     return ip4_rewrite_inline (vm, node, frame, 0, 1, 1);
 }
 
+#ifndef CLIB_MARCH_VARIANT
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (ip4_rewrite_node) = {
-  .function = ip4_rewrite,
   .name = "ip4-rewrite",
   .vector_size = sizeof (u32),
 
@@ -2566,36 +2589,29 @@ VLIB_REGISTER_NODE (ip4_rewrite_node) = {
     [IP4_REWRITE_NEXT_FRAGMENT] = "ip4-frag",
   },
 };
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_rewrite_node, ip4_rewrite)
 
 VLIB_REGISTER_NODE (ip4_rewrite_mcast_node) = {
-  .function = ip4_rewrite_mcast,
   .name = "ip4-rewrite-mcast",
   .vector_size = sizeof (u32),
 
   .format_trace = format_ip4_rewrite_trace,
   .sibling_of = "ip4-rewrite",
 };
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_rewrite_mcast_node, ip4_rewrite_mcast)
 
-VLIB_REGISTER_NODE (ip4_mcast_midchain_node, static) = {
-  .function = ip4_mcast_midchain,
+VLIB_REGISTER_NODE (ip4_mcast_midchain_node) = {
   .name = "ip4-mcast-midchain",
   .vector_size = sizeof (u32),
 
   .format_trace = format_ip4_rewrite_trace,
   .sibling_of = "ip4-rewrite",
 };
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_mcast_midchain_node, ip4_mcast_midchain)
 
 VLIB_REGISTER_NODE (ip4_midchain_node) = {
-  .function = ip4_midchain,
   .name = "ip4-midchain",
   .vector_size = sizeof (u32),
   .format_trace = format_ip4_forward_next_trace,
   .sibling_of =  "ip4-rewrite",
 };
-VLIB_NODE_FUNCTION_MULTIARCH (ip4_midchain_node, ip4_midchain);
 /* *INDENT-ON */
 
 int
@@ -2992,6 +3008,7 @@ ip4_config (vlib_main_t * vm, unformat_input_t * input)
 }
 
 VLIB_EARLY_CONFIG_FUNCTION (ip4_config, "ip");
+#endif /* CLIB_MARCH_VARIANT */
 
 /*
  * fd.io coding-style-patch-verification: ON
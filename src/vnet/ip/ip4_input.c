@@ -156,6 +156,29 @@ ip4_input_inline (vlib_main_t * vm,
     {
       u32 x = 0;
 
+#ifdef CLIB_HAVE_VEC256
+      /* 8 packets from the same interface as the previous ones, without
+         features and with nothing unusual in their headers */
+      if (n_left_from >= 8 && !arc_enabled &&
+	  ip4_input_check_x8 (b, next, last_sw_if_index, verify_checksum))
+	{
+	  if (n_left_from >= 16)
+	    {
+	      int i;
+	      for (i = 8; i < 16; i++)
+		{
+		  vlib_prefetch_buffer_header (b[i], LOAD);
+		  CLIB_PREFETCH (b[i]->data, sizeof (ip4_header_t), LOAD);
+		}
+	    }
+	  cnt += 8;
+	  b += 8;
+	  next += 8;
+	  n_left_from -= 8;
+	  continue;
+	}
+#endif
+
       /* Prefetch next iteration. */
       if (n_left_from >= 12)
 	{
@@ -77,6 +77,82 @@ check_ver_opt_csum (ip4_header_t * ip, u8 * error, int verify_checksum)
     *error = IP4_ERROR_BAD_CHECKSUM;
 }
 
+#ifdef CLIB_HAVE_VEC256
+/* Checks 8 packets received on sw_if_index at once. Returns 1 and sets
+   next[0..7] to ip4-lookup or ip4-mfib-forward-lookup when all of them
+   are plain unfragmented ip4 packets with a valid header, returns 0 and
+   leaves the buffers untouched otherwise so that the caller handles
+   them one by one. */
+static_always_inline int
+ip4_input_check_x8 (vlib_buffer_t ** b, u16 * next, u32 sw_if_index,
+		    int verify_checksum)
+{
+  u32x8 w0, w1, w2, w3, w4, len, bad, mcast, nx;
+  int i;
+
+  bad = vlib_buffer_gather_u32_x8 (b, STRUCT_OFFSET_OF (vlib_buffer_t,
+							flags));
+  bad &= u32x8_splat (VLIB_BUFFER_NEXT_PRESENT);
+  bad |= vlib_buffer_gather_u32_x8 (b, STRUCT_OFFSET_OF (vlib_buffer_t,
+							 opaque) +
+				    STRUCT_OFFSET_OF (vnet_buffer_opaque_t,
+						      sw_if_index[VLIB_RX])) ^
+    u32x8_splat (sw_if_index);
+
+  /* the 5 words of a 20 byte header, little endian loads of network
+     order data */
+  w0 = vlib_buffer_gather_current_u32_x8 (b, 0);
+  w1 = vlib_buffer_gather_current_u32_x8 (b, 4);
+  w2 = vlib_buffer_gather_current_u32_x8 (b, 8);
+  w3 = vlib_buffer_gather_current_u32_x8 (b, 12);
+  w4 = vlib_buffer_gather_current_u32_x8 (b, 16);
+
+  /* version 4, no options */
+  bad |= (w0 & u32x8_splat (0xff)) ^ u32x8_splat (0x45);
+
+  /* ttl */
+  bad |= (u32x8) ((w2 & u32x8_splat (0xff)) == u32x8_splat (0));
+
+  /* fragment offset 1 */
+  bad |= (u32x8) (((w1 >> 16) & u32x8_splat (0xff1f)) ==
+		  u32x8_splat (0x0100));
+
+  /* ip length, at least a header and no more than the buffer */
+  len = ((w0 >> 8) & u32x8_splat (0xff00)) | (w0 >> 24);
+  bad |= (u32x8) (len < u32x8_splat (sizeof (ip4_header_t)));
+  bad |= (u32x8) (len > (vlib_buffer_gather_u32_x8
+			 (b, STRUCT_OFFSET_OF (vlib_buffer_t,
+					       current_data)) >> 16));
+
+  if (verify_checksum)
+    {
+      u32x8 sum, mask = u32x8_splat (0xffff);
+      sum = (w0 & mask) + (w0 >> 16) + (w1 & mask) + (w1 >> 16) +
+	(w2 & mask) + (w2 >> 16) + (w3 & mask) + (w3 >> 16) +
+	(w4 & mask) + (w4 >> 16);
+      sum = (sum & mask) + (sum >> 16);
+      sum = (sum & mask) + (sum >> 16);
+      bad |= sum ^ mask;
+    }
+
+  if (!u32x8_is_all_zero (bad))
+    return 0;
+
+  /* 224.0.0.0/4 */
+  mcast = (u32x8) ((w4 & u32x8_splat (0xf0)) == u32x8_splat (0xe0));
+  nx = (mcast & u32x8_splat (IP4_INPUT_NEXT_LOOKUP_MULTICAST)) |
+    (~mcast & u32x8_splat (IP4_INPUT_NEXT_LOOKUP));
+
+  for (i = 0; i < 8; i++)
+    {
+      vnet_buffer (b[i])->ip.adj_index[VLIB_RX] = ~0;
+      next[i] = nx[i];
+    }
+
+  return 1;
+}
+#endif
+
 always_inline void
 ip4_input_check_x4 (vlib_main_t * vm,
 		    vlib_node_runtime_t * error_node,
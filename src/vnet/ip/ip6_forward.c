@@ -912,7 +912,7 @@ ip6_tcp_udp_icmp_compute_checksum (vlib_main_t * vm, vlib_buffer_t * p0,
 {
   ip_csum_t sum0;
   u16 sum16, payload_length_host_byte_order;
-  u32 i, n_this_buffer, n_bytes_left;
+  u32 i, n_this_buffer, n_bytes_left, is_odd = 0;
   u32 headers_size = sizeof (ip0[0]);
   void *data_this_buffer;
 
@@ -962,7 +962,12 @@ ip6_tcp_udp_icmp_compute_checksum (vlib_main_t * vm, vlib_buffer_t * p0,
       headers_size ? p0->current_length - headers_size : 0;
   while (1)
     {
-      sum0 = ip_incremental_checksum (sum0, data_this_buffer, n_this_buffer);
+      if (PREDICT_TRUE (!is_odd))
+	sum0 = ip_incremental_checksum (sum0, data_this_buffer,
+					n_this_buffer);
+      else
+	sum0 = ip_incremental_checksum_odd (sum0, data_this_buffer,
+					    n_this_buffer);
       n_bytes_left -= n_this_buffer;
       if (n_bytes_left == 0)
 	break;
@@ -972,9 +977,12 @@ ip6_tcp_udp_icmp_compute_checksum (vlib_main_t * vm, vlib_buffer_t * p0,
 	  *bogus_lengthp = 1;
 	  return 0xfefe;
 	}
+      /* A buffer that follows an odd number of bytes has its bytes
+         swapped in the 16 bit sum. */
+      is_odd ^= n_this_buffer & 1;
       p0 = vlib_get_buffer (vm, p0->next_buffer);
       data_this_buffer = vlib_buffer_get_current (p0);
-      n_this_buffer = p0->current_length;
+      n_this_buffer = clib_min (p0->current_length, n_bytes_left);
     }
 
   sum16 = ~ip_csum_fold (sum0);
@@ -256,6 +256,16 @@ ip_incremental_checksum (ip_csum_t sum, void *_data, uword n_bytes)
   return (*vnet_incremental_checksum_fp) (sum, _data, n_bytes);
 }
 
+/* Checksum data starting at an odd offset into the checksummed bytes, as
+   the next buffer of a chain after an odd number of bytes. Its 16 bit
+   words are byte swapped with respect to the checksum's. */
+always_inline ip_csum_t
+ip_incremental_checksum_odd (ip_csum_t sum, void *_data, uword n_bytes)
+{
+  u16 sum16 = ip_csum_fold (ip_incremental_checksum (0, _data, n_bytes));
+  return ip_csum_with_carry (sum, clib_byte_swap_u16 (sum16));
+}
+
 always_inline u16
 ip_csum_and_memcpy_fold (ip_csum_t sum, void *dst)
 {
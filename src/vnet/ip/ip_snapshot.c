@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief IP state in warm restart snapshots.
+ *
+ * The "ip" section holds the tables, the interface to table bindings,
+ * the interface addresses and the API and CLI sourced routes. Routes
+ * contributed by other sources (interfaces, adjacencies, plugins...)
+ * come back when their owner is restored. The "ip-neighbor" section
+ * holds the ARP and ND entries, from which the adjacencies are rebuilt.
+ */
+
+#include <vnet/snapshot/snapshot.h>
+#include <vnet/ip/ip.h>
+#include <vnet/ip/ip6_neighbor.h>
+#include <vnet/ethernet/arp.h>
+#include <vnet/ethernet/arp_packet.h>
+#include <vnet/fib/fib_table.h>
+#include <vnet/fib/fib_entry.h>
+#include <vnet/fib/fib_path_ext.h>
+#include <vnet/dpo/ip_null_dpo.h>
+#include <vnet/dpo/receive_dpo.h>
+#include <vnet/dpo/drop_dpo.h>
+
+/**
+ * How a saved route forwards
+ */
+typedef enum ip_snapshot_route_type_t_
+{
+  IP_SNAPSHOT_ROUTE_PATHS,
+  IP_SNAPSHOT_ROUTE_NULL,
+  IP_SNAPSHOT_ROUTE_LOCAL,
+  IP_SNAPSHOT_ROUTE_SPECIAL,
+} ip_snapshot_route_type_t;
+
+typedef struct ip_snapshot_walk_ctx_t_
+{
+  serialize_main_t *m;
+  fib_protocol_t fproto;
+  u32 table_id;
+  fib_node_index_t *feis;
+} ip_snapshot_walk_ctx_t;
+
+static fib_table_t *
+ip_snapshot_tables (fib_protocol_t fproto)
+{
+  return (FIB_PROTOCOL_IP4 == fproto ? ip4_main.fibs : ip6_main.fibs);
+}
+
+static ip_lookup_main_t *
+ip_snapshot_lookup_main (fib_protocol_t fproto)
+{
+  return (FIB_PROTOCOL_IP4 == fproto ?
+	  &ip4_main.lookup_main : &ip6_main.lookup_main);
+}
+
+static fib_table_walk_rc_t
+ip_snapshot_route_collect (fib_node_index_t fei, void *arg)
+{
+  ip_snapshot_walk_ctx_t *ctx = arg;
+  fib_source_t src;
+
+  src = fib_entry_get_best_source (fei);
+  if (FIB_SOURCE_API == src || FIB_SOURCE_CLI == src)
+    vec_add1 (ctx->feis, fei);
+
+  return (FIB_TABLE_WALK_CONTINUE);
+}
+
+/**
+ * Paths which can be written by value: IP next-hops, interfaces and
+ * tables. MPLS labels, UDP encaps and BIER state are owned by other
+ * subsystems and not in the snapshot, so such routes are skipped.
+ */
+static int
+ip_snapshot_route_is_saveable (fib_node_index_t fei, fib_source_t src,
+			       fib_route_path_encode_t * rpaths)
+{
+  fib_route_path_encode_t *rpath;
+  fib_entry_src_t *esrc;
+  fib_path_ext_t *ext;
+  fib_entry_t *fe;
+
+  fe = fib_entry_get (fei);
+  vec_foreach (esrc, fe->fe_srcs)
+  {
+    if (esrc->fes_src != src)
+      continue;
+    vec_foreach (ext, esrc->fes_path_exts.fpel_exts)
+    {
+      if (FIB_PATH_EXT_MPLS == ext->fpe_type)
+	return (0);
+    }
+  }
+
+  vec_foreach (rpath, rpaths)
+  {
+    if (rpath->rpath.frp_proto != DPO_PROTO_IP4 &&
+	rpath->rpath.frp_proto != DPO_PROTO_IP6)
+      return (0);
+    if (rpath->rpath.frp_flags & FIB_ROUTE_PATH_UDP_ENCAP)
+      return (0);
+  }
+
+  return (1);
+}
+
+static int
+ip_snapshot_save_route (ip_snapshot_walk_ctx_t * ctx, fib_node_index_t fei)
+{
+  fib_route_path_encode_t *rpaths = NULL, *rpath;
+  ip_snapshot_route_type_t type;
+  serialize_main_t *m = ctx->m;
+  fib_entry_flag_t flags;
+  fib_prefix_t pfx;
+  fib_source_t src;
+  u32 action = 0;
+  int saved = 0;
+
+  src = fib_entry_get_best_source (fei);
+  flags = fib_entry_get_flags_for_source (fei, src);
+  fib_entry_get_prefix (fei, &pfx);
+  fib_entry_encode (fei, &rpaths);
+
+  if ((flags & FIB_ENTRY_FLAG_EXCLUSIVE) && vec_len (rpaths))
+    {
+      dpo_id_t *dpo = &rpaths[0].dpo;
+
+      if (DPO_IP_NULL == dpo->dpoi_type)
+	{
+	  type = IP_SNAPSHOT_ROUTE_NULL;
+	  action = ip_null_dpo_get_action (dpo->dpoi_index);
+	}
+      else if (DPO_RECEIVE == dpo->dpoi_type)
+	type = IP_SNAPSHOT_ROUTE_LOCAL;
+      else
+	{
+	  /* classify and other DPOs refer to state not saved */
+	  vnet_snapshot_skip ();
+	  goto done;
+	}
+    }
+  else if (flags & (FIB_ENTRY_FLAG_DROP | FIB_ENTRY_FLAG_LOCAL))
+    type = IP_SNAPSHOT_ROUTE_SPECIAL;
+  else if (ip_snapshot_route_is_saveable (fei, src, rpaths))
+    type = IP_SNAPSHOT_ROUTE_PATHS;
+  else
+    {
+      vnet_snapshot_skip ();
+      goto done;
+    }
+
+  serialize_integer (m, ctx->table_id, sizeof (u32));
+  serialize_integer (m, pfx.fp_len, sizeof (u8));
+  serialize_vnet_snapshot_data (m, &pfx.fp_addr, sizeof (pfx.fp_addr));
+  serialize_integer (m, src, sizeof (u8));
+  serialize_integer (m, flags, sizeof (u32));
+  serialize_integer (m, type, sizeof (u8));
+
+  switch (type)
+    {
+    case IP_SNAPSHOT_ROUTE_NULL:
+      serialize_integer (m, action, sizeof (u8));
+      break;
+    case IP_SNAPSHOT_ROUTE_LOCAL:
+    case IP_SNAPSHOT_ROUTE_SPECIAL:
+      break;
+    case IP_SNAPSHOT_ROUTE_PATHS:
+      serialize_likely_small_unsigned_integer (m, vec_len (rpaths));
+      vec_foreach (rpath, rpaths)
+      {
+	fib_route_path_t *p = &rpath->rpath;
+	u32 table_id = ~0;
+
+	/* recursive and deag paths name the table they look up in */
+	if (~0 == p->frp_sw_if_index)
+	  table_id = fib_table_get_table_id (p->frp_fib_index,
+					     dpo_proto_to_fib (p->frp_proto));
+
+	serialize_integer (m, p->frp_proto, sizeof (u8));
+	serialize_vnet_snapshot_data (m, &p->frp_addr, sizeof (p->frp_addr));
+	serialize_vnet_snapshot_sw_if_index (m, p->frp_sw_if_index);
+	serialize_integer (m, table_id, sizeof (u32));
+	serialize_integer (m, p->frp_weight, sizeof (u8));
+	serialize_integer (m, p->frp_preference, sizeof (u8));
+	serialize_integer (m, p->frp_flags, sizeof (u32));
+      }
+      break;
+    }
+  saved = 1;
+
+done:
+  vec_free (rpaths);
+  return (saved);
+}
+
+static void
+ip_snapshot_save_routes (serialize_main_t * m, fib_protocol_t fproto)
+{
+  ip_snapshot_walk_ctx_t ctx = {
+    .fproto = fproto,
+  };
+  fib_node_index_t *fei;
+  fib_table_t *fib;
+  serialize_main_t rm;
+  u32 n_routes = 0;
+  u8 *routes;
+
+  /*
+   * The count goes ahead of the routes but is known only once they
+   * have been filtered, so write them aside first.
+   */
+  serialize_open_vector (&rm, 0);
+  ctx.m = &rm;
+
+  /* *INDENT-OFF* */
+  pool_foreach (fib, ip_snapshot_tables (fproto),
+  ({
+    if (fib->ft_flags & FIB_TABLE_FLAG_IP6_LL)
+      continue;
+    vec_reset_length (ctx.feis);
+    ctx.table_id = fib->ft_table_id;
+    fib_table_walk (fib->ft_index, fproto, ip_snapshot_route_collect, &ctx);
+    vec_foreach (fei, ctx.feis)
+      n_routes += ip_snapshot_save_route (&ctx, *fei);
+  }));
+  /* *INDENT-ON* */
+
+  routes = serialize_close_vector (&rm);
+  serialize_likely_small_unsigned_integer (m, n_routes);
+  serialize_vnet_snapshot_data (m, routes, vec_len (routes));
+
+  vec_free (routes);
+  vec_free (ctx.feis);
+}
+
+static void
+ip_snapshot_restore_routes (serialize_main_t * m, fib_protocol_t fproto)
+{
+  fib_route_path_t *rpaths = NULL, *p;
+  u32 n_routes, n_paths, table_id, fib_index, action, type;
+  fib_entry_flag_t flags;
+  fib_source_t src;
+  fib_prefix_t pfx;
+  int skip;
+
+  n_routes = unserialize_likely_small_unsigned_integer (m);
+  while (n_routes--)
+    {
+      memset (&pfx, 0, sizeof (pfx));
+      pfx.fp_proto = fproto;
+      table_id = flags = src = type = action = 0;
+
+      unserialize_integer (m, &table_id, sizeof (u32));
+      unserialize_integer (m, &pfx.fp_len, sizeof (u8));
+      unserialize_vnet_snapshot_data (m, &pfx.fp_addr, sizeof (pfx.fp_addr));
+      unserialize_integer (m, &src, sizeof (u8));
+      unserialize_integer (m, &flags, sizeof (u32));
+      unserialize_integer (m, &type, sizeof (u8));
+
+      skip = 0;
+      vec_reset_length (rpaths);
+      switch (type)
+	{
+	case IP_SNAPSHOT_ROUTE_NULL:
+	  unserialize_integer (m, &action, sizeof (u8));
+	  break;
+	case IP_SNAPSHOT_ROUTE_LOCAL:
+	case IP_SNAPSHOT_ROUTE_SPECIAL:
+	  break;
+	case IP_SNAPSHOT_ROUTE_PATHS:
+	  n_paths = unserialize_likely_small_unsigned_integer (m);
+	  while (n_paths--)
+	    {
+	      u32 nh_table_id = 0;
+
+	      vec_add2 (rpaths, p, 1);
+	      memset (p, 0, sizeof (*p));
+	      unserialize_integer (m, &p->frp_proto, sizeof (u8));
+	      unserialize_vnet_snapshot_data (m, &p->frp_addr,
+					      sizeof (p->frp_addr));
+	      skip |= unserialize_vnet_snapshot_sw_if_index
+		(m, &p->frp_sw_if_index);
+	      unserialize_integer (m, &nh_table_id, sizeof (u32));
+	      unserialize_integer (m, &p->frp_weight, sizeof (u8));
+	      unserialize_integer (m, &p->frp_preference, sizeof (u8));
+	      unserialize_integer (m, &p->frp_flags, sizeof (u32));
+
+	      if (~0 != nh_table_id)
+		{
+		  p->frp_fib_index =
+		    fib_table_find (dpo_proto_to_fib (p->frp_proto),
+				    nh_table_id);
+		  if (~0 == p->frp_fib_index)
+		    skip = 1;
+		  else if (ip46_address_is_zero (&p->frp_addr))
+		    p->frp_flags |= FIB_ROUTE_PATH_DEAG;
+		}
+	    }
+	  break;
+	default:
+	  serialize_error_return (m, "unknown route type %d", type);
+	}
+
+      fib_index = fib_table_find (fproto, table_id);
+      if (skip || ~0 == fib_index)
+	{
+	  vnet_snapshot_skip ();
+	  continue;
+	}
+
+      switch (type)
+	{
+	case IP_SNAPSHOT_ROUTE_NULL:
+	case IP_SNAPSHOT_ROUTE_LOCAL:
+	  {
+	    dpo_proto_t dproto = fib_proto_to_dpo (fproto);
+	    dpo_id_t dpo = DPO_INVALID;
+
+	    if (IP_SNAPSHOT_ROUTE_NULL == type)
+	      ip_null_dpo_add_and_lock (dproto, action, &dpo);
+	    else
+	      receive_dpo_add_or_lock (dproto, ~0, NULL, &dpo);
+
+	    fib_table_entry_special_dpo_update (fib_index, &pfx, src,
+						FIB_ENTRY_FLAG_EXCLUSIVE,
+						&dpo);
+	    dpo_reset (&dpo);
+	  }
+	  break;
+	case IP_SNAPSHOT_ROUTE_SPECIAL:
+	  fib_table_entry_special_add (fib_index, &pfx, src,
+				       flags & (FIB_ENTRY_FLAG_DROP |
+						FIB_ENTRY_FLAG_LOCAL));
+	  break;
+	case IP_SNAPSHOT_ROUTE_PATHS:
+	  fib_table_entry_update (fib_index, &pfx, src,
+				  flags & FIB_ENTRY_FLAG_MULTICAST, rpaths);
+	  break;
+	}
+    }
+
+  vec_free (rpaths);
+}
+
+static void
+ip_snapshot_save (serialize_main_t * m, va_list * va)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  ip_interface_address_t *ia;
+  fib_protocol_t fproto;
+  ip_lookup_main_t *lm;
+  fib_table_t *fib;
+  u32 i, n, *fib_index;
+
+  FOR_EACH_FIB_IP_PROTOCOL (fproto)
+  {
+    /* tables added by the API or the CLI */
+    n = 0;
+    /* *INDENT-OFF* */
+    pool_foreach (fib, ip_snapshot_tables (fproto),
+    ({
+      n += (0 != fib->ft_table_id &&
+	    (fib->ft_locks[FIB_SOURCE_API] || fib->ft_locks[FIB_SOURCE_CLI]));
+    }));
+    serialize_likely_small_unsigned_integer (m, n);
+    pool_foreach (fib, ip_snapshot_tables (fproto),
+    ({
+      if (0 != fib->ft_table_id &&
+	  (fib->ft_locks[FIB_SOURCE_API] || fib->ft_locks[FIB_SOURCE_CLI]))
+	{
+	  u8 *name = format (0, "%v%c", fib->ft_desc, 0);
+
+	  serialize_integer (m, fib->ft_table_id, sizeof (u32));
+	  serialize_integer (m, 0 != fib->ft_locks[FIB_SOURCE_API],
+			     sizeof (u8));
+	  serialize_cstring (m, (char *) name);
+	  vec_free (name);
+	}
+    }));
+    /* *INDENT-ON* */
+
+    /* interfaces bound to a table other than the default */
+    fib_index = (FIB_PROTOCOL_IP4 == fproto ?
+		 ip4_main.fib_index_by_sw_if_index :
+		 ip6_main.fib_index_by_sw_if_index);
+    n = 0;
+    for (i = 0; i < vec_len (fib_index); i++)
+      n += (0 != fib_index[i] && vnet_sw_interface_is_valid (vnm, i));
+    serialize_likely_small_unsigned_integer (m, n);
+    for (i = 0; i < vec_len (fib_index); i++)
+      {
+	if (0 == fib_index[i] || !vnet_sw_interface_is_valid (vnm, i))
+	  continue;
+	serialize_vnet_snapshot_sw_if_index (m, i);
+	serialize_integer (m, fib_table_get_table_id (fib_index[i], fproto),
+			   sizeof (u32));
+      }
+
+    /* interface addresses */
+    lm = ip_snapshot_lookup_main (fproto);
+    serialize_likely_small_unsigned_integer (m, pool_elts
+					     (lm->if_address_pool));
+    /* *INDENT-OFF* */
+    pool_foreach (ia, lm->if_address_pool,
+    ({
+      serialize_vnet_snapshot_sw_if_index (m, ia->sw_if_index);
+      serialize_integer (m, ia->address_length, sizeof (u8));
+      serialize_vnet_snapshot_data (m,
+				    ip_interface_address_get_address (lm, ia),
+				    (FIB_PROTOCOL_IP4 == fproto ?
+				     sizeof (ip4_address_t) :
+				     sizeof (ip6_address_t)));
+    }));
+    /* *INDENT-ON* */
+
+    ip_snapshot_save_routes (m, fproto);
+  }
+}
+
+static void
+ip_snapshot_restore (serialize_main_t * m, va_list * va)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u32 n, table_id, sw_if_index;
+  fib_protocol_t fproto;
+  clib_error_t *error;
+  ip46_address_t addr;
+  u8 is_api, len;
+  char *name;
+
+  FOR_EACH_FIB_IP_PROTOCOL (fproto)
+  {
+    n = unserialize_likely_small_unsigned_integer (m);
+    while (n--)
+      {
+	unserialize_integer (m, &table_id, sizeof (u32));
+	unserialize_integer (m, &is_api, sizeof (u8));
+	unserialize_cstring (m, &name);
+	ip_table_create (fproto, table_id, is_api, (u8 *) name);
+	vec_free (name);
+      }
+
+    n = unserialize_likely_small_unsigned_integer (m);
+    while (n--)
+      {
+	int skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+
+	unserialize_integer (m, &table_id, sizeof (u32));
+	if (!skip && ip_table_bind (fproto, sw_if_index, table_id, 1))
+	  vnet_snapshot_skip ();
+      }
+
+    n = unserialize_likely_small_unsigned_integer (m);
+    while (n--)
+      {
+	int skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+
+	unserialize_integer (m, &len, sizeof (u8));
+	if (FIB_PROTOCOL_IP4 == fproto)
+	  {
+	    unserialize_vnet_snapshot_data (m, &addr.ip4,
+					    sizeof (ip4_address_t));
+	    if (skip)
+	      continue;
+	    error = ip4_add_del_interface_address (vm, sw_if_index,
+						   &addr.ip4, len, 0);
+	  }
+	else
+	  {
+	    unserialize_vnet_snapshot_data (m, &addr.ip6,
+					    sizeof (ip6_address_t));
+	    if (skip)
+	      continue;
+	    error = ip6_add_del_interface_address (vm, sw_if_index,
+						   &addr.ip6, len, 0);
+	  }
+	if (error)
+	  {
+	    /* most likely the address is already there */
+	    clib_error_free (error);
+	  }
+      }
+
+    ip_snapshot_restore_routes (m, fproto);
+  }
+}
+
+/* *INDENT-OFF* */
+VNET_SNAPSHOT_SECTION (ip, static) = {
+  .name = "ip",
+  .save = ip_snapshot_save,
+  .restore = ip_snapshot_restore,
+};
+/* *INDENT-ON* */
+
+static void
+ip_snapshot_neighbor_save (serialize_main_t * m, va_list * va)
+{
+  ethernet_arp_ip4_entry_t *n4s, *n4;
+  ip6_neighbor_t *n6s, *n6;
+
+  n4s = ip4_neighbor_entries (~0);
+  serialize_likely_small_unsigned_integer (m, vec_len (n4s));
+  vec_foreach (n4, n4s)
+  {
+    serialize_vnet_snapshot_sw_if_index (m, n4->sw_if_index);
+    serialize_vnet_snapshot_data (m, &n4->ip4_address,
+				  sizeof (n4->ip4_address));
+    serialize_vnet_snapshot_data (m, n4->ethernet_address,
+				  sizeof (n4->ethernet_address));
+    serialize_integer (m, n4->flags, sizeof (u8));
+  }
+  vec_free (n4s);
+
+  n6s = ip6_neighbors_entries (~0);
+  serialize_likely_small_unsigned_integer (m, vec_len (n6s));
+  vec_foreach (n6, n6s)
+  {
+    serialize_vnet_snapshot_sw_if_index (m, n6->key.sw_if_index);
+    serialize_vnet_snapshot_data (m, &n6->key.ip6_address,
+				  sizeof (n6->key.ip6_address));
+    serialize_vnet_snapshot_data (m, n6->link_layer_address, 6);
+    serialize_integer (m, n6->flags, sizeof (u8));
+  }
+  vec_free (n6s);
+}
+
+static void
+ip_snapshot_neighbor_restore (serialize_main_t * m, va_list * va)
+{
+  ethernet_arp_ip4_over_ethernet_address_t a4;
+  vnet_main_t *vnm = vnet_get_main ();
+  vlib_main_t *vm = vlib_get_main ();
+  u32 n, sw_if_index;
+  ip6_address_t a6;
+  u8 mac[6], flags;
+  int skip;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+      unserialize_vnet_snapshot_data (m, &a4.ip4, sizeof (a4.ip4));
+      unserialize_vnet_snapshot_data (m, a4.ethernet, sizeof (a4.ethernet));
+      unserialize_integer (m, &flags, sizeof (u8));
+      if (skip)
+	continue;
+
+      vnet_arp_set_ip4_over_ethernet
+	(vnm, sw_if_index, &a4,
+	 flags & ETHERNET_ARP_IP4_ENTRY_FLAG_STATIC,
+	 flags & ETHERNET_ARP_IP4_ENTRY_FLAG_NO_FIB_ENTRY);
+    }
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+      unserialize_vnet_snapshot_data (m, &a6, sizeof (a6));
+      unserialize_vnet_snapshot_data (m, mac, sizeof (mac));
+      unserialize_integer (m, &flags, sizeof (u8));
+      if (skip)
+	continue;
+
+      vnet_set_ip6_ethernet_neighbor (vm, sw_if_index, &a6, mac, sizeof (mac),
+				      flags & IP6_NEIGHBOR_FLAG_STATIC,
+				      flags & IP6_NEIGHBOR_FLAG_NO_FIB_ENTRY);
+    }
+}
+
+/* *INDENT-OFF* */
+VNET_SNAPSHOT_SECTION (ip_neighbor, static) = {
+  .name = "ip-neighbor",
+  .save = ip_snapshot_neighbor_save,
+  .restore = ip_snapshot_neighbor_restore,
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
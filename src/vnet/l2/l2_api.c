@@ -265,6 +265,7 @@ vl_api_want_l2_macs_events_t_handler (vl_api_want_l2_macs_events_t * mp)
 	{
 	  lm->client_pid = pid;
 	  lm->client_index = mp->client_index;
+	  l2learn_flush_events ();
 
 	  if (mp->max_macs_in_event)
 	    fm->max_macs_in_event = mp->max_macs_in_event * 10;
@@ -294,6 +295,7 @@ vl_api_want_l2_macs_events_t_handler (vl_api_want_l2_macs_events_t * mp)
     {
       lm->client_pid = 0;
       lm->client_index = 0;
+      l2learn_flush_events ();
       if (learn_limit && (learn_limit < L2LEARN_DEFAULT_LIMIT))
 	lm->global_learn_limit = learn_limit;
       else
@@ -262,16 +262,27 @@ show_l2fib (vlib_main_t * vm,
   else
     {
       l2learn_main_t *lm = &l2learn_main;
+      l2learn_per_thread_data_t *ptd;
+      u64 n_events_dropped = 0;
+
+      vec_foreach (ptd, lm->per_thread_data)
+	n_events_dropped += ptd->n_events_dropped;
+
       vlib_cli_output (vm, "L2FIB total/learned entries: %d/%d  "
 		       "Last scan time: %.4esec  Learn limit: %d ",
 		       total_entries, lm->global_learn_count,
 		       msm->age_scan_duration, lm->global_learn_limit);
+      vlib_cli_output (vm, "Learn rate: %.2f/sec  Last scan aged: %d  "
+		       "Last scan slices: %d  Buckets left in scan: %d",
+		       msm->learn_rate, msm->age_scan_last_n_aged,
+		       msm->age_scan_last_n_slices, msm->age_scan_n_left);
       if (lm->client_pid)
 	vlib_cli_output (vm, "L2MAC events client PID: %d  "
 			 "Last e-scan time: %.4esec  Delay: %.2esec  "
-			 "Max macs in event: %d",
+			 "Max macs in event: %d  Events dropped: %lld",
 			 lm->client_pid, msm->evt_scan_duration,
-			 msm->event_scan_delay, msm->max_macs_in_event);
+			 msm->event_scan_delay, msm->max_macs_in_event,
+			 n_events_dropped);
     }
 
   if (raw)
@@ -384,6 +395,7 @@ l2fib_add_entry (u8 * mac, u32 bd_index,
 
   /* set up key */
   key.raw = l2fib_make_key (mac, bd_index);
+  kv.key = key.raw;
 
   /* check if entry alread exist */
   if (BV (clib_bihash_search) (&fm->mac_table, &kv, &kv))
@@ -391,7 +403,7 @@ l2fib_add_entry (u8 * mac, u32 bd_index,
       /* decrement counter if overwriting a learned mac  */
       result.raw = kv.value;
       if ((result.fields.age_not == 0) && (lm->global_learn_count))
-	lm->global_learn_count--;
+	__sync_fetch_and_sub (&lm->global_learn_count, 1);
     }
 
   /* set up result */
@@ -408,6 +420,35 @@ l2fib_add_entry (u8 * mac, u32 bd_index,
   BV (clib_bihash_add_del) (&fm->mac_table, &kv, 1 /* is_add */ );
 }
 
+/**
+ * Add a learned entry to the l2fib, as the learn node would have.
+ * The entry ages out normally. An existing entry is left alone.
+ */
+void
+l2fib_add_learned_entry (u8 * mac, u32 bd_index, u32 sw_if_index)
+{
+  l2fib_entry_result_t result;
+  l2fib_main_t *fm = &l2fib_main;
+  l2learn_main_t *lm = &l2learn_main;
+  BVT (clib_bihash_kv) kv;
+
+  if (lm->global_learn_count >= lm->global_learn_limit)
+    return;
+
+  kv.key = l2fib_make_key (mac, bd_index);
+  if (0 == BV (clib_bihash_search) (&fm->mac_table, &kv, &kv))
+    return;
+
+  result.raw = 0;
+  result.fields.sw_if_index = sw_if_index;
+  result.fields.timestamp = (u8) (vlib_time_now (vlib_get_main ()) / 60);
+  result.fields.sn = l2fib_cur_seq_num (bd_index, sw_if_index);
+
+  kv.value = result.raw;
+  BV (clib_bihash_add_del) (&fm->mac_table, &kv, 1 /* is_add */ );
+  __sync_fetch_and_add (&lm->global_learn_count, 1);
+}
+
 /**
  * Add an entry to the L2FIB.
  * The CLI format is:
@@ -679,7 +720,7 @@ l2fib_del_entry (u8 * mac, u32 bd_index, u32 sw_if_index)
 
   /* decrement counter if dynamically learned mac */
   if ((result.fields.age_not == 0) && (l2learn_main.global_learn_count))
-    l2learn_main.global_learn_count--;
+    __sync_fetch_and_sub (&l2learn_main.global_learn_count, 1);
 
   /* Remove entry from hash table */
   BV (clib_bihash_add_del) (&mp->mac_table, &kv, 0 /* is_add */ );
@@ -959,42 +1000,179 @@ allocate_mac_evt_buf (u32 client, u32 client_index)
   return mp;
 }
 
-static_always_inline f64
-l2fib_scan (vlib_main_t * vm, f64 start_time, u8 event_only)
+typedef struct
+{
+  /* event message being filled, allocated on the first mac */
+  vl_api_l2_macs_event_t *mp;
+  u32 n_macs;
+
+  /* learn events collected from the workers */
+  l2learn_event_t *events;
+} l2fib_mac_event_ctx_t;
+
+static void
+l2fib_mac_event_send (l2fib_mac_event_ctx_t * ctx)
+{
+  l2learn_main_t *lm = &l2learn_main;
+  vl_api_registration_t *reg;
+
+  if (ctx->mp == 0)
+    return;
+
+  reg = vl_api_client_index_to_registration (lm->client_index);
+  if (ctx->n_macs && reg && vl_api_can_send_msg (reg))
+    {
+      ctx->mp->n_macs = htonl (ctx->n_macs);
+      vl_api_send_msg (reg, (u8 *) ctx->mp);
+    }
+  else
+    {
+      if (ctx->n_macs && reg)
+	clib_warning ("MAC event to pid %d queue stuffed!"
+		      " %d MAC entries lost", lm->client_pid, ctx->n_macs);
+      vl_msg_api_free (ctx->mp);
+    }
+  ctx->mp = 0;
+  ctx->n_macs = 0;
+}
+
+static_always_inline void
+l2fib_mac_event_add (l2fib_mac_event_ctx_t * ctx, l2fib_entry_key_t * key,
+		     u32 sw_if_index, u8 action)
 {
   l2fib_main_t *fm = &l2fib_main;
   l2learn_main_t *lm = &l2learn_main;
 
+  if (PREDICT_FALSE (ctx->mp == 0))
+    ctx->mp = allocate_mac_evt_buf (lm->client_pid, lm->client_index);
+
+  clib_memcpy (ctx->mp->mac[ctx->n_macs].mac_addr, key->fields.mac, 6);
+  ctx->mp->mac[ctx->n_macs].action = action;
+  ctx->mp->mac[ctx->n_macs].sw_if_index = htonl (sw_if_index);
+
+  /* event message full, send it and start a new one */
+  if (++ctx->n_macs >= fm->max_macs_in_event)
+    l2fib_mac_event_send (ctx);
+}
+
+/**
+ * Collect the macs learned or moved by all threads since the last call.
+ * The learn path queues them per thread so no table scan is needed.
+ */
+static f64
+l2fib_mac_event_scan (vlib_main_t * vm, l2fib_mac_event_ctx_t * ctx)
+{
+  l2learn_main_t *lm = &l2learn_main;
+  l2learn_per_thread_data_t *ptd;
+  l2learn_event_t *e, *tmp;
+  f64 start_time = vlib_time_now (vm);
+
+  vec_foreach (ptd, lm->per_thread_data)
+  {
+    if (vec_len (ptd->events) == 0)
+      continue;
+
+    /* swap in an empty vector so the worker is held off only briefly */
+    vec_reset_length (ctx->events);
+    clib_spinlock_lock (&ptd->event_lock);
+    tmp = ptd->events;
+    ptd->events = ctx->events;
+    ctx->events = tmp;
+    clib_spinlock_unlock (&ptd->event_lock);
+
+    vec_foreach (e, ctx->events)
+      l2fib_mac_event_add (ctx, &e->key, e->sw_if_index, e->action);
+  }
+
+  return vlib_time_now (vm) - start_time;
+}
+
+static void
+l2fib_age_scan_start (vlib_main_t * vm, u8 flush)
+{
+  l2fib_main_t *fm = &l2fib_main;
+
+  /* a flush restarts any scan in progress, the whole table must be seen */
+  fm->age_scan_n_left = fm->mac_table.nbuckets;
+  fm->age_scan_flush = flush;
+  fm->age_scan_start_time = vlib_time_now (vm);
+  fm->age_scan_accum = 0;
+  fm->age_scan_learn_count = 0;
+  fm->age_scan_n_aged = 0;
+  fm->age_scan_n_slices = 0;
+}
+
+static void
+l2fib_age_scan_done (vlib_main_t * vm)
+{
+  l2fib_main_t *fm = &l2fib_main;
+  l2learn_main_t *lm = &l2learn_main;
+  l2learn_per_thread_data_t *ptd;
+  f64 now = vlib_time_now (vm);
+  u64 n_learned = 0;
+
+  vec_foreach (ptd, lm->per_thread_data)
+    n_learned += ptd->n_learned;
+
+  fm->age_scan_duration = fm->age_scan_accum;
+  fm->age_scan_last_n_aged = fm->age_scan_n_aged;
+  fm->age_scan_last_n_slices = fm->age_scan_n_slices;
+
+  /* learn rate since the previous scan completed */
+  if (now > fm->learn_rate_time)
+    fm->learn_rate = (n_learned - fm->learn_rate_n_learned) /
+      (now - fm->learn_rate_time);
+  fm->learn_rate_time = now;
+  fm->learn_rate_n_learned = n_learned;
+
+  /* keep learn count consistent - only a flat out scan sees a snapshot
+   * close enough to trust */
+  if (fm->age_scan_flush)
+    lm->global_learn_count = fm->age_scan_learn_count;
+  fm->age_scan_flush = 0;
+}
+
+/**
+ * Age one slice of the mac table, resuming at the bucket the previous slice
+ * stopped at. A paced scan only ages the buckets due by now so that a full
+ * scan takes L2FIB_AGE_SCAN_INTERVAL, while a flush scan keeps going. Either
+ * way the slice yields after L2FIB_AGE_SCAN_SLICE_TIME.
+ * Returns the time the next slice, or the next scan, is due.
+ */
+static f64
+l2fib_age_scan_slice (vlib_main_t * vm, l2fib_mac_event_ctx_t * ctx)
+{
+  l2fib_main_t *fm = &l2fib_main;
+  l2learn_main_t *lm = &l2learn_main;
   BVT (clib_bihash) * h = &fm->mac_table;
-  int i, j, k;
-  f64 last_start = start_time;
-  f64 accum_t = 0;
-  f64 delta_t = 0;
-  u32 evt_idx = 0;
-  u32 learn_count = 0;
-  u32 client = lm->client_pid;
-  u32 cl_idx = lm->client_index;
-  vl_api_l2_macs_event_t *mp = 0;
-  vl_api_registration_t *reg = 0;
-
-  if (client)
+  f64 start_time = vlib_time_now (vm);
+  u8 minutes = (u8) (start_time / 60);
+  u32 n_buckets, n_done;
+  int j, k;
+
+  n_done = h->nbuckets - fm->age_scan_n_left;
+  if (fm->age_scan_flush)
+    n_buckets = fm->age_scan_n_left;
+  else
     {
-      mp = allocate_mac_evt_buf (client, cl_idx);
-      reg = vl_api_client_index_to_registration (lm->client_index);
+      f64 due = (start_time - fm->age_scan_start_time) /
+	L2FIB_AGE_SCAN_INTERVAL * h->nbuckets;
+      n_buckets = due > n_done ? clib_min ((u32) due + 1 - n_done,
+					   fm->age_scan_n_left) : 0;
     }
 
-  for (i = 0; i < h->nbuckets; i++)
+  while (n_buckets)
     {
-      /* allow no more than 20us without a pause */
-      delta_t = vlib_time_now (vm) - last_start;
-      if (delta_t > 20e-6)
-	{
-	  vlib_process_suspend (vm, 100e-6);	/* suspend for 100 us */
-	  last_start = vlib_time_now (vm);
-	  accum_t += delta_t;
-	}
+      u32 i = fm->age_scan_bucket;
+
+      if (vlib_time_now (vm) - start_time > L2FIB_AGE_SCAN_SLICE_TIME)
+	break;
+
+      fm->age_scan_bucket = i + 1 < h->nbuckets ? i + 1 : 0;
+      fm->age_scan_n_left--;
+      n_buckets--;
 
-      if (i < (h->nbuckets - 3))
+      if (i + 3 < h->nbuckets)
 	{
 	  BVT (clib_bihash_bucket) * b = &h->buckets[i + 3];
 	  CLIB_PREFETCH (b, CLIB_CACHE_LINE_BYTES, LOAD);
@@ -1021,54 +1199,11 @@ l2fib_scan (vlib_main_t * vm, f64 start_time, u8 event_only)
 	      l2fib_entry_key_t key = {.raw = v->kvp[k].key };
 	      l2fib_entry_result_t result = {.raw = v->kvp[k].value };
 
-	      if (result.fields.age_not == 0)
-		learn_count++;
-
-	      if (client)
-		{
-		  if (PREDICT_FALSE (evt_idx >= fm->max_macs_in_event))
-		    {
-		      /* event message full, send it and start a new one */
-		      if (reg && vl_api_can_send_msg (reg))
-			{
-			  mp->n_macs = htonl (evt_idx);
-			  vl_api_send_msg (reg, (u8 *) mp);
-			  mp = allocate_mac_evt_buf (client, cl_idx);
-			}
-		      else
-			{
-			  if (reg)
-			    clib_warning ("MAC event to pid %d queue stuffed!"
-					  " %d MAC entries lost", client,
-					  evt_idx);
-			}
-		      evt_idx = 0;
-		    }
-
-		  if (result.fields.lrn_evt)
-		    {
-		      /* copy mac entry to event msg */
-		      clib_memcpy (mp->mac[evt_idx].mac_addr, key.fields.mac,
-				   6);
-		      mp->mac[evt_idx].action = result.fields.lrn_mov ?
-			MAC_EVENT_ACTION_MOVE : MAC_EVENT_ACTION_ADD;
-		      mp->mac[evt_idx].sw_if_index =
-			htonl (result.fields.sw_if_index);
-		      /* clear event bits and update mac entry */
-		      result.fields.lrn_evt = 0;
-		      result.fields.lrn_mov = 0;
-		      BVT (clib_bihash_kv) kv;
-		      kv.key = key.raw;
-		      kv.value = result.raw;
-		      BV (clib_bihash_add_del) (&fm->mac_table, &kv, 1);
-		      evt_idx++;
-		      continue;	/* skip aging */
-		    }
-		}
-
-	      if (event_only || result.fields.age_not)
+	      if (result.fields.age_not)
 		continue;	/* skip aging - static_mac alsways age_not */
 
+	      fm->age_scan_learn_count++;
+
 	      /* start aging processing */
 	      u32 bd_index = key.fields.bd_index;
 	      u32 sw_if_index = result.fields.sw_if_index;
@@ -1082,57 +1217,43 @@ l2fib_scan (vlib_main_t * vm, f64 start_time, u8 event_only)
 	      if (bd_config->mac_age == 0)
 		continue;	/* skip aging */
 
-	      i16 delta = (u8) (start_time / 60) - result.fields.timestamp;
+	      i16 delta = minutes - result.fields.timestamp;
 	      delta += delta < 0 ? 256 : 0;
 
 	      if (delta < bd_config->mac_age)
 		continue;	/* still valid */
 
 	    age_out:
-	      if (client)
-		{
-		  /* copy mac entry to event msg */
-		  clib_memcpy (mp->mac[evt_idx].mac_addr, key.fields.mac, 6);
-		  mp->mac[evt_idx].action = MAC_EVENT_ACTION_DELETE;
-		  mp->mac[evt_idx].sw_if_index =
-		    htonl (result.fields.sw_if_index);
-		  evt_idx++;
-		}
+	      if (lm->client_pid)
+		l2fib_mac_event_add (ctx, &key, sw_if_index,
+				     MAC_EVENT_ACTION_DELETE);
 	      /* delete mac entry */
 	      BVT (clib_bihash_kv) kv;
 	      kv.key = key.raw;
 	      BV (clib_bihash_add_del) (&fm->mac_table, &kv, 0);
-	      learn_count--;
+	      if (lm->global_learn_count)
+		__sync_fetch_and_sub (&lm->global_learn_count, 1);
+	      fm->age_scan_learn_count--;
+	      fm->age_scan_n_aged++;
 	    }
 	  v++;
 	}
     }
 
-  /* keep learn count consistent */
-  l2learn_main.global_learn_count = learn_count;
+  fm->age_scan_accum += vlib_time_now (vm) - start_time;
+  fm->age_scan_n_slices++;
 
-  if (mp)
+  if (fm->age_scan_n_left == 0)
     {
-      /*  send any outstanding mac event message else free message buffer */
-      if (evt_idx)
-	{
-	  if (reg && vl_api_can_send_msg (reg))
-	    {
-	      mp->n_macs = htonl (evt_idx);
-	      vl_api_send_msg (reg, (u8 *) mp);
-	    }
-	  else
-	    {
-	      if (reg)
-		clib_warning ("MAC event to pid %d queue stuffed!"
-			      " %d MAC entries lost", client, evt_idx);
-	      vl_msg_api_free (mp);
-	    }
-	}
-      else
-	vl_msg_api_free (mp);
+      l2fib_age_scan_done (vm);
+      return fm->age_scan_start_time + L2FIB_AGE_SCAN_INTERVAL;
     }
-  return delta_t + accum_t;
+
+  /* out of time with buckets still due - come back right away */
+  if (n_buckets)
+    return start_time + 100e-6;
+
+  return start_time + L2FIB_AGE_SCAN_SLICE_INTERVAL;
 }
 
 static uword
@@ -1142,68 +1263,67 @@ l2fib_mac_age_scanner_process (vlib_main_t * vm, vlib_node_runtime_t * rt,
   uword event_type, *event_data = 0;
   l2fib_main_t *fm = &l2fib_main;
   l2learn_main_t *lm = &l2learn_main;
+  l2fib_mac_event_ctx_t ctx = { 0 };
   bool enabled = 0;
-  f64 start_time, next_age_scan_time = CLIB_TIME_MAX;
+  f64 now, t, next_scan_time = CLIB_TIME_MAX;
 
   while (1)
     {
+      now = vlib_time_now (vm);
+      t = next_scan_time - now;
       if (lm->client_pid)
-	vlib_process_wait_for_event_or_clock (vm, fm->event_scan_delay);
-      else if (enabled)
-	{
-	  f64 t = next_age_scan_time - vlib_time_now (vm);
-	  vlib_process_wait_for_event_or_clock (vm, t);
-	}
+	t = clib_min (t, fm->event_scan_delay);
+
+      if (lm->client_pid || next_scan_time < CLIB_TIME_MAX)
+	vlib_process_wait_for_event_or_clock (vm, clib_max (t, 0));
       else
 	vlib_process_wait_for_event (vm);
 
       event_type = vlib_process_get_events (vm, &event_data);
       vec_reset_length (event_data);
 
-      start_time = vlib_time_now (vm);
-      enum
-      { SCAN_MAC_AGE, SCAN_MAC_EVENT, SCAN_DISABLE } scan = SCAN_MAC_AGE;
-
       switch (event_type)
 	{
 	case ~0:		/* timer expired */
-	  if (lm->client_pid != 0 && start_time < next_age_scan_time)
-	    scan = SCAN_MAC_EVENT;
 	  break;
 
 	case L2_MAC_AGE_PROCESS_EVENT_START:
 	  enabled = 1;
+	  l2fib_age_scan_start (vm, 1 /* flush */ );
 	  break;
 
 	case L2_MAC_AGE_PROCESS_EVENT_STOP:
 	  enabled = 0;
-	  scan = SCAN_DISABLE;
+	  fm->age_scan_n_left = 0;
+	  fm->age_scan_duration = 0;
+	  fm->evt_scan_duration = 0;
 	  break;
 
 	case L2_MAC_AGE_PROCESS_EVENT_ONE_PASS:
+	  l2fib_age_scan_start (vm, 1 /* flush */ );
 	  break;
 
 	default:
 	  ASSERT (0);
 	}
 
-      if (scan == SCAN_MAC_EVENT)
-	l2fib_main.evt_scan_duration = l2fib_scan (vm, start_time, 1);
-      else
-	{
-	  if (scan == SCAN_MAC_AGE)
-	    l2fib_main.age_scan_duration = l2fib_scan (vm, start_time, 0);
-	  if (scan == SCAN_DISABLE)
-	    {
-	      l2fib_main.age_scan_duration = 0;
-	      l2fib_main.evt_scan_duration = 0;
-	    }
-	  /* schedule next scan */
-	  if (enabled)
-	    next_age_scan_time = start_time + L2FIB_AGE_SCAN_INTERVAL;
-	  else
-	    next_age_scan_time = CLIB_TIME_MAX;
-	}
+      now = vlib_time_now (vm);
+      if (lm->client_pid)
+	fm->evt_scan_duration = l2fib_mac_event_scan (vm, &ctx);
+
+      /* start the next paced scan once the scan interval is up */
+      if (fm->age_scan_n_left == 0 && enabled && now >= next_scan_time)
+	l2fib_age_scan_start (vm, 0 /* flush */ );
+
+      if (fm->age_scan_n_left
+	  && (fm->age_scan_flush || now >= next_scan_time))
+	next_scan_time = l2fib_age_scan_slice (vm, &ctx);
+
+      if (fm->age_scan_n_left == 0 && !enabled)
+	next_scan_time = CLIB_TIME_MAX;
+
+      if (lm->client_pid)
+	l2fib_mac_event_send (&ctx);
     }
   return 0;
 }
@@ -30,6 +30,14 @@
 /* Ager scan interval is 1 minute for aging */
 #define L2FIB_AGE_SCAN_INTERVAL		(60.0)
 
+/*
+ * The ager spreads each scan over the scan interval, waking up every 10 msec
+ * to age the buckets due by then, and runs for no more than 20 usec at a
+ * time before yielding
+ */
+#define L2FIB_AGE_SCAN_SLICE_INTERVAL	(10e-3)
+#define L2FIB_AGE_SCAN_SLICE_TIME	(20e-6)
+
 /* MAC event scan delay is 100 msec unless specified by MAC event client */
 #define L2FIB_EVENT_SCAN_DELAY_DEFAULT	(0.1)
 
@@ -52,6 +60,26 @@ typedef struct
   f64 evt_scan_duration;
   f64 age_scan_duration;
 
+  /* incremental ager state: next bucket, buckets left in the current
+   * scan and whether the scan runs flat out (flush) or paced */
+  u32 age_scan_bucket;
+  u32 age_scan_n_left;
+  u8 age_scan_flush;
+  f64 age_scan_start_time;
+  f64 age_scan_accum;
+  u32 age_scan_learn_count;
+  u32 age_scan_n_aged;
+  u32 age_scan_n_slices;
+
+  /* macs aged out and slices taken by the last complete scan */
+  u32 age_scan_last_n_aged;
+  u32 age_scan_last_n_slices;
+
+  /* macs learned per second, sampled whenever a scan completes */
+  f64 learn_rate;
+  f64 learn_rate_time;
+  u64 learn_rate_n_learned;
+
   /* delay between event scans, default to 100 msec */
   f64 event_scan_delay;
 
@@ -117,9 +145,7 @@ typedef struct
       u8 age_not:1;		/* not subject to age */
       u8 bvi:1;			/* mac is for a bridged virtual interface */
       u8 filter:1;		/* drop packets to/from this mac */
-      u8 lrn_evt:1;		/* MAC learned to be sent in L2 MAC event */
-      u8 lrn_mov:1;		/* MAC learned is a MAC move */
-      u8 unused:2;
+      u8 unused:4;
 
       u8 timestamp;		/* timestamp for aging */
       l2fib_seq_num_t sn;	/* bd/int seq num */
@@ -389,6 +415,8 @@ l2fib_add_entry (u8 * mac,
 		 u32 bd_index,
 		 u32 sw_if_index, u8 static_mac, u8 drop_mac, u8 bvi_mac);
 
+void l2fib_add_learned_entry (u8 * mac, u32 bd_index, u32 sw_if_index);
+
 static inline void
 l2fib_add_fwd_entry (u8 * mac, u32 bd_index, u32 sw_if_index, u8 static_mac,
 		     u8 bvi_mac)
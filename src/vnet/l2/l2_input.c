@@ -49,6 +49,7 @@
  * For interfaces in Layer 3 mode, the packets will be routed.
  */
 
+#ifndef CLIB_MARCH_VARIANT
 /* Feature graph node names */
 static char *l2input_feat_names[] = {
 #define _(sym,name) name,
@@ -85,6 +86,7 @@ format_l2_input_features (u8 * s, va_list * args)
       s = format (s, "%10s (%s)\n", display_names[i], l2input_feat_names[i]);
   return s;
 }
+#endif
 
 typedef struct
 {
@@ -95,6 +97,7 @@ typedef struct
   u32 sw_if_index;
 } l2input_trace_t;
 
+#ifndef CLIB_MARCH_VARIANT
 /* packet trace format function */
 static u8 *
 format_l2input_trace (u8 * s, va_list * args)
@@ -111,6 +114,7 @@ format_l2input_trace (u8 * s, va_list * args)
 }
 
 l2input_main_t l2input_main;
+#endif
 
 #define foreach_l2input_error			\
 _(L2INPUT,     "L2 input packets")		\
@@ -124,11 +128,13 @@ typedef enum
     L2INPUT_N_ERROR,
 } l2input_error_t;
 
+#ifndef CLIB_MARCH_VARIANT
 static char *l2input_error_strings[] = {
 #define _(sym,string) string,
   foreach_l2input_error
 #undef _
 };
+#endif
 
 typedef enum
 {				/*  */
@@ -276,187 +282,154 @@ l2input_node_inline (vlib_main_t * vm,
 		     vlib_node_runtime_t * node, vlib_frame_t * frame,
 		     int do_trace)
 {
-  u32 n_left_from, *from, *to_next;
-  l2input_next_t next_index;
+  u32 n_left_from, *from;
   l2input_main_t *msm = &l2input_main;
+  vlib_buffer_t *bufs[VLIB_FRAME_SIZE], **b = bufs;
+  u16 nexts[VLIB_FRAME_SIZE], *next;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;	/* number of packets to process */
-  next_index = node->cached_next_index;
+  next = nexts;
+  vlib_get_buffers (vm, from, bufs, n_left_from);
 
-  while (n_left_from > 0)
+  while (n_left_from >= 8)
     {
-      u32 n_left_to_next;
-
-      /* get space to enqueue frame to graph node "next_index" */
-      vlib_get_next_frame (vm, node, next_index, to_next, n_left_to_next);
-
-      while (n_left_from >= 8 && n_left_to_next >= 4)
-	{
-	  u32 bi0, bi1, bi2, bi3;
-	  vlib_buffer_t *b0, *b1, *b2, *b3;
-	  u32 next0, next1, next2, next3;
-	  u32 sw_if_index0, sw_if_index1, sw_if_index2, sw_if_index3;
-
-	  /* Prefetch next iteration. */
-	  {
-	    vlib_buffer_t *p4, *p5, *p6, *p7;
-
-	    p4 = vlib_get_buffer (vm, from[4]);
-	    p5 = vlib_get_buffer (vm, from[5]);
-	    p6 = vlib_get_buffer (vm, from[6]);
-	    p7 = vlib_get_buffer (vm, from[7]);
-
-	    /* Prefetch the buffer header and packet for the N+2 loop iteration */
-	    vlib_prefetch_buffer_header (p4, LOAD);
-	    vlib_prefetch_buffer_header (p5, LOAD);
-	    vlib_prefetch_buffer_header (p6, LOAD);
-	    vlib_prefetch_buffer_header (p7, LOAD);
-
-	    CLIB_PREFETCH (p4->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p5->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p6->data, CLIB_CACHE_LINE_BYTES, STORE);
-	    CLIB_PREFETCH (p7->data, CLIB_CACHE_LINE_BYTES, STORE);
-
-	    /*
-	     * Don't bother prefetching the bridge-domain config (which
-	     * depends on the input config above). Only a small number of
-	     * bridge domains are expected. Plus the structure is small
-	     * and several fit in a cache line.
-	     */
-	  }
-
-	  /* speculatively enqueue b0 and b1 to the current next frame */
-	  /* bi is "buffer index", b is pointer to the buffer */
-	  to_next[0] = bi0 = from[0];
-	  to_next[1] = bi1 = from[1];
-	  to_next[2] = bi2 = from[2];
-	  to_next[3] = bi3 = from[3];
-	  from += 4;
-	  to_next += 4;
-	  n_left_from -= 4;
-	  n_left_to_next -= 4;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-	  b1 = vlib_get_buffer (vm, bi1);
-	  b2 = vlib_get_buffer (vm, bi2);
-	  b3 = vlib_get_buffer (vm, bi3);
-
-	  if (do_trace)
-	    {
-	      /* RX interface handles */
-	      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
-	      sw_if_index1 = vnet_buffer (b1)->sw_if_index[VLIB_RX];
-	      sw_if_index2 = vnet_buffer (b2)->sw_if_index[VLIB_RX];
-	      sw_if_index3 = vnet_buffer (b3)->sw_if_index[VLIB_RX];
+      vlib_buffer_t *b0, *b1, *b2, *b3;
+      u32 next0, next1, next2, next3;
+      u32 sw_if_index0, sw_if_index1, sw_if_index2, sw_if_index3;
+
+      /* Prefetch next iteration. */
+      /* Prefetch the buffer header and packet for the N+2 loop iteration */
+      vlib_prefetch_buffer_header (b[4], LOAD);
+      vlib_prefetch_buffer_header (b[5], LOAD);
+      vlib_prefetch_buffer_header (b[6], LOAD);
+      vlib_prefetch_buffer_header (b[7], LOAD);
+
+      CLIB_PREFETCH (b[4]->data, CLIB_CACHE_LINE_BYTES, STORE);
+      CLIB_PREFETCH (b[5]->data, CLIB_CACHE_LINE_BYTES, STORE);
+      CLIB_PREFETCH (b[6]->data, CLIB_CACHE_LINE_BYTES, STORE);
+      CLIB_PREFETCH (b[7]->data, CLIB_CACHE_LINE_BYTES, STORE);
 
-	      if (b0->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  ethernet_header_t *h0 = vlib_buffer_get_current (b0);
-		  l2input_trace_t *t =
-		    vlib_add_trace (vm, node, b0, sizeof (*t));
-		  t->sw_if_index = sw_if_index0;
-		  clib_memcpy (t->src, h0->src_address, 6);
-		  clib_memcpy (t->dst, h0->dst_address, 6);
-		}
-	      if (b1->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  ethernet_header_t *h1 = vlib_buffer_get_current (b1);
-		  l2input_trace_t *t =
-		    vlib_add_trace (vm, node, b1, sizeof (*t));
-		  t->sw_if_index = sw_if_index1;
-		  clib_memcpy (t->src, h1->src_address, 6);
-		  clib_memcpy (t->dst, h1->dst_address, 6);
-		}
-	      if (b2->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  ethernet_header_t *h2 = vlib_buffer_get_current (b2);
-		  l2input_trace_t *t =
-		    vlib_add_trace (vm, node, b2, sizeof (*t));
-		  t->sw_if_index = sw_if_index2;
-		  clib_memcpy (t->src, h2->src_address, 6);
-		  clib_memcpy (t->dst, h2->dst_address, 6);
-		}
-	      if (b3->flags & VLIB_BUFFER_IS_TRACED)
-		{
-		  ethernet_header_t *h3 = vlib_buffer_get_current (b3);
-		  l2input_trace_t *t =
-		    vlib_add_trace (vm, node, b3, sizeof (*t));
-		  t->sw_if_index = sw_if_index3;
-		  clib_memcpy (t->src, h3->src_address, 6);
-		  clib_memcpy (t->dst, h3->dst_address, 6);
-		}
-	    }
+      /*
+       * Don't bother prefetching the bridge-domain config (which
+       * depends on the input config above). Only a small number of
+       * bridge domains are expected. Plus the structure is small
+       * and several fit in a cache line.
+       */
 
-	  classify_and_dispatch (msm, b0, &next0);
-	  classify_and_dispatch (msm, b1, &next1);
-	  classify_and_dispatch (msm, b2, &next2);
-	  classify_and_dispatch (msm, b3, &next3);
-
-	  /* verify speculative enqueues, maybe switch current next frame */
-	  /* if next0==next1==next_index then nothing special needs to be done */
-	  vlib_validate_buffer_enqueue_x4 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, bi1, bi2, bi3,
-					   next0, next1, next2, next3);
-	}
+      b0 = b[0];
+      b1 = b[1];
+      b2 = b[2];
+      b3 = b[3];
 
-      while (n_left_from > 0 && n_left_to_next > 0)
+      if (do_trace)
 	{
-	  u32 bi0;
-	  vlib_buffer_t *b0;
-	  u32 next0;
-	  u32 sw_if_index0;
-
-	  /* speculatively enqueue b0 to the current next frame */
-	  bi0 = from[0];
-	  to_next[0] = bi0;
-	  from += 1;
-	  to_next += 1;
-	  n_left_from -= 1;
-	  n_left_to_next -= 1;
-
-	  b0 = vlib_get_buffer (vm, bi0);
-
-	  if (do_trace && PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	  /* RX interface handles */
+	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
+	  sw_if_index1 = vnet_buffer (b1)->sw_if_index[VLIB_RX];
+	  sw_if_index2 = vnet_buffer (b2)->sw_if_index[VLIB_RX];
+	  sw_if_index3 = vnet_buffer (b3)->sw_if_index[VLIB_RX];
+
+	  if (b0->flags & VLIB_BUFFER_IS_TRACED)
 	    {
 	      ethernet_header_t *h0 = vlib_buffer_get_current (b0);
-	      l2input_trace_t *t = vlib_add_trace (vm, node, b0, sizeof (*t));
-	      sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
+	      l2input_trace_t *t =
+		vlib_add_trace (vm, node, b0, sizeof (*t));
 	      t->sw_if_index = sw_if_index0;
 	      clib_memcpy (t->src, h0->src_address, 6);
 	      clib_memcpy (t->dst, h0->dst_address, 6);
 	    }
+	  if (b1->flags & VLIB_BUFFER_IS_TRACED)
+	    {
+	      ethernet_header_t *h1 = vlib_buffer_get_current (b1);
+	      l2input_trace_t *t =
+		vlib_add_trace (vm, node, b1, sizeof (*t));
+	      t->sw_if_index = sw_if_index1;
+	      clib_memcpy (t->src, h1->src_address, 6);
+	      clib_memcpy (t->dst, h1->dst_address, 6);
+	    }
+	  if (b2->flags & VLIB_BUFFER_IS_TRACED)
+	    {
+	      ethernet_header_t *h2 = vlib_buffer_get_current (b2);
+	      l2input_trace_t *t =
+		vlib_add_trace (vm, node, b2, sizeof (*t));
+	      t->sw_if_index = sw_if_index2;
+	      clib_memcpy (t->src, h2->src_address, 6);
+	      clib_memcpy (t->dst, h2->dst_address, 6);
+	    }
+	  if (b3->flags & VLIB_BUFFER_IS_TRACED)
+	    {
+	      ethernet_header_t *h3 = vlib_buffer_get_current (b3);
+	      l2input_trace_t *t =
+		vlib_add_trace (vm, node, b3, sizeof (*t));
+	      t->sw_if_index = sw_if_index3;
+	      clib_memcpy (t->src, h3->src_address, 6);
+	      clib_memcpy (t->dst, h3->dst_address, 6);
+	    }
+	}
+
+      classify_and_dispatch (msm, b0, &next0);
+      classify_and_dispatch (msm, b1, &next1);
+      classify_and_dispatch (msm, b2, &next2);
+      classify_and_dispatch (msm, b3, &next3);
+
+      next[0] = next0;
+      next[1] = next1;
+      next[2] = next2;
+      next[3] = next3;
+
+      b += 4;
+      next += 4;
+      n_left_from -= 4;
+    }
 
-	  classify_and_dispatch (msm, b0, &next0);
+  while (n_left_from > 0)
+    {
+      vlib_buffer_t *b0;
+      u32 next0;
+      u32 sw_if_index0;
 
-	  /* verify speculative enqueue, maybe switch current next frame */
-	  vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
-					   to_next, n_left_to_next,
-					   bi0, next0);
+      b0 = b[0];
+
+      if (do_trace && PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
+	{
+	  ethernet_header_t *h0 = vlib_buffer_get_current (b0);
+	  l2input_trace_t *t = vlib_add_trace (vm, node, b0, sizeof (*t));
+	  sw_if_index0 = vnet_buffer (b0)->sw_if_index[VLIB_RX];
+	  t->sw_if_index = sw_if_index0;
+	  clib_memcpy (t->src, h0->src_address, 6);
+	  clib_memcpy (t->dst, h0->dst_address, 6);
 	}
 
-      vlib_put_next_frame (vm, node, next_index, n_left_to_next);
+      classify_and_dispatch (msm, b0, &next0);
+
+      next[0] = next0;
+
+      b += 1;
+      next += 1;
+      n_left_from -= 1;
     }
 
+  vlib_buffer_enqueue_to_next (vm, node, from, nexts, frame->n_vectors);
+
   vlib_node_increment_counter (vm, l2input_node.index,
 			       L2INPUT_ERROR_L2INPUT, frame->n_vectors);
 
   return frame->n_vectors;
 }
 
-static uword
-l2input_node_fn (vlib_main_t * vm,
-		 vlib_node_runtime_t * node, vlib_frame_t * frame)
+VLIB_NODE_FN (l2input_node) (vlib_main_t * vm,
+			     vlib_node_runtime_t * node,
+			     vlib_frame_t * frame)
 {
   if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)))
     return l2input_node_inline (vm, node, frame, 1 /* do_trace */ );
   return l2input_node_inline (vm, node, frame, 0 /* do_trace */ );
 }
 
+#ifndef CLIB_MARCH_VARIANT
 /* *INDENT-OFF* */
 VLIB_REGISTER_NODE (l2input_node) = {
-  .function = l2input_node_fn,
   .name = "l2-input",
   .vector_size = sizeof (u32),
   .format_trace = format_l2input_trace,
@@ -477,8 +450,8 @@ VLIB_REGISTER_NODE (l2input_node) = {
 };
 /* *INDENT-ON* */
 
-VLIB_NODE_FUNCTION_MULTIARCH (l2input_node, l2input_node_fn)
-     clib_error_t *l2input_init (vlib_main_t * vm)
+clib_error_t *
+l2input_init (vlib_main_t * vm)
 {
   l2input_main_t *mp = &l2input_main;
 
@@ -1163,6 +1136,7 @@ while (0);
 }
 
 VLIB_INIT_FUNCTION (l2_init);
+#endif /* CLIB_MARCH_VARIANT */
 
 /*
  * fd.io coding-style-patch-verification: ON
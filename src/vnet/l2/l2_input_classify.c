@@ -355,10 +355,14 @@ l2_input_classify_node_fn (vlib_main_t * vm,
 
 	  if (PREDICT_TRUE (table_index0 != ~0))
 	    {
-	      hash0 = vnet_buffer (b0)->l2_classify.hash;
-	      t0 = pool_elt_at_index (vcm->tables, table_index0);
+	      u32 hit_table_index0;
 
-	      e0 = vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
+	      hash0 = vnet_buffer (b0)->l2_classify.hash;
+	      /* all the tables of the chain are searched together */
+	      e0 = vnet_classify_find_entry_chain (vcm, table_index0,
+						   (u8 *) h0, hash0, now,
+						   &hit_table_index0);
+	      t0 = pool_elt_at_index (vcm->tables, hit_table_index0);
 	      if (e0)
 		{
 		  vnet_buffer (b0)->l2_classify.opaque_index
@@ -367,37 +371,13 @@ l2_input_classify_node_fn (vlib_main_t * vm,
 		  next0 = (e0->next_index < n_next_nodes) ?
 		    e0->next_index : next0;
 		  hits++;
+		  chain_hits += hit_table_index0 != table_index0;
 		}
 	      else
 		{
-		  while (1)
-		    {
-		      if (t0->next_table_index != ~0)
-			t0 = pool_elt_at_index (vcm->tables,
-						t0->next_table_index);
-		      else
-			{
-			  next0 = (t0->miss_next_index < n_next_nodes) ?
-			    t0->miss_next_index : next0;
-			  misses++;
-			  break;
-			}
-
-		      hash0 = vnet_classify_hash_packet (t0, (u8 *) h0);
-		      e0 =
-			vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
-		      if (e0)
-			{
-			  vnet_buffer (b0)->l2_classify.opaque_index
-			    = e0->opaque_index;
-			  vlib_buffer_advance (b0, e0->advance);
-			  next0 = (e0->next_index < n_next_nodes) ?
-			    e0->next_index : next0;
-			  hits++;
-			  chain_hits++;
-			  break;
-			}
-		    }
+		  next0 = (t0->miss_next_index < n_next_nodes) ?
+		    t0->miss_next_index : next0;
+		  misses++;
 		}
 	    }
 
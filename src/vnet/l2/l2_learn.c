@@ -105,11 +105,49 @@ typedef enum
 } l2learn_next_t;
 
 
+/** Queue a learned or moved mac for the L2 MAC event client. */
+
+static_always_inline void
+l2learn_queue_event (l2learn_per_thread_data_t * ptd,
+		     l2fib_entry_key_t * key, u32 sw_if_index, u8 action)
+{
+  l2learn_event_t *e;
+
+  clib_spinlock_lock (&ptd->event_lock);
+  if (PREDICT_FALSE (vec_len (ptd->events) >= L2LEARN_EVENT_QUEUE_MAX))
+    ptd->n_events_dropped++;
+  else
+    {
+      vec_add2 (ptd->events, e, 1);
+      e->key = *key;
+      e->sw_if_index = sw_if_index;
+      e->action = action;
+    }
+  clib_spinlock_unlock (&ptd->event_lock);
+}
+
+/** Drop the macs queued for the L2 MAC event client when it goes away,
+    they must not reach the next client. */
+void
+l2learn_flush_events (void)
+{
+  l2learn_main_t *lm = &l2learn_main;
+  l2learn_per_thread_data_t *ptd;
+
+  vec_foreach (ptd, lm->per_thread_data)
+  {
+    clib_spinlock_lock (&ptd->event_lock);
+    vec_reset_length (ptd->events);
+    clib_spinlock_unlock (&ptd->event_lock);
+  }
+}
+
 /** Perform learning on one packet based on the mac table lookup result. */
 
 static_always_inline void
 l2learn_process (vlib_node_runtime_t * node,
 		 l2learn_main_t * msm,
+		 l2learn_per_thread_data_t * ptd,
 		 u64 * counter_base,
 		 vlib_buffer_t * b0,
 		 u32 sw_if_index0,
@@ -118,6 +156,8 @@ l2learn_process (vlib_node_runtime_t * node,
 		 u32 * count,
 		 l2fib_entry_result_t * result0, u32 * next0, u8 timestamp)
 {
+  u8 action = ~0;
+
   /* Set up the default next node (typically L2FWD) */
   *next0 = vnet_l2_feature_next (b0, msm->feat_next_node_index,
 				 L2INPUT_FEAT_LEARN);
@@ -168,10 +208,10 @@ l2learn_process (vlib_node_runtime_t * node,
 	return;
 
       /* It is ok to learn */
-      msm->global_learn_count++;
+      __sync_fetch_and_add (&msm->global_learn_count, 1);
       result0->raw = 0;		/* clear all fields */
       result0->fields.sw_if_index = sw_if_index0;
-      result0->fields.lrn_evt = (msm->client_pid != 0);
+      action = MAC_EVENT_ACTION_ADD;
     }
   else
     {
@@ -203,11 +243,10 @@ l2learn_process (vlib_node_runtime_t * node,
       result0->fields.sw_if_index = sw_if_index0;
       if (result0->fields.age_not)	/* The mac was provisioned */
 	{
-	  msm->global_learn_count++;
+	  __sync_fetch_and_add (&msm->global_learn_count, 1);
 	  result0->fields.age_not = 0;
 	}
-      result0->fields.lrn_evt = (msm->client_pid != 0);
-      result0->fields.lrn_mov = (msm->client_pid != 0);
+      action = MAC_EVENT_ACTION_MOVE;
       counter_base[L2LEARN_ERROR_MAC_MOVE] += 1;
     }
 
@@ -222,6 +261,13 @@ l2learn_process (vlib_node_runtime_t * node,
 
   /* Invalidate the cache */
   cached_key->raw = ~0;
+
+  if (action != (u8) ~ 0)
+    {
+      ptd->n_learned++;
+      if (msm->client_pid)
+	l2learn_queue_event (ptd, key0, sw_if_index0, action);
+    }
 }
 
 
@@ -232,6 +278,8 @@ l2learn_node_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   u32 n_left_from, *from, *to_next;
   l2learn_next_t next_index;
   l2learn_main_t *msm = &l2learn_main;
+  l2learn_per_thread_data_t *ptd =
+    vec_elt_at_index (msm->per_thread_data, vm->thread_index);
   vlib_node_t *n = vlib_get_node (vm, l2learn_node.index);
   u32 node_counter_base_index = n->error_heap_index;
   vlib_error_main_t *em = &vm->error_main;
@@ -372,19 +420,23 @@ l2learn_node_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 			  &bucket0, &bucket1, &bucket2, &bucket3,
 			  &result0, &result1, &result2, &result3);
 
-	  l2learn_process (node, msm, &em->counters[node_counter_base_index],
+	  l2learn_process (node, msm, ptd,
+			   &em->counters[node_counter_base_index],
 			   b0, sw_if_index0, &key0, &cached_key,
 			   &count, &result0, &next0, timestamp);
 
-	  l2learn_process (node, msm, &em->counters[node_counter_base_index],
+	  l2learn_process (node, msm, ptd,
+			   &em->counters[node_counter_base_index],
 			   b1, sw_if_index1, &key1, &cached_key,
 			   &count, &result1, &next1, timestamp);
 
-	  l2learn_process (node, msm, &em->counters[node_counter_base_index],
+	  l2learn_process (node, msm, ptd,
+			   &em->counters[node_counter_base_index],
 			   b2, sw_if_index2, &key2, &cached_key,
 			   &count, &result2, &next2, timestamp);
 
-	  l2learn_process (node, msm, &em->counters[node_counter_base_index],
+	  l2learn_process (node, msm, ptd,
+			   &em->counters[node_counter_base_index],
 			   b3, sw_if_index3, &key3, &cached_key,
 			   &count, &result3, &next3, timestamp);
 
@@ -439,7 +491,8 @@ l2learn_node_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 			  h0->src_address, vnet_buffer (b0)->l2.bd_index,
 			  &key0, &bucket0, &result0);
 
-	  l2learn_process (node, msm, &em->counters[node_counter_base_index],
+	  l2learn_process (node, msm, ptd,
+			   &em->counters[node_counter_base_index],
 			   b0, sw_if_index0, &key0, &cached_key,
 			   &count, &result0, &next0, timestamp);
 
@@ -489,10 +542,16 @@ VLIB_NODE_FUNCTION_MULTIARCH (l2learn_node, l2learn_node_fn)
      clib_error_t *l2learn_init (vlib_main_t * vm)
 {
   l2learn_main_t *mp = &l2learn_main;
+  l2learn_per_thread_data_t *ptd;
 
   mp->vlib_main = vm;
   mp->vnet_main = vnet_get_main ();
 
+  vec_validate_aligned (mp->per_thread_data, vlib_num_workers (),
+			CLIB_CACHE_LINE_BYTES);
+  vec_foreach (ptd, mp->per_thread_data)
+    clib_spinlock_init (&ptd->event_lock);
+
   /* Initialize the feature next-node indexes */
   feat_bitmap_init_next_nodes (vm,
 			       l2learn_node.index,
@@ -20,6 +20,30 @@
 
 #include <vlib/vlib.h>
 #include <vnet/ethernet/ethernet.h>
+#include <vnet/l2/l2_fib.h>
+
+/* MAC learned or moved on a worker, waiting to go out in a MAC event */
+typedef struct
+{
+  l2fib_entry_key_t key;
+  u32 sw_if_index;
+  u8 action;
+} l2learn_event_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /* events queued by this thread, drained by the mac age scanner */
+  clib_spinlock_t event_lock;
+  l2learn_event_t *events;
+
+  /* macs learned or moved by this thread */
+  u64 n_learned;
+
+  /* events dropped because the event client was not keeping up */
+  u64 n_events_dropped;
+} l2learn_per_thread_data_t;
 
 
 typedef struct
@@ -38,6 +62,9 @@ typedef struct
   u32 client_pid;
   u32 client_index;
 
+  /* per-thread learn event queues and counters */
+  l2learn_per_thread_data_t *per_thread_data;
+
   /* Next nodes for each feature */
   u32 feat_next_node_index[32];
 
@@ -48,8 +75,13 @@ typedef struct
 
 #define L2LEARN_DEFAULT_LIMIT (L2FIB_NUM_BUCKETS * 64)
 
+/* Max MAC events a thread holds before dropping new ones */
+#define L2LEARN_EVENT_QUEUE_MAX (16 * 1024)
+
 extern l2learn_main_t l2learn_main;
 
+void l2learn_flush_events (void);
+
 extern vlib_node_registration_t l2fib_mac_age_scanner_process_node;
 
 enum
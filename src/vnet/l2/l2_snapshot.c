@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief L2 state in warm restart snapshots.
+ *
+ * The "l2" section holds the bridge domains with their ARP termination
+ * entries, the bridge and cross-connect mode of the interfaces, and
+ * the L2 FIB. Learned MACs are restored as learned, so they age out
+ * as they would have, instead of the bridge flooding until they are
+ * learned again.
+ */
+
+#include <vnet/snapshot/snapshot.h>
+#include <vnet/l2/l2_input.h>
+#include <vnet/l2/l2_bd.h>
+#include <vnet/l2/l2_fib.h>
+
+static void
+l2_snapshot_save_bds (serialize_main_t * m)
+{
+  l2input_main_t *l2im = &l2input_main;
+  l2_bridge_domain_t *bd, **bds = 0, **bdp;
+  u32 ip4, n;
+  u64 mac;
+  ip6_address_t *ip6;
+
+  vec_foreach (bd, l2im->bd_configs)
+  {
+    /* bd 0 is the default, always there */
+    if (bd_is_valid (bd) && bd->bd_id != 0 && bd->bd_id != ~0)
+      vec_add1 (bds, bd);
+  }
+
+  serialize_likely_small_unsigned_integer (m, vec_len (bds));
+  vec_foreach (bdp, bds)
+  {
+    bd = *bdp;
+    serialize_integer (m, bd->bd_id, sizeof (u32));
+    serialize_integer (m, bd->feature_bitmap, sizeof (u32));
+    serialize_integer (m, bd->mac_age, sizeof (u8));
+    serialize_cstring (m, bd->bd_tag ? (char *) bd->bd_tag : "");
+
+    n = hash_elts (bd->mac_by_ip4);
+    serialize_likely_small_unsigned_integer (m, n);
+    /* *INDENT-OFF* */
+    hash_foreach (ip4, mac, bd->mac_by_ip4,
+    ({
+      serialize_vnet_snapshot_data (m, &ip4, sizeof (ip4));
+      serialize_vnet_snapshot_data (m, &mac, 6);
+    }));
+    /* *INDENT-ON* */
+
+    n = hash_elts (bd->mac_by_ip6);
+    serialize_likely_small_unsigned_integer (m, n);
+    /* *INDENT-OFF* */
+    hash_foreach_mem (ip6, mac, bd->mac_by_ip6,
+    ({
+      serialize_vnet_snapshot_data (m, ip6, sizeof (*ip6));
+      serialize_vnet_snapshot_data (m, &mac, 6);
+    }));
+    /* *INDENT-ON* */
+  }
+
+  vec_free (bds);
+}
+
+static void
+l2_snapshot_restore_bds (serialize_main_t * m)
+{
+  l2_bridge_domain_add_del_args_t a;
+  u32 n_bds, n, bd_index, feature_bitmap;
+  ip46_address_t ip;
+  char *tag;
+  u64 mac;
+  int rv;
+
+  n_bds = unserialize_likely_small_unsigned_integer (m);
+  while (n_bds--)
+    {
+      memset (&a, 0, sizeof (a));
+      unserialize_integer (m, &a.bd_id, sizeof (u32));
+      unserialize_integer (m, &feature_bitmap, sizeof (u32));
+      unserialize_integer (m, &a.mac_age, sizeof (u8));
+      unserialize_cstring (m, &tag);
+
+      a.is_add = 1;
+      a.flood = !!(feature_bitmap & L2INPUT_FEAT_FLOOD);
+      a.uu_flood = !!(feature_bitmap & L2INPUT_FEAT_UU_FLOOD);
+      a.forward = !!(feature_bitmap & L2INPUT_FEAT_FWD);
+      a.learn = !!(feature_bitmap & L2INPUT_FEAT_LEARN);
+      a.arp_term = !!(feature_bitmap & L2INPUT_FEAT_ARP_TERM);
+      a.bd_tag = tag[0] ? (u8 *) tag : NULL;
+
+      rv = bd_add_del (&a);
+      vec_free (tag);
+      bd_index = bd_find_index (&bd_main, a.bd_id);
+      if (rv && VNET_API_ERROR_BD_ALREADY_EXISTS != rv)
+	bd_index = ~0;
+
+      n = unserialize_likely_small_unsigned_integer (m);
+      while (n--)
+	{
+	  mac = 0;
+	  unserialize_vnet_snapshot_data (m, &ip.ip4, sizeof (ip.ip4));
+	  unserialize_vnet_snapshot_data (m, &mac, 6);
+	  if (~0 != bd_index)
+	    bd_add_del_ip_mac (bd_index, (u8 *) & ip.ip4, (u8 *) & mac,
+			       0 /* is_ip6 */ , 1 /* is_add */ );
+	}
+
+      n = unserialize_likely_small_unsigned_integer (m);
+      while (n--)
+	{
+	  mac = 0;
+	  unserialize_vnet_snapshot_data (m, &ip.ip6, sizeof (ip.ip6));
+	  unserialize_vnet_snapshot_data (m, &mac, 6);
+	  if (~0 != bd_index)
+	    bd_add_del_ip_mac (bd_index, (u8 *) & ip.ip6, (u8 *) & mac,
+			       1 /* is_ip6 */ , 1 /* is_add */ );
+	}
+
+      if (~0 == bd_index)
+	vnet_snapshot_skip ();
+    }
+}
+
+static void
+l2_snapshot_save_interfaces (serialize_main_t * m)
+{
+  l2input_main_t *l2im = &l2input_main;
+  vnet_main_t *vnm = vnet_get_main ();
+  l2_input_config_t *config;
+  u32 sw_if_index, n = 0;
+
+  vec_foreach_index (sw_if_index, l2im->configs)
+  {
+    config = vec_elt_at_index (l2im->configs, sw_if_index);
+    n += ((config->bridge || config->xconnect) &&
+	  vnet_sw_interface_is_valid (vnm, sw_if_index));
+  }
+
+  serialize_likely_small_unsigned_integer (m, n);
+  vec_foreach_index (sw_if_index, l2im->configs)
+  {
+    config = vec_elt_at_index (l2im->configs, sw_if_index);
+    if (!(config->bridge || config->xconnect) ||
+	!vnet_sw_interface_is_valid (vnm, sw_if_index))
+      continue;
+
+    serialize_vnet_snapshot_sw_if_index (m, sw_if_index);
+    if (config->bridge)
+      {
+	serialize_integer (m, MODE_L2_BRIDGE, sizeof (u8));
+	serialize_integer (m, l2input_bd_config (config->bd_index)->bd_id,
+			   sizeof (u32));
+	serialize_integer (m, config->bvi, sizeof (u8));
+	serialize_integer (m, config->shg, sizeof (u8));
+      }
+    else
+      {
+	serialize_integer (m, MODE_L2_XC, sizeof (u8));
+	serialize_vnet_snapshot_sw_if_index (m, config->output_sw_if_index);
+      }
+  }
+}
+
+static void
+l2_snapshot_restore_interfaces (serialize_main_t * m)
+{
+  vnet_main_t *vnm = vnet_get_main ();
+  vlib_main_t *vm = vlib_get_main ();
+  u32 n, mode, sw_if_index, bd_id, bd_index, bvi, shg, xc_sw_if_index;
+  int skip;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+      mode = bvi = shg = 0;
+      bd_index = xc_sw_if_index = ~0;
+      unserialize_integer (m, &mode, sizeof (u8));
+
+      if (MODE_L2_BRIDGE == mode)
+	{
+	  unserialize_integer (m, &bd_id, sizeof (u32));
+	  unserialize_integer (m, &bvi, sizeof (u8));
+	  unserialize_integer (m, &shg, sizeof (u8));
+	  bd_index = bd_find_index (&bd_main, bd_id);
+	  if (~0 == bd_index)
+	    {
+	      vnet_snapshot_skip ();
+	      continue;
+	    }
+	}
+      else if (MODE_L2_XC == mode)
+	skip |= unserialize_vnet_snapshot_sw_if_index (m, &xc_sw_if_index);
+      else
+	serialize_error_return (m, "unknown l2 mode %d", mode);
+
+      if (skip)
+	continue;
+
+      if (set_int_l2_mode (vm, vnm, mode, sw_if_index, bd_index, bvi, shg,
+			   xc_sw_if_index))
+	vnet_snapshot_skip ();
+    }
+}
+
+static void
+l2_snapshot_save_fib (serialize_main_t * m)
+{
+  l2fib_entry_key_t *keys = 0, *key;
+  l2fib_entry_result_t *results = 0, *result;
+  u32 n = 0;
+
+  l2fib_table_dump (~0, &keys, &results);
+
+  /* BVI entries are added back with the BVI interface */
+  vec_foreach (result, results) n += !result->fields.bvi;
+
+  serialize_likely_small_unsigned_integer (m, n);
+  vec_foreach (key, keys)
+  {
+    result = vec_elt_at_index (results, key - keys);
+    if (result->fields.bvi)
+      continue;
+
+    serialize_vnet_snapshot_data (m, key->fields.mac, 6);
+    serialize_integer (m, l2input_bd_config (key->fields.bd_index)->bd_id,
+		       sizeof (u32));
+    serialize_vnet_snapshot_sw_if_index (m, result->fields.filter ? ~0 :
+					 result->fields.sw_if_index);
+    serialize_integer (m, result->fields.static_mac, sizeof (u8));
+    serialize_integer (m, result->fields.filter, sizeof (u8));
+    serialize_integer (m, result->fields.age_not, sizeof (u8));
+  }
+
+  vec_free (keys);
+  vec_free (results);
+}
+
+static void
+l2_snapshot_restore_fib (serialize_main_t * m)
+{
+  u32 n, bd_id, bd_index, sw_if_index;
+  u8 static_mac, filter, age_not;
+  /* l2fib_make_key () reads 8 bytes */
+  u8 mac[8] = { 0 };
+  int skip;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      unserialize_vnet_snapshot_data (m, mac, 6);
+      unserialize_integer (m, &bd_id, sizeof (u32));
+      skip = unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index);
+      unserialize_integer (m, &static_mac, sizeof (u8));
+      unserialize_integer (m, &filter, sizeof (u8));
+      unserialize_integer (m, &age_not, sizeof (u8));
+
+      bd_index = bd_find_index (&bd_main, bd_id);
+      if (~0 == bd_index)
+	{
+	  vnet_snapshot_skip ();
+	  continue;
+	}
+      if (skip)
+	continue;
+
+      if (filter)
+	l2fib_add_filter_entry (mac, bd_index);
+      else if (age_not)
+	l2fib_add_fwd_entry (mac, bd_index, sw_if_index, static_mac, 0);
+      else
+	l2fib_add_learned_entry (mac, bd_index, sw_if_index);
+    }
+}
+
+static void
+l2_snapshot_save (serialize_main_t * m, va_list * va)
+{
+  l2_snapshot_save_bds (m);
+  l2_snapshot_save_interfaces (m);
+  l2_snapshot_save_fib (m);
+}
+
+static void
+l2_snapshot_restore (serialize_main_t * m, va_list * va)
+{
+  l2_snapshot_restore_bds (m);
+  l2_snapshot_restore_interfaces (m);
+  l2_snapshot_restore_fib (m);
+}
+
+/* *INDENT-OFF* */
+VNET_SNAPSHOT_SECTION (l2, static) = {
+  .name = "l2",
+  .save = l2_snapshot_save,
+  .restore = l2_snapshot_restore,
+};
+/* *INDENT-ON* */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
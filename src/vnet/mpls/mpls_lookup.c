@@ -32,12 +32,19 @@ static vlib_node_registration_t mpls_lookup_node;
  */
 u32 mpls_lookup_to_replicate_edge;
 
+/**
+ * The arcs/edges from the MPLS lookup node to the MPLS lookup DPO nodes
+ */
+u32 mpls_lookup_to_lookup_edge;
+u32 mpls_lookup_to_lookup_itf_edge;
+
 typedef struct {
   u32 next_index;
   u32 lb_index;
   u32 lfib_index;
   u32 label_net_byte_order;
   u32 hash;
+  u32 n_labels;
 } mpls_lookup_trace_t;
 
 static u8 *
@@ -48,15 +55,29 @@ format_mpls_lookup_trace (u8 * s, va_list * args)
   mpls_lookup_trace_t * t = va_arg (*args, mpls_lookup_trace_t *);
 
   s = format (s, "MPLS: next [%d], lookup fib index %d, LB index %d hash %x "
-              "label %d eos %d", 
+              "label %d eos %d n-labels %d",
               t->next_index, t->lfib_index, t->lb_index, t->hash,
               vnet_mpls_uc_get_label(
                   clib_net_to_host_u32(t->label_net_byte_order)),
               vnet_mpls_uc_get_s(
-                  clib_net_to_host_u32(t->label_net_byte_order)));
+                  clib_net_to_host_u32(t->label_net_byte_order)),
+              t->n_labels);
   return s;
 }
 
+/**
+ * Prefetch the LFIB entry of the label at the head of a buffer whose
+ * header and data have been prefetched already.
+ */
+static_always_inline void
+mpls_lookup_prefetch_lfib (mpls_main_t * mm, vlib_buffer_t * b)
+{
+  mpls_fib_table_forwarding_lookup_prefetch (
+      vec_elt(mm->fib_index_by_sw_if_index,
+              vnet_buffer(b)->sw_if_index[VLIB_RX]),
+      vlib_buffer_get_current (b));
+}
+
 static inline uword
 mpls_lookup (vlib_main_t * vm,
              vlib_node_runtime_t * node,
@@ -80,28 +101,52 @@ mpls_lookup (vlib_main_t * vm,
 
       while (n_left_from >= 8 && n_left_to_next >= 4)
         {
-          u32 lbi0, next0, lfib_index0, bi0, hash_c0;
+          u32 lbi0, next0, lfib_index0, bi0, hash_c0, n_labels0;
           const mpls_unicast_header_t * h0;
           const load_balance_t *lb0;
           const dpo_id_t *dpo0;
           vlib_buffer_t * b0;
-          u32 lbi1, next1, lfib_index1, bi1, hash_c1;
+          u32 lbi1, next1, lfib_index1, bi1, hash_c1, n_labels1;
           const mpls_unicast_header_t * h1;
           const load_balance_t *lb1;
           const dpo_id_t *dpo1;
           vlib_buffer_t * b1;
-          u32 lbi2, next2, lfib_index2, bi2, hash_c2;
+          u32 lbi2, next2, lfib_index2, bi2, hash_c2, n_labels2;
           const mpls_unicast_header_t * h2;
           const load_balance_t *lb2;
           const dpo_id_t *dpo2;
           vlib_buffer_t * b2;
-          u32 lbi3, next3, lfib_index3, bi3, hash_c3;
+          u32 lbi3, next3, lfib_index3, bi3, hash_c3, n_labels3;
           const mpls_unicast_header_t * h3;
           const load_balance_t *lb3;
           const dpo_id_t *dpo3;
           vlib_buffer_t * b3;
 
-           /* Prefetch next iteration. */
+          /*
+           * Prefetch the buffers of the iteration after next, and the
+           * LFIB entries of the next iteration's labels, whose buffers
+           * were prefetched in the last one. The LFIB is a flat array
+           * indexed by label, so its entries are rarely in the cache.
+           */
+          if (n_left_from >= 12)
+          {
+              vlib_buffer_t *p8, *p9, *p10, *p11;
+
+            p8 = vlib_get_buffer (vm, from[8]);
+            p9 = vlib_get_buffer (vm, from[9]);
+            p10 = vlib_get_buffer (vm, from[10]);
+            p11 = vlib_get_buffer (vm, from[11]);
+
+            vlib_prefetch_buffer_header (p8, STORE);
+            vlib_prefetch_buffer_header (p9, STORE);
+            vlib_prefetch_buffer_header (p10, STORE);
+            vlib_prefetch_buffer_header (p11, STORE);
+
+            CLIB_PREFETCH (p8->data, sizeof (h0[0]), LOAD);
+            CLIB_PREFETCH (p9->data, sizeof (h0[0]), LOAD);
+            CLIB_PREFETCH (p10->data, sizeof (h0[0]), LOAD);
+            CLIB_PREFETCH (p11->data, sizeof (h0[0]), LOAD);
+          }
           {
               vlib_buffer_t *p4, *p5, *p6, *p7;
 
@@ -110,15 +155,10 @@ mpls_lookup (vlib_main_t * vm,
             p6 = vlib_get_buffer (vm, from[6]);
             p7 = vlib_get_buffer (vm, from[7]);
 
-            vlib_prefetch_buffer_header (p4, STORE);
-            vlib_prefetch_buffer_header (p5, STORE);
-            vlib_prefetch_buffer_header (p6, STORE);
-            vlib_prefetch_buffer_header (p7, STORE);
-
-            CLIB_PREFETCH (p4->data, sizeof (h0[0]), LOAD);
-            CLIB_PREFETCH (p5->data, sizeof (h0[0]), LOAD);
-            CLIB_PREFETCH (p6->data, sizeof (h0[0]), LOAD);
-            CLIB_PREFETCH (p7->data, sizeof (h0[0]), LOAD);
+            mpls_lookup_prefetch_lfib (mm, p4);
+            mpls_lookup_prefetch_lfib (mm, p5);
+            mpls_lookup_prefetch_lfib (mm, p6);
+            mpls_lookup_prefetch_lfib (mm, p7);
           }
 
           bi0 = to_next[0] = from[0];
@@ -315,6 +355,20 @@ mpls_lookup (vlib_main_t * vm,
           vlib_buffer_advance(b2, sizeof(*h2));
           vlib_buffer_advance(b3, sizeof(*h3));
 
+          /*
+           * look up the labels below it too, if that is what the
+           * popped one's forwarding asks for
+           */
+          n_labels0 = n_labels1 = n_labels2 = n_labels3 = 1;
+          next0 = mpls_lookup_next_labels (vm, b0, next0, thread_index,
+                                           &n_labels0);
+          next1 = mpls_lookup_next_labels (vm, b1, next1, thread_index,
+                                           &n_labels1);
+          next2 = mpls_lookup_next_labels (vm, b2, next2, thread_index,
+                                           &n_labels2);
+          next3 = mpls_lookup_next_labels (vm, b3, next3, thread_index,
+                                           &n_labels3);
+
           if (PREDICT_FALSE(b0->flags & VLIB_BUFFER_IS_TRACED))
           {
               mpls_lookup_trace_t *tr = vlib_add_trace (vm, node,
@@ -324,6 +378,7 @@ mpls_lookup (vlib_main_t * vm,
               tr->lfib_index = lfib_index0;
               tr->hash = hash_c0;
               tr->label_net_byte_order = h0->label_exp_s_ttl;
+              tr->n_labels = n_labels0;
           }
 
           if (PREDICT_FALSE(b1->flags & VLIB_BUFFER_IS_TRACED))
@@ -335,6 +390,7 @@ mpls_lookup (vlib_main_t * vm,
               tr->lfib_index = lfib_index1;
               tr->hash = hash_c1;
               tr->label_net_byte_order = h1->label_exp_s_ttl;
+              tr->n_labels = n_labels1;
           }
 
           if (PREDICT_FALSE(b2->flags & VLIB_BUFFER_IS_TRACED))
@@ -346,6 +402,7 @@ mpls_lookup (vlib_main_t * vm,
               tr->lfib_index = lfib_index2;
               tr->hash = hash_c2;
               tr->label_net_byte_order = h2->label_exp_s_ttl;
+              tr->n_labels = n_labels2;
           }
 
           if (PREDICT_FALSE(b3->flags & VLIB_BUFFER_IS_TRACED))
@@ -357,6 +414,7 @@ mpls_lookup (vlib_main_t * vm,
               tr->lfib_index = lfib_index3;
               tr->hash = hash_c3;
               tr->label_net_byte_order = h3->label_exp_s_ttl;
+              tr->n_labels = n_labels3;
           }
 
           vlib_validate_buffer_enqueue_x4 (vm, node, next_index,
@@ -367,7 +425,7 @@ mpls_lookup (vlib_main_t * vm,
 
       while (n_left_from > 0 && n_left_to_next > 0)
       {
-          u32 lbi0, next0, lfib_index0, bi0, hash_c0;
+          u32 lbi0, next0, lfib_index0, bi0, hash_c0, n_labels0;
           const mpls_unicast_header_t * h0;
           const load_balance_t *lb0;
           const dpo_id_t *dpo0;
@@ -436,6 +494,10 @@ mpls_lookup (vlib_main_t * vm,
            */
           vlib_buffer_advance(b0, sizeof(*h0));
 
+          n_labels0 = 1;
+          next0 = mpls_lookup_next_labels (vm, b0, next0, thread_index,
+                                           &n_labels0);
+
           if (PREDICT_FALSE(b0->flags & VLIB_BUFFER_IS_TRACED))
           {
               mpls_lookup_trace_t *tr = vlib_add_trace (vm, node,
@@ -445,6 +507,7 @@ mpls_lookup (vlib_main_t * vm,
               tr->lfib_index = lfib_index0;
               tr->hash = hash_c0;
               tr->label_net_byte_order = h0->label_exp_s_ttl;
+              tr->n_labels = n_labels0;
           }
 
           vlib_validate_buffer_enqueue_x1 (vm, node, next_index,
@@ -716,6 +779,14 @@ mpls_lookup_init (vlib_main_t * vm)
       vlib_node_add_named_next(vm,
                                mpls_lookup_node.index,
                                "mpls-replicate");
+  mpls_lookup_to_lookup_edge =
+      vlib_node_add_named_next(vm,
+                               mpls_lookup_node.index,
+                               "lookup-mpls-dst");
+  mpls_lookup_to_lookup_itf_edge =
+      vlib_node_add_named_next(vm,
+                               mpls_lookup_node.index,
+                               "lookup-mpls-dst-itf");
 
   return (NULL);
 }
@@ -18,12 +18,29 @@
 
 #include <vnet/mpls/mpls.h>
 #include <vnet/ip/ip.h>
+#include <vnet/fib/mpls_fib.h>
+#include <vnet/dpo/load_balance_map.h>
+#include <vnet/dpo/lookup_dpo.h>
 
 /**
  * The arc/edge from the MPLS lookup node to the MPLS replicate node
  */
 u32 mpls_lookup_to_replicate_edge;
 
+/**
+ * The arcs/edges from the MPLS lookup node to the MPLS lookup DPO nodes,
+ * i.e. the forwarding of a non-EOS label that is popped and the next
+ * label looked up, in a given table or in the table of the RX interface.
+ */
+extern u32 mpls_lookup_to_lookup_edge;
+extern u32 mpls_lookup_to_lookup_itf_edge;
+
+/**
+ * The maximum number of labels looked up and popped in one visit to an
+ * MPLS lookup node. A deeper stack continues through the lookup DPO nodes.
+ */
+#define MPLS_LOOKUP_MAX_N_LABELS 8
+
 /*
  * Compute flow hash. 
  * We'll use it to select which adjacency to use for this flow.  And other things.
@@ -99,4 +116,92 @@ mpls_compute_flow_hash (const mpls_unicast_header_t * hdr,
     return (hash);
 }
 
+/**
+ * @brief Look up and pop the labels that follow a popped label whose
+ * forwarding is another MPLS lookup.
+ *
+ * Rather than sending the packet to the lookup DPO node once per label,
+ * as the forwarding graph describes, the lookups are done here, until a
+ * label's forwarding goes elsewhere or MPLS_LOOKUP_MAX_N_LABELS labels
+ * have been popped. The buffer meta-data is left as the lookup DPO nodes
+ * would leave it.
+ *
+ * @return The next node for the packet
+ */
+always_inline u32
+mpls_lookup_next_labels (vlib_main_t * vm,
+                         vlib_buffer_t * b0,
+                         u32 next0,
+                         u32 thread_index,
+                         u32 * n_labels)
+{
+    vlib_combined_counter_main_t * cm = &load_balance_main.lbm_to_counters;
+    const mpls_unicast_header_t * h0;
+    const load_balance_t *lb0;
+    const lookup_dpo_t *lkd0;
+    const dpo_id_t *dpo0;
+    u32 lbi0, fib_index0, hash_c0;
+
+    while ((next0 == mpls_lookup_to_lookup_edge ||
+            next0 == mpls_lookup_to_lookup_itf_edge) &&
+           *n_labels < MPLS_LOOKUP_MAX_N_LABELS)
+    {
+        h0 = vlib_buffer_get_current (b0);
+
+        if (next0 == mpls_lookup_to_lookup_itf_edge)
+        {
+            fib_index0 = mpls_fib_table_get_index_for_sw_if_index(
+                vnet_buffer(b0)->sw_if_index[VLIB_RX]);
+        }
+        else
+        {
+            lkd0 = lookup_dpo_get(vnet_buffer(b0)->ip.adj_index[VLIB_TX]);
+            fib_index0 = lkd0->lkd_fib_index;
+        }
+
+        lbi0 = mpls_fib_table_forwarding_lookup (fib_index0, h0);
+
+        if (MPLS_IS_REPLICATE & lbi0)
+        {
+            next0 = mpls_lookup_to_replicate_edge;
+            vnet_buffer (b0)->ip.adj_index[VLIB_TX] =
+                (lbi0 & ~MPLS_IS_REPLICATE);
+        }
+        else
+        {
+            lb0 = load_balance_get(lbi0);
+            ASSERT (lb0->lb_n_buckets > 0);
+            ASSERT (is_pow2 (lb0->lb_n_buckets));
+
+            if (PREDICT_FALSE(lb0->lb_n_buckets > 1))
+            {
+                hash_c0 = vnet_buffer (b0)->ip.flow_hash =
+                    mpls_compute_flow_hash(h0, lb0->lb_hash_config);
+                dpo0 = load_balance_get_fwd_bucket
+                    (lb0,
+                     (hash_c0 & (lb0->lb_n_buckets_minus_1)));
+            }
+            else
+            {
+                dpo0 = load_balance_get_bucket_i (lb0, 0);
+            }
+            next0 = dpo0->dpoi_next_node;
+            vnet_buffer (b0)->ip.adj_index[VLIB_TX] = dpo0->dpoi_index;
+
+            vlib_increment_combined_counter
+                (cm, thread_index, lbi0, 1,
+                 vlib_buffer_length_in_chain (vm, b0));
+        }
+
+        vnet_buffer (b0)->mpls.ttl = ((char*)h0)[3];
+        vnet_buffer (b0)->mpls.exp = (((char*)h0)[2] & 0xe) >> 1;
+        vnet_buffer (b0)->mpls.first = 1;
+        vlib_buffer_advance(b0, sizeof(*h0));
+
+        *n_labels += 1;
+    }
+
+    return (next0);
+}
+
 #endif /* __MPLS_LOOKUP_H__ */
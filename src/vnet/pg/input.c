@@ -911,14 +911,15 @@ pg_generate_fix_multi_buffer_lengths (pg_main_t * pg,
 
   while (n_buffers > 0)
     {
-      vlib_buffer_t *b;
+      vlib_buffer_t *b, *b_first;
+      uword n_bytes_packet;
       u32 bi;
 
       bi = buffers[0];
-      b = vlib_get_buffer (vm, bi);
+      b = b_first = vlib_get_buffer (vm, bi);
 
       /* Current length here is length of whole packet. */
-      n_bytes_left = b->current_length;
+      n_bytes_left = n_bytes_packet = b->current_length;
 
       pbi = s->buffer_indices;
       while (1)
@@ -945,6 +946,14 @@ pg_generate_fix_multi_buffer_lengths (pg_main_t * pg,
 	}
       ASSERT (n_bytes_left == 0);
 
+      /* Spare the nodes walking the chain for the packet length */
+      if (b_first->flags & VLIB_BUFFER_NEXT_PRESENT)
+	{
+	  b_first->total_length_not_including_first_buffer =
+	    n_bytes_packet - b_first->current_length;
+	  b_first->flags |= VLIB_BUFFER_TOTAL_LENGTH_VALID;
+	}
+
       buffers += 1;
       n_buffers -= 1;
     }
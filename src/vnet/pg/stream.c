@@ -436,16 +436,25 @@ pg_stream_add (pg_main_t * pg, pg_stream_t * s_init)
 
   {
     pg_buffer_index_t *bi;
+    vlib_buffer_free_list_index_t free_list_index;
     int n;
 
-    s->buffer_bytes = VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES;
+    /* Larger buffers come from the buffer pool with room for them, if
+       there is one, so that jumbo frames need not be chained. */
+    free_list_index = VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX;
+    if (s->buffer_bytes > VLIB_BUFFER_DEFAULT_FREE_LIST_BYTES)
+      free_list_index =
+	vlib_buffer_get_or_create_free_list (vm, s->buffer_bytes,
+					     "pg %d bytes", s->buffer_bytes);
+
+    s->buffer_bytes = vlib_buffer_free_list_buffer_size (vm, free_list_index);
     n = s->max_packet_bytes / s->buffer_bytes;
     n += (s->max_packet_bytes % s->buffer_bytes) != 0;
 
     vec_resize (s->buffer_indices, n);
 
     vec_foreach (bi, s->buffer_indices)
-      bi->free_list_index = VLIB_BUFFER_DEFAULT_FREE_LIST_INDEX;
+      bi->free_list_index = free_list_index;
   }
 
   /* Find an interface to use. */
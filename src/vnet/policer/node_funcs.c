@@ -358,6 +358,7 @@ test_policer_add_del (u32 rx_sw_if_index, u8 * config_name, int is_add)
       pool_get_aligned (pm->policers, policer, CLIB_CACHE_LINE_BYTES);
 
       policer[0] = template[0];
+      policer_thread_shares_reset (policer - pm->policers);
 
       vec_validate (pm->policer_index_by_sw_if_index, rx_sw_if_index);
       pm->policer_index_by_sw_if_index[rx_sw_if_index]
@@ -692,9 +693,14 @@ policer_classify_inline (vlib_main_t * vm,
 
 	  if (PREDICT_TRUE (table_index0 != ~0))
 	    {
+	      u32 hit_table_index0;
+
 	      hash0 = vnet_buffer (b0)->l2_classify.hash;
-	      t0 = pool_elt_at_index (vcm->tables, table_index0);
-	      e0 = vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
+	      /* all the tables of the chain are searched together */
+	      e0 = vnet_classify_find_entry_chain (vcm, table_index0,
+						   (u8 *) h0, hash0, now,
+						   &hit_table_index0);
+	      t0 = pool_elt_at_index (vcm->tables, hit_table_index0);
 
 	      if (e0)
 		{
@@ -710,46 +716,13 @@ policer_classify_inline (vlib_main_t * vm,
 		      drop++;
 		    }
 		  hits++;
+		  chain_hits += hit_table_index0 != table_index0;
 		}
 	      else
 		{
-		  while (1)
-		    {
-		      if (PREDICT_TRUE (t0->next_table_index != ~0))
-			{
-			  t0 = pool_elt_at_index (vcm->tables,
-						  t0->next_table_index);
-			}
-		      else
-			{
-			  next0 = (t0->miss_next_index < n_next_nodes) ?
-			    t0->miss_next_index : next0;
-			  misses++;
-			  break;
-			}
-
-		      hash0 = vnet_classify_hash_packet (t0, (u8 *) h0);
-		      e0 =
-			vnet_classify_find_entry (t0, (u8 *) h0, hash0, now);
-		      if (e0)
-			{
-			  act0 = vnet_policer_police (vm,
-						      b0,
-						      e0->next_index,
-						      time_in_policer_periods,
-						      e0->opaque_index);
-			  if (PREDICT_FALSE (act0 == SSE2_QOS_ACTION_DROP))
-			    {
-			      next0 = POLICER_CLASSIFY_NEXT_INDEX_DROP;
-			      b0->error =
-				node->errors[POLICER_CLASSIFY_ERROR_DROP];
-			      drop++;
-			    }
-			  hits++;
-			  chain_hits++;
-			  break;
-			}
-		    }
+		  next0 = (t0->miss_next_index < n_next_nodes) ?
+		    t0->miss_next_index : next0;
+		  misses++;
 		}
 	    }
 	  if (PREDICT_FALSE ((node->flags & VLIB_NODE_FLAG_TRACE)
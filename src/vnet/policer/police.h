@@ -15,6 +15,8 @@
 #ifndef __POLICE_H__
 #define __POLICE_H__
 
+#include <vppinfra/cache.h>
+
 typedef enum
 {
   POLICE_CONFORM = 0,
@@ -53,6 +55,17 @@ typedef enum
 // The 64-bit last_update_time supports a 4Ghz CPU without rollover for 100 years
 //
 // The lock field should be used for a spin-lock on the struct.
+//
+// A policer shared by many workers can instead run in per-thread mode
+// (thread_quantum != 0). Each worker then polices against its own share
+// of tokens, see policer_thread_share_t, and the buckets in this struct
+// become a reservoir that is refilled and drained with atomics only.
+// A worker takes up to thread_quantum tokens from the reservoir when its
+// share runs dry, so the reservoir cache line is touched about once per
+// quantum rather than once per packet. The cost is accuracy: tokens held
+// by workers are not available to others, so the aggregate burst can be
+// off by up to n_workers * thread_quantum. A smaller quantum is more
+// accurate, a larger one does fewer atomic operations.
 
 #define POLICER_TICKS_PER_PERIOD_SHIFT 17
 #define POLICER_TICKS_PER_PERIOD       (1 << POLICER_TICKS_PER_PERIOD_SHIFT)
@@ -82,10 +95,20 @@ typedef struct
   u32 extended_bucket;		// MOD
 
   u64 last_update_time;		// MOD
-  u64 pad64;
+  u32 thread_quantum;		// per-thread mode if non-zero, in tokens
+  u32 pad32;
 
 } policer_read_response_type_st;
 
+// A worker's share of a per-thread mode policer's tokens.
+// One per worker and policer, on its own cache line.
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  u32 current_bucket;
+  u32 extended_bucket;
+} policer_thread_share_t;
+
 static inline policer_result_e
 vnet_police_packet (policer_read_response_type_st * policer,
 		    u32 packet_length,
@@ -203,6 +226,133 @@ vnet_police_packet (policer_read_response_type_st * policer,
   return result;
 }
 
+// Add n_periods worth of tokens to a reservoir bucket, up to its limit
+static inline void
+vnet_police_reservoir_add (u32 * bucket, u64 tokens, u32 limit)
+{
+  u32 old, new;
+
+  do
+    {
+      old = *(volatile u32 *) bucket;
+      new = (old + tokens > limit) ? limit : old + tokens;
+    }
+  while (!__sync_bool_compare_and_swap (bucket, old, new));
+}
+
+// Take up to want tokens from a reservoir bucket, returns the number taken
+static inline u32
+vnet_police_reservoir_take (u32 * bucket, u32 want)
+{
+  u32 old, n;
+
+  do
+    {
+      old = *(volatile u32 *) bucket;
+      n = (old < want) ? old : want;
+      if (n == 0)
+	return 0;
+    }
+  while (!__sync_bool_compare_and_swap (bucket, old, old - n));
+
+  return n;
+}
+
+// Refill a per-thread mode policer's reservoir. Whichever worker moves
+// last_update_time forward adds the tokens for the elapsed periods.
+static inline void
+vnet_police_reservoir_refill (policer_read_response_type_st * policer,
+			      u64 time)
+{
+  u64 last, n_periods;
+
+  last = *(volatile u64 *) & policer->last_update_time;
+  if (time <= last)
+    return;
+  if (!__sync_bool_compare_and_swap (&policer->last_update_time, last, time))
+    return;
+
+  // See vnet_police_packet() about why this does not overflow
+  n_periods = time - last;
+
+  vnet_police_reservoir_add (&policer->current_bucket,
+			     n_periods * policer->cir_tokens_per_period,
+			     policer->current_limit);
+  vnet_police_reservoir_add (&policer->extended_bucket,
+			     n_periods * (policer->single_rate ?
+					  policer->cir_tokens_per_period :
+					  policer->pir_tokens_per_period),
+			     policer->extended_limit);
+}
+
+static inline policer_result_e
+vnet_police_packet_per_thread (policer_read_response_type_st * policer,
+			       policer_thread_share_t * share,
+			       u32 packet_length,
+			       policer_result_e packet_color, u64 time)
+{
+  u32 current_tokens, extended_tokens;
+  policer_result_e result;
+
+  packet_length = packet_length << policer->scale;
+
+  // Top the share up from the reservoir once it cannot cover a packet
+  if (PREDICT_FALSE (share->current_bucket < packet_length ||
+		     share->extended_bucket < packet_length))
+    {
+      u32 want = (packet_length > policer->thread_quantum) ?
+	packet_length : policer->thread_quantum;
+
+      vnet_police_reservoir_refill (policer, time);
+
+      if (share->current_bucket < want)
+	share->current_bucket +=
+	  vnet_police_reservoir_take (&policer->current_bucket,
+				      want - share->current_bucket);
+      if (share->extended_bucket < want)
+	share->extended_bucket +=
+	  vnet_police_reservoir_take (&policer->extended_bucket,
+				      want - share->extended_bucket);
+    }
+
+  current_tokens = share->current_bucket;
+  extended_tokens = share->extended_bucket;
+
+  // Determine color, as vnet_police_packet() does
+  if (policer->single_rate)
+    {
+      if ((!policer->color_aware || (packet_color == POLICE_CONFORM))
+	  && (current_tokens >= packet_length))
+	result = POLICE_CONFORM;
+      else if ((!policer->color_aware || (packet_color != POLICE_VIOLATE))
+	       && (extended_tokens >= packet_length))
+	result = POLICE_EXCEED;
+      else
+	result = POLICE_VIOLATE;
+    }
+  else
+    {
+      if ((policer->color_aware && (packet_color == POLICE_VIOLATE))
+	  || (extended_tokens < packet_length))
+	result = POLICE_VIOLATE;
+      else if ((policer->color_aware && (packet_color == POLICE_EXCEED))
+	       || (current_tokens < packet_length))
+	result = POLICE_EXCEED;
+      else
+	result = POLICE_CONFORM;
+    }
+
+  if (result == POLICE_CONFORM)
+    {
+      share->current_bucket = current_tokens - packet_length;
+      share->extended_bucket = extended_tokens - packet_length;
+    }
+  else if (result == POLICE_EXCEED)
+    share->extended_bucket = extended_tokens - packet_length;
+
+  return result;
+}
+
 #endif // __POLICE_H__
 
 /*
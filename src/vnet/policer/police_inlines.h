@@ -70,7 +70,14 @@ vnet_policer_police (vlib_main_t * vm,
 
   len = vlib_buffer_length_in_chain (vm, b);
   pol = &pm->policers[policer_index];
-  col = vnet_police_packet (pol, len, packet_color, time_in_policer_periods);
+  if (PREDICT_FALSE (pol->thread_quantum != 0))
+    col = vnet_police_packet_per_thread
+      (pol, vec_elt_at_index (pm->thread_shares[vm->thread_index],
+			      policer_index),
+       len, packet_color, time_in_policer_periods);
+  else
+    col = vnet_police_packet (pol, len, packet_color,
+			      time_in_policer_periods);
   act = pol->action[col];
   if (PREDICT_TRUE (act == SSE2_QOS_ACTION_MARK_AND_TRANSMIT))
     vnet_policer_mark (b, pol->mark_dscp[col]);
@@ -18,6 +18,29 @@
 
 vnet_policer_main_t vnet_policer_main;
 
+/*
+ * Zero every worker's share of a policer, before it is (re)used.
+ * Runs with the workers stopped
+ */
+void
+policer_thread_shares_reset (u32 policer_index)
+{
+  vnet_policer_main_t *pm = &vnet_policer_main;
+  vlib_thread_main_t *tm = vlib_get_thread_main ();
+  policer_thread_share_t *share;
+  int i;
+
+  vec_validate (pm->thread_shares, tm->n_vlib_mains - 1);
+
+  for (i = 0; i < tm->n_vlib_mains; i++)
+    {
+      vec_validate_aligned (pm->thread_shares[i], policer_index,
+			    CLIB_CACHE_LINE_BYTES);
+      share = vec_elt_at_index (pm->thread_shares[i], policer_index);
+      memset (share, 0, sizeof (*share));
+    }
+}
+
 clib_error_t *
 policer_add_del (vlib_main_t * vm,
 		 u8 * name,
@@ -85,6 +108,7 @@ policer_add_del (vlib_main_t * vm,
       pool_get_aligned (pm->policers, policer, CLIB_CACHE_LINE_BYTES);
       policer[0] = pp[0];
       pi = policer - pm->policers;
+      policer_thread_shares_reset (pi);
       hash_set_mem (pm->policer_index_by_name, name, pi);
       *policer_index = pi;
     }
@@ -112,6 +136,8 @@ format_policer_instance (u8 * s, va_list * va)
 	      i->current_limit,
 	      i->current_bucket, i->extended_limit, i->extended_bucket);
   s = format (s, "last update %llu\n", i->last_update_time);
+  if (i->thread_quantum)
+    s = format (s, "per-thread, quantum %u tok\n", i->thread_quantum);
   return s;
 }
 
@@ -220,6 +246,10 @@ format_policer_config (u8 * s, va_list * va)
 	      format_policer_action_type, &c->conform_action,
 	      format_policer_action_type, &c->exceed_action,
 	      format_policer_action_type, &c->violate_action);
+  if (c->per_thread)
+    s = format (s, "per-thread, quantum %u bytes\n",
+		c->thread_quantum_bytes ? c->thread_quantum_bytes :
+		SSE2_QOS_POL_THREAD_QUANTUM_DEFAULT);
   return s;
 }
 
@@ -444,6 +474,11 @@ configure_policer_command_fn (vlib_main_t * vm,
 	;
       else if (unformat (line_input, "color-aware"))
 	c.color_aware = 1;
+      else if (unformat (line_input, "per-thread quantum %u",
+			 &c.thread_quantum_bytes))
+	c.per_thread = 1;
+      else if (unformat (line_input, "per-thread"))
+	c.per_thread = 1;
 
 #define _(a) else if (unformat (line_input, "%U", unformat_policer_##a, &c)) ;
       foreach_config_param
@@ -467,7 +502,8 @@ done:
 /* *INDENT-OFF* */
 VLIB_CLI_COMMAND (configure_policer_command, static) = {
     .path = "configure policer",
-    .short_help = "configure policer name <name> <params> ",
+    .short_help = "configure policer name <name> <params> "
+                  "[per-thread [quantum <bytes>]]",
     .function = configure_policer_command_fn,
 };
 /* *INDENT-ON* */
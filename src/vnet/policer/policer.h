@@ -39,6 +39,9 @@ typedef struct
   /* Policer by sw_if_index vector */
   u32 *policer_index_by_sw_if_index;
 
+  /* Per-thread mode token shares, per thread and by policer index */
+  policer_thread_share_t **thread_shares;
+
   /* convenience */
   vlib_main_t *vlib_main;
   vnet_main_t *vnet_main;
@@ -91,6 +94,7 @@ typedef enum
 } vnet_dscp_t;
 
 u8 *format_policer_instance (u8 * s, va_list * va);
+void policer_thread_shares_reset (u32 policer_index);
 clib_error_t *policer_add_del (vlib_main_t * vm,
 			       u8 * name,
 			       sse2_qos_pol_cfg_params_st * cfg,
@@ -75,6 +75,8 @@ vl_api_policer_add_del_t_handler (vl_api_policer_add_del_t * mp)
   cfg.violate_action.action_type = mp->violate_action_type;
   cfg.violate_action.dscp = mp->violate_dscp;
   cfg.color_aware = mp->color_aware;
+  cfg.per_thread = mp->per_thread;
+  cfg.thread_quantum_bytes = ntohl (mp->thread_quantum);
 
   error = policer_add_del (vm, name, &cfg, &policer_index, mp->is_add);
 
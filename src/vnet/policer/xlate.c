@@ -1271,6 +1271,17 @@ sse2_pol_logical_2_physical (sse2_qos_pol_cfg_params_st * cfg,
 
 #endif // if !defined (INTERNAL_SS) && !defined (X86)
 
+  if (cfg->per_thread)
+    {
+      u64 quantum = cfg->thread_quantum_bytes ?
+	cfg->thread_quantum_bytes : SSE2_QOS_POL_THREAD_QUANTUM_DEFAULT;
+
+      // tokens are scaled like the packet length
+      quantum <<= phys->scale;
+      quantum = clib_min (quantum, phys->current_limit);
+      phys->thread_quantum = clib_max (quantum, 1);
+    }
+
   return 0;
 }
 
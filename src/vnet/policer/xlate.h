@@ -121,6 +121,12 @@ typedef struct sse2_qos_pol_action_params_st_
  * element: rnd_type
  *      Rounding type (see sse_qos_round_type_en). Needed when policer values
  *      need to be rounded. Caller can decide on type of rounding used
+ * element: per_thread
+ *      Police each worker against its own token share, refilled from the
+ *      policer buckets with atomics. See policer_read_response_type_st.
+ * element: thread_quantum_bytes
+ *      Bytes a worker takes at a time in per-thread mode, 0 for
+ *      SSE2_QOS_POL_THREAD_QUANTUM_DEFAULT.
  */
 typedef struct sse2_qos_pol_cfg_params_st_
 {
@@ -148,6 +154,8 @@ typedef struct sse2_qos_pol_cfg_params_st_
   u8 overwrite_bucket;		/* for debugging purposes */
   u32 current_bucket;		/* for debugging purposes */
   u32 extended_bucket;		/* for debugging purposes */
+  u8 per_thread;		/* police per-thread token shares */
+  u32 thread_quantum_bytes;	/* per-thread share refill, 0 = default */
   sse2_qos_pol_action_params_st conform_action;
   sse2_qos_pol_action_params_st exceed_action;
   sse2_qos_pol_action_params_st violate_action;
@@ -170,6 +178,8 @@ typedef struct sse2_qos_pol_hw_params_st_
 } sse2_qos_pol_hw_params_st;
 
 
+#define SSE2_QOS_POL_THREAD_QUANTUM_DEFAULT (16 << 10)
+
 int
 sse2_pol_logical_2_physical (sse2_qos_pol_cfg_params_st * cfg,
 			     policer_read_response_type_st * phys);
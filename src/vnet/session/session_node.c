@@ -407,6 +407,7 @@ session_tx_fifo_read_and_snd_i (vlib_main_t * vm, vlib_node_runtime_t * node,
   /* Allow enqueuing of a new event */
   svm_fifo_unset_event (s->server_tx_fifo);
 
+next_dgram:
   /* Check how much we can pull. */
   session_tx_set_dequeue_params (vm, ctx, VLIB_FRAME_SIZE - *n_tx_packets,
 				 peek_data);
@@ -528,10 +529,18 @@ session_tx_fifo_read_and_snd_i (vlib_main_t * vm, vlib_node_runtime_t * node,
       if (ctx->max_len_to_snd < ctx->max_dequeue)
 	svm_fifo_overwrite_head (s->server_tx_fifo, (u8 *) & ctx->hdr,
 				 sizeof (session_dgram_pre_hdr_t));
-      /* More data needs to be read */
+      /* More datagrams queued. Keep draining them while the frame has
+       * room instead of waiting for the next dispatch */
       else if (svm_fifo_max_dequeue (s->server_tx_fifo) > 0)
-	if (svm_fifo_set_event (s->server_tx_fifo))
-	  vec_add1 (smm->pending_event_vector[thread_index], *e);
+	{
+	  if (*n_tx_packets < VLIB_FRAME_SIZE)
+	    {
+	      n_trace = vlib_get_trace_count (vm, node);
+	      goto next_dgram;
+	    }
+	  if (svm_fifo_set_event (s->server_tx_fifo))
+	    vec_add1 (smm->pending_event_vector[thread_index], *e);
+	}
     }
   return SESSION_TX_OK;
 }
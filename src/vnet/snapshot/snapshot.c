@@ -0,0 +1,474 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/snapshot/snapshot.h>
+#include <vlib/unix/unix.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+vnet_snapshot_main_t vnet_snapshot_main;
+
+#define VNET_SNAPSHOT_MAGIC "vpp-snapshot"
+#define VNET_SNAPSHOT_VERSION 1
+
+void
+serialize_vnet_snapshot_sw_if_index (serialize_main_t * m, u32 sw_if_index)
+{
+  u8 *name;
+
+  if (~0 == sw_if_index)
+    {
+      serialize_cstring (m, "");
+      return;
+    }
+
+  name = format (0, "%U%c", format_vnet_sw_if_index_name,
+		 vnet_snapshot_main.vnet_main, sw_if_index, 0);
+  serialize_cstring (m, (char *) name);
+  vec_free (name);
+}
+
+int
+unserialize_vnet_snapshot_sw_if_index (serialize_main_t * m,
+				       u32 * sw_if_index)
+{
+  unformat_input_t input;
+  char *name;
+  int rv = 0;
+
+  unserialize_cstring (m, &name);
+
+  *sw_if_index = ~0;
+  if (0 == name[0])
+    goto done;
+
+  unformat_init_string (&input, name, strlen (name));
+  if (!unformat (&input, "%U", unformat_vnet_sw_interface,
+		 vnet_snapshot_main.vnet_main, sw_if_index))
+    {
+      clib_warning ("snapshot: interface %s not found, skipped", name);
+      vnet_snapshot_skip ();
+      rv = -1;
+    }
+  unformat_free (&input);
+
+done:
+  vec_free (name);
+  return (rv);
+}
+
+/*
+ * Admin state of the interfaces, so the restored routes and bridge
+ * domains have somewhere to forward to.
+ */
+static void
+vnet_snapshot_save_interfaces (serialize_main_t * m, va_list * va)
+{
+  vnet_main_t *vnm = vnet_snapshot_main.vnet_main;
+  vnet_sw_interface_t *si;
+  u32 *up = 0, *sw_if_index;
+
+  /* *INDENT-OFF* */
+  pool_foreach (si, vnm->interface_main.sw_interfaces,
+  ({
+    if (si->flags & VNET_SW_INTERFACE_FLAG_ADMIN_UP)
+      vec_add1 (up, si->sw_if_index);
+  }));
+  /* *INDENT-ON* */
+
+  serialize_likely_small_unsigned_integer (m, vec_len (up));
+  vec_foreach (sw_if_index, up)
+    serialize_vnet_snapshot_sw_if_index (m, *sw_if_index);
+
+  vec_free (up);
+}
+
+static void
+vnet_snapshot_restore_interfaces (serialize_main_t * m, va_list * va)
+{
+  vnet_main_t *vnm = vnet_snapshot_main.vnet_main;
+  clib_error_t *error;
+  u32 n, sw_if_index;
+
+  n = unserialize_likely_small_unsigned_integer (m);
+  while (n--)
+    {
+      if (unserialize_vnet_snapshot_sw_if_index (m, &sw_if_index))
+	continue;
+
+      error = vnet_sw_interface_set_flags (vnm, sw_if_index,
+					   VNET_SW_INTERFACE_FLAG_ADMIN_UP);
+      if (error)
+	clib_error_report (error);
+    }
+}
+
+/* *INDENT-OFF* */
+VNET_SNAPSHOT_SECTION (interfaces, static) = {
+  .name = "interface",
+  .save = vnet_snapshot_save_interfaces,
+  .restore = vnet_snapshot_restore_interfaces,
+};
+/* *INDENT-ON* */
+
+static void
+serialize_vnet_snapshot_file (serialize_main_t * m, va_list * va)
+{
+  vnet_snapshot_main_t *sm = &vnet_snapshot_main;
+  vnet_snapshot_section_registration_t *r;
+  serialize_main_t section;
+  clib_error_t *error;
+  u32 n_sections = 0;
+  u8 *blob;
+
+  serialize_magic (m, VNET_SNAPSHOT_MAGIC, strlen (VNET_SNAPSHOT_MAGIC));
+  serialize_integer (m, VNET_SNAPSHOT_VERSION, sizeof (u32));
+
+  for (r = sm->next_section; r; r = r->next)
+    n_sections++;
+  serialize_likely_small_unsigned_integer (m, n_sections);
+
+  for (r = sm->next_section; r; r = r->next)
+    {
+      serialize_open_vector (&section, 0);
+      error = serialize (&section, r->save);
+      blob = serialize_close_vector (&section);
+      if (error)
+	{
+	  vec_free (blob);
+	  serialize_error (&m->header, error);
+	}
+
+      serialize_cstring (m, r->name);
+      serialize_likely_small_unsigned_integer (m, vec_len (blob));
+      serialize_vnet_snapshot_data (m, blob, vec_len (blob));
+      vec_free (blob);
+    }
+}
+
+static vnet_snapshot_section_registration_t *
+vnet_snapshot_section_find (char *name)
+{
+  vnet_snapshot_section_registration_t *r;
+
+  for (r = vnet_snapshot_main.next_section; r; r = r->next)
+    if (!strcmp (r->name, name))
+      return (r);
+
+  return (NULL);
+}
+
+static void
+unserialize_vnet_snapshot_file (serialize_main_t * m, va_list * va)
+{
+  vnet_snapshot_section_registration_t *r;
+  serialize_main_t section;
+  clib_error_t *error;
+  u32 version, n_sections, n_bytes;
+  char *name;
+  u8 *blob;
+
+  unserialize_check_magic (m, VNET_SNAPSHOT_MAGIC,
+			   strlen (VNET_SNAPSHOT_MAGIC));
+  unserialize_integer (m, &version, sizeof (u32));
+  if (version != VNET_SNAPSHOT_VERSION)
+    serialize_error_return (m, "unsupported snapshot version %d", version);
+
+  n_sections = unserialize_likely_small_unsigned_integer (m);
+  while (n_sections--)
+    {
+      unserialize_cstring (m, &name);
+      n_bytes = unserialize_likely_small_unsigned_integer (m);
+      if (n_bytes > m->stream.n_buffer_bytes - m->stream.current_buffer_index)
+	{
+	  vec_free (name);
+	  serialize_error_return (m, "snapshot truncated");
+	}
+      /* the file is mapped: this points straight into it */
+      blob = unserialize_get (m, n_bytes);
+
+      r = vnet_snapshot_section_find (name);
+      if (NULL == r)
+	{
+	  clib_warning ("snapshot: unknown section `%s' skipped", name);
+	  vec_free (name);
+	  continue;
+	}
+
+      unserialize_open_data (&section, blob, n_bytes);
+      error = unserialize (&section, r->restore);
+      unserialize_close (&section);
+      if (error)
+	{
+	  error = clib_error_return (error, "section `%s'", name);
+	  vec_free (name);
+	  serialize_error (&m->header, error);
+	}
+      vec_free (name);
+    }
+}
+
+clib_error_t *
+vnet_snapshot_save (vlib_main_t * vm, char *filename)
+{
+  serialize_main_t m;
+  clib_error_t *error;
+  u8 *tmp;
+
+  /*
+   * Write next to the target and rename, so a crash half way through
+   * leaves the previous snapshot intact.
+   */
+  tmp = format (0, "%s.tmp%c", filename, 0);
+
+  error = serialize_open_clib_file (&m, (char *) tmp);
+  if (error)
+    goto done;
+
+  error = serialize (&m, serialize_vnet_snapshot_file);
+  serialize_close (&m);
+  close (m.stream.data_function_opaque);
+
+  if (error)
+    {
+      unlink ((char *) tmp);
+      goto done;
+    }
+
+  if (rename ((char *) tmp, filename) < 0)
+    {
+      error = clib_error_return_unix (0, "rename `%s'", filename);
+      unlink ((char *) tmp);
+    }
+
+done:
+  vec_free (tmp);
+  return (error);
+}
+
+clib_error_t *
+vnet_snapshot_restore (vlib_main_t * vm, char *filename)
+{
+  vnet_snapshot_main_t *sm = &vnet_snapshot_main;
+  clib_error_t *error = 0;
+  serialize_main_t m;
+  struct stat st;
+  void *data;
+  int fd;
+
+  fd = open (filename, O_RDONLY);
+  if (fd < 0)
+    return clib_error_return_unix (0, "open `%s'", filename);
+
+  if (fstat (fd, &st) < 0)
+    {
+      error = clib_error_return_unix (0, "stat `%s'", filename);
+      goto done;
+    }
+
+  data = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED)
+    {
+      error = clib_error_return_unix (0, "mmap `%s'", filename);
+      goto done;
+    }
+
+  sm->n_skipped = 0;
+  unserialize_open_data (&m, data, st.st_size);
+  error = unserialize (&m, unserialize_vnet_snapshot_file);
+  unserialize_close (&m);
+
+  munmap (data, st.st_size);
+
+done:
+  close (fd);
+  return (error);
+}
+
+static clib_error_t *
+snapshot_save_command_fn (vlib_main_t * vm,
+			  unformat_input_t * input, vlib_cli_command_t * cmd)
+{
+  clib_error_t *error;
+  u8 *filename = 0;
+
+  if (!unformat (input, "%s", &filename))
+    return clib_error_return (0, "expected file name, got `%U'",
+			      format_unformat_error, input);
+
+  vec_add1 (filename, 0);
+  error = vnet_snapshot_save (vm, (char *) filename);
+  vec_free (filename);
+
+  return (error);
+}
+
+/*?
+ * Write the run-time state of vpp (interface admin state, FIB tables
+ * and routes, neighbors, bridge domains and the L2 FIB, and the state of
+ * the plugins which registered a snapshot section) to a file, which a
+ * restarted vpp can load with '<em>snapshot restore</em>'.
+ *
+ * @cliexpar
+ * @cliexcmd{snapshot save /var/run/vpp/warm.snap}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (snapshot_save_command, static) = {
+  .path = "snapshot save",
+  .short_help = "snapshot save <file>",
+  .function = snapshot_save_command_fn,
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+snapshot_restore_command_fn (vlib_main_t * vm,
+			     unformat_input_t * input,
+			     vlib_cli_command_t * cmd)
+{
+  clib_error_t *error;
+  u8 *filename = 0;
+
+  if (!unformat (input, "%s", &filename))
+    return clib_error_return (0, "expected file name, got `%U'",
+			      format_unformat_error, input);
+
+  vec_add1 (filename, 0);
+  error = vnet_snapshot_restore (vm, (char *) filename);
+  vec_free (filename);
+
+  if (!error && vnet_snapshot_main.n_skipped)
+    vlib_cli_output (vm, "%d objects skipped",
+		     vnet_snapshot_main.n_skipped);
+
+  return (error);
+}
+
+/*?
+ * Load a snapshot written by '<em>snapshot save</em>'. The interfaces
+ * must exist, so when they are created by the startup config this
+ * command goes at the end of it.
+ *
+ * @cliexpar
+ * @cliexcmd{snapshot restore /var/run/vpp/warm.snap}
+?*/
+/* *INDENT-OFF* */
+VLIB_CLI_COMMAND (snapshot_restore_command, static) = {
+  .path = "snapshot restore",
+  .short_help = "snapshot restore <file>",
+  .function = snapshot_restore_command_fn,
+};
+/* *INDENT-ON* */
+
+static uword
+snapshot_restore_process (vlib_main_t * vm,
+			  vlib_node_runtime_t * rt, vlib_frame_t * f)
+{
+  vnet_snapshot_main_t *sm = &vnet_snapshot_main;
+  clib_error_t *error;
+
+  if (0 == sm->restore_filename)
+    return 0;
+
+  /* same as the startup config: let the interfaces come up first */
+  vlib_process_suspend (vm, 2.0);
+
+  while (unix_main.unix_config_complete == 0)
+    vlib_process_suspend (vm, 0.1);
+
+  vlib_worker_thread_barrier_sync (vm);
+  error = vnet_snapshot_restore (vm, (char *) sm->restore_filename);
+  vlib_worker_thread_barrier_release (vm);
+
+  if (error)
+    clib_error_report (error);
+  else if (sm->n_skipped)
+    clib_warning ("snapshot: %d objects skipped", sm->n_skipped);
+
+  return 0;
+}
+
+/* *INDENT-OFF* */
+VLIB_REGISTER_NODE (snapshot_restore_node, static) = {
+  .function = snapshot_restore_process,
+  .type = VLIB_NODE_TYPE_PROCESS,
+  .name = "snapshot-restore-process",
+};
+/* *INDENT-ON* */
+
+static clib_error_t *
+snapshot_exit (vlib_main_t * vm)
+{
+  vnet_snapshot_main_t *sm = &vnet_snapshot_main;
+  clib_error_t *error;
+
+  if (0 == sm->save_on_exit_filename)
+    return 0;
+
+  vlib_worker_thread_barrier_sync (vm);
+  error = vnet_snapshot_save (vm, (char *) sm->save_on_exit_filename);
+  vlib_worker_thread_barrier_release (vm);
+
+  if (error)
+    clib_error_report (error);
+
+  return 0;
+}
+
+VLIB_MAIN_LOOP_EXIT_FUNCTION (snapshot_exit);
+
+static clib_error_t *
+snapshot_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  vnet_snapshot_main_t *sm = &vnet_snapshot_main;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "restore %s", &sm->restore_filename))
+	vec_add1 (sm->restore_filename, 0);
+      else if (unformat (input, "save-on-exit %s",
+			 &sm->save_on_exit_filename))
+	vec_add1 (sm->save_on_exit_filename, 0);
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  return 0;
+}
+
+VLIB_CONFIG_FUNCTION (snapshot_config, "snapshot");
+
+static clib_error_t *
+snapshot_init (vlib_main_t * vm)
+{
+  vnet_snapshot_main_t *sm = &vnet_snapshot_main;
+
+  sm->vlib_main = vm;
+  sm->vnet_main = vnet_get_main ();
+
+  return 0;
+}
+
+VLIB_INIT_FUNCTION (snapshot_init);
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
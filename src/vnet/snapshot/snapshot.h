@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Warm restart snapshots.
+ *
+ * A snapshot is a single file holding the run-time state of the
+ * subsystems which registered a section: FIB tables and routes,
+ * neighbors, bridge domains and the L2 FIB, ACLs, NAT sessions...
+ * It is written with the vppinfra serializer and read back, without
+ * copying, from an mmap of the file, so a restarted vpp can be brought
+ * back to its previous state without replaying the configuration
+ * through the API.
+ *
+ * Each section is stored as its name followed by a length-prefixed
+ * blob, so sections unknown to the restoring image (e.g. from a plugin
+ * which is not loaded) are skipped. Interfaces are referenced by name,
+ * since sw_if_index values are not stable across restarts; objects
+ * bound to an interface which does not exist any more are skipped.
+ */
+
+#ifndef included_vnet_snapshot_h
+#define included_vnet_snapshot_h
+
+#include <vnet/vnet.h>
+#include <vppinfra/serialize.h>
+
+typedef struct _vnet_snapshot_section_registration
+{
+  struct _vnet_snapshot_section_registration *next;
+
+  /** Section name, unique, as written to the file */
+  char *name;
+
+  /** Writes the section. va_list is empty */
+  serialize_function_t *save;
+
+  /** Reads the section back and applies it */
+  serialize_function_t *restore;
+} vnet_snapshot_section_registration_t;
+
+typedef struct
+{
+  /** Registered sections */
+  vnet_snapshot_section_registration_t *next_section;
+
+  /** startup config: snapshot to restore after the config is applied */
+  u8 *restore_filename;
+
+  /** startup config: snapshot to write when vpp exits */
+  u8 *save_on_exit_filename;
+
+  /** Objects skipped by the restore in progress */
+  u32 n_skipped;
+
+  vlib_main_t *vlib_main;
+  vnet_main_t *vnet_main;
+} vnet_snapshot_main_t;
+
+extern vnet_snapshot_main_t vnet_snapshot_main;
+
+#define VNET_SNAPSHOT_SECTION(x,...)					\
+  __VA_ARGS__ vnet_snapshot_section_registration_t vnet_snapshot_##x;	\
+static void __vnet_add_snapshot_section_##x (void)			\
+  __attribute__((__constructor__)) ;					\
+static void __vnet_add_snapshot_section_##x (void)			\
+{									\
+  vnet_snapshot_main_t * sm = &vnet_snapshot_main;			\
+  vnet_snapshot_##x.next = sm->next_section;				\
+  sm->next_section = & vnet_snapshot_##x;				\
+}									\
+static void __vnet_rm_snapshot_section_##x (void)			\
+  __attribute__((__destructor__)) ;					\
+static void __vnet_rm_snapshot_section_##x (void)			\
+{									\
+  vnet_snapshot_main_t * sm = &vnet_snapshot_main;			\
+  vnet_snapshot_section_registration_t *r = &vnet_snapshot_##x;	\
+  VLIB_REMOVE_FROM_LINKED_LIST (sm->next_section, r, next);		\
+}									\
+__VA_ARGS__ vnet_snapshot_section_registration_t vnet_snapshot_##x
+
+clib_error_t *vnet_snapshot_save (vlib_main_t * vm, char *filename);
+clib_error_t *vnet_snapshot_restore (vlib_main_t * vm, char *filename);
+
+/**
+ * Interfaces are written by name. On restore the name is looked up
+ * again; a missing interface returns non-zero and counts the object
+ * as skipped. ~0 (no interface) is written and read back as is.
+ */
+void serialize_vnet_snapshot_sw_if_index (serialize_main_t * m,
+					  u32 sw_if_index);
+int unserialize_vnet_snapshot_sw_if_index (serialize_main_t * m,
+					   u32 * sw_if_index);
+
+/** Raw bytes, e.g. addresses, which are kept in network order */
+always_inline void
+serialize_vnet_snapshot_data (serialize_main_t * m, void *data, u32 n_bytes)
+{
+  clib_memcpy (serialize_get (m, n_bytes), data, n_bytes);
+}
+
+always_inline void
+unserialize_vnet_snapshot_data (serialize_main_t * m, void *data,
+				u32 n_bytes)
+{
+  clib_memcpy (data, unserialize_get (m, n_bytes), n_bytes);
+}
+
+always_inline void
+vnet_snapshot_skip (void)
+{
+  vnet_snapshot_main.n_skipped++;
+}
+
+#endif /* included_vnet_snapshot_h */
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -54,6 +54,9 @@
 
 #define SR_SEGMENT_LIST_WEIGHT_DEFAULT 1
 
+/* Length in bits of a micro-segment (uSID) in a uSID container */
+#define SR_USID_LEN 16
+
 /**
  * @brief SR Segment List (SID list)
  */
@@ -105,6 +108,8 @@ typedef struct
 
   char end_psp;					/**< Combined with End.PSP? */
 
+  u8 usid_block_len;			/**< uSID block length in bits, 0 if not a uSID */
+
   u16 behavior;					/**< Behavior associated to this localsid */
 
   union
@@ -267,9 +272,12 @@ extern int sr_policy_del (ip6_address_t * bsid, u32 index);
 
 extern int
 sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
-		 char end_psp, u8 behavior, u32 sw_if_index,
-		 u32 vlan_index, u32 fib_table, ip46_address_t * nh_addr,
-		 void *ls_plugin_mem);
+		 char end_psp, u8 usid_block_len, u8 behavior,
+		 u32 sw_if_index, u32 vlan_index, u32 fib_table,
+		 ip46_address_t * nh_addr, void *ls_plugin_mem);
+
+extern ip6_address_t *sr_usid_compress (ip6_address_t * sl,
+					u8 usid_block_len);
 
 extern int
 sr_steering_policy (int is_del, ip6_address_t * bsid, u32 sr_policy_index,
@@ -61,8 +61,9 @@ static void vl_api_sr_localsid_add_del_t_handler
   int rv = 0;
 /*
  * int sr_cli_localsid (char is_del, ip6_address_t *localsid_addr,
- *  char end_psp, u8 behavior, u32 sw_if_index, u32 vlan_index, u32 fib_table,
- *  ip46_address_t *nh_addr, void *ls_plugin_mem)
+ *  char end_psp, u8 usid_block_len, u8 behavior, u32 sw_if_index,
+ *  u32 vlan_index, u32 fib_table, ip46_address_t *nh_addr,
+ *  void *ls_plugin_mem)
  */
   if (mp->behavior == SR_BEHAVIOR_X ||
       mp->behavior == SR_BEHAVIOR_DX6 ||
@@ -80,7 +81,7 @@ static void vl_api_sr_localsid_add_del_t_handler
 
   rv = sr_cli_localsid (mp->is_del,
 			(ip6_address_t *) & mp->localsid,
-			mp->end_psp,
+			mp->end_psp, 0,
 			mp->behavior,
 			ntohl (mp->sw_if_index),
 			ntohl (mp->vlan_index),
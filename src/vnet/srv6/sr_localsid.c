@@ -54,6 +54,8 @@ static dpo_type_t sr_localsid_d_dpo_type;
  * @param is_del Boolean of whether its a delete instruction
  * @param localsid_addr IPv6 address of the localsid
  * @param is_decap Boolean of whether decapsulation is allowed in this function
+ * @param usid_block_len uSID block length in bits, for a uSID End or End.X
+ *                       localsid, 0 otherwise
  * @param behavior Type of behavior (function) for this localsid
  * @param sw_if_index Only for L2/L3 xconnect. OIF. In VRF variant the fib_table.
  * @param vlan_index Only for L2 xconnect. Outgoing VLAN tag.
@@ -64,8 +66,9 @@ static dpo_type_t sr_localsid_d_dpo_type;
  */
 int
 sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
-		 char end_psp, u8 behavior, u32 sw_if_index, u32 vlan_index,
-		 u32 fib_table, ip46_address_t * nh_addr, void *ls_plugin_mem)
+		 char end_psp, u8 usid_block_len, u8 behavior,
+		 u32 sw_if_index, u32 vlan_index, u32 fib_table,
+		 ip46_address_t * nh_addr, void *ls_plugin_mem)
 {
   ip6_sr_main_t *sm = &sr_main;
   uword *p;
@@ -93,6 +96,9 @@ sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
 			}
 	  };
 
+	  if (ls->usid_block_len)
+	    pfx.fp_len = ls->usid_block_len + SR_USID_LEN;
+
 	  fib_table_entry_delete (fib_table_find (FIB_PROTOCOL_IP6,
 						  fib_table),
 				  &pfx, FIB_SOURCE_SR);
@@ -134,6 +140,10 @@ sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
   pfx.fp_addr.as_u64[0] = localsid_addr->as_u64[0];
   pfx.fp_addr.as_u64[1] = localsid_addr->as_u64[1];
 
+  /* A uSID localsid matches its block and uSID, whatever follows them */
+  if (usid_block_len)
+    pfx.fp_len = usid_block_len + SR_USID_LEN;
+
   /* Lookup the FIB index associated to the table id provided */
   u32 fib_index = fib_table_find (FIB_PROTOCOL_IP6, fib_table);
   if (fib_index == ~0)
@@ -150,6 +160,7 @@ sr_cli_localsid (char is_del, ip6_address_t * localsid_addr,
 
   clib_memcpy (&ls->localsid, localsid_addr, sizeof (ip6_address_t));
   ls->end_psp = end_psp;
+  ls->usid_block_len = usid_block_len;
   ls->behavior = behavior;
   ls->nh_adj = (u32) ~ 0;
   ls->fib_table = fib_table;
@@ -268,6 +279,7 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
   u32 sw_if_index = (u32) ~ 0, vlan_index = (u32) ~ 0, fib_index = 0;
   int is_del = 0;
   int end_psp = 0;
+  u32 usid_block_len = 0;
   ip6_address_t resulting_address;
   ip46_address_t next_hop;
   char address_set = 0;
@@ -352,11 +364,13 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	}
       else if (!end_psp && unformat (input, "psp"))
 	end_psp = 1;
+      else if (!usid_block_len
+	       && unformat (input, "usid-block %u", &usid_block_len));
       else
 	break;
     }
 
-  if (!behavior && end_psp)
+  if (!behavior && (end_psp || usid_block_len))
     behavior = SR_BEHAVIOR_END;
 
   if (!address_set)
@@ -371,10 +385,20 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
   if (end_psp && !(behavior == SR_BEHAVIOR_END || behavior == SR_BEHAVIOR_X))
     return clib_error_return (0,
 			      "Error: SRv6 PSP only compatible with End and End.X");
+  if (usid_block_len
+      && !(behavior == SR_BEHAVIOR_END || behavior == SR_BEHAVIOR_X))
+    return clib_error_return (0,
+			      "Error: SRv6 uSID only compatible with End and End.X");
+  if (usid_block_len % SR_USID_LEN
+      || usid_block_len + 2 * SR_USID_LEN > 128)
+    return clib_error_return (0,
+			      "Error: SRv6 uSID block length must be a multiple "
+			      "of %u bits leaving room for two uSIDs",
+			      SR_USID_LEN);
 
-  rv = sr_cli_localsid (is_del, &resulting_address, end_psp, behavior,
-			sw_if_index, vlan_index, fib_index, &next_hop,
-			ls_plugin_mem);
+  rv = sr_cli_localsid (is_del, &resulting_address, end_psp, usid_block_len,
+			behavior, sw_if_index, vlan_index, fib_index,
+			&next_hop, ls_plugin_mem);
 
   switch (rv)
     {
@@ -409,13 +433,17 @@ sr_cli_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
 VLIB_CLI_COMMAND (sr_localsid_command, static) = {
   .path = "sr localsid",
   .short_help = "sr localsid (del) address XX:XX::YY:YY"
-      "(fib-table 8) behavior STRING",
+      "(fib-table 8) behavior STRING (psp) (usid-block N)",
   .long_help =
     "Create SR LocalSID and binds it to a particular behavior\n"
     "Arguments:\n"
     "\tlocalSID IPv6_addr(128b)   LocalSID IPv6 address\n"
     "\t(fib-table X)              Optional. VRF where to install SRv6 localsid\n"
     "\tbehavior STRING            Specifies the behavior\n"
+    "\t(usid-block N)             Optional. End and End.X only. The localsid\n"
+    "\t                           is the uSID following an N bits uSID block\n"
+    "\t                           in the address. The uSIDs after it are\n"
+    "\t                           shifted over it before the SRH is used.\n"
     "\n\tBehaviors:\n"
     "\tEnd\t-> Endpoint.\n"
     "\tEnd.X\t-> Endpoint with decapsulation and Layer-3 cross-connect.\n"
@@ -534,6 +562,9 @@ show_sr_localsid_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	}
       if (ls->end_psp)
 	vlib_cli_output (vm, "\tPSP: \tTrue\n");
+      if (ls->usid_block_len)
+	vlib_cli_output (vm, "\tuSID: \t%u bits block\n",
+			 ls->usid_block_len);
 
       /* Print counters */
       vlib_counter_t valid, invalid;
@@ -707,7 +738,7 @@ end_srh_processing (vlib_node_runtime_t * node,
 {
   ip6_address_t *new_dst0;
 
-  if (PREDICT_TRUE (sr0->type == ROUTING_HEADER_TYPE_SR))
+  if (PREDICT_TRUE (sr0 && sr0->type == ROUTING_HEADER_TYPE_SR))
     {
       if (sr0->segments_left == 1 && psp)
 	{
@@ -791,6 +822,48 @@ end_srh_processing (vlib_node_runtime_t * node,
     }
 }
 
+/**
+ * @brief Function doing uSID processing.
+ *
+ * The destination address of a uSID localsid holds its uSID block, its
+ * uSID and the uSIDs of the next segments. While there are uSIDs after
+ * the active one, they are shifted over it and the packet is forwarded
+ * on the new address; the SRH is only looked at when the last uSID of
+ * the address is reached.
+ *
+ * @return 1 if the packet was processed, 0 if End processing applies
+ */
+static_always_inline int
+end_usid_processing (vlib_buffer_t * b0, ip6_header_t * ip0,
+		     ip6_sr_localsid_t * ls0, u32 * next0)
+{
+  u128 dst0, block_mask0;
+  u8 block_len0 = ls0->usid_block_len;
+
+  if (PREDICT_TRUE (block_len0 == 0))
+    return 0;
+
+  dst0 = ((u128) clib_net_to_host_u64 (ip0->dst_address.as_u64[0]) << 64) |
+    clib_net_to_host_u64 (ip0->dst_address.as_u64[1]);
+
+  /* end of the uSID container */
+  if ((dst0 << (block_len0 + SR_USID_LEN)) == 0)
+    return 0;
+
+  block_mask0 = ~(u128) 0 << (128 - block_len0);
+  dst0 = (dst0 & block_mask0) | ((dst0 << SR_USID_LEN) & ~block_mask0);
+
+  ip0->dst_address.as_u64[0] = clib_host_to_net_u64 (dst0 >> 64);
+  ip0->dst_address.as_u64[1] = clib_host_to_net_u64 ((u64) dst0);
+
+  if (ls0->behavior == SR_BEHAVIOR_X)
+    {
+      vnet_buffer (b0)->ip.adj_index[VLIB_TX] = ls0->nh_adj;
+      *next0 = SR_LOCALSID_NEXT_IP6_REWRITE;
+    }
+  return 1;
+}
+
 /*
  * @brief Function doing SRH processing for D* variants
  */
@@ -1267,14 +1340,18 @@ sr_localsid_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 	    pool_elt_at_index (sm->localsids,
 			       vnet_buffer (b3)->ip.adj_index[VLIB_TX]);
 
-	  end_srh_processing (node, b0, ip0, sr0, ls0, &next0, ls0->end_psp,
-			      prev0);
-	  end_srh_processing (node, b1, ip1, sr1, ls1, &next1, ls1->end_psp,
-			      prev1);
-	  end_srh_processing (node, b2, ip2, sr2, ls2, &next2, ls2->end_psp,
-			      prev2);
-	  end_srh_processing (node, b3, ip3, sr3, ls3, &next3, ls3->end_psp,
-			      prev3);
+	  if (!end_usid_processing (b0, ip0, ls0, &next0))
+	    end_srh_processing (node, b0, ip0, sr0, ls0, &next0,
+				ls0->end_psp, prev0);
+	  if (!end_usid_processing (b1, ip1, ls1, &next1))
+	    end_srh_processing (node, b1, ip1, sr1, ls1, &next1,
+				ls1->end_psp, prev1);
+	  if (!end_usid_processing (b2, ip2, ls2, &next2))
+	    end_srh_processing (node, b2, ip2, sr2, ls2, &next2,
+				ls2->end_psp, prev2);
+	  if (!end_usid_processing (b3, ip3, ls3, &next3))
+	    end_srh_processing (node, b3, ip3, sr3, ls3, &next3,
+				ls3->end_psp, prev3);
 
 	  if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
 	    {
@@ -1425,8 +1502,9 @@ sr_localsid_fn (vlib_main_t * vm, vlib_node_runtime_t * node,
 			       vnet_buffer (b0)->ip.adj_index[VLIB_TX]);
 
 	  /* SRH processing */
-	  end_srh_processing (node, b0, ip0, sr0, ls0, &next0, ls0->end_psp,
-			      prev0);
+	  if (!end_usid_processing (b0, ip0, ls0, &next0))
+	    end_srh_processing (node, b0, ip0, sr0, ls0, &next0,
+				ls0->end_psp, prev0);
 
 	  if (PREDICT_FALSE (b0->flags & VLIB_BUFFER_IS_TRACED))
 	    {
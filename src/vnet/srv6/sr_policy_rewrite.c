@@ -815,6 +815,66 @@ sr_policy_mod (ip6_address_t * bsid, u32 index, u32 fib_table,
   return 0;
 }
 
+/**
+ * @brief Compress a segment list of uSIDs into uSID containers
+ *
+ * Consecutive segments that are uSIDs of the same uSID block, i.e. whose
+ * address is the block followed by one uSID, are packed into the address
+ * of one segment for as long as it has room. Each container replaces up
+ * to (128 - block length) / 16 segments of the SRH, and a segment list
+ * that fits in one container is sent without an SRH at all.
+ *
+ * @param sl is a vector of IPv6 addresses composing the Segment List
+ * @param usid_block_len is the uSID block length in bits
+ *
+ * @return the new segment list vector
+ */
+ip6_address_t *
+sr_usid_compress (ip6_address_t * sl, u8 usid_block_len)
+{
+  u32 n_slots = (128 - usid_block_len) / SR_USID_LEN, n_used = 0;
+  u128 block_mask = ~(u128) 0 << (128 - usid_block_len);
+  ip6_address_t *containers = 0, *seg, *c;
+  u128 v, cv = 0;
+  int is_usid;
+
+  vec_foreach (seg, sl)
+  {
+    v = ((u128) clib_net_to_host_u64 (seg->as_u64[0]) << 64) |
+      clib_net_to_host_u64 (seg->as_u64[1]);
+    is_usid = (v << (usid_block_len + SR_USID_LEN)) == 0;
+
+    if (n_used && is_usid && n_used < n_slots
+	&& (v & block_mask) == (cv & block_mask))
+      {
+	v >>= 128 - usid_block_len - SR_USID_LEN;
+	v &= (1 << SR_USID_LEN) - 1;
+	cv |= v << (128 - usid_block_len - (n_used + 1) * SR_USID_LEN);
+	n_used++;
+	continue;
+      }
+
+    if (n_used)
+      {
+	vec_add2 (containers, c, 1);
+	c->as_u64[0] = clib_host_to_net_u64 (cv >> 64);
+	c->as_u64[1] = clib_host_to_net_u64 ((u64) cv);
+      }
+    cv = v;
+    /* a SID that is not a uSID is a segment of its own */
+    n_used = is_usid ? 1 : n_slots;
+  }
+
+  if (n_used)
+    {
+      vec_add2 (containers, c, 1);
+      c->as_u64[0] = clib_host_to_net_u64 (cv >> 64);
+      c->as_u64[1] = clib_host_to_net_u64 ((u64) cv);
+    }
+
+  return containers;
+}
+
 /**
  * @brief CLI for 'sr policies' command family
  */
@@ -832,6 +892,7 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
   u8 operation = 0;
   char is_encap = 1;
   char is_spray = 0;
+  u32 usid_block_len = 0;
 
   while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
     {
@@ -869,6 +930,7 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
 	is_encap = 0;
       else if (unformat (input, "spray"))
 	is_spray = 1;
+      else if (unformat (input, "usid-block %u", &usid_block_len));
       else
 	break;
     }
@@ -876,6 +938,20 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
   if (!is_add && !is_mod && !is_del)
     return clib_error_return (0, "Incorrect CLI");
 
+  if (usid_block_len)
+    {
+      ip6_address_t *containers;
+
+      if (usid_block_len % SR_USID_LEN
+	  || usid_block_len + 2 * SR_USID_LEN > 128)
+	return clib_error_return (0, "uSID block length must be a multiple "
+				  "of %u bits leaving room for two uSIDs",
+				  SR_USID_LEN);
+      containers = sr_usid_compress (segments, usid_block_len);
+      vec_free (segments);
+      segments = containers;
+    }
+
   if (!policy_set)
     return clib_error_return (0, "No SR policy BSID or index specified");
 
@@ -939,7 +1015,8 @@ sr_policy_command_fn (vlib_main_t * vm, unformat_input_t * input,
 VLIB_CLI_COMMAND (sr_policy_command, static) = {
   .path = "sr policy",
   .short_help = "sr policy [add||del||mod] [bsid 2001::1||index 5] "
-    "next A:: next B:: next C:: (weight 1) (fib-table 2) (encap|insert)",
+    "next A:: next B:: next C:: (weight 1) (fib-table 2) (encap|insert) "
+    "(usid-block N)",
   .long_help =
     "Manipulation of SR policies.\n"
     "A Segment Routing policy may contain several SID lists. Each SID list has\n"
@@ -952,7 +1029,9 @@ VLIB_CLI_COMMAND (sr_policy_command, static) = {
     "The mod command allows you to add, remove, or modify the existing segment lists\n"
     "within an SR policy.\n"
     "The del command allows you to delete a SR policy along with all its associated\n"
-    "SID lists.\n",
+    "SID lists.\n"
+    "With usid-block, the segments that are uSIDs of the same N bits uSID block\n"
+    "are compressed into uSID containers.\n",
   .function = sr_policy_command_fn,
 };
 /* *INDENT-ON* */
@@ -219,6 +219,9 @@ tcp_connection_cleanup (tcp_connection_t * tc)
       /* Make sure all timers are cleared */
       tcp_connection_timers_reset (tc);
 
+      pool_free (tc->sack_sb.holes);
+      vec_free (tc->tx_ts);
+
       if (!tc->c_is_ip4 && ip6_address_is_link_local_unicast (&tc->c_rmt_ip6))
 	tcp_add_del_adjacency (tc, 0);
 
@@ -783,6 +786,11 @@ format_tcp_vars (u8 * s, va_list * args)
   s = format (s, " rto %u rto_boff %u srtt %u rttvar %u rtt_ts %u ", tc->rto,
 	      tc->rto_boff, tc->srtt, tc->rttvar, tc->rtt_ts);
   s = format (s, "rtt_seq %u\n", tc->rtt_seq);
+  s = format (s, " rack xmit_ts %u end_seq %u rtt %u min_rtt %u",
+	      tc->rack_xmit_ts, tc->rack_end_seq - tc->iss, tc->rack_rtt,
+	      tc->rack_min_rtt);
+  s = format (s, " tlp_high_seq %u\n",
+	      tc->tlp_high_seq ? tc->tlp_high_seq - tc->iss : 0);
   s = format (s, " tsval_recent %u tsval_recent_age %u\n", tc->tsval_recent,
 	      tcp_time_now () - tc->tsval_recent_age);
   if (tc->state >= TCP_STATE_ESTABLISHED)
@@ -939,8 +947,8 @@ format_tcp_scoreboard (u8 * s, va_list * args)
 	      sb->sacked_bytes, sb->last_sacked_bytes, sb->lost_bytes);
   s = format (s, " last_bytes_delivered %u high_sacked %u snd_una_adv %u\n",
 	      sb->last_bytes_delivered, sb->high_sacked, sb->snd_una_adv);
-  s = format (s, " cur_rxt_hole %u high_rxt %u rescue_rxt %u",
-	      sb->cur_rxt_hole, sb->high_rxt, sb->rescue_rxt);
+  s = format (s, " cur_rxt_hole %u high_rxt %u rescue_rxt %u hole_bytes %u",
+	      sb->cur_rxt_hole, sb->high_rxt, sb->rescue_rxt, sb->hole_bytes);
 
   hole = scoreboard_first_hole (sb);
   if (hole)
@@ -1207,7 +1215,9 @@ static timer_expiration_handler *timer_expiration_handlers[TCP_N_TIMERS] =
     tcp_timer_keep_handler,
     tcp_timer_waitclose_handler,
     tcp_timer_retransmit_syn_handler,
-    tcp_timer_establish_handler
+    tcp_timer_establish_handler,
+    tcp_timer_reorder_handler,
+    tcp_timer_tlp_handler
 };
 /* *INDENT-ON* */
 
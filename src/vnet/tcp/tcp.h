@@ -73,7 +73,9 @@ format_function_t format_tcp_rcv_sacks;
   _(KEEP, "KEEP")                       \
   _(WAITCLOSE, "WAIT CLOSE")            \
   _(RETRANSMIT_SYN, "RETRANSMIT SYN")   \
-  _(ESTABLISH, "ESTABLISH")
+  _(ESTABLISH, "ESTABLISH")             \
+  _(REORDER, "RACK REORDER")            \
+  _(TLP, "TAIL LOSS PROBE")
 
 typedef enum _tcp_timers
 {
@@ -89,6 +91,8 @@ extern timer_expiration_handler tcp_timer_delack_handler;
 extern timer_expiration_handler tcp_timer_retransmit_handler;
 extern timer_expiration_handler tcp_timer_persist_handler;
 extern timer_expiration_handler tcp_timer_retransmit_syn_handler;
+extern timer_expiration_handler tcp_timer_reorder_handler;
+extern timer_expiration_handler tcp_timer_tlp_handler;
 
 #define TCP_TIMER_HANDLE_INVALID ((u32) ~0)
 
@@ -109,6 +113,9 @@ extern timer_expiration_handler tcp_timer_retransmit_syn_handler;
 #define TCP_RTT_MAX 30 * THZ	/* 30s (probably too much) */
 #define TCP_RTO_SYN_RETRIES 3	/* SYN retries without doubling RTO */
 #define TCP_RTO_INIT 1 * THZ	/* Initial retransmit timer */
+#define TCP_TLP_MIN_PTO 0.01 * THZ	/* Min probe timeout (10ms) */
+#define TCP_TLP_DELACK 0.2 * THZ	/* Worst case peer delayed ack time */
+#define TCP_RACK_TX_TS_MAX 256	/* Max transmit time samples tracked */
 
 /** TCP connection flags */
 #define foreach_tcp_connection_flag             \
@@ -176,6 +183,7 @@ typedef struct _sack_scoreboard_hole
   u32 prev;		/**< Index for previous entry in linked list */
   u32 start;		/**< Start sequence number */
   u32 end;		/**< End sequence number */
+  u32 xmit_ts;		/**< Time of last retransmit from hole, if any */
   u8 is_lost;		/**< Mark hole as lost */
 } sack_scoreboard_hole_t;
 
@@ -192,7 +200,9 @@ typedef struct _sack_scoreboard
   u32 high_rxt;				/**< Highest retransmitted sequence */
   u32 rescue_rxt;			/**< Rescue sequence number */
   u32 lost_bytes;			/**< Bytes lost as per RFC6675 */
+  u32 hole_bytes;			/**< Bytes in all holes */
   u32 cur_rxt_hole;			/**< Retransmitting from this hole */
+  u8 rack_loss;				/**< RACK detected new losses */
 
 #if TCP_SCOREBOARD_TRACE
   scoreboard_trace_elt_t *trace;
@@ -257,6 +267,13 @@ typedef enum _tcp_cc_ack_t
   TCP_CC_PARTIALACK
 } tcp_cc_ack_t;
 
+/** Transmit time sample, covers all bytes sent up to seq */
+typedef struct _tcp_tx_ts
+{
+  u32 seq;		/**< End sequence number of bytes sent at ts */
+  u32 ts;		/**< Time bytes were sent */
+} tcp_tx_ts_t;
+
 typedef struct _tcp_connection
 {
   transport_connection_t connection;  /**< Common transport data. First! */
@@ -320,6 +337,14 @@ typedef struct _tcp_connection
   u32 rtt_ts;		/**< Timestamp for tracked ACK */
   u32 rtt_seq;		/**< Sequence number for tracked ACK */
 
+  /* RACK-TLP loss detection (RFC8985) */
+  tcp_tx_ts_t *tx_ts;	/**< Transmit times of outstanding bytes */
+  u32 rack_xmit_ts;	/**< Tx time of most recently delivered segment */
+  u32 rack_end_seq;	/**< End seq of most recently delivered segment */
+  u32 rack_rtt;		/**< RTT of most recently delivered segment */
+  u32 rack_min_rtt;	/**< Min RTT used to derive the reordering window */
+  u32 tlp_high_seq;	/**< snd_una_max when tail loss probe was sent */
+
   u16 mss;		/**< Our max seg size that includes options */
   u32 limited_transmit;	/**< snd_nxt when limited transmit starts */
   u32 last_fib_check;	/**< Last time we checked fib route for peer */
@@ -795,11 +820,68 @@ tcp_timer_is_active (tcp_connection_t * tc, tcp_timers_e timer)
   return tc->timers[timer] != TCP_TIMER_HANDLE_INVALID;
 }
 
+/**
+ * Probe timeout for tail loss probes as per RFC8985 Sec. 7.2
+ *
+ * Returns 0 if no probe should be scheduled, i.e., if the retransmit
+ * timer would fire first.
+ */
+always_inline u32
+tcp_tlp_pto (tcp_connection_t * tc)
+{
+  u32 pto;
+
+  if (!tc->srtt)
+    return 0;
+
+  pto = tc->srtt << 1;
+  if (tc->snd_una_max - tc->snd_una <= tc->snd_mss)
+    pto += TCP_TLP_DELACK;
+  pto = clib_max (pto, TCP_TLP_MIN_PTO);
+
+  return pto < tc->rto ? pto : 0;
+}
+
+/**
+ * Arm, re-arm or stop the tail loss probe timer
+ *
+ * Probes are only sent for SACK enabled connections that are not already
+ * recovering and that have not sent a probe for the current flight.
+ */
+always_inline void
+tcp_tlp_timer_update (tcp_connection_t * tc)
+{
+  u32 pto;
+
+  if (!tcp_opts_sack_permitted (&tc->rcv_opts)
+      || tc->snd_una == tc->snd_una_max || tcp_in_cong_recovery (tc)
+      || tc->tlp_high_seq || tc->rto_boff
+      || !(pto = tcp_tlp_pto (tc)))
+    {
+      tcp_timer_reset (tc, TCP_TIMER_TLP);
+      return;
+    }
+
+  tcp_timer_update (tc, TCP_TIMER_TLP, clib_max (pto * TCP_TO_TIMER_TICK, 1));
+}
+
+/**
+ * Forget the tail loss probe once the flight it was sent for is acked
+ */
+always_inline void
+tcp_tlp_rcv_ack (tcp_connection_t * tc)
+{
+  if (tc->tlp_high_seq && seq_geq (tc->snd_una, tc->tlp_high_seq))
+    tc->tlp_high_seq = 0;
+}
+
 #define tcp_validate_txf_size(_tc, _a) 					\
   ASSERT(_tc->state != TCP_STATE_ESTABLISHED 				\
 	 || session_tx_fifo_max_dequeue (&_tc->connection) >= _a)
 
 void tcp_rcv_sacks (tcp_connection_t * tc, u32 ack);
+void tcp_rack_update (tcp_connection_t * tc, u32 ack);
+u8 tcp_rack_detect_loss (tcp_connection_t * tc);
 u8 *tcp_scoreboard_replay (u8 * s, tcp_connection_t * tc, u8 verbose);
 
 void tcp_cc_algo_register (tcp_cc_algorithm_type_e type,
@@ -559,7 +559,7 @@ if (_av > 0) 								\
   {                                                             	\
     .format = "timer-pop: %s (%d)",                              	\
     .format_args = "t4i4",                                      	\
-    .n_enum_strings = 7,                                        	\
+    .n_enum_strings = 9,                                        	\
     .enum_strings = {                                           	\
       "retransmit",                                             	\
       "delack",                                                 	\
@@ -568,6 +568,8 @@ if (_av > 0) 								\
       "waitclose",                                              	\
       "retransmit syn",                                         	\
       "establish",                                              	\
+      "reorder",                                                	\
+      "tlp",                                                    	\
     },                                                          	\
   };                                                            	\
   if (_tc)								\
@@ -633,7 +635,7 @@ if (_av > 0) 								\
   {									\
     .format = "cc: %s snd_space %u snd_una %u out %u flight %u",	\
     .format_args = "t4i4i4i4i4",					\
-    .n_enum_strings = 7,						\
+    .n_enum_strings = 9,						\
     .enum_strings = {                                           	\
       "fast-rxt",	                                             	\
       "rxt-timeout",                                                 	\
@@ -642,6 +644,8 @@ if (_av > 0) 								\
       "congestion",							\
       "undo",								\
       "recovery",							\
+      "rack-loss",							\
+      "tlp",								\
     },  								\
   };									\
   DECLARE_ETD(_tc, _e, 5);						\
@@ -504,6 +504,7 @@ tcp_dequeue_acked (tcp_connection_t * tc, u32 ack)
   /* If everything has been acked, stop retransmit timer
    * otherwise update. */
   tcp_retransmit_timer_update (tc);
+  tcp_tlp_timer_update (tc);
 }
 
 /**
@@ -528,7 +529,7 @@ tcp_ack_is_cc_event (tcp_connection_t * tc, vlib_buffer_t * b,
 {
   /* Check if ack is duplicate. Per RFC 6675, ACKs that SACK new data are
    * defined to be 'duplicate' */
-  *is_dack = tc->sack_sb.last_sacked_bytes
+  *is_dack = tc->sack_sb.last_sacked_bytes || tc->sack_sb.rack_loss
     || tcp_ack_is_dupack (tc, b, prev_snd_wnd, prev_snd_una);
 
   return ((*is_dack || tcp_in_cong_recovery (tc)) && !tcp_is_lost_fin (tc));
@@ -615,6 +616,10 @@ scoreboard_remove_hole (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole)
   if (scoreboard_hole_index (sb, hole) == sb->cur_rxt_hole)
     sb->cur_rxt_hole = TCP_INVALID_SACK_HOLE_INDEX;
 
+  sb->hole_bytes -= scoreboard_hole_bytes (hole);
+  if (hole->is_lost)
+    sb->lost_bytes -= scoreboard_hole_bytes (hole);
+
   /* Poison the entry */
   if (CLIB_DEBUG > 0)
     memset (hole, 0xfe, sizeof (*hole));
@@ -635,6 +640,7 @@ scoreboard_insert_hole (sack_scoreboard_t * sb, u32 prev_index,
   hole->start = start;
   hole->end = end;
   hole_index = scoreboard_hole_index (sb, hole);
+  sb->hole_bytes += end - start;
 
   prev = scoreboard_get_hole (sb, prev_index);
   if (prev)
@@ -659,22 +665,138 @@ scoreboard_insert_hole (sack_scoreboard_t * sb, u32 prev_index,
   return hole;
 }
 
+/**
+ * Change hole boundaries while keeping byte accounting in sync
+ */
+static void
+scoreboard_update_hole (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole,
+			u32 start, u32 end)
+{
+  u32 old_bytes = scoreboard_hole_bytes (hole);
+
+  hole->start = start;
+  hole->end = end;
+  sb->hole_bytes += scoreboard_hole_bytes (hole) - old_bytes;
+  if (hole->is_lost)
+    sb->lost_bytes += scoreboard_hole_bytes (hole) - old_bytes;
+}
+
+/**
+ * Split hole by removing [start, end) from it. The bytes to the right of
+ * end are moved to a new hole that is returned.
+ *
+ * Since holes are marked as lost from head up to a point, the new hole is
+ * lost only if the hole after it is lost as well.
+ */
+static sack_scoreboard_hole_t *
+scoreboard_split_hole (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole,
+		       u32 start, u32 end)
+{
+  sack_scoreboard_hole_t *new_hole, *next;
+  u32 hole_index;
+
+  hole_index = scoreboard_hole_index (sb, hole);
+  new_hole = scoreboard_insert_hole (sb, hole_index, end, hole->end);
+
+  /* Pool might've moved */
+  hole = scoreboard_get_hole (sb, hole_index);
+  scoreboard_update_hole (sb, hole, hole->start, start);
+  new_hole->xmit_ts = hole->xmit_ts;
+
+  next = scoreboard_next_hole (sb, new_hole);
+  if (next && next->is_lost)
+    {
+      new_hole->is_lost = 1;
+      sb->lost_bytes += scoreboard_hole_bytes (new_hole);
+    }
+
+  ASSERT (hole->next == scoreboard_hole_index (sb, new_hole));
+  return new_hole;
+}
+
+/**
+ * Mark hole and all unmarked holes before it as lost
+ *
+ * Lost holes always form a prefix of the hole list, so the walk stops at
+ * the first hole already marked. Amortized over a recovery episode, every
+ * hole is visited once.
+ */
+static void
+scoreboard_mark_lost (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole)
+{
+  while (hole && !hole->is_lost)
+    {
+      hole->is_lost = 1;
+      sb->lost_bytes += scoreboard_hole_bytes (hole);
+      hole = scoreboard_prev_hole (sb, hole);
+    }
+}
+
+/**
+ * Find first hole that ends after seq
+ *
+ * Walks either forward from hole or backward from the tail, whichever is
+ * closer in sequence space. New SACK blocks typically cover the highest
+ * sequence numbers so this bounds the per-ack cost even when the scoreboard
+ * has many holes.
+ */
+static sack_scoreboard_hole_t *
+scoreboard_seek_hole (sack_scoreboard_t * sb, sack_scoreboard_hole_t * hole,
+		      u32 seq)
+{
+  sack_scoreboard_hole_t *last, *prev;
+
+  last = scoreboard_last_hole (sb);
+  if (seq_geq (seq, last->end))
+    return 0;
+  if (seq_geq (seq, last->start))
+    return last;
+
+  if (seq - hole->end <= last->start - seq)
+    {
+      while (hole && seq_leq (hole->end, seq))
+	hole = scoreboard_next_hole (sb, hole);
+      return hole;
+    }
+
+  hole = last;
+  while ((prev = scoreboard_prev_hole (sb, hole)) && seq_gt (prev->end, seq))
+    hole = prev;
+  return hole;
+}
+
+/**
+ * Update sacked and lost bytes
+ *
+ * Sacked bytes are derived from the span of the scoreboard and the bytes
+ * still in holes, so only the tail of the scoreboard, up to the last hole
+ * that's not yet lost, is walked.
+ */
 static void
 scoreboard_update_bytes (tcp_connection_t * tc, sack_scoreboard_t * sb)
 {
-  sack_scoreboard_hole_t *hole, *prev;
+  sack_scoreboard_hole_t *hole, *prev, *first;
   u32 bytes = 0, blks = 0;
 
-  sb->lost_bytes = 0;
-  sb->sacked_bytes = 0;
   hole = scoreboard_last_hole (sb);
   if (!hole)
-    return;
+    {
+      ASSERT (sb->lost_bytes == 0 && sb->hole_bytes == 0);
+      sb->sacked_bytes = 0;
+      return;
+    }
 
+  first = scoreboard_first_hole (sb);
   if (seq_gt (sb->high_sacked, hole->end))
     {
       bytes = sb->high_sacked - hole->end;
       blks = 1;
+      sb->sacked_bytes = sb->high_sacked - first->start - sb->hole_bytes;
+    }
+  else
+    {
+      sb->sacked_bytes = hole->start - first->start
+	- (sb->hole_bytes - scoreboard_hole_bytes (hole));
     }
 
   while ((prev = scoreboard_prev_hole (sb, hole))
@@ -686,16 +808,7 @@ scoreboard_update_bytes (tcp_connection_t * tc, sack_scoreboard_t * sb)
       hole = prev;
     }
 
-  while (hole)
-    {
-      sb->lost_bytes += scoreboard_hole_bytes (hole);
-      hole->is_lost = 1;
-      prev = hole;
-      hole = scoreboard_prev_hole (sb, hole);
-      if (hole)
-	bytes += prev->start - hole->end;
-    }
-  sb->sacked_bytes = bytes;
+  scoreboard_mark_lost (sb, hole);
 }
 
 /**
@@ -796,6 +909,8 @@ scoreboard_clear (sack_scoreboard_t * sb)
   sb->high_sacked = 0;
   sb->high_rxt = 0;
   sb->lost_bytes = 0;
+  sb->hole_bytes = 0;
+  sb->rack_loss = 0;
   sb->cur_rxt_hole = TCP_INVALID_SACK_HOLE_INDEX;
 }
 
@@ -819,12 +934,18 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
   sack_scoreboard_t *sb = &tc->sack_sb;
   sack_block_t *blk, tmp;
   sack_scoreboard_hole_t *hole, *next_hole, *last_hole;
-  u32 blk_index = 0, old_sacked_bytes, hole_index;
+  u32 blk_index = 0, old_sacked_bytes;
   int i, j;
 
   sb->last_sacked_bytes = 0;
   sb->last_bytes_delivered = 0;
   sb->snd_una_adv = 0;
+  sb->rack_loss = 0;
+
+  /* Options parsing only refreshes the blocks if the option is present,
+   * so whatever is left belongs to an earlier segment */
+  if (!tcp_opts_sack (&tc->rcv_opts))
+    vec_reset_length (tc->rcv_opts.sacks);
 
   if (!tcp_opts_sack (&tc->rcv_opts)
       && sb->head == TCP_INVALID_SACK_HOLE_INDEX)
@@ -888,7 +1009,8 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 	{
 	  if (seq_geq (last_hole->start, sb->high_sacked))
 	    {
-	      last_hole->end = tc->snd_una_max;
+	      scoreboard_update_hole (sb, last_hole, last_hole->start,
+				      tc->snd_una_max);
 	    }
 	  /* New hole after high sacked block */
 	  else if (seq_lt (sb->high_sacked, tc->snd_una_max))
@@ -908,6 +1030,14 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
   while (hole && blk_index < vec_len (tc->rcv_opts.sacks))
     {
       blk = &tc->rcv_opts.sacks[blk_index];
+
+      /* Skip holes that are not touched by the block */
+      if (seq_leq (hole->end, blk->start))
+	{
+	  hole = scoreboard_seek_hole (sb, hole, blk->start);
+	  continue;
+	}
+
       if (seq_leq (blk->start, hole->start))
 	{
 	  /* Block covers hole. Remove hole */
@@ -940,9 +1070,7 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 	  else
 	    {
 	      if (seq_gt (blk->end, hole->start))
-		{
-		  hole->start = blk->end;
-		}
+		scoreboard_update_hole (sb, hole, blk->end, hole->end);
 	      blk_index++;
 	    }
 	}
@@ -951,20 +1079,12 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
 	  /* Hole must be split */
 	  if (seq_lt (blk->end, hole->end))
 	    {
-	      hole_index = scoreboard_hole_index (sb, hole);
-	      next_hole = scoreboard_insert_hole (sb, hole_index, blk->end,
-						  hole->end);
-
-	      /* Pool might've moved */
-	      hole = scoreboard_get_hole (sb, hole_index);
-	      hole->end = blk->start;
+	      hole = scoreboard_split_hole (sb, hole, blk->start, blk->end);
 	      blk_index++;
-	      ASSERT (hole->next == scoreboard_hole_index (sb, next_hole));
-	    }
-	  else if (seq_lt (blk->start, hole->end))
-	    {
-	      hole->end = blk->start;
+	      continue;
 	    }
+
+	  scoreboard_update_hole (sb, hole, hole->start, blk->start);
 	  hole = scoreboard_next_hole (sb, hole);
 	}
     }
@@ -982,6 +1102,144 @@ tcp_rcv_sacks (tcp_connection_t * tc, u32 ack)
   TCP_EVT_DBG (TCP_EVT_CC_SCOREBOARD, tc);
 }
 
+/**
+ * Find time when byte with sequence number seq was last sent
+ *
+ * If no sample covers seq, current time is returned.
+ */
+static u32
+tcp_rack_xmit_ts (tcp_connection_t * tc, u32 seq)
+{
+  tcp_tx_ts_t *txts = tc->tx_ts;
+  int lo = 0, hi = vec_len (txts) - 1, mid;
+
+  if (hi < 0 || seq_geq (seq, txts[hi].seq))
+    return tcp_time_now ();
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) >> 1;
+      if (seq_lt (seq, txts[mid].seq))
+	hi = mid;
+      else
+	lo = mid + 1;
+    }
+  return txts[lo].ts;
+}
+
+static u32
+tcp_rack_hole_xmit_ts (tcp_connection_t * tc, sack_scoreboard_hole_t * hole)
+{
+  if (hole->xmit_ts)
+    return hole->xmit_ts;
+  return tcp_rack_xmit_ts (tc, hole->end - 1);
+}
+
+/**
+ * Update RACK state with most recently sent segment delivered by ack
+ *
+ * Newly delivered bytes are the ones cumulatively acked, from snd_una to
+ * ack, and, only if the ack carried a SACK option, the sacked blocks. The
+ * sorted sack vector also holds the cumulative ack block, so its highest
+ * block ends with the most recently sent segment.
+ */
+void
+tcp_rack_update (tcp_connection_t * tc, u32 ack)
+{
+  sack_block_t *sacks = tc->rcv_opts.sacks;
+  u32 end_seq = ack, xmit_ts, rtt, n_acked = 0;
+  u8 delivered = seq_gt (ack, tc->snd_una);
+
+  if (tcp_opts_sack (&tc->rcv_opts) && vec_len (sacks))
+    {
+      if (!delivered || seq_gt (sacks[vec_len (sacks) - 1].end, end_seq))
+	end_seq = sacks[vec_len (sacks) - 1].end;
+      delivered = 1;
+    }
+
+  if (delivered)
+    {
+      xmit_ts = tcp_rack_xmit_ts (tc, end_seq - 1);
+      if (timestamp_lt (tc->rack_xmit_ts, xmit_ts)
+	  || (xmit_ts == tc->rack_xmit_ts
+	      && seq_gt (end_seq, tc->rack_end_seq)))
+	{
+	  rtt = tcp_time_now () - xmit_ts;
+	  tc->rack_xmit_ts = xmit_ts;
+	  tc->rack_end_seq = end_seq;
+	  tc->rack_rtt = rtt;
+	  if (!tc->rack_min_rtt || rtt < tc->rack_min_rtt)
+	    tc->rack_min_rtt = clib_max (rtt, 1);
+	}
+    }
+
+  /* Drop samples for bytes that are cumulatively acked */
+  ack += tc->sack_sb.snd_una_adv;
+  while (n_acked < vec_len (tc->tx_ts)
+	 && seq_leq (tc->tx_ts[n_acked].seq, ack))
+    n_acked++;
+  if (n_acked)
+    vec_delete (tc->tx_ts, n_acked, 0);
+}
+
+/**
+ * RACK loss detection as per RFC8985 Sec. 6.2
+ *
+ * A hole is lost if its bytes were sent before the most recently delivered
+ * segment and were not delivered within one rtt plus a reordering window.
+ * Holes that could still be reordered arm the reordering timer. Lost holes
+ * form a prefix of the scoreboard so only the few unmarked holes at the
+ * tail need to be checked.
+ *
+ * @return 1 if new holes were marked as lost
+ */
+u8
+tcp_rack_detect_loss (tcp_connection_t * tc)
+{
+  sack_scoreboard_t *sb = &tc->sack_sb;
+  sack_scoreboard_hole_t *hole, *lost = 0;
+  u32 now, reo_wnd, xmit_ts, timeout = ~0;
+  i32 remaining;
+
+  if (!tc->rack_xmit_ts)
+    return 0;
+
+  now = tcp_time_now ();
+  reo_wnd = clib_max (tc->rack_min_rtt >> 2, 1);
+  hole = scoreboard_last_hole (sb);
+  while (hole && !hole->is_lost)
+    {
+      xmit_ts = tcp_rack_hole_xmit_ts (tc, hole);
+      if (timestamp_lt (xmit_ts, tc->rack_xmit_ts)
+	  || (xmit_ts == tc->rack_xmit_ts
+	      && seq_leq (hole->end, tc->rack_end_seq)))
+	{
+	  remaining = (i32) (xmit_ts + tc->rack_rtt + reo_wnd - now);
+	  if (remaining <= 0)
+	    {
+	      lost = hole;
+	      break;
+	    }
+	  timeout = clib_min (timeout, remaining);
+	}
+      hole = scoreboard_prev_hole (sb, hole);
+    }
+
+  if (timeout != ~0)
+    tcp_timer_update (tc, TCP_TIMER_REORDER,
+		      clib_max (timeout * TCP_TO_TIMER_TICK, 1));
+  else
+    tcp_timer_reset (tc, TCP_TIMER_REORDER);
+
+  if (!lost)
+    return 0;
+
+  scoreboard_mark_lost (sb, lost);
+  sb->rack_loss = 1;
+  TCP_EVT_DBG (TCP_EVT_CC_EVT, tc, 7);
+  return 1;
+}
+
 /**
  * Try to update snd_wnd based on feedback received from peer.
  *
@@ -1135,7 +1393,37 @@ static u8
 tcp_should_fastrecover (tcp_connection_t * tc)
 {
   return (tc->rcv_dupacks == TCP_DUPACK_THRESHOLD
-	  || tcp_should_fastrecover_sack (tc));
+	  || tcp_should_fastrecover_sack (tc) || tc->sack_sb.rack_loss);
+}
+
+/**
+ * Enter fast recovery and retransmit first unacked segment
+ */
+static void
+tcp_cc_enter_fastrecovery (tcp_connection_t * tc)
+{
+  tcp_cc_init_congestion (tc);
+  tc->cc_algo->rcv_cong_ack (tc, TCP_CC_DUPACK);
+
+  /* The first segment MUST be retransmitted */
+  tcp_retransmit_first_unacked (tc);
+
+  /* Post retransmit update cwnd to ssthresh and account for the
+   * three segments that have left the network and should've been
+   * buffered at the receiver XXX */
+  tc->cwnd = tc->ssthresh + tc->rcv_dupacks * tc->snd_mss;
+  ASSERT (tc->cwnd >= tc->snd_mss);
+
+  /* If cwnd allows, send more data */
+  if (tcp_opts_sack_permitted (&tc->rcv_opts))
+    {
+      scoreboard_init_high_rxt (&tc->sack_sb, tc->snd_una + tc->snd_mss);
+      tcp_fast_retransmit_sack (tc);
+    }
+  else
+    {
+      tcp_fast_retransmit_no_sack (tc);
+    }
 }
 
 /**
@@ -1195,29 +1483,7 @@ tcp_cc_handle_event (tcp_connection_t * tc, u32 is_dack)
 	      return;
 	    }
 
-	  tcp_cc_init_congestion (tc);
-	  tc->cc_algo->rcv_cong_ack (tc, TCP_CC_DUPACK);
-
-	  /* The first segment MUST be retransmitted */
-	  tcp_retransmit_first_unacked (tc);
-
-	  /* Post retransmit update cwnd to ssthresh and account for the
-	   * three segments that have left the network and should've been
-	   * buffered at the receiver XXX */
-	  tc->cwnd = tc->ssthresh + tc->rcv_dupacks * tc->snd_mss;
-	  ASSERT (tc->cwnd >= tc->snd_mss);
-
-	  /* If cwnd allows, send more data */
-	  if (tcp_opts_sack_permitted (&tc->rcv_opts))
-	    {
-	      scoreboard_init_high_rxt (&tc->sack_sb,
-					tc->snd_una + tc->snd_mss);
-	      tcp_fast_retransmit_sack (tc);
-	    }
-	  else
-	    {
-	      tcp_fast_retransmit_no_sack (tc);
-	    }
+	  tcp_cc_enter_fastrecovery (tc);
 	  return;
 	}
       else if (!tc->bytes_acked
@@ -1366,7 +1632,10 @@ tcp_rcv_ack (tcp_connection_t * tc, vlib_buffer_t * b,
    */
 process_ack:
   if (tcp_opts_sack_permitted (&tc->rcv_opts))
-    tcp_rcv_sacks (tc, vnet_buffer (b)->tcp.ack_number);
+    {
+      tcp_rcv_sacks (tc, vnet_buffer (b)->tcp.ack_number);
+      tcp_rack_update (tc, vnet_buffer (b)->tcp.ack_number);
+    }
 
   prev_snd_wnd = tc->snd_wnd;
   prev_snd_una = tc->snd_una;
@@ -1377,11 +1646,20 @@ process_ack:
   tc->snd_una = vnet_buffer (b)->tcp.ack_number + tc->sack_sb.snd_una_adv;
   tcp_validate_txf_size (tc, tc->bytes_acked);
 
+  tcp_tlp_rcv_ack (tc);
+
   if (tc->bytes_acked)
     tcp_dequeue_acked (tc, vnet_buffer (b)->tcp.ack_number);
 
   TCP_EVT_DBG (TCP_EVT_ACK_RCVD, tc);
 
+  /*
+   * Time based loss detection for holes that dupack counting would not
+   * mark as lost yet
+   */
+  if (tc->sack_sb.head != TCP_INVALID_SACK_HOLE_INDEX && !tcp_in_recovery (tc))
+    tcp_rack_detect_loss (tc);
+
   /*
    * Check if we have congestion event
    */
@@ -1403,6 +1681,34 @@ process_ack:
   return 0;
 }
 
+/**
+ * RACK reordering timer handler
+ *
+ * Holes that were waiting for the reordering window to elapse are checked
+ * again and, if lost, recovery starts without waiting for more acks.
+ */
+void
+tcp_timer_reorder_handler (u32 index)
+{
+  u32 thread_index = vlib_get_thread_index ();
+  tcp_connection_t *tc;
+
+  tc = tcp_connection_get (index, thread_index);
+  /* Note: the connection may have been closed and pool_put */
+  if (PREDICT_FALSE (tc == 0))
+    return;
+  tc->timers[TCP_TIMER_REORDER] = TCP_TIMER_HANDLE_INVALID;
+
+  if (tc->state < TCP_STATE_ESTABLISHED || tcp_in_recovery (tc)
+      || tc->snd_una == tc->snd_una_max || !tcp_rack_detect_loss (tc))
+    return;
+
+  if (tcp_in_fastrecovery (tc))
+    tcp_fast_retransmit (tc);
+  else
+    tcp_cc_enter_fastrecovery (tc);
+}
+
 static u8
 tcp_sack_vector_is_sane (sack_block_t * sacks)
 {
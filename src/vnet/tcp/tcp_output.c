@@ -1181,12 +1181,44 @@ tcp_push_hdr_i (tcp_connection_t * tc, vlib_buffer_t * b,
   TCP_EVT_DBG (TCP_EVT_PKTIZE, tc);
 }
 
+/**
+ * Record transmit time of all bytes up to snd_una_max for RACK
+ *
+ * Segments sent within the same tick share one sample. If too many samples
+ * are outstanding the oldest is dropped, which only delays loss detection
+ * for the bytes it covered.
+ */
+always_inline void
+tcp_rack_xmit_ts_add (tcp_connection_t * tc)
+{
+  u32 now = tcp_time_now ();
+  tcp_tx_ts_t *txts;
+
+  if (vec_len (tc->tx_ts))
+    {
+      txts = vec_end (tc->tx_ts) - 1;
+      if (txts->ts == now)
+	{
+	  txts->seq = tc->snd_una_max;
+	  return;
+	}
+      if (vec_len (tc->tx_ts) >= TCP_RACK_TX_TS_MAX)
+	vec_delete (tc->tx_ts, 1, 0);
+    }
+
+  vec_add2 (tc->tx_ts, txts, 1);
+  txts->seq = tc->snd_una_max;
+  txts->ts = now;
+}
+
 u32
 tcp_push_header (tcp_connection_t * tc, vlib_buffer_t * b)
 {
   tcp_push_hdr_i (tc, b, TCP_STATE_ESTABLISHED, /* compute opts */ 0,
 		  /* burst */ 1);
   tc->snd_una_max = tc->snd_nxt;
+  if (tcp_opts_sack_permitted (&tc->rcv_opts))
+    tcp_rack_xmit_ts_add (tc);
   ASSERT (seq_leq (tc->snd_una_max, tc->snd_una + tc->snd_wnd));
   tcp_validate_txf_size (tc, tc->snd_una_max - tc->snd_una);
   /* If not tracking an ACK, start tracking */
@@ -1200,6 +1232,8 @@ tcp_push_header (tcp_connection_t * tc, vlib_buffer_t * b)
       tcp_retransmit_timer_set (tc);
       tc->rto_boff = 0;
     }
+  if (!tcp_timer_is_active (tc, TCP_TIMER_TLP))
+    tcp_tlp_timer_update (tc);
   tcp_trajectory_add_start (b, 3);
   return 0;
 }
@@ -1407,6 +1441,8 @@ tcp_rxt_timeout_cc (tcp_connection_t * tc)
   tc->snd_congestion = tc->snd_una_max;
   tc->rtt_ts = 0;
   tc->cwnd_acc_bytes = 0;
+  tc->tlp_high_seq = 0;
+  tcp_timer_reset (tc, TCP_TIMER_TLP);
 
   tcp_recovery_on (tc);
 }
@@ -1476,6 +1512,7 @@ tcp_timer_retransmit_handler_i (u32 index, u8 is_syn)
 
       tc->snd_una_max = tc->snd_nxt = tc->snd_una;
       tc->rto = clib_min (tc->rto << 1, TCP_RTO_MAX);
+      vec_reset_length (tc->tx_ts);
 
       /* Send one segment. Note that n_bytes may be zero due to buffer shortfall  */
       n_bytes = tcp_prepare_retransmit_segment (tc, 0, tc->snd_mss, &b);
@@ -1578,6 +1615,56 @@ tcp_timer_retransmit_syn_handler (u32 index)
   tcp_timer_retransmit_handler_i (index, 1);
 }
 
+/**
+ * Tail loss probe timer handler
+ *
+ * Retransmits the last outstanding segment to solicit an ack whose SACK
+ * information triggers fast recovery instead of waiting for an RTO, as per
+ * RFC8985 Sec. 7.3. New data is never used as probe since the session
+ * layer schedules new data on its own.
+ */
+void
+tcp_timer_tlp_handler (u32 index)
+{
+  vlib_main_t *vm = vlib_get_main ();
+  u32 thread_index = vlib_get_thread_index ();
+  u32 bi, offset, n_bytes, max_bytes, old_snd_nxt, old_snd_congestion;
+  tcp_connection_t *tc;
+  vlib_buffer_t *b = 0;
+
+  tc = tcp_connection_get (index, thread_index);
+  /* Note: the connection may have been closed and pool_put */
+  if (PREDICT_FALSE (tc == 0))
+    return;
+  tc->timers[TCP_TIMER_TLP] = TCP_TIMER_HANDLE_INVALID;
+
+  if (tc->state < TCP_STATE_ESTABLISHED || (tc->flags & TCP_CONN_FINSNT)
+      || tcp_in_cong_recovery (tc) || tc->snd_una == tc->snd_una_max
+      || tc->tlp_high_seq)
+    return;
+
+  max_bytes = clib_min (tc->snd_mss, tc->snd_una_max - tc->snd_una);
+  offset = tc->snd_una_max - tc->snd_una - max_bytes;
+
+  /* Not in recovery, so snd_congestion may be stale. Retransmit up to
+   * snd_una_max instead */
+  old_snd_nxt = tc->snd_nxt;
+  old_snd_congestion = tc->snd_congestion;
+  tc->snd_nxt = tc->snd_una + offset;
+  tc->snd_congestion = tc->snd_una_max;
+  n_bytes = tcp_prepare_retransmit_segment (tc, offset, max_bytes, &b);
+  tc->snd_nxt = old_snd_nxt;
+  tc->snd_congestion = old_snd_congestion;
+
+  if (!n_bytes)
+    return;
+
+  tc->tlp_high_seq = tc->snd_una_max;
+  TCP_EVT_DBG (TCP_EVT_CC_EVT, tc, 8);
+  bi = vlib_get_buffer_index (vm, b);
+  tcp_enqueue_to_output (vm, b, bi, tc->c_is_ip4);
+}
+
 /**
  * Got 0 snd_wnd from peer, try to do something about it.
  *
@@ -1751,6 +1838,7 @@ tcp_fast_retransmit_sack (tcp_connection_t * tc)
 
       bi = vlib_get_buffer_index (vm, b);
       sb->high_rxt += n_written;
+      hole->xmit_ts = tcp_time_now ();
       tcp_enqueue_to_output (vm, b, bi, tc->c_is_ip4);
       ASSERT (n_written <= snd_space);
       snd_space -= n_written;
@@ -66,6 +66,26 @@ tcp_test_scoreboard_replay (vlib_main_t * vm, unformat_input_t * input)
   return 0;
 }
 
+static int
+tcp_test_scoreboard_bytes (sack_scoreboard_t * sb, u32 * hole_bytes,
+			   u32 * lost_bytes)
+{
+  sack_scoreboard_hole_t *hole;
+  int n_holes = 0;
+
+  *hole_bytes = *lost_bytes = 0;
+  hole = scoreboard_first_hole (sb);
+  while (hole)
+    {
+      *hole_bytes += hole->end - hole->start;
+      if (hole->is_lost)
+	*lost_bytes += hole->end - hole->start;
+      hole = scoreboard_next_hole (sb, hole);
+      n_holes++;
+    }
+  return n_holes;
+}
+
 static int
 tcp_test_sack_rx (vlib_main_t * vm, unformat_input_t * input)
 {
@@ -354,6 +374,61 @@ tcp_test_sack_rx (vlib_main_t * vm, unformat_input_t * input)
     vlib_cli_output (vm, "sb added [0, 300]:\n%U", format_tcp_scoreboard, sb);
   TCP_TEST ((sb->sacked_bytes == 500), "sacked bytes %d", sb->sacked_bytes);
 
+  /*
+   * Many holes. Sack every other segment, one per ack, and check that
+   * the incrementally maintained byte counters match a full walk
+   */
+  scoreboard_clear (sb);
+  tc->snd_una = 0;
+  tc->snd_una_max = 100000;
+  tc->snd_nxt = 100000;
+  tc->snd_mss = 100;
+
+  for (i = 0; i < 100000 / 200; i++)
+    {
+      vec_reset_length (tc->rcv_opts.sacks);
+      block.start = i * 200 + 100;
+      block.end = (i + 1) * 200;
+      vec_add1 (tc->rcv_opts.sacks, block);
+      tc->rcv_opts.n_sack_blocks = vec_len (tc->rcv_opts.sacks);
+      tcp_rcv_sacks (tc, 0);
+    }
+
+  {
+    u32 hole_bytes, lost_bytes;
+    int n_holes;
+
+    n_holes = tcp_test_scoreboard_bytes (sb, &hole_bytes, &lost_bytes);
+    if (verbose)
+      vlib_cli_output (vm, "sb with %d holes:\n%U", n_holes,
+		       format_tcp_scoreboard, sb, 0);
+    TCP_TEST ((n_holes == 500), "scoreboard has %d holes", n_holes);
+    TCP_TEST ((sb->hole_bytes == hole_bytes && hole_bytes == 50000),
+	      "hole bytes %u walk %u", sb->hole_bytes, hole_bytes);
+    TCP_TEST ((sb->lost_bytes == lost_bytes && lost_bytes == 49900),
+	      "lost bytes %u walk %u", sb->lost_bytes, lost_bytes);
+    TCP_TEST ((sb->sacked_bytes == 50000), "sacked bytes %u",
+	      sb->sacked_bytes);
+
+    /* Ack half of the holes */
+    vec_reset_length (tc->rcv_opts.sacks);
+    tcp_rcv_sacks (tc, 50000);
+
+    n_holes = tcp_test_scoreboard_bytes (sb, &hole_bytes, &lost_bytes);
+    TCP_TEST ((n_holes == 250), "scoreboard has %d holes", n_holes);
+    TCP_TEST ((sb->snd_una_adv == 0), "snd_una_adv %u", sb->snd_una_adv);
+    TCP_TEST ((sb->hole_bytes == hole_bytes && hole_bytes == 25000),
+	      "hole bytes %u walk %u", sb->hole_bytes, hole_bytes);
+    TCP_TEST ((sb->lost_bytes == lost_bytes && lost_bytes == 24900),
+	      "lost bytes %u walk %u", sb->lost_bytes, lost_bytes);
+    TCP_TEST ((sb->sacked_bytes == 25000), "sacked bytes %u",
+	      sb->sacked_bytes);
+  }
+
+  scoreboard_clear (sb);
+  TCP_TEST ((sb->hole_bytes == 0 && sb->lost_bytes == 0),
+	    "hole bytes %u lost bytes %u", sb->hole_bytes, sb->lost_bytes);
+
   return 0;
 }
 
@@ -1718,6 +1793,273 @@ tcp_test_session (vlib_main_t * vm, unformat_input_t * input)
   return rv;
 }
 
+/*
+ * RACK and TLP tests use a connection in the connections pool, so that
+ * its timers can be armed and their handlers can find it, and a session
+ * with private fifos that only serve as the connection's tx buffer.
+ */
+static tcp_connection_t *
+tcp_test_rack_connection (u32 n_segs, u32 tx_time)
+{
+  tcp_connection_t *tc;
+  stream_session_t *s;
+  tcp_tx_ts_t *txts;
+  u8 *data = 0;
+  int i;
+
+  tc = tcp_connection_new (0);
+  tc->state = TCP_STATE_ESTABLISHED;
+  tc->c_is_ip4 = 1;
+  tc->c_lcl_ip4.as_u32 = clib_host_to_net_u32 (0x06000101);
+  tc->c_rmt_ip4.as_u32 = clib_host_to_net_u32 (0x06000102);
+  tc->c_lcl_port = clib_host_to_net_u16 (1234);
+  tc->c_rmt_port = clib_host_to_net_u16 (11234);
+  tc->rcv_opts.mss = 1450;
+  tc->rcv_opts.flags |= TCP_OPTS_FLAG_SACK_PERMITTED;
+  tcp_connection_init_vars (tc);
+
+  s = session_alloc (0);
+  s->session_state = SESSION_STATE_READY;
+  s->connection_index = tc->c_c_index;
+  s->server_rx_fifo = svm_fifo_create (64 << 10);
+  s->server_tx_fifo = svm_fifo_create (64 << 10);
+  tc->c_s_index = s->session_index;
+
+  /* All segments are in flight, each sent one tick after the previous */
+  vec_validate (data, n_segs * tc->snd_mss - 1);
+  svm_fifo_enqueue_nowait (s->server_tx_fifo, vec_len (data), data);
+  vec_free (data);
+
+  tc->snd_una = 0;
+  tc->snd_nxt = tc->snd_una_max = n_segs * tc->snd_mss;
+  tc->snd_wnd = 64 << 10;
+  tc->cwnd = n_segs * tc->snd_mss;
+  for (i = 0; i < n_segs; i++)
+    {
+      vec_add2 (tc->tx_ts, txts, 1);
+      txts->seq = (i + 1) * tc->snd_mss;
+      txts->ts = tx_time + i;
+    }
+
+  return tc;
+}
+
+static void
+tcp_test_rack_connection_free (tcp_connection_t * tc)
+{
+  tcp_main_t *tm = vnet_get_tcp_main ();
+  stream_session_t *s = session_get (tc->c_s_index, 0);
+
+  tcp_connection_timers_reset (tc);
+  pool_free (tc->sack_sb.holes);
+  vec_free (tc->rcv_opts.sacks);
+  vec_free (tc->tx_ts);
+  svm_fifo_free (s->server_rx_fifo);
+  svm_fifo_free (s->server_tx_fifo);
+  session_free (s);
+  pool_put (tm->connections[0], tc);
+}
+
+/*
+ * Take the segments sent by a test connection back from the pending
+ * tcp4-output frame, before they are dispatched
+ */
+static int
+tcp_test_rack_sent (vlib_main_t * vm, tcp_connection_t * tc, u32 * seq,
+		    u32 * len)
+{
+  tcp_main_t *tm = vnet_get_tcp_main ();
+  vlib_frame_t *f = tm->wrk_ctx[0].tx_frames[0];
+  u32 *from, i, n_left = 0;
+  tcp_header_t *th;
+  vlib_buffer_t *b;
+  int n_sent = 0;
+
+  if (!f)
+    return 0;
+
+  from = vlib_frame_vector_args (f);
+  for (i = 0; i < f->n_vectors; i++)
+    {
+      b = vlib_get_buffer (vm, from[i]);
+      if (vnet_buffer (b)->tcp.connection_index != tc->c_c_index)
+	{
+	  from[n_left++] = from[i];
+	  continue;
+	}
+      if (n_sent++ == 0)
+	{
+	  th = vlib_buffer_get_current (b);
+	  *seq = clib_net_to_host_u32 (th->seq_number);
+	  *len = vlib_buffer_length_in_chain (vm, b) - tcp_header_bytes (th);
+	}
+      vlib_buffer_free_one (vm, from[i]);
+    }
+
+  f->n_vectors = n_left;
+  if (!n_left)
+    {
+      vlib_frame_free (vm, vlib_node_get_runtime (vm, tcp4_output_node.index),
+		       f);
+      tm->wrk_ctx[0].tx_frames[0] = 0;
+    }
+  return n_sent;
+}
+
+static int
+tcp_test_rack (vlib_main_t * vm, unformat_input_t * input)
+{
+  tcp_main_t *tm = vnet_get_tcp_main ();
+  tcp_connection_t *tc;
+  sack_scoreboard_t *sb;
+  sack_scoreboard_hole_t *hole;
+  sack_block_t block;
+  tcp_tx_ts_t *tx_ts;
+  u32 now, mss, seq = 0, len = 0, xmit_ts;
+  int n_sent, verbose = 0;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "verbose"))
+	verbose = 1;
+      else
+	break;
+    }
+
+  now = tcp_set_time_now (0);
+
+  /*
+   * Ten segments in flight, the first sent 20 ticks ago. The third is
+   * sacked: rtt 18 and reordering window 18 / 4 = 4
+   */
+  tc = tcp_test_rack_connection (10, now - 20);
+  sb = &tc->sack_sb;
+  mss = tc->snd_mss;
+
+  block.start = 2 * mss;
+  block.end = 3 * mss;
+  tc->rcv_opts.flags |= TCP_OPTS_FLAG_SACK;
+  vec_add1 (tc->rcv_opts.sacks, block);
+  tcp_rcv_sacks (tc, 0);
+  tcp_rack_update (tc, 0);
+
+  if (verbose)
+    vlib_cli_output (vm, "sb after sack of third segment:\n%U",
+		     format_tcp_scoreboard, sb);
+
+  TCP_TEST ((tc->rack_xmit_ts == now - 18 && tc->rack_end_seq == 3 * mss),
+	    "rack xmit ts %d end seq %u", tc->rack_xmit_ts - now,
+	    tc->rack_end_seq);
+  TCP_TEST ((tc->rack_rtt == 18 && tc->rack_min_rtt == 18),
+	    "rack rtt %u min rtt %u", tc->rack_rtt, tc->rack_min_rtt);
+
+  /* First hole was sent one tick before the sacked segment so it may still
+   * be reordered, 3 more ticks. Last hole was sent after it */
+  TCP_TEST ((tcp_rack_detect_loss (tc) == 0), "no loss within reorder wnd");
+  hole = scoreboard_first_hole (sb);
+  TCP_TEST ((hole->start == 0 && hole->end == 2 * mss && !hole->is_lost),
+	    "first hole start %u end %u lost %u", hole->start, hole->end,
+	    hole->is_lost);
+  hole = scoreboard_last_hole (sb);
+  TCP_TEST ((!hole->is_lost && sb->lost_bytes == 0),
+	    "last hole lost %u lost bytes %u", hole->is_lost, sb->lost_bytes);
+  TCP_TEST ((tcp_timer_is_active (tc, TCP_TIMER_REORDER)),
+	    "reorder timer is armed");
+
+  /*
+   * Ack without SACK option that acks nothing new, after the transmit
+   * samples were dropped, as on rto. The sack block of the previous ack
+   * must not be taken as delivered again
+   */
+  xmit_ts = tc->rack_xmit_ts;
+  tx_ts = tc->tx_ts;
+  tc->tx_ts = 0;
+  tc->rcv_opts.flags &= ~TCP_OPTS_FLAG_SACK;
+  tcp_rcv_sacks (tc, 0);
+  tcp_rack_update (tc, 0);
+
+  TCP_TEST ((vec_len (tc->rcv_opts.sacks) == 0),
+	    "sack blocks %u", vec_len (tc->rcv_opts.sacks));
+  TCP_TEST ((tc->rack_xmit_ts == xmit_ts && tc->rack_rtt == 18),
+	    "rack xmit ts %d rtt %u", tc->rack_xmit_ts - now, tc->rack_rtt);
+  TCP_TEST ((sb->sacked_bytes == mss), "sacked bytes %u", sb->sacked_bytes);
+  tc->tx_ts = tx_ts;
+
+  /*
+   * Reordering window expires, the reorder timer marks the first hole
+   * lost and fast recovery retransmits it
+   */
+  tm->wrk_ctx[0].time_now = now + 3;
+  tcp_timer_reset (tc, TCP_TIMER_REORDER);
+  tcp_timer_reorder_handler (tc->c_c_index);
+
+  if (verbose)
+    vlib_cli_output (vm, "sb after reorder timer:\n%U",
+		     format_tcp_scoreboard, sb);
+
+  hole = scoreboard_first_hole (sb);
+  TCP_TEST ((hole->is_lost && sb->lost_bytes == 2 * mss),
+	    "first hole lost %u lost bytes %u", hole->is_lost, sb->lost_bytes);
+  TCP_TEST ((tcp_in_fastrecovery (tc)), "in fast recovery");
+  TCP_TEST ((!tcp_timer_is_active (tc, TCP_TIMER_REORDER)),
+	    "reorder timer is not armed");
+  n_sent = tcp_test_rack_sent (vm, tc, &seq, &len);
+  TCP_TEST ((n_sent >= 1 && seq == 0 && len == mss),
+	    "retransmitted %d segments, first seq %u len %u", n_sent, seq,
+	    len);
+
+  tcp_test_rack_connection_free (tc);
+
+  /*
+   * Tail of four segments is not acked. The loss probe timer is armed,
+   * when it fires the last segment is resent
+   */
+  tm->wrk_ctx[0].time_now = now;
+  tc = tcp_test_rack_connection (4, now - 4);
+  mss = tc->snd_mss;
+  tc->srtt = 50;
+  tc->rto = 1000;
+
+  tcp_tlp_timer_update (tc);
+  TCP_TEST ((tcp_timer_is_active (tc, TCP_TIMER_TLP)), "tlp timer is armed");
+
+  tm->wrk_ctx[0].time_now = now + tcp_tlp_pto (tc);
+  tcp_timer_reset (tc, TCP_TIMER_TLP);
+  tcp_timer_tlp_handler (tc->c_c_index);
+
+  TCP_TEST ((tc->tlp_high_seq == 4 * mss), "tlp high seq %u",
+	    tc->tlp_high_seq);
+  n_sent = tcp_test_rack_sent (vm, tc, &seq, &len);
+  TCP_TEST ((n_sent == 1 && seq == 3 * mss && len == mss),
+	    "sent %d probes, seq %u len %u", n_sent, seq, len);
+
+  /* Only one probe per flight */
+  tcp_tlp_timer_update (tc);
+  TCP_TEST ((!tcp_timer_is_active (tc, TCP_TIMER_TLP)),
+	    "tlp timer is not armed with probe outstanding");
+
+  /* Partial ack leaves the probe outstanding, full ack clears it */
+  tc->snd_una = 2 * mss;
+  tcp_tlp_rcv_ack (tc);
+  TCP_TEST ((tc->tlp_high_seq == 4 * mss), "tlp high seq %u after partial "
+	    "ack", tc->tlp_high_seq);
+  tc->snd_una = 4 * mss;
+  tcp_tlp_rcv_ack (tc);
+  TCP_TEST ((tc->tlp_high_seq == 0), "tlp high seq %u after ack",
+	    tc->tlp_high_seq);
+
+  /* New flight can be probed again */
+  tc->snd_nxt = tc->snd_una_max = 5 * mss;
+  tcp_tlp_timer_update (tc);
+  TCP_TEST ((tcp_timer_is_active (tc, TCP_TIMER_TLP)),
+	    "tlp timer is armed for new flight");
+
+  tcp_test_rack_connection_free (tc);
+  tcp_set_time_now (0);
+
+  return 0;
+}
+
 static clib_error_t *
 tcp_test (vlib_main_t * vm,
 	  unformat_input_t * input, vlib_cli_command_t * cmd_arg)
@@ -1742,6 +2084,10 @@ tcp_test (vlib_main_t * vm,
 	{
 	  res = tcp_test_lookup (vm, input);
 	}
+      else if (unformat (input, "rack"))
+	{
+	  res = tcp_test_rack (vm, input);
+	}
       else if (unformat (input, "all"))
 	{
 	  if ((res = tcp_test_sack (vm, input)))
@@ -1750,6 +2096,8 @@ tcp_test (vlib_main_t * vm,
 	    goto done;
 	  if ((res = tcp_test_lookup (vm, input)))
 	    goto done;
+	  if ((res = tcp_test_rack (vm, input)))
+	    goto done;
 	}
       else
 	break;
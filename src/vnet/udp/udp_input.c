@@ -76,6 +76,46 @@ udp_input_inc_counter (vlib_main_t * vm, u8 is_ip4, u8 evt, u8 val)
     vlib_node_increment_counter (vm, udp6_input_node.index, evt, val);
 }
 
+/**
+ * Last session matched by udp input on this frame. Bursts of datagrams on
+ * the same 5-tuple, e.g., a connected peer or a busy dgram listener, skip
+ * the session table lookup. Only sessions owned by the current thread are
+ * cached, so no pool peeker needs to be held across packets.
+ */
+typedef struct
+{
+  stream_session_t *s;
+  u32 fib_index;
+  u32 ports;
+  ip46_address_t lcl_ip;
+  ip46_address_t rmt_ip;
+} udp_input_flow_cache_t;
+
+always_inline int
+udp_input_flow_cache_hit (udp_input_flow_cache_t * fc, u32 fib_index,
+			  void *lcl, void *rmt, u32 ports, u8 is_ip4)
+{
+  if (!fc->s || fc->fib_index != fib_index || fc->ports != ports)
+    return 0;
+  if (is_ip4)
+    return (fc->lcl_ip.ip4.as_u32 == ((ip4_address_t *) lcl)->as_u32
+	    && fc->rmt_ip.ip4.as_u32 == ((ip4_address_t *) rmt)->as_u32);
+  return (ip6_address_is_equal (&fc->lcl_ip.ip6, lcl)
+	  && ip6_address_is_equal (&fc->rmt_ip.ip6, rmt));
+}
+
+always_inline void
+udp_input_flow_cache_set (udp_input_flow_cache_t * fc, stream_session_t * s,
+			  u32 fib_index, void *lcl, void *rmt, u32 ports,
+			  u8 is_ip4)
+{
+  fc->s = s;
+  fc->fib_index = fib_index;
+  fc->ports = ports;
+  ip_set (&fc->lcl_ip, lcl, is_ip4);
+  ip_set (&fc->rmt_ip, rmt, is_ip4);
+}
+
 always_inline uword
 udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 		    vlib_frame_t * frame, u8 is_ip4)
@@ -83,6 +123,7 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
   u32 n_left_from, *from, *to_next;
   u32 next_index, errors;
   u32 my_thread_index = vm->thread_index;
+  udp_input_flow_cache_t _fc = { 0 }, *fc = &_fc;
 
   from = vlib_frame_vector_args (frame);
   n_left_from = frame->n_vectors;
@@ -96,7 +137,7 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 
       while (n_left_from > 0 && n_left_to_next > 0)
 	{
-	  u32 bi0, fib_index0;
+	  u32 bi0, fib_index0, ports0;
 	  vlib_buffer_t *b0;
 	  u32 next0 = UDP_INPUT_NEXT_DROP;
 	  u32 error0 = UDP_ERROR_ENQUEUED;
@@ -125,28 +166,43 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	  data0 = vlib_buffer_get_current (b0);
 	  udp0 = (udp_header_t *) (data0 - sizeof (*udp0));
 	  fib_index0 = vnet_buffer (b0)->ip.fib_index;
+	  ports0 = ((u32 *) udp0)[0];
 
 	  if (is_ip4)
 	    {
 	      /* TODO: must fix once udp_local does ip options correctly */
 	      ip40 = (ip4_header_t *) (((u8 *) udp0) - sizeof (*ip40));
-	      s0 = session_lookup_safe4 (fib_index0, &ip40->dst_address,
-					 &ip40->src_address, udp0->dst_port,
-					 udp0->src_port, TRANSPORT_PROTO_UDP);
 	      lcl_addr = &ip40->dst_address;
 	      rmt_addr = &ip40->src_address;
-
 	    }
 	  else
 	    {
 	      ip60 = (ip6_header_t *) (((u8 *) udp0) - sizeof (*ip60));
-	      s0 = session_lookup_safe6 (fib_index0, &ip60->dst_address,
-					 &ip60->src_address, udp0->dst_port,
-					 udp0->src_port, TRANSPORT_PROTO_UDP);
 	      lcl_addr = &ip60->dst_address;
 	      rmt_addr = &ip60->src_address;
 	    }
 
+	  if (udp_input_flow_cache_hit (fc, fib_index0, lcl_addr, rmt_addr,
+					ports0, is_ip4))
+	    {
+	      s0 = fc->s;
+	      if (s0->session_state == SESSION_STATE_LISTENING)
+		tc0 = listen_session_get_transport (s0);
+	      else
+		tc0 = session_get_transport (s0);
+	      uc0 = udp_get_connection_from_transport (tc0);
+	      goto enqueue0;
+	    }
+
+	  if (is_ip4)
+	    s0 = session_lookup_safe4 (fib_index0, &ip40->dst_address,
+				       &ip40->src_address, udp0->dst_port,
+				       udp0->src_port, TRANSPORT_PROTO_UDP);
+	  else
+	    s0 = session_lookup_safe6 (fib_index0, &ip60->dst_address,
+				       &ip60->src_address, udp0->dst_port,
+				       udp0->src_port, TRANSPORT_PROTO_UDP);
+
 	  if (PREDICT_FALSE (!s0))
 	    {
 	      error0 = UDP_ERROR_NO_LISTENER;
@@ -168,6 +224,7 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 		   * Clone the transport. It will be cleaned up with the
 		   * session once we notify the session layer.
 		   */
+		  fc->s = 0;
 		  new_uc0 = udp_connection_clone_safe (s0->connection_index,
 						       s0->thread_index);
 		  ASSERT (s0->session_index == new_uc0->c_s_index);
@@ -192,6 +249,7 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	      uc0 = udp_get_connection_from_transport (tc0);
 	      if (uc0->is_connected)
 		{
+		  fc->s = 0;
 		  child0 = udp_connection_alloc (my_thread_index);
 		  if (is_ip4)
 		    {
@@ -227,6 +285,16 @@ udp46_input_inline (vlib_main_t * vm, vlib_node_runtime_t * node,
 	      goto trace0;
 	    }
 
+	  /* Remember sessions that need no peeker, i.e., dgram listeners and
+	   * sessions owned by this thread */
+	  if (s0->session_state == SESSION_STATE_LISTENING
+	      ? !uc0->is_connected
+	      : (s0->session_state == SESSION_STATE_READY
+		 && s0->thread_index == my_thread_index))
+	    udp_input_flow_cache_set (fc, s0, fib_index0, lcl_addr, rmt_addr,
+				      ports0, is_ip4);
+
+	enqueue0:
 	  if (!uc0->is_connected)
 	    {
 	      if (svm_fifo_max_enqueue (s0->server_rx_fifo)
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vnet/udp/udp_tunnel_demux.h>
+
+udp_tunnel_demux_main_t udp_tunnel_demux_main = {
+  .v4_buckets = UDP_TUNNEL_DEMUX_DEFAULT_NUM_BUCKETS,
+  .v4_memory_size = UDP_TUNNEL_DEMUX_DEFAULT_MEMORY_SIZE,
+  .v6_buckets = UDP_TUNNEL_DEMUX_DEFAULT_NUM_BUCKETS,
+  .v6_memory_size = UDP_TUNNEL_DEMUX_DEFAULT_MEMORY_SIZE,
+};
+
+/**
+ * Set up a demux. Nothing is allocated until the first tunnel is added.
+ */
+void
+udp_tunnel_demux_init (udp_tunnel_demux_t * td, char *name)
+{
+  memset (td, 0, sizeof (*td));
+  td->name = name;
+}
+
+static void
+udp_tunnel_demux_table_init (udp_tunnel_demux_t * td, u8 is_ip6)
+{
+  udp_tunnel_demux_main_t *tdm = &udp_tunnel_demux_main;
+  u8 *name;
+
+  /* the bihash keeps the name pointer */
+  name = format (0, "%s%d%c", td->name, is_ip6 ? 6 : 4, 0);
+  if (is_ip6)
+    {
+      clib_bihash_init_24_8 (&td->tunnel6_by_key, (char *) name,
+			     tdm->v6_buckets, tdm->v6_memory_size);
+      td->tunnel6_is_init = 1;
+    }
+  else
+    {
+      clib_bihash_init_16_8 (&td->tunnel4_by_key, (char *) name,
+			     tdm->v4_buckets, tdm->v4_memory_size);
+      td->tunnel4_is_init = 1;
+    }
+}
+
+/**
+ * Add or delete the tunnel for a key. Returns 0 on success, else the
+ * bihash error; adding an existing key overwrites it.
+ */
+int
+udp_tunnel_demux_add_del (udp_tunnel_demux_t * td,
+			  const ip46_address_t * remote, u32 fib_index,
+			  u32 id, u8 is_ip6, u32 tunnel_index, int is_add)
+{
+  udp_tunnel_demux_key_t k;
+
+  if (!(is_ip6 ? td->tunnel6_is_init : td->tunnel4_is_init))
+    {
+      if (!is_add)
+	return -1;
+      udp_tunnel_demux_table_init (td, is_ip6);
+    }
+
+  if (is_ip6)
+    {
+      udp_tunnel_demux_key6 (&k, &remote->ip6, fib_index, id);
+      k.kv6.value = tunnel_index;
+      return clib_bihash_add_del_24_8 (&td->tunnel6_by_key, &k.kv6, is_add);
+    }
+
+  udp_tunnel_demux_key4 (&k, &remote->ip4, fib_index, id);
+  k.kv4.value = tunnel_index;
+  return clib_bihash_add_del_16_8 (&td->tunnel4_by_key, &k.kv4, is_add);
+}
+
+u32
+udp_tunnel_demux_find (udp_tunnel_demux_t * td,
+		       const ip46_address_t * remote, u32 fib_index, u32 id,
+		       u8 is_ip6)
+{
+  udp_tunnel_demux_key_t k;
+
+  if (is_ip6)
+    udp_tunnel_demux_key6 (&k, &remote->ip6, fib_index, id);
+  else
+    udp_tunnel_demux_key4 (&k, &remote->ip4, fib_index, id);
+
+  return udp_tunnel_demux_lookup (td, &k, !is_ip6);
+}
+
+u8 *
+format_udp_tunnel_demux (u8 * s, va_list * args)
+{
+  udp_tunnel_demux_t *td = va_arg (*args, udp_tunnel_demux_t *);
+  int verbose = va_arg (*args, int);
+
+  if (td->tunnel4_is_init)
+    s = format (s, "%U\n", format_bihash_16_8, &td->tunnel4_by_key,
+		verbose);
+  else
+    s = format (s, "%s4: no ip4 tunnels\n", td->name);
+  if (td->tunnel6_is_init)
+    s = format (s, "%U", format_bihash_24_8, &td->tunnel6_by_key, verbose);
+  else
+    s = format (s, "%s6: no ip6 tunnels", td->name);
+
+  return s;
+}
+
+static clib_error_t *
+udp_tunnel_demux_config (vlib_main_t * vm, unformat_input_t * input)
+{
+  udp_tunnel_demux_main_t *tdm = &udp_tunnel_demux_main;
+  uword tmp;
+
+  while (unformat_check_input (input) != UNFORMAT_END_OF_INPUT)
+    {
+      if (unformat (input, "v4-buckets %d", &tdm->v4_buckets))
+	;
+      else if (unformat (input, "v6-buckets %d", &tdm->v6_buckets))
+	;
+      else if (unformat (input, "v4-memory %U", unformat_memory_size, &tmp))
+	tdm->v4_memory_size = tmp;
+      else if (unformat (input, "v6-memory %U", unformat_memory_size, &tmp))
+	tdm->v6_memory_size = tmp;
+      else
+	return clib_error_return (0, "unknown input `%U'",
+				  format_unformat_error, input);
+    }
+
+  if (!tdm->v4_buckets || !tdm->v6_buckets)
+    return clib_error_return (0, "bucket count must be non zero");
+  return 0;
+}
+
+/*?
+ * Size the tables GENEVE, GTP-U and VXLAN-GPE decap use to find a
+ * packet's tunnel. Each user's table for an address family is only
+ * created with its first tunnel of that family.
+ *
+ * @cfgcmd{v4-buckets, &lt;number&gt;}
+ * @cfgcmd{v6-buckets, &lt;number&gt;}
+ * Number of hash buckets, 65536 by default.
+ *
+ * @cfgcmd{v4-memory, &lt;size&gt;}
+ * @cfgcmd{v6-memory, &lt;size&gt;}
+ * Memory reserved for the table's key/value pages, 64m by default.
+?*/
+VLIB_CONFIG_FUNCTION (udp_tunnel_demux_config, "udp-tunnel-demux");
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
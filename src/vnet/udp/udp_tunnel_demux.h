@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2018 Cisco and/or its affiliates.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UDP_TUNNEL_DEMUX_H__
+#define __UDP_TUNNEL_DEMUX_H__
+
+#include <vnet/ip/ip.h>
+#include <vppinfra/bihash_16_8.h>
+#include <vppinfra/bihash_24_8.h>
+
+/**
+ * UDP tunnel demux.
+ * Finds the tunnel a UDP encapsulated packet (GENEVE, GTP-U, VXLAN-GPE...)
+ * belongs to on decap. Tunnels are keyed on the remote address, the
+ * underlay FIB index and the tunnel id carried in the encap header
+ * (VNI, TEID). The id is opaque and used as is, users in tree key on it
+ * exactly as it appears on the wire.
+ * The local address is not part of the key, decap nodes validate it
+ * against the tunnel found.
+ * Each table is created when the first tunnel of its address family is
+ * added, sized from the udp-tunnel-demux startup config.
+ */
+typedef struct udp_tunnel_demux_t_
+{
+  clib_bihash_16_8_t tunnel4_by_key;
+  clib_bihash_24_8_t tunnel6_by_key;
+  u8 tunnel4_is_init;
+  u8 tunnel6_is_init;
+  char *name;
+} udp_tunnel_demux_t;
+
+typedef struct udp_tunnel_demux_main_t_
+{
+  /* Table sizes, shared by all users */
+  u32 v4_buckets;
+  uword v4_memory_size;
+  u32 v6_buckets;
+  uword v6_memory_size;
+} udp_tunnel_demux_main_t;
+
+extern udp_tunnel_demux_main_t udp_tunnel_demux_main;
+
+/**
+ * A lookup key; after a search the value holds the tunnel index, or ~0
+ */
+typedef union udp_tunnel_demux_key_t_
+{
+  clib_bihash_kv_16_8_t kv4;
+  clib_bihash_kv_24_8_t kv6;
+} udp_tunnel_demux_key_t;
+
+#define UDP_TUNNEL_DEMUX_DEFAULT_NUM_BUCKETS (64 * 1024)
+#define UDP_TUNNEL_DEMUX_DEFAULT_MEMORY_SIZE (64 << 20)
+
+extern void udp_tunnel_demux_init (udp_tunnel_demux_t * td, char *name);
+extern int udp_tunnel_demux_add_del (udp_tunnel_demux_t * td,
+				     const ip46_address_t * remote,
+				     u32 fib_index, u32 id, u8 is_ip6,
+				     u32 tunnel_index, int is_add);
+extern u32 udp_tunnel_demux_find (udp_tunnel_demux_t * td,
+				  const ip46_address_t * remote,
+				  u32 fib_index, u32 id, u8 is_ip6);
+extern u8 *format_udp_tunnel_demux (u8 * s, va_list * args);
+
+always_inline void
+udp_tunnel_demux_key4 (udp_tunnel_demux_key_t * k,
+		       const ip4_address_t * remote, u32 fib_index, u32 id)
+{
+  k->kv4.key[0] = remote->as_u32;
+  k->kv4.key[1] = ((u64) fib_index << 32) | id;
+}
+
+always_inline void
+udp_tunnel_demux_key6 (udp_tunnel_demux_key_t * k,
+		       const ip6_address_t * remote, u32 fib_index, u32 id)
+{
+  k->kv6.key[0] = remote->as_u64[0];
+  k->kv6.key[1] = remote->as_u64[1];
+  k->kv6.key[2] = ((u64) fib_index << 32) | id;
+}
+
+/**
+ * Look up a single key, returns the tunnel index or ~0
+ */
+always_inline u32
+udp_tunnel_demux_lookup (udp_tunnel_demux_t * td,
+			 udp_tunnel_demux_key_t * k, u8 is_ip4)
+{
+  if (is_ip4)
+    {
+      if (PREDICT_FALSE (!td->tunnel4_is_init)
+	  || clib_bihash_search_inline_16_8 (&td->tunnel4_by_key,
+					     &k->kv4) < 0)
+	return ~0;
+      return k->kv4.value;
+    }
+  if (PREDICT_FALSE (!td->tunnel6_is_init)
+      || clib_bihash_search_inline_24_8 (&td->tunnel6_by_key, &k->kv6) < 0)
+    return ~0;
+  return k->kv6.value;
+}
+
+/**
+ * Look up a frame's worth of keys.
+ * Keys go through three stages, four at a time: hash and prefetch the
+ * bucket, prefetch the bucket's key/value page, search. So up to twelve
+ * lookups are in flight and the table can be far larger than the cache.
+ */
+always_inline void
+udp_tunnel_demux_search (udp_tunnel_demux_t * td,
+			 udp_tunnel_demux_key_t * k, u32 n_keys, u8 is_ip4)
+{
+  clib_bihash_16_8_t *h4 = &td->tunnel4_by_key;
+  clib_bihash_24_8_t *h6 = &td->tunnel6_by_key;
+  u64 hash[VLIB_FRAME_SIZE];
+  u32 i, j;
+
+  ASSERT (n_keys <= VLIB_FRAME_SIZE);
+
+  /* No tunnel of this family yet, so no table to search */
+  if (PREDICT_FALSE (!(is_ip4 ? td->tunnel4_is_init : td->tunnel6_is_init)))
+    {
+      for (j = 0; j < n_keys; j++)
+	{
+	  if (is_ip4)
+	    k[j].kv4.value = ~0;
+	  else
+	    k[j].kv6.value = ~0;
+	}
+      return;
+    }
+
+  for (i = 0; i < n_keys + 8; i += 4)
+    {
+      /* stage 0: hash and prefetch the bucket */
+      for (j = i; j < clib_min (i + 4, n_keys); j++)
+	{
+	  if (is_ip4)
+	    {
+	      hash[j] = clib_bihash_hash_16_8 (&k[j].kv4);
+	      clib_bihash_prefetch_bucket_16_8 (h4, hash[j]);
+	    }
+	  else
+	    {
+	      hash[j] = clib_bihash_hash_24_8 (&k[j].kv6);
+	      clib_bihash_prefetch_bucket_24_8 (h6, hash[j]);
+	    }
+	}
+
+      /* stage 1: prefetch the page the key would be in */
+      for (j = i - 4; i >= 4 && j < clib_min (i, n_keys); j++)
+	{
+	  if (is_ip4)
+	    clib_bihash_prefetch_data_16_8 (h4, hash[j]);
+	  else
+	    clib_bihash_prefetch_data_24_8 (h6, hash[j]);
+	}
+
+      /* stage 2: search */
+      for (j = i - 8; i >= 8 && j < clib_min (i - 4, n_keys); j++)
+	{
+	  if (is_ip4)
+	    {
+	      if (clib_bihash_search_inline_with_hash_16_8
+		  (h4, hash[j], &k[j].kv4) < 0)
+		k[j].kv4.value = ~0;
+	    }
+	  else
+	    {
+	      if (clib_bihash_search_inline_with_hash_24_8
+		  (h6, hash[j], &k[j].kv6) < 0)
+		k[j].kv6.value = ~0;
+	    }
+	}
+    }
+}
+
+/**
+ * The tunnel index a search left in a key
+ */
+always_inline u32
+udp_tunnel_demux_result (udp_tunnel_demux_key_t * k, u8 is_ip4)
+{
+  return is_ip4 ? k->kv4.value : k->kv6.value;
+}
+
+#endif
+
+/*
+ * fd.io coding-style-patch-verification: ON
+ *
+ * Local Variables:
+ * eval: (c-set-style "gnu")
+ * End:
+ */
@@ -85,6 +85,101 @@ format_vxlan_gpe_with_length (u8 * s, va_list * args)
   return s;
 }
 
+always_inline u32
+vxlan_gpe_buffer_fib_index (vlib_buffer_t * b, u8 is_ip4)
+{
+  u32 sw_if_index = vnet_buffer (b)->sw_if_index[VLIB_RX];
+
+  if (vnet_buffer (b)->sw_if_index[VLIB_TX] != (u32) ~ 0)
+    return vnet_buffer (b)->sw_if_index[VLIB_TX];
+
+  return is_ip4 ?
+    vec_elt (ip4_main.fib_index_by_sw_if_index, sw_if_index) :
+    vec_elt (ip6_main.fib_index_by_sw_if_index, sw_if_index);
+}
+
+/**
+ * @brief Build the tunnel demux key of each packet in the frame
+ *
+ * Key fields: packet SIP, encap-fib and VNI as it is on the wire
+ */
+always_inline void
+vxlan_gpe_demux_keys (vlib_main_t * vm, u32 * from,
+		      udp_tunnel_demux_key_t * k, u32 n_left, u8 is_ip4)
+{
+  while (n_left > 0)
+    {
+      vlib_buffer_t *b0;
+      u8 *vxlan0;
+      u32 fib_index0;
+
+      if (n_left > 4)
+	{
+	  vlib_buffer_t *p4 = vlib_get_buffer (vm, from[4]);
+	  vlib_prefetch_buffer_header (p4, LOAD);
+	  CLIB_PREFETCH (p4->data, 2 * CLIB_CACHE_LINE_BYTES, LOAD);
+	}
+
+      b0 = vlib_get_buffer (vm, from[0]);
+      fib_index0 = vxlan_gpe_buffer_fib_index (b0, is_ip4);
+
+      /* udp leaves current_data pointing at the vxlan-gpe header */
+      vxlan0 = vlib_buffer_get_current (b0);
+      if (is_ip4)
+	{
+	  ip4_vxlan_gpe_header_t *iuvn4_0 =
+	    (void *) (vxlan0 - sizeof (udp_header_t) - sizeof (ip4_header_t));
+	  udp_tunnel_demux_key4 (k, &iuvn4_0->ip4.src_address, fib_index0,
+				 iuvn4_0->vxlan.vni_res);
+	}
+      else
+	{
+	  ip6_vxlan_gpe_header_t *iuvn6_0 =
+	    (void *) (vxlan0 - sizeof (udp_header_t) - sizeof (ip6_header_t));
+	  udp_tunnel_demux_key6 (k, &iuvn6_0->ip6.src_address, fib_index0,
+				 iuvn6_0->vxlan.vni_res);
+	}
+
+      from += 1;
+      k += 1;
+      n_left -= 1;
+    }
+}
+
+/**
+ * @brief Return the tunnel found by the demux search, or ~0
+ *
+ * The packet DIP must be the tunnel local address
+ */
+always_inline u32
+vxlan_gpe_find_tunnel (vxlan_gpe_main_t * ngm, udp_tunnel_demux_key_t * k,
+		       void *iuvn0, u8 is_ip4)
+{
+  u32 tunnel_index0 = udp_tunnel_demux_result (k, is_ip4);
+  vxlan_gpe_tunnel_t *t0;
+
+  if (PREDICT_FALSE (tunnel_index0 == ~0))
+    return ~0;
+  t0 = pool_elt_at_index (ngm->tunnels, tunnel_index0);
+
+  if (is_ip4)
+    {
+      ip4_vxlan_gpe_header_t *iuvn4_0 = iuvn0;
+      if (PREDICT_FALSE (iuvn4_0->ip4.dst_address.as_u32 !=
+			 t0->local.ip4.as_u32))
+	return ~0;
+    }
+  else
+    {
+      ip6_vxlan_gpe_header_t *iuvn6_0 = iuvn0;
+      if (PREDICT_FALSE (!ip6_address_is_equal (&iuvn6_0->ip6.dst_address,
+						&t0->local.ip6)))
+	return ~0;
+    }
+
+  return tunnel_index0;
+}
+
 /**
  * @brief Common processing for IPv4 and IPv6 VXLAN GPE decap dispatch functions
  *
@@ -113,21 +208,18 @@ vxlan_gpe_input (vlib_main_t * vm,
   vxlan_gpe_main_t *nngm = &vxlan_gpe_main;
   vnet_main_t *vnm = nngm->vnet_main;
   vnet_interface_main_t *im = &vnm->interface_main;
-  u32 last_tunnel_index = ~0;
-  vxlan4_gpe_tunnel_key_t last_key4;
-  vxlan6_gpe_tunnel_key_t last_key6;
+  udp_tunnel_demux_key_t keys[VLIB_FRAME_SIZE], *k = keys;
   u32 pkts_decapsulated = 0;
   u32 thread_index = vm->thread_index;
   u32 stats_sw_if_index, stats_n_packets, stats_n_bytes;
 
-  if (is_ip4)
-    memset (&last_key4, 0xff, sizeof (last_key4));
-  else
-    memset (&last_key6, 0xff, sizeof (last_key6));
-
   from = vlib_frame_vector_args (from_frame);
   n_left_from = from_frame->n_vectors;
 
+  /* Find the tunnels for the whole frame up front */
+  vxlan_gpe_demux_keys (vm, from, keys, n_left_from, is_ip4);
+  udp_tunnel_demux_search (&nngm->tunnel_demux, keys, n_left_from, is_ip4);
+
   next_index = node->cached_next_index;
   stats_sw_if_index = node->runtime_data[0];
   stats_n_packets = stats_n_bytes = 0;
@@ -145,11 +237,9 @@ vxlan_gpe_input (vlib_main_t * vm,
 	  u32 next0, next1;
 	  ip4_vxlan_gpe_header_t *iuvn4_0, *iuvn4_1;
 	  ip6_vxlan_gpe_header_t *iuvn6_0, *iuvn6_1;
-	  uword *p0, *p1;
+	  udp_tunnel_demux_key_t *k0, *k1;
 	  u32 tunnel_index0, tunnel_index1;
 	  vxlan_gpe_tunnel_t *t0, *t1;
-	  vxlan4_gpe_tunnel_key_t key4_0, key4_1;
-	  vxlan6_gpe_tunnel_key_t key6_0, key6_1;
 	  u32 error0, error1;
 	  u32 sw_if_index0, sw_if_index1, len0, len1;
 
@@ -169,9 +259,12 @@ vxlan_gpe_input (vlib_main_t * vm,
 
 	  bi0 = from[0];
 	  bi1 = from[1];
+	  k0 = &k[0];
+	  k1 = &k[1];
 	  to_next[0] = bi0;
 	  to_next[1] = bi1;
 	  from += 2;
+	  k += 2;
 	  to_next += 2;
 	  n_left_to_next -= 2;
 	  n_left_from -= 2;
@@ -214,8 +307,6 @@ vxlan_gpe_input (vlib_main_t * vm,
 	      vlib_buffer_advance (b1, sizeof (*iuvn6_1));
 	    }
 
-	  tunnel_index0 = ~0;
-	  tunnel_index1 = ~0;
 	  error0 = 0;
 	  error1 = 0;
 
@@ -229,62 +320,6 @@ vxlan_gpe_input (vlib_main_t * vm,
 		(iuvn4_1->vxlan.protocol < VXLAN_GPE_PROTOCOL_MAX) ?
 		nngm->decap_next_node_list[iuvn4_1->vxlan.protocol] :
 		VXLAN_GPE_INPUT_NEXT_DROP;
-
-	      key4_0.local = iuvn4_0->ip4.dst_address.as_u32;
-	      key4_1.local = iuvn4_1->ip4.dst_address.as_u32;
-
-	      key4_0.remote = iuvn4_0->ip4.src_address.as_u32;
-	      key4_1.remote = iuvn4_1->ip4.src_address.as_u32;
-
-	      key4_0.vni = iuvn4_0->vxlan.vni_res;
-	      key4_1.vni = iuvn4_1->vxlan.vni_res;
-
-	      key4_0.pad = 0;
-	      key4_1.pad = 0;
-	    }
-	  else			/* is_ip6 */
-	    {
-	      next0 = (iuvn6_0->vxlan.protocol < node->n_next_nodes) ?
-		iuvn6_0->vxlan.protocol : VXLAN_GPE_INPUT_NEXT_DROP;
-	      next1 = (iuvn6_1->vxlan.protocol < node->n_next_nodes) ?
-		iuvn6_1->vxlan.protocol : VXLAN_GPE_INPUT_NEXT_DROP;
-
-	      key6_0.local.as_u64[0] = iuvn6_0->ip6.dst_address.as_u64[0];
-	      key6_0.local.as_u64[1] = iuvn6_0->ip6.dst_address.as_u64[1];
-	      key6_1.local.as_u64[0] = iuvn6_1->ip6.dst_address.as_u64[0];
-	      key6_1.local.as_u64[1] = iuvn6_1->ip6.dst_address.as_u64[1];
-
-	      key6_0.remote.as_u64[0] = iuvn6_0->ip6.src_address.as_u64[0];
-	      key6_0.remote.as_u64[1] = iuvn6_0->ip6.src_address.as_u64[1];
-	      key6_1.remote.as_u64[0] = iuvn6_1->ip6.src_address.as_u64[0];
-	      key6_1.remote.as_u64[1] = iuvn6_1->ip6.src_address.as_u64[1];
-
-	      key6_0.vni = iuvn6_0->vxlan.vni_res;
-	      key6_1.vni = iuvn6_1->vxlan.vni_res;
-	    }
-
-	  /* Processing packet 0 */
-	  if (is_ip4)
-	    {
-	      /* Processing for key4_0 */
-	      if (PREDICT_FALSE ((key4_0.as_u64[0] != last_key4.as_u64[0])
-				 || (key4_0.as_u64[1] !=
-				     last_key4.as_u64[1])))
-		{
-		  p0 = hash_get_mem (nngm->vxlan4_gpe_tunnel_by_key, &key4_0);
-
-		  if (p0 == 0)
-		    {
-		      error0 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
-		      goto trace0;
-		    }
-
-		  last_key4.as_u64[0] = key4_0.as_u64[0];
-		  last_key4.as_u64[1] = key4_0.as_u64[1];
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
 	    }
 	  else			/* is_ip6 */
 	    {
@@ -296,37 +331,16 @@ vxlan_gpe_input (vlib_main_t * vm,
 		(iuvn6_1->vxlan.protocol < VXLAN_GPE_PROTOCOL_MAX) ?
 		nngm->decap_next_node_list[iuvn6_1->vxlan.protocol] :
 		VXLAN_GPE_INPUT_NEXT_DROP;
+	    }
 
-	      key6_0.local.as_u64[0] = iuvn6_0->ip6.dst_address.as_u64[0];
-	      key6_0.local.as_u64[1] = iuvn6_0->ip6.dst_address.as_u64[1];
-	      key6_1.local.as_u64[0] = iuvn6_1->ip6.dst_address.as_u64[0];
-	      key6_1.local.as_u64[1] = iuvn6_1->ip6.dst_address.as_u64[1];
-
-	      key6_0.remote.as_u64[0] = iuvn6_0->ip6.src_address.as_u64[0];
-	      key6_0.remote.as_u64[1] = iuvn6_0->ip6.src_address.as_u64[1];
-	      key6_1.remote.as_u64[0] = iuvn6_1->ip6.src_address.as_u64[0];
-	      key6_1.remote.as_u64[1] = iuvn6_1->ip6.src_address.as_u64[1];
-
-	      key6_0.vni = iuvn6_0->vxlan.vni_res;
-	      key6_1.vni = iuvn6_1->vxlan.vni_res;
-
-	      /* Processing for key6_0 */
-	      if (PREDICT_FALSE
-		  (memcmp (&key6_0, &last_key6, sizeof (last_key6)) != 0))
-		{
-		  p0 = hash_get_mem (nngm->vxlan6_gpe_tunnel_by_key, &key6_0);
-
-		  if (p0 == 0)
-		    {
-		      error0 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
-		      goto trace0;
-		    }
-
-		  memcpy (&last_key6, &key6_0, sizeof (key6_0));
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
+	  /* Processing packet 0 */
+	  tunnel_index0 = vxlan_gpe_find_tunnel (nngm, k0,
+						 is_ip4 ? (void *) iuvn4_0 :
+						 (void *) iuvn6_0, is_ip4);
+	  if (PREDICT_FALSE (tunnel_index0 == ~0))
+	    {
+	      error0 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
+	      goto trace0;
 	    }
 
 	  t0 = pool_elt_at_index (nngm->tunnels, tunnel_index0);
@@ -378,47 +392,13 @@ vxlan_gpe_input (vlib_main_t * vm,
 	    }
 
 	  /* Process packet 1 */
-	  if (is_ip4)
+	  tunnel_index1 = vxlan_gpe_find_tunnel (nngm, k1,
+						 is_ip4 ? (void *) iuvn4_1 :
+						 (void *) iuvn6_1, is_ip4);
+	  if (PREDICT_FALSE (tunnel_index1 == ~0))
 	    {
-	      /* Processing for key4_1 */
-	      if (PREDICT_FALSE ((key4_1.as_u64[0] != last_key4.as_u64[0])
-				 || (key4_1.as_u64[1] !=
-				     last_key4.as_u64[1])))
-		{
-		  p1 = hash_get_mem (nngm->vxlan4_gpe_tunnel_by_key, &key4_1);
-
-		  if (p1 == 0)
-		    {
-		      error1 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
-		      goto trace1;
-		    }
-
-		  last_key4.as_u64[0] = key4_1.as_u64[0];
-		  last_key4.as_u64[1] = key4_1.as_u64[1];
-		  tunnel_index1 = last_tunnel_index = p1[0];
-		}
-	      else
-		tunnel_index1 = last_tunnel_index;
-	    }
-	  else			/* is_ip6 */
-	    {
-	      /* Processing for key6_1 */
-	      if (PREDICT_FALSE
-		  (memcmp (&key6_1, &last_key6, sizeof (last_key6)) != 0))
-		{
-		  p1 = hash_get_mem (nngm->vxlan6_gpe_tunnel_by_key, &key6_1);
-
-		  if (p1 == 0)
-		    {
-		      error1 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
-		      goto trace1;
-		    }
-
-		  memcpy (&last_key6, &key6_1, sizeof (key6_1));
-		  tunnel_index1 = last_tunnel_index = p1[0];
-		}
-	      else
-		tunnel_index1 = last_tunnel_index;
+	      error1 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
+	      goto trace1;
 	    }
 
 	  t1 = pool_elt_at_index (nngm->tunnels, tunnel_index1);
@@ -483,17 +463,17 @@ vxlan_gpe_input (vlib_main_t * vm,
 	  u32 next0;
 	  ip4_vxlan_gpe_header_t *iuvn4_0;
 	  ip6_vxlan_gpe_header_t *iuvn6_0;
-	  uword *p0;
+	  udp_tunnel_demux_key_t *k0;
 	  u32 tunnel_index0;
 	  vxlan_gpe_tunnel_t *t0;
-	  vxlan4_gpe_tunnel_key_t key4_0;
-	  vxlan6_gpe_tunnel_key_t key6_0;
 	  u32 error0;
 	  u32 sw_if_index0, len0;
 
 	  bi0 = from[0];
+	  k0 = &k[0];
 	  to_next[0] = bi0;
 	  from += 1;
+	  k += 1;
 	  to_next += 1;
 	  n_left_from -= 1;
 	  n_left_to_next -= 1;
@@ -525,71 +505,26 @@ vxlan_gpe_input (vlib_main_t * vm,
 	      vlib_buffer_advance (b0, sizeof (*iuvn6_0));
 	    }
 
-	  tunnel_index0 = ~0;
 	  error0 = 0;
 
 	  if (is_ip4)
+	    next0 =
+	      (iuvn4_0->vxlan.protocol < VXLAN_GPE_PROTOCOL_MAX) ?
+	      nngm->decap_next_node_list[iuvn4_0->vxlan.protocol] :
+	      VXLAN_GPE_INPUT_NEXT_DROP;
+	  else
+	    next0 =
+	      (iuvn6_0->vxlan.protocol < VXLAN_GPE_PROTOCOL_MAX) ?
+	      nngm->decap_next_node_list[iuvn6_0->vxlan.protocol] :
+	      VXLAN_GPE_INPUT_NEXT_DROP;
+
+	  tunnel_index0 = vxlan_gpe_find_tunnel (nngm, k0,
+						 is_ip4 ? (void *) iuvn4_0 :
+						 (void *) iuvn6_0, is_ip4);
+	  if (PREDICT_FALSE (tunnel_index0 == ~0))
 	    {
-	      next0 =
-		(iuvn4_0->vxlan.protocol < VXLAN_GPE_PROTOCOL_MAX) ?
-		nngm->decap_next_node_list[iuvn4_0->vxlan.protocol] :
-		VXLAN_GPE_INPUT_NEXT_DROP;
-
-	      key4_0.local = iuvn4_0->ip4.dst_address.as_u32;
-	      key4_0.remote = iuvn4_0->ip4.src_address.as_u32;
-	      key4_0.vni = iuvn4_0->vxlan.vni_res;
-	      key4_0.pad = 0;
-
-	      /* Processing for key4_0 */
-	      if (PREDICT_FALSE ((key4_0.as_u64[0] != last_key4.as_u64[0])
-				 || (key4_0.as_u64[1] !=
-				     last_key4.as_u64[1])))
-		{
-		  p0 = hash_get_mem (nngm->vxlan4_gpe_tunnel_by_key, &key4_0);
-
-		  if (p0 == 0)
-		    {
-		      error0 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
-		      goto trace00;
-		    }
-
-		  last_key4.as_u64[0] = key4_0.as_u64[0];
-		  last_key4.as_u64[1] = key4_0.as_u64[1];
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
-	    }
-	  else			/* is_ip6 */
-	    {
-	      next0 =
-		(iuvn6_0->vxlan.protocol < VXLAN_GPE_PROTOCOL_MAX) ?
-		nngm->decap_next_node_list[iuvn6_0->vxlan.protocol] :
-		VXLAN_GPE_INPUT_NEXT_DROP;
-
-	      key6_0.local.as_u64[0] = iuvn6_0->ip6.dst_address.as_u64[0];
-	      key6_0.local.as_u64[1] = iuvn6_0->ip6.dst_address.as_u64[1];
-	      key6_0.remote.as_u64[0] = iuvn6_0->ip6.src_address.as_u64[0];
-	      key6_0.remote.as_u64[1] = iuvn6_0->ip6.src_address.as_u64[1];
-	      key6_0.vni = iuvn6_0->vxlan.vni_res;
-
-	      /* Processing for key6_0 */
-	      if (PREDICT_FALSE
-		  (memcmp (&key6_0, &last_key6, sizeof (last_key6)) != 0))
-		{
-		  p0 = hash_get_mem (nngm->vxlan6_gpe_tunnel_by_key, &key6_0);
-
-		  if (p0 == 0)
-		    {
-		      error0 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
-		      goto trace00;
-		    }
-
-		  memcpy (&last_key6, &key6_0, sizeof (key6_0));
-		  tunnel_index0 = last_tunnel_index = p0[0];
-		}
-	      else
-		tunnel_index0 = last_tunnel_index;
+	      error0 = VXLAN_GPE_ERROR_NO_SUCH_TUNNEL;
+	      goto trace00;
 	    }
 
 	  t0 = pool_elt_at_index (nngm->tunnels, tunnel_index0);
@@ -456,6 +456,40 @@ mcast_shared_remove (ip46_address_t * remote)
   hash_unset_mem_free (&vxlan_gpe_main.mcast_shared, remote);
 }
 
+/**
+ * @brief Find a VXLAN GPE tunnel by its endpoints and VNI, in any encap fib
+ *
+ * Control plane only: walks the tunnel pool
+ *
+ * @param *local
+ * @param *remote
+ * @param vni
+ * @param is_ip6
+ *
+ * @return tunnel index or ~0
+ *
+ */
+u32
+vxlan_gpe_tunnel_find (ip46_address_t * local, ip46_address_t * remote,
+		       u32 vni, u8 is_ip6)
+{
+  vxlan_gpe_main_t *ngm = &vxlan_gpe_main;
+  vxlan_gpe_tunnel_t *t;
+
+  /* *INDENT-OFF* */
+  pool_foreach (t, ngm->tunnels,
+  ({
+    if (t->vni == vni &&
+        ((t->flags & VXLAN_GPE_TUNNEL_IS_IPV4) == 0) == is_ip6 &&
+        ip46_address_is_equal (&t->local, local) &&
+        ip46_address_is_equal (&t->remote, remote))
+      return t - ngm->tunnels;
+  }));
+  /* *INDENT-ON* */
+
+  return ~0;
+}
+
 /**
  * @brief Add or Del a VXLAN GPE tunnel
  *
@@ -472,40 +506,22 @@ int vnet_vxlan_gpe_add_del_tunnel
   vxlan_gpe_tunnel_t *t = 0;
   vnet_main_t *vnm = ngm->vnet_main;
   vnet_hw_interface_t *hi;
-  uword *p;
   u32 hw_if_index = ~0;
   u32 sw_if_index = ~0;
   int rv;
-  vxlan4_gpe_tunnel_key_t key4, *key4_copy;
-  vxlan6_gpe_tunnel_key_t key6, *key6_copy;
+  u32 tunnel_index;
   u32 is_ip6 = a->is_ip6;
+  u32 vni = clib_host_to_net_u32 (a->vni << 8);
 
-  if (!is_ip6)
-    {
-      key4.local = a->local.ip4.as_u32;
-      key4.remote = a->remote.ip4.as_u32;
-      key4.vni = clib_host_to_net_u32 (a->vni << 8);
-      key4.pad = 0;
-
-      p = hash_get_mem (ngm->vxlan4_gpe_tunnel_by_key, &key4);
-    }
-  else
-    {
-      key6.local.as_u64[0] = a->local.ip6.as_u64[0];
-      key6.local.as_u64[1] = a->local.ip6.as_u64[1];
-      key6.remote.as_u64[0] = a->remote.ip6.as_u64[0];
-      key6.remote.as_u64[1] = a->remote.ip6.as_u64[1];
-      key6.vni = clib_host_to_net_u32 (a->vni << 8);
-
-      p = hash_get_mem (ngm->vxlan6_gpe_tunnel_by_key, &key6);
-    }
+  tunnel_index = udp_tunnel_demux_find (&ngm->tunnel_demux, &a->remote,
+					a->encap_fib_index, vni, is_ip6);
 
   if (a->is_add)
     {
       l2input_main_t *l2im = &l2input_main;
 
       /* adding a tunnel: tunnel must not already exist */
-      if (p)
+      if (tunnel_index != ~0)
 	return VNET_API_ERROR_TUNNEL_EXIST;
 
       pool_get_aligned (ngm->tunnels, t, CLIB_CACHE_LINE_BYTES);
@@ -540,19 +556,15 @@ int vnet_vxlan_gpe_add_del_tunnel
 	  return rv;
 	}
 
-      if (!is_ip6)
-	{
-	  key4_copy = clib_mem_alloc (sizeof (*key4_copy));
-	  clib_memcpy (key4_copy, &key4, sizeof (*key4_copy));
-	  hash_set_mem (ngm->vxlan4_gpe_tunnel_by_key, key4_copy,
-			t - ngm->tunnels);
-	}
-      else
+      /* No interface exists yet, so on failure only the pool entry and
+       * its rewrite need to be undone */
+      if (udp_tunnel_demux_add_del (&ngm->tunnel_demux, &t->remote,
+				    t->encap_fib_index, vni, is_ip6,
+				    t - ngm->tunnels, 1 /* is_add */ ))
 	{
-	  key6_copy = clib_mem_alloc (sizeof (*key6_copy));
-	  clib_memcpy (key6_copy, &key6, sizeof (*key6_copy));
-	  hash_set_mem (ngm->vxlan6_gpe_tunnel_by_key, key6_copy,
-			t - ngm->tunnels);
+	  vec_free (t->rewrite);
+	  pool_put (ngm->tunnels, t);
+	  return VNET_API_ERROR_INVALID_REGISTRATION;
 	}
 
       if (vec_len (ngm->free_vxlan_gpe_tunnel_hw_if_indices) > 0)
@@ -704,10 +716,10 @@ int vnet_vxlan_gpe_add_del_tunnel
   else
     {
       /* deleting a tunnel: tunnel must exist */
-      if (!p)
+      if (tunnel_index == ~0)
 	return VNET_API_ERROR_NO_SUCH_ENTRY;
 
-      t = pool_elt_at_index (ngm->tunnels, p[0]);
+      t = pool_elt_at_index (ngm->tunnels, tunnel_index);
 
       sw_if_index = t->sw_if_index;
       vnet_sw_interface_set_flags (vnm, t->sw_if_index, 0 /* down */ );
@@ -719,10 +731,9 @@ int vnet_vxlan_gpe_add_del_tunnel
 
       ngm->tunnel_index_by_sw_if_index[t->sw_if_index] = ~0;
 
-      if (!is_ip6)
-	hash_unset (ngm->vxlan4_gpe_tunnel_by_key, key4.as_u64);
-      else
-	hash_unset_mem_free (&ngm->vxlan6_gpe_tunnel_by_key, &key6);
+      udp_tunnel_demux_add_del (&ngm->tunnel_demux, &t->remote,
+				t->encap_fib_index, vni, is_ip6,
+				t - ngm->tunnels, 0 /* is_add */ );
 
       if (!ip46_address_is_multicast (&t->remote))
 	{
@@ -1241,11 +1252,7 @@ vxlan_gpe_init (vlib_main_t * vm)
   ngm->vnet_main = vnet_get_main ();
   ngm->vlib_main = vm;
 
-  ngm->vxlan4_gpe_tunnel_by_key
-    = hash_create_mem (0, sizeof (vxlan4_gpe_tunnel_key_t), sizeof (uword));
-
-  ngm->vxlan6_gpe_tunnel_by_key
-    = hash_create_mem (0, sizeof (vxlan6_gpe_tunnel_key_t), sizeof (uword));
+  udp_tunnel_demux_init (&ngm->tunnel_demux, "vxlan-gpe");
 
 
   ngm->mcast_shared = hash_create_mem (0,
@@ -32,6 +32,7 @@
 #include <vnet/ip/ip4_packet.h>
 #include <vnet/ip/ip6_packet.h>
 #include <vnet/udp/udp.h>
+#include <vnet/udp/udp_tunnel_demux.h>
 #include <vnet/dpo/dpo.h>
 #include <vnet/adj/adj_types.h>
 
@@ -61,41 +62,6 @@ typedef CLIB_PACKED (struct {
 }) ip6_vxlan_gpe_header_t;
 /* *INDENT-ON* */
 
-/**
- * @brief Key struct for IPv4 VXLAN GPE tunnel.
- * Key fields: local remote, vni
- * all fields in NET byte order
- * VNI shifted 8 bits
- */
-/* *INDENT-OFF* */
-typedef CLIB_PACKED(struct {
-  union {
-    struct {
-      u32 local;
-      u32 remote;
-
-      u32 vni;
-      u32 pad;
-    };
-    u64 as_u64[2];
-  };
-}) vxlan4_gpe_tunnel_key_t;
-/* *INDENT-ON* */
-
-/**
- * @brief Key struct for IPv6 VXLAN GPE tunnel.
- * Key fields: local remote, vni
- * all fields in NET byte order
- * VNI shifted 8 bits
- */
-/* *INDENT-OFF* */
-typedef CLIB_PACKED(struct {
-  ip6_address_t local;
-  ip6_address_t remote;
-  u32 vni;
-}) vxlan6_gpe_tunnel_key_t;
-/* *INDENT-ON* */
-
 /**
  * @brief Struct for VXLAN GPE tunnel
  */
@@ -198,10 +164,8 @@ typedef struct
   /** vector of encap tunnel instances */
   vxlan_gpe_tunnel_t *tunnels;
 
-  /** lookup IPv4 VXLAN GPE tunnel by key */
-  uword *vxlan4_gpe_tunnel_by_key;
-  /** lookup IPv6 VXLAN GPE tunnel by key */
-  uword *vxlan6_gpe_tunnel_by_key;
+  /** lookup VXLAN GPE tunnel by key: ip46.remote + encap fib + vni */
+  udp_tunnel_demux_t tunnel_demux;
 
   /* local VTEP IPs ref count used by vxlan-bypass node to check if
      received VXLAN packet DIP matches any local VTEP address */
@@ -248,6 +212,8 @@ typedef struct
 
 int vnet_vxlan_gpe_add_del_tunnel
   (vnet_vxlan_gpe_add_del_tunnel_args_t * a, u32 * sw_if_indexp);
+u32 vxlan_gpe_tunnel_find (ip46_address_t * local, ip46_address_t * remote,
+			   u32 vni, u8 is_ip6);
 
 
 int vxlan4_gpe_rewrite (vxlan_gpe_tunnel_t * t, u32 extension_size,
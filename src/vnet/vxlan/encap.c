@@ -26,11 +26,13 @@
 #define foreach_vxlan_encap_error    \
 _(ENCAPSULATED, "good packets encapsulated")
 
+#ifndef CLIB_MARCH_VARIANT
 static char * vxlan_encap_error_strings[] = {
 #define _(sym,string) string,
   foreach_vxlan_encap_error
 #undef _
 };
+#endif
 
 typedef enum {
 #define _(sym,str) VXLAN_ENCAP_ERROR_##sym,
@@ -49,6 +51,7 @@ typedef struct {
   u32 vni;
 } vxlan_encap_trace_t;
 
+#ifndef CLIB_MARCH_VARIANT
 u8 * format_vxlan_encap_trace (u8 * s, va_list * args)
 {
   CLIB_UNUSED (vlib_main_t * vm) = va_arg (*args, vlib_main_t *);
@@ -60,6 +63,7 @@ u8 * format_vxlan_encap_trace (u8 * s, va_list * args)
 	      t->tunnel_index, t->vni);
   return s;
 }
+#endif
 
 always_inline uword
 vxlan_encap_inline (vlib_main_t * vm,
@@ -452,10 +456,9 @@ vxlan_encap_inline (vlib_main_t * vm,
   return from_frame->n_vectors;
 }
 
-static uword
-vxlan4_encap (vlib_main_t * vm,
-	      vlib_node_runtime_t * node,
-	      vlib_frame_t * from_frame)
+VLIB_NODE_FN (vxlan4_encap_node) (vlib_main_t * vm,
+				  vlib_node_runtime_t * node,
+				  vlib_frame_t * from_frame)
 {
   /* Disable chksum offload as setup overhead in tx node is not worthwhile
      for ip4 header checksum only, unless udp checksum is also required */
@@ -463,18 +466,17 @@ vxlan4_encap (vlib_main_t * vm,
 			     /* csum_offload */ 0);
 }
 
-static uword
-vxlan6_encap (vlib_main_t * vm,
-	      vlib_node_runtime_t * node,
-	      vlib_frame_t * from_frame)
+VLIB_NODE_FN (vxlan6_encap_node) (vlib_main_t * vm,
+				  vlib_node_runtime_t * node,
+				  vlib_frame_t * from_frame)
 {
   /* Enable checksum offload for ip6 as udp checksum is mandatory, */
   return vxlan_encap_inline (vm, node, from_frame, /* is_ip4 */ 0, 
 			     /* csum_offload */ 1);
 }
 
+#ifndef CLIB_MARCH_VARIANT
 VLIB_REGISTER_NODE (vxlan4_encap_node) = {
-  .function = vxlan4_encap,
   .name = "vxlan4-encap",
   .vector_size = sizeof (u32),
   .format_trace = format_vxlan_encap_trace,
@@ -487,10 +489,7 @@ VLIB_REGISTER_NODE (vxlan4_encap_node) = {
   },
 };
 
-VLIB_NODE_FUNCTION_MULTIARCH (vxlan4_encap_node, vxlan4_encap)
-
 VLIB_REGISTER_NODE (vxlan6_encap_node) = {
-  .function = vxlan6_encap,
   .name = "vxlan6-encap",
   .vector_size = sizeof (u32),
   .format_trace = format_vxlan_encap_trace,
@@ -502,6 +501,5 @@ VLIB_REGISTER_NODE (vxlan6_encap_node) = {
         [VXLAN_ENCAP_NEXT_DROP] = "error-drop",
   },
 };
-
-VLIB_NODE_FUNCTION_MULTIARCH (vxlan6_encap_node, vxlan6_encap)
+#endif
 
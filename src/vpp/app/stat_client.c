@@ -137,6 +137,54 @@ maybe_update_cached_pointers (stat_client_main_t * sm,
   sm->current_epoch = (u64) shared_header->opaque[STAT_SEGMENT_OPAQUE_EPOCH];
 }
 
+/* Print the records added to the sampling tracer rings since the last
+   call. Called with the stats segment lock held. */
+static void
+dump_trace_samples (stat_client_main_t * sm,
+		    ssvm_shared_header_t * shared_header)
+{
+  uword *p, *counter_vector_by_name;
+  stat_segment_directory_entry_t *ep;
+  vlib_trace_sample_ring_t *r;
+  vlib_trace_sample_record_t *records = 0, *rec;
+  u8 *name = 0;
+  u64 n_lost;
+  int i;
+
+  counter_vector_by_name = (uword *)
+    shared_header->opaque[STAT_SEGMENT_OPAQUE_DIR];
+
+  for (i = 0;; i++)
+    {
+      vec_reset_length (name);
+      name = format (name, "/trace/sample/%d%c", i, 0);
+      p = hash_get_mem (counter_vector_by_name, name);
+      if (p == 0)
+	break;
+      ep = (stat_segment_directory_entry_t *) (p[0]);
+      ASSERT (ep->type == STAT_DIR_TYPE_TRACE_SAMPLE_RING);
+      r = ep->value;
+
+      vec_validate (sm->trace_sample_next, i);
+      vec_reset_length (records);
+      n_lost = vlib_trace_sample_ring_read (r, &sm->trace_sample_next[i],
+					    &records);
+      if (n_lost)
+	fformat (stdout, "thread %d: %lld sample records lost\n", i, n_lost);
+
+      vec_foreach (rec, records)
+	fformat (stdout, "thread %d: %.6f sample 0x%08x node %d "
+		 "buffer 0x%x data %d length %d flags 0x%x opaque 0x%x\n",
+		 i, (f64) (i64) (rec->time - r->init_cpu_time) *
+		 r->seconds_per_clock, rec->sample_id, rec->node_index,
+		 rec->buffer_index, rec->current_data, rec->current_length,
+		 rec->buffer_flags, rec->opaque0);
+    }
+
+  vec_free (records);
+  vec_free (name);
+}
+
 static void
 stat_poll_loop (stat_client_main_t * sm)
 {
@@ -204,6 +252,9 @@ stat_poll_loop (stat_client_main_t * sm)
       source_address_match_errors =
 	sm->thread_0_error_counts[sm->source_address_match_error_index];
 
+      if (sm->dump_trace_samples)
+	dump_trace_samples (sm, shared_header);
+
       /* Drop the lock */
       clib_spinlock_unlock (sm->stat_segment_lockp);
 
@@ -348,9 +399,12 @@ main (int argc, char **argv)
     {
       if (unformat (a, "socket-name %s", &stat_segment_name))
 	;
+      else if (unformat (a, "trace-samples"))
+	sm->dump_trace_samples = 1;
       else
 	{
-	  fformat (stderr, "%s: usage [socket-name <name>]\n", argv[0]);
+	  fformat (stderr, "%s: usage [socket-name <name>] [trace-samples]\n",
+		   argv[0]);
 	  exit (1);
 	}
     }
@@ -50,6 +50,10 @@ typedef struct
   clib_spinlock_t *stat_segment_lockp;
 
   u8 *socket_name;
+
+  /* Dump the sampling tracer rings, next record to read by thread */
+  int dump_trace_samples;
+  u64 *trace_sample_next;
 } stat_client_main_t;
 
 extern stat_client_main_t stat_client_main;
@@ -186,6 +186,53 @@ vlib_stats_pop_heap2 (u64 * counter_vector, u32 thread_index, void *oldheap)
   ssvm_pop_heap (oldheap);
 }
 
+void
+vlib_stats_register_trace_sample_ring (void *ring, u32 thread_index,
+				       void *oldheap)
+{
+  stats_main_t *sm = &stats_main;
+  ssvm_private_t *ssvmp = &sm->stat_segment;
+  ssvm_shared_header_t *shared_header;
+  stat_segment_directory_entry_t *ep;
+  hash_pair_t *hp;
+  u8 *ring_name;
+  u8 *name_copy;
+
+  ASSERT (ssvmp && ssvmp->sh);
+
+  shared_header = ssvmp->sh;
+
+  clib_spinlock_lock (sm->stat_segment_lockp);
+
+  ring_name = format (0, "/trace/sample/%d%c", thread_index, 0);
+
+  /* Update hash table. The name must be copied into the segment */
+  hp = hash_get_pair (sm->counter_vector_by_name, ring_name);
+  if (hp)
+    {
+      name_copy = (u8 *) hp->key;
+      ep = (stat_segment_directory_entry_t *) (hp->value[0]);
+      hash_unset_mem (sm->counter_vector_by_name, ring_name);
+      vec_free (name_copy);
+      clib_mem_free (ep);
+    }
+
+  ep = clib_mem_alloc (sizeof (*ep));
+  ep->type = STAT_DIR_TYPE_TRACE_SAMPLE_RING;
+  ep->value = ring;
+
+  hash_set_mem (sm->counter_vector_by_name, ring_name, ep);
+
+  /* Reset the client hash table pointer, since it WILL change! */
+  shared_header->opaque[STAT_SEGMENT_OPAQUE_DIR] = sm->counter_vector_by_name;
+
+  /* Warn clients to refresh any pointers they might be holding */
+  shared_header->opaque[STAT_SEGMENT_OPAQUE_EPOCH] = (void *)
+    ((u64) shared_header->opaque[STAT_SEGMENT_OPAQUE_EPOCH] + 1);
+  clib_spinlock_unlock (sm->stat_segment_lockp);
+  ssvm_pop_heap (oldheap);
+}
+
 clib_error_t *
 vlib_map_stat_segment_init (void)
 {
@@ -317,6 +364,10 @@ format_stat_dir_entry (u8 * s, va_list * args)
       type_name = "SerNodesPtr";
       break;
 
+    case STAT_DIR_TYPE_TRACE_SAMPLE_RING:
+      type_name = "SampleRing";
+      break;
+
     case STAT_DIR_TYPE_ERROR_INDEX:
       type_name = "ErrIndex";
       format_string = "%-10s %20lld";
@@ -212,6 +212,7 @@ typedef enum
   STAT_DIR_TYPE_COUNTER_VECTOR,
   STAT_DIR_TYPE_ERROR_INDEX,
   STAT_DIR_TYPE_SERIALIZED_NODES,
+  STAT_DIR_TYPE_TRACE_SAMPLE_RING,
 } stat_directory_type_t;
 
 typedef struct
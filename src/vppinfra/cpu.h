@@ -61,6 +61,15 @@
 
 #define CLIB_MARCH_SFX CLIB_MULTIARCH_FN
 
+/* Name of the variant being compiled, "default" for the baseline one */
+#ifdef CLIB_MARCH_VARIANT
+#define __CLIB_MARCH_VARIANT_STR(a) #a
+#define _CLIB_MARCH_VARIANT_STR(a) __CLIB_MARCH_VARIANT_STR(a)
+#define CLIB_MARCH_VARIANT_STR _CLIB_MARCH_VARIANT_STR(CLIB_MARCH_VARIANT)
+#else
+#define CLIB_MARCH_VARIANT_STR "default"
+#endif
+
 #define foreach_x86_64_flags \
 _ (sse3,     1, ecx, 0)   \
 _ (ssse3,    1, ecx, 9)   \
@@ -69,6 +78,10 @@ _ (sse42,    1, ecx, 20)  \
 _ (avx,      1, ecx, 28)  \
 _ (avx2,     7, ebx, 5)   \
 _ (avx512f,  7, ebx, 16)  \
+_ (avx512dq, 7, ebx, 17)  \
+_ (avx512cd, 7, ebx, 28)  \
+_ (avx512bw, 7, ebx, 30)  \
+_ (avx512vl, 7, ebx, 31)  \
 _ (x86_aes,  1, ecx, 25)  \
 _ (sha,      7, ebx, 29)  \
 _ (invariant_tsc, 0x80000007, edx, 8)
@@ -167,10 +180,14 @@ clib_cpu_supports_aes ()
 #endif
 }
 
+/* The avx512 variant is built for skylake-avx512, which also uses the
+   cd, bw, dq and vl extensions */
 static inline int
 clib_cpu_march_priority_avx512 ()
 {
-  if (clib_cpu_supports_avx512f ())
+  if (clib_cpu_supports_avx512f () && clib_cpu_supports_avx512cd () &&
+      clib_cpu_supports_avx512bw () && clib_cpu_supports_avx512dq () &&
+      clib_cpu_supports_avx512vl ())
     return 20;
   return -1;
 }
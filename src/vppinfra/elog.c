@@ -42,6 +42,14 @@
 #include <vppinfra/hash.h>
 #include <vppinfra/math.h>
 
+#ifdef CLIB_UNIX
+#include <vppinfra/unix.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 static inline void
 elog_lock (elog_main_t * em)
 {
@@ -460,6 +468,28 @@ elog_alloc (elog_main_t * em, u32 n_events)
   /* Leave an empty ievent at end so we can always speculatively write
      and event there (possibly a long form event). */
   vec_resize_aligned (em->event_ring, n_events, CLIB_CACHE_LINE_BYTES);
+
+  /* Thread rings are the same size as the shared ring. */
+  if (em->thread_rings)
+    elog_alloc_thread_rings (em, vec_len (em->thread_rings));
+}
+
+void
+elog_alloc_thread_rings (elog_main_t * em, u32 n_threads)
+{
+  elog_thread_ring_t *r;
+
+  vec_foreach (r, em->thread_rings) vec_free (r->event_ring);
+  vec_free (em->thread_rings);
+
+  if (n_threads == 0)
+    return;
+
+  vec_validate_aligned (em->thread_rings, n_threads - 1,
+			CLIB_CACHE_LINE_BYTES);
+  vec_foreach (r, em->thread_rings)
+    vec_resize_aligned (r->event_ring, em->event_ring_size,
+			CLIB_CACHE_LINE_BYTES);
 }
 
 void
@@ -505,30 +535,56 @@ elog_event_range (elog_main_t * em, uword * lo)
     }
 }
 
-elog_event_t *
-elog_peek_events (elog_main_t * em)
+static int elog_cmp (void *a1, void *a2);
+
+/* Copy events [lo, hi) of a ring, converting their time stamps. */
+static elog_event_t *
+elog_copy_events (elog_main_t * em, elog_event_t * es,
+		  elog_event_t * ring, u32 lo, u32 hi)
 {
-  elog_event_t *e, *f, *es = 0;
-  uword i, j, n;
+  elog_event_t *e;
+  u32 i;
 
-  n = elog_event_range (em, &j);
-  for (i = 0; i < n; i++)
+  for (i = lo; i != hi; i++)
     {
       vec_add2 (es, e, 1);
-      f = vec_elt_at_index (em->event_ring, j);
-      e[0] = f[0];
+      e[0] = ring[i & (em->event_ring_size - 1)];
 
       /* Convert absolute time from cycles to seconds from start. */
       e->time =
 	(e->time_cycles -
 	 em->init_time.cpu) * em->cpu_timer.seconds_per_clock;
-
-      j = (j + 1) & (em->event_ring_size - 1);
     }
 
   return es;
 }
 
+elog_event_t *
+elog_peek_events (elog_main_t * em)
+{
+  elog_event_t *es = 0;
+  elog_thread_ring_t *r;
+  uword j, n;
+
+  n = elog_event_range (em, &j);
+  es = elog_copy_events (em, es, em->event_ring, j, j + n);
+
+  if (vec_len (em->thread_rings) == 0)
+    return es;
+
+  vec_foreach (r, em->thread_rings)
+  {
+    u32 hi = r->n_total_events;
+    u32 lo = hi > em->event_ring_size ? hi - em->event_ring_size : 0;
+    es = elog_copy_events (em, es, r->event_ring, lo, hi);
+  }
+
+  /* Interleave the threads' events. */
+  vec_sort_with_function (es, elog_cmp);
+
+  return es;
+}
+
 /* Add a formatted string to the string table. */
 u32
 elog_string (elog_main_t * em, char *fmt, ...)
@@ -1104,6 +1160,399 @@ unserialize_elog_main (serialize_main_t * m, va_list * va)
   }
 }
 
+#ifdef CLIB_UNIX
+
+static char *elog_stream_magic = "elog stream v0";
+
+/* Rings of an event log: the shared ring first, then the thread rings. */
+always_inline uword
+elog_stream_n_rings (elog_main_t * em)
+{
+  return 1 + vec_len (em->thread_rings);
+}
+
+always_inline elog_event_t *
+elog_stream_ring (elog_main_t * em, uword i, u32 * n_total_events)
+{
+  if (i == 0)
+    {
+      *n_total_events = *(volatile u32 *) &em->n_total_events;
+      return em->event_ring;
+    }
+
+  *n_total_events =
+    *(volatile u32 *) &em->thread_rings[i - 1].n_total_events;
+  return em->thread_rings[i - 1].event_ring;
+}
+
+/* Write a chunk, preceded by its length. */
+static clib_error_t *
+elog_stream_write_chunk (elog_stream_t * es, u8 * chunk)
+{
+  u32 n_bytes = vec_len (chunk);
+  u8 *data = (u8 *) & n_bytes;
+  uword n_left = sizeof (n_bytes);
+  int is_length = 1;
+
+  while (1)
+    {
+      word n = write (es->fd, data, n_left);
+
+      if (n < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  return clib_error_return_unix (0, "write");
+	}
+
+      data += n;
+      n_left -= n;
+      if (n_left > 0)
+	continue;
+
+      if (!is_length)
+	break;
+
+      is_length = 0;
+      data = chunk;
+      n_left = n_bytes;
+    }
+
+  return 0;
+}
+
+static void
+serialize_elog_stream_header (serialize_main_t * m, va_list * va)
+{
+  elog_main_t *em = va_arg (*va, elog_main_t *);
+
+  serialize_magic (m, elog_stream_magic, strlen (elog_stream_magic));
+  serialize_integer (m, em->event_ring_size, sizeof (u32));
+  serialize (m, serialize_elog_time_stamp, &em->init_time);
+}
+
+static void
+unserialize_elog_stream_header (serialize_main_t * m, va_list * va)
+{
+  elog_main_t *em = va_arg (*va, elog_main_t *);
+  u32 rs;
+
+  unserialize_check_magic (m, elog_stream_magic, strlen (elog_stream_magic));
+
+  unserialize_integer (m, &rs, sizeof (u32));
+  elog_init (em, rs);
+
+  /* The default track comes with the first chunk. */
+  vec_reset_length (em->tracks);
+
+  unserialize (m, unserialize_elog_time_stamp, &em->init_time);
+  em->serialize_time = em->init_time;
+}
+
+clib_error_t *
+elog_stream_open (elog_main_t * em, elog_stream_t * es, char *clib_file)
+{
+  serialize_main_t m;
+  clib_error_t *error;
+  uword i, n_rings;
+  u32 n;
+  u8 *chunk;
+
+  memset (es, 0, sizeof (es[0]));
+
+  es->fd = open (clib_file, O_CREAT | O_TRUNC | O_WRONLY, 0664);
+  if (es->fd < 0)
+    return clib_error_return_unix (0, "open `%s'", clib_file);
+
+  /* Start with the events still in the rings. */
+  n_rings = elog_stream_n_rings (em);
+  vec_validate (es->n_events_exported, n_rings - 1);
+  vec_validate (es->n_events_published, n_rings - 1);
+  for (i = 0; i < n_rings; i++)
+    {
+      elog_stream_ring (em, i, &n);
+      es->n_events_exported[i] =
+	n > em->event_ring_size ? n - em->event_ring_size : 0;
+      es->n_events_published[i] = n;
+    }
+
+  serialize_open_vector (&m, 0);
+  error = serialize (&m, serialize_elog_stream_header, em);
+  chunk = serialize_close_vector (&m);
+
+  if (!error)
+    error = elog_stream_write_chunk (es, chunk);
+  vec_free (chunk);
+
+  if (error)
+    {
+      close (es->fd);
+      es->fd = -1;
+    }
+
+  return error;
+}
+
+static void
+serialize_elog_stream_chunk (serialize_main_t * m, va_list * va)
+{
+  elog_main_t *em = va_arg (*va, elog_main_t *);
+  elog_stream_t *es = va_arg (*va, elog_stream_t *);
+  elog_event_t *events = va_arg (*va, elog_event_t *);
+  u64 n_events_lost = va_arg (*va, u64);
+  elog_time_stamp_t now;
+  elog_event_t *e;
+  u32 n;
+
+  elog_time_now (&now);
+  serialize (m, serialize_elog_time_stamp, &now);
+
+  /* Types, tracks and strings are only ever appended. */
+  n = vec_len (em->event_types) - es->n_event_types;
+  serialize_integer (m, es->n_event_types, sizeof (u32));
+  serialize_integer (m, n, sizeof (u32));
+  serialize (m, serialize_elog_event_type,
+	     em->event_types + es->n_event_types, n);
+  es->n_event_types += n;
+
+  n = vec_len (em->tracks) - es->n_tracks;
+  serialize_integer (m, es->n_tracks, sizeof (u32));
+  serialize_integer (m, n, sizeof (u32));
+  serialize (m, serialize_elog_track, em->tracks + es->n_tracks, n);
+  es->n_tracks += n;
+
+  n = vec_len (em->string_table) - es->n_string_table_bytes;
+  serialize_integer (m, es->n_string_table_bytes, sizeof (u32));
+  serialize_integer (m, n, sizeof (u32));
+  serialize (m, serialize_vec_8,
+	     em->string_table + es->n_string_table_bytes, n);
+  es->n_string_table_bytes += n;
+
+  serialize (m, serialize_64, n_events_lost);
+
+  serialize_integer (m, vec_len (events), sizeof (u32));
+  vec_foreach (e, events) serialize (m, serialize_elog_event, em, e);
+}
+
+static void
+unserialize_elog_stream_chunk (serialize_main_t * m, va_list * va)
+{
+  elog_main_t *em = va_arg (*va, elog_main_t *);
+  u64 *n_events_lost = va_arg (*va, u64 *);
+  elog_event_t *e;
+  u32 i, first, n;
+  u64 lost;
+
+  unserialize (m, unserialize_elog_time_stamp, &em->serialize_time);
+
+  unserialize_integer (m, &first, sizeof (u32));
+  unserialize_integer (m, &n, sizeof (u32));
+  if (first != vec_len (em->event_types))
+    serialize_error_return (m, "event types out of sequence");
+  vec_resize (em->event_types, n);
+  unserialize (m, unserialize_elog_event_type, em->event_types + first, n);
+  for (i = first; i < first + n; i++)
+    new_event_type (em, i);
+
+  unserialize_integer (m, &first, sizeof (u32));
+  unserialize_integer (m, &n, sizeof (u32));
+  if (first != vec_len (em->tracks))
+    serialize_error_return (m, "tracks out of sequence");
+  vec_resize (em->tracks, n);
+  unserialize (m, unserialize_elog_track, em->tracks + first, n);
+
+  unserialize_integer (m, &first, sizeof (u32));
+  unserialize_integer (m, &n, sizeof (u32));
+  if (first != vec_len (em->string_table))
+    serialize_error_return (m, "string table out of sequence");
+  vec_resize (em->string_table, n);
+  unserialize (m, unserialize_vec_8, em->string_table + first, n);
+
+  unserialize (m, unserialize_64, &lost);
+  *n_events_lost += lost;
+
+  unserialize_integer (m, &n, sizeof (u32));
+  for (i = 0; i < n; i++)
+    {
+      vec_add2 (em->events, e, 1);
+      unserialize (m, unserialize_elog_event, em, e);
+    }
+}
+
+static clib_error_t *
+elog_stream_flush_internal (elog_main_t * em, elog_stream_t * es,
+			    int is_final)
+{
+  serialize_main_t m;
+  clib_error_t *error;
+  elog_event_t *events = 0, *ring;
+  u64 n_events_lost = 0;
+  uword i, n_rings;
+  u32 lo, hi, n, n_after, l;
+  u8 *chunk;
+
+  if (es->fd < 0)
+    return 0;
+
+  /* Thread rings set up after the stream was opened start empty. */
+  n_rings = elog_stream_n_rings (em);
+  vec_validate (es->n_events_exported, n_rings - 1);
+  vec_validate (es->n_events_published, n_rings - 1);
+
+  for (i = 0; i < n_rings; i++)
+    {
+      ring = elog_stream_ring (em, i, &n);
+      lo = es->n_events_exported[i];
+      hi = is_final ? n : es->n_events_published[i];
+
+      /* The log was reset: start over. */
+      if ((i32) (n - lo) < 0 || (i32) (hi - lo) < 0)
+	{
+	  es->n_events_exported[i] = 0;
+	  es->n_events_published[i] = n;
+	  continue;
+	}
+
+      /* Skip the events which have already been overwritten. */
+      if (n - lo > em->event_ring_size)
+	{
+	  n_events_lost += n - em->event_ring_size - lo;
+	  lo = n - em->event_ring_size;
+	}
+
+      es->n_events_published[i] = n;
+      if ((i32) (hi - lo) <= 0)
+	{
+	  es->n_events_exported[i] = lo;
+	  continue;
+	}
+
+      l = vec_len (events);
+      events = elog_copy_events (em, events, ring, lo, hi);
+      es->n_events_exported[i] = hi;
+
+      /* Drop the events the thread overwrote while they were copied. */
+      CLIB_MEMORY_BARRIER ();
+      elog_stream_ring (em, i, &n_after);
+      if (n_after - lo > em->event_ring_size)
+	{
+	  u32 n_bad = clib_min (n_after - em->event_ring_size - lo, hi - lo);
+	  vec_delete (events, n_bad, l);
+	  n_events_lost += n_bad;
+	}
+    }
+
+  es->n_events_lost += n_events_lost;
+  es->n_events_written += vec_len (events);
+
+  if (vec_len (events) == 0 && n_events_lost == 0
+      && es->n_event_types == vec_len (em->event_types)
+      && es->n_tracks == vec_len (em->tracks)
+      && es->n_string_table_bytes == vec_len (em->string_table))
+    return 0;
+
+  /* Types and tracks are registered under the lock. */
+  elog_lock (em);
+  serialize_open_vector (&m, 0);
+  error = serialize (&m, serialize_elog_stream_chunk, em, es, events,
+		     n_events_lost);
+  chunk = serialize_close_vector (&m);
+  elog_unlock (em);
+
+  if (!error)
+    error = elog_stream_write_chunk (es, chunk);
+
+  vec_free (chunk);
+  vec_free (events);
+  return error;
+}
+
+clib_error_t *
+elog_stream_flush (elog_main_t * em, elog_stream_t * es)
+{
+  return elog_stream_flush_internal (em, es, /* is_final */ 0);
+}
+
+clib_error_t *
+elog_stream_close (elog_main_t * em, elog_stream_t * es)
+{
+  clib_error_t *error;
+
+  error = elog_stream_flush_internal (em, es, /* is_final */ 1);
+
+  if (es->fd >= 0)
+    close (es->fd);
+  es->fd = -1;
+  vec_free (es->n_events_exported);
+  vec_free (es->n_events_published);
+
+  return error;
+}
+
+clib_error_t *
+elog_read_stream_file (elog_main_t * em, char *clib_file)
+{
+  serialize_main_t m;
+  clib_error_t *error;
+  u8 *data = 0;
+  uword offset = 0;
+  u64 n_events_lost = 0;
+  u32 n_bytes;
+  int is_header = 1;
+  elog_event_t *e;
+
+  error = clib_file_contents (clib_file, &data);
+  if (error)
+    return error;
+
+  /* A chunk cut short by a crash ends the stream. */
+  while (offset + sizeof (n_bytes) <= vec_len (data))
+    {
+      n_bytes = clib_mem_unaligned (data + offset, u32);
+      offset += sizeof (n_bytes);
+      if (offset + n_bytes > vec_len (data))
+	break;
+
+      unserialize_open_data (&m, data + offset, n_bytes);
+      if (is_header)
+	error = unserialize (&m, unserialize_elog_stream_header, em);
+      else
+	error = unserialize (&m, unserialize_elog_stream_chunk, em,
+			     &n_events_lost);
+      if (error)
+	break;
+
+      offset += n_bytes;
+      is_header = 0;
+    }
+
+  vec_free (data);
+
+  if (!error && is_header)
+    error = clib_error_return (0, "%s: not an event log stream", clib_file);
+  if (error)
+    return error;
+
+  if (n_events_lost)
+    clib_warning ("%s: %Ld events lost", clib_file, n_events_lost);
+
+  if (em->serialize_time.cpu != em->init_time.cpu)
+    em->nsec_per_cpu_clock = elog_nsec_per_clock (em);
+
+  /* The threads' events come in per-thread batches. */
+  vec_sort_with_function (em->events, elog_cmp);
+
+  /* Recreate the event ring or the results won't serialize */
+  em->n_total_events = vec_len (em->events);
+  if (vec_len (em->events) > em->event_ring_size)
+    elog_alloc (em, vec_len (em->events));
+  vec_foreach (e, em->events) em->event_ring[e - em->events] = e[0];
+
+  return 0;
+}
+
+#endif /* CLIB_UNIX */
+
 /*
  * fd.io coding-style-patch-verification: ON
  *
@@ -42,6 +42,8 @@
     event logging at minimum cost. In typical operation, logging
     a single event costs around 80ns on x86_64. It's appropriate
     for at-least per-frame event-logging in vector packet processing.
+    Threads given their own event ring log without any lock or atomic
+    operation, and the log can be streamed to a file as it is filled.
 
     See https://wiki.fd.io/view/VPP/elog for more information.
 */
@@ -128,6 +130,18 @@ typedef struct
   u64 os_nsec;
 } elog_time_stamp_t;
 
+/** Event ring written by a single thread, without locking. */
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+
+  /** Total number of events logged by this thread. */
+  u32 n_total_events;
+
+  /** Circular buffer of events, event_ring_size long. */
+  elog_event_t *event_ring;
+} elog_thread_ring_t;
+
 typedef struct
 {
   /** Total number of events in buffer. */
@@ -171,6 +185,11 @@ typedef struct
   /** SMP lock, non-zero means locking required */
   uword *lock;
 
+  /** Per-thread event rings indexed by thread index.  When present,
+      each thread logs into its own ring and event_ring only takes the
+      events of threads without one. */
+  elog_thread_ring_t *thread_rings;
+
   /** Use serialize_time and init_time to give estimate for
       cpu clock frequency. */
   f64 nsec_per_cpu_clock;
@@ -187,7 +206,12 @@ typedef struct
 always_inline uword
 elog_n_events_in_buffer (elog_main_t * em)
 {
-  return clib_min (em->n_total_events, em->event_ring_size);
+  elog_thread_ring_t *r;
+  uword n = clib_min (em->n_total_events, em->event_ring_size);
+
+  vec_foreach (r, em->thread_rings)
+    n += clib_min (r->n_total_events, em->event_ring_size);
+  return n;
 }
 
 /** @brief Return number of events which can fit in the event buffer
@@ -197,7 +221,15 @@ elog_n_events_in_buffer (elog_main_t * em)
 always_inline uword
 elog_buffer_capacity (elog_main_t * em)
 {
-  return em->event_ring_size;
+  return em->event_ring_size * (1 + vec_len (em->thread_rings));
+}
+
+always_inline void
+elog_reset_thread_rings (elog_main_t * em)
+{
+  elog_thread_ring_t *r;
+
+  vec_foreach (r, em->thread_rings) r->n_total_events = 0;
 }
 
 /** @brief Reset the event buffer
@@ -208,6 +240,7 @@ elog_reset_buffer (elog_main_t * em)
 {
   em->n_total_events = 0;
   em->n_total_events_disable_limit = ~0;
+  elog_reset_thread_rings (em);
 }
 
 /** @brief Enable or disable event logging
@@ -218,6 +251,7 @@ elog_enable_disable (elog_main_t * em, int is_enabled)
 {
   em->n_total_events = 0;
   em->n_total_events_disable_limit = is_enabled ? ~0 : 0;
+  elog_reset_thread_rings (em);
 }
 
 /** @brief disable logging after specified number of ievents have been logged.
@@ -226,6 +260,9 @@ elog_enable_disable (elog_main_t * em, int is_enabled)
    Events will be logged both before and after the "event" but the
    event will not be lost as long as N < RING_SIZE.
 
+   Only the events logged into the shared ring count towards N:
+   events logged into per-thread rings are not counted.
+
    @param em elog_main_t *
    @param n uword number of events before disabling event logging
 */
@@ -292,7 +329,7 @@ elog_event_data_inline (elog_main_t * em,
 			elog_track_t * track, u64 cpu_time)
 {
   elog_event_t *e;
-  uword ei;
+  uword ei, thread_index;
   word type_index, track_index;
 
   /* Return the user dummy memory to scribble data into. */
@@ -312,13 +349,27 @@ elog_event_data_inline (elog_main_t * em,
   ASSERT (track_index < vec_len (em->tracks));
   ASSERT (is_pow2 (vec_len (em->event_ring)));
 
-  if (em->lock)
-    ei = clib_smp_atomic_add (&em->n_total_events, 1);
+  /* Threads without an index of their own read the main thread's, so
+     they log into the shared ring. */
+  thread_index = os_get_thread_index ();
+  if (PREDICT_TRUE (thread_index < vec_len (em->thread_rings)
+		    && os_thread_index_is_set ()))
+    {
+      elog_thread_ring_t *r = em->thread_rings + thread_index;
+
+      ei = r->n_total_events++ & (em->event_ring_size - 1);
+      e = r->event_ring + ei;
+    }
   else
-    ei = em->n_total_events++;
+    {
+      if (em->lock)
+	ei = clib_smp_atomic_add (&em->n_total_events, 1);
+      else
+	ei = em->n_total_events++;
 
-  ei &= em->event_ring_size - 1;
-  e = vec_elt_at_index (em->event_ring, ei);
+      ei &= em->event_ring_size - 1;
+      e = vec_elt_at_index (em->event_ring, ei);
+    }
 
   e->time_cycles = cpu_time;
   e->type = type_index;
@@ -523,6 +574,15 @@ void unserialize_elog_main (serialize_main_t * m, va_list * va);
 void elog_init (elog_main_t * em, u32 n_events);
 void elog_alloc (elog_main_t * em, u32 n_events);
 
+/** @brief give each of n_threads threads its own event ring
+    @param em elog_main_t *
+    @param n_threads u32 number of threads, 0 to go back to a shared ring
+    @note must be called before the threads start logging. Threads
+    which never set their index with os_set_thread_index log into the
+    shared ring.
+*/
+void elog_alloc_thread_rings (elog_main_t * em, u32 n_threads);
+
 #ifdef CLIB_UNIX
 always_inline clib_error_t *
 elog_write_file (elog_main_t * em, char *clib_file, int flush_ring)
@@ -554,6 +614,48 @@ elog_read_file (elog_main_t * em, char *clib_file)
   return error;
 }
 
+/** Continuous export of an event log to a file.
+
+    The file is a sequence of chunks, each one holding the event types,
+    tracks and strings added since the previous chunk and the events
+    logged since then.  Chunks are written while the threads keep
+    logging: each flush exports the events which were already in the
+    rings at the previous flush, so that they are complete.  Events
+    overwritten before they could be exported are counted as lost.
+*/
+typedef struct
+{
+  int fd;
+
+  /** Event types, tracks and string table bytes already exported. */
+  u32 n_event_types;
+  u32 n_tracks;
+  u32 n_string_table_bytes;
+
+  /** Per ring, shared ring first: events exported and events logged
+      as of the previous flush. */
+  u32 *n_events_exported;
+  u32 *n_events_published;
+
+  /** Events overwritten before they could be exported. */
+  u64 n_events_lost;
+
+  /** Number of events written to the file. */
+  u64 n_events_written;
+} elog_stream_t;
+
+clib_error_t *elog_stream_open (elog_main_t * em, elog_stream_t * es,
+				char *clib_file);
+clib_error_t *elog_stream_flush (elog_main_t * em, elog_stream_t * es);
+
+/** @brief write out all the events in the rings and close the stream */
+clib_error_t *elog_stream_close (elog_main_t * em, elog_stream_t * es);
+
+/** @brief read a file written by elog_stream_flush
+    @note a partially written last chunk is ignored
+*/
+clib_error_t *elog_read_stream_file (elog_main_t * em, char *clib_file);
+
 #endif /* CLIB_UNIX */
 
 #endif /* included_clib_elog_h */
@@ -46,6 +46,10 @@
 #define F_SEAL_WRITE    0x0008	/* prevent writes */
 #endif
 
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
 uword
 clib_mem_vm_get_page_size (int fd)
 {
@@ -120,18 +124,25 @@ clib_mem_vm_ext_alloc (clib_mem_vm_alloc_t * a)
 	{
 	  char *mount_dir;
 	  char template[] = "/tmp/hugepage_mount.XXXXXX";
+	  u8 *mount_opts = 0;
 
 	  mount_dir = mkdtemp (template);
 	  if (mount_dir == 0)
 	    return clib_error_return_unix (0, "mkdtemp \'%s\'", template);
 
-	  if (mount ("none", (char *) mount_dir, "hugetlbfs", 0, NULL))
+	  if (a->log2_page_size)
+	    mount_opts = format (0, "pagesize=%uK%c",
+				 1 << (a->log2_page_size - 10), 0);
+
+	  if (mount ("none", (char *) mount_dir, "hugetlbfs", 0, mount_opts))
 	    {
+	      vec_free (mount_opts);
 	      rmdir ((char *) mount_dir);
 	      err = clib_error_return_unix (0, "mount hugetlb directory '%s'",
 					    mount_dir);
 	      goto error;
 	    }
+	  vec_free (mount_opts);
 
 	  filename = format (0, "%s/%s%c", mount_dir, a->name, 0);
 
@@ -181,6 +192,11 @@ clib_mem_vm_ext_alloc (clib_mem_vm_alloc_t * a)
 	{
 	  mmap_flags |= MAP_HUGETLB;
 	  log2_page_size = 21;
+	  if (a->log2_page_size)
+	    {
+	      mmap_flags |= a->log2_page_size << MAP_HUGE_SHIFT;
+	      log2_page_size = a->log2_page_size;
+	    }
 	}
       else
 	{
@@ -345,7 +345,9 @@ typedef struct
   int numa_node; /**< numa node preference. Valid if CLIB_MEM_VM_F_NUMA_PREFER set. */
   void *addr; /**< Pointer to allocated memory, set on successful allocation. */
   int fd; /**< File descriptor, set on successful allocation if CLIB_MEM_VM_F_SHARED is set. */
-  int log2_page_size;		/* Page size in log2 format, set on successful allocation. */
+  int log2_page_size;		/* Page size in log2 format, set on successful allocation.
+				   If set by caller together with CLIB_MEM_VM_F_HUGETLB,
+				   hugepages of that size are requested. */
   int n_pages;			/* Number of pages. */
   uword requested_va;		/**< Request fixed position mapping */
 } clib_mem_vm_alloc_t;
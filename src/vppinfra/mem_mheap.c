@@ -92,6 +92,10 @@ clib_mem_init (void *memory, uword memory_size)
 
   clib_mem_set_heap (heap);
 
+  /* The thread setting up the heap is the main thread */
+  if (!os_thread_index_is_set ())
+    os_set_thread_index (0);
+
   return heap;
 }
 
@@ -49,6 +49,15 @@
 static void mheap_get_trace (void *v, uword offset, uword size);
 static void mheap_put_trace (void *v, uword offset, uword size);
 static int mheap_trace_sort (const void *t1, const void *t2);
+static void mheap_put_uncached (void *v, uword uoffset);
+
+/* Threads without an index of their own all read index 0, so they
+   cannot tell each other apart: they never own the lock recursively. */
+always_inline u32
+mheap_lock_owner (void)
+{
+  return os_thread_index_is_set ()? os_get_thread_index () : ~0;
+}
 
 always_inline void
 mheap_maybe_lock (void *v)
@@ -56,8 +65,8 @@ mheap_maybe_lock (void *v)
   mheap_t *h = mheap_header (v);
   if (v && (h->flags & MHEAP_FLAG_THREAD_SAFE))
     {
-      u32 my_cpu = os_get_thread_index ();
-      if (h->owner_cpu == my_cpu)
+      u32 my_cpu = mheap_lock_owner ();
+      if (my_cpu != ~0 && h->owner_cpu == my_cpu)
 	{
 	  h->recursion_count++;
 	  return;
@@ -77,7 +86,7 @@ mheap_maybe_unlock (void *v)
   mheap_t *h = mheap_header (v);
   if (v && h->flags & MHEAP_FLAG_THREAD_SAFE)
     {
-      ASSERT (os_get_thread_index () == h->owner_cpu);
+      ASSERT (mheap_lock_owner () == h->owner_cpu);
       if (--h->recursion_count == 0)
 	{
 	  h->owner_cpu = ~0;
@@ -639,6 +648,152 @@ mheap_get_extend_vector (void *v,
   return v;
 }
 
+/* Smallest thread cache size class whose objects are at least
+   n_user_data_bytes big. */
+always_inline uword
+mheap_thread_cache_alloc_class (uword n_user_data_bytes)
+{
+  uword l;
+
+  if (n_user_data_bytes <= 16)
+    return 0;
+
+  l = max_log2 (n_user_data_bytes);
+  if (n_user_data_bytes <= (3 << (l - 2)))
+    return 2 * (l - 5) + 1;
+  return 2 * (l - 4);
+}
+
+/* Largest thread cache size class an object with n_user_data_bytes
+   can serve. */
+always_inline uword
+mheap_thread_cache_free_class (uword n_user_data_bytes)
+{
+  uword l = min_log2 (n_user_data_bytes);
+
+  if (n_user_data_bytes >= (3 << (l - 1)))
+    return 2 * (l - 4) + 1;
+  return 2 * (l - 4);
+}
+
+always_inline uword
+mheap_thread_cache_class_bytes (uword class)
+{
+  return (class & 1) ? 24 << (class / 2) : 16 << (class / 2);
+}
+
+/* Tracing and validation see every get and put, so they bypass the
+   caches.  So do threads without an index of their own: they would
+   share the main thread's cache without its lock. */
+always_inline mheap_thread_cache_t *
+mheap_thread_cache_get_cache (mheap_t * h)
+{
+  uword thread_index;
+
+  if ((h->flags & (MHEAP_FLAG_THREAD_CACHE | MHEAP_FLAG_TRACE
+		   | MHEAP_FLAG_VALIDATE)) != MHEAP_FLAG_THREAD_CACHE)
+    return 0;
+
+  thread_index = os_get_thread_index ();
+  if (PREDICT_FALSE (thread_index >= CLIB_MAX_MHEAPS
+		     || !os_thread_index_is_set ()))
+    return 0;
+
+  return h->thread_caches + thread_index;
+}
+
+/* Give the n oldest objects of a class back to the heap. */
+static void
+mheap_thread_cache_flush_class (void *v, mheap_thread_cache_t * tc,
+				mheap_thread_cache_class_t * c, uword n)
+{
+  uword i;
+
+  mheap_maybe_lock (v);
+  for (i = 0; i < n; i++)
+    mheap_put_uncached (v, c->offsets[i]);
+  mheap_maybe_unlock (v);
+
+  c->n_objects -= n;
+  memmove (c->offsets, c->offsets + n, c->n_objects * sizeof (c->offsets[0]));
+  tc->n_flushed += n;
+}
+
+static uword
+mheap_thread_cache_get (void *v, uword n_user_data_bytes,
+			uword align, uword align_offset)
+{
+  mheap_thread_cache_t *tc;
+  mheap_thread_cache_class_t *c;
+  uword i, offset;
+
+  if (n_user_data_bytes > MHEAP_THREAD_CACHE_MAX_BYTES)
+    return MHEAP_GROUNDED;
+
+  tc = mheap_thread_cache_get_cache (mheap_header (v));
+  if (!tc)
+    return MHEAP_GROUNDED;
+
+  c = tc->classes + mheap_thread_cache_alloc_class (n_user_data_bytes);
+
+  /* Most recently freed first: it is the most likely to still be in
+     the cache. */
+  for (i = c->n_objects; i > 0; i--)
+    {
+      offset = c->offsets[i - 1];
+      if (((offset + align_offset) & (align - 1)) == 0)
+	{
+	  c->offsets[i - 1] = c->offsets[--c->n_objects];
+	  tc->n_hits += 1;
+	  return offset;
+	}
+    }
+
+  tc->n_misses += 1;
+  return MHEAP_GROUNDED;
+}
+
+static int
+mheap_thread_cache_put (void *v, uword uoffset)
+{
+  mheap_thread_cache_t *tc;
+  mheap_thread_cache_class_t *c;
+  mheap_elt_t *e;
+  uword n_user_data_bytes;
+
+  tc = mheap_thread_cache_get_cache (mheap_header (v));
+  if (!tc)
+    return 0;
+
+  e = mheap_elt_at_uoffset (v, uoffset);
+  n_user_data_bytes = mheap_elt_data_bytes (e);
+  if (n_user_data_bytes < 16
+      || n_user_data_bytes > MHEAP_THREAD_CACHE_MAX_BYTES)
+    return 0;
+
+  /* Object was already freed. */
+  if (e->is_free)
+    os_panic ();
+
+  c = tc->classes + mheap_thread_cache_free_class (n_user_data_bytes);
+
+  if (CLIB_DEBUG > 0)
+    {
+      uword i;
+      for (i = 0; i < c->n_objects; i++)
+	ASSERT (c->offsets[i] != uoffset);
+    }
+
+  if (PREDICT_FALSE (c->n_objects >= MHEAP_THREAD_CACHE_CLASS_SIZE))
+    mheap_thread_cache_flush_class (v, tc, c,
+				    MHEAP_THREAD_CACHE_CLASS_SIZE / 2);
+
+  c->offsets[c->n_objects++] = uoffset;
+  tc->n_puts += 1;
+
+  return 1;
+}
+
 void *
 mheap_get_aligned (void *v,
 		   uword n_user_data_bytes,
@@ -688,6 +843,14 @@ mheap_get_aligned (void *v,
   if (!v)
     v = mheap_alloc (0, 64 << 20);
 
+  /* Try this thread's cache before taking the lock. */
+  offset = mheap_thread_cache_get (v, n_user_data_bytes, align, align_offset);
+  if (offset != MHEAP_GROUNDED)
+    {
+      *offset_return = offset;
+      return v;
+    }
+
   mheap_maybe_lock (v);
 
   h = mheap_header (v);
@@ -769,6 +932,13 @@ free_last_elt (void *v, mheap_elt_t * e)
 
 void
 mheap_put (void *v, uword uoffset)
+{
+  if (!mheap_thread_cache_put (v, uoffset))
+    mheap_put_uncached (v, uoffset);
+}
+
+static void
+mheap_put_uncached (void *v, uword uoffset)
 {
   mheap_t *h;
   uword n_user_data_bytes, bin;
@@ -980,8 +1150,13 @@ _mheap_free (void *v)
   mheap_t *h = mheap_header (v);
 
   if (v)
-    clib_mem_vm_free ((void *) h - h->vm_alloc_offset_from_header,
-		      h->vm_alloc_size);
+    {
+      if (h->thread_caches)
+	clib_mem_vm_free (h->thread_caches,
+			  CLIB_MAX_MHEAPS * sizeof (h->thread_caches[0]));
+      clib_mem_vm_free ((void *) h - h->vm_alloc_offset_from_header,
+			h->vm_alloc_size);
+    }
 
   return 0;
 }
@@ -1131,6 +1306,33 @@ mheap_first_corrupt (void *v)
   return 0;
 }
 
+/* How much of the free space is out of reach of the biggest
+   allocation the heap could serve without growing. */
+static u8 *
+format_mheap_fragmentation (u8 * s, va_list * va)
+{
+  mheap_t *h = va_arg (*va, mheap_t *);
+  void *v = mheap_vector (h);
+  mheap_elt_t *e;
+  uword n_free = 0, free = 0, largest = 0;
+
+  if (vec_len (v) > 0)
+    for (e = v;
+	 e->n_user_data != MHEAP_N_USER_DATA_INVALID; e = mheap_next_elt (e))
+      if (e->is_free)
+	{
+	  uword size = mheap_elt_data_bytes (e);
+	  n_free += 1;
+	  free += size;
+	  largest = clib_max (largest, size);
+	}
+
+  return format (s, "free space: %wd objects, largest %U, "
+		 "fragmentation %.2f%%", n_free,
+		 format_mheap_byte_count, largest,
+		 free != 0 ? 100. * (f64) (free - largest) / (f64) free : 0.);
+}
+
 static u8 *
 format_mheap_stats (u8 * s, va_list * va)
 {
@@ -1171,6 +1373,44 @@ format_mheap_stats (u8 * s, va_list * va)
 	      format_white_space, indent,
 	      st->n_puts, (f64) st->n_clocks_put / (f64) st->n_puts);
 
+  s = format (s, "\n%U%U", format_white_space, indent,
+	      format_mheap_fragmentation, h);
+
+  if (h->thread_caches)
+    {
+      mheap_thread_cache_t *tc;
+      u64 n_hits = 0, n_misses = 0, n_puts = 0, n_flushed = 0;
+      uword i, j, n_cached = 0, n_bytes_cached = 0;
+
+      for (i = 0; i < CLIB_MAX_MHEAPS; i++)
+	{
+	  tc = h->thread_caches + i;
+	  n_hits += tc->n_hits;
+	  n_misses += tc->n_misses;
+	  n_puts += tc->n_puts;
+	  n_flushed += tc->n_flushed;
+	  for (j = 0; j < MHEAP_THREAD_CACHE_N_CLASSES; j++)
+	    {
+	      n_cached += tc->classes[j].n_objects;
+	      n_bytes_cached += tc->classes[j].n_objects
+		* mheap_thread_cache_class_bytes (j);
+	    }
+	}
+
+      s = format (s,
+		  "\n%Uthread caches %s: %Ld hits %Ld misses (%.2f%%), "
+		  "%Ld frees cached, %Ld flushed",
+		  format_white_space, indent,
+		  (h->flags & MHEAP_FLAG_THREAD_CACHE) ? "on" : "off",
+		  n_hits, n_misses,
+		  (n_hits + n_misses != 0 ?
+		   100. * (f64) n_hits / (f64) (n_hits + n_misses) : 0.),
+		  n_puts, n_flushed);
+      s = format (s, "\n%Ucached: %wd objects, %U bytes or more",
+		  format_white_space, indent, n_cached,
+		  format_mheap_byte_count, n_bytes_cached);
+    }
+
   return s;
 }
 
@@ -1633,6 +1873,44 @@ mheap_trace_main_free (mheap_trace_main_t * tm)
   hash_free (tm->trace_index_by_offset);
 }
 
+void
+mheap_thread_cache (void *v, int enable)
+{
+  mheap_t *h = mheap_header (v);
+  mheap_thread_cache_t *tc;
+  uword i, j;
+
+  mheap_maybe_lock (v);
+
+  if (enable)
+    {
+      if (!h->thread_caches)
+	h->thread_caches =
+	  clib_mem_vm_alloc (CLIB_MAX_MHEAPS * sizeof (h->thread_caches[0]));
+
+      /* Caches must be there before anyone sees the flag. */
+      CLIB_MEMORY_BARRIER ();
+
+      if (h->thread_caches)
+	h->flags |= MHEAP_FLAG_THREAD_CACHE;
+    }
+  else if (h->flags & MHEAP_FLAG_THREAD_CACHE)
+    {
+      h->flags &= ~MHEAP_FLAG_THREAD_CACHE;
+
+      for (i = 0; i < CLIB_MAX_MHEAPS; i++)
+	{
+	  tc = h->thread_caches + i;
+	  for (j = 0; j < MHEAP_THREAD_CACHE_N_CLASSES; j++)
+	    if (tc->classes[j].n_objects)
+	      mheap_thread_cache_flush_class (v, tc, tc->classes + j,
+					      tc->classes[j].n_objects);
+	}
+    }
+
+  mheap_maybe_unlock (v);
+}
+
 void
 mheap_trace (void *v, int enable)
 {
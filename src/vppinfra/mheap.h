@@ -80,6 +80,11 @@ void mheap_usage (void *v, clib_mem_usage_t * usage);
 /* Enable disable traceing. */
 void mheap_trace (void *v, int enable);
 
+/* Enable disable per-thread object caches.  Disabling returns all the
+   cached objects to the heap and must not race with other threads
+   using the heap. */
+void mheap_thread_cache (void *v, int enable);
+
 /* Test routine. */
 int test_mheap_main (unformat_input_t * input);
 
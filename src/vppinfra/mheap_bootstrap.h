@@ -45,6 +45,7 @@
 #include <vppinfra/error_bootstrap.h>
 #include <vppinfra/os.h>
 #include <vppinfra/vector.h>
+#include <vppinfra/cache.h>
 
 /* Each element in heap is immediately followed by this struct. */
 typedef struct
@@ -218,6 +219,41 @@ typedef struct
   u32 replacement_index;
 } mheap_small_object_cache_t;
 
+/* Per-thread caches of freed objects.
+
+   Objects freed by a thread with MHEAP_FLAG_THREAD_CACHE set are kept
+   in that thread's cache and handed back to its next allocation of the
+   same size class without taking the heap lock.  Cached objects are
+   still allocated as far as the heap is concerned.
+
+   Size class i holds objects with 16 * 2^(i/2) (i even) or
+   24 * 2^((i-1)/2) (i odd) bytes of user data or more: two classes per
+   power of two, from 16 bytes to 2k. */
+#define MHEAP_THREAD_CACHE_N_CLASSES 15
+#define MHEAP_THREAD_CACHE_MAX_BYTES 2048
+
+/* Objects per class and thread; half of them are given back to the
+   heap, under a single lock, when a class fills up. */
+#define MHEAP_THREAD_CACHE_CLASS_SIZE 32
+
+typedef struct
+{
+  u32 n_objects;
+  uword offsets[MHEAP_THREAD_CACHE_CLASS_SIZE];
+} mheap_thread_cache_class_t;
+
+typedef struct
+{
+  CLIB_CACHE_LINE_ALIGN_MARK (cacheline0);
+  mheap_thread_cache_class_t classes[MHEAP_THREAD_CACHE_N_CLASSES];
+
+  /* Allocations served by and missed in the cache. */
+  u64 n_hits, n_misses;
+
+  /* Frees kept in the cache and objects flushed back to the heap. */
+  u64 n_puts, n_flushed;
+} mheap_thread_cache_t;
+
 /* Vec header for heaps. */
 typedef struct
 {
@@ -240,6 +276,7 @@ typedef struct
 #define MHEAP_FLAG_THREAD_SAFE			(1 << 2)
 #define MHEAP_FLAG_SMALL_OBJECT_CACHE		(1 << 3)
 #define MHEAP_FLAG_VALIDATE			(1 << 4)
+#define MHEAP_FLAG_THREAD_CACHE			(1 << 5)
 
   /* Lock use when MHEAP_FLAG_THREAD_SAFE is set. */
   volatile u32 lock;
@@ -263,6 +300,10 @@ typedef struct
 
   mheap_trace_main_t trace_main;
 
+  /* Per-thread caches indexed by thread index, VM allocated when
+     MHEAP_FLAG_THREAD_CACHE is first set. */
+  mheap_thread_cache_t *thread_caches;
+
   mheap_stats_t stats;
 } mheap_t;
 
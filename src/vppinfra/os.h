@@ -57,6 +57,7 @@ void os_out_of_memory (void);
 f64 os_cpu_clock_frequency (void);
 
 extern __thread uword __os_thread_index;
+extern __thread u8 __os_thread_index_is_set;
 
 static_always_inline uword
 os_get_thread_index (void)
@@ -64,6 +65,22 @@ os_get_thread_index (void)
   return __os_thread_index;
 }
 
+/* Give the calling thread its index. A thread which never did, e.g. one
+   created by a library behind our back, still reads index 0, the main
+   thread's, so it must stay off per-thread state. */
+static_always_inline void
+os_set_thread_index (uword thread_index)
+{
+  __os_thread_index = thread_index;
+  __os_thread_index_is_set = 1;
+}
+
+static_always_inline uword
+os_thread_index_is_set (void)
+{
+  return __os_thread_index_is_set;
+}
+
 static_always_inline uword
 os_get_cpu_number (void) __attribute__ ((deprecated));
 
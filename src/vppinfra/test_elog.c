@@ -42,6 +42,124 @@
 #include <vppinfra/serialize.h>
 #include <vppinfra/unix.h>
 
+#ifdef CLIB_UNIX
+#include <pthread.h>
+
+typedef struct
+{
+  elog_main_t *em;
+  elog_track_t track;
+  uword thread_index;
+  u32 n_iter;
+} test_elog_thread_t;
+
+static void *
+test_elog_thread (void *arg)
+{
+  test_elog_thread_t *t = arg;
+  u32 i;
+
+  if (t->thread_index != ~0)
+    os_set_thread_index (t->thread_index);
+
+  for (i = 0; i < t->n_iter; i++)
+    {
+      ELOG_TYPE_DECLARE (e) =
+      {
+      .format = "thread %d event %d",.format_args = "i4i4",};
+      u32 *d = elog_data (t->em, &e, &t->track);
+      d[0] = t->thread_index;
+      d[1] = i;
+    }
+
+  return 0;
+}
+
+/* Threads log into their own rings while the log is streamed to a
+   file; every event must be either read back or counted as lost. */
+static clib_error_t *
+test_elog_threads (elog_main_t * em, u32 n_threads, u32 n_iter,
+		   u32 max_events, char *stream_file)
+{
+  test_elog_thread_t *threads = 0, *t;
+  pthread_t *tids = 0;
+  elog_main_t _rem, *rem = &_rem;
+  elog_stream_t _es, *es = &_es;
+  clib_error_t *error;
+  uword i, n_done;
+  f64 t0;
+
+  elog_init (em, max_events);
+  em->lock = clib_mem_alloc_aligned (CLIB_CACHE_LINE_BYTES,
+				     CLIB_CACHE_LINE_BYTES);
+  em->lock[0] = 0;
+  elog_alloc_thread_rings (em, n_threads + 1);
+  elog_enable_disable (em, 1);
+
+  if ((error = elog_stream_open (em, es, stream_file)))
+    return error;
+
+  vec_validate (threads, n_threads - 1);
+  vec_validate (tids, n_threads - 1);
+
+  t0 = unix_time_now ();
+  for (i = 0; i < n_threads; i++)
+    {
+      t = threads + i;
+      t->em = em;
+      t->track.name = (char *) format (0, "thread %d%c", i + 1, 0);
+      elog_track_register (em, &t->track);
+      /* Every other thread goes without an index, as a thread which
+	 vpp did not create would: these share the locked ring. */
+      t->thread_index = (i & 1) ? ~0 : i + 1;
+      t->n_iter = n_iter;
+      if (pthread_create (tids + i, NULL, test_elog_thread, t))
+	return clib_error_return_unix (0, "pthread_create");
+    }
+
+  /* Stream while the threads are logging. */
+  do
+    {
+      if ((error = elog_stream_flush (em, es)))
+	return error;
+      n_done = em->n_total_events;
+      for (i = 0; i < n_threads; i++)
+	n_done += em->thread_rings[i + 1].n_total_events;
+    }
+  while (n_done < n_threads * n_iter);
+
+  for (i = 0; i < n_threads; i++)
+    pthread_join (tids[i], NULL);
+
+  if ((error = elog_stream_close (em, es)))
+    return error;
+
+  fformat (stdout, "%d threads: %.2f events/second, %Ld streamed, "
+	   "%Ld lost\n", n_threads,
+	   (f64) n_threads * n_iter / (unix_time_now () - t0),
+	   es->n_events_written, es->n_events_lost);
+
+  memset (rem, 0, sizeof (rem[0]));
+  if ((error = elog_read_stream_file (rem, stream_file)))
+    return error;
+
+  if (vec_len (rem->events) != es->n_events_written
+      || es->n_events_written + es->n_events_lost != n_threads * n_iter)
+    return clib_error_return (0, "read %d events, expected %Ld",
+			      vec_len (rem->events), es->n_events_written);
+
+  for (i = 1; i < vec_len (rem->events); i++)
+    if (rem->events[i].time < rem->events[i - 1].time)
+      return clib_error_return (0, "events out of order");
+
+  vec_foreach (t, threads) vec_free (t->track.name);
+  vec_free (threads);
+  vec_free (tids);
+
+  return 0;
+}
+#endif /* CLIB_UNIX */
+
 int
 test_elog_main (unformat_input_t * input)
 {
@@ -54,6 +172,8 @@ test_elog_main (unformat_input_t * input)
   u8 *tag, **tags;
   f64 align_tweak;
   f64 *align_tweaks;
+  u32 n_threads = 0;
+  char *stream_file = 0;
 
   n_iter = 100;
   max_events = 100000;
@@ -88,6 +208,10 @@ test_elog_main (unformat_input_t * input)
 	;
       else if (unformat (input, "align-tweak %f", &align_tweak))
 	vec_add1 (align_tweaks, align_tweak);
+      else if (unformat (input, "threads %d", &n_threads))
+	;
+      else if (unformat (input, "stream %s", &stream_file))
+	;
       else
 	{
 	  error = clib_error_create ("unknown input `%U'\n",
@@ -97,6 +221,17 @@ test_elog_main (unformat_input_t * input)
     }
 
 #ifdef CLIB_UNIX
+  if (n_threads > 0)
+    {
+      if (!stream_file)
+	stream_file = (char *) format (0, "/tmp/test_elog_stream.%d%c",
+				       getpid (), 0);
+      error = test_elog_threads (em, n_threads, n_iter, max_events,
+				 stream_file);
+      unlink (stream_file);
+      goto done;
+    }
+
   if (load_file)
     {
       if ((error = elog_read_file (em, load_file)))
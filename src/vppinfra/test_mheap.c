@@ -50,6 +50,10 @@
 #include <vppinfra/random.h>
 #include <vppinfra/time.h>
 
+#ifdef CLIB_UNIX
+#include <pthread.h>
+#endif
+
 static int verbose = 0;
 #define if_verbose(format,args...) \
   if (verbose) { clib_warning(format, ## args); }
@@ -88,6 +92,122 @@ test1 (void)
   return 0;
 }
 
+#ifdef CLIB_UNIX
+typedef struct
+{
+  void *heap;
+  uword thread_index;
+  uword *objects;
+  u32 n_iterations;
+  u32 n_objects;
+  u32 max_object_size;
+  u32 seed;
+} test_mt_thread_t;
+
+/* Each thread keeps n_objects live and replaces a random one per
+   iteration, so gets and puts hit the shared heap at the same rate. */
+static void *
+test_mt_thread (void *arg)
+{
+  test_mt_thread_t *t = arg;
+  uword *objects = t->objects;
+  u32 i, j, seed = t->seed;
+
+  if (t->thread_index != ~0)
+    os_set_thread_index (t->thread_index);
+
+  for (i = 0; i < t->n_iterations; i++)
+    {
+      j = random_u32 (&seed) % t->n_objects;
+      if (objects[j] != ~0)
+	mheap_put (t->heap, objects[j]);
+      mheap_get_aligned (t->heap,
+			 1 + random_u32 (&seed) % t->max_object_size,
+			 0, 0, &objects[j]);
+      ASSERT (objects[j] != ~0);
+    }
+
+  for (j = 0; j < t->n_objects; j++)
+    if (objects[j] != ~0)
+      mheap_put (t->heap, objects[j]);
+
+  return 0;
+}
+
+int
+test_mt (u32 n_threads, u32 n_iterations, u32 n_objects,
+	 u32 max_object_size, u32 seed, int thread_cache)
+{
+  clib_time_t clib_time;
+  test_mt_thread_t *threads = 0, *t;
+  pthread_t *tids = 0;
+  uword size = 256 << 20;
+  void *h, *h_mem;
+  f64 before, after;
+  u32 i;
+
+  clib_time_init (&clib_time);
+
+  h_mem = clib_mem_alloc (size);
+  if (!h_mem)
+    return 1;
+
+  /* Thread-safe heap of fixed size: it must not move while in use. */
+  h = mheap_alloc_with_flags (h_mem, size,
+			      MHEAP_FLAG_DISABLE_VM | MHEAP_FLAG_THREAD_SAFE);
+  if (thread_cache)
+    mheap_thread_cache (h, 1);
+
+  vec_validate (threads, n_threads - 1);
+  vec_validate (tids, n_threads - 1);
+
+  before = clib_time_now (&clib_time);
+
+  for (i = 0; i < n_threads; i++)
+    {
+      t = threads + i;
+      t->heap = h;
+      /* Every other thread goes without an index, as a thread which
+	 vpp did not create would: these all read index 0. */
+      t->thread_index = (i & 1) ? ~0 : 1 + i;
+      t->n_iterations = n_iterations;
+      t->n_objects = n_objects;
+      /* Threads without an index would share the main thread's heap */
+      t->objects = clib_mem_alloc (n_objects * sizeof (t->objects[0]));
+      memset (t->objects, ~0, n_objects * sizeof (t->objects[0]));
+      t->max_object_size = max_object_size;
+      t->seed = seed + i;
+      if (pthread_create (tids + i, NULL, test_mt_thread, t))
+	{
+	  clib_unix_warning ("pthread_create");
+	  return 1;
+	}
+    }
+
+  for (i = 0; i < n_threads; i++)
+    pthread_join (tids[i], NULL);
+
+  after = clib_time_now (&clib_time);
+
+  fformat (stdout, "%d threads, thread cache %s: %.2f seconds, "
+	   "%.2f alloc/free pairs/second\n",
+	   n_threads, thread_cache ? "on" : "off", after - before,
+	   ((f64) n_threads * n_iterations) / (after - before));
+  if (verbose)
+    fformat (stdout, "%U\n", format_mheap, h, 1);
+
+  mheap_thread_cache (h, 0);
+  ASSERT (mheap_elts (h) == 0);
+
+  vec_foreach (t, threads) clib_mem_free (t->objects);
+  vec_free (threads);
+  vec_free (tids);
+  mheap_free (h);
+  clib_mem_free (h_mem);
+
+  return 0;
+}
+#endif
 
 int
 test_mheap_main (unformat_input_t * input)
@@ -98,6 +218,7 @@ test_mheap_main (unformat_input_t * input)
   u32 objects_used, really_verbose, n_objects, max_object_size;
   u32 check_mask, seed, trace, use_vm;
   u32 print_every = 0;
+  u32 n_threads = 0, thread_cache = 0;
   u32 *data;
   mheap_t *mh;
 
@@ -130,6 +251,8 @@ test_mheap_main (unformat_input_t * input)
 	  && 0 == unformat (input, "verbose %=", &really_verbose, 1)
 	  && 0 == unformat (input, "trace %=", &trace, 1)
 	  && 0 == unformat (input, "vm %=", &use_vm, 1)
+	  && 0 == unformat (input, "threads %d", &n_threads)
+	  && 0 == unformat (input, "cache %=", &thread_cache, 1)
 	  && 0 == unformat (input, "align %|", &check_mask, CHECK_ALIGN)
 	  && 0 == unformat (input, "test1 %|", &check_mask, TEST1))
 	{
@@ -147,6 +270,12 @@ test_mheap_main (unformat_input_t * input)
       return test1 ();
     }
 
+#ifdef CLIB_UNIX
+  if (n_threads > 0)
+    return test_mt (n_threads, n_iterations, n_objects, max_object_size,
+		    seed, thread_cache);
+#endif
+
   if_verbose
     ("testing %d iterations, %d %saligned objects, max. size %d, seed %d",
      n_iterations, n_objects, (check_mask & CHECK_ALIGN) ? "randomly " : "un",
@@ -142,6 +142,19 @@ u16x16_byte_swap (u16x16 v)
   return (u16x16) _mm256_shuffle_epi8 ((__m256i) v, (__m256i) swap);
 }
 
+/* Hardware gathers are not faster than plain loads before avx512, so
+   this just lets the compiler insert the 8 values */
+static_always_inline u32x8
+u32x8_gather (void *p0, void *p1, void *p2, void *p3, void *p4, void *p5,
+	      void *p6, void *p7)
+{
+  u32x8 r = {
+    *(u32 *) p0, *(u32 *) p1, *(u32 *) p2, *(u32 *) p3,
+    *(u32 *) p4, *(u32 *) p5, *(u32 *) p6, *(u32 *) p7,
+  };
+  return r;
+}
+
 static_always_inline u32x8
 u32x8_hadd (u32x8 v1, u32x8 v2)
 {
@@ -69,6 +69,20 @@ u16x32_msb_mask (u16x32 v)
   return (u32) _mm512_movepi16_mask ((__m512i) v);
 }
 
+/* Load the u32 found at each of the 8 addresses */
+static_always_inline u32x8
+u64x8_gather_u32 (u64x8 addr)
+{
+  return (u32x8) _mm512_i64gather_epi32 ((__m512i) addr, 0, 1);
+}
+
+/* Sign extend 8 i32 to i64 */
+static_always_inline i64x8
+i32x8_extend_to_i64x8 (i32x8 v)
+{
+  return (i64x8) _mm512_cvtepi32_epi64 ((__m256i) v);
+}
+
 #endif /* included_vector_avx512_h */
 /*
  * fd.io coding-style-patch-verification: ON
@@ -0,0 +1,181 @@
+#!/usr/bin/env python
+
+import re
+import time
+import unittest
+from subprocess import check_call, CalledProcessError
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.sendrecv import sendp
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+
+class TestBufferPools(VppTestCase):
+    """ Buffer Pools Test Case """
+
+    @classmethod
+    def setUpConstants(cls):
+        super(TestBufferPools, cls).setUpConstants()
+        cls.vpp_cmdline.extend(["buffers", "{", "pool", "data-size", "9216",
+                                "memory-size-in-mb", "64", "}"])
+
+    def setUp(self):
+        super(TestBufferPools, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestBufferPools, self).tearDown()
+
+    def create_stream(self, size, n_pkts):
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=1234))
+        p = p / Raw('\xa5' * (size - len(p)))
+        return [p] * n_pkts
+
+    def verify_capture(self, rx, size):
+        for p in rx:
+            self.assertEqual(len(p), size)
+            self.assertEqual(p[IP].dst, self.pg1.remote_ip4)
+            # the checksum is recomputed on the received copy
+            chksum = p[UDP].chksum
+            del p[UDP].chksum
+            p2 = p.__class__(str(p))
+            self.assertEqual(p2[UDP].chksum, chksum)
+
+    def test_jumbo_pool(self):
+        """ Jumbo frames in single buffers """
+
+        buffers = self.vapi.cli("show buffers")
+        self.assertIn("9472", buffers)
+
+        rx = self.send_and_expect(self.pg0, self.create_stream(9000, 5),
+                                  self.pg1)
+        self.verify_capture(rx, 9000)
+
+        # the stream's buffers come from the 9216 byte free list
+        buffers = self.vapi.cli("show buffers")
+        self.logger.info(buffers)
+        self.assertIn("pg 9000 bytes", buffers)
+
+    def test_default_pool(self):
+        """ Small frames stay in default buffers """
+
+        rx = self.send_and_expect(self.pg0, self.create_stream(1000, 5),
+                                  self.pg1)
+        self.verify_capture(rx, 1000)
+
+
+class TestBufferPoolsRx(VppTestCase):
+    """ Buffer Pools RX Queue Test Case """
+
+    host_if = "vpp-bp0"
+    peer_if = "vpp-bp1"
+
+    @classmethod
+    def setUpConstants(cls):
+        super(TestBufferPoolsRx, cls).setUpConstants()
+        cls.vpp_cmdline.extend(["buffers", "{", "pool", "data-size", "9216",
+                                "memory-size-in-mb", "64", "}"])
+
+    def ip_link(self, *args):
+        check_call(["ip", "link"] + list(args))
+
+    def setUp(self):
+        super(TestBufferPoolsRx, self).setUp()
+
+        # a veth pair, vpp reads one end through af_packet
+        try:
+            self.ip_link("add", self.host_if, "type", "veth",
+                         "peer", "name", self.peer_if)
+        except (CalledProcessError, OSError):
+            self.skipTest("can't create a veth pair")
+        for ifname in (self.host_if, self.peer_if):
+            self.ip_link("set", "dev", ifname, "mtu", "9000", "up")
+
+        self.vapi.cli("create host-interface name %s" % self.host_if)
+        self.vapi.cli("set interface state host-%s up" % self.host_if)
+
+    def tearDown(self):
+        self.vapi.cli("delete host-interface name %s" % self.host_if)
+        self.ip_link("del", self.host_if)
+
+        super(TestBufferPoolsRx, self).tearDown()
+
+    def rx_n_buffers(self, size, n_pkts):
+        """ buffers each received frame of size bytes took """
+        self.vapi.cli("clear trace")
+        # room for whatever else the kernel sends on the link
+        self.vapi.cli("trace add af-packet-input %d" % (n_pkts + 16))
+
+        p = (Ether(src="02:fe:00:00:00:01", dst="ff:ff:ff:ff:ff:ff") /
+             IP(src="10.0.0.1", dst="10.0.0.2") /
+             UDP(sport=1234, dport=1234))
+        p = p / Raw('\xa5' * (size - len(p)))
+        sendp([p] * n_pkts, iface=self.peer_if, verbose=0)
+
+        for i in range(20):
+            trace = self.vapi.cli("show trace")
+            n_buffers = [int(m.group(1)) for m in re.finditer(
+                r"n-buffers (\d+)\s+tpacket2_hdr:\s+status 0x[0-9a-f]+ "
+                r"len (\d+)", trace) if int(m.group(2)) == size]
+            if len(n_buffers) >= n_pkts:
+                break
+            time.sleep(0.1)
+        self.logger.info(trace)
+        self.assertEqual(len(n_buffers), n_pkts)
+        return n_buffers
+
+    def test_rx_jumbo_single_buffer(self):
+        """ MTU-sized frames are received into single buffers """
+
+        # the interface's frames fit the 9216 byte pool
+        buffers = self.vapi.cli("show buffers")
+        self.logger.info(buffers)
+        self.assertIn("rx 9216 bytes", buffers)
+
+        self.assertEqual(self.rx_n_buffers(9014, 5), [1] * 5)
+
+
+class TestBufferCaches(VppTestCase):
+    """ Buffer Caches Test Case """
+
+    @classmethod
+    def setUpConstants(cls):
+        super(TestBufferCaches, cls).setUpConstants()
+        cls.vpp_cmdline.extend(["cpu", "{", "workers", "2", "}"])
+
+    def test_remote_free(self):
+        """ Buffers freed on another thread than they were allocated """
+
+        error = self.vapi.cli("test buffer remote-free rounds 16")
+        self.logger.info(error)
+        self.assertNotIn("failed", error)
+        self.assertIn("16 rounds", error)
+
+        # more buffers than a thread keeps, so magazines went back to
+        # the pool from the thread which did not allocate them
+        error = self.vapi.cli("test buffer remote-free buffers 8192 "
+                              "rounds 4")
+        self.logger.info(error)
+        self.assertNotIn("failed", error)
+
+        buffers = self.vapi.cli("show buffers")
+        self.logger.info(buffers)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
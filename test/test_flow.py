@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+from scapy.layers.vxlan import VXLAN
+
+
+class TestFlow(VppTestCase):
+    """ Flow Offload Emulation Test Case """
+
+    def setUp(self):
+        super(TestFlow, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.vapi.cli("clear errors")
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestFlow, self).tearDown()
+
+    def create_stream(self, dport, n_pkts):
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=dport) /
+             Raw('\xa5' * 100))
+        return [p] * n_pkts
+
+    def flow_add(self, args):
+        reply = self.vapi.cli("test flow add %s" % args)
+        return int(reply.split()[-1])
+
+    def test_flow_drop(self):
+        """ Flow drop action """
+
+        index = self.flow_add("src-ip %s/32 dst-ip %s/32 proto 17 "
+                              "dst-port 1234 drop" %
+                              (self.pg0.remote_ip4, self.pg1.remote_ip4))
+        self.vapi.cli("test flow enable index %d %s" % (index, self.pg0.name))
+        self.assertIn("1 flows",
+                      self.vapi.cli("show flow interface %s" % self.pg0.name))
+
+        self.send_and_assert_no_replies(self.pg0,
+                                        self.create_stream(1234, 5))
+        self.send_and_expect(self.pg0, self.create_stream(1235, 5), self.pg1)
+
+        self.assertIn("5 packets",
+                      self.vapi.cli("show flow entry index %d" % index))
+        self.assertIn("flow drop", self.vapi.cli("show errors"))
+
+        #
+        # with the flow disabled the packets are forwarded again
+        #
+        self.vapi.cli("test flow disable index %d %s" % (index, self.pg0.name))
+        self.vapi.cli("test flow del index %d" % index)
+
+        self.send_and_expect(self.pg0, self.create_stream(1234, 5), self.pg1)
+
+    def test_flow_vxlan(self):
+        """ Flow VXLAN decap offload """
+
+        self.vapi.cli("create vxlan tunnel src %s dst %s vni 24" %
+                      (self.pg0.local_ip4, self.pg0.remote_ip4))
+        self.vapi.cli("set interface state vxlan_tunnel0 up")
+        self.vapi.cli("set interface l2 bridge vxlan_tunnel0 24")
+        self.vapi.cli("set interface l2 bridge %s 24" % self.pg1.name)
+        self.vapi.cli("set flow-offload vxlan hw %s rx vxlan_tunnel0" %
+                      self.pg0.name)
+
+        inner = (Ether(src="00:00:00:00:00:02", dst="ff:ff:ff:ff:ff:ff") /
+                 IP(src="4.3.2.1", dst="1.2.3.4") /
+                 UDP(sport=1234, dport=1234) /
+                 Raw('\xa5' * 100))
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg0.local_ip4) /
+             UDP(sport=4789, dport=4789, chksum=0) /
+             VXLAN(vni=24, flags=0x8) /
+             inner)
+
+        rx = self.send_and_expect(self.pg0, [p] * 5, self.pg1)
+        for r in rx:
+            self.assertEqual(r[IP].dst, "1.2.3.4")
+            self.assertEqual(r[Ether].src, "00:00:00:00:00:02")
+
+        self.assertIn("5 packets", self.vapi.cli("show flow entry index 0"))
+
+        self.vapi.cli("set flow-offload vxlan hw %s rx vxlan_tunnel0 del" %
+                      self.pg0.name)
+        self.vapi.cli("set interface l3 %s" % self.pg1.name)
+        self.vapi.cli("create vxlan tunnel src %s dst %s vni 24 del" %
+                      (self.pg0.local_ip4, self.pg0.remote_ip4))
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -112,6 +112,36 @@ class TestGtpu(BridgeDomain, VppTestCase):
             # payload = self.decapsulate(pkt)
             # self.assert_eq_pkts(payload, self.frame_reply)
 
+    def test_decap_ucast_tunnels(self):
+        """ Decapsulation from many tunnels test
+        Send encapsulated frames from each ucast tunnel remote on pg0
+        Verify receipt of decapsulated frames on pg3
+        and the drop of frames with an unknown teid
+        """
+        pkts = []
+        for i in range(3):
+            for src_ip in self.ip_range(10, 10 + self.n_ucast_tunnels):
+                pkts.append(Ether(src=self.pg0.remote_mac,
+                                  dst=self.pg0.local_mac) /
+                            IP(src=src_ip, dst=self.pg0.local_ip4) /
+                            UDP(sport=self.dport, dport=self.dport,
+                                chksum=0) /
+                            GTP_U_Header(teid=self.ucast_flood_bd,
+                                         gtp_type=self.gtp_type,
+                                         length=150) /
+                            self.frame_request)
+        pkts.append(self.encapsulate(self.frame_request, 0x1234))
+
+        self.pg0.add_stream(pkts)
+
+        self.pg3.enable_capture()
+
+        self.pg_start()
+
+        out = self.pg3.get_capture(len(pkts) - 1)
+        for pkt in out:
+            self.assert_eq_pkts(pkt, self.frame_request)
+
     def test_mcast_flood(self):
         """ Multicast flood test
         Send frames from pg2
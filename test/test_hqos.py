@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+
+import re
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+
+class TestHQoS(VppTestCase):
+    """ Hierarchical QoS Scheduler Test Case """
+
+    def setUp(self):
+        super(TestHQoS, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    def tearDown(self):
+        self.vapi.cli("hqos port %s del" % self.pg1.name)
+
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestHQoS, self).tearDown()
+
+    def create_stream(self, tos, n_pkts):
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4, tos=tos) /
+             UDP(sport=1234, dport=1234) /
+             Raw('\xa5' * 458))
+        return [p] * n_pkts
+
+    def test_hqos_unshaped(self):
+        """ HQoS unshaped port """
+
+        self.vapi.cli("hqos port %s subports 2 pipes 4" % self.pg1.name)
+        self.vapi.cli("hqos classify %s pipe offset 30 mask ff" %
+                      self.pg1.name)
+
+        pkts = self.create_stream(0, 10) + self.create_stream(0xb8, 10)
+        rx = self.send_and_expect(self.pg0, pkts, self.pg1)
+        for p in rx:
+            self.assertEqual(p[IP].dst, self.pg1.remote_ip4)
+
+        self.logger.info(self.vapi.cli("show hqos verbose"))
+
+    def test_hqos_tail_drop(self):
+        """ HQoS queue tail drop """
+
+        #
+        # a slow port with short queues takes the first packets of a
+        # burst and drops the rest
+        #
+        self.vapi.cli("hqos port %s rate 1000 queue-size 4" % self.pg1.name)
+
+        pkts = self.create_stream(0, 20)
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        self.pg1.get_capture(4)
+
+        self.assertIn("drops 16", self.vapi.cli("show hqos"))
+
+    def test_hqos_priority(self):
+        """ HQoS strict priority """
+
+        #
+        # the port bucket holds four packets, the high priority packets
+        # sent last go out first
+        #
+        self.vapi.cli("hqos port %s rate 10000 burst 2048" % self.pg1.name)
+
+        pkts = self.create_stream(0, 4) + self.create_stream(0xc0, 4)
+        rx = self.send_and_expect(self.pg0, pkts, self.pg1)
+
+        for p in rx[:4]:
+            self.assertEqual(p[IP].tos, 0xc0)
+        for p in rx[4:]:
+            self.assertEqual(p[IP].tos, 0)
+
+    def test_hqos_interface_delete(self):
+        """ HQoS port deleted with its interface """
+
+        #
+        # a port too slow to drain holds the packets routed out of a
+        # loopback, deleting the loopback deletes the port and frees them
+        #
+        self.create_loopback_interfaces(1)
+        loop = self.lo_interfaces[0]
+        loop.admin_up()
+        loop.config_ip4()
+        loop.configure_ipv4_neighbors()
+
+        self.vapi.cli("hqos port %s rate 1000 burst 600" % loop.name)
+
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=loop.remote_ip4) /
+             UDP(sport=1234, dport=1234) /
+             Raw('\xa5' * 458))
+        self.pg0.add_stream([p] * 10)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        reply = self.vapi.cli("show hqos")
+        self.logger.info(reply)
+        queued = re.search(r"queued (\d+)", reply)
+        self.assertIsNotNone(queued)
+        self.assertGreater(int(queued.group(1)), 0)
+
+        loop.remove_vpp_config()
+
+        reply = self.vapi.cli("show hqos")
+        self.logger.info(reply)
+        self.assertNotIn(loop.name, reply)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -1132,6 +1132,26 @@ class TestIPPunt(VppTestCase):
                                   rate_type=1, is_add=0)
         self.send_and_expect(self.pg0, pkts, self.pg1)
 
+        #
+        # the same with per-thread token shares
+        #
+        policer = self.vapi.policer_add_del("ip4-punt", 400, 0, 10, 0,
+                                            rate_type=1, per_thread=1)
+        self.vapi.ip_punt_police(policer.policer_index)
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        rx = self.pg1._get_capture(1)
+        self.assertTrue(len(rx) > 0)
+        self.assertTrue(len(rx) < len(pkts))
+
+        self.vapi.ip_punt_police(policer.policer_index, is_add=0)
+        self.vapi.policer_add_del("ip4-punt", 400, 0, 10, 0,
+                                  rate_type=1, is_add=0)
+        self.send_and_expect(self.pg0, pkts, self.pg1)
+
         #
         # remove the redirect. expect full drop.
         #
@@ -1392,5 +1412,51 @@ class TestIPInput(VppTestCase):
         # Reset MTU for subsequent tests
         self.vapi.sw_interface_set_mtu(self.pg1.sw_if_index, [9000, 0, 0, 0])
 
+    def test_ip_input_mixed(self):
+        """ IP Input Exceptions within a frame of good packets """
+
+        #
+        # ethernet-input and ip4-input check whole runs of packets at
+        # once; one bad packet in a run must only affect that packet
+        #
+        p_good = (Ether(src=self.pg0.remote_mac,
+                        dst=self.pg0.local_mac) /
+                  IP(src=self.pg0.remote_ip4,
+                     dst=self.pg1.remote_ip4) /
+                  UDP(sport=1234, dport=1234) /
+                  Raw('\xa5' * 100))
+        p_mac = (Ether(src=self.pg0.remote_mac,
+                       dst="00:00:11:22:33:44") /
+                 IP(src=self.pg0.remote_ip4,
+                    dst=self.pg1.remote_ip4) /
+                 UDP(sport=1234, dport=1234) /
+                 Raw('\xa5' * 100))
+        p_bad = [p_mac,
+                 (Ether(src=self.pg0.remote_mac,
+                        dst=self.pg0.local_mac) /
+                  IP(src=self.pg0.remote_ip4,
+                     dst=self.pg1.remote_ip4,
+                     chksum=400) /
+                  UDP(sport=1234, dport=1234) /
+                  Raw('\xa5' * 100)),
+                 (Ether(src=self.pg0.remote_mac,
+                        dst=self.pg0.local_mac) /
+                  IP(src=self.pg0.remote_ip4,
+                     dst=self.pg1.remote_ip4,
+                     len=400) /
+                  UDP(sport=1234, dport=1234) /
+                  Raw('\xa5' * 100))]
+
+        for bad in p_bad:
+            for pos in [0, 7, 33, 64]:
+                pkts = p_good * 65
+                pkts[pos] = bad
+                self.pg0.add_stream(pkts)
+                self.pg_enable_capture(self.pg_interfaces)
+                self.pg_start()
+                rx = self.pg1.get_capture(64)
+                for p in rx:
+                    self.assertEqual(p[IP].ttl, 63)
+
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,187 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+from vpp_ip_route import VppIpRoute, VppRoutePath
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP, TCP
+
+
+class TestIP4FlowCache(VppTestCase):
+    """ IPv4 Flow Cache Test Case """
+
+    def setUp(self):
+        super(TestIP4FlowCache, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        for i in self.pg_interfaces:
+            self.vapi.cli("set interface ip4-flow-cache %s" % i.name)
+        self.vapi.cli("clear errors")
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            self.vapi.cli("set interface ip4-flow-cache %s disable" % i.name)
+
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestIP4FlowCache, self).tearDown()
+
+    def create_stream(self, l4, n_pkts):
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4, ttl=64) /
+             l4 /
+             Raw('\xa5' * 100))
+        return [p] * n_pkts
+
+    def verify_capture(self, rx):
+        for p in rx:
+            self.assertEqual(p[Ether].src, self.pg1.local_mac)
+            self.assertEqual(p[Ether].dst, self.pg1.remote_mac)
+            self.assertEqual(p[IP].dst, self.pg1.remote_ip4)
+            self.assertEqual(p[IP].ttl, 63)
+            # the checksums are recomputed on the received copy
+            chksum = p[IP].chksum
+            del p[IP].chksum
+            p2 = p.__class__(str(p))
+            self.assertEqual(p2[IP].chksum, chksum)
+
+    def n_hits(self):
+        errors = self.vapi.cli("show errors")
+        for line in errors.splitlines():
+            if "flow cache hits" in line:
+                return int(line.split()[0])
+        return 0
+
+    def test_flow_cache_udp(self):
+        """ Flow cache UDP flow """
+
+        #
+        # the first packet learns the flow, the next ones hit
+        #
+        rx = self.send_and_expect(self.pg0,
+                                  self.create_stream(UDP(sport=1234,
+                                                         dport=1234), 1),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertIn("1 flows", self.vapi.cli("show ip4 flow-cache"))
+
+        rx = self.send_and_expect(self.pg0,
+                                  self.create_stream(UDP(sport=1234,
+                                                         dport=1234), 10),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertEqual(self.n_hits(), 10)
+
+        #
+        # a route change makes the flow go through the graph again
+        #
+        route = VppIpRoute(self, "10.10.10.0", 24,
+                           [VppRoutePath(self.pg1.remote_ip4,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        rx = self.send_and_expect(self.pg0,
+                                  self.create_stream(UDP(sport=1234,
+                                                         dport=1234), 1),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertEqual(self.n_hits(), 10)
+
+        rx = self.send_and_expect(self.pg0,
+                                  self.create_stream(UDP(sport=1234,
+                                                         dport=1234), 10),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertEqual(self.n_hits(), 20)
+
+        route.remove_vpp_config()
+
+    def test_flow_cache_tcp(self):
+        """ Flow cache TCP flow """
+
+        #
+        # SYNs are never replayed from the cache
+        #
+        syn = TCP(sport=1234, dport=80, flags="S")
+        ack = TCP(sport=1234, dport=80, flags="A")
+
+        self.send_and_expect(self.pg0, self.create_stream(ack, 1), self.pg1)
+
+        rx = self.send_and_expect(self.pg0, self.create_stream(syn, 5),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertEqual(self.n_hits(), 0)
+
+        rx = self.send_and_expect(self.pg0, self.create_stream(ack, 5),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertEqual(self.n_hits(), 5)
+
+        self.logger.info(self.vapi.cli("show ip4 flow-cache verbose"))
+
+    def test_flow_cache_output_disabled(self):
+        """ Flow cache not enabled on the output interface """
+
+        self.vapi.cli("set interface ip4-flow-cache %s disable" %
+                      self.pg1.name)
+
+        rx = self.send_and_expect(self.pg0,
+                                  self.create_stream(UDP(sport=1234,
+                                                         dport=1234), 10),
+                                  self.pg1)
+        self.verify_capture(rx)
+        self.assertIn("0 flows", self.vapi.cli("show ip4 flow-cache"))
+        self.assertEqual(self.n_hits(), 0)
+
+        self.vapi.cli("set interface ip4-flow-cache %s" % self.pg1.name)
+
+    def test_flow_cache_nat(self):
+        """ Flow cache NAT session delete """
+
+        nat_addr = "10.0.0.3"
+        self.vapi.cli("nat44 add address %s" % nat_addr)
+        self.vapi.cli("set interface nat44 in %s out %s" %
+                      (self.pg0.name, self.pg1.name))
+
+        for sport in [1234, 1235]:
+            rx = self.send_and_expect(self.pg0,
+                                      self.create_stream(UDP(sport=sport,
+                                                             dport=1234), 1),
+                                      self.pg1)
+            for p in rx:
+                self.assertEqual(p[IP].src, nat_addr)
+        self.assertIn("2 flows", self.vapi.cli("show ip4 flow-cache"))
+
+        #
+        # deleting one session removes its flow only
+        #
+        self.vapi.cli("nat44 del session in %s:1234 udp" %
+                      self.pg0.remote_ip4)
+        self.assertIn("1 flows", self.vapi.cli("show ip4 flow-cache"))
+
+        rx = self.send_and_expect(self.pg0,
+                                  self.create_stream(UDP(sport=1235,
+                                                         dport=1234), 10),
+                                  self.pg1)
+        for p in rx:
+            self.assertEqual(p[IP].src, nat_addr)
+        self.assertEqual(self.n_hits(), 10)
+
+        self.vapi.cli("set interface nat44 in %s out %s del" %
+                      (self.pg0.name, self.pg1.name))
+        self.vapi.cli("nat44 add address %s del" % nat_addr)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
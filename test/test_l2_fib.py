@@ -60,6 +60,7 @@
     - no packet received on all 4 pg-l2 interfaces
 """
 
+import re
 import unittest
 import random
 
@@ -520,6 +521,46 @@ class TestL2fib(VppTestCase):
             self.assertLess(len(e), ev_macs * 10)
         self.assertEqual(len(learned_macs ^ macs), 0)
 
+    def test_l2_fib_mac_age_evs(self):
+        """ L2 FIB - mac aging events across ager scan slices
+        """
+        bd1 = 1
+        hosts = self.create_hosts(10, subnet=41)
+
+        self.vapi.want_macs_learn_events()
+        self.learn_hosts(bd1, hosts)
+
+        self.sleep(1)
+        evs = self.vapi.collect_events()
+        learned_macs = {
+            e.mac[i].mac_addr for e in evs for i in range(e.n_macs)
+            if e.mac[i].action == MAC_EVENT_ACTION_ADD}
+        macs = {h.bin_mac for swif in self.bd_ifs(bd1)
+                for h in hosts[self.pg_interfaces[swif].sw_if_index]}
+        self.assertEqual(len(learned_macs ^ macs), 0)
+
+        # flushing the interface leaves its macs stale, the ager scan
+        # deletes them while yielding every few buckets
+        swif = self.pg_interfaces[self.bd_ifs(bd1)[0]].sw_if_index
+        self.vapi.l2fib_flush_int(swif)
+
+        self.sleep(1)
+        reply = self.vapi.ppcli("show l2fib")
+        self.logger.info(reply)
+        evs = self.vapi.collect_events()
+        self.vapi.want_macs_learn_events(enable_disable=0)
+
+        aged_macs = {
+            e.mac[i].mac_addr for e in evs for i in range(e.n_macs)
+            if e.mac[i].action == MAC_EVENT_ACTION_DELETE}
+        self.assertEqual(aged_macs, {h.bin_mac for h in hosts[swif]})
+
+        scan = re.search(r"Last scan aged: (\d+)  Last scan slices: (\d+)",
+                         reply)
+        self.assertIsNotNone(scan)
+        self.assertEqual(int(scan.group(1)), len(hosts[swif]))
+        self.assertGreater(int(scan.group(2)), 1)
+
 
 if __name__ == '__main__':
     unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether, ARP
+from scapy.layers.inet import IP, UDP
+
+
+class TestL2Flood(VppTestCase):
+    """ L2-flood """
+
+    def setUp(self):
+        super(TestL2Flood, self).setUp()
+
+        # 12 l2 interfaces and one l3
+        self.create_pg_interfaces(range(13))
+        self.create_loopback_interfaces(1)
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+        for i in self.lo_interfaces:
+            i.admin_up()
+
+        self.pg12.config_ip4()
+        self.pg12.resolve_arp()
+
+    def tearDown(self):
+        self.pg12.unconfig_ip4()
+        for i in self.pg_interfaces:
+            i.admin_down()
+        for i in self.lo_interfaces:
+            i.admin_down()
+        super(TestL2Flood, self).tearDown()
+
+    def test_flood(self):
+        """ L2 Flood Tests """
+
+        #
+        # Create a single bridge Domain
+        #
+        self.vapi.bridge_domain_add_del(1)
+
+        #
+        # add each interface to the BD. 3 interfaces per split horizon group
+        #
+        for i in self.pg_interfaces[0:4]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, 1, 0)
+        for i in self.pg_interfaces[4:8]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, 1, 1)
+        for i in self.pg_interfaces[8:12]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, 1, 2)
+
+        #
+        # Payloads both below and above the size where clones share
+        # the packet tail
+        #
+        for size in [100, 1000]:
+            p = (Ether(dst="ff:ff:ff:ff:ff:ff", src="00:00:de:ad:be:ef") /
+                 IP(src="10.10.10.10", dst="1.1.1.1") /
+                 UDP(sport=1234, dport=1234) /
+                 Raw('\xa5' * size))
+
+            #
+            # input on pg0 expect copies on pg1->11
+            # this is in SHG=0 so its flooded to all, expect the pg0 since
+            # this is the ingress interface
+            #
+            self.pg0.add_stream(p * 65)
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+
+            for i in self.pg_interfaces[1:12]:
+                rx0 = i.get_capture(65, timeout=1)
+                for rx in rx0:
+                    self.assertEqual(rx[Raw].load, p[Raw].load)
+
+            #
+            # input on pg4 (SHG=1) expect copies on pg0->3 (SHG=0)
+            # and pg8->11 (SHG=2)
+            #
+            self.pg4.add_stream(p * 65)
+            self.pg_enable_capture(self.pg_interfaces)
+            self.pg_start()
+
+            for i in self.pg_interfaces[:4]:
+                rx0 = i.get_capture(65, timeout=1)
+            for i in self.pg_interfaces[8:12]:
+                rx0 = i.get_capture(65, timeout=1)
+            for i in self.pg_interfaces[4:8]:
+                i.assert_nothing_captured(remark="Different SHG")
+
+        #
+        # An IP interface in the same BD.
+        # The BVI gets the last clone, so an ARP request answered by it
+        # must still reach every other member untouched
+        #
+        self.vapi.sw_interface_set_l2_bridge(self.loop0.sw_if_index,
+                                             1, 0, bvi=1)
+        self.loop0.config_ip4()
+
+        p = (Ether(dst="ff:ff:ff:ff:ff:ff", src=self.pg0.remote_mac) /
+             ARP(op="who-has", hwsrc=self.pg0.remote_mac,
+                 psrc="10.10.10.10", pdst=self.loop0.local_ip4))
+
+        self.pg0.add_stream(p * 65)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+        rx0 = self.pg0.get_capture(65, timeout=1)
+        for rx in rx0:
+            self.assertEqual(rx[ARP].op, 2)
+            self.assertEqual(rx[ARP].psrc, self.loop0.local_ip4)
+        for i in self.pg_interfaces[1:12]:
+            rx0 = i.get_capture(65, timeout=1)
+            for rx in rx0:
+                self.assertEqual(rx[ARP].op, 1)
+                self.assertEqual(rx[ARP].pdst, self.loop0.local_ip4)
+
+        #
+        # cleanup
+        #
+        self.loop0.unconfig_ip4()
+        self.vapi.sw_interface_set_l2_bridge(self.loop0.sw_if_index,
+                                             1, 0, bvi=1, enable=0)
+        for i in self.pg_interfaces[:12]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, 1, enable=0)
+        self.vapi.bridge_domain_add_del(1, is_add=0)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,144 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP, ICMP
+from scapy.layers.inet6 import IPv6, ICMPv6EchoRequest, ICMPv6EchoReply
+
+
+class TestMixedNext(VppTestCase):
+    """ Mixed Next Node Test Case """
+
+    def setUp(self):
+        super(TestMixedNext, self).setUp()
+
+        self.create_pg_interfaces(range(6))
+
+        #
+        # pg0-2 route, pg3-5 are in a bridge domain
+        #
+        for i in self.pg_interfaces[:3]:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+            i.config_ip6()
+            i.resolve_ndp()
+
+        self.vapi.bridge_domain_add_del(bd_id=1)
+        for i in self.pg_interfaces[3:]:
+            i.admin_up()
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, bd_id=1)
+        self.vapi.l2fib_add_del(self.pg4.remote_mac, 1,
+                                self.pg4.sw_if_index, static_mac=1)
+
+    def tearDown(self):
+        self.vapi.l2fib_add_del(self.pg4.remote_mac, 1,
+                                self.pg4.sw_if_index, is_add=0)
+        for i in self.pg_interfaces[3:]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, bd_id=1,
+                                                 enable=0)
+            i.admin_down()
+        self.vapi.bridge_domain_add_del(bd_id=1, is_add=0)
+
+        for i in self.pg_interfaces[:3]:
+            i.unconfig_ip4()
+            i.unconfig_ip6()
+            i.admin_down()
+
+        super(TestMixedNext, self).tearDown()
+
+    def send_mixed(self, intf, pkts, n_rounds):
+        """ send the packets round-robin, so each takes a different
+        next node from the previous one """
+        self.vapi.cli("clear runtime")
+        intf.add_stream(pkts * n_rounds)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+
+    def test_ip4_mixed(self):
+        """ IP4 lookup with a different next for each packet """
+
+        eth = Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+        udp = UDP(sport=1234, dport=1234) / Raw('\xa5' * 100)
+        pkts = [eth / IP(src=self.pg0.remote_ip4,
+                         dst=self.pg1.remote_ip4) / udp,
+                eth / IP(src=self.pg0.remote_ip4,
+                         dst=self.pg2.remote_ip4) / udp,
+                eth / IP(src=self.pg0.remote_ip4,
+                         dst=self.pg0.local_ip4) / ICMP(id=1),
+                eth / IP(src=self.pg0.remote_ip4,
+                         dst="10.99.0.1") / udp]
+
+        self.send_mixed(self.pg0, pkts, 65)
+
+        rx = self.pg1.get_capture(65)
+        for p in rx:
+            self.assertEqual(p[IP].dst, self.pg1.remote_ip4)
+            self.assertEqual(p[IP].ttl, 63)
+        rx = self.pg2.get_capture(65)
+        for p in rx:
+            self.assertEqual(p[IP].dst, self.pg2.remote_ip4)
+        rx = self.pg0.get_capture(65)
+        for p in rx:
+            self.assertEqual(p[ICMP].type, 0)  # echo-reply
+
+        self.logger.info(self.vapi.cli("show runtime"))
+
+    def test_ip6_mixed(self):
+        """ IP6 lookup with a different next for each packet """
+
+        eth = Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac)
+        udp = UDP(sport=1234, dport=1234) / Raw('\xa5' * 100)
+        pkts = [eth / IPv6(src=self.pg0.remote_ip6,
+                           dst=self.pg1.remote_ip6) / udp,
+                eth / IPv6(src=self.pg0.remote_ip6,
+                           dst=self.pg2.remote_ip6) / udp,
+                eth / IPv6(src=self.pg0.remote_ip6,
+                           dst=self.pg0.local_ip6) / ICMPv6EchoRequest(),
+                eth / IPv6(src=self.pg0.remote_ip6,
+                           dst="2001:db8:99::1") / udp]
+
+        self.send_mixed(self.pg0, pkts, 65)
+
+        rx = self.pg1.get_capture(65)
+        for p in rx:
+            self.assertEqual(p[IPv6].dst, self.pg1.remote_ip6)
+            self.assertEqual(p[IPv6].hlim, 63)
+        rx = self.pg2.get_capture(65)
+        for p in rx:
+            self.assertEqual(p[IPv6].dst, self.pg2.remote_ip6)
+        rx = self.pg0.get_capture(65, filter_out_fn=lambda p: (
+            not p.haslayer(ICMPv6EchoReply)))
+        self.assertEqual(len(rx), 65)
+
+        self.logger.info(self.vapi.cli("show runtime"))
+
+    def test_l2_mixed(self):
+        """ L2 input with known unicast and flooded packets interleaved """
+
+        ip = (IP(src="10.0.0.1", dst="10.0.0.2") /
+              UDP(sport=1234, dport=1234) /
+              Raw('\xa5' * 100))
+        pkts = [Ether(src=self.pg3.remote_mac,
+                      dst=self.pg4.remote_mac) / ip,
+                Ether(src=self.pg3.remote_mac,
+                      dst="ff:ff:ff:ff:ff:ff") / ip]
+
+        self.send_mixed(self.pg3, pkts, 65)
+
+        rx = self.pg4.get_capture(130)
+        self.assertEqual(len([p for p in rx
+                              if p[Ether].dst == self.pg4.remote_mac]), 65)
+        rx = self.pg5.get_capture(65)
+        for p in rx:
+            self.assertEqual(p[Ether].dst, "ff:ff:ff:ff:ff:ff")
+
+        self.logger.info(self.vapi.cli("show runtime"))
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
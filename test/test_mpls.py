@@ -1034,6 +1034,27 @@ class TestMPLS(VppTestCase):
         rx = self.send_and_expect(self.pg0, tx, self.pg1)
         self.verify_capture_ip4(self.pg1, rx, tx, ping_resp=1)
 
+        #
+        # Pop a stack deeper than the labels mpls-lookup pops in one go
+        #
+        routes_neos = []
+        for label in range(37, 47):
+            route = VppMplsRoute(self, label, 0,
+                                 [VppRoutePath("0.0.0.0",
+                                               0xffffffff)])
+            route.add_vpp_config()
+            routes_neos.append(route)
+
+        tx = self.create_stream_labelled_ip4(self.pg0,
+                                             [VppMplsLabel(l)
+                                              for l in range(36, 47)] +
+                                             [VppMplsLabel(35)],
+                                             ping=1, ip_itf=self.pg1)
+        rx = self.send_and_expect(self.pg0, tx, self.pg1)
+        self.verify_capture_ip4(self.pg1, rx, tx, ping_resp=1)
+
+        for route in routes_neos:
+            route.remove_vpp_config()
         route_36_neos.remove_vpp_config()
         route_35_eos.remove_vpp_config()
         route_34_eos.remove_vpp_config()
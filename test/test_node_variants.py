@@ -0,0 +1,85 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+
+class TestNodeVariants(VppTestCase):
+    """ Node Function Variants Test Case """
+
+    def setUp(self):
+        super(TestNodeVariants, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestNodeVariants, self).tearDown()
+
+    def create_stream(self, n_pkts):
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=1234) /
+             Raw('\xa5' * 100))
+        return [p] * n_pkts
+
+    def variants(self, node):
+        """ return the (name, priority, active) of the variants of a node """
+        reply = self.vapi.cli("show node %s" % node)
+        variants = []
+        in_table = False
+        for line in reply.splitlines():
+            words = line.split()
+            if in_table and len(words) >= 2:
+                variants.append((words[0], int(words[1]),
+                                 len(words) > 2 and words[2] == "yes"))
+            if words and words[0] == "Name":
+                in_table = True
+        return variants
+
+    def test_variants(self):
+        """ Forwarding through each cpu variant """
+
+        variants = self.variants("ip4-rewrite")
+        self.assertIn("default", [v[0] for v in variants])
+
+        for name, priority, active in variants:
+            if priority < 0:
+                continue
+            for node in ["ethernet-input", "ip4-lookup", "ip4-rewrite"]:
+                self.vapi.cli("set node function %s %s" % (node, name))
+            self.assertIn((name, priority, True),
+                          self.variants("ip4-rewrite"))
+
+            self.vapi.cli("clear runtime")
+            rx = self.send_and_expect(self.pg0, self.create_stream(65),
+                                      self.pg1)
+            for p in rx:
+                self.assertEqual(p[IP].ttl, 63)
+            self.logger.info("variant %s:\n%s" %
+                             (name, self.vapi.cli("show runtime")))
+
+        #
+        # back to the variant picked at startup
+        #
+        best = max(variants, key=lambda v: v[1])[0]
+        for node in ["ethernet-input", "ip4-lookup", "ip4-rewrite"]:
+            self.vapi.cli("set node function %s %s" % (node, best))
+        self.assertIn(True, [v[2] for v in self.variants("ip4-rewrite")])
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
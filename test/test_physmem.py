@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+
+import re
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+
+def online_numa_nodes():
+    """ the numa nodes VPP preallocates an arena on """
+    try:
+        with open("/sys/devices/system/node/online") as f:
+            online = f.read().strip()
+    except IOError:
+        return [0]
+    nodes = []
+    for r in online.split(","):
+        lo, _, hi = r.partition("-")
+        nodes.extend(range(int(lo), int(hi or lo) + 1))
+    return nodes
+
+
+class TestPhysmemArenaBase(VppTestCase):
+    """ Physmem arena base, parses show physmem """
+
+    def show_physmem(self):
+        reply = self.vapi.cli("show physmem")
+        self.logger.info(reply)
+        arenas = {}
+        for m in re.finditer(r"arena numa-node (\d+) page-size (\d+)KB "
+                             r"num-pages (\d+)", reply):
+            arenas[int(m.group(1))] = int(m.group(2)) * int(m.group(3))
+        regions = {}
+        for m in re.finditer(r"name '([^']+)' page-size \d+KB "
+                             r"num-pages \d+ numa-node (\d+) fd -?\d+"
+                             r"( arena)?", reply):
+            regions[m.group(1)] = (int(m.group(2)), m.group(3) is not None)
+        if not arenas:
+            self.skipTest("no hugepages to preallocate the arenas from")
+        return arenas, regions
+
+
+class TestPhysmemArena(TestPhysmemArenaBase):
+    """ Physmem Arena Test Case """
+
+    @classmethod
+    def setUpConstants(cls):
+        super(TestPhysmemArena, cls).setUpConstants()
+        cls.vpp_cmdline.extend(["physmem", "{", "prealloc-size", "64M", "}",
+                                "buffers", "{", "memory-size-in-mb", "16",
+                                "}"])
+
+    def test_arena_per_numa(self):
+        """ One arena per online numa node, buffers carved out of it """
+
+        arenas, regions = self.show_physmem()
+
+        for n in online_numa_nodes():
+            self.assertIn(n, arenas)
+            self.assertGreaterEqual(arenas[n], 64 << 10)
+
+        # the default pool and the per-numa pools come from the arena
+        # of their own numa node
+        self.assertIn("buffers", regions)
+        for name, (numa_node, in_arena) in regions.items():
+            if not name.startswith("buffers"):
+                continue
+            self.assertTrue(in_arena, "region %s not in an arena" % name)
+            self.assertIn(numa_node, arenas)
+
+
+class TestPhysmemArenaFull(TestPhysmemArenaBase):
+    """ Physmem Arena Fallback Test Case """
+
+    @classmethod
+    def setUpConstants(cls):
+        super(TestPhysmemArenaFull, cls).setUpConstants()
+        cls.vpp_cmdline.extend(["physmem", "{", "prealloc-size", "4M", "}",
+                                "buffers", "{", "memory-size-in-mb", "16",
+                                "}"])
+
+    def test_arena_full(self):
+        """ Regions which don't fit the arena get their own memory """
+
+        arenas, regions = self.show_physmem()
+
+        self.assertIn("buffers", regions)
+        numa_node, in_arena = regions["buffers"]
+        self.assertFalse(in_arena)
+
+        # and the buffers are usable
+        error = self.vapi.cli("show buffers")
+        self.logger.info(error)
+        self.assertIn("default", error)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,350 @@
+#!/usr/bin/env python
+
+import os
+import socket
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+from vpp_ip_route import VppIpRoute, VppRoutePath, find_route
+from vpp_neighbor import VppNeighbor, find_nbr
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+
+class TestSnapshot(VppTestCase):
+    """ Warm restart snapshot Test Case """
+
+    def setUp(self):
+        super(TestSnapshot, self).setUp()
+
+        self.create_pg_interfaces(range(4))
+
+        for i in self.pg_interfaces[:2]:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+        for i in self.pg_interfaces[2:]:
+            i.admin_up()
+
+        self.snapshot = os.path.join(self.tempdir, "vpp.snapshot")
+
+    def tearDown(self):
+        for i in self.pg_interfaces[:2]:
+            i.unconfig_ip4()
+            i.admin_down()
+        for i in self.pg_interfaces[2:]:
+            i.admin_down()
+
+        super(TestSnapshot, self).tearDown()
+
+    def test_snapshot(self):
+        """ Save a snapshot, remove the state, restore it """
+
+        route = VppIpRoute(self, "10.10.10.0", 24,
+                           [VppRoutePath(self.pg1.remote_ip4,
+                                         self.pg1.sw_if_index)])
+        route.add_vpp_config()
+
+        self.vapi.bridge_domain_add_del(bd_id=10)
+        for i in self.pg_interfaces[2:]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, bd_id=10)
+        self.vapi.l2fib_add_del(self.pg3.remote_mac, 10,
+                                self.pg3.sw_if_index, static_mac=1)
+
+        reply = self.vapi.cli("snapshot save %s" % self.snapshot)
+        self.assertNotIn("failed", reply)
+
+        #
+        # remove it all, then bring it back from the snapshot
+        #
+        self.vapi.l2fib_add_del(self.pg3.remote_mac, 10,
+                                self.pg3.sw_if_index, is_add=0)
+        for i in self.pg_interfaces[2:]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, bd_id=10,
+                                                 enable=0)
+        self.vapi.bridge_domain_add_del(bd_id=10, is_add=0)
+        route.remove_vpp_config()
+
+        self.assertFalse(find_route(self, "10.10.10.0", 24))
+        self.assertEqual(len(self.vapi.bridge_domain_dump(10)), 0)
+
+        reply = self.vapi.cli("snapshot restore %s" % self.snapshot)
+        self.logger.info(reply)
+
+        self.assertTrue(find_route(self, "10.10.10.0", 24))
+        bd = self.vapi.bridge_domain_dump(10)
+        self.assertEqual(len(bd), 1)
+        self.assertEqual(bd[0].n_sw_ifs, 2)
+
+        #
+        # the restored route and l2fib entry forward
+        #
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst="10.10.10.1") /
+             UDP(sport=1234, dport=1234) /
+             Raw('\xa5' * 100))
+        self.send_and_expect(self.pg0, p * 65, self.pg1)
+
+        p = (Ether(src=self.pg2.remote_mac, dst=self.pg3.remote_mac) /
+             IP(src="10.0.0.1", dst="10.0.0.2") /
+             UDP(sport=1234, dport=1234) /
+             Raw('\xa5' * 100))
+        self.send_and_expect(self.pg2, p * 65, self.pg3)
+
+        self.vapi.l2fib_add_del(self.pg3.remote_mac, 10,
+                                self.pg3.sw_if_index, is_add=0)
+        for i in self.pg_interfaces[2:]:
+            self.vapi.sw_interface_set_l2_bridge(i.sw_if_index, bd_id=10,
+                                                 enable=0)
+        self.vapi.bridge_domain_add_del(bd_id=10, is_add=0)
+        route.remove_vpp_config()
+
+    def acl_rule(self, is_permit, proto=0, dport=None):
+        return {'is_permit': is_permit, 'is_ipv6': 0, 'proto': proto,
+                'srcport_or_icmptype_first': 0,
+                'srcport_or_icmptype_last': 65535,
+                'src_ip_prefix_len': 0,
+                'src_ip_addr': '\x00' * 4,
+                'dstport_or_icmpcode_first': dport or 0,
+                'dstport_or_icmpcode_last': dport or 65535,
+                'dst_ip_prefix_len': 0,
+                'dst_ip_addr': '\x00' * 4}
+
+    def test_snapshot_acl(self):
+        """ Save and restore ACLs and their interface bindings """
+
+        rules = [self.acl_rule(0, proto=17, dport=4321),
+                 self.acl_rule(1)]
+        acl = self.vapi.acl_add_replace(acl_index=0xffffffff, r=rules,
+                                        tag="snapshot")
+        self.vapi.acl_interface_set_acl_list(sw_if_index=self.pg0.sw_if_index,
+                                             n_input=1,
+                                             acls=[acl.acl_index])
+
+        reply = self.vapi.cli("snapshot save %s" % self.snapshot)
+        self.assertNotIn("failed", reply)
+
+        self.vapi.acl_interface_set_acl_list(sw_if_index=self.pg0.sw_if_index,
+                                             n_input=0, acls=[])
+        self.vapi.acl_del(acl.acl_index)
+        self.assertEqual(len(self.vapi.acl_dump(0xffffffff)), 0)
+
+        reply = self.vapi.cli("snapshot restore %s" % self.snapshot)
+        self.logger.info(reply)
+
+        acls = self.vapi.acl_dump(0xffffffff)
+        self.assertEqual(len(acls), 1)
+        self.assertEqual(acls[0].tag.rstrip('\x00'), "snapshot")
+        self.assertEqual(acls[0].count, 2)
+        bound = self.vapi.acl_interface_list_dump(self.pg0.sw_if_index)
+        self.assertEqual(len(bound), 1)
+        self.assertEqual(bound[0].n_input, 1)
+        self.assertEqual(bound[0].acls[:bound[0].count],
+                         [acls[0].acl_index])
+
+        #
+        # the restored ACL still drops what it denies
+        #
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=4321) /
+             Raw('\xa5' * 100))
+        self.send_and_assert_no_replies(self.pg0, p * 65)
+        p[UDP].dport = 1234
+        self.send_and_expect(self.pg0, p * 65, self.pg1)
+
+        self.vapi.acl_interface_set_acl_list(sw_if_index=self.pg0.sw_if_index,
+                                             n_input=0, acls=[])
+        self.vapi.acl_del(acls[0].acl_index)
+
+    def test_snapshot_neighbors(self):
+        """ Save and restore static ARP and ND entries """
+
+        self.pg1.config_ip6()
+        self.pg1.generate_remote_hosts(2)
+        host = self.pg1.remote_hosts[1]
+
+        arp = VppNeighbor(self, self.pg1.sw_if_index, host.mac, host.ip4,
+                          is_static=1)
+        nd = VppNeighbor(self, self.pg1.sw_if_index, host.mac, host.ip6,
+                         af=socket.AF_INET6, is_static=1)
+        arp.add_vpp_config()
+        nd.add_vpp_config()
+
+        reply = self.vapi.cli("snapshot save %s" % self.snapshot)
+        self.assertNotIn("failed", reply)
+
+        arp.remove_vpp_config()
+        nd.remove_vpp_config()
+        self.assertFalse(find_nbr(self, self.pg1.sw_if_index, host.ip4,
+                                  is_static=1))
+        self.assertFalse(find_nbr(self, self.pg1.sw_if_index, host.ip6,
+                                  is_static=1, inet=socket.AF_INET6))
+
+        reply = self.vapi.cli("snapshot restore %s" % self.snapshot)
+        self.logger.info(reply)
+
+        self.assertTrue(find_nbr(self, self.pg1.sw_if_index, host.ip4,
+                                 is_static=1, mac=host.mac))
+        self.assertTrue(find_nbr(self, self.pg1.sw_if_index, host.ip6,
+                                 is_static=1, inet=socket.AF_INET6,
+                                 mac=host.mac))
+
+        #
+        # the restored entry is used to forward
+        #
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=host.ip4) /
+             UDP(sport=1234, dport=1234) /
+             Raw('\xa5' * 100))
+        rx = self.send_and_expect(self.pg0, p * 65, self.pg1)
+        for r in rx:
+            self.assertEqual(r[Ether].dst, host.mac)
+
+        arp.remove_vpp_config()
+        nd.remove_vpp_config()
+        self.pg1.unconfig_ip6()
+
+    def test_snapshot_bad_file(self):
+        """ Restore a snapshot which is not one """
+
+        with open(self.snapshot, "w") as f:
+            f.write("not a snapshot")
+        reply = self.vapi.cli("snapshot restore %s" % self.snapshot)
+        self.assertIn("bad magic number", reply)
+
+
+class TestSnapshotNat44(VppTestCase):
+    """ Warm restart snapshot NAT44 Test Case """
+
+    nat_addr = '10.0.0.3'
+
+    @classmethod
+    def setUpConstants(cls):
+        super(TestSnapshotNat44, cls).setUpConstants()
+        cls.vpp_cmdline.extend(["cpu", "{", "workers", "2", "}"])
+
+    def setUp(self):
+        super(TestSnapshotNat44, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.nat_addr_n = socket.inet_pton(socket.AF_INET, self.nat_addr)
+        self.snapshot = os.path.join(self.tempdir, "vpp.snapshot")
+
+    def tearDown(self):
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestSnapshotNat44, self).tearDown()
+
+    def nat44_config(self, is_add=1):
+        self.vapi.nat44_add_del_address_range(self.nat_addr_n,
+                                              self.nat_addr_n,
+                                              is_add=is_add)
+        self.vapi.nat44_interface_add_del_feature(self.pg0.sw_if_index,
+                                                  is_add=is_add)
+        self.vapi.nat44_interface_add_del_feature(self.pg1.sw_if_index,
+                                                  is_inside=0,
+                                                  is_add=is_add)
+
+    def nat44_sessions(self):
+        return self.vapi.nat44_user_session_dump(self.pg0.remote_ip4n, 0)
+
+    def in2out(self):
+        """ open a session, return the outside port it got """
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=4321))
+        rx = self.send_and_expect(self.pg0, [p], self.pg1)
+        self.assertEqual(rx[0][IP].src, self.nat_addr)
+        return rx[0][UDP].sport
+
+    def out2in(self, port):
+        return (Ether(src=self.pg1.remote_mac, dst=self.pg1.local_mac) /
+                IP(src=self.pg1.remote_ip4, dst=self.nat_addr) /
+                UDP(sport=4321, dport=port))
+
+    def save_and_clear(self):
+        reply = self.vapi.cli("snapshot save %s" % self.snapshot)
+        self.assertNotIn("failed", reply)
+
+        # deleting the address takes its sessions with it
+        self.nat44_config(is_add=0)
+        self.assertEqual(len(self.vapi.nat44_interface_dump()), 0)
+        self.assertEqual(len(self.vapi.nat44_address_dump()), 0)
+        self.assertEqual(len(self.nat44_sessions()), 0)
+
+    def verify_config(self):
+        interfaces = self.vapi.nat44_interface_dump()
+        self.assertEqual(len(interfaces), 2)
+        for i in interfaces:
+            self.assertEqual(i.is_inside,
+                             i.sw_if_index == self.pg0.sw_if_index)
+        addresses = self.vapi.nat44_address_dump()
+        self.assertEqual(len(addresses), 1)
+        self.assertEqual(addresses[0].ip_address[:4], self.nat_addr_n)
+
+    def test_snapshot_nat44(self):
+        """ Save and restore NAT44 config and sessions """
+
+        self.nat44_config()
+        port = self.in2out()
+
+        self.save_and_clear()
+
+        reply = self.vapi.cli("snapshot restore %s" % self.snapshot)
+        self.logger.info(reply)
+
+        self.verify_config()
+        self.assertEqual(len(self.nat44_sessions()), 1)
+
+        #
+        # the reply to the restored session gets translated back
+        #
+        rx = self.send_and_expect(self.pg1, [self.out2in(port)], self.pg0)
+        self.assertEqual(rx[0][IP].dst, self.pg0.remote_ip4)
+        self.assertEqual(rx[0][UDP].dport, 1234)
+
+        # and the outside port is not handed out again
+        self.assertEqual(self.in2out(), port)
+        self.assertEqual(len(self.nat44_sessions()), 1)
+
+        self.nat44_config(is_add=0)
+
+    def test_snapshot_nat44_workers(self):
+        """ NAT44 sessions are skipped when the workers changed """
+
+        self.nat44_config()
+        port = self.in2out()
+
+        self.save_and_clear()
+
+        # one worker owns all the ports now, sessions saved with the
+        # old partitioning can't be placed
+        self.vapi.cli("set nat workers 0")
+        try:
+            reply = self.vapi.cli("snapshot restore %s" % self.snapshot)
+            self.logger.info(reply)
+            self.assertIn("objects skipped", reply)
+
+            # the config is restored, the session is not
+            self.verify_config()
+            self.assertEqual(len(self.nat44_sessions()), 0)
+            self.send_and_assert_no_replies(self.pg1, [self.out2in(port)])
+        finally:
+            self.vapi.cli("set nat workers 0-1")
+
+        self.nat44_config(is_add=0)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -569,6 +569,86 @@ class TestSRv6(VppTestCase):
         # cleanup interfaces
         self.teardown_interfaces()
 
+    def test_SRv6_End_uSID(self):
+        """ Test SRv6 End behavior on a uSID localsid.
+        """
+        # send traffic to one destination interface
+        # source and destination interfaces are IPv6 only
+        self.setup_interfaces(ipv6=[True, True])
+
+        # configure FIB entries for the next uSID
+        route = VppIpRoute(self, "fc00:0:2::", 48,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index,
+                                         proto=DpoProto.DPO_PROTO_IP6)],
+                           is_ip6=1)
+        route.add_vpp_config()
+
+        # configure the uSID fc00:0:1 of the 32 bits uSID block fc00:0
+        self.vapi.cli("sr localsid address fc00:0:1:: behavior end "
+                      "usid-block 32")
+        self.logger.debug(self.vapi.cli("show sr localsid"))
+
+        # packets without SRH carrying the uSIDs 1, 2 and 3
+        count = len(self.pg_packet_sizes)
+        packet_header = self.create_packet_header_IPv6('fc00:0:1:2:3::')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+
+        # send packets and verify received packets
+        self.send_and_verify_pkts(self.pg0, pkts, self.pg1,
+                                  self.compare_rx_tx_packet_End_uSID)
+
+        # log the localsid counters
+        self.logger.info(self.vapi.cli("show sr localsid"))
+
+        # remove SRv6 localSIDs
+        self.vapi.cli("sr localsid del address fc00:0:1::")
+
+        # cleanup interfaces
+        self.teardown_interfaces()
+
+    def test_SRv6_uSID_compress(self):
+        """ Test SRv6 policy with uSID compressed segments.
+        """
+        # send traffic to one destination interface
+        # source and destination interfaces are IPv6 only
+        self.setup_interfaces(ipv6=[True, True])
+
+        # configure FIB entries
+        route = VppIpRoute(self, "fc00:0:1::", 48,
+                           [VppRoutePath(self.pg1.remote_ip6,
+                                         self.pg1.sw_if_index,
+                                         proto=DpoProto.DPO_PROTO_IP6)],
+                           is_ip6=1)
+        route.add_vpp_config()
+
+        # the three uSIDs fit in one container, sent without an SRH
+        self.vapi.cli("set sr encaps source addr a3::")
+        self.vapi.cli("sr policy add bsid a3::9999:1 next fc00:0:1:: "
+                      "next fc00:0:2:: next fc00:0:3:: encap "
+                      "usid-block 32")
+        self.vapi.cli("sr steer l3 a4::/64 via bsid a3::9999:1")
+        self.logger.debug(self.vapi.cli("show sr policies"))
+
+        count = len(self.pg_packet_sizes)
+        packet_header = self.create_packet_header_IPv6('a4::1')
+        pkts = self.create_stream(self.pg0, self.pg1, packet_header,
+                                  self.pg_packet_sizes, count)
+
+        self.pg0.add_stream(pkts)
+        self.pg_enable_capture(self.pg_interfaces)
+        self.pg_start()
+        for rx in self.pg1.get_capture(len(pkts)):
+            self.assertEqual(rx[IPv6].dst, 'fc00:0:1:2:3::')
+            self.assertFalse(rx.haslayer(IPv6ExtHdrSegmentRouting))
+
+        self.vapi.cli("sr steer del l3 a4::/64 via bsid a3::9999:1")
+        self.vapi.cli("sr policy del bsid a3::9999:1")
+
+        # cleanup interfaces
+        self.teardown_interfaces()
+
     def test_SRv6_End_with_PSP(self):
         """ Test SRv6 End with PSP behavior.
         """
@@ -1576,6 +1656,25 @@ class TestSRv6(VppTestCase):
 
         self.logger.debug("packet verification: SUCCESS")
 
+    def compare_rx_tx_packet_End_uSID(self, tx_pkt, rx_pkt):
+        """ Compare input and output packet after passing a uSID End
+
+        :param tx_pkt: transmitted packet
+        :param rx_pkt: received packet
+        """
+        # the uSIDs following the active one are shifted over it:
+        # in: IPv6(A, fc00:0:1:2:3::)
+        # out: IPv6(A, fc00:0:2:3::)
+        rx_ip = rx_pkt.getlayer(IPv6)
+        tx_ip = tx_pkt.getlayer(IPv6)
+
+        self.assertEqual(rx_ip.dst, 'fc00:0:2:3::')
+        self.assertEqual(rx_ip.src, tx_ip.src)
+        self.assertEqual(rx_ip.hlim, tx_ip.hlim - 1)
+        self.assertEqual(rx_pkt[UDP], tx_pkt[UDP])
+
+        self.logger.debug("packet verification: SUCCESS")
+
     def compare_rx_tx_packet_End(self, tx_pkt, rx_pkt):
         """ Compare input and output packet after passing End (without PSP)
 
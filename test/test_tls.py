@@ -0,0 +1,106 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+from vpp_ip_route import VppIpTable, VppIpRoute, VppRoutePath
+
+
+class TestTLS(VppTestCase):
+    """ TLS Test Case """
+
+    @classmethod
+    def setUpClass(cls):
+        super(TestTLS, cls).setUpClass()
+
+    def setUp(self):
+        super(TestTLS, self).setUp()
+
+        self.vapi.session_enable_disable(is_enabled=1)
+        self.create_loopback_interfaces(2)
+
+        table_id = 0
+
+        for i in self.lo_interfaces:
+            i.admin_up()
+
+            if table_id != 0:
+                tbl = VppIpTable(self, table_id)
+                tbl.add_vpp_config()
+
+            i.set_table_ip4(table_id)
+            i.config_ip4()
+            table_id += 1
+
+        # Configure namespaces
+        self.vapi.app_namespace_add(namespace_id="0",
+                                    sw_if_index=self.loop0.sw_if_index)
+        self.vapi.app_namespace_add(namespace_id="1",
+                                    sw_if_index=self.loop1.sw_if_index)
+
+    def tearDown(self):
+        self.vapi.cli("tls openssl record-offload disable")
+
+        for i in self.lo_interfaces:
+            i.unconfig_ip4()
+            i.set_table_ip4(0)
+            i.admin_down()
+
+        super(TestTLS, self).tearDown()
+        self.vapi.session_enable_disable(is_enabled=1)
+
+    def test_tls_unittest(self):
+        """ TLS record layer known answer tests """
+        error = self.vapi.cli("test tls all")
+
+        if error:
+            self.logger.critical(error)
+        self.assertEqual(error.find("failed"), -1)
+
+    def test_tls_record_offload_echo(self):
+        """ TLS echo through the native record layer """
+
+        # Add inter-table routes
+        ip_t01 = VppIpRoute(self, self.loop1.local_ip4, 32,
+                            [VppRoutePath("0.0.0.0",
+                                          0xffffffff,
+                                          nh_table_id=1)])
+        ip_t10 = VppIpRoute(self, self.loop0.local_ip4, 32,
+                            [VppRoutePath("0.0.0.0",
+                                          0xffffffff,
+                                          nh_table_id=0)], table_id=1)
+        ip_t01.add_vpp_config()
+        ip_t10.add_vpp_config()
+
+        self.vapi.cli("tls openssl record-offload enable")
+
+        # More data than fits in one record or one fifo, so that records
+        # wrap in both the app and the tls fifos
+        uri = "tls://" + self.loop0.local_ip4 + "/1234"
+        error = self.vapi.cli("test echo server appns 0 fifo-size 64 " +
+                              "uri " + uri)
+        if error:
+            self.logger.critical(error)
+            self.assertEqual(error.find("failed"), -1)
+
+        error = self.vapi.cli("test echo client appns 1 fifo-size 64 " +
+                              "bytes 1000000 test-bytes no-output " +
+                              "test-timeout 20 uri " + uri)
+        if error:
+            self.logger.critical(error)
+            self.assertEqual(error.find("failed"), -1)
+
+        if self.vpp_dead:
+            self.assert_equal(0)
+
+        # Both the client and the server session went native
+        reply = self.vapi.cli("show tls openssl record-offload")
+        self.logger.info(reply)
+        self.assertIn("2 sessions offloaded", reply)
+
+        # Delete inter-table routes
+        ip_t01.remove_vpp_config()
+        ip_t10.remove_vpp_config()
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -0,0 +1,83 @@
+#!/usr/bin/env python
+
+import unittest
+
+from framework import VppTestCase, VppTestRunner
+
+from scapy.packet import Raw
+from scapy.layers.l2 import Ether
+from scapy.layers.inet import IP, UDP
+
+
+class TestTraceSample(VppTestCase):
+    """ Sampling Tracer Test Case """
+
+    def setUp(self):
+        super(TestTraceSample, self).setUp()
+
+        self.create_pg_interfaces(range(2))
+
+        for i in self.pg_interfaces:
+            i.admin_up()
+            i.config_ip4()
+            i.resolve_arp()
+
+        self.vapi.cli("clear trace")
+
+    def tearDown(self):
+        self.vapi.cli("trace sample stop")
+
+        for i in self.pg_interfaces:
+            i.unconfig_ip4()
+            i.admin_down()
+
+        super(TestTraceSample, self).tearDown()
+
+    def create_stream(self, dport, n_pkts):
+        p = (Ether(src=self.pg0.remote_mac, dst=self.pg0.local_mac) /
+             IP(src=self.pg0.remote_ip4, dst=self.pg1.remote_ip4) /
+             UDP(sport=1234, dport=dport) /
+             Raw('\xa5' * 100))
+        return [p] * n_pkts
+
+    def samples(self):
+        reply = self.vapi.cli("show trace sample max 1000")
+        return [l for l in reply.splitlines() if l.startswith("Sample")]
+
+    def test_sample_every(self):
+        """ Sample 1 in N packets """
+
+        self.vapi.cli("trace sample pg-input every 4 records 256")
+        self.send_and_expect(self.pg0, self.create_stream(1234, 20),
+                             self.pg1)
+
+        self.assertEqual(len(self.samples()), 5)
+
+        reply = self.vapi.cli("show trace sample")
+        self.logger.info(reply)
+        for node in ["pg-input", "ethernet-input", "ip4-input",
+                     "ip4-lookup", "ip4-rewrite"]:
+            self.assertIn(node, reply)
+
+    def test_sample_match(self):
+        """ Sample the packets matching a filter """
+
+        #
+        # UDP destination port 0x04d3 is at offset 36 of the frame
+        #
+        self.vapi.cli("trace sample pg-input match 36 04d3")
+        self.send_and_expect(self.pg0, self.create_stream(1234, 10),
+                             self.pg1)
+        self.send_and_expect(self.pg0, self.create_stream(1235, 7),
+                             self.pg1)
+
+        self.assertEqual(len(self.samples()), 7)
+
+        self.vapi.cli("trace sample pg-input disable")
+        self.send_and_expect(self.pg0, self.create_stream(1235, 7),
+                             self.pg1)
+        self.assertEqual(len(self.samples()), 7)
+
+
+if __name__ == '__main__':
+    unittest.main(testRunner=VppTestRunner)
@@ -221,6 +221,10 @@ class VCLCutThruTestCase(VCLTestCase):
         self.cut_thru_setup()
         self.client_echo_test_args = ["-E", self.echo_phrase, "-X",
                                       self.server_addr, self.server_port]
+        self.client_batch_echo_test_args = ["-b", "-I", "4", "-E",
+                                            self.echo_phrase, "-X",
+                                            self.server_addr,
+                                            self.server_port]
         self.client_iperf3_timeout = 20
         self.client_iperf3_args = ["-V4d", "-c", self.server_addr]
         self.server_iperf3_args = ["-V4d", "-s"]
@@ -232,6 +236,11 @@ class VCLCutThruTestCase(VCLTestCase):
         self.client_bi_dir_nsock_test_args = ["-I", "2", "-B", "-X",
                                               self.server_addr,
                                               self.server_port]
+        self.client_rr_nsock_timeout = 60
+        self.client_rr_nsock_test_args = ["-I", "2", "-Q", "-N", "10000",
+                                          "-T", "128", "-X",
+                                          self.server_addr,
+                                          self.server_port]
 
     def tearDown(self):
         self.cut_thru_tear_down()
@@ -276,12 +285,27 @@ class VCLCutThruTestCase(VCLTestCase):
                            "sock_test_client",
                            self.client_bi_dir_nsock_test_args)
 
+    @unittest.skipUnless(running_extended_tests(), "part of extended tests")
+    def test_ldp_cut_thru_rr_nsock(self):
+        """ run LDP cut thru request/response (multiple sockets) test """
+
+        self.timeout = self.client_rr_nsock_timeout
+        self.cut_thru_test("sock_test_server", self.server_args,
+                           "sock_test_client",
+                           self.client_rr_nsock_test_args)
+
     def test_vcl_cut_thru_echo(self):
         """ run VCL cut thru echo test """
 
         self.cut_thru_test("vcl_test_server", self.server_args,
                            "vcl_test_client", self.client_echo_test_args)
 
+    def test_vcl_cut_thru_batch_echo(self):
+        """ run VCL cut thru echo test through the batch api """
+
+        self.cut_thru_test("vcl_test_server", self.server_args,
+                           "vcl_test_client", self.client_batch_echo_test_args)
+
     @unittest.skipUnless(running_extended_tests(), "part of extended tests")
     def test_vcl_cut_thru_uni_dir_nsock(self):
         """ run VCL cut thru uni-directional (multiple sockets) test """
@@ -341,6 +365,42 @@ class VCLThruHostStackTestCase(VCLTestCase):
     #      is fixed.
 
 
+class VCLThruHostStackMmsgTestCase(VCLTestCase):
+    """ VCL Thru Host Stack UDP sendmmsg/recvmmsg Tests """
+
+    def setUp(self):
+        super(VCLThruHostStackMmsgTestCase, self).setUp()
+
+        self.thru_host_stack_setup()
+
+    def tearDown(self):
+        self.thru_host_stack_tear_down()
+
+        super(VCLThruHostStackMmsgTestCase, self).tearDown()
+
+    def test_vcl_thru_host_stack_udp_mmsg(self):
+        """ run VCL thru host stack udp sendmmsg/recvmmsg test """
+
+        self.env = {'VCL_API_PREFIX': self.shm_prefix,
+                    'VCL_APP_SCOPE_GLOBAL': "true",
+                    'VCL_APP_NAMESPACE_ID': "1",
+                    'VCL_APP_NAMESPACE_SECRET': "1234"}
+
+        # Listener and connected session live in the same app
+        worker = VCLAppWorker(self.build_dir, "test_vcl_mmsg",
+                              [self.loop0.local_ip4, self.server_port],
+                              self.logger, self.env)
+        worker.start()
+        worker.join(self.timeout)
+
+        if worker.result is None:
+            os.killpg(os.getpgid(worker.process.pid), signal.SIGTERM)
+            worker.join()
+            self.fail("Timeout! test_vcl_mmsg did not finish in %ss" %
+                      self.timeout)
+        self.assert_equal(worker.result, 0, "Binary test return code")
+
+
 class VCLThruHostStackExtendedATestCase(VCLTestCase):
     """ VCL Thru Host Stack Extended Tests """
 
@@ -2967,7 +2967,9 @@ class VppPapiProvider(object):
                         exceed_action_type=0,
                         exceed_dscp=0,
                         violate_action_type=0,
-                        violate_dscp=0):
+                        violate_dscp=0,
+                        per_thread=0,
+                        thread_quantum=0):
         return self.api(self.papi.policer_add_del,
                         {'name': name,
                          'cir': cir,
@@ -2984,7 +2986,9 @@ class VppPapiProvider(object):
                          'exceed_action_type': exceed_action_type,
                          'exceed_dscp': exceed_dscp,
                          'violate_action_type': violate_action_type,
-                         'violate_dscp': violate_dscp})
+                         'violate_dscp': violate_dscp,
+                         'per_thread': per_thread,
+                         'thread_quantum': thread_quantum})
 
     def ip_punt_police(self,
                        policer_index,